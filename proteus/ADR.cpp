@@ -24,6 +24,6 @@ PYBIND11_MODULE(cADR, m)
 
     py::class_<cADR_base>(m, "cADR_base")
         .def(py::init(&proteus::newADR))
-        .def("calculateResidual", &cADR_base::calculateResidual)
-        .def("calculateJacobian", &cADR_base::calculateJacobian);
+        .def("calculateResidual", &cADR_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cADR_base::calculateJacobian, proteus::release_gil());
 }
@@ -0,0 +1,229 @@
+#ifndef BALLGRID_H
+#define BALLGRID_H
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace proteus
+{
+  /**
+   * \brief Uniform grid (cell list) over a set of balls for neighbor and nearest-ball queries
+   *
+   * Ball centers are binned into cubic cells of width at least the
+   * requested cell size and stored in CSR form, each cell holding its
+   * balls in ascending order. Every pair of balls closer than the cell
+   * size lies in the same or in adjacent cells, and the nearest ball to
+   * a point is found by searching rings of cells outward from the cell
+   * of the point. The number of cells is kept proportional to the number
+   * of balls, so building the grid and each query cost O(1) per ball for
+   * well spread out particles instead of O(nBalls).
+   */
+  class BallGrid
+  {
+  public:
+    BallGrid():
+      nBalls(0),
+      center(0),
+      radius(0),
+      maxRadius(0.0),
+      h(1.0)
+    {
+      for (int I=0;I<3;I++)
+        {
+          origin[I] = 0.0;
+          nCells[I] = 1;
+        }
+    }
+
+    /// bin the balls, with cells of width at least cellSize (about one ball per cell if cellSize <= 0)
+    inline void build(int nBalls_in, const double* center_in, const double* radius_in, double cellSize=0.0)
+    {
+      nBalls = nBalls_in;
+      center = center_in;
+      radius = radius_in;
+      double lower[3]={0.0,0.0,0.0},upper[3]={0.0,0.0,0.0};
+      maxRadius = 0.0;
+      for (int i=0;i<nBalls;i++)
+        {
+          for (int I=0;I<3;I++)
+            {
+              lower[I] = (i == 0) ? center[i*3+I] : std::min(lower[I],center[i*3+I]);
+              upper[I] = (i == 0) ? center[i*3+I] : std::max(upper[I],center[i*3+I]);
+            }
+          maxRadius = std::max(maxRadius,radius[i]);
+        }
+      if (cellSize > 0.0)
+        h = cellSize*(1.0 + 1.0e-8);
+      else
+        {
+          //about one ball per cell over the dimensions the centers span
+          double volume=1.0;
+          int nSpace=0;
+          for (int I=0;I<3;I++)
+            if (upper[I] > lower[I])
+              {
+                volume *= upper[I]-lower[I];
+                nSpace++;
+              }
+          h = (nSpace > 0) ? std::pow(volume/std::max(nBalls,1),1.0/nSpace) : 0.0;
+          h = std::max(h,2.0*maxRadius);
+          if (!(h > 0.0))
+            h = 1.0;
+        }
+      //cap the number of cells at a multiple of the number of balls
+      for (;;)
+        {
+          double nCells_total=1.0;
+          for (int I=0;I<3;I++)
+            nCells_total *= std::floor((upper[I]-lower[I])/h) + 1.0;
+          if (nCells_total <= 8.0*nBalls + 64.0)
+            break;
+          h *= 2.0;
+        }
+      for (int I=0;I<3;I++)
+        {
+          origin[I] = lower[I];
+          nCells[I] = int(std::floor((upper[I]-lower[I])/h)) + 1;
+        }
+      cellOffsets.assign(nCells[0]*nCells[1]*nCells[2]+1,0);
+      std::vector<int> ballCell(nBalls);
+      for (int i=0;i<nBalls;i++)
+        {
+          int c[3];
+          cellOf(&center[i*3],c);
+          ballCell[i] = cellIndex(c);
+          cellOffsets[ballCell[i]+1]++;
+        }
+      for (std::size_t cell=1;cell<cellOffsets.size();cell++)
+        cellOffsets[cell] += cellOffsets[cell-1];
+      cellBalls.resize(nBalls);
+      std::vector<int> fill(cellOffsets.begin(),cellOffsets.end()-1);
+      for (int i=0;i<nBalls;i++)
+        cellBalls[fill[ballCell[i]]++] = i;
+    }
+
+    /// balls with centers in the cells adjacent to the cell of x, in ascending order
+    inline void neighbors(const double* x, std::vector<int>& balls) const
+    {
+      balls.clear();
+      int c[3],lo[3],hi[3];
+      cellOf(x,c);
+      for (int I=0;I<3;I++)
+        {
+          lo[I] = std::max(c[I]-1,0);
+          hi[I] = std::min(c[I]+1,nCells[I]-1);
+        }
+      for (int i=lo[0];i<=hi[0];i++)
+        for (int j=lo[1];j<=hi[1];j++)
+          for (int k=lo[2];k<=hi[2];k++)
+            {
+              const int cell = (i*nCells[1]+j)*nCells[2]+k;
+              balls.insert(balls.end(),cellBalls.begin()+cellOffsets[cell],cellBalls.begin()+cellOffsets[cell+1]);
+            }
+      std::sort(balls.begin(),balls.end());
+    }
+
+    /// the ball minimizing |x - center| - radius, with ties going to the lowest index as in a linear scan
+    inline int nearest(const double x, const double y, const double z, double& distance) const
+    {
+      const double xyz[3]={x,y,z};
+      int c[3];
+      cellOf(xyz,c);
+      distance = 1e10;
+      int index = -1;
+      for (int ring=0;;ring++)
+        {
+          if (ring > 0 && outsideDistance(xyz,c,ring-1) - maxRadius > distance)
+            break;
+          int lo[3],hi[3];
+          for (int I=0;I<3;I++)
+            {
+              lo[I] = std::max(c[I]-ring,0);
+              hi[I] = std::min(c[I]+ring,nCells[I]-1);
+            }
+          for (int i=lo[0];i<=hi[0];i++)
+            for (int j=lo[1];j<=hi[1];j++)
+              {
+                //only the shell of the ring: all k on its sides, the two end cells otherwise
+                const bool side = (std::abs(i-c[0]) == ring || std::abs(j-c[1]) == ring);
+                const int kStep = (side || ring == 0) ? 1 : 2*ring;
+                for (int k=c[2]-ring;k<=c[2]+ring;k+=kStep)
+                  {
+                    if (k < lo[2] || k > hi[2])
+                      continue;
+                    const int cell = (i*nCells[1]+j)*nCells[2]+k;
+                    for (int offset=cellOffsets[cell];offset<cellOffsets[cell+1];offset++)
+                      {
+                        const int b = cellBalls[offset];
+                        const double d_ball = std::sqrt((center[b*3+0]-x)*(center[b*3+0]-x)
+                                                        +(center[b*3+1]-y)*(center[b*3+1]-y)
+                                                        +(center[b*3+2]-z)*(center[b*3+2]-z)
+                                                        ) - radius[b];
+                        if (d_ball < distance || (d_ball == distance && b < index))
+                          {
+                            distance = d_ball;
+                            index = b;
+                          }
+                      }
+                  }
+              }
+        }
+      return index;
+    }
+  private:
+    int nBalls;
+    const double* center;
+    const double* radius;
+    double maxRadius;
+    double h;
+    double origin[3];
+    int nCells[3];
+    std::vector<int> cellOffsets;
+    std::vector<int> cellBalls;
+
+    inline void cellOf(const double* x, int* c) const
+    {
+      for (int I=0;I<3;I++)
+        {
+          const double s = std::floor((x[I]-origin[I])/h);
+          c[I] = int(std::min(std::max(s,0.0),double(nCells[I]-1)));
+        }
+    }
+
+    /// lower bound on the distance from x to the centers outside the cells within ring of c, or HUGE_VAL if there are none
+    inline double outsideDistance(const double* x, const int* c, int ring) const
+    {
+      double bound = HUGE_VAL;
+      for (int I=0;I<3;I++)
+        for (int side=-1;side<=1;side+=2)
+          {
+            const int edge = c[I] + side*ring;
+            if ((side < 0 && edge <= 0) || (side > 0 && edge >= nCells[I]-1))
+              continue;
+            //distance to the part of the grid beyond this face of the ring
+            double d2=0.0;
+            for (int J=0;J<3;J++)
+              {
+                double lower = origin[J], upper = origin[J] + nCells[J]*h;
+                if (J == I)
+                  {
+                    if (side < 0)
+                      upper = origin[J] + edge*h;
+                    else
+                      lower = origin[J] + (edge+1)*h;
+                  }
+                const double dJ = std::max(std::max(lower - x[J],x[J] - upper),0.0);
+                d2 += dJ*dJ;
+              }
+            bound = std::min(bound,std::sqrt(d2));
+          }
+      return bound;
+    }
+
+    inline int cellIndex(const int* c) const
+    {
+      return (c[0]*nCells[1]+c[1])*nCells[2]+c[2];
+    }
+  };
+}//proteus
+#endif
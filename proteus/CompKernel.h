@@ -1,6 +1,8 @@
 #ifndef COMPKERNEL_H
 #define COMPKERNEL_H
 #include <cmath>
+#include <vector>
+#include <cstddef>
 //#include "xtensor-python/pyarray.hpp"
 //#include "xtensor-python/pyvectorize.hpp"
 /**
@@ -225,8 +227,86 @@ public:
     YHX(2),YHY(3),
     ZHX(4),ZHY(5),
     HXHX(0),HXHY(1),
-    HYHX(2),HYHY(3)
+    HYHX(2),HYHY(3),
+    geometryCache_mesh_dof(NULL),
+    geometryCache_mesh_l2g(NULL),
+    geometryCache_nElements(-1),
+    geometryCache_meshGeneration(-1)
   {}
+  std::vector<double> geometryCache;
+  const double* geometryCache_mesh_dof;
+  const int* geometryCache_mesh_l2g;
+  int geometryCache_nElements;
+  int geometryCache_meshGeneration;
+
+  /**
+   * Cache the constant jacobian, inverse and determinant of affine simplices
+   *
+   * With 4 mesh DOFs per element the mapping is affine, so the element
+   * and element boundary mappings only need to interpolate the physical
+   * point once the cache holds the 19 doubles (152 bytes) per element.
+   * The cache is only used for the mesh_dof and mesh_l2g arrays it was
+   * built from, and it is rebuilt when those arrays, the element count or
+   * meshGeneration (Mesh.generation, bumped whenever the nodes move)
+   * change. Every entry point of a kernel that maps elements calls it, so
+   * none of them reads the geometry of a mesh that has since moved.
+   */
+  inline void updateGeometryCache(const int nElements,
+				  double* mesh_dof,
+				  int* mesh_l2g,
+				  double* mesh_grad_trial_ref,
+				  const int meshGeneration)
+  {
+    if (NDOF_MESH_TRIAL_ELEMENT != 4)
+      return;
+    if (meshGeneration == geometryCache_meshGeneration &&
+	mesh_dof == geometryCache_mesh_dof &&
+	mesh_l2g == geometryCache_mesh_l2g &&
+	nElements == geometryCache_nElements)
+      return;
+    double trial_ref[NDOF_MESH_TRIAL_ELEMENT],x,y,z;
+    for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
+      trial_ref[j] = 0.0;
+    clearGeometryCache();
+    geometryCache.resize(nElements*19);
+    for (int eN=0;eN<nElements;eN++)
+      {
+	double* g = &geometryCache[eN*19];
+	calculateMapping_element(eN,0,mesh_dof,mesh_l2g,trial_ref,mesh_grad_trial_ref,g,g[18],&g[9],x,y,z);
+      }
+    geometryCache_mesh_dof = mesh_dof;
+    geometryCache_mesh_l2g = mesh_l2g;
+    geometryCache_nElements = nElements;
+    geometryCache_meshGeneration = meshGeneration;
+  }
+
+  inline void clearGeometryCache()
+  {
+    geometryCache.clear();
+    geometryCache_mesh_dof = NULL;
+    geometryCache_mesh_l2g = NULL;
+    geometryCache_nElements = -1;
+    geometryCache_meshGeneration = -1;
+  }
+
+  inline bool geometryCached(const double* mesh_dof, const int* mesh_l2g) const
+  {
+    return mesh_dof == geometryCache_mesh_dof && mesh_l2g == geometryCache_mesh_l2g;
+  }
+
+  inline void loadGeometryCache(const int eN,
+				double* jac,
+				double& jacDet,
+				double* jacInv) const
+  {
+    const double* g = &geometryCache[eN*19];
+    for (int I=0;I<9;I++)
+      {
+	jac[I] = g[I];
+	jacInv[I] = g[9+I];
+      }
+    jacDet = g[18];
+  }
   inline void calculateMapping_element(const int eN,
 				       const int k,
 				       double* mesh_dof,
@@ -247,6 +327,18 @@ public:
     //mapping of reference element to physical element
     //
     x=0.0;y=0.0;z=0.0;
+    if (geometryCached(mesh_dof,mesh_l2g))
+      {
+	for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
+	  {
+	    int eN_j=eN*NDOF_MESH_TRIAL_ELEMENT+j;
+	    x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_ref[k*NDOF_MESH_TRIAL_ELEMENT+j];
+	    y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_ref[k*NDOF_MESH_TRIAL_ELEMENT+j];
+	    z += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_trial_ref[k*NDOF_MESH_TRIAL_ELEMENT+j];
+	  }
+	loadGeometryCache(eN,jac,jacDet,jacInv);
+	return;
+      }
     for (int I=0;I<3;I++)
       {
 	Grad_x[I]=0.0;Grad_y[I]=0.0;Grad_z[I]=0.0;
@@ -364,51 +456,66 @@ public:
     //calculate mapping from the reference element to the physical element
     // 
     x=0.0;y=0.0;z=0.0;
-    for (int I=0;I<3;I++)
+    if (geometryCached(mesh_dof,mesh_l2g))
       {
-	Grad_x_ext[I] = 0.0;
-	Grad_y_ext[I] = 0.0;
-	Grad_z_ext[I] = 0.0;
-      }
-    for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++) 
-      { 
-	int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
-	int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
-	int ebN_local_kb_j_nSpace = ebN_local_kb_j*3;
-	x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j]; 
-	y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j]; 
-	z += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_trial_trace_ref[ebN_local_kb_j]; 
-	for (int I=0;I<3;I++)
+	for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
 	  {
-	    Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
-	    Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; 
-	    Grad_z_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
-	  } 
+	    int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
+	    int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
+	    x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j];
+	    y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j];
+	    z += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_trial_trace_ref[ebN_local_kb_j];
+	  }
+	loadGeometryCache(eN,jac,jacDet,jacInv);
+      }
+    else
+      {
+        for (int I=0;I<3;I++)
+          {
+    	Grad_x_ext[I] = 0.0;
+    	Grad_y_ext[I] = 0.0;
+    	Grad_z_ext[I] = 0.0;
+          }
+        for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++) 
+          { 
+    	int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
+    	int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
+    	int ebN_local_kb_j_nSpace = ebN_local_kb_j*3;
+    	x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j]; 
+    	y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j]; 
+    	z += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_trial_trace_ref[ebN_local_kb_j]; 
+    	for (int I=0;I<3;I++)
+    	  {
+    	    Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
+    	    Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; 
+    	    Grad_z_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+2]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
+    	  } 
+          }
+        //Space Mapping Jacobian
+        jac[XX] = Grad_x_ext[X];
+        jac[XY] = Grad_x_ext[Y];
+        jac[XZ] = Grad_x_ext[Z];
+        jac[YX] = Grad_y_ext[X];
+        jac[YY] = Grad_y_ext[Y];
+        jac[YZ] = Grad_y_ext[Z];
+        jac[ZX] = Grad_z_ext[X];
+        jac[ZY] = Grad_z_ext[Y];
+        jac[ZZ] = Grad_z_ext[Z];
+        jacDet = 
+          jac[XX]*(jac[YY]*jac[ZZ] - jac[YZ]*jac[ZY]) -
+          jac[XY]*(jac[YX]*jac[ZZ] - jac[YZ]*jac[ZX]) +
+          jac[XZ]*(jac[YX]*jac[ZY] - jac[YY]*jac[ZX]);
+        oneOverJacDet = 1.0/jacDet;
+        jacInv[XX] = oneOverJacDet*(jac[YY]*jac[ZZ] - jac[YZ]*jac[ZY]);
+        jacInv[YX] = oneOverJacDet*(jac[YZ]*jac[ZX] - jac[YX]*jac[ZZ]);
+        jacInv[ZX] = oneOverJacDet*(jac[YX]*jac[ZY] - jac[YY]*jac[ZX]);
+        jacInv[XY] = oneOverJacDet*(jac[ZY]*jac[XZ] - jac[ZZ]*jac[XY]);
+        jacInv[YY] = oneOverJacDet*(jac[ZZ]*jac[XX] - jac[ZX]*jac[XZ]);
+        jacInv[ZY] = oneOverJacDet*(jac[ZX]*jac[XY] - jac[ZY]*jac[XX]);
+        jacInv[XZ] = oneOverJacDet*(jac[XY]*jac[YZ] - jac[XZ]*jac[YY]);
+        jacInv[YZ] = oneOverJacDet*(jac[XZ]*jac[YX] - jac[XX]*jac[YZ]);
+        jacInv[ZZ] = oneOverJacDet*(jac[XX]*jac[YY] - jac[XY]*jac[YX]);
       }
-    //Space Mapping Jacobian
-    jac[XX] = Grad_x_ext[X];
-    jac[XY] = Grad_x_ext[Y];
-    jac[XZ] = Grad_x_ext[Z];
-    jac[YX] = Grad_y_ext[X];
-    jac[YY] = Grad_y_ext[Y];
-    jac[YZ] = Grad_y_ext[Z];
-    jac[ZX] = Grad_z_ext[X];
-    jac[ZY] = Grad_z_ext[Y];
-    jac[ZZ] = Grad_z_ext[Z];
-    jacDet = 
-      jac[XX]*(jac[YY]*jac[ZZ] - jac[YZ]*jac[ZY]) -
-      jac[XY]*(jac[YX]*jac[ZZ] - jac[YZ]*jac[ZX]) +
-      jac[XZ]*(jac[YX]*jac[ZY] - jac[YY]*jac[ZX]);
-    oneOverJacDet = 1.0/jacDet;
-    jacInv[XX] = oneOverJacDet*(jac[YY]*jac[ZZ] - jac[YZ]*jac[ZY]);
-    jacInv[YX] = oneOverJacDet*(jac[YZ]*jac[ZX] - jac[YX]*jac[ZZ]);
-    jacInv[ZX] = oneOverJacDet*(jac[YX]*jac[ZY] - jac[YY]*jac[ZX]);
-    jacInv[XY] = oneOverJacDet*(jac[ZY]*jac[XZ] - jac[ZZ]*jac[XY]);
-    jacInv[YY] = oneOverJacDet*(jac[ZZ]*jac[XX] - jac[ZX]*jac[XZ]);
-    jacInv[ZY] = oneOverJacDet*(jac[ZX]*jac[XY] - jac[ZY]*jac[XX]);
-    jacInv[XZ] = oneOverJacDet*(jac[XY]*jac[YZ] - jac[XZ]*jac[YY]);
-    jacInv[YZ] = oneOverJacDet*(jac[XZ]*jac[YX] - jac[XX]*jac[YZ]);
-    jacInv[ZZ] = oneOverJacDet*(jac[XX]*jac[YY] - jac[XY]*jac[YX]);
     //normal
     norm_normal=0.0;
     for (int I=0;I<3;I++)
@@ -661,8 +768,86 @@ public:
     nSymTen(3),
     XHX(0),
     YHX(1),
-    HXHX(0)
+    HXHX(0),
+    geometryCache_mesh_dof(NULL),
+    geometryCache_mesh_l2g(NULL),
+    geometryCache_nElements(-1),
+    geometryCache_meshGeneration(-1)
   {}
+  std::vector<double> geometryCache;
+  const double* geometryCache_mesh_dof;
+  const int* geometryCache_mesh_l2g;
+  int geometryCache_nElements;
+  int geometryCache_meshGeneration;
+
+  /**
+   * Cache the constant jacobian, inverse and determinant of affine simplices
+   *
+   * With 3 mesh DOFs per element the mapping is affine, so the element
+   * and element boundary mappings only need to interpolate the physical
+   * point once the cache holds the 9 doubles (72 bytes) per element.
+   * The cache is only used for the mesh_dof and mesh_l2g arrays it was
+   * built from, and it is rebuilt when those arrays, the element count or
+   * meshGeneration (Mesh.generation, bumped whenever the nodes move)
+   * change. Every entry point of a kernel that maps elements calls it, so
+   * none of them reads the geometry of a mesh that has since moved.
+   */
+  inline void updateGeometryCache(const int nElements,
+				  double* mesh_dof,
+				  int* mesh_l2g,
+				  double* mesh_grad_trial_ref,
+				  const int meshGeneration)
+  {
+    if (NDOF_MESH_TRIAL_ELEMENT != 3)
+      return;
+    if (meshGeneration == geometryCache_meshGeneration &&
+	mesh_dof == geometryCache_mesh_dof &&
+	mesh_l2g == geometryCache_mesh_l2g &&
+	nElements == geometryCache_nElements)
+      return;
+    double trial_ref[NDOF_MESH_TRIAL_ELEMENT],x,y;
+    for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
+      trial_ref[j] = 0.0;
+    clearGeometryCache();
+    geometryCache.resize(nElements*9);
+    for (int eN=0;eN<nElements;eN++)
+      {
+	double* g = &geometryCache[eN*9];
+	calculateMapping_element(eN,0,mesh_dof,mesh_l2g,trial_ref,mesh_grad_trial_ref,g,g[8],&g[4],x,y);
+      }
+    geometryCache_mesh_dof = mesh_dof;
+    geometryCache_mesh_l2g = mesh_l2g;
+    geometryCache_nElements = nElements;
+    geometryCache_meshGeneration = meshGeneration;
+  }
+
+  inline void clearGeometryCache()
+  {
+    geometryCache.clear();
+    geometryCache_mesh_dof = NULL;
+    geometryCache_mesh_l2g = NULL;
+    geometryCache_nElements = -1;
+    geometryCache_meshGeneration = -1;
+  }
+
+  inline bool geometryCached(const double* mesh_dof, const int* mesh_l2g) const
+  {
+    return mesh_dof == geometryCache_mesh_dof && mesh_l2g == geometryCache_mesh_l2g;
+  }
+
+  inline void loadGeometryCache(const int eN,
+				double* jac,
+				double& jacDet,
+				double* jacInv) const
+  {
+    const double* g = &geometryCache[eN*9];
+    for (int I=0;I<4;I++)
+      {
+	jac[I] = g[I];
+	jacInv[I] = g[4+I];
+      }
+    jacDet = g[8];
+  }
   inline void calculateMapping_element(const int eN,
 				       const int k,
 				       double* mesh_dof,
@@ -682,6 +867,17 @@ public:
     //mapping of reference element to physical element
     //
     x=0.0;y=0.0;
+    if (geometryCached(mesh_dof,mesh_l2g))
+      {
+	for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
+	  {
+	    int eN_j=eN*NDOF_MESH_TRIAL_ELEMENT+j;
+	    x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_ref[k*NDOF_MESH_TRIAL_ELEMENT+j];
+	    y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_ref[k*NDOF_MESH_TRIAL_ELEMENT+j];
+	  }
+	loadGeometryCache(eN,jac,jacDet,jacInv);
+	return;
+      }
     for (int I=0;I<2;I++)
       {
 	Grad_x[I]=0.0;Grad_y[I]=0.0;
@@ -788,42 +984,56 @@ public:
     //calculate mapping from the reference element to the physical element
     // 
     x=0.0;y=0.0;
-    for (int I=0;I<2;I++)
+    if (geometryCached(mesh_dof,mesh_l2g))
       {
-	Grad_x_ext[I] = 0.0;
-	Grad_y_ext[I] = 0.0;
-      }
-    for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++) 
-      { 
-	int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
-	int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
-	int ebN_local_kb_j_nSpace = ebN_local_kb_j*2;
-	/* x += mesh_dof[mesh_l2g[eN_j]*2+0]*mesh_trial_trace_ref[ebN_local_kb_j];  */
-	/* y += mesh_dof[mesh_l2g[eN_j]*2+1]*mesh_trial_trace_ref[ebN_local_kb_j];  */
-	/* for (int I=0;I<2;I++) */
-	/*   { */
-	/*     Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*2+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; */
-	/*     Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*2+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];  */
-	/*   }  */
-	x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j]; 
-	y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j]; 
-	for (int I=0;I<2;I++)
+	for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++)
 	  {
-	    Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
-	    Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; 
-	  } 
+	    int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
+	    int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
+	    x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j];
+	    y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j];
+	  }
+	loadGeometryCache(eN,jac,jacDet,jacInv);
+      }
+    else
+      {
+        for (int I=0;I<2;I++)
+          {
+    	Grad_x_ext[I] = 0.0;
+    	Grad_y_ext[I] = 0.0;
+          }
+        for (int j=0;j<NDOF_MESH_TRIAL_ELEMENT;j++) 
+          { 
+    	int eN_j = eN*NDOF_MESH_TRIAL_ELEMENT+j;
+    	int ebN_local_kb_j = ebN_local_kb*NDOF_MESH_TRIAL_ELEMENT+j;
+    	int ebN_local_kb_j_nSpace = ebN_local_kb_j*2;
+    	/* x += mesh_dof[mesh_l2g[eN_j]*2+0]*mesh_trial_trace_ref[ebN_local_kb_j];  */
+    	/* y += mesh_dof[mesh_l2g[eN_j]*2+1]*mesh_trial_trace_ref[ebN_local_kb_j];  */
+    	/* for (int I=0;I<2;I++) */
+    	/*   { */
+    	/*     Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*2+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; */
+    	/*     Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*2+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];  */
+    	/*   }  */
+    	x += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_trial_trace_ref[ebN_local_kb_j]; 
+    	y += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_trial_trace_ref[ebN_local_kb_j]; 
+    	for (int I=0;I<2;I++)
+    	  {
+    	    Grad_x_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+0]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I];
+    	    Grad_y_ext[I] += mesh_dof[mesh_l2g[eN_j]*3+1]*mesh_grad_trial_trace_ref[ebN_local_kb_j_nSpace+I]; 
+    	  } 
+          }
+        //Space Mapping Jacobian
+        jac[XX] = Grad_x_ext[X];
+        jac[XY] = Grad_x_ext[Y];
+        jac[YX] = Grad_y_ext[X];
+        jac[YY] = Grad_y_ext[Y];
+        jacDet =  jac[XX]*jac[YY] - jac[XY]*jac[YX]; 
+        oneOverJacDet = 1.0/jacDet;
+        jacInv[XX] = oneOverJacDet*jac[YY];
+        jacInv[XY] = -oneOverJacDet*jac[XY];
+        jacInv[YX] = -oneOverJacDet*jac[YX];
+        jacInv[YY] = oneOverJacDet*jac[XX];
       }
-    //Space Mapping Jacobian
-    jac[XX] = Grad_x_ext[X];
-    jac[XY] = Grad_x_ext[Y];
-    jac[YX] = Grad_y_ext[X];
-    jac[YY] = Grad_y_ext[Y];
-    jacDet =  jac[XX]*jac[YY] - jac[XY]*jac[YX]; 
-    oneOverJacDet = 1.0/jacDet;
-    jacInv[XX] = oneOverJacDet*jac[YY];
-    jacInv[XY] = -oneOverJacDet*jac[XY];
-    jacInv[YX] = -oneOverJacDet*jac[YX];
-    jacInv[YY] = oneOverJacDet*jac[XX];
     //normal
     norm_normal=0.0;
     for (int I=0;I<2;I++)
@@ -2001,6 +2211,15 @@ public:
     return tmp;
   }
 
+  inline void updateGeometryCache(const int nElements,
+				  double* mesh_dof,
+				  int* mesh_l2g,
+				  double* mesh_grad_trial_ref,
+				  const int meshGeneration)
+  {
+    mapping.updateGeometryCache(nElements,mesh_dof,mesh_l2g,mesh_grad_trial_ref,meshGeneration);
+  }
+
   inline void calculateMapping_element(const int eN,
 				       const int k,
 				       double* mesh_dof,
@@ -2832,6 +3051,15 @@ public:
     return tmp;
   }
 
+  inline void updateGeometryCache(const int nElements,
+				  double* mesh_dof,
+				  int* mesh_l2g,
+				  double* mesh_grad_trial_ref,
+				  const int meshGeneration)
+  {
+    mapping.updateGeometryCache(nElements,mesh_dof,mesh_l2g,mesh_grad_trial_ref,meshGeneration);
+  }
+
   inline void calculateMapping_element(const int eN,
 				       const int k,
 				       double* mesh_dof,
@@ -3709,6 +3937,13 @@ public:
     return tmp;
   }
 
+  inline void updateGeometryCache(const int nElements,
+				  double* mesh_dof,
+				  int* mesh_l2g,
+				  double* mesh_grad_trial_ref,
+				  const int meshGeneration)
+  {}
+
   inline void calculateMapping_element(const int eN,
 				       const int k,
 				       double* mesh_dof,
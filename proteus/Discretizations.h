@@ -0,0 +1,144 @@
+#ifndef DISCRETIZATIONS_H
+#define DISCRETIZATIONS_H
+/**
+ * The discretizations the model factories instantiate
+ *
+ * ModelFactory.h and MixedModelFactory.h compile one model
+ * specialization per entry of these lists and pick the one matching
+ * the arguments at run time. An entry of a PROTEUS_DISCRETIZATIONS_*D
+ * list is
+ *
+ *   X(nSpace, nQuadraturePoints_element, nDOF_mesh_trial_element,
+ *     nDOF_trial_element, nDOF_test_element,
+ *     nQuadraturePoints_elementBoundary, matchBoundary)
+ *
+ * and an entry of a PROTEUS_MIXED_DISCRETIZATIONS_*D list adds
+ * nDOF_v_trial_element and nDOF_v_test_element after
+ * nDOF_test_element. Entries are matched on everything but the test
+ * spaces, which are the trial spaces, and on the element boundary
+ * quadrature only if matchBoundary is 1; the first match wins.
+ *
+ * Any list can be replaced at build time, e.g. to compile only what
+ * production runs use,
+ *
+ *   PROTEUS_OPT="-D'PROTEUS_DISCRETIZATIONS_3D(X)=X(3,5,4,4,4,4,0)'"
+ *
+ * or with -include of a header defining the lists. Building with
+ * -DPROTEUS_HIGH_ORDER_DISCRETIZATIONS adds the P2, Q2 and high order
+ * quadrature specializations to the default lists.
+ */
+
+#ifdef PROTEUS_HIGH_ORDER_DISCRETIZATIONS
+#define PROTEUS_HIGH_ORDER_DISCRETIZATIONS_3D(X) \
+  X(3,8,8,8,8,9,1)                              \
+  X(3,27,8,8,8,4,1)                             \
+  X(3,27,8,8,8,9,1)                             \
+  X(3,15,10,10,10,7,1)                          \
+  X(3,8,27,27,27,4,1)                           \
+  X(3,8,27,27,27,9,1)                           \
+  X(3,27,27,27,27,4,1)                          \
+  X(3,27,27,27,27,9,1)                          \
+  X(3,5,4,10,10,4,1)                            \
+  X(3,14,4,10,10,6,1)                           \
+  X(3,31,4,10,10,12,1)
+#define PROTEUS_HIGH_ORDER_DISCRETIZATIONS_2D(X) \
+  X(2,16,3,3,3,3,1)                             \
+  X(2,36,3,3,3,3,1)                             \
+  X(2,100,3,3,3,3,1)                            \
+  X(2,112,3,3,3,5,1)                            \
+  X(2,3,3,6,6,2,1)                              \
+  X(2,4,3,6,6,3,1)                              \
+  X(2,6,3,6,6,4,1)                              \
+  X(2,112,3,6,6,5,1)
+#define PROTEUS_HIGH_ORDER_MIXED_DISCRETIZATIONS_3D(X)        \
+  X(3,4,4,4,4,4,4,3,1)                                       \
+  X(3,4,4,4,4,10,10,3,1)                                     \
+  X(3,8,8,8,8,8,8,9,1)                                       \
+  X(3,27,8,8,8,8,8,4,1)                                      \
+  X(3,27,8,8,8,8,8,9,1)                                      \
+  X(3,8,8,8,8,27,27,9,1)                                     \
+  X(3,27,8,8,8,27,27,4,1)                                    \
+  X(3,27,8,8,8,27,27,9,1)                                    \
+  X(3,15,10,10,10,10,10,7,1)                                 \
+  X(3,8,27,27,27,27,27,4,1)                                  \
+  X(3,8,27,27,27,27,27,9,1)                                  \
+  X(3,27,27,27,27,27,27,4,1)                                 \
+  X(3,27,27,27,27,27,27,9,1)                                 \
+  X(3,5,4,10,10,10,10,4,1)                                   \
+  X(3,14,4,10,10,10,10,6,1)                                  \
+  X(3,15,4,10,10,10,10,7,1)                                  \
+  X(3,24,4,10,10,10,10,12,1)                                 \
+  X(3,31,4,10,10,10,10,12,1)                                 \
+  X(3,125,8,27,27,27,27,25,1)
+#else
+#define PROTEUS_HIGH_ORDER_DISCRETIZATIONS_3D(X)
+#define PROTEUS_HIGH_ORDER_DISCRETIZATIONS_2D(X)
+#define PROTEUS_HIGH_ORDER_MIXED_DISCRETIZATIONS_3D(X)
+#endif
+
+#ifndef PROTEUS_DISCRETIZATIONS_3D
+#define PROTEUS_DISCRETIZATIONS_3D(X)           \
+  X(3,5,4,4,4,4,0)                              \
+  X(3,4,4,4,4,3,0)                              \
+  X(3,15,4,4,4,7,1)                             \
+  X(3,24,4,4,4,12,1)                            \
+  X(3,8,8,8,8,4,1)                              \
+  X(3,4,4,10,10,3,1)                            \
+  X(3,15,4,10,10,7,1)                           \
+  X(3,24,4,10,10,12,1)                          \
+  X(3,125,8,27,27,25,0)                         \
+  PROTEUS_HIGH_ORDER_DISCRETIZATIONS_3D(X)
+#endif
+
+#ifndef PROTEUS_DISCRETIZATIONS_2D
+#define PROTEUS_DISCRETIZATIONS_2D(X)           \
+  X(2,1,3,3,3,1,1)                              \
+  X(2,3,3,3,3,2,1)                              \
+  X(2,4,3,3,3,3,1)                              \
+  X(2,6,3,3,3,4,1)                              \
+  X(2,7,3,3,3,5,1)                              \
+  X(2,12,3,3,3,6,1)                             \
+  X(2,4,4,4,4,2,1)                              \
+  X(2,1,3,6,6,1,1)                              \
+  X(2,7,3,6,6,5,1)                              \
+  X(2,12,3,6,6,6,1)                             \
+  PROTEUS_HIGH_ORDER_DISCRETIZATIONS_2D(X)
+#endif
+
+#ifndef PROTEUS_DISCRETIZATIONS_1D
+#define PROTEUS_DISCRETIZATIONS_1D(X)           \
+  X(1,2,2,2,2,1,1)                              \
+  X(1,3,2,2,2,1,1)                              \
+  X(1,4,2,2,2,1,1)                              \
+  X(1,5,2,2,2,1,1)
+#endif
+
+#ifndef PROTEUS_MIXED_DISCRETIZATIONS_3D
+#define PROTEUS_MIXED_DISCRETIZATIONS_3D(X)     \
+  X(3,5,4,4,4,4,4,4,0)                          \
+  X(3,15,4,4,4,4,4,7,1)                         \
+  X(3,24,4,4,4,4,4,12,1)                        \
+  X(3,5,4,4,4,10,10,4,0)                        \
+  X(3,15,4,4,4,10,10,7,1)                       \
+  X(3,8,8,8,8,8,8,4,1)                          \
+  X(3,8,8,8,8,27,27,4,1)                        \
+  X(3,4,4,10,10,10,10,3,1)                      \
+  PROTEUS_HIGH_ORDER_MIXED_DISCRETIZATIONS_3D(X)
+#endif
+
+#ifndef PROTEUS_MIXED_DISCRETIZATIONS_2D
+#define PROTEUS_MIXED_DISCRETIZATIONS_2D(X)     \
+  X(2,1,3,3,3,3,3,1,1)                          \
+  X(2,3,3,3,3,3,3,2,1)                          \
+  X(2,4,3,3,3,3,3,3,1)                          \
+  X(2,6,3,3,3,3,3,4,1)                          \
+  X(2,7,3,3,3,3,3,5,1)                          \
+  X(2,12,3,3,3,3,3,6,1)                         \
+  X(2,4,4,4,4,4,4,2,1)                          \
+  X(2,25,4,4,4,4,4,5,1)                         \
+  X(2,1,3,3,3,6,6,1,1)                          \
+  X(2,7,3,3,3,6,6,5,1)                          \
+  X(2,12,3,3,3,6,6,6,1)                         \
+  X(2,1,3,6,6,6,6,1,1)
+#endif
+#endif
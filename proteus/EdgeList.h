@@ -0,0 +1,134 @@
+#ifndef EDGELIST_H
+#define EDGELIST_H
+#include <vector>
+#include <stdexcept>
+#include "Workspace.h"
+
+namespace proteus
+{
+  /**
+   * \brief The edges i<j of a symmetric DOF-to-DOF (CSR) sparsity pattern
+   *
+   * Each edge keeps its end points and the positions ij and ji of its two
+   * entries in the CSR value arrays, and transpose maps every position ij
+   * to ji, so the transpose of a matrix on the pattern is read from the
+   * matrix itself instead of being assembled and stored. Operators that
+   * are symmetric per edge, such as the low order graph viscosity dij,
+   * are evaluated once per edge by forEachEdge and written to both
+   * entries. Edges are processed in parallel when OpenMP is enabled; an
+   * edge writes only its own two entries, so the result does not depend
+   * on the number of threads.
+   *
+   * The list is rebuilt only when the pattern changes. The scratch only
+   * grows when the pattern does; the number of times it did is counted
+   * as in Workspace.
+   */
+  class EdgeList
+  {
+  public:
+    std::vector<int> edge_i, edge_j, edge_ij, edge_ji;
+    std::vector<int> transpose;
+
+    EdgeList():
+      numDOFs(-1),
+      nnz(-1),
+      rowptr(0),
+      colind(0),
+      nAllocations(0)
+    {}
+
+    /// build the edges of the pattern unless it is the one already built
+    inline void setPattern(int numDOFs_in, const int* rowptr_in, const int* colind_in)
+    {
+      if (numDOFs_in == numDOFs && rowptr_in == rowptr && colind_in == colind &&
+          rowptr_in[numDOFs_in] == nnz)
+        return;
+      numDOFs = numDOFs_in;
+      rowptr = rowptr_in;
+      colind = colind_in;
+      nnz = rowptr[numDOFs];
+      std::size_t nEdges = 0;
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          if (i < colind[ij])
+            nEdges++;
+      nAllocations += resizeScratch(transpose, nnz);
+      nAllocations += resizeScratch(edge_i, nEdges);
+      nAllocations += resizeScratch(edge_j, nEdges);
+      nAllocations += resizeScratch(edge_ij, nEdges);
+      nAllocations += resizeScratch(edge_ji, nEdges);
+      int e = 0;
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          {
+            const int j = colind[ij];
+            const int ji = find(j, i);
+            transpose[ij] = ji;
+            if (i < j)
+              {
+                edge_i[e] = i;
+                edge_j[e] = j;
+                edge_ij[e] = ij;
+                edge_ji[e] = ji;
+                e++;
+              }
+          }
+    }
+
+    inline int nEdges() const
+    {
+      return edge_i.size();
+    }
+
+    /// number of scratch (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+
+    /// call f(i,j,ij,ji) once for every edge i<j
+    template<class EdgeFunction>
+    inline void forEachEdge(EdgeFunction f) const
+    {
+      const int n = nEdges();
+#pragma omp parallel for schedule(static)
+      for (int e=0; e<n; e++)
+        f(edge_i[e], edge_j[e], edge_ij[e], edge_ji[e]);
+    }
+
+    /// set A_ij = A_ji = dij(i,j,ij,ji) on every edge and A_ii = 0
+    template<class Dij>
+    inline void symmetricFill(double* A, Dij dij) const
+    {
+      forEachEdge([A, &dij](int i, int j, int ij, int ji)
+                  {
+                    A[ij] = A[ji] = dij(i, j, ij, ji);
+                  });
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          if (colind[ij] == i)
+            A[ij] = 0.;
+    }
+  private:
+    int numDOFs;
+    int nnz;
+    const int* rowptr;
+    const int* colind;
+    int nAllocations;
+
+    /// the position of (i,j) in the pattern
+    inline int find(int i, int j) const
+    {
+      for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+        if (colind[ij] == j)
+          return ij;
+      throw std::invalid_argument("EdgeList: the sparsity pattern is not symmetric");
+    }
+  };
+}//proteus
+#endif
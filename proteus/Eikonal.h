@@ -0,0 +1,309 @@
+#ifndef EIKONAL_H
+#define EIKONAL_H
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "Workspace.h"
+#include "equivalent_polynomials.h"
+
+namespace proteus
+{
+  /**
+   * \brief Signed distance to the zero level set of a P1 function on simplices
+   *
+   * redistance replaces the DOF values of a P1 level set by the signed
+   * distance to its zero level set, solving |grad d| = 1 by fast marching
+   * from the interface. The DOFs of the elements the interface cuts start
+   * from their exact distance to the linear interface of the element, as
+   * computed by equivalent_polynomials::Simplex, or 0 on the DOFs where
+   * the level set vanishes. The others are accepted in increasing order
+   * of distance from a binary heap, each tentative value being the
+   * smallest first order update from the accepted DOFs of an element
+   * containing it: from one vertex, along one edge or, in 3D, across one
+   * face, the latter two only if the characteristic enters the element
+   * through the edge or face. The marching stops at bandWidth, where the
+   * remaining DOFs get max(bandWidth, tentative value). Distances known
+   * from elsewhere, e.g. from the owners of ghost DOFs, can be given as
+   * seeds: they start as tentative values, so the march only lowers them.
+   * The accepted distances can be returned, -1 marking the DOFs beyond
+   * the band, in the same form as the seeds. The DOF to element
+   * map is rebuilt only when the DOF map changes, while the coordinates are
+   * copied on every setMesh so that a moving mesh is followed; their
+   * (re)allocations are counted as in Workspace.
+   */
+  template<int nSpace>
+  class EikonalSolver
+  {
+  public:
+    static const int nN = nSpace+1;
+
+    EikonalSolver():
+      nElements(-1),
+      nDOF(-1),
+      u_l2g(0),
+      mesh_l2g(0),
+      mesh_dof(0),
+      nAllocations(0)
+    {}
+
+    /// set the P1 DOF map and the mesh, local DOF i being at local node i
+    inline void setMesh(int nElements_in, int nDOF_in, const int* u_l2g_in,
+                        const int* mesh_l2g_in, const double* mesh_dof_in)
+    {
+      mesh_l2g = mesh_l2g_in;
+      mesh_dof = mesh_dof_in;
+      if (nElements_in != nElements || nDOF_in != nDOF || u_l2g_in != u_l2g)
+        {
+          nElements = nElements_in;
+          nDOF = nDOF_in;
+          u_l2g = u_l2g_in;
+          buildDofElements();
+        }
+      nAllocations += resizeScratch(x, nDOF*3);
+      for (int eN=0; eN<nElements; eN++)
+        for (int i=0; i<nN; i++)
+          for (int I=0; I<3; I++)
+            x[u_l2g[eN*nN+i]*3+I] = mesh_dof[mesh_l2g[eN*nN+i]*3+I];
+    }
+
+    /// overwrite phi with the signed distance to its zero level set, up to bandWidth, seed and distance being optional (-1 where none)
+    inline void redistance(double* phi, double bandWidth, const double* seed=0, double* distance=0)
+    {
+      const double infinity = std::numeric_limits<double>::infinity();
+      nAllocations += resizeScratch(T, nDOF);
+      nAllocations += resizeScratch(accepted, nDOF);
+      std::fill(T.begin(), T.begin() + nDOF, infinity);
+      std::fill(accepted.begin(), accepted.begin() + nDOF, 0);
+      heap.clear();
+      for (int dof=0; dof<nDOF; dof++)
+        if (phi[dof] == 0.0)
+          T[dof] = 0.0;
+      double phi_element[nN], x_element[nN*3], xi_r[3]={0.0,0.0,0.0};
+      for (int eN=0; eN<nElements; eN++)
+        {
+          bool negative = false, positive = false;
+          for (int i=0; i<nN; i++)
+            {
+              const int dof = u_l2g[eN*nN+i];
+              phi_element[i] = phi[dof];
+              negative = negative || phi[dof] < 0.0;
+              positive = positive || phi[dof] > 0.0;
+              for (int I=0; I<3; I++)
+                x_element[i*3+I] = x[dof*3+I];
+            }
+          if (!(negative && positive))
+            continue;
+          if (cut.calculate(phi_element, x_element, xi_r, false) != 0)
+            continue;
+          for (int i=0; i<nN; i++)
+            {
+              const int dof = u_l2g[eN*nN+i];
+              T[dof] = std::min(T[dof], std::fabs(cut.phi_dof_corrected[i]));
+            }
+        }
+      if (seed)
+        for (int dof=0; dof<nDOF; dof++)
+          if (seed[dof] >= 0.0)
+            T[dof] = std::min(T[dof], seed[dof]);
+      for (int dof=0; dof<nDOF; dof++)
+        if (T[dof] < infinity)
+          push(T[dof], dof);
+      while (!heap.empty())
+        {
+          std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<double,int> >());
+          const double T_dof = heap.back().first;
+          const int dof = heap.back().second;
+          heap.pop_back();
+          if (accepted[dof] || T_dof > T[dof])
+            continue;
+          if (T_dof > bandWidth)
+            break;
+          accepted[dof] = 1;
+          for (int k=dofElementsBegin[dof]; k<dofElementsBegin[dof+1]; k++)
+            {
+              const int eN = dofElements[k];
+              for (int i=0; i<nN; i++)
+                {
+                  const int dof_i = u_l2g[eN*nN+i];
+                  if (accepted[dof_i])
+                    continue;
+                  const double T_i = update(eN, i);
+                  if (T_i < T[dof_i])
+                    {
+                      T[dof_i] = T_i;
+                      push(T_i, dof_i);
+                    }
+                }
+            }
+        }
+      for (int dof=0; dof<nDOF; dof++)
+        {
+          double d = T[dof];
+          if (distance)
+            distance[dof] = accepted[dof] ? d : -1.0;
+          if (!accepted[dof])
+            {
+              if (d < infinity)
+                d = std::max(d, bandWidth);
+              else if (bandWidth < infinity)
+                d = bandWidth;
+              else
+                d = std::fabs(phi[dof]);
+            }
+          phi[dof] = phi[dof] < 0.0 ? -d : (phi[dof] > 0.0 ? d : 0.0);
+        }
+    }
+
+    /// number of scratch (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+  private:
+    inline void buildDofElements()
+    {
+      nAllocations += resizeScratch(dofElementsBegin, nDOF+1);
+      nAllocations += resizeScratch(dofElements, nElements*nN);
+      std::fill(dofElementsBegin.begin(), dofElementsBegin.begin() + nDOF + 1, 0);
+      for (int eN=0; eN<nElements; eN++)
+        for (int i=0; i<nN; i++)
+          dofElementsBegin[u_l2g[eN*nN+i]+1]++;
+      for (int dof=0; dof<nDOF; dof++)
+        dofElementsBegin[dof+1] += dofElementsBegin[dof];
+      for (int eN=0; eN<nElements; eN++)
+        for (int i=0; i<nN; i++)
+          {
+            const int dof = u_l2g[eN*nN+i];
+            dofElements[dofElementsBegin[dof]++] = eN;
+          }
+      for (int dof=nDOF; dof>0; dof--)
+        dofElementsBegin[dof] = dofElementsBegin[dof-1];
+      dofElementsBegin[0] = 0;
+    }
+
+    inline void push(double T_dof, int dof)
+    {
+      if (heap.size() == heap.capacity())
+        nAllocations++;
+      heap.push_back(std::make_pair(T_dof, dof));
+      std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<double,int> >());
+    }
+
+    static inline double dot(const double* a, const double* b)
+    {
+      return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+
+    /// smallest update of local DOF i of element eN from the accepted DOFs of eN
+    inline double update(int eN, int i)
+    {
+      const double* x_i = &x[u_l2g[eN*nN+i]*3];
+      int known[nN-1], nKnown=0;
+      double T_i = std::numeric_limits<double>::infinity();
+      for (int j=0; j<nN; j++)
+        {
+          const int dof_j = u_l2g[eN*nN+j];
+          if (j == i || !accepted[dof_j])
+            continue;
+          known[nKnown++] = dof_j;
+          double e[3];
+          for (int I=0; I<3; I++)
+            e[I] = x_i[I] - x[dof_j*3+I];
+          T_i = std::min(T_i, T[dof_j] + std::sqrt(dot(e, e)));
+        }
+      for (int j=0; j<nKnown; j++)
+        for (int k=j+1; k<nKnown; k++)
+          T_i = std::min(T_i, edgeUpdate(x_i, known[j], known[k]));
+      if (nSpace == 3 && nKnown == 3)
+        T_i = std::min(T_i, faceUpdate(x_i, known));
+      return T_i;
+    }
+
+    /// update of x_i from the interior of the edge between DOFs j and k
+    inline double edgeUpdate(const double* x_i, int j, int k)
+    {
+      double a[3], b[3];
+      for (int I=0; I<3; I++)
+        {
+          a[I] = x[k*3+I] - x[j*3+I];
+          b[I] = x_i[I] - x[j*3+I];
+        }
+      const double c = T[k] - T[j], aa = dot(a, a), ab = dot(a, b);
+      if (c*c >= aa)
+        return std::numeric_limits<double>::infinity();
+      const double hh = std::max(dot(b, b) - ab*ab/aa, 0.0);
+      const double lambda = ab/aa - c*std::sqrt(hh/(aa*(aa - c*c)));
+      if (lambda <= 0.0 || lambda >= 1.0)
+        return std::numeric_limits<double>::infinity();
+      double d[3];
+      for (int I=0; I<3; I++)
+        d[I] = b[I] - lambda*a[I];
+      return T[j] + lambda*c + std::sqrt(dot(d, d));
+    }
+
+    /// update of x_i from the interior of the face of the three known DOFs
+    inline double faceUpdate(const double* x_i, const int* known)
+    {
+      const double infinity = std::numeric_limits<double>::infinity();
+      //rows e_j = x_j - x_i, so that E grad(d) = T_j - T_i
+      double E[9], Einv[9];
+      for (int j=0; j<3; j++)
+        for (int I=0; I<3; I++)
+          E[j*3+I] = x[known[j]*3+I] - x_i[I];
+      Einv[0] = E[4]*E[8] - E[5]*E[7];
+      Einv[1] = E[2]*E[7] - E[1]*E[8];
+      Einv[2] = E[1]*E[5] - E[2]*E[4];
+      Einv[3] = E[5]*E[6] - E[3]*E[8];
+      Einv[4] = E[0]*E[8] - E[2]*E[6];
+      Einv[5] = E[2]*E[3] - E[0]*E[5];
+      Einv[6] = E[3]*E[7] - E[4]*E[6];
+      Einv[7] = E[1]*E[6] - E[0]*E[7];
+      Einv[8] = E[0]*E[4] - E[1]*E[3];
+      const double det = E[0]*Einv[0] + E[1]*Einv[3] + E[2]*Einv[6];
+      if (det == 0.0)
+        return infinity;
+      //grad(d) = u - T_i v
+      double u[3]={0.0,0.0,0.0}, v[3]={0.0,0.0,0.0};
+      for (int I=0; I<3; I++)
+        for (int j=0; j<3; j++)
+          {
+            u[I] += Einv[I*3+j]*T[known[j]]/det;
+            v[I] += Einv[I*3+j]/det;
+          }
+      const double vv = dot(v, v), uv = dot(u, v), uu = dot(u, u);
+      const double discriminant = uv*uv - vv*(uu - 1.0);
+      if (discriminant < 0.0)
+        return infinity;
+      const double T_i = (uv + std::sqrt(discriminant))/vv;
+      if (T_i < std::max(T[known[0]], std::max(T[known[1]], T[known[2]])))
+        return infinity;
+      //the characteristic x_i - s grad(d), s > 0, crosses the face iff E^{-T} grad(d) <= 0
+      double g[3];
+      for (int I=0; I<3; I++)
+        g[I] = u[I] - T_i*v[I];
+      for (int j=0; j<3; j++)
+        if ((Einv[0*3+j]*g[0] + Einv[1*3+j]*g[1] + Einv[2*3+j]*g[2])/det > 0.0)
+          return infinity;
+      return T_i;
+    }
+
+    int nElements, nDOF;
+    const int* u_l2g;
+    const int* mesh_l2g;
+    const double* mesh_dof;
+    int nAllocations;
+    std::vector<int> dofElementsBegin, dofElements;
+    std::vector<double> x, T;
+    std::vector<char> accepted;
+    std::vector<std::pair<double,int> > heap;
+    equivalent_polynomials::Simplex<nSpace,1,1,1> cut;
+  };
+}//proteus
+#endif
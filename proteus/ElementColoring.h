@@ -0,0 +1,185 @@
+#ifndef ELEMENTCOLORING_H
+#define ELEMENTCOLORING_H
+#include <vector>
+#include <cassert>
+
+namespace proteus
+{
+  /**
+   * \brief An element-to-global-DOF map, e.g. one of the l2g arrays passed to a kernel
+   */
+  struct ElementDOFMap
+  {
+    const int* l2g;
+    int nDOF_element;
+  };
+
+  /**
+   * \brief Partition of the elements into colors whose members share no global DOF
+   *
+   * Two elements receive different colors if they touch a common entry
+   * through any of the maps used to build the coloring, so all elements
+   * of one color can be assembled concurrently into the global residual
+   * and Jacobian without atomics. Colors are stored in CSR form and the
+   * elements of each color are kept in ascending order, so a colored
+   * traversal accumulates into every DOF in the same order regardless
+   * of the number of threads.
+   */
+  class ElementColoring
+  {
+  public:
+    std::vector<int> colorOffsets;
+    std::vector<int> colorElements;
+
+    ElementColoring()
+    {
+      setSerial(0);
+    }
+
+    inline int nColors() const
+    {
+      return int(colorOffsets.size()) - 1;
+    }
+
+    inline int element(int eN_color) const
+    {
+      return colorElements.empty() ? eN_color : colorElements[eN_color];
+    }
+
+    /// one color holding every element in natural order
+    inline void setSerial(int nElements)
+    {
+      colorOffsets.assign(2, 0);
+      colorOffsets[1] = nElements;
+      colorElements.clear();
+    }
+
+    /// greedy first-fit coloring of the element graph induced by the maps
+    inline void build(int nElements, const std::vector<ElementDOFMap>& maps)
+    {
+      std::vector<int> color(nElements, -1), forbidden;
+      std::vector<std::vector<int> > dofElementsOffsets(maps.size()), dofElements(maps.size());
+      for (std::size_t m=0; m < maps.size(); m++)
+        {
+          const int* l2g = maps[m].l2g;
+          const int nDOF_element = maps[m].nDOF_element;
+          int nDOF_global=0;
+          for (int eN_i=0; eN_i < nElements*nDOF_element; eN_i++)
+            if (l2g[eN_i] + 1 > nDOF_global)
+              nDOF_global = l2g[eN_i] + 1;
+          std::vector<int>& offsets = dofElementsOffsets[m];
+          std::vector<int>& elements = dofElements[m];
+          offsets.assign(nDOF_global+1, 0);
+          for (int eN_i=0; eN_i < nElements*nDOF_element; eN_i++)
+            if (l2g[eN_i] >= 0)
+              offsets[l2g[eN_i]+1]++;
+          for (int I=0; I < nDOF_global; I++)
+            offsets[I+1] += offsets[I];
+          elements.resize(offsets[nDOF_global]);
+          std::vector<int> fill(offsets.begin(), offsets.end()-1);
+          for (int eN=0; eN < nElements; eN++)
+            for (int i=0; i < nDOF_element; i++)
+              {
+                const int I = l2g[eN*nDOF_element+i];
+                if (I >= 0)
+                  elements[fill[I]++] = eN;
+              }
+        }
+      int nColors_new=0;
+      for (int eN=0; eN < nElements; eN++)
+        {
+          for (std::size_t m=0; m < maps.size(); m++)
+            for (int i=0; i < maps[m].nDOF_element; i++)
+              {
+                const int I = maps[m].l2g[eN*maps[m].nDOF_element+i];
+                if (I < 0)
+                  continue;
+                for (int k=dofElementsOffsets[m][I]; k < dofElementsOffsets[m][I+1]; k++)
+                  {
+                    const int c = color[dofElements[m][k]];
+                    if (c >= 0)
+                      forbidden[c] = eN;
+                  }
+              }
+          int c=0;
+          while (c < nColors_new && forbidden[c] == eN)
+            c++;
+          if (c == nColors_new)
+            {
+              nColors_new++;
+              forbidden.push_back(-1);
+            }
+          color[eN] = c;
+        }
+      colorOffsets.assign(nColors_new+1, 0);
+      for (int eN=0; eN < nElements; eN++)
+        colorOffsets[color[eN]+1]++;
+      for (int c=0; c < nColors_new; c++)
+        colorOffsets[c+1] += colorOffsets[c];
+      colorElements.resize(nElements);
+      std::vector<int> fill(colorOffsets.begin(), colorOffsets.end()-1);
+      for (int eN=0; eN < nElements; eN++)
+        colorElements[fill[color[eN]]++] = eN;
+      assert(nElements == 0 || nColors_new > 0);
+    }
+  };
+
+  /**
+   * \brief A coloring stored elsewhere, e.g. the one cached on the Mesh
+   *
+   * Gives a model read access to colors in the CSR form of
+   * ElementColoring without copying them.
+   */
+  class ElementColorsView
+  {
+  public:
+    ElementColorsView()
+    {
+      setSerial(0);
+    }
+
+    inline int nColors() const
+    {
+      return nColors_;
+    }
+
+    inline int colorBegin(int color) const
+    {
+      return colorOffsets ? colorOffsets[color] : 0;
+    }
+
+    inline int colorEnd(int color) const
+    {
+      return colorOffsets ? colorOffsets[color+1] : nElements;
+    }
+
+    inline int element(int eN_color) const
+    {
+      return colorElements ? colorElements[eN_color] : eN_color;
+    }
+
+    /// one color holding every element in natural order
+    inline void setSerial(int nElements_in)
+    {
+      nColors_ = 1;
+      nElements = nElements_in;
+      colorOffsets = 0;
+      colorElements = 0;
+    }
+
+    /// view the colors; the arrays must outlive their use
+    inline void set(int nColors_in, const int* colorOffsets_in, const int* colorElements_in)
+    {
+      nColors_ = nColors_in;
+      nElements = colorOffsets_in[nColors_in];
+      colorOffsets = colorOffsets_in;
+      colorElements = colorElements_in;
+    }
+  private:
+    int nColors_;
+    int nElements;
+    const int* colorOffsets;
+    const int* colorElements;
+  };
+}//proteus
+#endif
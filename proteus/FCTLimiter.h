@@ -0,0 +1,273 @@
+#ifndef FCTLIMITER_H
+#define FCTLIMITER_H
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Workspace.h"
+
+namespace proteus
+{
+  /**
+   * \brief Flux corrected transport on the DOF-to-DOF (CSR) sparsity pattern of the edge based models
+   *
+   * Holds the antidiffusive flux matrices of one or more components in
+   * structure of arrays form (one contiguous block of NNZ values per
+   * component), the nodal Zalesak factors and an edge limiter matrix,
+   * and keeps them between calls so the limiting steps do not allocate.
+   * Every pass is a loop over the rows in which row i writes only the
+   * entries of row i and nodal value i, so the rows are distributed over
+   * threads when OpenMP is enabled. The sums over a row are taken in
+   * column order, so the result does not depend on the number of
+   * threads.
+   *
+   * The model supplies the physics through callbacks: the flux entries,
+   * the nodal bounds, and what to do with the limited sum of each row.
+   * The scratch only grows when the pattern does; the number of times
+   * it did is counted as in Workspace.
+   */
+  class FCTLimiter
+  {
+  public:
+    std::vector<double> Rpos, Rneg;
+    std::vector<double> flux;
+    std::vector<double> limiter;
+
+    FCTLimiter():
+      numDOFs(0),
+      nnz(0),
+      rowptr(0),
+      colind(0),
+      nAllocations(0)
+    {}
+
+    /// set the pattern and size the scratch for nComponents flux matrices
+    inline void setPattern(int numDOFs_in, const int* rowptr_in, const int* colind_in, int nComponents=1)
+    {
+      numDOFs = numDOFs_in;
+      rowptr = rowptr_in;
+      colind = colind_in;
+      nnz = rowptr[numDOFs];
+      nAllocations += resizeScratch(Rpos, numDOFs);
+      nAllocations += resizeScratch(Rneg, numDOFs);
+      nAllocations += resizeScratch(flux, std::size_t(nComponents)*nnz);
+    }
+
+    /// number of scratch (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+
+    inline double* componentFlux(int component)
+    {
+      return &flux[std::size_t(component)*nnz];
+    }
+
+    /// fill the flux matrix of a component, F_ij = fluxij(i,j,ij)
+    template<class Flux>
+    inline void computeFlux(int component, Flux fluxij)
+    {
+      double* F = componentFlux(component);
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          F[ij] = fluxij(i, colind[ij], ij);
+    }
+
+    /// fill the flux matrices of all components together, fluxij(i,j,ij,Fij) setting Fij[c]
+    template<int nComponents, class Flux>
+    inline void computeFluxes(Flux fluxij)
+    {
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          {
+            double Fij[nComponents];
+            fluxij(i, colind[ij], ij, Fij);
+            for (int c=0; c<nComponents; c++)
+              flux[std::size_t(c)*nnz+ij] = Fij[c];
+          }
+    }
+
+    /// extend [mini,maxi] by the values of u over row i
+    inline void rowBounds(const double* u, int i, double& mini, double& maxi) const
+    {
+      for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+        {
+          mini = fmin(mini, u[colind[ij]]);
+          maxi = fmax(maxi, u[colind[ij]]);
+        }
+    }
+
+    /**
+     * \brief Zalesak factors R^+_i = min(1,Q^+_i/P^+_i) and R^-_i = min(1,Q^-_i/P^-_i)
+     *
+     * bounds(i,Qposi,Qnegi) gives the admissible increments of row i. A
+     * row whose P is at most pTolerance times the larger of |P^+| and
+     * |P^-| is not limited.
+     */
+    template<class Bounds>
+    inline void computeR(const double* F, Bounds bounds, double pTolerance=0.0)
+    {
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        {
+          double Pposi=0., Pnegi=0.;
+          for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+            {
+              Pposi += F[ij]*((F[ij] > 0) ? 1. : 0.);
+              Pnegi += F[ij]*((F[ij] < 0) ? 1. : 0.);
+            }
+          double Qposi, Qnegi;
+          bounds(i, Qposi, Qnegi);
+          const double psmall = pTolerance*fmax(fabs(Pnegi), fabs(Pposi));
+          Rpos[i] = ((Pposi <= psmall) ? 1. : fmin(1.0, Qposi/Pposi));
+          Rneg[i] = ((Pnegi >= -psmall) ? 1. : fmin(1.0, Qnegi/Pnegi));
+        }
+    }
+
+    /// the symmetric Zalesak limiter of entry ij
+    inline double zalesak(double Fij, int i, int j) const
+    {
+      return (Fij > 0) ? fmin(Rpos[i], Rneg[j]) : fmin(Rneg[i], Rpos[j]);
+    }
+
+    /// update(i, sum_j L_ij F_ij) with the Zalesak limiter
+    template<class Update>
+    inline void limit(const double* F, Update update)
+    {
+      limit(F, update, [F](int i, int j, int ij, double Lij) { return Lij*F[ij]; });
+    }
+
+    /// update(i, sum_j edge(i,j,ij,L_ij)) with the Zalesak limiter, edge giving the limited entry
+    template<class Update, class Edge>
+    inline void limit(const double* F, Update update, Edge edge)
+    {
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        {
+          double ith_limited_flux_correction = 0.;
+          for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+            {
+              const int j = colind[ij];
+              ith_limited_flux_correction += edge(i, j, ij, zalesak(F[ij], i, j));
+            }
+          update(i, ith_limited_flux_correction);
+        }
+    }
+
+    /// set every entry of the edge limiter matrix to value
+    inline void resetLimiter(double value)
+    {
+      nAllocations += resizeScratch(limiter, nnz);
+      std::fill(limiter.begin(), limiter.end(), value);
+    }
+
+    /// L_ij = edgeLimiter(i,j,ij,L_ij) over the pattern
+    template<class EdgeLimiter>
+    inline void computeLimiter(EdgeLimiter edgeLimiter)
+    {
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+          limiter[ij] = edgeLimiter(i, colind[ij], ij, limiter[ij]);
+    }
+
+    /// update(i, sums) with sums[c] = sum_j L_ij F^c_ij from the edge limiter matrix
+    template<int nComponents, class Update>
+    inline void applyLimiter(Update update)
+    {
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<numDOFs; i++)
+        {
+          double sums[nComponents];
+          for (int c=0; c<nComponents; c++)
+            sums[c] = 0.;
+          for (int ij=rowptr[i]; ij<rowptr[i+1]; ij++)
+            for (int c=0; c<nComponents; c++)
+              sums[c] += limiter[ij]*flux[std::size_t(c)*nnz+ij];
+          update(i, sums);
+        }
+    }
+
+    /// keep the part of the fluxes not yet applied, F = (1-L)F, for another limiting pass
+    inline void reduceFlux(int nComponents)
+    {
+      for (int c=0; c<nComponents; c++)
+        {
+          double* F = componentFlux(c);
+#pragma omp parallel for schedule(static)
+          for (int ij=0; ij<nnz; ij++)
+            F[ij] = (1.0 - limiter[ij])*F[ij];
+        }
+    }
+  private:
+    int numDOFs;
+    int nnz;
+    const int* rowptr;
+    const int* colind;
+    int nAllocations;
+  };
+
+  /**
+   * \brief Largest limiter keeping uLow + l P within [umin,umax] (convex limiting of a scalar bound)
+   *
+   * Starts from l and returns it unchanged if the full increment is
+   * admissible. eps relaxes the bounds relative to their size.
+   */
+  inline double boundLimiter(double l, double uLow, double P, double umin, double umax, double eps)
+  {
+    const double denominator = 1. / (std::abs(P) + eps * umax);
+    if (uLow + P < umin)
+      l = std::min((std::abs(umin - uLow) + eps * umin) * denominator, 1.);
+    else if (umax < uLow + P)
+      l = std::min((std::abs(umax - uLow) + eps * umin) * denominator, 1.);
+    return l;
+  }
+
+  /**
+   * \brief Limiter in [0,l] keeping kinMax h - |q|^2/2 >= 0 along (h,qx,qy)Low + l (P_h,P_qx,P_qy)
+   *
+   * The kinetic energy bound is concave in l, so the admissible limiter
+   * is given by the negative root of the quadratic, with a tolerance
+   * KE_tiny, and is zero at dry states.
+   */
+  inline double kineticEnergyLimiter(double l, double hLow, double huLow, double hvLow, double kinMax,
+                                     double P_h, double P_hu, double P_hv, double KE_tiny)
+  {
+    double l_tmp = 0.;
+    const double h_r = hLow + l * P_h;
+    const double hu_r = huLow + l * P_hu;
+    const double hv_r = hvLow + l * P_hv;
+    const double psi = kinMax * h_r - 0.5 * (hu_r * hu_r + hv_r * hv_r);
+    l_tmp = (psi > -KE_tiny) ? l : l_tmp;
+
+    const double a = -0.5 * (P_hu * P_hu + P_hv * P_hv);
+    const double a_nudged = std::min(a, -KE_tiny);
+    const double b = kinMax * P_h - (huLow * P_hu + hvLow * P_hv);
+    const double c = hLow * kinMax - 0.5 * (huLow * huLow + hvLow * hvLow);
+    const double delta = b * b - 4. * a * c;
+    const double root = 0.5 / a_nudged * (-b - std::sqrt(std::abs(delta)));
+
+    double l_K = (root > 0.) ? std::min(root, l) : std::min(l_tmp, l);
+    // if the bound was already satisfied keep the larger limiter
+    l_tmp = std::max(l_tmp, l_K);
+    l_tmp = (hLow * kinMax <= KE_tiny) ? 0. : l_tmp;
+    l_tmp = std::min(l_tmp, 1.);
+    l_tmp = std::max(l_tmp, 0.);
+    return std::min(l_tmp, l);
+  }
+
+  /// relax the local bounds to [drelax umin, urelax umax] but by no more than |deltaSqd|
+  inline void relaxBounds(double drelax, double urelax, double deltaSqd, double& umin, double& umax)
+  {
+    umin = std::max(drelax * umin, umin - std::abs(deltaSqd));
+    umax = std::min(urelax * umax, umax + std::abs(deltaSqd));
+  }
+}//proteus
+#endif
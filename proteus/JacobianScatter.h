@@ -0,0 +1,65 @@
+#ifndef JACOBIANSCATTER_H
+#define JACOBIANSCATTER_H
+#include <algorithm>
+
+namespace proteus
+{
+  /**
+   * \brief Where the element loops of a Jacobian put their contributions
+   *
+   * The loops add every contribution through add(ij, I, J, value), ij
+   * being the position of entry (I,J) in the CSR value array and I, J
+   * the global row and column, i.e. the DOFs the element maps the test
+   * and trial functions to. After assemble the contribution goes to the
+   * CSR values, i.e. the Jacobian is assembled. After apply it is
+   * multiplied by x[J] and added to y[I], so the same loops compute
+   * y = J x element matrix by element matrix, without storing J or
+   * reading its sparsity pattern. A loop that may add to the same CSR
+   * value from two threads may add to the same entry of y, so the loops
+   * are as safe in both modes.
+   */
+  class JacobianScatter
+  {
+  public:
+    JacobianScatter():
+      values(0),
+      x(0),
+      y(0)
+    {}
+
+    /// add the contributions to the CSR values
+    inline void assemble(double* values_in)
+    {
+      values = values_in;
+      x = 0;
+      y = 0;
+    }
+
+    /// set y = 0 and add the contributions times x to y
+    inline void apply(int nRows, const double* x_in, double* y_in)
+    {
+      values = 0;
+      x = x_in;
+      y = y_in;
+      std::fill(y, y + nRows, 0.0);
+    }
+
+    inline bool matrixFree() const
+    {
+      return values == 0;
+    }
+
+    inline void add(int ij, int I, int J, double value)
+    {
+      if (values)
+        values[ij] += value;
+      else
+        y[I] += value*x[J];
+    }
+  private:
+    double* values;
+    const double* x;
+    double* y;
+  };
+}//proteus
+#endif
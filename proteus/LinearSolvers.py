@@ -3491,6 +3491,7 @@ class OperatorConstructor_rans2p(OperatorConstructor):
         argsDict["mesh_grad_trial_ref"] = self.model.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.model.mesh.nodeArray
         argsDict["mesh_l2g"] = self.model.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.model.mesh.generation
         argsDict["dV_ref"] = self.model.elementQuadratureWeights[('u',0)]
         argsDict["p_trial_ref"] = self.model.u[0].femSpace.psi
         argsDict["p_grad_trial_ref"] = self.model.u[0].femSpace.grad_psi
@@ -3533,6 +3534,7 @@ class OperatorConstructor_rans2p(OperatorConstructor):
         argsDict["mesh_grad_trial_ref"] = self.model.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.model.mesh.nodeArray
         argsDict["mesh_l2g"] = self.model.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.model.mesh.generation
         argsDict["dV_ref"] = self.model.elementQuadratureWeights[('u',0)]
         argsDict["p_grad_trial_ref"] = self.model.u[0].femSpace.grad_psi
         argsDict["vel_grad_trial_ref"] = self.model.u[1].femSpace.grad_psi
@@ -3605,6 +3607,7 @@ class OperatorConstructor_rans2p(OperatorConstructor):
         argsDict["&mesh_grad_trial_ref"] = self.model.u[0].femSpace.elementMaps.grad_psi
         argsDict["&mesh_dof"] = self.model.mesh.nodeArray
         argsDict["mesh_l2g"] = self.model.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.model.mesh.generation
         argsDict["dV_ref"] = self.model.elementQuadratureWeights[('u',0)]
         argsDict["p_trial_ref"] = self.model.u[0].femSpace.psi
         argsDict["p_test_ref"] = self.model.u[0].femSpace.psi
@@ -3663,6 +3666,7 @@ class OperatorConstructor_rans2p(OperatorConstructor):
         argsDict["&mesh_grad_trial_ref"] = self.model.u[0].femSpace.elementMaps.grad_psi
         argsDict["&mesh_dof"] = self.model.mesh.nodeArray
         argsDict["mesh_l2g"] = self.model.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.model.mesh.generation
         argsDict["dV_ref"] = self.model.elementQuadratureWeights[('u',0)]
         argsDict["p_trial_ref"] = self.model.u[0].femSpace.psi
         argsDict["p_test_ref"] = self.model.u[0].femSpace.psi
@@ -49,6 +49,8 @@ int MeshAdaptPUMIDrvr::constructFromSerialPUMIMesh(Mesh& mesh)
 {
   assert(m != 0);
   logEvent("Constructing global data structures",4);
+  //the connectivity is rebuilt below, so any cached coloring is stale
+  deleteElementColoring(mesh);
 
   int dim = m->getDimension();
   mesh.nElements_global = m->count(dim);
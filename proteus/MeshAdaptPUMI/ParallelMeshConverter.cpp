@@ -24,6 +24,7 @@ static int countTotal(apf::Mesh* m, int dim)
 
 int MeshAdaptPUMIDrvr::constructFromParallelPUMIMesh(Mesh& mesh, Mesh& subdomain_mesh)
 {
+  deleteElementColoring(mesh);
   mesh.subdomainp = &subdomain_mesh;
   initializeMesh(subdomain_mesh);
   if (!PCU_Comm_Self())
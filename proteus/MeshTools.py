@@ -497,6 +497,9 @@ class Mesh(object):
         This array lists the global edge number associated with every
         edge or face of an element.
     """
+    #: bumped whenever the node coordinates change, see nodesMoved; the
+    #: kernels that cache element geometry rebuild it when it differs
+    generation = 0
     #cek adding parallel support
     def __init__(self):
         #array interface
@@ -1073,7 +1076,37 @@ class Mesh(object):
         self.nElements_owned = self.nElements_global
         self.nElementBoundaries_owned = self.nElementBoundaries_global
         self.nEdges_owned = self.nEdges_global
+        self.generation += 1
         logEvent(memory("buildFromC","MeshTools"),level=4)
+    def nodesMoved(self):
+        """Record that nodeArray was changed in place, e.g. by a mesh motion model"""
+        self.generation += 1
+    def buildElementColoring(self):
+        """Color the elements and exterior element boundaries for threaded assembly
+
+        The coloring is cached on the C mesh and only rebuilt when the mesh changes.
+        """
+        from . import cmeshTools
+        (self.nElementColors,
+         self.elementColorOffsets,
+         self.elementColorsArray,
+         self.nExteriorElementBoundaryColors,
+         self.exteriorElementBoundaryColorOffsets,
+         self.exteriorElementBoundaryColorsArray) = cmeshTools.buildElementColoring(self.cmesh)
+    def generateFromBinaryFile(self,filename):
+        """Load a mesh written by :meth:`writeBinaryFile`
+
+        The topology, material types and geometric info are read as
+        stored; nothing is parsed or rebuilt.
+        """
+        from . import cmeshTools
+        self.cmesh = cmeshTools.CMesh()
+        cmeshTools.generateFromBinaryFile(self.cmesh,filename)
+        self.buildFromC(self.cmesh)
+    def writeBinaryFile(self,filename):
+        """Write the mesh in the native binary format"""
+        from . import cmeshTools
+        cmeshTools.writeBinaryFile(self.cmesh,filename)
     def buildFromCNoArrays(self,cmesh):
         from . import cmeshTools
         #
@@ -6045,6 +6078,39 @@ def readMeshXdmf(xmf_archive_base,heavy_file_base,MeshTag="Spatial_Domain",hasHD
 
     return MeshInfo
 #
+def convertToBinaryMesh(filebase,fileFormat,base=None,filename=None):
+    """
+    Read a mesh in one of the existing file formats, construct its
+    topology and geometric info, and write it in the native binary
+    format so later runs can load it with Mesh.generateFromBinaryFile.
+
+    fileFormat is one of 'tetgen', 'triangle', '3dm', '2dm' or 'hex';
+    base is the index base of the files (1 for 3dm/2dm, 0 for hex and 1
+    for tetgen/triangle by default). Returns the name of the binary file,
+    filebase+'.pmesh' unless given.
+    """
+    if fileFormat == 'tetgen':
+        mesh = TetrahedralMesh()
+        mesh.generateFromTetgenFiles(filebase,1 if base is None else base)
+    elif fileFormat == 'triangle':
+        mesh = TriangularMesh()
+        mesh.generateFromTriangleFiles(filebase,1 if base is None else base)
+    elif fileFormat == '3dm':
+        mesh = TetrahedralMesh()
+        mesh.generateFrom3DMFile(filebase,1 if base is None else base)
+    elif fileFormat == '2dm':
+        mesh = TriangularMesh()
+        mesh.generateFrom2DMFile(filebase,1 if base is None else base)
+    elif fileFormat == 'hex':
+        mesh = HexahedralMesh()
+        mesh.generateFromHexFile(filebase,0 if base is None else base)
+    else:
+        raise ValueError("unknown mesh file format "+str(fileFormat))
+    if filename is None:
+        filename = filebase+'.pmesh'
+    mesh.writeBinaryFile(filename)
+    return filename
+#
 def writeHexMesh(mesh_info,hexfile_base,index_base=0):
     """
     Write a hex mesh in Ido's format with base numbering index_base
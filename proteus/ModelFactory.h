@@ -1,6 +1,7 @@
 #ifndef MODELFACTORY_H
 #define MODELFACTORY_H
 #include <iostream>
+#include "Discretizations.h"
 
 #define NO_INSTANCE std::cout<<"Constructing model object from template class:"<<std::endl \
   <<"return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<" \
@@ -16,6 +17,16 @@
   <<nQuadraturePoints_elementBoundaryIn<<">());"                        \
   <<std::endl<<std::flush
 
+/* return the specialization of one entry of Discretizations.h if it matches the arguments */
+#define PROTEUS_ALLOCATE_MODEL(nSpace,nQuadraturePoints_element,nDOF_mesh_trial_element,nDOF_trial_element,nDOF_test_element,nQuadraturePoints_elementBoundary,matchBoundary) \
+  if (nSpaceIn == nSpace &&                                             \
+      nQuadraturePoints_elementIn == nQuadraturePoints_element &&       \
+      nDOF_mesh_trial_elementIn == nDOF_mesh_trial_element &&           \
+      nDOF_trial_elementIn == nDOF_trial_element &&                     \
+      (!matchBoundary || nQuadraturePoints_elementBoundaryIn == nQuadraturePoints_elementBoundary)) \
+    return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<nSpace,nDOF_mesh_trial_element,nDOF_trial_element,nDOF_test_element>, \
+                                    nSpace,nQuadraturePoints_element,nDOF_mesh_trial_element,nDOF_trial_element,nDOF_test_element,nQuadraturePoints_elementBoundary>());
+
 namespace proteus
 {
   template<class Model_Base,
@@ -42,170 +53,10 @@ namespace proteus
   {
     if (CompKernelFlag == 0)
       {
-        if (nSpaceIn == 3) // 3D
-          {
-            if (nDOF_mesh_trial_elementIn == nDOF_trial_elementIn)//iso-parametric
-              {
-                if (nDOF_mesh_trial_elementIn == 4) // P1 FE-space. Default nquad=5
-                  {
-                    if (nQuadraturePoints_elementIn == 5)
-                      return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,4,4>,3,5,4,4,4,4>());
-                    else if (nQuadraturePoints_elementIn == 4)
-                      return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,4,4>,3,4,4,4,4,3>());
-                    else if (nQuadraturePoints_elementIn == 15 && nQuadraturePoints_elementBoundaryIn == 7)
-                      return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,4,4>,3,15,4,4,4,7>());
-                    else if (nQuadraturePoints_elementIn == 24 && nQuadraturePoints_elementBoundaryIn == 12)
-		      return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,4,4>,3,24,4,4,4,12>());
-                    else
-                      {
-                        NO_INSTANCE;
-                        abort();
-                      }
-                  }
-                else if (nDOF_mesh_trial_elementIn == 8) // Q1 FE-space. Default nquad=27
-                  {
-		    if (nQuadraturePoints_elementIn == 8)
-		      {
-			if ( nQuadraturePoints_elementBoundaryIn == 4)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,8,8,8>,3,8,8,8,8,4>());
-			/* else if ( nQuadraturePoints_elementBoundaryIn == 9) */
-			/*   return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,8,8,8>,3,8,8,8,8,9>()); */
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 27) */
-		    /*        { */
-		    /*          if ( nQuadraturePoints_elementBoundaryIn == 4) */
-		    /*            return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,8,8,8>,3,27,8,8,8,4>()); */
-		    /*          /\* else if ( nQuadraturePoints_elementBoundaryIn == 9) *\/ */
-		    /*          /\*   return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,8,8,8>,3,27,8,8,8,9>()); *\/ */
-		    /*          else */
-		    /*            { */
-		    /*              NO_INSTANCE; */
-		    /*              abort(); */
-		    /*            } */
-		    /*        } */
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		  }
-		/* else if (nDOF_mesh_trial_elementIn == 10) // P2 FE space. Default nquad=15 */
-		/*   { */
-		/*     if (nQuadraturePoints_elementIn == 15) */
-		/*       return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,10,10,10>,3,15,10,10,10,7>()); */
-		/*     else */
-		/*       { */
-		/*         NO_INSTANCE; */
-		/*         abort(); */
-		/*       } */
-		/*   } */
-		/* else if (nDOF_mesh_trial_elementIn == 27) // Q2 FE space. Default nquad=27 */
-		/*   { */
-		/*     if (nQuadraturePoints_elementIn == 8) */
-		/*    { */
-		/*      if ( nQuadraturePoints_elementBoundaryIn == 4) */
-		/*        return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,27,27,27>,3,8,27,27,27,4>()); */
-		/*      /\* else if ( nQuadraturePoints_elementBoundaryIn == 9) *\/ */
-		/*      /\*   return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,27,27,27>,3,8,27,27,27,9>()); *\/ */
-		/*      else */
-		/*        { */
-		/*          NO_INSTANCE; */
-		/*          abort(); */
-		/*        } */
-		/*    } */
-		/* else if (nQuadraturePoints_elementIn == 27) */
-		/*        { */
-		/*          if ( nQuadraturePoints_elementBoundaryIn == 4) */
-		/*            return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,27,27,27>,3,27,27,27,27,4>()); */
-		/*          /\* else if ( nQuadraturePoints_elementBoundaryIn == 9) *\/ */
-		/*          /\*   return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,27,27,27>,3,27,27,27,27,9>()); *\/ */
-		/*          else */
-		/*            { */
-		/*              NO_INSTANCE; */
-		/*              abort(); */
-		/*            } */
-		/*        } */
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else if (nDOF_mesh_trial_elementIn == 4)//sub-parametric tets
-	      {
-		if (nDOF_trial_elementIn == 10)
-		  {
-		    if (nQuadraturePoints_elementIn == 4 && nQuadraturePoints_elementBoundaryIn == 3)
-		      {
-			return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,4,4,10,10,3>());
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 5 && nQuadraturePoints_elementBoundaryIn == 4) */
-		    /*   { */
-		    /*     return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,5,4,10,10,4>()); */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 14 && nQuadraturePoints_elementBoundaryIn == 6) */
-		    /*   { */
-		    /*     return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,14,4,10,10,6>()); */
-		    /*   } */
-		    else if (nQuadraturePoints_elementIn == 15 && nQuadraturePoints_elementBoundaryIn == 7)
-		      {
-		        return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,15,4,10,10,7>());
-		      }
-		    else if (nQuadraturePoints_elementIn == 24 && nQuadraturePoints_elementBoundaryIn == 12)
-		      {
-		        return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,24,4,10,10,12>());
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 31 && nQuadraturePoints_elementBoundaryIn == 12) */
-		    /*   { */
-		    /*     return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,4,10,10>,3,31,4,10,10,12>()); */
-		    /*   } */
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		  }
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else if (nDOF_mesh_trial_elementIn == 8)//sub-parametric hexes
-	      {
-		if (nDOF_trial_elementIn == 27)
-		  {
-		    if (nQuadraturePoints_elementIn == 125)
-		      return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<3,8,27,27>,3,125,8,27,27,25>());
-		  }
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else
-	      {
-		NO_INSTANCE;
-		abort();
-	      }
-	  }
-	else
-	  {
-	    NO_INSTANCE;
-	    abort();
-	  }
-      }
-    else
-      {
-	NO_INSTANCE;
-	abort();
+        PROTEUS_DISCRETIZATIONS_3D(PROTEUS_ALLOCATE_MODEL)
       }
+    NO_INSTANCE;
+    abort();
     return NULL;
   }
   template<class Model_Base,
@@ -232,255 +83,10 @@ namespace proteus
   {
     if (CompKernelFlag == 0)
       {
-	if (nSpaceIn == 2) // 2D
-	  {
-	    if (nDOF_mesh_trial_elementIn == nDOF_trial_elementIn)//iso-parametric
-	      {
-		if (nDOF_mesh_trial_elementIn == 3) // P1 FE-space. Default nquad=4
-		  {
-		    if (nQuadraturePoints_elementIn == 1)
-		      {
-		    	if (nQuadraturePoints_elementBoundaryIn == 1)
-		    	  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,1,3,3,3,1>());
-		    	else
-		    	  {
-		    	    NO_INSTANCE;
-		    	    abort();
-		    	  }
-		      }
-		    else if (nQuadraturePoints_elementIn == 3)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 2)
-		          return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,3,3,3,3,2>());
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    else if (nQuadraturePoints_elementIn == 4)
-		      {
-			if (nQuadraturePoints_elementBoundaryIn == 3)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,4,3,3,3,3>());
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    else if (nQuadraturePoints_elementIn == 6)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 4)
-		          return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,6,3,3,3,4>());
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    else if (nQuadraturePoints_elementIn == 7)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 5)
-		          return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,7,3,3,3,5>());
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    else if (nQuadraturePoints_elementIn == 12)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 6)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,12,3,3,3,6>());
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 112)//hk=0.25 */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 5) */
-		    /*       { */
-		    /*         return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,112,3,3,3,5>()); */
-		    /*       } */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 16)//hk=0.5 */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 3) */
-		    /*       { */
-		    /*         return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,16,3,3,3,3>()); */
-		    /*       } */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 36)//hk=0.3 */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 3) */
-		    /*       { */
-		    /*         return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,36,3,3,3,3>()); */
-		    /*       } */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 100)//hk=0.2 */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 3) */
-		    /*       { */
-		    /*         return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,3,3>,2,100,3,3,3,3>()); */
-		    /*       } */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		  }
-		else  if(nDOF_mesh_trial_elementIn == 4)
-		  {
-		    if (nQuadraturePoints_elementIn == 4) // Q1 FE-space
-		      {
-			if (nQuadraturePoints_elementBoundaryIn == 2)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,4,4,4>,2,4,4,4,4,2>());
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		  }
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else if (nDOF_mesh_trial_elementIn == 3)
-	      {
-		if (nDOF_trial_elementIn == 6) // P2 FE-space. Default nquad=7
-		  {
-		    if (nQuadraturePoints_elementIn == 1)
-		      {
-			if (nQuadraturePoints_elementBoundaryIn == 1)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,1,3,6,6,1>());
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 3) */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 2) */
-		    /*       return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,3,3,6,6,2>()); */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 4) */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 3) */
-		    /*       return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,4,3,6,6,3>()); */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    /* else if (nQuadraturePoints_elementIn == 6) */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 4) */
-		    /*       return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,6,3,6,6,4>()); */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    else if (nQuadraturePoints_elementIn == 7)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 5)
-		          {
-		            return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,7,3,6,6,5>());
-		          }
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    else if (nQuadraturePoints_elementIn == 12)
-		      {
-		        if (nQuadraturePoints_elementBoundaryIn == 6)
-		          {
-			    return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,12,3,6,6,6>());
-		          }
-		        else
-		          {
-		            NO_INSTANCE;
-		            abort();
-		          }
-		      }
-		    /* else if (nQuadraturePoints_elementIn == 112) */
-		    /*   { */
-		    /*     if (nQuadraturePoints_elementBoundaryIn == 5) */
-		    /*       { */
-		    /*         return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<2,3,6,6>,2,112,3,6,6,5>()); */
-		    /*       } */
-		    /*     else */
-		    /*       { */
-		    /*         NO_INSTANCE; */
-		    /*         abort(); */
-		    /*       } */
-		    /*   } */
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		    
-		  }
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else
-	      {
-		NO_INSTANCE;
-		abort();
-	      }
-	  }
-      }
-    else
-      {
-	NO_INSTANCE;
-	abort();
+        PROTEUS_DISCRETIZATIONS_2D(PROTEUS_ALLOCATE_MODEL)
       }
+    NO_INSTANCE;
+    abort();
     return NULL;
   }
   template<class Model_Base,
@@ -507,81 +113,10 @@ namespace proteus
   {
     if (CompKernelFlag == 0)
       {
-	if (nSpaceIn == 1) // 1D
-	  {
-	    if (nDOF_mesh_trial_elementIn == nDOF_trial_elementIn)//iso-parametric
-	      {
-		if (nDOF_mesh_trial_elementIn == 2) // P1 FE-space. Default nquad=4
-		  {
-		    if (nQuadraturePoints_elementIn == 2)
-		      {
-		    	if (nQuadraturePoints_elementBoundaryIn == 1)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<1,2,2,2>,1,2,2,2,2,1>());
-		    	else
-		    	  {
-		    	    NO_INSTANCE;
-		    	    abort();
-		    	  }
-		      }
-		    else if (nQuadraturePoints_elementIn == 3)
-		      {
-		    	if (nQuadraturePoints_elementBoundaryIn == 1)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<1,2,2,2>,1,3,2,2,2,1>());
-		    	else
-		    	  {
-		    	    NO_INSTANCE;
-		    	    abort();
-		    	  }
-		      }
-		    else if (nQuadraturePoints_elementIn == 4)
-		      {
-			if (nQuadraturePoints_elementBoundaryIn == 1)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<1,2,2,2>,1,4,2,2,2,1>());
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    else if (nQuadraturePoints_elementIn == 5)
-		      {
-			if (nQuadraturePoints_elementBoundaryIn == 1)
-			  return static_cast<Model_Base*>(new ModelTemplate<CompKernelTemplate<1,2,2,2>,1,5,2,2,2,1>());
-			else
-			  {
-			    NO_INSTANCE;
-			    abort();
-			  }
-		      }
-		    else
-		      {
-			NO_INSTANCE;
-			abort();
-		      }
-		  }
-		else
-		  {
-		    NO_INSTANCE;
-		    abort();
-		  }
-	      }
-	    else
-	      {
-		NO_INSTANCE;
-		abort();
-	      }
-	  }
-	else
-	  {
-	    NO_INSTANCE;
-	    abort();
-	  }
-      }
-    else
-      {
-	NO_INSTANCE;
-	abort();
+        PROTEUS_DISCRETIZATIONS_1D(PROTEUS_ALLOCATE_MODEL)
       }
+    NO_INSTANCE;
+    abort();
     return NULL;
   }
 }
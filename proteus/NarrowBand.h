@@ -0,0 +1,144 @@
+#ifndef NARROWBAND_H
+#define NARROWBAND_H
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "Workspace.h"
+
+namespace proteus
+{
+  /**
+   * \brief The elements within a few layers of the zero level set
+   *
+   * build marks the elements whose DOF values of the level set change
+   * sign or vanish, then nLayers layers of the elements sharing a DOF
+   * with the previous layer, and lists the marked elements in increasing
+   * order so the loops over the band visit them in mesh order. It also
+   * sets isActiveDOF to 1 on the DOFs of the band elements and to 0 on
+   * the others, including the DOFs the band shares with the elements
+   * outside it. The models hold the latter fixed, i.e. the solution is
+   * frozen outside the band and on its rim, which acts as a Dirichlet
+   * boundary, until the band is rebuilt, normally once per time step.
+   * Since the layers grow through the DOFs, the rim lies on the outermost
+   * layer only, and nLayers >= 1 keeps every DOF of the cut elements
+   * active. The scratch only grows with the mesh; the number of times it
+   * did is counted as in Workspace.
+   */
+  class NarrowBand
+  {
+  public:
+    NarrowBand():
+      nAllocations(0)
+    {}
+
+    /// rebuild the band from the sign of u_dof
+    inline void build(int nElements, int nDOF_element, const int* l2g,
+                      const double* u_dof, int nLayers,
+                      int nDOF, double* isActiveDOF)
+    {
+      if (nLayers < 1)
+        throw std::invalid_argument("NarrowBand: nLayers must be at least 1 to keep the cut elements active");
+      buildStar(nElements, nDOF_element, l2g, nDOF);
+      nAllocations += resizeScratch(inBand, nElements);
+      std::fill(inBand.begin(), inBand.end(), 0);
+      elements.clear();
+      for (int eN=0; eN<nElements; eN++)
+        {
+          bool negative = false, positive = false;
+          for (int i=0; i<nDOF_element; i++)
+            {
+              const double u = u_dof[l2g[eN*nDOF_element+i]];
+              negative = negative || u <= 0.0;
+              positive = positive || u >= 0.0;
+            }
+          if (negative && positive)
+            mark(eN);
+        }
+      std::size_t layerBegin = 0;
+      for (int layer=0; layer<nLayers; layer++)
+        {
+          const std::size_t layerEnd = elements.size();
+          for (std::size_t n=layerBegin; n<layerEnd; n++)
+            for (int i=0; i<nDOF_element; i++)
+              {
+                const int I = l2g[elements[n]*nDOF_element+i];
+                for (int k=starBegin[I]; k<starBegin[I+1]; k++)
+                  if (!inBand[star[k]])
+                    mark(star[k]);
+              }
+          layerBegin = layerEnd;
+        }
+      std::sort(elements.begin(), elements.end());
+      std::fill(isActiveDOF, isActiveDOF + nDOF, 0.0);
+      for (std::size_t n=0; n<elements.size(); n++)
+        for (int i=0; i<nDOF_element; i++)
+          isActiveDOF[l2g[elements[n]*nDOF_element+i]] = 1.0;
+      for (int eN=0; eN<nElements; eN++)
+        if (!inBand[eN])
+          for (int i=0; i<nDOF_element; i++)
+            isActiveDOF[l2g[eN*nDOF_element+i]] = 0.0;
+    }
+
+    /// number of elements in the band
+    inline int size() const
+    {
+      return elements.size();
+    }
+
+    /// the n-th element of the band
+    inline int element(int n) const
+    {
+      return elements[n];
+    }
+
+    inline bool contains(int eN) const
+    {
+      return inBand[eN];
+    }
+
+    /// number of scratch (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+  private:
+    /// the elements around each DOF, in CSR form
+    inline void buildStar(int nElements, int nDOF_element, const int* l2g, int nDOF)
+    {
+      nAllocations += resizeScratch(starBegin, nDOF + 1);
+      nAllocations += resizeScratch(star, nElements*nDOF_element);
+      std::fill(starBegin.begin(), starBegin.begin() + nDOF + 1, 0);
+      for (int k=0; k<nElements*nDOF_element; k++)
+        starBegin[l2g[k]+1]++;
+      for (int I=0; I<nDOF; I++)
+        starBegin[I+1] += starBegin[I];
+      for (int eN=0; eN<nElements; eN++)
+        for (int i=0; i<nDOF_element; i++)
+          {
+            const int I = l2g[eN*nDOF_element+i];
+            star[starBegin[I]++] = eN;
+          }
+      for (int I=nDOF; I>0; I--)
+        starBegin[I] = starBegin[I-1];
+      starBegin[0] = 0;
+    }
+
+    inline void mark(int eN)
+    {
+      inBand[eN] = 1;
+      if (elements.size() == elements.capacity())
+        nAllocations++;
+      elements.push_back(eN);
+    }
+    std::vector<int> elements;
+    std::vector<char> inBand;
+    std::vector<int> starBegin, star;
+    int nAllocations;
+  };
+}//proteus
+#endif
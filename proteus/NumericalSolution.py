@@ -760,6 +760,7 @@ class NS_base(object):  # (HasTraits):
                         for m in model.levelModelList:
                             if m.movingDomain and m.tLast_mesh != self.systemStepController.t_system_last:
                                 m.t_mesh = self.systemStepController.t_system_last
+                                m.mesh.nodesMoved()
                                 m.updateAfterMeshMotion()
                                 m.tLast_mesh = m.t_mesh
 
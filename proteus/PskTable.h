@@ -0,0 +1,230 @@
+#ifndef PSKTABLE_H
+#define PSKTABLE_H
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include "Workspace.h"
+
+namespace proteus
+{
+  /**
+   * van Genuchten-Mualem relations of x = alpha*psi_c > 0
+   *
+   * Sets value to the effective saturation S = (1 + x^n)^-m, m = 1 - 1/n,
+   * and the relative permeabilities krw = sqrt(S)(1 - x^(n-1) S)^2 and
+   * krn = sqrt(1-S)(x^(n-1) S)^2, and derivative to their x derivatives.
+   * 1-S is computed without cancellation where S is close to 1.
+   */
+  inline void vanGenuchtenMualem(double x, double n, double value[3], double derivative[3])
+  {
+    const double m = 1.0 - 1.0/n,
+      x_nM1 = std::pow(x, n - 1.0),
+      x_n = x_nM1*x,
+      S = std::pow(1.0 + x_n, -m),
+      oneMinusS = -std::expm1(-m*std::log1p(x_n)),
+      dS = (1.0 - n)*x_nM1*S/(1.0 + x_n),
+      u = x_nM1*S,
+      du = (n - 1.0)*x_nM1/x*S + x_nM1*dS,
+      v = 1.0 - u,
+      sqrtS = std::sqrt(S),
+      sqrt_oneMinusS = std::sqrt(oneMinusS);
+    value[0] = S;
+    value[1] = sqrtS*v*v;
+    value[2] = sqrt_oneMinusS*u*u;
+    derivative[0] = dS;
+    derivative[1] = 0.5/sqrtS*dS*v*v - 2.0*sqrtS*v*du;
+    derivative[2] = sqrt_oneMinusS > 0.0 ? -0.5/sqrt_oneMinusS*dS*u*u + 2.0*sqrt_oneMinusS*u*du : 0.0;
+  }
+
+  /**
+   * \brief Tables of the van Genuchten-Mualem relations of each material
+   *
+   * build tabulates S, krw and krn of x = alpha*psi_c (see
+   * vanGenuchtenMualem) on 2^xMinExponent <= x < 2^xMaxExponent, where
+   * they are power laws of x at both ends, so the cells are uniform within
+   * each binade of x: a cell is found from the exponent and the leading
+   * bits of the mantissa of x, without a search or a transcendental. Each
+   * cell holds the cubic Hermite interpolant of the values and exact x
+   * derivatives at its ends, and evaluate returns the interpolant and its
+   * derivative, so the Jacobian of a model stays consistent with its
+   * residual. The number of cells per binade is doubled until the largest
+   * error measured at a quarter, half and three quarters of every cell is
+   * below the tolerance, up to 2^maxRefinement cells. The error reached is
+   * kept in maxError. Outside the tables the relations are evaluated
+   * analytically. The tables are rebuilt only when the parameters change;
+   * their (re)allocations are counted as in Workspace.
+   */
+  class VanGenuchtenTable
+  {
+  public:
+    static const int nFunctions = 3;
+    static const int xMinExponent = -26;
+    static const int xMaxExponent = 20;
+    static const int maxRefinement = 10;
+
+    VanGenuchtenTable():
+      tolerance(-1.0),
+      error(0.0),
+      nAllocations(0)
+    {}
+
+    /// tabulate the relations of the materials with exponents n to within tolerance
+    inline void build(int nMaterials, const double* n_in, double tolerance_in)
+    {
+      if (tolerance_in == tolerance && int(n.size()) == nMaterials &&
+          std::equal(n.begin(), n.end(), n_in))
+        return;
+      tolerance = tolerance_in;
+      error = 0.0;
+      nAllocations += resizeScratch(n, nMaterials);
+      nAllocations += resizeScratch(refinement, nMaterials);
+      nAllocations += resizeScratch(offset, nMaterials + 1);
+      std::copy(n_in, n_in + nMaterials, n.begin());
+      cells.clear();
+      offset[0] = 0;
+      for (int material=0; material<nMaterials; material++)
+        {
+          double materialError = 0.0;
+          for (int k=1; k<=maxRefinement; k++)
+            {
+              cells.resize(offset[material]);
+              tabulate(material, k);
+              materialError = measureError(material);
+              if (materialError <= tolerance)
+                break;
+            }
+          error = std::max(error, materialError);
+          offset[material+1] = cells.size();
+        }
+    }
+
+    /// whether x is within the tables
+    static inline bool covers(double x)
+    {
+      return x >= std::ldexp(1.0, xMinExponent) && x < std::ldexp(1.0, xMaxExponent);
+    }
+
+    /// the relations of material at x from its table, or analytically outside it
+    inline void evaluate(int material, double x, double value[nFunctions], double derivative[nFunctions]) const
+    {
+      if (!covers(x))
+        {
+          vanGenuchtenMualem(x, n[material], value, derivative);
+          return;
+        }
+      uint64_t bits;
+      std::memcpy(&bits, &x, sizeof(double));
+      const int k = refinement[material], fractionBits = 52 - k;
+      const uint64_t cell = (bits >> fractionBits) - (uint64_t(1023 + xMinExponent) << k);
+      const double t = std::ldexp(double(bits & ((uint64_t(1) << fractionBits) - 1)), -fractionBits);
+      const double* c = &cells[offset[material] + cell*nCellValues];
+      for (int f=0; f<nFunctions; f++)
+        {
+          const double* cf = c + 1 + 4*f;
+          value[f] = cf[0] + t*(cf[1] + t*(cf[2] + t*cf[3]));
+          derivative[f] = (cf[1] + t*(2.0*cf[2] + 3.0*t*cf[3]))*c[0];
+        }
+    }
+
+    /// evaluate at nPoints points, function f of point i going to value[f*nPoints+i]
+    inline void evaluate(int material, int nPoints, const double* x, double* value, double* derivative) const
+    {
+      for (int i=0; i<nPoints; i++)
+        {
+          double value_i[nFunctions], derivative_i[nFunctions];
+          evaluate(material, x[i], value_i, derivative_i);
+          for (int f=0; f<nFunctions; f++)
+            {
+              value[f*nPoints + i] = value_i[f];
+              derivative[f*nPoints + i] = derivative_i[f];
+            }
+        }
+    }
+
+    /// largest interpolation error measured over the tables
+    inline double maxError() const
+    {
+      return error;
+    }
+
+    /// log2 of the number of cells per binade in the table of material
+    inline int cellsPerBinadeExponent(int material) const
+    {
+      return refinement[material];
+    }
+
+    /// number of scratch (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+  private:
+    //per cell 1/width, then the coefficients in t of the cubic of each function
+    static const int nCellValues = 1 + 4*nFunctions;
+
+    /// left end of cell j of a table with 2^k cells per binade
+    static inline double knot(int k, int j)
+    {
+      const int binade = j >> k, K = 1 << k;
+      return std::ldexp(1.0 + double(j - binade*K)/K, xMinExponent + binade);
+    }
+
+    inline void tabulate(int material, int k)
+    {
+      refinement[material] = k;
+      const int nCells = (xMaxExponent - xMinExponent) << k;
+      if (cells.size() + nCells*nCellValues > cells.capacity())
+        nAllocations++;
+      double value0[nFunctions], derivative0[nFunctions], value1[nFunctions], derivative1[nFunctions];
+      vanGenuchtenMualem(knot(k, 0), n[material], value0, derivative0);
+      for (int j=0; j<nCells; j++)
+        {
+          const double x0 = knot(k, j), x1 = knot(k, j+1), h = x1 - x0;
+          vanGenuchtenMualem(x1, n[material], value1, derivative1);
+          cells.push_back(1.0/h);
+          for (int f=0; f<nFunctions; f++)
+            {
+              const double y0 = value0[f], y1 = value1[f], m0 = h*derivative0[f], m1 = h*derivative1[f];
+              cells.push_back(y0);
+              cells.push_back(m0);
+              cells.push_back(3.0*(y1 - y0) - 2.0*m0 - m1);
+              cells.push_back(2.0*(y0 - y1) + m0 + m1);
+              value0[f] = value1[f];
+              derivative0[f] = derivative1[f];
+            }
+        }
+    }
+
+    inline double measureError(int material) const
+    {
+      const int k = refinement[material], nCells = (xMaxExponent - xMinExponent) << k;
+      double maxError = 0.0;
+      for (int j=0; j<nCells; j++)
+        for (int q=1; q<4; q++)
+          {
+            const double x = knot(k, j) + 0.25*q*(knot(k, j+1) - knot(k, j));
+            double value[nFunctions], derivative[nFunctions], value_table[nFunctions], derivative_table[nFunctions];
+            vanGenuchtenMualem(x, n[material], value, derivative);
+            evaluate(material, x, value_table, derivative_table);
+            for (int f=0; f<nFunctions; f++)
+              maxError = std::max(maxError, std::fabs(value_table[f] - value[f]));
+          }
+      return maxError;
+    }
+
+    double tolerance, error;
+    int nAllocations;
+    std::vector<double> n;
+    std::vector<int> refinement;
+    std::vector<std::size_t> offset;
+    std::vector<double> cells;
+  };
+}//proteus
+#endif
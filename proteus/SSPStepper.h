@@ -0,0 +1,145 @@
+#ifndef SSPSTEPPER_H
+#define SSPSTEPPER_H
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace proteus
+{
+  /**
+   * \brief Time step and stage bookkeeping of the explicit SSP Runge-Kutta steps of the edge based models
+   *
+   * Reproduces, operation by operation, what the Python RKEV integrators
+   * (choose_dt, updateStage, updateTimeHistory) and the stepExact rule
+   * of Sequential_MinModelStep do between the kernel calls, so a model
+   * can take whole steps natively and still get the same solution as
+   * the Python driven steps. The arrays of each component are passed as
+   * tables of pointers, nComponents of them.
+   */
+  template<int nComponents>
+  class SSPStepper
+  {
+  public:
+    SSPStepper(int timeOrder_in, int n_in, double* tmp_in):
+      timeOrder(timeOrder_in),
+      n(n_in),
+      tmp(tmp_in)
+    {
+      if (timeOrder < 1 || timeOrder > 3)
+        throw std::invalid_argument("SSPStepper: timeOrder must be 1, 2 or 3");
+    }
+
+    /// the RKEV time step for the largest CFL number maxCFL, growing by at most dtRatioMax
+    static inline double chooseDt(double runCFL, double maxCFL, double dtLast, double dtRatioMax)
+    {
+      maxCFL = std::max(1.0e-6, maxCFL);
+      double dt = runCFL/maxCFL;
+      if (dt/dtLast > dtRatioMax)
+        dt = dtLast*dtRatioMax;
+      if (!(dt > 1.0e-8))
+        throw std::runtime_error("Time step is probably getting too small");
+      return dt;
+    }
+
+    /// shorten dt so that a step from tLast lands on tOut or leaves at least half a step before it
+    static inline double stepExact(double tLast, double dt, double tOut, double stepExactEps=1.0e-12)
+    {
+      if (dt > 0.0)
+        {
+          if (tLast + dt >= tOut*(1.0 - stepExactEps))
+            dt = tOut - tLast;
+          else if (tOut - (tLast + dt) < dt/2.0)
+            dt = (tOut - tLast)/2.0;
+        }
+      return dt;
+    }
+
+    /**
+     * \brief Combine the solution of stage lstage (1 based) with the one at the start of the step
+     *
+     * u holds the solution just computed, uLast the one at the start of
+     * the step, uStage the stage values and uOld the state the next stage
+     * starts from. With lastStageFromLast the last stage leaves uOld at
+     * uLast (SW2DCV) instead of the combined state (GN_SW2DCV).
+     */
+    inline void updateStage(int lstage, double* const* u, double* const* uOld,
+                            double* const* uLast, double* const* uStage,
+                            bool lastStageFromLast) const
+    {
+      if (timeOrder == 1)
+        return;
+      const bool lastStage = (lstage == timeOrder);
+      for (int c=0; c<nComponents; c++)
+        {
+          if (lstage == 1)
+            std::copy(u[c], u[c]+n, uStage[c]);
+          else if (timeOrder == 3 && lstage == 2)
+            combine(uStage[c], u[c], 1./4., uLast[c], 3./4.);
+          else if (timeOrder == 3)
+            combine(uStage[c], u[c], 2.0/3.0, uLast[c], 1.0/3.0);
+          else
+            combine(uStage[c], u[c], 1./2., uLast[c], 1./2.);
+          if (lastStage)
+            std::copy(uStage[c], uStage[c]+n, u[c]);
+          const double* next = (lastStage && lastStageFromLast) ? uLast[c] : uStage[c];
+          std::copy(next, next+n, uOld[c]);
+        }
+    }
+  private:
+    int timeOrder;
+    int n;
+    double* tmp;
+
+    /// a = a_u u + a_v v, rounded like the numpy update a = u; a *= a_u; a += a_v*v
+    inline void combine(double* a, const double* u, double a_u, const double* v, double a_v) const
+    {
+      //separate passes so the products are rounded before the sum, as in numpy
+      for (int i=0; i<n; i++)
+        a[i] = u[i]*a_u;
+      for (int i=0; i<n; i++)
+        tmp[i] = a_v*v[i];
+      for (int i=0; i<n; i++)
+        a[i] += tmp[i];
+    }
+  };
+
+  /// dof[i] = u[offset + stride i], the component of the global vector (setUnknowns without Dirichlet DOFs)
+  inline void gatherComponent(const double* u, int offset, int stride, int n, double* dof)
+  {
+    for (int i=0; i<n; i++)
+      dof[i] = u[offset + stride*i];
+  }
+
+  /// u[offset + stride i] = dof[i]
+  inline void scatterComponent(const double* dof, int offset, int stride, int n, double* u)
+  {
+    for (int i=0; i<n; i++)
+      u[offset + stride*i] = dof[i];
+  }
+
+  /// keep only the tangential part of the discharge at the reflecting boundary DOFs
+  inline void reflectDischarge(const int* index, int nIndex, const double* normalx, const double* normaly,
+                               double* hu, double* hv)
+  {
+    for (int k=0; k<nIndex; k++)
+      {
+        const int i = index[k];
+        const double vt = hu[i]*normaly[i] - hv[i]*normalx[i];
+        hu[i] = vt*normaly[i];
+        hv[i] = -vt*normalx[i];
+      }
+  }
+
+  /// throw if the water height is negative beyond eps times its maximum
+  inline void checkWaterHeight(const double* h, int n, double eps)
+  {
+    if (n == 0)
+      return;
+    const double hMin = *std::min_element(h, h+n);
+    const double hMax = *std::max_element(h, h+n);
+    if (!(hMin >= -eps*hMax))
+      throw std::runtime_error("Negative water height: " + std::to_string(hMin));
+  }
+}//proteus
+#endif
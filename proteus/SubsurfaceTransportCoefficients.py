@@ -993,6 +993,8 @@ class TwophaseDarcyFlow_base(TC_base):
                                     'rho_0':1.205,#Air   kg/m^3
                                     'psi_0':0.0,
                                     'beta':0.0}
+    #the psk evaluations with a psk_model='VGMtable' branch
+    supports_psk_table = False
     def __init__(self,
                  nd=1,
                  dimensionless_gravity=[-1.0],
@@ -1050,24 +1052,29 @@ class TwophaseDarcyFlow_base(TC_base):
                         'VGB':2,
                         'BCM':3,
                         'BCB':4,
-                        'PSKspline':5}
+                        'PSKspline':5,
+                        'VGMtable':6}#VGM tabulated, psic formulations only
         self.psk_tolerances={'default':{'eps_small':1.0e-16},
-                             'VGM':{'eps_small':1.0e-16,'ns_del':1.0e-8}}
+                             'VGM':{'eps_small':1.0e-16,'ns_del':1.0e-8},
+                             'VGMtable':{'eps_small':1.0e-16,'ns_del':1.0e-8,'table':1.0e-8}}
         for psk_model_id in self.psk_types:
             if psk_model_id not in self.psk_tolerances:
                 self.psk_tolerances[psk_model_id] = self.psk_tolerances['default']
         self.nPskTolerances=1
         assert(self.psk_model in list(self.psk_types.keys()))
+        assert self.psk_model != 'VGMtable' or self.supports_psk_table, 'psk_model VGMtable is not implemented for %s' % self.__class__.__name__
         self.nMaterialTypes = nMaterialTypes
         #psk rwork array lengths
         self.nPSKsplineKnots = nPSKsplineKnots
         self.iwork_psk = numpy.zeros((2,),'i')
         if self.psk_model == 'simp':
             self.nPskParams=2
-        elif self.psk_model in ['VGM','VGB']:
+        elif self.psk_model in ['VGM','VGB','VGMtable']:
             self.nPskParams=4
             if self.psk_model == 'VGM':
                 self.nPskTolerances=2
+            elif self.psk_model == 'VGMtable':
+                self.nPskTolerances=3
         elif self.psk_model in ['BCM','BCB']:
             self.nPskParams=4
         elif self.psk_model in ['PSKspline']:
@@ -1151,7 +1158,7 @@ class TwophaseDarcyFlow_base(TC_base):
             for Sw_min,Sw_max,i in zip(Sw_min_types,Sw_max_types,list(range(self.nMaterialTypes))):
                 self.rwork_psk[i,0] = Sw_min
                 self.rwork_psk[i,1] = Sw_max
-        elif self.psk_model in ['VGM','VGB']:
+        elif self.psk_model in ['VGM','VGB','VGMtable']:
             assert(vg_alpha_types is not None and vg_m_types  is not None)
             assert self.nPskParams == 4
             self.rwork_psk = numpy.zeros((self.nMaterialTypes,self.nPskParams),'d')
@@ -1654,6 +1661,7 @@ class TwophaseDarcy_fc_pp(TwophaseDarcyFlow_base):
 
     # """
     from proteus.cTwophaseDarcyCoefficients import twophaseDarcy_fc_pp_sd_het_matType
+    supports_psk_table = True
     def __init__(self,
                  nd=1,
                  dimensionless_gravity=[-1.0],
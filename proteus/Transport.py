@@ -1872,6 +1872,17 @@ class OneLevelTransport(NonlinearEquation):
                         raise RuntimeError("Jacobian has a zero row because sparse matrix has no diagonal entry at row "+repr(global_dofN)+". You probably need add diagonal mass or reaction term")
         self.nonlinear_function_jacobian_evaluations += 1
         return jacobian
+    def setIdentityRows(self,isActiveDOF):
+        """
+        Replace the Jacobian rows of the DOFs where isActiveDOF is 0 by identity rows
+
+        The row of each nonzero is computed once per sparsity pattern.
+        """
+        if self.csrRows is None:
+            self.csrRows = numpy.repeat(numpy.arange(self.rowptr.shape[0]-1,dtype='i'),numpy.diff(self.rowptr))
+            self.csrDiagonal = numpy.where(self.colind == self.csrRows,1.0,0.0)
+        frozen = isActiveDOF[self.csrRows] == 0.0
+        self.nzval[frozen] = self.csrDiagonal[frozen]
     def getJacobian_dense(self,jacobian):
         import copy
         jacobian.fill(0.0)
@@ -4464,6 +4475,7 @@ class OneLevelTransport(NonlinearEquation):
                     self.colind[self.rowptr[I]+columnOffset]=J
             self.nzval = numpy.zeros((self.nnz,),'d')
         #end first pass at translation to C, return rowptr,nnz,colind, connection list can be replaced by colind and rowptr
+        self.csrRows = None
         if self.matType == superluWrappers.SparseMatrix:
             self.jacobian = SparseMat(self.nFreeVDOF_global,self.nFreeVDOF_global,self.nnz,self.nzval,self.colind,self.rowptr)
         elif self.matType == numpy.array:
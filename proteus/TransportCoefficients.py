@@ -6539,6 +6539,7 @@ class MovingMesh(TC_base):
 #                 self.mesh.nodeArray[nN,1]+=self.modelList[-1].u[1].dof[nN]
             self.mesh.nodeArray[:,0]+=self.modelList[-1].u[0].dof
             self.mesh.nodeArray[:,1]+=self.modelList[-1].u[1].dof
+            self.mesh.nodesMoved()
             self.mesh.computeGeometricInfo()
         copyInstructions = {}
         return copyInstructions
@@ -0,0 +1,68 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+namespace proteus
+{
+  /// resize v to n entries, returning true if the storage had to grow
+  template<class T>
+  inline bool resizeScratch(std::vector<T>& v, std::size_t n)
+  {
+    const bool grows = n > v.capacity();
+    v.resize(n);
+    return grows;
+  }
+
+  /**
+   * \brief Fixed set of scratch arrays owned by a model and reused across kernel calls
+   *
+   * Each slot is a contiguous array of doubles that keeps its storage
+   * between calls, so it is only reallocated when a call asks for more
+   * entries than the slot has held so far (i.e. when the mesh or the
+   * sparsity pattern changes). The number of such allocations is counted
+   * so the model can report it per time step; once the sizes have
+   * settled it stays at zero.
+   */
+  template<int nArrays>
+  class Workspace
+  {
+  public:
+    Workspace():
+      nAllocations(0)
+    {}
+
+    /// the n entries of a slot, holding whatever the last call left in them
+    inline double* array(int slot, std::size_t n)
+    {
+      assert(slot >= 0 && slot < nArrays);
+      if (resizeScratch(arrays[slot], n))
+        nAllocations++;
+      return arrays[slot].data();
+    }
+
+    /// the n entries of a slot, set to value
+    inline double* array(int slot, std::size_t n, double value)
+    {
+      double* a = array(slot, n);
+      std::fill(a, a+n, value);
+      return a;
+    }
+
+    /// number of slot (re)allocations since the last resetAllocations
+    inline int allocations() const
+    {
+      return nAllocations;
+    }
+
+    inline void resetAllocations()
+    {
+      nAllocations = 0;
+    }
+  private:
+    std::vector<double> arrays[nArrays];
+    int nAllocations;
+  };
+}//proteus
+#endif
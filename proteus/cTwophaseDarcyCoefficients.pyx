@@ -23,6 +23,8 @@ cdef extern from "pskRelations.h":
         pass
     cdef cppclass VGM:
         pass
+    cdef cppclass VGMTabulated:
+        pass
     cdef cppclass VGB:
         pass
     cdef cppclass BCB:
@@ -850,6 +852,46 @@ def twophaseDarcy_fc_pp_sd_het_matType(int pskModelFlag,
                                                                                           <double*>(an.data),
                                                                                           <double*>(dan_dpsiw.data),
                                                                                           <double*>(dan_dpsic.data))
+        elif pskModelFlag == 6:
+            tpdc.twophaseDarcy_fc_pp_sd_het_matType[VGMTabulated,ExponentialDensity,ExponentialDensity](nSimplex,
+                                                                                                   nPointsPerSimplex,
+                                                                                                   g.shape[0],
+                                                                                                   4,
+                                                                                                   <int*>(rowptr.data),
+                                                                                                   <int*>(colind.data),
+                                                                                                   <int*>(matType.data),
+                                                                                                   muw,
+                                                                                                   mun,
+                                                                                                   <double*>(omega.data),
+                                                                                                   <double*>(Kbar.data),
+                                                                                                   b,
+                                                                                                   <double*>(rwork_psk.data),
+                                                                                                   <int*>(iwork_psk.data),
+                                                                                                   <double*>(rwork_psk_tol.data),
+                                                                                                   <double*>(rwork_density_w.data),
+                                                                                                   <double*>(rwork_density_n.data),
+                                                                                                   <double*>(g.data),
+                                                                                                   <double*>(x.data),
+                                                                                                   <double*>(psiw.data),
+                                                                                                   <double*>(psic.data),
+                                                                                                   <double*>(sw.data),
+                                                                                                   <double*>(mw.data),
+                                                                                                   <double*>(dmw_dpsiw.data),
+                                                                                                   <double*>(dmw_dpsic.data),
+                                                                                                   <double*>(mn.data),
+                                                                                                   <double*>(dmn_dpsiw.data),
+                                                                                                   <double*>(dmn_dpsic.data),
+                                                                                                   <double*>(phi_psiw.data),
+                                                                                                   <double*>(dphi_psiw_dpsiw.data),
+                                                                                                   <double*>(phi_psin.data),
+                                                                                                   <double*>(dphi_psin_dpsiw.data),
+                                                                                                   <double*>(dphi_psin_dpsic.data),
+                                                                                                   <double*>(aw.data),
+                                                                                                   <double*>(daw_dpsiw.data),
+                                                                                                   <double*>(daw_dpsic.data),
+                                                                                                   <double*>(an.data),
+                                                                                                   <double*>(dan_dpsiw.data),
+                                                                                                   <double*>(dan_dpsic.data))
         else:
             tpdc.twophaseDarcy_fc_pp_sd_het_matType[SimplePSK,ExponentialDensity,ExponentialDensity](nSimplex,
                                                                                                 nPointsPerSimplex,
@@ -971,6 +1013,46 @@ def twophaseDarcy_fc_pp_sd_het_matType(int pskModelFlag,
                                                                                        <double*>(an.data),
                                                                                        <double*>(dan_dpsiw.data),
                                                                                        <double*>(dan_dpsic.data))
+        elif pskModelFlag == 6:
+            tpdc.twophaseDarcy_fc_pp_sd_het_matType[VGMTabulated,ExponentialDensity,IdealGasDensity](nSimplex,
+                                                                                                nPointsPerSimplex,
+                                                                                                g.shape[0],
+                                                                                                4,
+                                                                                                <int*>(rowptr.data),
+                                                                                                <int*>(colind.data),
+                                                                                                <int*>(matType.data),
+                                                                                                muw,
+                                                                                                mun,
+                                                                                                <double*>(omega.data),
+                                                                                                <double*>(Kbar.data),
+                                                                                                b,
+                                                                                                <double*>(rwork_psk.data),
+                                                                                                <int*>(iwork_psk.data),
+                                                                                                <double*>(rwork_psk_tol.data),
+                                                                                                <double*>(rwork_density_w.data),
+                                                                                                <double*>(rwork_density_n.data),
+                                                                                                <double*>(g.data),
+                                                                                                <double*>(x.data),
+                                                                                                <double*>(psiw.data),
+                                                                                                <double*>(psic.data),
+                                                                                                <double*>(sw.data),
+                                                                                                <double*>(mw.data),
+                                                                                                <double*>(dmw_dpsiw.data),
+                                                                                                <double*>(dmw_dpsic.data),
+                                                                                                <double*>(mn.data),
+                                                                                                <double*>(dmn_dpsiw.data),
+                                                                                                <double*>(dmn_dpsic.data),
+                                                                                                <double*>(phi_psiw.data),
+                                                                                                <double*>(dphi_psiw_dpsiw.data),
+                                                                                                <double*>(phi_psin.data),
+                                                                                                <double*>(dphi_psin_dpsiw.data),
+                                                                                                <double*>(dphi_psin_dpsic.data),
+                                                                                                <double*>(aw.data),
+                                                                                                <double*>(daw_dpsiw.data),
+                                                                                                <double*>(daw_dpsic.data),
+                                                                                                <double*>(an.data),
+                                                                                                <double*>(dan_dpsiw.data),
+                                                                                                <double*>(dan_dpsic.data))
         else:
             tpdc.twophaseDarcy_fc_pp_sd_het_matType[SimplePSK,ExponentialDensity,IdealGasDensity](nSimplex,
                                                                                                nPointsPerSimplex,
@@ -53,6 +53,13 @@ cdef class CMesh:
         cdef np.ndarray nodeMaterialTypes,
         cdef np.ndarray nodeArray,
 
+        cdef int nElementColors,
+        cdef int nExteriorElementBoundaryColors,
+        cdef np.ndarray elementColorOffsets,
+        cdef np.ndarray elementColorsArray,
+        cdef np.ndarray exteriorElementBoundaryColorOffsets,
+        cdef np.ndarray exteriorElementBoundaryColorsArray,
+
         cdef int nx
         cdef int ny
         cdef int nz      #NURBS
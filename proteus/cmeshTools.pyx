@@ -101,6 +101,33 @@ cdef class CMesh:
         self.sigmaMax = self.mesh.sigmaMax
         self.volume = self.mesh.volume
 
+    def buildElementColoring(self):
+        cppm.constructElementColoring(self.mesh)
+        self.nElementColors = self.mesh.nElementColors
+        self.nExteriorElementBoundaryColors = self.mesh.nExteriorElementBoundaryColors
+        self.elementColorOffsets = np.asarray(<int[:self.mesh.nElementColors+1]> self.mesh.elementColorOffsets)
+        if self.mesh.nElements_global:
+            self.elementColorsArray = np.asarray(<int[:self.mesh.nElements_global]> self.mesh.elementColorsArray)
+        else:
+            self.elementColorsArray = np.empty(0, dtype=np.int32)
+        if self.mesh.exteriorElementBoundaryColorOffsets != NULL:
+            self.exteriorElementBoundaryColorOffsets = np.asarray(<int[:self.mesh.nExteriorElementBoundaryColors+1]> self.mesh.exteriorElementBoundaryColorOffsets)
+        else:
+            self.exteriorElementBoundaryColorOffsets = np.zeros(1, dtype=np.int32)
+        if self.mesh.nExteriorElementBoundaries_global and self.mesh.exteriorElementBoundaryColorsArray != NULL:
+            self.exteriorElementBoundaryColorsArray = np.asarray(<int[:self.mesh.nExteriorElementBoundaries_global]> self.mesh.exteriorElementBoundaryColorsArray)
+        else:
+            self.exteriorElementBoundaryColorsArray = np.empty(0, dtype=np.int32)
+
+    def deleteElementColoring(self):
+        cppm.deleteElementColoring(self.mesh)
+        self.nElementColors = 0
+        self.nExteriorElementBoundaryColors = 0
+        self.elementColorOffsets = None
+        self.elementColorsArray = None
+        self.exteriorElementBoundaryColorOffsets = None
+        self.exteriorElementBoundaryColorsArray = None
+
     def buildPythonMeshInterfaceNoArrays(self):
         cdef int dim1
         self.nElements_global = self.mesh.nElements_global
@@ -196,6 +223,19 @@ def buildPythonMeshInterfaceNoArrays(cmesh):
             cmesh.sigmaMax,
             cmesh.volume)
 
+def buildElementColoring(cmesh):
+    """
+    color the elements and exterior element boundaries of cmesh so that
+    members of a color share no node; the coloring is cached on the mesh
+    """
+    cmesh.buildElementColoring()
+    return (cmesh.nElementColors,
+            cmesh.elementColorOffsets,
+            cmesh.elementColorsArray,
+            cmesh.nExteriorElementBoundaryColors,
+            cmesh.exteriorElementBoundaryColorOffsets,
+            cmesh.exteriorElementBoundaryColorsArray)
+
 cdef CMesh CMesh_FromMesh(cppm.Mesh mesh):
     CMeshnew = CMesh()
     CMeshnew.mesh = mesh
@@ -363,6 +403,28 @@ cpdef void writeTetgenFiles(CMesh cmesh,
     cppm.reorientTetrahedralMesh(cmesh.mesh);
     failed = cppm.writeTetgenMesh(cmesh.mesh,filebase.encode('utf8'),base);
 
+def generateFromBinaryFile(CMesh cmesh,
+                           unicode filename):
+    """
+    load a fully constructed mesh, including geometric info, from a file
+    written by writeBinaryFile
+    """
+    cdef int failed
+    failed = cppm.readBinaryMesh(cmesh.mesh,filename.encode('utf8'))
+    if failed:
+        raise IOError("could not read binary mesh file "+filename)
+
+def writeBinaryFile(CMesh cmesh,
+                    unicode filename):
+    """
+    write the mesh topology, material types and geometric info in the
+    native binary format
+    """
+    cdef int failed
+    failed = cppm.writeBinaryMesh(cmesh.mesh,filename.encode('utf8'))
+    if failed:
+        raise IOError("could not write binary mesh file "+filename)
+
 cpdef void write3dmFiles(CMesh cmesh,
                         unicode filebase,
                         int base):
@@ -14,6 +14,14 @@ if not PROTEUS_OPT:
 else:
     PROTEUS_OPT=PROTEUS_OPT.split()
 
+#set PROTEUS_OPENMP=1 to build the threaded element assembly
+if os.getenv('PROTEUS_OPENMP'):
+    PROTEUS_OPENMP_COMPILE_ARGS=['-fopenmp']
+    PROTEUS_OPENMP_LINK_ARGS=['-fopenmp']
+else:
+    PROTEUS_OPENMP_COMPILE_ARGS=[]
+    PROTEUS_OPENMP_LINK_ARGS=[]
+
 PROTEUS_INCLUDE_DIR = pjoin(prefix, 'include')
 PROTEUS_LIB_DIR = pjoin(prefix, 'lib')
 
@@ -12,6 +12,7 @@
 #include "proteus_blas.h"
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "Workspace.h"
 #include "mohrCoulomb.h"
 #include "mohrCoulomb2.h"
 #include "vonMises.h"
@@ -32,6 +33,7 @@ namespace proteus
             virtual ~ElastoPlastic_base(){}
             virtual void calculateResidual(arguments_dict& args)=0;
             virtual void calculateJacobian(arguments_dict& args)=0;
+            virtual void evaluateYieldFunction(arguments_dict& args)=0;
     };
 
     template<class CompKernelType,
@@ -63,6 +65,19 @@ namespace proteus
                       ZHX,ZHY,
                       HXHX,HXHY,
                       HYHX,HYHY;
+                /**
+                 * The consistent tangent dstress of the last residual at
+                 * each element quadrature point, with the inputs of the
+                 * return mapping it came from: the material type, strain0,
+                 * strain_last, Delta_strain and plasticStrain_last (slot 1),
+                 * and the material properties (slot 2). The residual always
+                 * runs the return mapping and gets the analytic tangent of
+                 * the yield function along with the stress, so a Newton
+                 * Jacobian at the same displacement takes it from here
+                 * instead of repeating the return mapping.
+                 */
+                Workspace<3> tangents;
+                int nTangents;
 
                 ElastoPlastic():
                     ck(),
@@ -81,7 +96,8 @@ namespace proteus
                     YHX(ei.YHX),YHY(ei.YHY),
                     ZHX(ei.ZHX),ZHY(ei.ZHY),
                     HXHX(ei.HXHX),HXHY(ei.HXHY),
-                    HYHX(ei.HYHX),HYHY(ei.HYHY)
+                    HYHX(ei.HYHX),HYHY(ei.HYHY),
+                    nTangents(0)
             {}
 
                 inline void calculateStrain(double* D, double* strain)
@@ -240,6 +256,28 @@ namespace proteus
                             stress_3);
                 }
 
+                /// f, df, r and dr of the materialProperties at each of the stresses, with dr[k+nSymTen*j] the derivative of r[k] by stress[j]
+                void evaluateYieldFunction(arguments_dict& args)
+                {
+                    xt::pyarray<double>& materialProperties = args.array<double>("materialProperties");
+                    xt::pyarray<double>& stress = args.array<double>("stress");
+                    xt::pyarray<double>& f = args.array<double>("f");
+                    xt::pyarray<double>& df = args.array<double>("df");
+                    xt::pyarray<double>& r = args.array<double>("r");
+                    xt::pyarray<double>& dr = args.array<double>("dr");
+                    double stress_3;
+                    for (std::size_t k=0;k<f.size();k++)
+                    {
+                        evaluateConstitutiveModel(materialProperties.data(),
+                                &stress.data()[k*nSymTen],
+                                f.data()[k],
+                                &df.data()[k*nSymTen],
+                                &r.data()[k*nSymTen],
+                                &dr.data()[k*nSymTen*nSymTen],
+                                stress_3);
+                    }
+                }
+
                 inline void differenceJacobian(const double* materialProperties,const double* stress,const double& f,double *df, const double* r, double* dr)
                 {
                     double f_delta,
@@ -264,6 +302,63 @@ namespace proteus
                                stress_plus_delta[j] = stress[j];
                            }
                 }
+                /// the inputs of the return mapping at a quadrature point other than the material properties
+                inline void tangentKey(int materialType, const double* strain0, const double* strain_last,
+                        const double* Delta_strain, const double* plasticStrain_last, double* key)
+                {
+                    key[0] = materialType;
+                    for (int i=0;i<nSymTen;i++)
+                    {
+                        key[1+i] = strain0[i];
+                        key[1+nSymTen+i] = strain_last[i];
+                        key[1+2*nSymTen+i] = Delta_strain[i];
+                        key[1+3*nSymTen+i] = plasticStrain_last[i];
+                    }
+                }
+
+                /// start caching the tangents of nQuadraturePoints_global points for the materialProperties
+                inline void resetTangents(int nQuadraturePoints_global, const double* materialProperties, int nMaterialPropertiesTotal)
+                {
+                    nTangents = nQuadraturePoints_global;
+                    tangents.array(0,std::size_t(nTangents)*nSymTen*nSymTen);
+                    tangents.array(1,std::size_t(nTangents)*(1+4*nSymTen),-1.0);
+                    double* properties = tangents.array(2,nMaterialPropertiesTotal);
+                    std::copy(materialProperties,materialProperties+nMaterialPropertiesTotal,properties);
+                }
+
+                inline void storeTangent(int eN_k, int materialType, const double* strain0, const double* strain_last,
+                        const double* Delta_strain, const double* plasticStrain_last, const double* dstress)
+                {
+                    const int nKey=1+4*nSymTen;
+                    tangentKey(materialType,strain0,strain_last,Delta_strain,plasticStrain_last,
+                            tangents.array(1,std::size_t(nTangents)*nKey)+eN_k*nKey);
+                    std::copy(dstress,dstress+nSymTen*nSymTen,tangents.array(0,std::size_t(nTangents)*nSymTen*nSymTen)+eN_k*nSymTen*nSymTen);
+                }
+
+                /// whether the cached tangents are of nQuadraturePoints_global points and of the materialProperties
+                inline bool tangentsMatch(int nQuadraturePoints_global, const double* materialProperties, int nMaterialPropertiesTotal)
+                {
+                    if (nTangents != nQuadraturePoints_global)
+                        return false;
+                    const double* properties = tangents.array(2,nMaterialPropertiesTotal);
+                    return std::equal(materialProperties,materialProperties+nMaterialPropertiesTotal,properties);
+                }
+
+                /// copy the cached tangent of eN_k to dstress if it came from the same inputs
+                inline bool cachedTangent(int eN_k, int materialType, const double* strain0, const double* strain_last,
+                        const double* Delta_strain, const double* plasticStrain_last, double* dstress)
+                {
+                    const int nKey=1+4*nSymTen;
+                    double key[1+4*nSymTen];
+                    tangentKey(materialType,strain0,strain_last,Delta_strain,plasticStrain_last,key);
+                    const double* cachedKey = tangents.array(1,std::size_t(nTangents)*nKey)+eN_k*nKey;
+                    if (!std::equal(key,key+nKey,cachedKey))
+                        return false;
+                    const double* cached = tangents.array(0,std::size_t(nTangents)*nSymTen*nSymTen)+eN_k*nSymTen*nSymTen;
+                    std::copy(cached,cached+nSymTen*nSymTen,dstress);
+                    return true;
+                }
+
                 inline void evaluateCoefficients(int usePicard,
                         const double pore_pressure,
                         const double* materialProperties,
@@ -970,6 +1065,7 @@ namespace proteus
                             //std::cout<<"nElements_global"<<nElements_global<<std::endl;
                             //std::cout<<"nQuadraturePoints_element"<<nQuadraturePoints_element<<std::endl;
                             const int usePicard = 0;
+                            resetTangents(nElements_global*nQuadraturePoints_element,materialProperties.data(),materialProperties.size());
                             for(int eN=0;eN<nElements_global;eN++)
                             {
                                 //declare local storage for element residual and initialize
@@ -1087,6 +1183,7 @@ namespace proteus
                                                          stress[i] -= pore_pressure;
                                                  }
                                                  else
+                                                 {
                                                      evaluateCoefficients(usePicard,
                                                              pore_pressure,
                                                              &materialProperties.data()[materialTypes.data()[eN]*nMaterialProperties],
@@ -1097,6 +1194,14 @@ namespace proteus
                                                              &q_plasticStrain.data()[eN_k*nSymTen],
                                                              stress,
                                                              dstress);
+                                                     storeTangent(eN_k,
+                                                             materialTypes.data()[eN],
+                                                             &q_strain0.data()[eN_k*nSymTen],
+                                                             &q_strain_last.data()[eN_k*nSymTen],
+                                                             Delta_strain,
+                                                             &q_plasticStrain_last.data()[eN_k*nSymTen],
+                                                             dstress);
+                                                 }
                                                  for (int i=0;i<nSymTen;i++)
                                                  {
                                                      q_strain.data()[eN_k*nSymTen+i] = q_strain_last.data()[eN_k*nSymTen + i] + Delta_strain[i];
@@ -1425,6 +1530,8 @@ namespace proteus
                             //
                             //loop over elements to compute volume integrals and load them into the element Jacobians and global Jacobian
                             //
+                            const bool reuseTangents = usePicard == 0 &&
+                                tangentsMatch(nElements_global*nQuadraturePoints_element,materialProperties.data(),materialProperties.size());
                             for(int eN=0;eN<nElements_global;eN++)
                             {
                                 double
@@ -1542,7 +1649,13 @@ namespace proteus
                                         for (int i=0; i<nSpace; i++)
                                             stress[i] -= pore_pressure;
                                     }
-                                    else
+                                    else if (!(reuseTangents && cachedTangent(eN_k,
+                                                    materialTypes.data()[eN],
+                                                    &q_strain0.data()[eN_k*nSymTen],
+                                                    &q_strain_last.data()[eN_k*nSymTen],
+                                                    Delta_strain,
+                                                    &q_plasticStrain_last.data()[eN_k*nSymTen],
+                                                    dstress)))
                                         evaluateCoefficients(usePicard,
                                                 pore_pressure,
                                                 &materialProperties.data()[materialTypes.data()[eN]*nMaterialProperties],
@@ -24,6 +24,7 @@ PYBIND11_MODULE(cElastoPlastic, m)
 
     py::class_<ElastoPlastic_base>(m, "cElastoPlastic_base")
         .def(py::init(&proteus::newElastoPlastic))
-        .def("calculateResidual", &ElastoPlastic_base::calculateResidual)
-        .def("calculateJacobian", &ElastoPlastic_base::calculateJacobian);
+        .def("calculateResidual", &ElastoPlastic_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &ElastoPlastic_base::calculateJacobian, proteus::release_gil())
+        .def("evaluateYieldFunction", &ElastoPlastic_base::evaluateYieldFunction, proteus::release_gil());
 }
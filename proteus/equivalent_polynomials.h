@@ -4,6 +4,8 @@
 #include <cassert>
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <algorithm>
 #include "equivalent_polynomials_coefficients.h"
 #include "equivalent_polynomials_coefficients_quad.h"
 #include "equivalent_polynomials_utils.h"
@@ -94,6 +96,16 @@ namespace equivalent_polynomials
     {
       return calculate(phi_dof, phi_nodes, xi_r, 1.0,1.0, isBoundary, false);
     }
+
+    //same as above for element eN, but the element quadrature of a cut
+    //element is reused as long as the arguments of the last call for eN
+    //are the same; uncut elements are only classified, never cached
+    inline int calculate(int eN, const double* phi_dof, const double* phi_nodes, const double* xi_r, double ma, double mb, bool isBoundary, bool scale);
+
+    inline int calculate(int eN, const double* phi_dof, const double* phi_nodes, const double* xi_r, bool isBoundary)
+    {
+      return calculate(eN, phi_dof, phi_nodes, xi_r, 1.0,1.0, isBoundary, false);
+    }
     
     inline void set_quad(unsigned int q)
     {
@@ -184,6 +196,13 @@ namespace equivalent_polynomials
     double _H[nQ], _ImH[nQ], _D[nQ], _va[nQ*nN], _vb[nQ*nN];
     double _H_ebq[nEBQ], _ImH_ebq[nEBQ], _D_ebq[nEBQ], _va_ebq[nEBQ*nN], _vb_ebq[nEBQ*nN];//cek hack: this is confusing because we use no suffice for the q arrays and _ebq for the ebq arrays, then use _q above for generic quad point
     inline void _calculate_basis_coefficients(const double ma, const double mb);
+    //cut element cache: per entry the arguments, then the element quadrature
+    static const unsigned int nCacheKey=nN*4 + nQ*nSpace + 3,
+      nCacheValue=2 + 3*nQ + 2*nQ*nN + 6*nN + nSpace + nN;
+    std::vector<int> cacheEntry;
+    std::vector<int> freeCacheEntries;
+    std::vector<double> cache;
+    inline void _cache(bool save, double* value);
     inline void _calculate_basis(const double* xi,double* va, double* vb)
     {
       //2D specific but won't break in 3D
@@ -762,6 +781,99 @@ namespace equivalent_polynomials
     return icase;
   }
 
+  template<int nSpace, int nP, int nQ, int nEBQ>
+  inline void Simplex<nSpace,nP,nQ,nEBQ>::_cache(bool save, double* value)
+  {
+    double* state[] = {_H, _ImH, _D, _va, _vb, _va_x, _va_y, _va_z, _vb_x, _vb_y, _vb_z, level_set_normal, phi_dof_corrected};
+    const unsigned int size[] = {nQ, nQ, nQ, nQ*nN, nQ*nN, nN, nN, nN, nN, nN, nN, nSpace, nN};
+    if (save)
+      {
+        value[0] = inside_out;
+        value[1] = quad_cut;
+      }
+    else
+      {
+        inside_out = value[0];
+        quad_cut = value[1];
+      }
+    value += 2;
+    for (unsigned int k=0; k < 13; k++)
+      {
+        if (save)
+          std::copy(state[k], state[k] + size[k], value);
+        else
+          std::copy(value, value + size[k], state[k]);
+        value += size[k];
+      }
+  }
+
+  template<int nSpace, int nP, int nQ, int nEBQ>
+  inline int Simplex<nSpace,nP,nQ,nEBQ>::calculate(int eN, const double* phi_dof, const double* phi_nodes, const double* xi_r, double ma, double mb, bool isBoundary, bool scale)
+  {
+    //the boundary quadrature points change with the boundary, so only the element quadrature is cached
+    if (isBoundary)
+      return calculate(phi_dof, phi_nodes, xi_r, ma, mb, isBoundary, scale);
+    if (eN >= int(cacheEntry.size()))
+      cacheEntry.resize(eN+1, -1);
+    int& entry = cacheEntry[eN];
+    //same classification as _calculate_permutation
+    const double eps=1.0e-8;
+    unsigned int pcount=0, ncount=0;
+    for (unsigned int i=0; i < nN; i++)
+      {
+        pcount += phi_dof[i] > eps;
+        ncount += phi_dof[i] < -eps;
+      }
+    double key[nCacheKey];
+    if (pcount < nN && ncount < nN)
+      {
+        std::copy(phi_dof, phi_dof + nN, key);
+        std::copy(phi_nodes, phi_nodes + nN*3, key + nN);
+        for (unsigned int q=0; q < nQ; q++)
+          std::copy(xi_r + q*3, xi_r + q*3 + nSpace, key + nN*4 + q*nSpace);
+        key[nCacheKey - 3] = ma;
+        key[nCacheKey - 2] = mb;
+        key[nCacheKey - 1] = scale;
+        if (entry >= 0)
+          {
+            double* cached = &cache[entry*(nCacheKey + nCacheValue)];
+            if (std::equal(key, key + nCacheKey, cached))
+              {
+                _cache(false, cached + nCacheKey);
+                set_quad(0);
+                return 0;
+              }
+          }
+      }
+    int icase = calculate(phi_dof, phi_nodes, xi_r, ma, mb, isBoundary, scale);
+    if (icase != 0)
+      {
+        if (entry >= 0)
+          {
+            freeCacheEntries.push_back(entry);
+            entry = -1;
+          }
+        return icase;
+      }
+    if (entry < 0)
+      {
+        if (freeCacheEntries.empty())
+          {
+            entry = cache.size()/(nCacheKey + nCacheValue);
+            cache.resize(cache.size() + nCacheKey + nCacheValue);
+          }
+        else
+          {
+            entry = freeCacheEntries.back();
+            freeCacheEntries.pop_back();
+          }
+      }
+    double* cached = &cache[entry*(nCacheKey + nCacheValue)];
+    std::copy(key, key + nCacheKey, cached);
+    _cache(true, cached + nCacheKey);
+    return icase;
+  }
+
   template<int nSpace, int nP, int nQ, int nEBQ>
   class GeneralizedFunctions_mix
   {
@@ -793,6 +905,20 @@ namespace equivalent_polynomials
       return calculate(phi_dof, phi_nodes, xi_r, 1.0,1.0,isBoundary, false);
     }
 
+    //cached version of the above for element eN, see Simplex
+    inline int calculate(int eN, const double* phi_dof, const double* phi_nodes, const double* xi_r, double ma, double mb, bool isBoundary, bool scale)
+    {
+      if(useExact)
+        return exact.calculate(eN, phi_dof, phi_nodes, xi_r, ma, mb,isBoundary,scale);
+      else
+        return calculate(phi_dof, phi_nodes, xi_r, ma, mb,isBoundary,scale);
+    }
+
+    inline int calculate(int eN, const double* phi_dof, const double* phi_nodes, const double* xi_r, bool isBoundary)
+    {
+      return calculate(eN, phi_dof, phi_nodes, xi_r, 1.0,1.0,isBoundary, false);
+    }
+
     inline double* get_normal()
     {
       if(useExact)
@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include "ElementColoring.h"
 #include "PyEmbeddedFunctions.h"
 #define DEBUG_REFINE
 /**
@@ -44,6 +45,10 @@ static double CurrentTime(void)
 #include <iostream>
 #include <fstream>
 #include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 //mwftodo decide where to put mesh type tags
 const int DEFAULT_ELEMENT_MATERIAL=0;
@@ -53,6 +58,500 @@ const int EXTERIOR_NODE_MATERIAL=1;
 const int INTERIOR_ELEMENT_BOUNDARY_MATERIAL=0;
 const int EXTERIOR_ELEMENT_BOUNDARY_MATERIAL=1;
 
+#if defined(_OPENMP) && defined(__GLIBCXX__)
+#include <parallel/algorithm>
+#define MESH_SORT __gnu_parallel::sort
+#else
+#define MESH_SORT std::sort
+#endif
+
+/* An element boundary seen from one of its elements, keyed by its sorted node numbers */
+template<int nNodes>
+struct ElementBoundaryKey
+{
+  int nodes[nNodes];
+  int eN,ebN_element;
+};
+
+template<int nNodes>
+inline bool operator<(const ElementBoundaryKey<nNodes>& left, const ElementBoundaryKey<nNodes>& right)
+{
+  for (int i=0;i<nNodes;i++)
+    if (left.nodes[i] != right.nodes[i])
+      return left.nodes[i] < right.nodes[i];
+  if (left.eN != right.eN)
+    return left.eN < right.eN;
+  return left.ebN_element < right.ebN_element;
+}
+
+template<int nNodes>
+inline bool sameNodes(const ElementBoundaryKey<nNodes>& left, const ElementBoundaryKey<nNodes>& right)
+{
+  for (int i=0;i<nNodes;i++)
+    if (left.nodes[i] != right.nodes[i])
+      return false;
+  return true;
+}
+
+/*
+  Build the element boundary arrays by sorting the boundaries of all
+  elements instead of inserting them into a std::map<NodeTuple>. The
+  numbering is the same as the map based construction: element boundaries
+  are numbered in lexicographic order of their sorted nodes, the left
+  element is the first element containing the boundary and the interior
+  and exterior boundary lists are ascending. localNodes[ebN] gives the
+  local nodes of element boundary ebN, which are used for
+  elementBoundaryNodesArray if sortedNodes is false.
+*/
+template<int nNodes_elementBoundary>
+static void constructElementBoundaries(Mesh& mesh, const int (*localNodes)[nNodes_elementBoundary], bool sortedNodes)
+{
+  typedef ElementBoundaryKey<nNodes_elementBoundary> Key;
+  const int nElementBoundaries_element = mesh.nElementBoundaries_element,
+    nNodes_element = mesh.nNodes_element;
+  const long nKeys = long(mesh.nElements_global)*nElementBoundaries_element;
+  std::vector<Key> keys(nKeys);
+#pragma omp parallel for
+  for (int eN=0;eN<mesh.nElements_global;eN++)
+    for (int ebN=0;ebN<nElementBoundaries_element;ebN++)
+      {
+        Key& key = keys[long(eN)*nElementBoundaries_element+ebN];
+        for (int nN=0;nN<nNodes_elementBoundary;nN++)
+          key.nodes[nN] = mesh.elementNodesArray[eN*nNodes_element+localNodes[ebN][nN]];
+        std::sort(key.nodes,key.nodes+nNodes_elementBoundary);
+        key.eN = eN;
+        key.ebN_element = ebN;
+      }
+  MESH_SORT(keys.begin(),keys.end());
+  int nElementBoundaries=0,nInteriorElementBoundaries=0;
+  for (long i=0;i<nKeys;i++)
+    {
+      if (i == 0 || !sameNodes(keys[i-1],keys[i]))
+        nElementBoundaries++;
+      else if (i == 1 || !sameNodes(keys[i-2],keys[i]))
+        nInteriorElementBoundaries++;
+    }
+  mesh.nElementBoundaries_global = nElementBoundaries;
+  mesh.nInteriorElementBoundaries_global = nInteriorElementBoundaries;
+  mesh.nExteriorElementBoundaries_global = nElementBoundaries - nInteriorElementBoundaries;
+  mesh.elementBoundaryNodesArray =  new int[mesh.nElementBoundaries_global*mesh.nNodes_elementBoundary];
+  mesh.elementBoundaryElementsArray = new int[mesh.nElementBoundaries_global*2];
+  mesh.elementBoundaryLocalElementBoundariesArray = new int[mesh.nElementBoundaries_global*2];
+  mesh.elementNeighborsArray = new int[mesh.nElements_global*mesh.nElementBoundaries_element];
+  mesh.elementBoundariesArray= new int[mesh.nElements_global*mesh.nElementBoundaries_element];
+  mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
+  mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
+  long first=0;
+  for (int ebN=0,ebNI=0,ebNE=0;ebN<mesh.nElementBoundaries_global;ebN++)
+    {
+      long last=first;
+      while (last+1 < nKeys && sameNodes(keys[first],keys[last+1]))
+        last++;
+      const Key& left = keys[first];
+      for (int nN=0;nN<nNodes_elementBoundary;nN++)
+        mesh.elementBoundaryNodesArray[ebN*nNodes_elementBoundary+nN] = sortedNodes ? left.nodes[nN] :
+          mesh.elementNodesArray[left.eN*nNodes_element+localNodes[left.ebN_element][nN]];
+      mesh.elementBoundaryElementsArray[ebN*2+0] = left.eN;
+      mesh.elementBoundaryLocalElementBoundariesArray[ebN*2+0] = left.ebN_element;
+      mesh.elementBoundariesArray[left.eN*nElementBoundaries_element+left.ebN_element] = ebN;
+      if (last > first)
+        {
+          const Key& right = keys[last];
+          mesh.elementBoundaryElementsArray[ebN*2+1] = right.eN;
+          mesh.elementBoundaryLocalElementBoundariesArray[ebN*2+1] = right.ebN_element;
+          mesh.elementNeighborsArray[left.eN*nElementBoundaries_element+left.ebN_element] = right.eN;
+          mesh.elementNeighborsArray[right.eN*nElementBoundaries_element+right.ebN_element] = left.eN;
+          mesh.elementBoundariesArray[right.eN*nElementBoundaries_element+right.ebN_element] = ebN;
+          mesh.interiorElementBoundariesArray[ebNI++] = ebN;
+        }
+      else
+        {
+          mesh.elementBoundaryElementsArray[ebN*2+1] = -1;
+          mesh.elementBoundaryLocalElementBoundariesArray[ebN*2+1] = -1;
+          mesh.elementNeighborsArray[left.eN*nElementBoundaries_element+left.ebN_element] = -1;
+          mesh.exteriorElementBoundariesArray[ebNE++] = ebN;
+        }
+      first = last+1;
+    }
+}
+
+/* Build edgeNodesArray from the local edges of each element, numbered in lexicographic order of their sorted nodes */
+static void constructEdges(Mesh& mesh, const int nEdges_element, const int (*localEdgeNodes)[2])
+{
+  const long nKeys = long(mesh.nElements_global)*nEdges_element;
+  std::vector<unsigned long long> keys(nKeys);
+#pragma omp parallel for
+  for (int eN=0;eN<mesh.nElements_global;eN++)
+    for (int edgeN=0;edgeN<nEdges_element;edgeN++)
+      {
+        const unsigned long long n0 = mesh.elementNodesArray[eN*mesh.nNodes_element+localEdgeNodes[edgeN][0]],
+          n1 = mesh.elementNodesArray[eN*mesh.nNodes_element+localEdgeNodes[edgeN][1]];
+        keys[long(eN)*nEdges_element+edgeN] = n0 < n1 ? (n0 << 32) | n1 : (n1 << 32) | n0;
+      }
+  MESH_SORT(keys.begin(),keys.end());
+  keys.erase(std::unique(keys.begin(),keys.end()),keys.end());
+  mesh.nEdges_global = keys.size();
+  mesh.edgeNodesArray = new int[mesh.nEdges_global*2];
+  for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
+    {
+      mesh.edgeNodesArray[edgeN*2+0] = int(keys[edgeN] >> 32);
+      mesh.edgeNodesArray[edgeN*2+1] = int(keys[edgeN] & 0xffffffffULL);
+    }
+}
+
+/* Build the node star and node element arrays in CSR form, each row in ascending order */
+static void constructNodeStarAndNodeElements(Mesh& mesh)
+{
+  mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
+  std::fill(mesh.nodeStarOffsets,mesh.nodeStarOffsets+mesh.nNodes_global+1,0);
+  for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
+    {
+      mesh.nodeStarOffsets[mesh.edgeNodesArray[edgeN*2+0]+1]++;
+      mesh.nodeStarOffsets[mesh.edgeNodesArray[edgeN*2+1]+1]++;
+    }
+  for (int nN=0;nN<mesh.nNodes_global;nN++)
+    mesh.nodeStarOffsets[nN+1] += mesh.nodeStarOffsets[nN];
+  mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
+  {
+    std::vector<int> fill(mesh.nodeStarOffsets,mesh.nodeStarOffsets+mesh.nNodes_global);
+    for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
+      {
+        const int n0 = mesh.edgeNodesArray[edgeN*2+0],
+          n1 = mesh.edgeNodesArray[edgeN*2+1];
+        mesh.nodeStarArray[fill[n0]++] = n1;
+        mesh.nodeStarArray[fill[n1]++] = n0;
+      }
+  }
+  mesh.max_nNodeNeighbors_node=0;
+  for (int nN=0;nN<mesh.nNodes_global;nN++)
+    {
+      std::sort(mesh.nodeStarArray+mesh.nodeStarOffsets[nN],mesh.nodeStarArray+mesh.nodeStarOffsets[nN+1]);
+      mesh.max_nNodeNeighbors_node=std::max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
+    }
+  mesh.nodeElementOffsets = new int[mesh.nNodes_global+1];
+  std::fill(mesh.nodeElementOffsets,mesh.nodeElementOffsets+mesh.nNodes_global+1,0);
+  for (int eN = 0; eN < mesh.nElements_global; eN++)
+    for (int nN = 0; nN < mesh.nNodes_element; nN++)
+      mesh.nodeElementOffsets[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]+1]++;
+  for (int nN = 0; nN < mesh.nNodes_global; nN++)
+    mesh.nodeElementOffsets[nN+1] += mesh.nodeElementOffsets[nN];
+  mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
+  std::vector<int> fill(mesh.nodeElementOffsets,mesh.nodeElementOffsets+mesh.nNodes_global);
+  for (int eN = 0; eN < mesh.nElements_global; eN++)
+    for (int nN = 0; nN < mesh.nNodes_element; nN++)
+      mesh.nodeElementsArray[fill[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]]++] = eN;
+}
+
+/*
+  Set the element boundary material types to interior or exterior and, if
+  a node material is DEFAULT, set it to exterior if the node is on at
+  least one exterior boundary and to interior otherwise
+*/
+static void setDefaultElementBoundaryMaterialTypes(Mesh& mesh)
+{
+  mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
+  for (int ebNE = 0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
+    {
+      int ebN = mesh.exteriorElementBoundariesArray[ebNE];
+      mesh.elementBoundaryMaterialTypes[ebN] = EXTERIOR_ELEMENT_BOUNDARY_MATERIAL;
+      for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
+        {
+          int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
+          if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
+            mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
+        }
+    }
+  for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
+    {
+      int ebN = mesh.interiorElementBoundariesArray[ebNI];
+      mesh.elementBoundaryMaterialTypes[ebN] = INTERIOR_ELEMENT_BOUNDARY_MATERIAL;
+      for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
+        {
+          int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
+          if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
+            mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
+        }
+    }
+}
+
+
+/* Native binary mesh format (see writeBinaryMesh/readBinaryMesh)
+
+   header (BINARY_MESH_HEADER_SIZE bytes):
+     char[8]   magic "PROTMESH"
+     uint32    byte order mark 0x01020304, as written by the producing machine
+     uint32    format version
+     int32[11] nElements_global ... max_nNodeNeighbors_node, in Mesh order
+     uint32    number of sections
+     double[4] h, hMin, sigmaMax, volume
+   section table, one entry per array present in the mesh:
+     uint32 id, uint32 bytes per entry, uint64 number of entries, uint64 file offset
+   array data, each section starting on a BINARY_MESH_ALIGNMENT boundary
+
+   Section ids are never reused; readers skip ids they do not know. */
+static const char BINARY_MESH_MAGIC[8]={'P','R','O','T','M','E','S','H'};
+static const unsigned int BINARY_MESH_BYTE_ORDER=0x01020304u;
+static const unsigned int BINARY_MESH_VERSION=1;
+static const int BINARY_MESH_N_COUNTS=11;
+static const int BINARY_MESH_N_SCALARS=4;
+static const size_t BINARY_MESH_HEADER_SIZE=128;
+static const size_t BINARY_MESH_SECTION_SIZE=24;
+static const size_t BINARY_MESH_ALIGNMENT=64;
+
+/* One Mesh array in the binary format; count < 0 means the length is stored in the file and checked against an offsets array */
+struct BinaryMeshArray
+{
+  unsigned int id;
+  int** iarray;
+  double** darray;
+  long long count;
+};
+
+static std::vector<BinaryMeshArray> binaryMeshArrays(Mesh& mesh)
+{
+  const long long nE=mesh.nElements_global,nN=mesh.nNodes_global,nEB=mesh.nElementBoundaries_global;
+  BinaryMeshArray arrays[]=
+    {
+      {1,&mesh.elementNodesArray,NULL,nE*mesh.nNodes_element},
+      {2,&mesh.nodeElementOffsets,NULL,nN+1},
+      {3,&mesh.nodeElementsArray,NULL,-1},
+      {4,&mesh.elementNeighborsArray,NULL,nE*mesh.nElementBoundaries_element},
+      {5,&mesh.elementBoundariesArray,NULL,nE*mesh.nElementBoundaries_element},
+      {6,&mesh.elementBoundaryNodesArray,NULL,nEB*mesh.nNodes_elementBoundary},
+      {7,&mesh.elementBoundaryElementsArray,NULL,nEB*2},
+      {8,&mesh.elementBoundaryLocalElementBoundariesArray,NULL,nEB*2},
+      {9,&mesh.interiorElementBoundariesArray,NULL,mesh.nInteriorElementBoundaries_global},
+      {10,&mesh.exteriorElementBoundariesArray,NULL,mesh.nExteriorElementBoundaries_global},
+      {11,&mesh.edgeNodesArray,NULL,2LL*mesh.nEdges_global},
+      {12,&mesh.nodeStarOffsets,NULL,nN+1},
+      {13,&mesh.nodeStarArray,NULL,-1},
+      {14,&mesh.elementMaterialTypes,NULL,nE},
+      {15,&mesh.elementBoundaryMaterialTypes,NULL,nEB},
+      {16,&mesh.nodeMaterialTypes,NULL,nN},
+      {17,&mesh.newestNodeBases,NULL,nE},
+      {32,NULL,&mesh.nodeArray,nN*3},
+      {33,NULL,&mesh.elementDiametersArray,nE},
+      {34,NULL,&mesh.elementInnerDiametersArray,nE},
+      {35,NULL,&mesh.elementBoundaryDiametersArray,nEB},
+      {36,NULL,&mesh.elementBarycentersArray,nE*3},
+      {37,NULL,&mesh.elementBoundaryBarycentersArray,nEB*3},
+      {38,NULL,&mesh.nodeDiametersArray,nN},
+      {39,NULL,&mesh.nodeSupportArray,nN}
+    };
+  return std::vector<BinaryMeshArray>(arrays,arrays+sizeof(arrays)/sizeof(BinaryMeshArray));
+}
+
+static inline void byteSwap(char* data, size_t entrySize, size_t nEntries)
+{
+  for (size_t i=0;i<nEntries;i++)
+    std::reverse(data+i*entrySize,data+(i+1)*entrySize);
+}
+
+/* Read a value of type T at offset in a mapped file, swapping bytes if the file came from a machine of the other byte order */
+template<class T>
+static inline T binaryMeshValue(const char* data, size_t offset, bool swap)
+{
+  T value;
+  memcpy(&value,data+offset,sizeof(T));
+  if (swap)
+    byteSwap(reinterpret_cast<char*>(&value),sizeof(T),1);
+  return value;
+}
+
+/* First word of an XMS (3DM/2DM) card line */
+static inline bool xmsCard(const char* line, const char* lineEnd, const char* card)
+{
+  const char* p=IOutils::skipBlanks(line,lineEnd);
+  const size_t n=strlen(card);
+  return size_t(lineEnd-p) >= n && strncmp(p,card,n) == 0 &&
+    (p+n == lineEnd || p[n] == ' ' || p[n] == '\t' || p[n] == '\r');
+}
+
+static inline bool xmsBlank(const char* line, const char* lineEnd)
+{
+  return IOutils::skipBlanks(line,lineEnd) == lineEnd;
+}
+
+/* First non-blank line in [p,end) that is not a card of the given type, or NULL */
+static inline const char* xmsFirstOtherCard(const char* p, const char* end, const char* card)
+{
+  while (p < end)
+    {
+      const char* lineEnd=IOutils::endOfLine(p,end);
+      if (!xmsBlank(p,lineEnd) && !xmsCard(p,lineEnd,card))
+        return p;
+      p=lineEnd+1;
+    }
+  return NULL;
+}
+
+static inline long long xmsCountCards(const char* p, const char* end, const char* card)
+{
+  long long n=0;
+  while (p < end)
+    {
+      const char* lineEnd=IOutils::endOfLine(p,end);
+      if (xmsCard(p,lineEnd,card))
+        n++;
+      p=lineEnd+1;
+    }
+  return n;
+}
+
+/* Read the element cards (E4T/E3T) and the node cards (ND) that follow them from a mapped XMS mesh file.
+   As with the stream reader it replaces, the element list ends at the first other card, the node list at the
+   first non-ND card after it, and the card ids are ignored. The line aligned chunks of the file are classified
+   and counted first so that every chunk knows where its cards go, and then parsed concurrently. */
+static int readXMSMesh(Mesh& mesh, const std::string& meshFilename, int indexBase, const char* caller,
+                       const char* fileKind, const char* meshCard, const char* elementCard, int nNodes_element)
+{
+  using namespace IOutils;
+  MappedFile meshFile(meshFilename);
+  if (!meshFile.good())
+    {
+      std::cerr<<caller<<" cannot open file "
+               <<meshFilename<<std::endl;
+      return true;
+    }
+  const char* p=meshFile.begin();
+  const char* end=meshFile.end();
+  while (p < end && xmsBlank(p,endOfLine(p,end)))
+    p=endOfLine(p,end)+1;
+  const char* lineEnd=endOfLine(p,end);
+  if (!xmsCard(p,lineEnd,meshCard))
+    {
+      const char* word=skipBlanks(p,lineEnd);
+      const char* wordEnd=word;
+      while (wordEnd < lineEnd && !iswhitespace(*wordEnd))
+        wordEnd++;
+      std::cerr<<caller<<" does not recognize filetype "
+               <<std::string(word,wordEnd)<<std::endl;
+      return true;
+    }
+  p=std::min(lineEnd+1,end);
+  while (p < end && xmsBlank(p,endOfLine(p,end)))
+    p=endOfLine(p,end)+1;
+  lineEnd=endOfLine(p,end);
+  if (xmsCard(p,lineEnd,"MESHNAME"))
+    {
+      std::string meshName(skipBlanks(skipBlanks(p,lineEnd)+strlen("MESHNAME"),lineEnd),lineEnd);
+      logEvent(&(std::string("Reading ")+fileKind+" "+meshName)[0],5);
+      p=std::min(lineEnd+1,end);
+    }
+  std::vector<const char*> chunks=splitLines(p,end);
+  const int nChunks=int(chunks.size())-1;
+  //the element cards end at the first other card
+  std::vector<const char*> firstOther(nChunks);
+#pragma omp parallel for schedule(dynamic)
+  for (int c=0;c<nChunks;c++)
+    firstOther[c]=xmsFirstOtherCard(chunks[c],chunks[c+1],elementCard);
+  const char* endElements=end;
+  for (int c=0;c<nChunks && endElements == end;c++)
+    if (firstOther[c])
+      endElements=firstOther[c];
+  //the node cards end at the first non-ND card after the elements
+  std::vector<long long> elementStart(nChunks+1,0),nodeStart(nChunks+1,0);
+#pragma omp parallel for schedule(dynamic)
+  for (int c=0;c<nChunks;c++)
+    {
+      elementStart[c+1]=xmsCountCards(chunks[c],std::min(chunks[c+1],endElements),elementCard);
+      firstOther[c]=NULL;
+      if (chunks[c+1] > endElements)
+        {
+          const char* nodes=std::max(chunks[c],endElements);
+          firstOther[c]=xmsFirstOtherCard(nodes,chunks[c+1],"ND");
+          nodeStart[c+1]=xmsCountCards(nodes,firstOther[c] ? firstOther[c] : chunks[c+1],"ND");
+        }
+    }
+  const char* endNodes=end;
+  for (int c=0;c<nChunks;c++)
+    {
+      if (endNodes != end)
+        nodeStart[c+1]=0;
+      else if (firstOther[c])
+        endNodes=firstOther[c];
+    }
+  for (int c=0;c<nChunks;c++)
+    {
+      elementStart[c+1]+=elementStart[c];
+      nodeStart[c+1]+=nodeStart[c];
+    }
+  mesh.nNodes_element=nNodes_element;
+  mesh.nElements_global=int(elementStart[nChunks]);
+  mesh.nNodes_global=int(nodeStart[nChunks]);
+  assert(!mesh.nodeArray);
+  mesh.nodeArray     = new double[mesh.nNodes_global*3];
+  assert(!mesh.nodeMaterialTypes);
+  mesh.nodeMaterialTypes = new int[mesh.nNodes_global];
+  assert(!mesh.elementNodesArray);
+  mesh.elementNodesArray = new int[mesh.nElements_global*mesh.nNodes_element];
+  assert(!mesh.elementMaterialTypes);
+  mesh.elementMaterialTypes = new int[mesh.nElements_global];
+  int nBadCards=0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nBadCards)
+  for (int c=0;c<nChunks;c++)
+    {
+      long long eN=elementStart[c],nN=nodeStart[c];
+      const char* endNodes_chunk=std::min(chunks[c+1],endNodes);
+      for (const char* line=chunks[c];line < endNodes_chunk;)
+        {
+          const char* lineEnd=endOfLine(line,endNodes_chunk);
+          const bool element=line < endElements;
+          if (xmsCard(line,lineEnd,element ? elementCard : "ND"))
+            {
+              const char* q=skipBlanks(line,lineEnd)+(element ? strlen(elementCard) : 2);
+              int id;
+              bool good=parseInt(q,lineEnd,id);
+              if (element)
+                {
+                  int nodes[4],emt;
+                  for (int nN_element=0;nN_element<nNodes_element;nN_element++)
+                    good = good && parseInt(q,lineEnd,nodes[nN_element]);
+                  good = good && parseInt(q,lineEnd,emt);
+                  if (good)
+                    {
+                      for (int nN_element=0;nN_element<nNodes_element;nN_element++)
+                        mesh.elementNodesArray[eN*nNodes_element+nN_element]=nodes[nN_element]-indexBase;
+                      mesh.elementMaterialTypes[eN]=emt-indexBase;
+                    }
+                  eN++;
+                }
+              else
+                {
+                  double x[3];
+                  for (int I=0;I<3;I++)
+                    good = good && parseDouble(q,lineEnd,x[I]);
+                  if (good)
+                    {
+                      for (int I=0;I<3;I++)
+                        mesh.nodeArray[nN*3+I]=x[I];
+                      mesh.nodeMaterialTypes[nN]=0;
+                    }
+                  nN++;
+                }
+              if (!good)
+                nBadCards++;
+            }
+          line=lineEnd+1;
+        }
+    }
+  if (nBadCards > 0)
+    {
+      std::cerr<<caller<<" could not parse "<<nBadCards<<" cards in "
+               <<meshFilename<<std::endl;
+      delete [] mesh.nodeArray;
+      delete [] mesh.nodeMaterialTypes;
+      delete [] mesh.elementNodesArray;
+      delete [] mesh.elementMaterialTypes;
+      mesh.nodeArray=NULL;
+      mesh.nodeMaterialTypes=NULL;
+      mesh.elementNodesArray=NULL;
+      mesh.elementMaterialTypes=NULL;
+      return true;
+    }
+  return 0;
+}
+
 //todo compute geometric info, node star
 extern "C"
 {
@@ -682,716 +1181,16 @@ extern "C"
             mesh.elementNeighborsArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = eb->second.left;
           }
         else
-          exteriorElementBoundaries.insert(ebN);
-	//mwf added
-	mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
-	if (eb->second.right != -1)
-	  {
-	    mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
- 	  }
-      }
-    mesh.nInteriorElementBoundaries_global = interiorElementBoundaries.size();
-    mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
-    mesh.nExteriorElementBoundaries_global = exteriorElementBoundaries.size();
-    mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
-    int ebNI=0,ebNE=0;
-    for (set<int>::iterator ebN=interiorElementBoundaries.begin();ebN != interiorElementBoundaries.end(); ebN++,ebNI++)
-      mesh.interiorElementBoundariesArray[ebNI] = *ebN;
-    for (set<int>::iterator ebN=exteriorElementBoundaries.begin();ebN != exteriorElementBoundaries.end(); ebN++,ebNE++)
-      mesh.exteriorElementBoundariesArray[ebNE] = *ebN;
-    //edges are elements in 1D so we just copy over but could be slicker
-    mesh.nEdges_global = mesh.nElements_global;
-    mesh.edgeNodesArray = new int[mesh.nElements_global*2];
-    for (int eN=0;eN<mesh.nElements_global;eN++)
-      {
-        mesh.edgeNodesArray[eN*2+0] = mesh.elementNodesArray[eN*2+0];
-        mesh.edgeNodesArray[eN*2+1] = mesh.elementNodesArray[eN*2+1];
-      }
-    vector<set<int> > nodeStar(mesh.nNodes_global);
-    for (int eN=0;eN<mesh.nElements_global;eN++)
-      {
-        nodeStar[mesh.edgeNodesArray[eN*2+0]].insert(mesh.edgeNodesArray[eN*2+1]);
-        nodeStar[mesh.edgeNodesArray[eN*2+1]].insert(mesh.edgeNodesArray[eN*2+0]);
-      }
-    mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeStarOffsets[0] = 0;
-    for (int nN=1;nN<mesh.nNodes_global+1;nN++)
-      mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1]+nodeStar[nN-1].size();
-    mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0;nN<mesh.nNodes_global;nN++)
-      for (set<int>::iterator nN_star=nodeStar[nN].begin();nN_star!=nodeStar[nN].end();nN_star++,offset++)
-        mesh.nodeStarArray[offset] = *nN_star;
-    mesh.max_nNodeNeighbors_node=0;
-    for (int nN=0;nN<mesh.nNodes_global;nN++)
-      mesh.max_nNodeNeighbors_node=max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
-    stop = CurrentTime();
-    //repeat for node-->elements arrays
-    vector<set<int> > nodeElementsStar(mesh.nNodes_global);
-    for (int eN = 0; eN < mesh.nElements_global; eN++)
-      {
-	for (int nN = 0; nN < mesh.nNodes_element; nN++)
-	  nodeElementsStar[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]].insert(eN);
-      }
-    mesh.nodeElementOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeElementOffsets[0] = 0;
-    for (int nN = 0; nN < mesh.nNodes_global; nN++)
-      mesh.nodeElementOffsets[nN+1] = mesh.nodeElementOffsets[nN]+nodeElementsStar[nN].size();
-    mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0; nN < mesh.nNodes_global; nN++)
-      {
-	for (set<int>::iterator eN_star = nodeElementsStar[nN].begin(); eN_star != nodeElementsStar[nN].end();
-	     eN_star++,offset++)
-	  {
-	    mesh.nodeElementsArray[offset] = *eN_star;
-	  }
-      }
-    //end node-->elements construction
-    mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
-    //if nodeMaterial is DEFAULT, go ahead and set to interior or exterior
-    //depending on which boundary node belongs to. 
-    //If node on at least one exterior boundary then it's exterior
-    for (int ebNE = 0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
-      {
-	int ebN = mesh.exteriorElementBoundariesArray[ebNE];
-	mesh.elementBoundaryMaterialTypes[ebN] = EXTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
-	  }
-      }
-    for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
-      {
-	int ebN = mesh.interiorElementBoundariesArray[ebNI];
-	mesh.elementBoundaryMaterialTypes[ebN] = INTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
-	  }
-      }
-
-
-    //cout<<"Elapsed time for populating arrays = "<<(stop-start)<<"s"<<endl;
-    return 0;
-  }
-
-  int constructElementBoundaryElementsArray_triangle(Mesh& mesh)
-  {
-    using namespace std;
-    mesh.nNodes_elementBoundary = 2;
-    mesh.nElementBoundaries_element = 3;
-    double start,stop;
-    //cout<<"Constructing element boundary map"<<endl;
-    map<NodeTuple<2>,
-      ElementNeighbors> elementBoundaryElements;
-    start=CurrentTime();
-    for(int eN=0;eN<mesh.nElements_global;eN++)
-      for(int ebN=0;ebN<3;ebN++)
-        {
-          int nodes[2];
-          nodes[0] = mesh.elementNodesArray[eN*3+(ebN+1)%3];
-          nodes[1] = mesh.elementNodesArray[eN*3+(ebN+2)%3];
-          NodeTuple<2> ebt(nodes);
-          if(elementBoundaryElements.find(ebt) != elementBoundaryElements.end())
-            {
-              elementBoundaryElements[ebt].right=eN;
-              elementBoundaryElements[ebt].right_ebN_element=ebN;
-            }
-          else
-            {
-              elementBoundaryElements.insert(elementBoundaryElements.end(),make_pair(ebt,ElementNeighbors(eN,ebN)));
-            }
-        }
-    stop = CurrentTime();
-    //cout<<"Elapsed time for building element boundary elements map= "<<(stop-start)<<"s"<<endl;
-    mesh.nElementBoundaries_global = elementBoundaryElements.size();
-    //cout<<"nElementBoundaries_global = "<<mesh.nElementBoundaries_global<<endl;
-    
-    //cout<<"Allocating Arrays"<<endl;
-    start = CurrentTime();
-    set<int> interiorElementBoundaries,exteriorElementBoundaries;
-    mesh.elementBoundaryNodesArray =  new int[mesh.nElementBoundaries_global*mesh.nNodes_elementBoundary];
-    mesh.elementBoundaryElementsArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementBoundaryLocalElementBoundariesArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementNeighborsArray = new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    mesh.elementBoundariesArray= new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    stop = CurrentTime();
-    //cout<<"Elapsed time for allocating arrays = "<<(stop-start)<<"s"<<endl;
-
-    //cout<<"Populating arrays"<<endl;
-    start = CurrentTime();
-    int ebN=0;
-    for(map<NodeTuple<2>,ElementNeighbors>::iterator eb=elementBoundaryElements.begin();
-        eb != elementBoundaryElements.end();
-        eb++,ebN++)
-      {
-        mesh.elementBoundaryNodesArray[ebN*2 + 0] = eb->first.nodes[0];
-        mesh.elementBoundaryNodesArray[ebN*2 + 1] = eb->first.nodes[1];
-        mesh.elementBoundaryElementsArray[ebN*2 + 0] = eb->second.left;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 0] = eb->second.left_ebN_element;
-        mesh.elementBoundaryElementsArray[ebN*2 + 1] = eb->second.right;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 1] = eb->second.right_ebN_element;
-        mesh.elementNeighborsArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = eb->second.right; 
-        if(eb->second.right != -1)
-          {
-            interiorElementBoundaries.insert(ebN);
-            mesh.elementNeighborsArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = eb->second.left;
-          }
-        else
-          exteriorElementBoundaries.insert(ebN);          
-	mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
-	if (eb->second.right != -1)
-	  {
-	    mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
-	  }
-      }
-    mesh.nInteriorElementBoundaries_global = interiorElementBoundaries.size();
-    mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
-    mesh.nExteriorElementBoundaries_global = exteriorElementBoundaries.size();
-    mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
-    int ebNI=0,ebNE=0;
-    for (set<int>::iterator ebN=interiorElementBoundaries.begin();ebN != interiorElementBoundaries.end(); ebN++,ebNI++)
-      mesh.interiorElementBoundariesArray[ebNI] = *ebN;
-    for (set<int>::iterator ebN=exteriorElementBoundaries.begin();ebN != exteriorElementBoundaries.end(); ebN++,ebNE++)
-      mesh.exteriorElementBoundariesArray[ebNE] = *ebN;
-    set<NodeTuple<2> > edges;
-    for (int eN=0;eN<mesh.nElements_global;eN++)
-      {
-        int nodes[2];
-        for (int nN_L=0;nN_L<mesh.nNodes_element;nN_L++)
-          for (int nN_R=nN_L+1;nN_R<mesh.nNodes_element;nN_R++)
-            {
-              nodes[0] = mesh.elementNodesArray[eN*3+nN_L];
-              nodes[1] = mesh.elementNodesArray[eN*3+nN_R];
-              edges.insert(NodeTuple<2>(nodes));
-            }
-      }
-    mesh.nEdges_global = edges.size();
-    mesh.edgeNodesArray = new int[mesh.nEdges_global*2];
-    int edgeN=0;
-    for (set<NodeTuple<2> >::iterator edgeTuple_p=edges.begin();edgeTuple_p != edges.end();edgeTuple_p++,edgeN++)
-      {
-        mesh.edgeNodesArray[edgeN*2+0] = edgeTuple_p->nodes[0];
-        mesh.edgeNodesArray[edgeN*2+1] = edgeTuple_p->nodes[1];
-      }
-    vector<set<int> > nodeStar(mesh.nNodes_global);
-    for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
-      {
-        nodeStar[mesh.edgeNodesArray[edgeN*2+0]].insert(mesh.edgeNodesArray[edgeN*2+1]);
-        nodeStar[mesh.edgeNodesArray[edgeN*2+1]].insert(mesh.edgeNodesArray[edgeN*2+0]);
-      }
-    mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeStarOffsets[0] = 0;
-    for (int nN=1;nN<mesh.nNodes_global+1;nN++)
-      mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1]+nodeStar[nN-1].size();
-    mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0;nN<mesh.nNodes_global;nN++)
-      for (set<int>::iterator nN_star=nodeStar[nN].begin();nN_star!=nodeStar[nN].end();nN_star++,offset++)
-        mesh.nodeStarArray[offset] = *nN_star;
-    stop = CurrentTime();
-    mesh.max_nNodeNeighbors_node=0;
-    for (int nN=0;nN<mesh.nNodes_global;nN++)
-      mesh.max_nNodeNeighbors_node=max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
-    //repeat for node-->elements arrays
-    vector<set<int> > nodeElementsStar(mesh.nNodes_global);
-    for (int eN = 0; eN < mesh.nElements_global; eN++)
-      {
-	for (int nN = 0; nN < mesh.nNodes_element; nN++)
-	  nodeElementsStar[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]].insert(eN);
-      }
-    mesh.nodeElementOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeElementOffsets[0] = 0;
-    for (int nN = 0; nN < mesh.nNodes_global; nN++)
-      mesh.nodeElementOffsets[nN+1] = mesh.nodeElementOffsets[nN]+nodeElementsStar[nN].size();
-    mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0; nN < mesh.nNodes_global; nN++)
-      {
-	for (set<int>::iterator eN_star = nodeElementsStar[nN].begin(); eN_star != nodeElementsStar[nN].end();
-	     eN_star++,offset++)
-	  {
-	    mesh.nodeElementsArray[offset] = *eN_star;
-	  }
-      }
-    //end node-->elements construction
-    mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
-    //if nodeMaterial is DEFAULT, go ahead and set to interior or exterior
-    //depending on which boundary node belongs to. 
-    //If node on at least one exterior boundary then it's exterior
-    //set actual values elsewhere
-    for (int ebNE = 0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
-      {
-	int ebN = mesh.exteriorElementBoundariesArray[ebNE];
-	mesh.elementBoundaryMaterialTypes[ebN] = EXTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
-	  }
-      }
-    for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
-      {
-	int ebN = mesh.interiorElementBoundariesArray[ebNI];
-	mesh.elementBoundaryMaterialTypes[ebN] = INTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
-	  }
-      }
-    //cout<<"Elapsed time for populating arrays = "<<(stop-start)<<"s"<<endl;
-    return 0;
-  }
-
-  int constructElementBoundaryElementsArray_quadrilateral(Mesh& mesh)
-  {
-    using namespace std;
-    mesh.nNodes_elementBoundary = 2;
-    mesh.nElementBoundaries_element = 4;
-    double start,stop;
-    //cout<<"Constructing element boundary map"<<endl;
-    map<NodeTuple<2>,
-      ElementNeighbors> elementBoundaryElements;
-    start=CurrentTime();
-    for(int eN=0;eN<mesh.nElements_global;eN++)
-      for(int ebN=0;ebN<4;ebN++)
-        {
-          int nodes[2];
-          nodes[0] = mesh.elementNodesArray[eN*4+ebN];
-          nodes[1] = mesh.elementNodesArray[eN*4+(ebN+1)%4];
-          NodeTuple<2> ebt(nodes);
-          if(elementBoundaryElements.find(ebt) != elementBoundaryElements.end())
-            {
-              elementBoundaryElements[ebt].right=eN;
-              elementBoundaryElements[ebt].right_ebN_element=ebN;
-            }
-          else
-            {
-              elementBoundaryElements.insert(elementBoundaryElements.end(),make_pair(ebt,ElementNeighbors(eN,ebN)));
-            }
-        }
-    stop = CurrentTime();
-    //cout<<"Elapsed time for building element boundary elements map= "<<(stop-start)<<"s"<<endl;
-    mesh.nElementBoundaries_global = elementBoundaryElements.size();
-    cout<<"nElementBoundaries_global = "<<mesh.nElementBoundaries_global<<endl;
-    
-    //cout<<"Allocating Arrays"<<endl;
-    start = CurrentTime();
-    set<int> interiorElementBoundaries,exteriorElementBoundaries;
-    mesh.elementBoundaryNodesArray =  new int[mesh.nElementBoundaries_global*mesh.nNodes_elementBoundary];
-    mesh.elementBoundaryElementsArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementBoundaryLocalElementBoundariesArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementNeighborsArray = new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    mesh.elementBoundariesArray= new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    stop = CurrentTime();
-    //cout<<"Elapsed time for allocating arrays = "<<(stop-start)<<"s"<<endl;
-
-    //cout<<"Populating arrays"<<endl;
-    start = CurrentTime();
-    int ebN=0;
-    for(map<NodeTuple<2>,ElementNeighbors>::iterator eb=elementBoundaryElements.begin();
-        eb != elementBoundaryElements.end();
-        eb++,ebN++)
-      {
-        mesh.elementBoundaryNodesArray[ebN*2 + 0] = eb->first.nodes[0];
-        mesh.elementBoundaryNodesArray[ebN*2 + 1] = eb->first.nodes[1];
-        mesh.elementBoundaryElementsArray[ebN*2 + 0] = eb->second.left;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 0] = eb->second.left_ebN_element;
-        mesh.elementBoundaryElementsArray[ebN*2 + 1] = eb->second.right;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 1] = eb->second.right_ebN_element;
-        mesh.elementNeighborsArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = eb->second.right; 
-        if(eb->second.right != -1)
-          {
-            interiorElementBoundaries.insert(ebN);
-            mesh.elementNeighborsArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = eb->second.left;
-          }
-        else
-          exteriorElementBoundaries.insert(ebN);          
-	mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
-	if (eb->second.right != -1)
-	  {
-	    mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
-	  }
-      }
-    mesh.nInteriorElementBoundaries_global = interiorElementBoundaries.size();
-    mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
-    mesh.nExteriorElementBoundaries_global = exteriorElementBoundaries.size();
-    mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
-    int ebNI=0,ebNE=0;
-    for (set<int>::iterator ebN=interiorElementBoundaries.begin();ebN != interiorElementBoundaries.end(); ebN++,ebNI++)
-      mesh.interiorElementBoundariesArray[ebNI] = *ebN;
-    for (set<int>::iterator ebN=exteriorElementBoundaries.begin();ebN != exteriorElementBoundaries.end(); ebN++,ebNE++)
-      mesh.exteriorElementBoundariesArray[ebNE] = *ebN;
-    set<NodeTuple<2> > edges;
-    for (int eN=0;eN<mesh.nElements_global;eN++)
-      {
-        int nodes[2];
-        for (int nN_L=0;nN_L<mesh.nNodes_element;nN_L++)
-          for (int nN_R=nN_L+1;nN_R<mesh.nNodes_element;nN_R++)
-            {
-              nodes[0] = mesh.elementNodesArray[eN*4+nN_L];
-              nodes[1] = mesh.elementNodesArray[eN*4+nN_R];
-              edges.insert(NodeTuple<2>(nodes));
-            }
-      }
-    mesh.nEdges_global = edges.size();
-    mesh.edgeNodesArray = new int[mesh.nEdges_global*2];
-    int edgeN=0;
-    for (set<NodeTuple<2> >::iterator edgeTuple_p=edges.begin();edgeTuple_p != edges.end();edgeTuple_p++,edgeN++)
-      {
-        mesh.edgeNodesArray[edgeN*2+0] = edgeTuple_p->nodes[0];
-        mesh.edgeNodesArray[edgeN*2+1] = edgeTuple_p->nodes[1];
-      }
-    vector<set<int> > nodeStar(mesh.nNodes_global);
-    for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
-      {
-        nodeStar[mesh.edgeNodesArray[edgeN*2+0]].insert(mesh.edgeNodesArray[edgeN*2+1]);
-        nodeStar[mesh.edgeNodesArray[edgeN*2+1]].insert(mesh.edgeNodesArray[edgeN*2+0]);
-      }
-    mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeStarOffsets[0] = 0;
-    for (int nN=1;nN<mesh.nNodes_global+1;nN++)
-      mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1]+nodeStar[nN-1].size();
-    mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0;nN<mesh.nNodes_global;nN++)
-      for (set<int>::iterator nN_star=nodeStar[nN].begin();nN_star!=nodeStar[nN].end();nN_star++,offset++)
-        mesh.nodeStarArray[offset] = *nN_star;
-    stop = CurrentTime();
-    mesh.max_nNodeNeighbors_node=0;
-    for (int nN=0;nN<mesh.nNodes_global;nN++)
-      mesh.max_nNodeNeighbors_node=max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
-    //repeat for node-->elements arrays
-    vector<set<int> > nodeElementsStar(mesh.nNodes_global);
-    for (int eN = 0; eN < mesh.nElements_global; eN++)
-      {
-	for (int nN = 0; nN < mesh.nNodes_element; nN++)
-	  nodeElementsStar[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]].insert(eN);
-      }
-    mesh.nodeElementOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeElementOffsets[0] = 0;
-    for (int nN = 0; nN < mesh.nNodes_global; nN++)
-      mesh.nodeElementOffsets[nN+1] = mesh.nodeElementOffsets[nN]+nodeElementsStar[nN].size();
-    mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0; nN < mesh.nNodes_global; nN++)
-      {
-	for (set<int>::iterator eN_star = nodeElementsStar[nN].begin(); eN_star != nodeElementsStar[nN].end();
-	     eN_star++,offset++)
-	  {
-	    mesh.nodeElementsArray[offset] = *eN_star;
-	  }
-      }
-    //end node-->elements construction
-    mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
-    //if nodeMaterial is DEFAULT, go ahead and set to interior or exterior
-    //depending on which boundary node belongs to. 
-    //If node on at least one exterior boundary then it's exterior
-    //set actual values elsewhere
-    for (int ebNE = 0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
-      {
-	int ebN = mesh.exteriorElementBoundariesArray[ebNE];
-	mesh.elementBoundaryMaterialTypes[ebN] = EXTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
-	  }
-      }
-    for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
-      {
-	int ebN = mesh.interiorElementBoundariesArray[ebNI];
-	mesh.elementBoundaryMaterialTypes[ebN] = INTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
-	  }
-      }
-    //cout<<"Elapsed time for populating arrays = "<<(stop-start)<<"s"<<endl;
-    return 0;
-  }
-
-  int constructElementBoundaryElementsArray_tetrahedron(Mesh& mesh)
-  {
-    mesh.nNodes_elementBoundary = 3;
-    mesh.nElementBoundaries_element = 4;
-    using namespace std;
-    double start,stop;
-    typedef map<NodeTuple<3>, ElementNeighbors> ElementBoundaryElementsType;
-    {
-    ElementBoundaryElementsType elementBoundaryElements;
-    start=CurrentTime();
-    //std::cout<<"Extracting boundary elements"<<endl;
-    for(int eN=0;eN<mesh.nElements_global;eN++)
-      for(int ebN=0;ebN<mesh.nElementBoundaries_element;ebN++)
-        {
-          int nodes[3];
-          nodes[0] = mesh.elementNodesArray[eN*4+((ebN+1)%4)];
-          nodes[1] = mesh.elementNodesArray[eN*4+((ebN+2)%4)];
-          nodes[2] = mesh.elementNodesArray[eN*4+((ebN+3)%4)];
-          NodeTuple<3> ebt(nodes);
-          if(elementBoundaryElements.find(ebt) != elementBoundaryElements.end())
-            {
-              elementBoundaryElements[ebt].right=eN;
-              elementBoundaryElements[ebt].right_ebN_element=ebN;
-            }
-          else
-            {
-              elementBoundaryElements.insert(elementBoundaryElements.end(),make_pair(ebt,ElementNeighbors(eN,ebN)));
-            }
-        }
-    stop = CurrentTime();
-    //std::cout<<"Elapsed time for building element boundary elements map= "<<(stop-start)<<"s"<<endl;
-    mesh.nElementBoundaries_global = elementBoundaryElements.size();
-    //std::cout<<"nElementBoundaries_global = "<<mesh.nElementBoundaries_global<<endl;
-
-    //std::cout<<"Allocating Arrays"<<endl;
-    start = CurrentTime();
-    typedef set<int> ElementBoundariesType;
-    ElementBoundariesType interiorElementBoundaries,exteriorElementBoundaries;
-    mesh.elementBoundaryNodesArray =  new int[mesh.nElementBoundaries_global*mesh.nNodes_elementBoundary];
-    mesh.elementBoundaryElementsArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementBoundaryLocalElementBoundariesArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementNeighborsArray = new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    mesh.elementBoundariesArray= new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    stop = CurrentTime();
-    //std::cout<<"Elapsed time for allocating arrays = "<<(stop-start)<<"s"<<endl;
-    //std::cout<<"Generating elementBoundaryElementsArray and elementBoundaryNodesArray"<<endl;
-    start = CurrentTime();
-    int ebN=0;
-    for(map<NodeTuple<3>,ElementNeighbors>::iterator eb=elementBoundaryElements.begin();
-        eb != elementBoundaryElements.end();
-        eb++,ebN++)
-      {
-        mesh.elementBoundaryNodesArray[ebN*3 + 0] = eb->first.nodes[0];
-        mesh.elementBoundaryNodesArray[ebN*3 + 1] = eb->first.nodes[1];
-        mesh.elementBoundaryNodesArray[ebN*3 + 2] = eb->first.nodes[2];
-
-        mesh.elementBoundaryElementsArray[ebN*2 + 0] = eb->second.left;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 0] = eb->second.left_ebN_element;
-        mesh.elementBoundaryElementsArray[ebN*2 + 1] = eb->second.right;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 1] = eb->second.right_ebN_element;
-        mesh.elementNeighborsArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = eb->second.right; 
-        if(eb->second.right != -1)
-	  {
-	    interiorElementBoundaries.insert(ebN);
-	    mesh.elementNeighborsArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = eb->second.left; 
-	  }
-        else
-          exteriorElementBoundaries.insert(ebN);
-	mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
-	if (eb->second.right != -1)
-	  {
-	    mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
- 	  }
-      }
-    mesh.nInteriorElementBoundaries_global = interiorElementBoundaries.size();
-    mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
-    mesh.nExteriorElementBoundaries_global = exteriorElementBoundaries.size();
-    mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
-    int ebNI=0,ebNE=0;
-    for (set<int>::iterator ebN=interiorElementBoundaries.begin();ebN != interiorElementBoundaries.end(); ebN++,ebNI++)
-      mesh.interiorElementBoundariesArray[ebNI] = *ebN;
-    for (set<int>::iterator ebN=exteriorElementBoundaries.begin();ebN != exteriorElementBoundaries.end(); ebN++,ebNE++)
-      mesh.exteriorElementBoundariesArray[ebNE] = *ebN;
-    }
-    //elementBoundaryElements.~ElementBoundaryElementsType();
-    //interiorElementBoundaries.~ElementBoundariesType();
-    //exteriorElementBoundaries.~ElementBoundariesType();
-    {
-      typedef set<NodeTuple<2> > EdgesType;
-    EdgesType edges;
-    //std::cout<<"extracting edges"<<std::endl;
-    for (int eN=0;eN<mesh.nElements_global;eN++)
-      {
-        int nodes[2];
-        for (int nN_L=0;nN_L<mesh.nNodes_element;nN_L++)
-          for (int nN_R=nN_L+1;nN_R<mesh.nNodes_element;nN_R++)
-            {
-              nodes[0] = mesh.elementNodesArray[eN*4+nN_L];
-              nodes[1] = mesh.elementNodesArray[eN*4+nN_R];
-              edges.insert(NodeTuple<2>(nodes));
-            }
-      }
-    mesh.nEdges_global = edges.size();
-    mesh.edgeNodesArray = new int[mesh.nEdges_global*2];
-    EdgesType::iterator edge_p=edges.begin();
-    for (int edgeN=0;edgeN<int(edges.size());edgeN++)
-      {
-        mesh.edgeNodesArray[edgeN*2+0] = edge_p->nodes[0];
-        mesh.edgeNodesArray[edgeN*2+1] = edge_p->nodes[1];
-        edge_p++;
-      }
-    }//edges.~EdgesType();
-    {
-      //std::cout<<"node star"<<std::endl;
-    typedef vector<set<int> > NodeStarType;
-    NodeStarType nodeStar(mesh.nNodes_global);
-    for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
-      {
-        nodeStar[mesh.edgeNodesArray[edgeN*2+0]].insert(mesh.edgeNodesArray[edgeN*2+1]);
-        nodeStar[mesh.edgeNodesArray[edgeN*2+1]].insert(mesh.edgeNodesArray[edgeN*2+0]);
-      }
-    mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeStarOffsets[0] = 0;
-    for (int nN=1;nN<mesh.nNodes_global+1;nN++)
-      mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1] + nodeStar[nN-1].size();
-    mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0;nN<mesh.nNodes_global;nN++)
-      for (set<int>::iterator nN_star=nodeStar[nN].begin();nN_star!=nodeStar[nN].end();nN_star++,offset++)
-        mesh.nodeStarArray[offset] = *nN_star;
-    }//nodeStar.~NodeStarType();
-    {
-      //std::cout<<"node elements star"<<std::endl;
-    stop = CurrentTime();
-    mesh.max_nNodeNeighbors_node=0;
-    for (int nN=0;nN<mesh.nNodes_global;nN++)
-      mesh.max_nNodeNeighbors_node=max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
-    typedef vector<set<int> > NodeElementsStarType;
-    NodeElementsStarType nodeElementsStar(mesh.nNodes_global);
-    for (int eN = 0; eN < mesh.nElements_global; eN++)
-      {
-	for (int nN = 0; nN < mesh.nNodes_element; nN++)
-	  nodeElementsStar[mesh.elementNodesArray[eN*mesh.nNodes_element+nN]].insert(eN);
-      }
-    mesh.nodeElementOffsets = new int[mesh.nNodes_global+1];
-    mesh.nodeElementOffsets[0] = 0;
-    for (int nN = 0; nN < mesh.nNodes_global; nN++)
-      mesh.nodeElementOffsets[nN+1] = mesh.nodeElementOffsets[nN]+nodeElementsStar[nN].size();
-    mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
-    for (int nN=0,offset=0; nN < mesh.nNodes_global; nN++)
-      {
-	for (set<int>::iterator eN_star = nodeElementsStar[nN].begin(); eN_star != nodeElementsStar[nN].end();
-	     eN_star++,offset++)
-	  {
-	    mesh.nodeElementsArray[offset] = *eN_star;
-	  }
-      }
-    }//nodeElementsStar.~NodeElementsStarType();
-    mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
-    //std::cout<<"nodematerials"<<std::endl;
-    //if nodeMaterial is DEFAULT, go ahead and set to interior or exterior
-    //depending on which boundary node belongs to. 
-    //If node on at least one exterior boundary then it's exterior
-    for (int ebNE = 0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
-      {
-	int ebN = mesh.exteriorElementBoundariesArray[ebNE];
-	mesh.elementBoundaryMaterialTypes[ebN] = EXTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
-	  }
-      }
-    for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
-      {
-	int ebN = mesh.interiorElementBoundariesArray[ebNI];
-	mesh.elementBoundaryMaterialTypes[ebN] = INTERIOR_ELEMENT_BOUNDARY_MATERIAL;
-	for (int nN_local = 0; nN_local < mesh.nNodes_elementBoundary; nN_local++)
-	  {
-	    int nN = mesh.elementBoundaryNodesArray[ebN*mesh.nNodes_elementBoundary+nN_local];
-	    if (mesh.nodeMaterialTypes[nN] == DEFAULT_NODE_MATERIAL)
-	      mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
-	  }
-      }
-    //std::cout<<"Elapsed time for populating arrays = "<<(stop-start)<<"s"<<endl;
-    return 0;
-  }
-
-  int constructElementBoundaryElementsArray_hexahedron(Mesh& mesh)
-  {
-    mesh.nNodes_elementBoundary = 4;
-    mesh.nElementBoundaries_element = 6;
-    using namespace std;
-    double start,stop;
-    map<NodeTuple<4>,
-      ElementNeighbors> elementBoundaryElements;
-    start=CurrentTime();
-    
-    int lface[6][4] = {{0,1,2,3},
-                       {0,1,5,4},
-                       {1,2,6,5},
-                       {2,3,7,6},
-                       {3,0,4,7},
-                       {4,5,6,7}};
-    
-    //cout<<"Extracting boundary elements"<<endl;
-    for(int eN=0;eN<mesh.nElements_global;eN++)
-      for(int ebN=0;ebN<mesh.nElementBoundaries_element;ebN++)
-        {
-          int nodes[4];
-          nodes[0] = mesh.elementNodesArray[eN*8+lface[ebN][0]];
-          nodes[1] = mesh.elementNodesArray[eN*8+lface[ebN][1]];
-          nodes[2] = mesh.elementNodesArray[eN*8+lface[ebN][2]];      
-          nodes[3] = mesh.elementNodesArray[eN*8+lface[ebN][3]];
-                    
-          NodeTuple<4> ebt(nodes);
-          if(elementBoundaryElements.find(ebt) != elementBoundaryElements.end())
-            {
-              elementBoundaryElements[ebt].right=eN;
-              elementBoundaryElements[ebt].right_ebN_element=ebN;
-            }
-          else
-            {
-              elementBoundaryElements.insert(elementBoundaryElements.end(),make_pair(ebt,ElementNeighbors(eN,ebN)));
-            }
-        }        
-    stop = CurrentTime();
-    //cout<<"Elapsed time for building element boundary elements map= "<<(stop-start)<<"s"<<endl;
-    mesh.nElementBoundaries_global = elementBoundaryElements.size();
-    //cout<<"nElementBoundaries_global = "<<mesh.nElementBoundaries_global<<endl;
-
-    //cout<<"Allocating Arrays"<<endl;
-    start = CurrentTime();
-    set<int> interiorElementBoundaries,exteriorElementBoundaries;
-    mesh.elementBoundaryNodesArray =  new int[mesh.nElementBoundaries_global*mesh.nNodes_elementBoundary];
-    mesh.elementBoundaryElementsArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementBoundaryLocalElementBoundariesArray = new int[mesh.nElementBoundaries_global*2];
-    mesh.elementNeighborsArray = new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    //mwf added
-    mesh.elementBoundariesArray= new int[mesh.nElements_global*mesh.nElementBoundaries_element];
-    stop = CurrentTime();
-    //cout<<"Elapsed time for allocating arrays = "<<(stop-start)<<"s"<<endl;
-
-    //cout<<"Generating elementBoundaryElementsArray and elementBoundaryNodesArray"<<endl;
-    start = CurrentTime();
-    int ebN=0;
-    for(map<NodeTuple<4>,ElementNeighbors>::iterator eb=elementBoundaryElements.begin();
-        eb != elementBoundaryElements.end();
-        eb++,ebN++)
-      {
-        mesh.elementBoundaryNodesArray[ebN*4 + 0] = eb->first.nodes_unsorted[0];
-        mesh.elementBoundaryNodesArray[ebN*4 + 1] = eb->first.nodes_unsorted[1];
-        mesh.elementBoundaryNodesArray[ebN*4 + 2] = eb->first.nodes_unsorted[2];
-        mesh.elementBoundaryNodesArray[ebN*4 + 3] = eb->first.nodes_unsorted[3];
-
-        mesh.elementBoundaryElementsArray[ebN*2 + 0] = eb->second.left;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 0] = eb->second.left_ebN_element;
-        mesh.elementBoundaryElementsArray[ebN*2 + 1] = eb->second.right;
-        mesh.elementBoundaryLocalElementBoundariesArray[ebN*2 + 1] = eb->second.right_ebN_element;
-        mesh.elementNeighborsArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = eb->second.right; 
-        if(eb->second.right != -1)
-	  {
-	    interiorElementBoundaries.insert(ebN);
-	    mesh.elementNeighborsArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = eb->second.left; 
-	  }
-        else
-          exteriorElementBoundaries.insert(ebN);    
-          //mwf added
-	    mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
-	    if (eb->second.right != -1)
-	    {
-	       mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
- 	    }
-      }    
+          exteriorElementBoundaries.insert(ebN);
+	//mwf added
+	mesh.elementBoundariesArray[eb->second.left*mesh.nElementBoundaries_element + eb->second.left_ebN_element] = ebN;
+	if (eb->second.right != -1)
+	  {
+	    mesh.elementBoundariesArray[eb->second.right*mesh.nElementBoundaries_element + eb->second.right_ebN_element] = ebN;
+ 	  }
+      }
     mesh.nInteriorElementBoundaries_global = interiorElementBoundaries.size();
-    mesh.interiorElementBoundariesArray  =  new int[mesh.nInteriorElementBoundaries_global];
+    mesh.interiorElementBoundariesArray = new int[mesh.nInteriorElementBoundaries_global];
     mesh.nExteriorElementBoundaries_global = exteriorElementBoundaries.size();
     mesh.exteriorElementBoundariesArray = new int[mesh.nExteriorElementBoundaries_global];
     int ebNI=0,ebNE=0;
@@ -1399,65 +1198,33 @@ extern "C"
       mesh.interiorElementBoundariesArray[ebNI] = *ebN;
     for (set<int>::iterator ebN=exteriorElementBoundaries.begin();ebN != exteriorElementBoundaries.end(); ebN++,ebNE++)
       mesh.exteriorElementBoundariesArray[ebNE] = *ebN;
-    set<NodeTuple<2> > edges;
-     
-    int ledge[12][2] = {{0,1},{1,2},{2,3},{3,0},
-                        {0,4},{1,5},{2,6},{3,7},
-                        {4,5},{5,6},{6,7},{7,4}};
-    
-    
-    
-    
-    //std::cout<<"Extracting edges"<<std::endl;
+    //edges are elements in 1D so we just copy over but could be slicker
+    mesh.nEdges_global = mesh.nElements_global;
+    mesh.edgeNodesArray = new int[mesh.nElements_global*2];
     for (int eN=0;eN<mesh.nElements_global;eN++)
       {
-	int nodes[2];
-	for (int e=0;e<12;e++)
-	  {
-    	
-	    nodes[0] = mesh.elementNodesArray[eN*8+ledge[e][0]];
-	    nodes[1] = mesh.elementNodesArray[eN*8+ledge[e][1]];
-                  
-            edges.insert(NodeTuple<2>(nodes));
-	  }   
-      }
-      
-      
-    mesh.nEdges_global = edges.size();
-    mesh.edgeNodesArray = new int[mesh.nEdges_global*2];
-    set<NodeTuple<2> >::iterator edge_p=edges.begin();
-    for (int edgeN=0;edgeN<int(edges.size());edgeN++)
-      {
-        mesh.edgeNodesArray[edgeN*2+0] = edge_p->nodes[0];
-        mesh.edgeNodesArray[edgeN*2+1] = edge_p->nodes[1];
-        edge_p++;
+        mesh.edgeNodesArray[eN*2+0] = mesh.elementNodesArray[eN*2+0];
+        mesh.edgeNodesArray[eN*2+1] = mesh.elementNodesArray[eN*2+1];
       }
-
-    //std::cout<<"Extracting nodeStar"<<std::endl;      
     vector<set<int> > nodeStar(mesh.nNodes_global);
-    for (int edgeN=0;edgeN<mesh.nEdges_global;edgeN++)
+    for (int eN=0;eN<mesh.nElements_global;eN++)
       {
-        nodeStar[mesh.edgeNodesArray[edgeN*2+0]].insert(mesh.edgeNodesArray[edgeN*2+1]);
-        nodeStar[mesh.edgeNodesArray[edgeN*2+1]].insert(mesh.edgeNodesArray[edgeN*2+0]);
+        nodeStar[mesh.edgeNodesArray[eN*2+0]].insert(mesh.edgeNodesArray[eN*2+1]);
+        nodeStar[mesh.edgeNodesArray[eN*2+1]].insert(mesh.edgeNodesArray[eN*2+0]);
       }
-
     mesh.nodeStarOffsets = new int[mesh.nNodes_global+1];
     mesh.nodeStarOffsets[0] = 0;
     for (int nN=1;nN<mesh.nNodes_global+1;nN++)
-      {
-        mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1] + nodeStar[nN-1].size();
-      }  
+      mesh.nodeStarOffsets[nN] = mesh.nodeStarOffsets[nN-1]+nodeStar[nN-1].size();
     mesh.nodeStarArray = new int[mesh.nodeStarOffsets[mesh.nNodes_global]];
     for (int nN=0,offset=0;nN<mesh.nNodes_global;nN++)
       for (set<int>::iterator nN_star=nodeStar[nN].begin();nN_star!=nodeStar[nN].end();nN_star++,offset++)
         mesh.nodeStarArray[offset] = *nN_star;
-    stop = CurrentTime();
     mesh.max_nNodeNeighbors_node=0;
     for (int nN=0;nN<mesh.nNodes_global;nN++)
       mesh.max_nNodeNeighbors_node=max(mesh.max_nNodeNeighbors_node,mesh.nodeStarOffsets[nN+1]-mesh.nodeStarOffsets[nN]);
-    //mwf repeat for node-->elements arrays
-
-    //std::cout<<"Extracting nodeElementsStar"<<std::endl;   
+    stop = CurrentTime();
+    //repeat for node-->elements arrays
     vector<set<int> > nodeElementsStar(mesh.nNodes_global);
     for (int eN = 0; eN < mesh.nElements_global; eN++)
       {
@@ -1470,16 +1237,14 @@ extern "C"
       mesh.nodeElementOffsets[nN+1] = mesh.nodeElementOffsets[nN]+nodeElementsStar[nN].size();
     mesh.nodeElementsArray  = new int[mesh.nodeElementOffsets[mesh.nNodes_global]];
     for (int nN=0,offset=0; nN < mesh.nNodes_global; nN++)
-      {      	
+      {
 	for (set<int>::iterator eN_star = nodeElementsStar[nN].begin(); eN_star != nodeElementsStar[nN].end();
 	     eN_star++,offset++)
 	  {
 	    mesh.nodeElementsArray[offset] = *eN_star;
 	  }
       }
-
-    //std::cout<<"Set material types"<<std::endl;     
-    //mwf end node-->elements construction
+    //end node-->elements construction
     mesh.elementBoundaryMaterialTypes = new int[mesh.nElementBoundaries_global];
     //if nodeMaterial is DEFAULT, go ahead and set to interior or exterior
     //depending on which boundary node belongs to. 
@@ -1495,7 +1260,6 @@ extern "C"
 	      mesh.nodeMaterialTypes[nN] = EXTERIOR_NODE_MATERIAL;
 	  }
       }
-        
     for (int ebNI = 0; ebNI < mesh.nInteriorElementBoundaries_global; ebNI++)
       {
 	int ebN = mesh.interiorElementBoundariesArray[ebNI];
@@ -1507,10 +1271,74 @@ extern "C"
 	      mesh.nodeMaterialTypes[nN] = INTERIOR_NODE_MATERIAL;
 	  }
       }
+
+
     //cout<<"Elapsed time for populating arrays = "<<(stop-start)<<"s"<<endl;
     return 0;
   }
 
+  int constructElementBoundaryElementsArray_triangle(Mesh& mesh)
+  {
+    mesh.nNodes_elementBoundary = 2;
+    mesh.nElementBoundaries_element = 3;
+    const int lface[3][2] = {{1,2},{2,0},{0,1}};
+    const int ledge[3][2] = {{0,1},{0,2},{1,2}};
+    constructElementBoundaries<2>(mesh,lface,true);
+    constructEdges(mesh,3,ledge);
+    constructNodeStarAndNodeElements(mesh);
+    setDefaultElementBoundaryMaterialTypes(mesh);
+    return 0;
+  }
+
+  int constructElementBoundaryElementsArray_quadrilateral(Mesh& mesh)
+  {
+    mesh.nNodes_elementBoundary = 2;
+    mesh.nElementBoundaries_element = 4;
+    const int lface[4][2] = {{0,1},{1,2},{2,3},{3,0}};
+    //all node pairs, including the diagonals
+    const int ledge[6][2] = {{0,1},{0,2},{0,3},{1,2},{1,3},{2,3}};
+    constructElementBoundaries<2>(mesh,lface,true);
+    std::cout<<"nElementBoundaries_global = "<<mesh.nElementBoundaries_global<<std::endl;
+    constructEdges(mesh,6,ledge);
+    constructNodeStarAndNodeElements(mesh);
+    setDefaultElementBoundaryMaterialTypes(mesh);
+    return 0;
+  }
+
+  int constructElementBoundaryElementsArray_tetrahedron(Mesh& mesh)
+  {
+    mesh.nNodes_elementBoundary = 3;
+    mesh.nElementBoundaries_element = 4;
+    const int lface[4][3] = {{1,2,3},{2,3,0},{3,0,1},{0,1,2}};
+    const int ledge[6][2] = {{0,1},{0,2},{0,3},{1,2},{1,3},{2,3}};
+    constructElementBoundaries<3>(mesh,lface,true);
+    constructEdges(mesh,6,ledge);
+    constructNodeStarAndNodeElements(mesh);
+    setDefaultElementBoundaryMaterialTypes(mesh);
+    return 0;
+  }
+
+  int constructElementBoundaryElementsArray_hexahedron(Mesh& mesh)
+  {
+    mesh.nNodes_elementBoundary = 4;
+    mesh.nElementBoundaries_element = 6;
+    const int lface[6][4] = {{0,1,2,3},
+                             {0,1,5,4},
+                             {1,2,6,5},
+                             {2,3,7,6},
+                             {3,0,4,7},
+                             {4,5,6,7}};
+    const int ledge[12][2] = {{0,1},{1,2},{2,3},{3,0},
+                              {0,4},{1,5},{2,6},{3,7},
+                              {4,5},{5,6},{6,7},{7,4}};
+    //hexahedron boundaries keep the local node order of their left element
+    constructElementBoundaries<4>(mesh,lface,false);
+    constructEdges(mesh,12,ledge);
+    constructNodeStarAndNodeElements(mesh);
+    setDefaultElementBoundaryMaterialTypes(mesh);
+    return 0;
+  }
+
 
   int constructElementBoundaryElementsArray_NURBS(Mesh& mesh)
   {
@@ -4011,6 +3839,57 @@ extern "C"
     return 0;
   }
 
+  /**
+     Color the elements so that no two elements of the same color share a
+     node, and color the exterior element boundaries so that no two
+     boundaries of the same color belong to elements sharing a node. Since
+     every continuous or discontinuous DOF lives on the closure of an
+     element, the element and boundary loops of a model can then assemble
+     one color at a time in parallel without atomics. The coloring is
+     cached on the mesh and only rebuilt when the element count changes;
+     call deleteElementColoring after changing the connectivity in place.
+   */
+  int constructElementColoring(Mesh& mesh)
+  {
+    using namespace std;
+    if (mesh.elementColorOffsets != NULL &&
+        mesh.elementColorOffsets[mesh.nElementColors] == mesh.nElements_global &&
+        (mesh.exteriorElementBoundaryColorOffsets == NULL ||
+         mesh.exteriorElementBoundaryColorOffsets[mesh.nExteriorElementBoundaryColors] == mesh.nExteriorElementBoundaries_global))
+      return 0;
+    deleteElementColoring(mesh);
+    assert(mesh.elementNodesArray);
+    proteus::ElementColoring coloring;
+    vector<proteus::ElementDOFMap> maps(1);
+    maps[0].l2g = mesh.elementNodesArray;
+    maps[0].nDOF_element = mesh.nNodes_element;
+    coloring.build(mesh.nElements_global,maps);
+    mesh.nElementColors = coloring.nColors();
+    mesh.elementColorOffsets = new int[mesh.nElementColors+1];
+    mesh.elementColorsArray = new int[mesh.nElements_global];
+    copy(coloring.colorOffsets.begin(),coloring.colorOffsets.end(),mesh.elementColorOffsets);
+    copy(coloring.colorElements.begin(),coloring.colorElements.end(),mesh.elementColorsArray);
+    if (mesh.exteriorElementBoundariesArray != NULL && mesh.elementBoundaryElementsArray != NULL)
+      {
+        vector<int> ebNE_nodes(mesh.nExteriorElementBoundaries_global*mesh.nNodes_element);
+        for (int ebNE=0; ebNE < mesh.nExteriorElementBoundaries_global; ebNE++)
+          {
+            const int ebN = mesh.exteriorElementBoundariesArray[ebNE],
+              eN = mesh.elementBoundaryElementsArray[ebN*2+0];
+            for (int nN=0; nN < mesh.nNodes_element; nN++)
+              ebNE_nodes[ebNE*mesh.nNodes_element+nN] = mesh.elementNodesArray[eN*mesh.nNodes_element+nN];
+          }
+        maps[0].l2g = ebNE_nodes.data();
+        coloring.build(mesh.nExteriorElementBoundaries_global,maps);
+        mesh.nExteriorElementBoundaryColors = coloring.nColors();
+        mesh.exteriorElementBoundaryColorOffsets = new int[mesh.nExteriorElementBoundaryColors+1];
+        mesh.exteriorElementBoundaryColorsArray = new int[mesh.nExteriorElementBoundaries_global];
+        copy(coloring.colorOffsets.begin(),coloring.colorOffsets.end(),mesh.exteriorElementBoundaryColorOffsets);
+        copy(coloring.colorElements.begin(),coloring.colorElements.end(),mesh.exteriorElementBoundaryColorsArray);
+      }
+    return 0;
+  }
+
   //mwftodo get global refinement to preserve element boundary type   
   int globallyRefineEdgeMesh(const int& nLevels, Mesh& mesh, MultilevelMesh& multilevelMesh, bool averageNewNodeFlags)
   {
@@ -4980,19 +4859,18 @@ int readTriangleMesh(Mesh& mesh, const char* filebase, int triangleIndexBase)
   using namespace meshIO;
   assert(filebase);
 
-  int nElements_file, nNodes_file;
-  vector<double> nodeArray_file;
-  vector<int> elementNodesArray_file;
-  vector<int> nodeMaterialTypes_file;
-  vector<int> elementMaterialTypes_file;
+  assert(!mesh.nodeArray);
+  assert(!mesh.nodeMaterialTypes);
+  assert(!mesh.elementNodesArray);
+  assert(!mesh.elementMaterialTypes);
   bool failed = readTriangleMeshNodesAndElements(filebase,
 						 triangleIndexBase,
-						 nElements_file,
-						 nNodes_file,
-						 nodeArray_file,
-						 elementNodesArray_file,
-						 nodeMaterialTypes_file,
-						 elementMaterialTypes_file,
+						 mesh.nElements_global,
+						 mesh.nNodes_global,
+						 mesh.nodeArray,
+						 mesh.elementNodesArray,
+						 mesh.nodeMaterialTypes,
+						 mesh.elementMaterialTypes,
 						 DEFAULT_ELEMENT_MATERIAL,
 						 DEFAULT_NODE_MATERIAL);
   if (failed)
@@ -5003,28 +4881,6 @@ int readTriangleMesh(Mesh& mesh, const char* filebase, int triangleIndexBase)
   
   mesh.nNodes_element =  3; //2d
 
-  //nodes
-  mesh.nNodes_global = nNodes_file;
-  assert(!mesh.nodeArray);
-  mesh.nodeArray     = new double[mesh.nNodes_global*3];
-
-  copy(nodeArray_file.begin(),nodeArray_file.end(),mesh.nodeArray);
-  assert(!mesh.nodeMaterialTypes);
-  mesh.nodeMaterialTypes = new int[mesh.nNodes_global];
-  copy(nodeMaterialTypes_file.begin(),nodeMaterialTypes_file.end(),
-       mesh.nodeMaterialTypes);
-
-  mesh.nElements_global = nElements_file;
-  assert(!mesh.elementNodesArray);
-  mesh.elementNodesArray = new int[mesh.nElements_global*mesh.nNodes_element];
-  assert(!mesh.elementMaterialTypes);
-  mesh.elementMaterialTypes = new int[mesh.nElements_global];
-
-  copy(elementNodesArray_file.begin(),elementNodesArray_file.end(),
-       mesh.elementNodesArray);
-  copy(elementMaterialTypes_file.begin(),elementMaterialTypes_file.end(),
-       mesh.elementMaterialTypes);
-
   return 0;
 }
 
@@ -5128,19 +4984,18 @@ int readTetgenMesh(Mesh& mesh, const char* filebase, int tetgenIndexBase)
   using namespace meshIO;
   assert(filebase);
 
-  int nElements_file, nNodes_file;
-  vector<double> nodeArray_file;
-  vector<int> elementNodesArray_file;
-  vector<int> nodeMaterialTypes_file;
-  vector<int> elementMaterialTypes_file;
+  assert(!mesh.nodeArray);
+  assert(!mesh.nodeMaterialTypes);
+  assert(!mesh.elementNodesArray);
+  assert(!mesh.elementMaterialTypes);
   bool failed = readTetgenMeshNodesAndElements(filebase,
 					       tetgenIndexBase,
-					       nElements_file,
-					       nNodes_file,
-					       nodeArray_file,
-					       elementNodesArray_file,
-					       nodeMaterialTypes_file,
-					       elementMaterialTypes_file,
+					       mesh.nElements_global,
+					       mesh.nNodes_global,
+					       mesh.nodeArray,
+					       mesh.elementNodesArray,
+					       mesh.nodeMaterialTypes,
+					       mesh.elementMaterialTypes,
 					       DEFAULT_ELEMENT_MATERIAL,
 					       DEFAULT_NODE_MATERIAL);
   if (failed)
@@ -5151,28 +5006,6 @@ int readTetgenMesh(Mesh& mesh, const char* filebase, int tetgenIndexBase)
   
   mesh.nNodes_element =  4; //3d
 
-  //nodes
-  mesh.nNodes_global = nNodes_file;
-  assert(!mesh.nodeArray);
-  mesh.nodeArray     = new double[mesh.nNodes_global*3];
-  copy(nodeArray_file.begin(),nodeArray_file.end(),mesh.nodeArray);
-
-  assert(!mesh.nodeMaterialTypes);
-  mesh.nodeMaterialTypes = new int[mesh.nNodes_global];
-  copy(nodeMaterialTypes_file.begin(),nodeMaterialTypes_file.end(),
-       mesh.nodeMaterialTypes);
-  
-  mesh.nElements_global = nElements_file;
-  assert(!mesh.elementNodesArray);
-  mesh.elementNodesArray = new int[mesh.nElements_global*mesh.nNodes_element];
-  assert(!mesh.elementMaterialTypes);
-  mesh.elementMaterialTypes = new int[mesh.nElements_global];
-
-  copy(elementNodesArray_file.begin(),elementNodesArray_file.end(),
-       mesh.elementNodesArray);
-  copy(elementMaterialTypes_file.begin(),elementMaterialTypes_file.end(),
-       mesh.elementMaterialTypes);
-
   return 0;
 }
 int readTetgenElementBoundaryMaterialTypes(Mesh& mesh, const char* filebase, int tetgenIndexBase)
@@ -5488,180 +5321,289 @@ int writeTetgenMesh(Mesh& mesh, const char* filebase, int tetgenIndexBase)
   return failed;
 }
 
-int read3DM(Mesh& mesh, const char* filebase, int indexBase)
+int writeBinaryMesh(Mesh& mesh, const char* filename)
 {
   /***************************************************
-    read nodes and element information from XMS 3DM
-     formatted mesh assuming base name in filebase
-    and base for integer indexing is indexBase
-
+    write the fully constructed mesh (topology, material
+    types and geometric info) in the native binary format
+    so it can be loaded with readBinaryMesh without
+    parsing or rebuilding anything
   **************************************************/
   using namespace std;
-  assert(filebase);
-  bool failed=true;
-  std::string meshFilename= std::string(filebase)+".3dm";
-  std::ifstream meshFile(meshFilename.c_str());
-  if (!meshFile.good())
+  assert(filename);
+  if (!mesh.elementNodesArray || !mesh.nodeArray || !mesh.elementBoundariesArray || !mesh.elementDiametersArray)
     {
-      std::cerr<<"read3DM cannot open file "
-	       <<meshFilename<<std::endl;
-      failed = true;
-      return failed;
+      cerr<<"writeBinaryMesh: mesh topology and geometric info must be constructed before writing "<<filename<<endl;
+      return 1;
     }
-  //read elements
-  std::string fileType;
-  meshFile>>fileType;
-  if (fileType != "MESH3D")
+  vector<BinaryMeshArray> arrays = binaryMeshArrays(mesh);
+  vector<BinaryMeshArray> present;
+  for (size_t i=0;i<arrays.size();i++)
     {
-      std::cerr<<"read3DM does not recognize filetype "
-	       <<fileType<<std::endl;
-      failed = true;
-      return failed;
+      if (arrays[i].iarray ? *arrays[i].iarray == NULL : *arrays[i].darray == NULL)
+        continue;
+      if (arrays[i].id == 3)
+        arrays[i].count = mesh.nodeElementOffsets ? mesh.nodeElementOffsets[mesh.nNodes_global] : -1;
+      if (arrays[i].id == 13)
+        arrays[i].count = mesh.nodeStarOffsets ? mesh.nodeStarOffsets[mesh.nNodes_global] : -1;
+      if (arrays[i].count < 0)
+        continue;
+      present.push_back(arrays[i]);
     }
-  std::string firstWord;
-  meshFile>>firstWord;
-  mesh.nElements_global=0;
-  std::vector<int> elementNodesArray_file;
-  std::vector<int> elementMaterialTypes_file;
-  int eN,n0,n1,n2,n3,emt;
-  while (firstWord == "E4T")
+  vector<char> header(BINARY_MESH_HEADER_SIZE + present.size()*BINARY_MESH_SECTION_SIZE,0);
+  const int counts[BINARY_MESH_N_COUNTS]={mesh.nElements_global,
+                                          mesh.nNodes_global,
+                                          mesh.nNodes_element,
+                                          mesh.nNodes_elementBoundary,
+                                          mesh.nElementBoundaries_element,
+                                          mesh.nElementBoundaries_global,
+                                          mesh.nInteriorElementBoundaries_global,
+                                          mesh.nExteriorElementBoundaries_global,
+                                          mesh.max_nElements_node,
+                                          mesh.nEdges_global,
+                                          mesh.max_nNodeNeighbors_node};
+  const double scalars[BINARY_MESH_N_SCALARS]={mesh.h,mesh.hMin,mesh.sigmaMax,mesh.volume};
+  const unsigned int nSections = present.size();
+  memcpy(&header[0],BINARY_MESH_MAGIC,8);
+  memcpy(&header[8],&BINARY_MESH_BYTE_ORDER,4);
+  memcpy(&header[12],&BINARY_MESH_VERSION,4);
+  memcpy(&header[16],counts,4*BINARY_MESH_N_COUNTS);
+  memcpy(&header[60],&nSections,4);
+  memcpy(&header[64],scalars,8*BINARY_MESH_N_SCALARS);
+  unsigned long long offset = header.size();
+  for (size_t i=0;i<present.size();i++)
     {
-      mesh.nElements_global+=1;
-      meshFile>>eN>>n0>>n1>>n2>>n3>>emt;
-      elementNodesArray_file.push_back(n0-indexBase);
-      elementNodesArray_file.push_back(n1-indexBase);
-      elementNodesArray_file.push_back(n2-indexBase);
-      elementNodesArray_file.push_back(n3-indexBase);
-      elementMaterialTypes_file.push_back(emt-indexBase);
-      meshFile>>firstWord;
+      const unsigned int entrySize = present[i].iarray ? sizeof(int) : sizeof(double);
+      const unsigned long long count = present[i].count;
+      offset = ((offset + BINARY_MESH_ALIGNMENT - 1)/BINARY_MESH_ALIGNMENT)*BINARY_MESH_ALIGNMENT;
+      char* section = &header[BINARY_MESH_HEADER_SIZE + i*BINARY_MESH_SECTION_SIZE];
+      memcpy(section,&present[i].id,4);
+      memcpy(section+4,&entrySize,4);
+      memcpy(section+8,&count,8);
+      memcpy(section+16,&offset,8);
+      offset += count*entrySize;
     }
-  std::vector<int> nodeMaterialTypes_file;
-  std::vector<double> nodeArray_file;
-  int nN;
-  double x,y,z;
-  mesh.nNodes_global=0;
-  while (!meshFile.eof() && firstWord == "ND")
+  ofstream meshFile(filename,ios::binary|ios::trunc);
+  if (!meshFile.good())
     {
-      mesh.nNodes_global+=1;
-      meshFile>>nN>>x>>y>>z;
-      nodeArray_file.push_back(x);
-      nodeArray_file.push_back(y);
-      nodeArray_file.push_back(z);
-      nodeMaterialTypes_file.push_back(0);
-      meshFile>>firstWord;
+      cerr<<"writeBinaryMesh: cannot open "<<filename<<endl;
+      return 1;
+    }
+  meshFile.write(&header[0],header.size());
+  const char padding[BINARY_MESH_ALIGNMENT]={0};
+  for (size_t i=0;i<present.size();i++)
+    {
+      unsigned long long sectionOffset;
+      memcpy(&sectionOffset,&header[BINARY_MESH_HEADER_SIZE + i*BINARY_MESH_SECTION_SIZE + 16],8);
+      meshFile.write(padding,sectionOffset - (unsigned long long)(meshFile.tellp()));
+      if (present[i].iarray)
+        meshFile.write(reinterpret_cast<const char*>(*present[i].iarray),present[i].count*sizeof(int));
+      else
+        meshFile.write(reinterpret_cast<const char*>(*present[i].darray),present[i].count*sizeof(double));
+    }
+  if (!meshFile.good())
+    {
+      cerr<<"writeBinaryMesh: error writing "<<filename<<endl;
+      return 1;
     }
-  mesh.nNodes_element =  4;
-  assert(!mesh.nodeArray);
-  mesh.nodeArray     = new double[mesh.nNodes_global*3];
-  copy(nodeArray_file.begin(),nodeArray_file.end(),mesh.nodeArray);
-  
-  assert(!mesh.nodeMaterialTypes);
-  mesh.nodeMaterialTypes = new int[mesh.nNodes_global];
-  copy(nodeMaterialTypes_file.begin(),nodeMaterialTypes_file.end(),
-       mesh.nodeMaterialTypes);
-  
-  assert(!mesh.elementNodesArray);
-  mesh.elementNodesArray = new int[mesh.nElements_global*mesh.nNodes_element];
-  copy(elementNodesArray_file.begin(),elementNodesArray_file.end(),
-       mesh.elementNodesArray);
-
-  assert(!mesh.elementMaterialTypes);
-  mesh.elementMaterialTypes = new int[mesh.nElements_global];
-  copy(elementMaterialTypes_file.begin(),elementMaterialTypes_file.end(),
-       mesh.elementMaterialTypes);
   return 0;
 }
 
-int read2DM(Mesh& mesh, const char* filebase, int indexBase)
+/* true if offsets[0..n] starts at 0, never decreases and ends at the length of the array it indexes */
+static bool binaryMeshOffsetsMatch(const int* offsets, int n, long long length)
 {
-  /***************************************************
-    read nodes and element information from XMS 2DM
-     formatted mesh assuming base name  filebase
-    and base for integer indexing is indexBase
+  if (offsets[0] != 0 || offsets[n] != length)
+    return false;
+  for (int i=0;i<n;i++)
+    if (offsets[i+1] < offsets[i])
+      return false;
+  return true;
+}
 
+int readBinaryMesh(Mesh& mesh, const char* filename)
+{
+  /***************************************************
+    load a mesh written by writeBinaryMesh; the file is
+    mapped and each array is copied straight into the
+    mesh, byte swapped if it was written on a machine
+    with the other byte order
   **************************************************/
   using namespace std;
-  assert(filebase);
-  bool failed=true;
-  std::string meshFilename= std::string(filebase)+".3dm";
-  std::ifstream meshFile(meshFilename.c_str());
-  if (!meshFile.good())
+  assert(filename);
+  assert(!mesh.elementNodesArray);
+  assert(!mesh.nodeArray);
+  int fd = open(filename,O_RDONLY);
+  if (fd < 0)
     {
-      std::cerr<<"read2DM cannot open file "
-	       <<meshFilename<<std::endl;
-      failed = true;
-      return failed;
+      cerr<<"readBinaryMesh: cannot open "<<filename<<endl;
+      return 1;
     }
-  //read elements
-  std::string fileType;
-  meshFile>>fileType;
-  if (fileType != "MESH2D")
+  struct stat fileStat;
+  if (fstat(fd,&fileStat) != 0 || size_t(fileStat.st_size) < BINARY_MESH_HEADER_SIZE)
     {
-      std::cerr<<"read2DM does not recognize filetype "
-	       <<fileType<<std::endl;
-      failed = true;
-      return failed;
+      cerr<<"readBinaryMesh: "<<filename<<" is not a proteus binary mesh"<<endl;
+      close(fd);
+      return 1;
     }
-  std::string meshName;
-  std::string firstWord;
-  meshFile>>meshName;
-  if (meshName == "E3T")
-    firstWord = meshName;
-  else
+  const size_t fileSize = fileStat.st_size;
+  void* mapped = mmap(NULL,fileSize,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if (mapped == MAP_FAILED)
     {
-      meshFile>>meshName;
-      logEvent(&("Reading 2DM"+meshName)[0],5); 
-      meshFile>>firstWord;
+      cerr<<"readBinaryMesh: cannot map "<<filename<<endl;
+      return 1;
     }
-  mesh.nElements_global=0;
-  std::vector<int> elementNodesArray_file;
-  std::vector<int> elementMaterialTypes_file;
-  int eN,n0,n1,n2,emt;
-  while (firstWord == "E3T")
+#ifdef MADV_SEQUENTIAL
+  madvise(mapped,fileSize,MADV_SEQUENTIAL);
+#endif
+  const char* data = static_cast<const char*>(mapped);
+  int failed = 0;
+  unsigned int byteOrder;
+  memcpy(&byteOrder,data+8,4);
+  const bool swap = (byteOrder != BINARY_MESH_BYTE_ORDER);
+  if (memcmp(data,BINARY_MESH_MAGIC,8) != 0 ||
+      binaryMeshValue<unsigned int>(data,8,swap) != BINARY_MESH_BYTE_ORDER)
     {
-      mesh.nElements_global+=1;
-      meshFile>>eN>>n0>>n1>>n2>>emt;
-      elementNodesArray_file.push_back(n0-indexBase);
-      elementNodesArray_file.push_back(n1-indexBase);
-      elementNodesArray_file.push_back(n2-indexBase);
-      elementMaterialTypes_file.push_back(emt-indexBase);
-      meshFile>>firstWord;
+      cerr<<"readBinaryMesh: "<<filename<<" is not a proteus binary mesh"<<endl;
+      failed = 1;
     }
-  std::vector<int> nodeMaterialTypes_file;
-  std::vector<double> nodeArray_file;
-  int nN;
-  double x,y,z;
-  mesh.nNodes_global=0;
-  while (!meshFile.eof() && firstWord == "ND")
+  else if (binaryMeshValue<unsigned int>(data,12,swap) != BINARY_MESH_VERSION)
     {
-      mesh.nNodes_global+=1;
-      meshFile>>nN>>x>>y>>z;
-      nodeArray_file.push_back(x);
-      nodeArray_file.push_back(y);
-      nodeArray_file.push_back(z);
-      nodeMaterialTypes_file.push_back(0);
-      meshFile>>firstWord;
+      cerr<<"readBinaryMesh: "<<filename<<" has format version "<<binaryMeshValue<unsigned int>(data,12,swap)
+          <<", expected "<<BINARY_MESH_VERSION<<endl;
+      failed = 1;
     }
-  mesh.nNodes_element =  3;
-  assert(!mesh.nodeArray);
-  mesh.nodeArray     = new double[mesh.nNodes_global*3];
-  copy(nodeArray_file.begin(),nodeArray_file.end(),mesh.nodeArray);
-  
-  assert(!mesh.nodeMaterialTypes);
-  mesh.nodeMaterialTypes = new int[mesh.nNodes_global];
-  copy(nodeMaterialTypes_file.begin(),nodeMaterialTypes_file.end(),
-       mesh.nodeMaterialTypes);
-  
-  assert(!mesh.elementNodesArray);
-  mesh.elementNodesArray = new int[mesh.nElements_global*mesh.nNodes_element];
-  copy(elementNodesArray_file.begin(),elementNodesArray_file.end(),
-       mesh.elementNodesArray);
+  const unsigned int nSections = failed ? 0 : binaryMeshValue<unsigned int>(data,60,swap);
+  if (!failed && BINARY_MESH_HEADER_SIZE + size_t(nSections)*BINARY_MESH_SECTION_SIZE > fileSize)
+    {
+      cerr<<"readBinaryMesh: "<<filename<<" is truncated"<<endl;
+      failed = 1;
+    }
+  if (!failed)
+    {
+      int* counts[BINARY_MESH_N_COUNTS]={&mesh.nElements_global,
+                                         &mesh.nNodes_global,
+                                         &mesh.nNodes_element,
+                                         &mesh.nNodes_elementBoundary,
+                                         &mesh.nElementBoundaries_element,
+                                         &mesh.nElementBoundaries_global,
+                                         &mesh.nInteriorElementBoundaries_global,
+                                         &mesh.nExteriorElementBoundaries_global,
+                                         &mesh.max_nElements_node,
+                                         &mesh.nEdges_global,
+                                         &mesh.max_nNodeNeighbors_node};
+      for (int i=0;i<BINARY_MESH_N_COUNTS;i++)
+        *counts[i] = binaryMeshValue<int>(data,16+4*i,swap);
+      double* scalars[BINARY_MESH_N_SCALARS]={&mesh.h,&mesh.hMin,&mesh.sigmaMax,&mesh.volume};
+      for (int i=0;i<BINARY_MESH_N_SCALARS;i++)
+        *scalars[i] = binaryMeshValue<double>(data,64+8*i,swap);
+    }
+  vector<BinaryMeshArray> arrays = binaryMeshArrays(mesh);
+  //lengths of the arrays indexed through an offsets array, checked once both are loaded
+  long long nNodeElements = -1, nNodeStar = -1;
+  for (unsigned int s=0;s<nSections && !failed;s++)
+    {
+      const size_t section = BINARY_MESH_HEADER_SIZE + s*BINARY_MESH_SECTION_SIZE;
+      const unsigned int id = binaryMeshValue<unsigned int>(data,section,swap);
+      const unsigned int entrySize = binaryMeshValue<unsigned int>(data,section+4,swap);
+      const unsigned long long count = binaryMeshValue<unsigned long long>(data,section+8,swap);
+      const unsigned long long offset = binaryMeshValue<unsigned long long>(data,section+16,swap);
+      BinaryMeshArray* array = NULL;
+      for (size_t i=0;i<arrays.size();i++)
+        if (arrays[i].id == id)
+          array = &arrays[i];
+      if (array == NULL)
+        continue;
+      if (entrySize == 0 || offset > fileSize || count > (fileSize - offset)/entrySize)
+        {
+          cerr<<"readBinaryMesh: "<<filename<<" is truncated"<<endl;
+          failed = 1;
+          break;
+        }
+      if (entrySize != (array->iarray ? sizeof(int) : sizeof(double)) ||
+          (array->count >= 0 && count != (unsigned long long)(array->count)) ||
+          (array->iarray ? *array->iarray != NULL : *array->darray != NULL))
+        {
+          cerr<<"readBinaryMesh: section "<<id<<" of "<<filename<<" does not match the mesh dimensions"<<endl;
+          failed = 1;
+          break;
+        }
+      char* target;
+      if (array->iarray)
+        target = reinterpret_cast<char*>(*array->iarray = new int[count]);
+      else
+        target = reinterpret_cast<char*>(*array->darray = new double[count]);
+      memcpy(target,data+offset,count*entrySize);
+      if (swap)
+        byteSwap(target,entrySize,count);
+      if (id == 3)
+        nNodeElements = count;
+      if (id == 13)
+        nNodeStar = count;
+    }
+  munmap(mapped,fileSize);
+  if (!failed)
+    {
+      if (!mesh.elementNodesArray || !mesh.nodeArray)
+        failed = 1;
+      if (mesh.nodeElementsArray && !mesh.nodeElementOffsets)
+        failed = 1;
+      if (mesh.nodeStarArray && !mesh.nodeStarOffsets)
+        failed = 1;
+      if (failed)
+        cerr<<"readBinaryMesh: "<<filename<<" is missing mesh arrays"<<endl;
+    }
+  if (!failed &&
+      ((mesh.nodeElementsArray && !binaryMeshOffsetsMatch(mesh.nodeElementOffsets,mesh.nNodes_global,nNodeElements)) ||
+       (mesh.nodeStarArray && !binaryMeshOffsetsMatch(mesh.nodeStarOffsets,mesh.nNodes_global,nNodeStar))))
+    {
+      cerr<<"readBinaryMesh: the node element or node star offsets of "<<filename<<" do not match the array lengths"<<endl;
+      failed = 1;
+    }
+  if (failed)
+    {
+      for (size_t i=0;i<arrays.size();i++)
+        {
+          if (arrays[i].iarray && *arrays[i].iarray)
+            {
+              delete [] *arrays[i].iarray;
+              *arrays[i].iarray = NULL;
+            }
+          if (arrays[i].darray && *arrays[i].darray)
+            {
+              delete [] *arrays[i].darray;
+              *arrays[i].darray = NULL;
+            }
+        }
+      deleteMesh(mesh);
+    }
+  return failed;
+}
 
-  assert(!mesh.elementMaterialTypes);
-  mesh.elementMaterialTypes = new int[mesh.nElements_global];
-  copy(elementMaterialTypes_file.begin(),elementMaterialTypes_file.end(),
-       mesh.elementMaterialTypes);
-  return 0;
+int read3DM(Mesh& mesh, const char* filebase, int indexBase)
+{
+  /***************************************************
+    read nodes and element information from XMS 3DM
+     formatted mesh assuming base name in filebase
+    and base for integer indexing is indexBase
+
+  **************************************************/
+  assert(filebase);
+  std::string meshFilename= std::string(filebase)+".3dm";
+  return readXMSMesh(mesh,meshFilename,indexBase,"read3DM","3DM","MESH3D","E4T",4);
+}
+
+int read2DM(Mesh& mesh, const char* filebase, int indexBase)
+{
+  /***************************************************
+    read nodes and element information from XMS 2DM
+     formatted mesh assuming base name  filebase
+    and base for integer indexing is indexBase
+
+  **************************************************/
+  assert(filebase);
+  std::string meshFilename= std::string(filebase)+".3dm";
+  return readXMSMesh(mesh,meshFilename,indexBase,"read2DM","2DM","MESH2D","E3T",3);
 }
 
 int readHex(Mesh& mesh, const char* filebase, int indexBase)
@@ -71,6 +71,14 @@ extern "C"
     //for adaptive mesh refinement
     int * newestNodeBases;
 
+    //element and exterior element boundary colors for threaded assembly
+    int nElementColors,
+      nExteriorElementBoundaryColors;
+    int *elementColorOffsets,        //offsets for indexing into elementColorsArray
+      *elementColorsArray,           //the element numbers of each color, ascending within a color
+      *exteriorElementBoundaryColorOffsets,
+      *exteriorElementBoundaryColorsArray; //the exterior element boundary numbers (ebNE) of each color
+
     //for parallel computations
     
     int *elementOffsets_subdomain_owned,
@@ -121,6 +129,14 @@ extern "C"
     mesh.nodeSupportArray=NULL;
     mesh.newestNodeBases=NULL;
 
+    //coloring
+    mesh.nElementColors=0;
+    mesh.nExteriorElementBoundaryColors=0;
+    mesh.elementColorOffsets=NULL;
+    mesh.elementColorsArray=NULL;
+    mesh.exteriorElementBoundaryColorOffsets=NULL;
+    mesh.exteriorElementBoundaryColorsArray=NULL;
+
     //parallel
     mesh.elementOffsets_subdomain_owned=NULL;
     mesh.elementNumbering_subdomain2global=NULL;
@@ -143,6 +159,8 @@ extern "C"
 
     //geometry
     mesh.elementDiametersArray=NULL;
+    mesh.elementInnerDiametersArray=NULL;
+    mesh.elementBoundaryDiametersArray=NULL;
     mesh.h=0.0;
     mesh.hMin=0.0;
     mesh.sigmaMax=0.0;
@@ -161,6 +179,20 @@ extern "C"
 
   }
 
+  inline void deleteElementColoring(Mesh& mesh)
+  {
+    mesh.nElementColors=0;
+    mesh.nExteriorElementBoundaryColors=0;
+    if(mesh.elementColorOffsets!=NULL) delete [] mesh.elementColorOffsets;
+    if(mesh.elementColorsArray!=NULL) delete [] mesh.elementColorsArray;
+    if(mesh.exteriorElementBoundaryColorOffsets!=NULL) delete [] mesh.exteriorElementBoundaryColorOffsets;
+    if(mesh.exteriorElementBoundaryColorsArray!=NULL) delete [] mesh.exteriorElementBoundaryColorsArray;
+    mesh.elementColorOffsets=NULL;
+    mesh.elementColorsArray=NULL;
+    mesh.exteriorElementBoundaryColorOffsets=NULL;
+    mesh.exteriorElementBoundaryColorsArray=NULL;
+  }
+
   inline void deleteMesh(Mesh& mesh)
   {
   	 	
@@ -195,11 +227,14 @@ extern "C"
     if(mesh.nodeMaterialTypes!=NULL) delete [] mesh.nodeMaterialTypes;
     if(mesh.nodeArray!=NULL) delete [] mesh.nodeArray;
     if(mesh.elementDiametersArray!=NULL) delete [] mesh.elementDiametersArray;
+    if(mesh.elementInnerDiametersArray!=NULL) delete [] mesh.elementInnerDiametersArray;
+    if(mesh.elementBoundaryDiametersArray!=NULL) delete [] mesh.elementBoundaryDiametersArray;
     if(mesh.elementBarycentersArray!=NULL) delete [] mesh.elementBarycentersArray;
     if(mesh.elementBoundaryBarycentersArray!=NULL) delete [] mesh.elementBoundaryBarycentersArray;
     if(mesh.nodeDiametersArray!=NULL) delete [] mesh.nodeDiametersArray;
     if(mesh.nodeSupportArray!=NULL) delete [] mesh.nodeSupportArray;
     if(mesh.newestNodeBases!=NULL) delete [] mesh.newestNodeBases;
+    deleteElementColoring(mesh);
    
     // NURBS
     mesh.nx=mesh.ny=mesh.nz=0;
@@ -240,6 +275,12 @@ extern "C"
     mesh.nodeArray=NULL;
     mesh.elementBarycentersArray=NULL;
     mesh.elementBoundaryBarycentersArray=NULL;
+    mesh.elementDiametersArray=NULL;
+    mesh.elementInnerDiametersArray=NULL;
+    mesh.elementBoundaryDiametersArray=NULL;
+    mesh.nodeDiametersArray=NULL;
+    mesh.nodeSupportArray=NULL;
+    mesh.newestNodeBases=NULL;
 
     //parallel
     mesh.elementOffsets_subdomain_owned=NULL;
@@ -373,6 +414,8 @@ extern "C"
   int assignElementBoundaryMaterialTypesFromParent(Mesh& parentMesh, Mesh& childMesh, const int* levelElementParentsArray,
 						   const int& nSpace_global);
   int allocateNodeAndElementNodeDataStructures(Mesh& mesh, int nElements_global, int nNodes_global, int nNodes_element);
+
+  int constructElementColoring(Mesh& mesh);
   //mwf added for converting from triangle data structure
   struct triangulateio;
 
@@ -384,6 +427,8 @@ extern "C"
   int readTetgenMesh(Mesh& mesh, const char* filebase, int base);
   int readTetgenElementBoundaryMaterialTypes(Mesh& mesh, const char* filebase, int base);
   int writeTetgenMesh(Mesh& mesh, const char* filebase, int base);
+  int readBinaryMesh(Mesh& mesh, const char* filename);
+  int writeBinaryMesh(Mesh& mesh, const char* filename);
   int read3DM(Mesh& mesh, const char* filebase, int indexBase);
   int read2DM(Mesh& mesh, const char* filebase, int indexBase);
   int readHex(Mesh& mesh, const char* filebase, int indexBase);
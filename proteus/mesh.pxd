@@ -50,6 +50,13 @@ cdef extern from "mesh.h":
       double h,hMin,sigmaMax,volume
       int * newestNodeBases
 
+      int nElementColors
+      int nExteriorElementBoundaryColors
+      int *elementColorOffsets
+      int *elementColorsArray
+      int *exteriorElementBoundaryColorOffsets
+      int *exteriorElementBoundaryColorsArray
+
       int *elementOffsets_subdomain_owned
       int *elementNumbering_subdomain2global
       int *nodeOffsets_subdomain_owned
@@ -64,6 +71,8 @@ cdef extern from "mesh.h":
 
     cdef void deleteMesh(Mesh& mesh)
 
+    cdef void deleteElementColoring(Mesh& mesh)
+
     cdef struct MultilevelMesh:
         int nLevels
         Mesh* meshArray
@@ -242,6 +251,7 @@ cdef extern from "mesh.h":
                                                       int nElements_global,
                                                       int nNodes_global,
                                                       int nNodes_element)
+    cdef int constructElementColoring(Mesh& mesh)
     cdef struct triangulateio
 
     cdef int setFromTriangleElements(triangulateio* trimesh,
@@ -268,6 +278,10 @@ cdef extern from "mesh.h":
     cdef int writeTetgenMesh(Mesh& mesh,
                              const char* filebase,
                              int base)
+    cdef int readBinaryMesh(Mesh& mesh,
+                            const char* filename)
+    cdef int writeBinaryMesh(Mesh& mesh,
+                             const char* filename)
     cdef int read3DM(Mesh& mesh,
                      const char* filebase,
                      int indexBase)
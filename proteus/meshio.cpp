@@ -5,6 +5,11 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace IOutils
 {
@@ -28,6 +33,49 @@ std::istream & eatcomments(std::istream & s)
   return s ;
 }
 
+MappedFile::MappedFile(const std::string& filename):
+  data(0),
+  size(0)
+{
+  int fd = open(filename.c_str(),O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat fileStat;
+  if (fstat(fd,&fileStat) == 0 && fileStat.st_size > 0)
+    {
+      void* map = mmap(0,fileStat.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+      if (map != MAP_FAILED)
+        {
+          madvise(map,fileStat.st_size,MADV_SEQUENTIAL);
+          data = static_cast<const char*>(map);
+          size = fileStat.st_size;
+        }
+    }
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data)
+    munmap(const_cast<char*>(data),size);
+}
+
+std::vector<const char*> splitLines(const char* begin, const char* end, size_t chunkSize)
+{
+  std::vector<const char*> chunks(1,begin);
+  const char* p = begin;
+  while (size_t(end - p) > chunkSize)
+    {
+      p = endOfLine(p + chunkSize,end);
+      if (p < end)
+        p++;
+      chunks.push_back(p);
+    }
+  if (chunks.back() < end)
+    chunks.push_back(end);
+  return chunks;
+}
+
 }//IOUtils
 
 namespace meshIO
@@ -37,113 +85,301 @@ namespace meshIO
 
  **********************************************************************/
 
-bool 
-readTriangleMeshNodesAndElements(const char * filebase,
-				 const int& indexBase,
-				 int& nElements, int& nNodes,
-				 std::vector<double>& nodeArray,
-				 std::vector<int>& 
-				 elementNodesArray,
-				 std::vector<int>& nodeMaterialTypes,
-				 std::vector<int>& elementMaterialTypes,
-				 const int& defaultElementMaterialType,
-				 const int& defaultNodeMaterialType)
+/***********************************************************************
+  chunked parsers for the .node and .ele files shared by the triangle
+  and tetgen readers: the mapped file is split into line aligned
+  chunks, the records in each chunk are counted to give every record
+  its ordinal, and the chunks are then parsed concurrently straight
+  into the output arrays
+ **********************************************************************/
+namespace
 {
-  bool failed = false;
-  const int simplexDim = 2+1;
-  const int vertexDim  =3; //always
-  using namespace IOutils;
-  std::string vertexFileName  = std::string(filebase) + ".node" ;
-  std::string elementFileName = std::string(filebase) + ".ele" ;
+using IOutils::MappedFile;
 
-  std::ifstream vertexFile(vertexFileName.c_str());
-  std::ifstream elementFile(elementFileName.c_str());
-  
-  if (!vertexFile.good())
+/// position of the first record line (the header) in [p,end), or end
+const char* findHeader(const char* p, const char* end)
+{
+  while (p < end)
     {
-      std::cerr<<"readTriangleMeshNodeAndElements cannot open file "
-	  <<vertexFileName<<std::endl;
-      failed = true;
-      return failed;
+      const char* lineEnd = IOutils::endOfLine(p,end);
+      if (IOutils::isRecord(p,lineEnd))
+        return p;
+      p = lineEnd + 1;
     }
-  if (!elementFile.good())
-    {
-      std::cerr<<"readTriangleMeshNodeAndElements cannot open file "
-	  <<elementFileName<<std::endl;
-      failed = true;
-      return failed;
+  return end;
+}
+
+/// number of record lines in each chunk, exclusive prefix sum in recordStart
+int countRecords(const std::vector<const char*>& chunks, std::vector<long long>& recordStart)
+{
+  const int nChunks = int(chunks.size()) - 1;
+  recordStart.assign(nChunks+1,0);
+#pragma omp parallel for schedule(dynamic)
+  for (int c = 0; c < nChunks; c++)
+    {
+      long long nRecords = 0;
+      for (const char* p = chunks[c]; p < chunks[c+1];)
+        {
+          const char* lineEnd = IOutils::endOfLine(p,chunks[c+1]);
+          if (IOutils::isRecord(p,lineEnd))
+            nRecords++;
+          p = lineEnd + 1;
+        }
+      recordStart[c+1] = nRecords;
     }
+  for (int c = 0; c < nChunks; c++)
+    recordStart[c+1] += recordStart[c];
+  return nChunks;
+}
 
-  int hasMarkers(0),hasAttributes(0),nSpace(2);
-  //read vertices
-  vertexFile >> eatcomments >> nNodes >> nSpace >> hasAttributes 
-	     >> hasMarkers >> eatline ;
-  assert(nNodes > 0);
-  assert(nSpace == 2);
+template<int nSpace>
+bool readSimplexNodes(const std::string& vertexFileName,
+                      const char* caller,
+                      const int& indexBase,
+                      int& nNodes,
+                      double*& nodeArray,
+                      int*& nodeMaterialTypes,
+                      const int& defaultNodeMaterialType)
+{
+  using namespace IOutils;
+  const int vertexDim = 3; //always
+  MappedFile vertexFile(vertexFileName);
+  if (!vertexFile.good())
+    {
+      std::cerr<<caller<<" cannot open file "<<vertexFileName<<std::endl;
+      return true;
+    }
+  const char* header = findHeader(vertexFile.begin(),vertexFile.end());
+  const char* headerEnd = endOfLine(header,vertexFile.end());
+  int nSpace_file(0),hasAttributes(0),hasMarkers(0);
+  const char* p = header;
+  if (!(parseInt(p,headerEnd,nNodes) && parseInt(p,headerEnd,nSpace_file)) || nNodes <= 0 || nSpace_file != nSpace)
+    {
+      std::cerr<<caller<<" bad header in "<<vertexFileName<<std::endl;
+      return true;
+    }
+  if (parseInt(p,headerEnd,hasAttributes))
+    parseInt(p,headerEnd,hasMarkers);
   if (hasAttributes > 0)
     {
-      std::cerr<<"WARNING readTriangle nodes hasAttributes= "<<hasAttributes
-	       <<" > 0 will treat first value as integer id for boundary!!"<<std::endl;
+      std::cerr<<"WARNING "<<caller<<" nodes hasAttributes= "<<hasAttributes
+               <<" > 0 will treat first value as integer id for boundary!!"<<std::endl;
       hasMarkers = 1;
     }
-  nodeArray.resize(vertexDim*nNodes);
-  nodeMaterialTypes.resize(nNodes,defaultNodeMaterialType);
+  const char* records = std::min(headerEnd + 1,vertexFile.end());
+  std::vector<const char*> chunks = splitLines(records,vertexFile.end());
+  std::vector<long long> recordStart;
+  const int nChunks = countRecords(chunks,recordStart);
+  if (recordStart[nChunks] < nNodes)
+    {
+      std::cerr<<caller<<" found "<<recordStart[nChunks]<<" of "<<nNodes
+               <<" nodes in "<<vertexFileName<<std::endl;
+      return true;
+    }
+  nodeArray = new double[vertexDim*nNodes];
+  nodeMaterialTypes = new int[nNodes];
+#pragma omp parallel for
+  for (int nN = 0; nN < nNodes; nN++)
+    {
+      nodeArray[vertexDim*nN + 0] = 0.0;
+      nodeArray[vertexDim*nN + 1] = 0.0;
+      nodeArray[vertexDim*nN + 2] = 0.0;//could use a default
+      nodeMaterialTypes[nN] = defaultNodeMaterialType;
+    }
+  int nBadRecords = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nBadRecords)
+  for (int c = 0; c < nChunks; c++)
+    {
+      long long record = recordStart[c];
+      for (const char* line = chunks[c]; line < chunks[c+1] && record < nNodes;)
+        {
+          const char* lineEnd = endOfLine(line,chunks[c+1]);
+          if (isRecord(line,lineEnd))
+            {
+              const char* q = line;
+              int nv,nodeId(0);
+              double x[nSpace];
+              bool good = parseInt(q,lineEnd,nv);
+              for (int d = 0; d < nSpace; d++)
+                good = good && parseDouble(q,lineEnd,x[d]);
+              if (hasMarkers > 0)
+                good = good && parseInt(q,lineEnd,nodeId);
+              nv -= indexBase;
+              if (good && 0 <= nv && nv < nNodes)
+                {
+                  for (int d = 0; d < nSpace; d++)
+                    nodeArray[vertexDim*nv + d] = x[d];
+                  if (hasMarkers > 0)
+                    nodeMaterialTypes[nv] = nodeId;
+                }
+              else
+                nBadRecords++;
+              record++;
+            }
+          line = lineEnd + 1;
+        }
+    }
+  if (nBadRecords > 0)
+    {
+      std::cerr<<caller<<" could not parse "<<nBadRecords<<" node records in "
+               <<vertexFileName<<std::endl;
+      delete [] nodeArray;
+      delete [] nodeMaterialTypes;
+      nodeArray = 0;
+      nodeMaterialTypes = 0;
+      return true;
+    }
+  return false;
+}
 
-  for (int iv = 0; iv < nNodes; iv++)
+template<int nSpace>
+bool readSimplexElements(const std::string& elementFileName,
+                         const char* caller,
+                         const int& indexBase,
+                         const int& nNodes,
+                         int& nElements,
+                         int*& elementNodesArray,
+                         int*& elementMaterialTypes,
+                         const int& defaultElementMaterialType)
+{
+  using namespace IOutils;
+  const int simplexDim = nSpace+1;
+  MappedFile elementFile(elementFileName);
+  if (!elementFile.good())
     {
-      int nv; double x,y; int nodeId(0);
-      vertexFile >> eatcomments >> nv >> x >> y;
-      if (hasMarkers > 0)
-	vertexFile >> nodeId;
-      nv -= indexBase;
-      assert(0 <= nv && nv < nNodes && vertexFile.good());
-      nodeArray[vertexDim*nv + 0] = x;
-      nodeArray[vertexDim*nv + 1] = y;
-      nodeArray[vertexDim*nv + 2] = 0.0;//could use a default
-      if (hasMarkers > 0)
-	nodeMaterialTypes[nv] = nodeId;
-      vertexFile >> eatline;
-    }//end iv
-  vertexFile.close();
-  
-  //read elements
-  int nNodesPerSimplex(simplexDim); hasMarkers = 0;
-  elementFile >> eatcomments >> nElements >> nNodesPerSimplex >> hasMarkers  >> eatline;
-  assert(nElements > 0);
-  assert(nNodesPerSimplex == simplexDim); //not allow midface nodes yet
- 
-  elementNodesArray.resize(simplexDim*nElements);
-  elementMaterialTypes.resize(nElements,defaultElementMaterialType);
-  
-  for (int ie = 0; ie < nElements; ie++)
+      std::cerr<<caller<<" cannot open file "<<elementFileName<<std::endl;
+      return true;
+    }
+  const char* header = findHeader(elementFile.begin(),elementFile.end());
+  const char* headerEnd = endOfLine(header,elementFile.end());
+  int nNodesPerSimplex(0),hasMarkers(0);
+  const char* p = header;
+  //not allow midface nodes yet
+  if (!(parseInt(p,headerEnd,nElements) && parseInt(p,headerEnd,nNodesPerSimplex)) || nElements <= 0 || nNodesPerSimplex != simplexDim)
+    {
+      std::cerr<<caller<<" bad header in "<<elementFileName<<std::endl;
+      return true;
+    }
+  parseInt(p,headerEnd,hasMarkers);
+  const char* records = std::min(headerEnd + 1,elementFile.end());
+  std::vector<const char*> chunks = splitLines(records,elementFile.end());
+  std::vector<long long> recordStart;
+  const int nChunks = countRecords(chunks,recordStart);
+  if (recordStart[nChunks] < nElements)
+    {
+      std::cerr<<caller<<" found "<<recordStart[nChunks]<<" of "<<nElements
+               <<" elements in "<<elementFileName<<std::endl;
+      return true;
+    }
+  elementNodesArray = new int[simplexDim*nElements];
+  elementMaterialTypes = new int[nElements];
+#pragma omp parallel for
+  for (int eN = 0; eN < nElements; eN++)
     {
-      int ne, nv, elementId(0);
-      long double elementId_double;
-      elementFile >> eatcomments >> ne;
-      ne -= indexBase;
-      assert(0 <= ne && ne < nElements && elementFile.good());
       for (int iv = 0; iv < simplexDim; iv++)
-	{
-	  elementFile >> nv ; nv -= indexBase;
-	  assert(0 <= nv && nv < nNodes);
-	  elementNodesArray[simplexDim*ne + iv] = nv;
-#ifdef DEBUG_LEVEL_2
-	  std::cout<<"readNodesAndMesh ie= "<<ie<<" "<<iv<<" ---> "
-		   <<nv<<std::endl;
-#endif
-	}//end iv
-      if (hasMarkers > 0)
-	{
-	  elementFile >> elementId_double;
-          //elementId = lrintl(elementId_double);
-          elementId = static_cast<long int>(elementId_double);
-	  elementMaterialTypes[ne] = elementId;
-	}
-      elementFile >> eatline;
-    }//end ie
-  elementFile.close();
+        elementNodesArray[simplexDim*eN + iv] = 0;
+      elementMaterialTypes[eN] = defaultElementMaterialType;
+    }
+  int nBadRecords = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:nBadRecords)
+  for (int c = 0; c < nChunks; c++)
+    {
+      long long record = recordStart[c];
+      for (const char* line = chunks[c]; line < chunks[c+1] && record < nElements;)
+        {
+          const char* lineEnd = endOfLine(line,chunks[c+1]);
+          if (isRecord(line,lineEnd))
+            {
+              const char* q = line;
+              int ne,nv[simplexDim];
+              double elementId_double(0.0);
+              bool good = parseInt(q,lineEnd,ne);
+              ne -= indexBase;
+              good = good && 0 <= ne && ne < nElements;
+              for (int iv = 0; iv < simplexDim; iv++)
+                {
+                  good = good && parseInt(q,lineEnd,nv[iv]);
+                  nv[iv] -= indexBase;
+                  good = good && 0 <= nv[iv] && nv[iv] < nNodes;
+                }
+              if (hasMarkers > 0)
+                good = good && parseDouble(q,lineEnd,elementId_double);
+              if (good)
+                {
+                  for (int iv = 0; iv < simplexDim; iv++)
+                    elementNodesArray[simplexDim*ne + iv] = nv[iv];
+                  if (hasMarkers > 0)
+                    elementMaterialTypes[ne] = static_cast<long int>(elementId_double);
+                }
+              else
+                nBadRecords++;
+              record++;
+            }
+          line = lineEnd + 1;
+        }
+    }
+  if (nBadRecords > 0)
+    {
+      std::cerr<<caller<<" could not parse "<<nBadRecords<<" element records in "
+               <<elementFileName<<std::endl;
+      delete [] elementNodesArray;
+      delete [] elementMaterialTypes;
+      elementNodesArray = 0;
+      elementMaterialTypes = 0;
+      return true;
+    }
+  return false;
+}
 
-  return failed;
+template<int nSpace>
+bool readSimplexMeshNodesAndElements(const char * filebase,
+                                     const char* caller,
+                                     const int& indexBase,
+                                     int& nElements, int& nNodes,
+                                     double*& nodeArray,
+                                     int*& elementNodesArray,
+                                     int*& nodeMaterialTypes,
+                                     int*& elementMaterialTypes,
+                                     const int& defaultElementMaterialType,
+                                     const int& defaultNodeMaterialType)
+{
+  std::string vertexFileName  = std::string(filebase) + ".node" ;
+  std::string elementFileName = std::string(filebase) + ".ele" ;
+  if (readSimplexNodes<nSpace>(vertexFileName,caller,indexBase,
+                               nNodes,nodeArray,nodeMaterialTypes,
+                               defaultNodeMaterialType))
+    return true;
+  if (readSimplexElements<nSpace>(elementFileName,caller,indexBase,nNodes,
+                                  nElements,elementNodesArray,elementMaterialTypes,
+                                  defaultElementMaterialType))
+    {
+      delete [] nodeArray;
+      delete [] nodeMaterialTypes;
+      nodeArray = 0;
+      nodeMaterialTypes = 0;
+      return true;
+    }
+  return false;
+}
+}
+
+bool 
+readTriangleMeshNodesAndElements(const char * filebase,
+				 const int& indexBase,
+				 int& nElements, int& nNodes,
+				 double*& nodeArray,
+				 int*& elementNodesArray,
+				 int*& nodeMaterialTypes,
+				 int*& elementMaterialTypes,
+				 const int& defaultElementMaterialType,
+				 const int& defaultNodeMaterialType)
+{
+  return readSimplexMeshNodesAndElements<2>(filebase,"readTriangleMeshNodesAndElements",
+                                            indexBase,nElements,nNodes,
+                                            nodeArray,elementNodesArray,
+                                            nodeMaterialTypes,elementMaterialTypes,
+                                            defaultElementMaterialType,
+                                            defaultNodeMaterialType);
 }//end readTriangleMesh
 
 bool 
@@ -339,109 +575,19 @@ bool
 readTetgenMeshNodesAndElements(const char * filebase,
 			       const int& indexBase,
 			       int& nElements, int& nNodes,
-			       std::vector<double>& nodeArray,
-			       std::vector<int>& 
-			       elementNodesArray,
-			       std::vector<int>& nodeMaterialTypes,
-			       std::vector<int>& elementMaterialTypes,
+			       double*& nodeArray,
+			       int*& elementNodesArray,
+			       int*& nodeMaterialTypes,
+			       int*& elementMaterialTypes,
 			       const int& defaultElementMaterialType,
 			       const int& defaultNodeMaterialType)
 {
-  bool failed = false;
-  const int simplexDim = 3+1;
-  const int vertexDim  = 3; //always
-  using namespace IOutils;
-  std::string vertexFileName  = std::string(filebase) + ".node" ;
-  std::string elementFileName = std::string(filebase) + ".ele" ;
-
-  std::ifstream vertexFile(vertexFileName.c_str());
-  std::ifstream elementFile(elementFileName.c_str());
-  
-  if (!vertexFile.good())
-    {
-      std::cerr<<"readTetgenMeshNodeAndElements cannot open file "
-	  <<vertexFileName<<std::endl;
-      failed = true;
-      return failed;
-    }
-  if (!elementFile.good())
-    {
-      std::cerr<<"readTetgenMeshNodeAndElements cannot open file "
-	  <<elementFileName<<std::endl;
-      failed = true;
-      return failed;
-    }
-
-  int hasMarkers(0),hasAttributes(0),nSpace(3);
-  //read vertices
-  vertexFile >> eatcomments >> nNodes >> nSpace >> hasAttributes >> hasMarkers >> eatline ;
-  assert(nNodes > 0);
-  assert(nSpace == 3);
-  if (hasAttributes > 0)
-    {
-      std::cerr<<"WARNING readTriangle nodes hasAttributes= "<<hasAttributes
-	       <<" > 0 will treat first value as integer id for boundary!!"<<std::endl;
-      hasMarkers = 1;
-    }
-  
-  nodeArray.resize(vertexDim*nNodes);
-  nodeMaterialTypes.resize(nNodes,defaultNodeMaterialType);
-
-  for (int iv = 0; iv < nNodes; iv++)
-    {
-      int nv; double x,y,z; int nodeId(0);
-      vertexFile >> eatcomments >> nv >> x >> y >> z;
-      if (hasMarkers > 0)
-	vertexFile >> nodeId;
-      nv -= indexBase;
-      assert(0 <= nv && nv < nNodes && vertexFile.good());
-      nodeArray[vertexDim*nv + 0] = x;
-      nodeArray[vertexDim*nv + 1] = y;
-      nodeArray[vertexDim*nv + 2] = z;
-      if (hasMarkers > 0)
-	nodeMaterialTypes[nv] = nodeId;
-      vertexFile >> eatline;
-    }//end iv
-  vertexFile.close();
-  
-  //read elements
-  int nNodesPerSimplex(simplexDim); hasMarkers = 0;
-  elementFile >> eatcomments >> nElements >> nNodesPerSimplex >> hasMarkers >> eatline;
-  assert(nElements > 0);
-  assert(nNodesPerSimplex == simplexDim); //not allow midface nodes yet
-  
-  elementNodesArray.resize(simplexDim*nElements);
-  elementMaterialTypes.resize(nElements,defaultElementMaterialType);
-
-  for (int ie = 0; ie < nElements; ie++)
-    {
-      int ne, nv, elementId(0);
-      long double elementId_double;
-      elementFile >> eatcomments >> ne;
-      ne -= indexBase;
-      assert(0 <= ne && ne < nElements && elementFile.good());
-      for (int iv = 0; iv < simplexDim; iv++)
-	{
-	  elementFile >> nv ; nv -= indexBase;
-	  assert(0 <= nv && nv < nNodes);
-	  elementNodesArray[simplexDim*ne + iv] = nv;
-#ifdef DEBUG_LEVEL_2
-	  std::cout<<"readNodesAndMesh ie= "<<ie<<" "<<iv<<" ---> "
-		   <<nv<<std::endl;
-#endif
-	}//end iv
-      if (hasMarkers > 0)
-	{
-	  elementFile >> elementId_double;
-          //elementId = lrintl(elementId_double);
-          elementId = static_cast<long int>(elementId_double);
-	  elementMaterialTypes[ne] = elementId;
-	}
-      elementFile >> eatline;
-    }//end ie
-  elementFile.close();
-
-  return failed;
+  return readSimplexMeshNodesAndElements<3>(filebase,"readTetgenMeshNodesAndElements",
+                                            indexBase,nElements,nNodes,
+                                            nodeArray,elementNodesArray,
+                                            nodeMaterialTypes,elementMaterialTypes,
+                                            defaultElementMaterialType,
+                                            defaultNodeMaterialType);
 }//end readTetgenMesh
 
 bool 
@@ -3,6 +3,12 @@
 
 #include <iostream>
 #include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
 /***********************************************************************
   some basic utilities for reading formatted files
  **********************************************************************/
@@ -12,6 +18,98 @@ std::istream& eatline(std::istream& s);
 std::istream& eatchar(std::istream& s);
 std::istream& eatcomments(std::istream& s);
 bool iswhitespace(const char& c);
+
+/***********************************************************************
+  read-only memory map of a whole file, used by the chunked parsers
+  below; begin == end if the file could not be mapped
+ **********************************************************************/
+class MappedFile
+{
+public:
+  MappedFile(const std::string& filename);
+  ~MappedFile();
+  bool good() const { return data != 0; }
+  const char* begin() const { return data; }
+  const char* end() const { return data + size; }
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+  const char* data;
+  size_t size;
+};
+
+/***********************************************************************
+  split [begin,end) into chunks of about chunkSize bytes that start at
+  the beginning of a line; returns the nChunks+1 chunk boundaries
+ **********************************************************************/
+std::vector<const char*> splitLines(const char* begin, const char* end,
+                                    size_t chunkSize = size_t(1) << 22);
+
+inline const char* endOfLine(const char* p, const char* end)
+{
+  const void* newline = memchr(p,'\n',end-p);
+  return newline ? static_cast<const char*>(newline) : end;
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    p++;
+  return p;
+}
+
+/// false for blank lines and lines starting with one of the eatcomments characters
+inline bool isRecord(const char* line, const char* lineEnd)
+{
+  const char* p = skipBlanks(line,lineEnd);
+  return p < lineEnd && !(*p == '!' || *p == '%' || *p == '#' || *p == ';' || *p == '$');
+}
+
+/// parse the next whitespace separated integer, stopping at the first non-digit like operator>>
+inline bool parseInt(const char*& p, const char* end, int& value)
+{
+  p = skipBlanks(p,end);
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = (*p++ == '-');
+  if (p == end || *p < '0' || *p > '9')
+    return false;
+  long long v = 0;
+  while (p < end && *p >= '0' && *p <= '9')
+    v = 10*v + (*p++ - '0');
+  value = int(negative ? -v : v);
+  return true;
+}
+
+/// parse the next whitespace separated floating point number, correctly rounded
+inline bool parseDouble(const char*& p, const char* end, double& value)
+{
+  p = skipBlanks(p,end);
+  if (p < end && *p == '+')
+    p++;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  std::from_chars_result result = std::from_chars(p,end,value);
+  if (result.ec != std::errc())
+    return false;
+  p = result.ptr;
+  return true;
+#else
+  char token[64];
+  size_t n = 0;
+  while (p + n < end && n < sizeof(token) - 1 && !(p[n] == ' ' || p[n] == '\t' || p[n] == '\r' || p[n] == '\n'))
+    {
+      token[n] = p[n];
+      n++;
+    }
+  token[n] = '\0';
+  char* tokenEnd;
+  value = strtod(token,&tokenEnd);
+  if (tokenEnd == token)
+    return false;
+  p += tokenEnd - token;
+  return true;
+#endif
+}
 } //end IOutils
 
 namespace meshIO
@@ -44,17 +142,20 @@ namespace meshIO
   @param elementMaterialTypes, OUT. optional flag for elements (0 by default)
     elementMaterialTypesArray[I] = f_I, 
     Dim = nElements .
+
+  The OUT arrays are allocated with new [] and owned by the caller,
+  and are left unset if the routine fails. The files are memory
+  mapped and their records parsed concurrently.
  **********************************************************************/
 
 bool 
 readTriangleMeshNodesAndElements(const char * filebase, 
 				 const int& indexBase,
 				 int& nElements, int& nNodes,
-				 std::vector<double>& nodeArray,
-				 std::vector<int>& 
-				 elementNodesArray,
-				 std::vector<int>& elementNodeTypesArray,
-				 std::vector<int>& elementMaterialTypesArray,
+				 double*& nodeArray,
+				 int*& elementNodesArray,
+				 int*& nodeMaterialTypesArray,
+				 int*& elementMaterialTypesArray,
 				 const int& defaultElementMaterialType = 0,
 				 const int& defaultNodeMaterialType = 0);
 
@@ -164,16 +265,20 @@ writeTriangleElementBoundaryNodes(const char * filebase,
   @param elementMaterialTypes, OUT. optional flag for elements (0 by default)
     elementMaterialTypesArray[I] = f_I, 
     Dim = nElements .
+
+  The OUT arrays are allocated with new [] and owned by the caller,
+  and are left unset if the routine fails. The files are memory
+  mapped and their records parsed concurrently.
   **********************************************************************/
 
 bool 
 readTetgenMeshNodesAndElements(const char * filebase, 
 			       const int& indexBase,
 			       int& nElements, int& nNodes,
-			       std::vector<double>& nodeArray,
-			       std::vector<int>& elementNodesArray,
-			       std::vector<int>& elementNodeTypesArray,
-			       std::vector<int>& elementMaterialTypesArray,
+			       double*& nodeArray,
+			       int*& elementNodesArray,
+			       int*& nodeMaterialTypesArray,
+			       int*& elementMaterialTypesArray,
 			       const int& defaultElementMaterialType = 0,
 			       const int& defaultNodeMaterialType = 0);
 
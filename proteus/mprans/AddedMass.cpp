@@ -25,8 +25,8 @@ PYBIND11_MODULE(cAddedMass, m)
     xt::import_numpy();
 
     py::class_<cppAddedMass_base>(m, "cppAddedMass_base")
-        .def("calculateResidual", &cppAddedMass_base::calculateResidual)
-        .def("calculateJacobian", &cppAddedMass_base::calculateJacobian);
+        .def("calculateResidual", &cppAddedMass_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppAddedMass_base::calculateJacobian, proteus::release_gil());
 
     m.def("newAddedMass", newAddedMass);
 }
@@ -97,25 +97,57 @@ namespace proteus
         );
     }
 
+    // Like def_readwrite, but replacing a whole internal dict moves its
+    // entries, so the argument blocks bound to them must be bound again
+    template <class M>
+    void bind_internal_dict(py::class_<arguments_dict>& cl, const char* name, M arguments_dict::*member)
+    {
+        cl.def_property(name,
+                py::cpp_function([member](arguments_dict& ad) -> M&
+                {
+                    return ad.*member;
+                }, py::return_value_policy::reference_internal),
+                [member](arguments_dict& ad, const M& m)
+                {
+                    ad.*member = m;
+                    ad.new_generation();
+                });
+    }
+
+    // Sets k in dict d of the type of v. A key set again with a value of
+    // another type is dropped from the dict of the old type first, and
+    // the argument blocks are bound again, so a dict kept across calls
+    // fails on the new type the way a fresh dict would.
+    template <class D, class O, class V>
+    void set_entry(arguments_dict& ad, D& d, O& other, std::string& k, V& v)
+    {
+        if(other.find(k) != other.end())
+        {
+            other.erase(k);
+            ad.new_generation();
+        }
+        d.insert_or_assign(std::move(k), std::move(v));
+    }
+
     void bind_arguments_dict(py::class_<arguments_dict>& cl, const std::string& name)
     {
         cl.def(py::init<>());
 
-        cl.def_readwrite("darray", &arguments_dict::m_darray);
-        cl.def_readwrite("iarray", &arguments_dict::m_iarray);
-        cl.def_readwrite("dscalar", &arguments_dict::m_dscalar);
-        cl.def_readwrite("iscalar", &arguments_dict::m_iscalar);
+        bind_internal_dict(cl, "darray", &arguments_dict::m_darray);
+        bind_internal_dict(cl, "iarray", &arguments_dict::m_iarray);
+        bind_internal_dict(cl, "dscalar", &arguments_dict::m_dscalar);
+        bind_internal_dict(cl, "iscalar", &arguments_dict::m_iscalar);
 
 
         cl.def("__setitem__",
                 [](arguments_dict& ad, std::string& k, xt::pyarray<int>& a)
                 {
-                    ad.m_iarray.insert_or_assign(std::move(k), std::move(a));
+                    set_entry(ad, ad.m_iarray, ad.m_darray, k, a);
                 });
         cl.def("__setitem__",
                 [](arguments_dict& ad, std::string& k, xt::pyarray<double>& a)
                 {
-                    ad.m_darray.insert_or_assign(std::move(k), std::move(a));
+                    set_entry(ad, ad.m_darray, ad.m_iarray, k, a);
                 });
         // IMPORTANT: keep the scalar overloads AFTER the pyarray overloads,
         // because numpy array containing a single elements can be implicitly
@@ -125,12 +157,12 @@ namespace proteus
         cl.def("__setitem__",
                 [](arguments_dict& ad, std::string& k, int i)
                 {
-                    ad.m_iscalar.insert_or_assign(std::move(k), std::move(i));
+                    set_entry(ad, ad.m_iscalar, ad.m_dscalar, k, i);
                 });
         cl.def("__setitem__",
                 [](arguments_dict& ad, std::string& k, double d)
                 {
-                    ad.m_dscalar.insert_or_assign(std::move(k), std::move(d));
+                    set_entry(ad, ad.m_dscalar, ad.m_iscalar, k, d);
                 });
         cl.def("__repr__",
                 [name](arguments_dict& ad)
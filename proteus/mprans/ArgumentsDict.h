@@ -4,6 +4,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include "pybind11/pybind11.h"
 #include "xtensor-python/pyarray.hpp"
 #include "xtensor/xio.hpp"
 
@@ -43,6 +44,7 @@ namespace proteus
         using base_type::empty;
         using base_type::find;
         using base_type::emplace;
+        using base_type::erase;
 
         using base_type::begin;
         using base_type::end;
@@ -73,14 +75,28 @@ namespace proteus
         scalar_dict<std::string, double> m_dscalar;
         scalar_dict<std::string, int> m_iscalar;
 
+        arguments_dict();
+        arguments_dict(const arguments_dict& rhs);
+        arguments_dict& operator=(const arguments_dict& rhs);
+
         template <class T>
         xt::pyarray<T>& array(const std::string& key);
 
         template <class T>
         T& scalar(const std::string& key);
 
+        // Identifies the entries of this dict: it changes whenever
+        // entries may have moved in memory (copy, assignment of a
+        // whole internal dict), never when a value is set
+        std::size_t generation() const;
+        void new_generation();
+
     private:
 
+        std::size_t m_generation;
+
+        static std::size_t next_generation();
+
         template <class D1, class D2>
         typename D1::mapped_type& find_element(const std::string& key,
                                                D1& expected_dict,
@@ -149,6 +165,46 @@ namespace proteus
      * arguments_dict implementation *
      *********************************/
 
+    inline arguments_dict::arguments_dict()
+        : m_generation(next_generation())
+    {
+    }
+
+    inline arguments_dict::arguments_dict(const arguments_dict& rhs)
+        : m_darray(rhs.m_darray)
+        , m_iarray(rhs.m_iarray)
+        , m_dscalar(rhs.m_dscalar)
+        , m_iscalar(rhs.m_iscalar)
+        , m_generation(next_generation())
+    {
+    }
+
+    inline arguments_dict& arguments_dict::operator=(const arguments_dict& rhs)
+    {
+        m_darray = rhs.m_darray;
+        m_iarray = rhs.m_iarray;
+        m_dscalar = rhs.m_dscalar;
+        m_iscalar = rhs.m_iscalar;
+        new_generation();
+        return *this;
+    }
+
+    inline std::size_t arguments_dict::generation() const
+    {
+        return m_generation;
+    }
+
+    inline void arguments_dict::new_generation()
+    {
+        m_generation = next_generation();
+    }
+
+    inline std::size_t arguments_dict::next_generation()
+    {
+        static std::size_t counter = 0;
+        return ++counter;
+    }
+
     template <>
     inline xt::pyarray<double>& arguments_dict::array<double>(const std::string& key)
     {
@@ -207,6 +263,101 @@ namespace proteus
             return " in dict of " + asked_type + " but found in dict of " + tried_type;
         }
     }
+
+    /***************
+     * release_gil *
+     ***************/
+
+    // Call guard of the compute kernels bound through pybind11. A kernel
+    // only touches its model object and the arrays and scalars it gets
+    // through the arguments_dict (element access, no Python API calls),
+    // so it runs without the GIL. Kernels of distinct model objects, and
+    // Python code that does not write to their arrays, may therefore run
+    // concurrently from different Python threads. A model object and the
+    // arrays it writes must not be used from two threads at the same time.
+    using release_gil = pybind11::call_guard<pybind11::gil_scoped_release>;
+
+    /*******************
+     * argument blocks *
+     *******************/
+
+    // A struct of typed pointers to the entries a kernel reads from an
+    // arguments_dict, looked up (and checked) once instead of at every
+    // call. The entries live in the nodes of the internal maps, which do
+    // not move when a key is set again, so the pointers follow the values
+    // set from Python for as long as the dict lives. The block is declared
+    // from a list macro LIST(ARRAY, SCALAR, SCALAR_REF) naming each entry
+    // with its type, one entry per line of a #define continued by
+    // backslashes:
+    //
+    //   #define MY_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF)
+    //     ARRAY(double, u_dof)
+    //     SCALAR(int, nElements_global)
+    //     SCALAR_REF(double, cfl_max)
+    //   PROTEUS_ARGUMENT_BLOCK(my_arguments, MY_ARGUMENTS)
+    //
+    // PROTEUS_ARGUMENT_LOCALS(MY_ARGUMENTS, block) then declares the local
+    // variables the kernel used to get from the dict: a reference for each
+    // ARRAY and SCALAR_REF, a copy for each SCALAR.
+
+#define PROTEUS_ARGUMENT_FIELD_ARRAY(T, name) xt::pyarray<T>* name = nullptr;
+#define PROTEUS_ARGUMENT_FIELD_SCALAR(T, name) T* name = nullptr;
+#define PROTEUS_ARGUMENT_BIND_ARRAY(T, name) name = &args.array<T>(#name);
+#define PROTEUS_ARGUMENT_BIND_SCALAR(T, name) name = &args.scalar<T>(#name);
+#define PROTEUS_ARGUMENT_LOCAL_ARRAY(T, name) xt::pyarray<T>& name = *proteus_block_.name;
+#define PROTEUS_ARGUMENT_LOCAL_SCALAR(T, name) T name = *proteus_block_.name;
+#define PROTEUS_ARGUMENT_LOCAL_SCALAR_REF(T, name) T& name = *proteus_block_.name;
+
+#define PROTEUS_ARGUMENT_BLOCK(block_name, LIST)                              \
+    struct block_name                                                         \
+    {                                                                         \
+        LIST(PROTEUS_ARGUMENT_FIELD_ARRAY, PROTEUS_ARGUMENT_FIELD_SCALAR,     \
+             PROTEUS_ARGUMENT_FIELD_SCALAR)                                   \
+        void bind(::proteus::arguments_dict& args)                            \
+        {                                                                     \
+            LIST(PROTEUS_ARGUMENT_BIND_ARRAY, PROTEUS_ARGUMENT_BIND_SCALAR,   \
+                 PROTEUS_ARGUMENT_BIND_SCALAR)                                \
+        }                                                                     \
+    };
+
+#define PROTEUS_ARGUMENT_LOCALS(LIST, block)                                  \
+    auto& proteus_block_ = block;                                             \
+    LIST(PROTEUS_ARGUMENT_LOCAL_ARRAY, PROTEUS_ARGUMENT_LOCAL_SCALAR,         \
+         PROTEUS_ARGUMENT_LOCAL_SCALAR_REF)
+
+    // Keeps a block bound to the last dict it was used with and binds it
+    // again only when it is called with another dict (or with one whose
+    // entries may have moved), so a kernel called repeatedly with the
+    // same dict does no string lookups.
+    template <class B>
+    class argument_binding
+    {
+    public:
+
+        argument_binding()
+            : m_args(nullptr)
+            , m_generation(0)
+        {
+        }
+
+        B& operator()(arguments_dict& args)
+        {
+            if(&args != m_args || args.generation() != m_generation)
+            {
+                m_args = nullptr;
+                m_block.bind(args);
+                m_args = &args;
+                m_generation = args.generation();
+            }
+            return m_block;
+        }
+
+    private:
+
+        B m_block;
+        const arguments_dict* m_args;
+        std::size_t m_generation;
+    };
 }
 
 #endif
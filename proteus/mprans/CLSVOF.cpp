@@ -25,13 +25,13 @@ PYBIND11_MODULE(cCLSVOF, m)
 
     py::class_<CLSVOF_base>(m, "cCLSVOF_base")
         .def(py::init(&proteus::newCLSVOF))
-        .def("calculateResidual"        , &CLSVOF_base::calculateResidual        )
-        .def("calculateJacobian"        , &CLSVOF_base::calculateJacobian        )
-        .def("calculateMetricsAtEOS"    , &CLSVOF_base::calculateMetricsAtEOS    , return_value_policy::take_ownership)
-        .def("calculateMetricsAtETS"    , &CLSVOF_base::calculateMetricsAtETS    , return_value_policy::take_ownership)
-        .def("normalReconstruction"     , &CLSVOF_base::normalReconstruction     )
-        .def("calculateRhsL2Proj"       , &CLSVOF_base::calculateRhsL2Proj       )
-        .def("calculateLumpedMassMatrix", &CLSVOF_base::calculateLumpedMassMatrix)
-        .def("assembleSpinUpSystem"     , &CLSVOF_base::assembleSpinUpSystem     )
-        .def("FCTStep"                  , &CLSVOF_base::FCTStep                  );
+        .def("calculateResidual"        , &CLSVOF_base::calculateResidual        , proteus::release_gil())
+        .def("calculateJacobian"        , &CLSVOF_base::calculateJacobian        , proteus::release_gil())
+        .def("calculateMetricsAtEOS"    , &CLSVOF_base::calculateMetricsAtEOS    , return_value_policy::take_ownership, proteus::release_gil())
+        .def("calculateMetricsAtETS"    , &CLSVOF_base::calculateMetricsAtETS    , return_value_policy::take_ownership, proteus::release_gil())
+        .def("normalReconstruction"     , &CLSVOF_base::normalReconstruction     , proteus::release_gil())
+        .def("calculateRhsL2Proj"       , &CLSVOF_base::calculateRhsL2Proj       , proteus::release_gil())
+        .def("calculateLumpedMassMatrix", &CLSVOF_base::calculateLumpedMassMatrix, proteus::release_gil())
+        .def("assembleSpinUpSystem"     , &CLSVOF_base::assembleSpinUpSystem     , proteus::release_gil())
+        .def("FCTStep"                  , &CLSVOF_base::FCTStep                  , proteus::release_gil());
 }
@@ -5,6 +5,7 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
 
@@ -31,7 +32,7 @@ namespace proteus
   {
     //The base class defining the interface
   public:
-    std::valarray<double> Rpos, Rneg, FluxCorrectionMatrix;
+    FCTLimiter fct;
     virtual ~CLSVOF_base(){}
     virtual void calculateResidual(arguments_dict& args)=0;
     virtual void calculateJacobian(arguments_dict& args)=0;
@@ -1948,7 +1949,6 @@ namespace proteus
 
       void FCTStep(arguments_dict& args)
       {
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix");
         xt::pyarray<double>& soln = args.array<double>("soln");
@@ -1958,76 +1958,32 @@ namespace proteus
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
         xt::pyarray<double>& MassMatrix = args.array<double>("matrix");
-        Rpos.resize(numDOFs, 0.0);
-        Rneg.resize(numDOFs, 0.0);
-        FluxCorrectionMatrix.resize(NNZ, 0.0);
-        //////////////////
-        // LOOP in DOFs //
-        //////////////////
-        int ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+        double* FluxCorrectionMatrix = fct.componentFlux(0);
+        ////////////////////////////////////
+        // COMPUTE FLUX CORRECTION MATRIX //
+        ////////////////////////////////////
+        fct.computeFlux(0, [&](int i, int j, int ij)
+          {
+            return ((i==j ? 1. : 0.)*lumped_mass_matrix.data()[i] - MassMatrix.data()[ij]) * (solH.data()[j]-solH.data()[i]);
+          });
+        /////////////////////////////
+        // COMPUTE Q AND R VECTORS //
+        /////////////////////////////
+        fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
           {
-            //read some vectors
-            double solHi = solH.data()[i];
-            double solLi = solL.data()[i];
-            double mi = lumped_mass_matrix.data()[i];
-
             double mini=-1.0, maxi=1.0; // global FCT
-            //double mini=1.0E10, maxi=-1.0E10;
-            double Pposi=0, Pnegi=0;
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                // i-th row of flux correction matrix
-                FluxCorrectionMatrix[ij] = ((i==j ? 1. : 0.)*mi - MassMatrix.data()[ij]) * (solH.data()[j]-solHi);
-
-                //mini = fmin(mini,limited_solution.data()[j]);
-                //maxi = fmax(maxi,limited_solution.data()[j]);
-
-                ///////////////////////
-                // COMPUTE P VECTORS //
-                ///////////////////////
-                Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-                Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-                //update ij
-                ij+=1;
-              }
-            ///////////////////////
-            // COMPUTE Q VECTORS //
-            ///////////////////////
-            double Qposi = mi*(maxi-solLi);
-            double Qnegi = mi*(mini-solLi);
-
-            ///////////////////////
-            // COMPUTE R VECTORS //
-            ///////////////////////
-            Rpos[i] = ((Pposi==0) ? 1. : std::min(1.0,Qposi/Pposi));
-            Rneg[i] = ((Pnegi==0) ? 1. : std::min(1.0,Qnegi/Pnegi));
-          } // i DOFs
-
+            double mi = lumped_mass_matrix.data()[i];
+            Qposi = mi*(maxi-solL.data()[i]);
+            Qnegi = mi*(mini-solL.data()[i]);
+          });
         //////////////////////
         // COMPUTE LIMITERS //
         //////////////////////
-        ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.limit(FluxCorrectionMatrix, [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
           {
-            double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-            double Rposi = Rpos[i], Rnegi = Rneg[i];
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                ith_Limiter_times_FluxCorrectionMatrix +=
-                  ((FluxCorrectionMatrix[ij]>0) ? std::min(Rposi,Rneg[j]) : std::min(Rnegi,Rpos[j]))
-                  * FluxCorrectionMatrix[ij];
-                //ith_Limiter_times_FluxCorrectionMatrix += FluxCorrectionMatrix[ij];
-                //update ij
-                ij+=1;
-              }
             limited_solution.data()[i] = solL.data()[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix;
-          }
+          });
       }
     };//CLSVOF
 
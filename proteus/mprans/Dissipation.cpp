@@ -24,6 +24,6 @@ PYBIND11_MODULE(cDissipation, m)
 
     py::class_<Dissipation_base>(m, "cDissipation_base")
         .def(py::init(&proteus::newDissipation))
-        .def("calculateResidual", &Dissipation_base::calculateResidual)
-        .def("calculateJacobian", &Dissipation_base::calculateJacobian);
+        .def("calculateResidual", &Dissipation_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &Dissipation_base::calculateJacobian, proteus::release_gil());
 }
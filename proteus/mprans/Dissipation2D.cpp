@@ -24,6 +24,6 @@ PYBIND11_MODULE(cDissipation2D, m)
 
     py::class_<Dissipation2D_base>(m, "cDissipation2D_base")
         .def(py::init(&proteus::newDissipation2D))
-        .def("calculateResidual", &Dissipation2D_base::calculateResidual)
-        .def("calculateJacobian", &Dissipation2D_base::calculateJacobian);
+        .def("calculateResidual", &Dissipation2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &Dissipation2D_base::calculateJacobian, proteus::release_gil());
 }
@@ -22,15 +22,23 @@ PYBIND11_MODULE(cGN_SW2DCV, m) {
 
   py::class_<GN_SW2DCV_base>(m, "cGN_SW2DCV_base")
       .def(py::init(&proteus::newGN_SW2DCV))
-      .def("convexLimiting", &GN_SW2DCV_base::convexLimiting)
+      .def("convexLimiting", &GN_SW2DCV_base::convexLimiting,
+           proteus::release_gil())
       .def("calculateEdgeBasedCFL", &GN_SW2DCV_base::calculateEdgeBasedCFL,
-           return_value_policy::take_ownership)
-      .def("calculatePreStep", &GN_SW2DCV_base::calculatePreStep)
-      .def("calculateEV", &GN_SW2DCV_base::calculateEV)
+           return_value_policy::take_ownership, proteus::release_gil())
+      .def("calculatePreStep", &GN_SW2DCV_base::calculatePreStep,
+           proteus::release_gil())
+      .def("calculateEV", &GN_SW2DCV_base::calculateEV, proteus::release_gil())
       .def("calculateBoundsAndHighOrderRHS",
-           &GN_SW2DCV_base::calculateBoundsAndHighOrderRHS)
-      .def("calculateResidual", &GN_SW2DCV_base::calculateResidual)
-      .def("calculateMassMatrix", &GN_SW2DCV_base::calculateMassMatrix)
+           &GN_SW2DCV_base::calculateBoundsAndHighOrderRHS,
+           proteus::release_gil())
+      .def("calculateResidual", &GN_SW2DCV_base::calculateResidual,
+           proteus::release_gil())
+      .def("advanceSSP", &GN_SW2DCV_base::advanceSSP, proteus::release_gil())
+      .def("calculateMassMatrix", &GN_SW2DCV_base::calculateMassMatrix,
+           proteus::release_gil())
       .def("calculateLumpedMassMatrix",
-           &GN_SW2DCV_base::calculateLumpedMassMatrix);
+           &GN_SW2DCV_base::calculateLumpedMassMatrix, proteus::release_gil())
+      .def("getAllocationCount", &GN_SW2DCV_base::getAllocationCount)
+      .def("resetAllocationCount", &GN_SW2DCV_base::resetAllocationCount);
 }
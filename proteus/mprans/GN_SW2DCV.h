@@ -3,11 +3,14 @@
 #include "ArgumentsDict.h"
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
+#include "EdgeList.h"
+#include "Workspace.h"
+#include "SSPStepper.h"
 #include "xtensor-python/pyarray.hpp"
 #include <assert.h>
 #include <cmath>
 #include <iostream>
-#include <valarray>
 
 namespace py = pybind11;
 
@@ -97,6 +100,23 @@ namespace proteus {
 
 class GN_SW2DCV_base {
 public:
+  /// slots of the scratch arrays kept between calls
+  enum ScratchArray {
+    H_BT,
+    HU_BT,
+    HV_BT,
+    HETA_BT,
+    HW_BT,
+    HBETA_BT,
+    D_LOW,
+    BAR_DELTASQD_H,
+    BAR_DELTASQD_HETA,
+    SSP_TMP,
+    N_SCRATCH_ARRAYS
+  };
+  FCTLimiter fct;
+  EdgeList edges;
+  Workspace<N_SCRATCH_ARRAYS> work;
   virtual ~GN_SW2DCV_base() {}
   virtual void convexLimiting(arguments_dict &args) = 0;
   virtual double calculateEdgeBasedCFL(arguments_dict &args) = 0;
@@ -104,8 +124,18 @@ public:
   virtual void calculateEV(arguments_dict &args) = 0;
   virtual void calculateBoundsAndHighOrderRHS(arguments_dict &args) = 0;
   virtual void calculateResidual(arguments_dict &args) = 0;
+  virtual int advanceSSP(arguments_dict &args) = 0;
   virtual void calculateMassMatrix(arguments_dict &args) = 0;
   virtual void calculateLumpedMassMatrix(arguments_dict &args) = 0;
+  /// scratch (re)allocations made by the kernels since the last reset
+  int getAllocationCount() const {
+    return work.allocations() + fct.allocations() + edges.allocations();
+  }
+  void resetAllocationCount() {
+    work.resetAllocations();
+    fct.resetAllocations();
+    edges.resetAllocations();
+  }
 };
 
 template <class CompKernelType, int nSpace, int nQuadraturePoints_element,
@@ -243,16 +273,23 @@ public:
     const xt::pyarray<double> &inverse_mesh =
         args.array<double>("inverse_mesh");
 
-    // Create FCT component matrices in vector form
-    std::valarray<double> FCT_h(0., Cx.size()), FCT_hu(0., Cx.size()),
-        FCT_hv(0., Cx.size()), FCT_heta(0., Cx.size()), FCT_hw(0., Cx.size()),
-        FCT_hbeta(0., Cx.size());
+    // FCT component matrices of h, hu, hv, heta, hw and hbeta
+    fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(),
+                   csrColumnOffsets_DofLoops.data(), 6);
+    const double *FCT_h = fct.componentFlux(0);
+    const double *FCT_hu = fct.componentFlux(1);
+    const double *FCT_hv = fct.componentFlux(2);
+    const double *FCT_heta = fct.componentFlux(3);
 
     ////////////////////////////////////////////////////
     // Loop to define FCT matrices for each component //
     ////////////////////////////////////////////////////
-    int ij = 0;
-    for (int i = 0; i < numDOFs; i++) {
+    fct.computeFluxes<6>([&](int i, int j, int ij, double *FCT_ij) {
+      if (j == i) {
+        for (int c = 0; c < 6; c++)
+          FCT_ij[c] = 0.;
+        return;
+      }
       // Read un at ith node
       const double hi = h_old[i];
       const double one_over_hi =
@@ -268,133 +305,115 @@ public:
       const double mi = lumped_mass_matrix[i];
       const double inv_meshSizei = inverse_mesh[i];
 
-      // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-      for (int offset = csrRowIndeces_DofLoops[i];
-           offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-        int j = csrColumnOffsets_DofLoops[offset];
-
-        if (j == i) {
-          FCT_h[ij] = 0.;
-          FCT_hu[ij] = 0.;
-          FCT_hv[ij] = 0.;
-          FCT_heta[ij] = 0.;
-          FCT_hw[ij] = 0.;
-          FCT_hbeta[ij] = 0.;
-        } else {
-          // Read un stuff at jth node
-          const double hj = h_old[j];
-          const double one_over_hj =
-              2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
-          const double huj = hu_old[j];
-          const double uj = huj * one_over_hj;
-          const double hvj = hv_old[j];
-          const double vj = hvj * one_over_hj;
-          const double hetaj = heta_old[j];
-          const double hwj = hw_old[j];
-          const double hbetaj = hbeta_old[j];
-          const double Zj = b_dof[j];
-          const double mj = lumped_mass_matrix[j];
-          const double inv_meshSizej = inverse_mesh[j];
-
-          // Compute star states
-          const double hStarij = fmax(0., hi + Zi - fmax(Zi, Zj));
-          const double hStarji = fmax(0., hj + Zj - fmax(Zi, Zj));
-          //
-          const double hStar_ratio_i = hStarij * one_over_hi;
-          const double hStar_ratio_j = hStarji * one_over_hj;
-          //
-          const double huStarij = hui * hStar_ratio_i;
-          const double hvStarij = hvi * hStar_ratio_i;
-          const double hetaStarij = hetai * std::pow(hStar_ratio_i, 2);
-          const double hwStarij = hwi * hStar_ratio_i;
-          const double hbetaStarij = hbetai * hStar_ratio_i;
-          //
-          const double huStarji = huj * hStar_ratio_j;
-          const double hvStarji = hvj * hStar_ratio_j;
-          const double hetaStarji = hetaj * std::pow(hStar_ratio_j, 2);
-          const double hwStarji = hwj * hStar_ratio_j;
-          const double hbetaStarji = hbetaj * hStar_ratio_j;
-
-          const double b_ij = 0. - MassMatrix[ij] / mj;
-          const double b_ji = 0. - MassMatrix[ij] / mi;
-
-          /* Redefine high-order viscosity. Note that this is not so expensive
-          since we are just accessing and multipying. */
-          const double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
-          const double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
-          const double nxij = Cx[ij] / cij_norm;
-          const double nyij = Cy[ij] / cij_norm;
-          const double nxji = CTx[ij] / cji_norm;
-          const double nyji = CTy[ij] / cji_norm;
-
-          const double muijL = fmax(std::abs(ui * Cx[ij] + vi * Cy[ij]),
-                                    std::abs(uj * CTx[ij] + vj * CTy[ij]));
-          double dijL = fmax(
-              maxWaveSpeedSharpInitialGuess(g, nxij, nyij, hi, hui, hvi, hetai,
-                                            inv_meshSizei, hj, huj, hvj, hetaj,
-                                            inv_meshSizej, hEps) *
-                  cij_norm,
-              maxWaveSpeedSharpInitialGuess(g, nxji, nyji, hj, huj, hvj, hetaj,
-                                            inv_meshSizej, hi, hui, hvi, hetai,
-                                            inv_meshSizei, hEps) *
-                  cji_norm);
-
-          // Take max with muij
-          dijL = std::max(dijL, muijL);
-
-          // Define high-order graph viscosity coefficients
-          const double dEVij =
-              std::max(global_entropy_residual[i], global_entropy_residual[j]);
-
-          const double dijH = std::min(dijL, dEVij);
-          const double muijH = std::min(muijL, dEVij);
-
-          const double diff_dij_muij = (dijH - dijL) - (muijH - muijL);
-          const double diff_muij = (muijH - muijL);
-
-          // h
-          double viscous_terms =
-              diff_dij_muij * (hStarji - hStarij) + diff_muij * (hj - hi);
-          FCT_h[ij] = dt * (b_ij * RHS_high_h[j] - b_ji * RHS_high_h[i] +
-                            viscous_terms);
-          // hu
-          viscous_terms =
-              diff_dij_muij * (huStarji - huStarij) + diff_muij * (huj - hui);
-          FCT_hu[ij] = dt * (b_ij * RHS_high_hu[j] - b_ji * RHS_high_hu[i] +
-                             viscous_terms);
-          // hv
-          viscous_terms =
-              diff_dij_muij * (hvStarji - hvStarij) + diff_muij * (hvj - hvi);
-          FCT_hv[ij] = dt * (b_ij * RHS_high_hv[j] - b_ji * RHS_high_hv[i] +
-                             viscous_terms);
-          // heta
-          viscous_terms = diff_dij_muij * (hetaStarji - hetaStarij) +
-                          diff_muij * (hetaj - hetai);
-          FCT_heta[ij] = dt * (b_ij * RHS_high_heta[j] -
-                               b_ji * RHS_high_heta[i] + viscous_terms);
-          // hw
-          viscous_terms =
-              diff_dij_muij * (hwStarji - hwStarij) + diff_muij * (hwj - hwi);
-          FCT_hw[ij] = dt * (b_ij * RHS_high_hw[j] - b_ji * RHS_high_hw[i] +
-                             viscous_terms);
-          // hbeta
-          viscous_terms = diff_dij_muij * (hbetaStarji - hbetaStarij) +
-                          diff_muij * (hbetaj - hbetai);
-          FCT_hbeta[ij] = dt * (b_ij * RHS_high_hbeta[j] -
-                                b_ji * RHS_high_hbeta[i] + viscous_terms);
-        }
-
-        // UPDATE ij //
-        ij += 1;
-      } // j loop ends here
-    }   // i loop ends here
+      // Read un stuff at jth node
+      const double hj = h_old[j];
+      const double one_over_hj =
+          2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
+      const double huj = hu_old[j];
+      const double uj = huj * one_over_hj;
+      const double hvj = hv_old[j];
+      const double vj = hvj * one_over_hj;
+      const double hetaj = heta_old[j];
+      const double hwj = hw_old[j];
+      const double hbetaj = hbeta_old[j];
+      const double Zj = b_dof[j];
+      const double mj = lumped_mass_matrix[j];
+      const double inv_meshSizej = inverse_mesh[j];
+
+      // Compute star states
+      const double hStarij = fmax(0., hi + Zi - fmax(Zi, Zj));
+      const double hStarji = fmax(0., hj + Zj - fmax(Zi, Zj));
+      //
+      const double hStar_ratio_i = hStarij * one_over_hi;
+      const double hStar_ratio_j = hStarji * one_over_hj;
+      //
+      const double huStarij = hui * hStar_ratio_i;
+      const double hvStarij = hvi * hStar_ratio_i;
+      const double hetaStarij = hetai * std::pow(hStar_ratio_i, 2);
+      const double hwStarij = hwi * hStar_ratio_i;
+      const double hbetaStarij = hbetai * hStar_ratio_i;
+      //
+      const double huStarji = huj * hStar_ratio_j;
+      const double hvStarji = hvj * hStar_ratio_j;
+      const double hetaStarji = hetaj * std::pow(hStar_ratio_j, 2);
+      const double hwStarji = hwj * hStar_ratio_j;
+      const double hbetaStarji = hbetaj * hStar_ratio_j;
+
+      const double b_ij = 0. - MassMatrix[ij] / mj;
+      const double b_ji = 0. - MassMatrix[ij] / mi;
+
+      /* Redefine high-order viscosity. Note that this is not so expensive
+      since we are just accessing and multipying. */
+      const double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
+      const double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
+      const double nxij = Cx[ij] / cij_norm;
+      const double nyij = Cy[ij] / cij_norm;
+      const double nxji = CTx[ij] / cji_norm;
+      const double nyji = CTy[ij] / cji_norm;
+
+      const double muijL = fmax(std::abs(ui * Cx[ij] + vi * Cy[ij]),
+                                std::abs(uj * CTx[ij] + vj * CTy[ij]));
+      double dijL = fmax(
+          maxWaveSpeedSharpInitialGuess(g, nxij, nyij, hi, hui, hvi, hetai,
+                                        inv_meshSizei, hj, huj, hvj, hetaj,
+                                        inv_meshSizej, hEps) *
+              cij_norm,
+          maxWaveSpeedSharpInitialGuess(g, nxji, nyji, hj, huj, hvj, hetaj,
+                                        inv_meshSizej, hi, hui, hvi, hetai,
+                                        inv_meshSizei, hEps) *
+              cji_norm);
+
+      // Take max with muij
+      dijL = std::max(dijL, muijL);
+
+      // Define high-order graph viscosity coefficients
+      const double dEVij =
+          std::max(global_entropy_residual[i], global_entropy_residual[j]);
+
+      const double dijH = std::min(dijL, dEVij);
+      const double muijH = std::min(muijL, dEVij);
+
+      const double diff_dij_muij = (dijH - dijL) - (muijH - muijL);
+      const double diff_muij = (muijH - muijL);
+
+      // h
+      double viscous_terms =
+          diff_dij_muij * (hStarji - hStarij) + diff_muij * (hj - hi);
+      FCT_ij[0] = dt * (b_ij * RHS_high_h[j] - b_ji * RHS_high_h[i] +
+                        viscous_terms);
+      // hu
+      viscous_terms =
+          diff_dij_muij * (huStarji - huStarij) + diff_muij * (huj - hui);
+      FCT_ij[1] = dt * (b_ij * RHS_high_hu[j] - b_ji * RHS_high_hu[i] +
+                        viscous_terms);
+      // hv
+      viscous_terms =
+          diff_dij_muij * (hvStarji - hvStarij) + diff_muij * (hvj - hvi);
+      FCT_ij[2] = dt * (b_ij * RHS_high_hv[j] - b_ji * RHS_high_hv[i] +
+                        viscous_terms);
+      // heta
+      viscous_terms = diff_dij_muij * (hetaStarji - hetaStarij) +
+                      diff_muij * (hetaj - hetai);
+      FCT_ij[3] = dt * (b_ij * RHS_high_heta[j] -
+                        b_ji * RHS_high_heta[i] + viscous_terms);
+      // hw
+      viscous_terms =
+          diff_dij_muij * (hwStarji - hwStarij) + diff_muij * (hwj - hwi);
+      FCT_ij[4] = dt * (b_ij * RHS_high_hw[j] - b_ji * RHS_high_hw[i] +
+                        viscous_terms);
+      // hbeta
+      viscous_terms = diff_dij_muij * (hbetaStarji - hbetaStarij) +
+                      diff_muij * (hbetaj - hbetai);
+      FCT_ij[5] = dt * (b_ij * RHS_high_hbeta[j] -
+                        b_ji * RHS_high_hbeta[i] + viscous_terms);
+    });
 
     ////////////////////////////////////////////////////////////////////
     // Main loop to define limiters and compute limited solution //////
     ////////////////////////////////////////////////////////////////////
 
-    // Create Lij_array and initialize with 1
-    std::valarray<double> Lij_array(1., Cx.size());
+    // Create the limiters, they are recomputed from 1 in every iteration
+    fct.resetLimiter(1.);
 
     // define tolerance for limiting
     const double eps = 1e-14;
@@ -403,9 +422,7 @@ public:
     for (int limit_iter = 0; limit_iter < LIMITING_ITERATION; limit_iter++) {
 
       /* Loop to compute limiter l^j_i and l^i_j */
-      ij = 0;
-      for (int i = 0; i < numDOFs; i++) {
-
+      fct.computeLimiter([&](int i, int j, int ij, double Lij) {
         // Get low order solution at ith node
         const double hLowi = hLow[i];
         const double huLowi = huLow[i];
@@ -414,385 +431,223 @@ public:
         const double kinMaxi = kin_max[i];
         const double mi = lumped_mass_matrix[i];
 
-        // LOOP OVER THE SPARSITY PATTERN (j-LOOP)
-        for (int offset = csrRowIndeces_DofLoops[i];
-             offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-          int j = csrColumnOffsets_DofLoops[offset];
-
-          Lij_array[ij] = 1.;
-
-          // Get low order solution at jth node
-          const double hLowj = hLow[j];
-          const double huLowj = huLow[j];
-          const double hvLowj = hvLow[j];
-          const double hetaLowj = hetaLow[j];
-          const double kinMaxj = kin_max[j];
-          const double mj = lumped_mass_matrix[j];
+        // Get low order solution at jth node
+        const double hLowj = hLow[j];
+        const double huLowj = huLow[j];
+        const double hvLowj = hvLow[j];
+        const double hetaLowj = hetaLow[j];
+        const double kinMaxj = kin_max[j];
+        const double mj = lumped_mass_matrix[j];
 
-          // Compute Pij matrix and Pji
-          double denom = 1. / (mi * thetaj_inv[i]);
-          const double P_h = FCT_h[ij] * denom;
-          const double P_hu = FCT_hu[ij] * denom;
-          const double P_hv = FCT_hv[ij] * denom;
-          const double P_heta = FCT_heta[ij] * denom;
-
-          denom = 1. / (mj * thetaj_inv[j]);
-          const double P_h_tr = -FCT_h[ij] * denom;
-          const double P_hu_tr = -FCT_hu[ij] * denom;
-          const double P_hv_tr = -FCT_hv[ij] * denom;
-          const double P_heta_tr = -FCT_heta[ij] * denom;
-
-          /* h limiting -- to defne l_ji_h */
-          double l_ji_h = Lij_array[ij];
-          {
-            const double denominator = 1. / (std::abs(P_h) + eps * h_max[i]);
-
-            // Define limiter here
-            if (hLowi + P_h < h_min[i]) {
-              l_ji_h = std::min((std::abs(h_min[i] - hLowi) + eps * h_min[i]) *
-                                    denominator,
-                                1.);
-            } else if (h_max[i] < hLowi + P_h) {
-              l_ji_h = std::min((std::abs(h_max[i] - hLowi) + eps * h_min[i]) *
-                                    denominator,
-                                1.);
-            }
-
-            // Set limiter to 0 if water depth is close to 0
-            l_ji_h = (hLowi <= hEps) ? 0. : l_ji_h;
-
-            /* Box limiter to be safe? */
-            l_ji_h = std::min(l_ji_h, 1.);
-            l_ji_h = std::max(l_ji_h, 0.);
+        // Compute Pij matrix and Pji
+        double denom = 1. / (mi * thetaj_inv[i]);
+        const double P_h = FCT_h[ij] * denom;
+        const double P_hu = FCT_hu[ij] * denom;
+        const double P_hv = FCT_hv[ij] * denom;
+        const double P_heta = FCT_heta[ij] * denom;
+
+        denom = 1. / (mj * thetaj_inv[j]);
+        const double P_h_tr = -FCT_h[ij] * denom;
+        const double P_hu_tr = -FCT_hu[ij] * denom;
+        const double P_hv_tr = -FCT_hv[ij] * denom;
+        const double P_heta_tr = -FCT_heta[ij] * denom;
+
+        /* h limiting -- to defne l_ji_h */
+        double l_ji_h = boundLimiter(1., hLowi, P_h, h_min[i], h_max[i], eps);
+        {
+          // Set limiter to 0 if water depth is close to 0
+          l_ji_h = (hLowi <= hEps) ? 0. : l_ji_h;
+
+          /* Box limiter to be safe? */
+          l_ji_h = std::min(l_ji_h, 1.);
+          l_ji_h = std::max(l_ji_h, 0.);
 
 #if IF_LIMITING_DEBUGGING
-            if ((hLowi + l_ji_h * P_h) - h_min[i] < -1e-12) {
-              std::cout << " MAJOR BUG 1a " << std::setprecision(15) << " \n "
-                        << " Diff   =  " << (hLowi + l_ji_h * P_h) - h_min[i]
-                        << " \n "
-                        << " hLowi  = " << hLowi << " \n "
-                        << " h_min  = " << h_min[i] << " \n "
-                        << " h_max  = " << h_max[i] << " \n "
-                        << " l_ji_h = " << l_ji_h << std::endl;
-              std::cout << "LIMIT_ITER " << limit_iter << std::endl;
-              abort();
-            }
-
-            if (h_max[i] - (hLowi + l_ji_h * P_h) < -1e-12) {
-              std::cout << " MAJOR BUG 1b " << std::setprecision(15) << " \n "
-                        << " Diff   = " << h_max[i] - (hLowi + l_ji_h * P_h)
-                        << " \n "
-                        << " Soln   = " << (hLowi + P_h) << " \n "
-                        << " hLowi  = " << hLowi << " \n "
-                        << " h_min  = " << h_min[i] << " \n "
-                        << " h_max  = " << h_max[i] << " \n "
-                        << " P_h    = " << P_h << " \n "
-                        << " l_ji_h = " << l_ji_h << std::endl;
-              std::cout << "LIMIT_ITER " << limit_iter << std::endl;
-              abort();
-            }
-#endif
+          if ((hLowi + l_ji_h * P_h) - h_min[i] < -1e-12) {
+            std::cout << " MAJOR BUG 1a " << std::setprecision(15) << " \n "
+                      << " Diff   =  " << (hLowi + l_ji_h * P_h) - h_min[i]
+                      << " \n "
+                      << " hLowi  = " << hLowi << " \n "
+                      << " h_min  = " << h_min[i] << " \n "
+                      << " h_max  = " << h_max[i] << " \n "
+                      << " l_ji_h = " << l_ji_h << std::endl;
+            std::cout << "LIMIT_ITER " << limit_iter << std::endl;
+            abort();
           }
 
-          /* h limiting -- to define l_ij_h */
-          double l_ij_h = Lij_array[ij];
-          {
-            const double denominator_test =
-                1. / (std::abs(P_h_tr) + eps * h_max[j]);
-
-            if (hLowj + P_h_tr < h_min[j]) {
-              l_ij_h = std::min((std::abs(h_min[j] - hLowj) + eps * h_min[j]) *
-                                    denominator_test,
-                                1.);
-            } else if (h_max[j] < hLowj + P_h_tr) {
-              l_ij_h = std::min((std::abs(h_max[j] - hLowj) + eps * h_min[j]) *
-                                    denominator_test,
-                                1.);
-            }
-
-            // set limiter to 0 if water depth is close to 0
-            l_ij_h = (hLowj <= hEps) ? 0. : l_ij_h;
-
-            /* Box limiter to be safe? */
-            l_ij_h = std::min(l_ij_h, 1.);
-            l_ij_h = std::max(l_ij_h, 0.);
-
-#if IF_LIMITING_DEBUGGING
-            if ((hLowj + l_ij_h * P_h_tr) - h_min[j] < -1e-12) {
-              std::cout << " MAJOR BUG 2a " << std::setprecision(15) << " \n "
-                        << " Diff   =  " << h_min[j] - (hLowj + l_ij_h * P_h_tr)
-                        << " \n "
-                        << " Soln   = " << (hLowj + P_h_tr) << " \n "
-                        << " hLowj  = " << hLowj << " \n "
-                        << " h_min  = " << h_min[j] << " \n "
-                        << " h_max  = " << h_max[j] << " \n "
-                        << " P_h_tr = " << P_h_tr << " \n "
-                        << " l_ij_h = " << l_ij_h << std::endl;
-              std::cout << "LIMIT_ITER " << limit_iter << std::endl;
-              abort();
-            }
-
-            if (h_max[j] - (hLowj + l_ij_h * P_h_tr) < -1e-12) {
-              std::cout << " MAJOR BUG 2b " << std::setprecision(15) << " \n "
-                        << " Diff   =  " << h_max[j] - (hLowj + l_ij_h * P_h_tr)
-                        << " \n "
-                        << " Soln   = " << (hLowj + P_h_tr) << " \n "
-                        << " hLowj  = " << hLowj << " \n "
-                        << " h_min  = " << h_min[j] << " \n "
-                        << " h_max  = " << h_max[j] << " \n "
-                        << " P_h_tr = " << P_h_tr << " \n "
-                        << " l_ij_h = " << l_ij_h << std::endl;
-              std::cout << "LIMIT_ITER " << limit_iter << std::endl;
-              abort();
-            }
-#endif
+          if (h_max[i] - (hLowi + l_ji_h * P_h) < -1e-12) {
+            std::cout << " MAJOR BUG 1b " << std::setprecision(15) << " \n "
+                      << " Diff   = " << h_max[i] - (hLowi + l_ji_h * P_h)
+                      << " \n "
+                      << " Soln   = " << (hLowi + P_h) << " \n "
+                      << " hLowi  = " << hLowi << " \n "
+                      << " h_min  = " << h_min[i] << " \n "
+                      << " h_max  = " << h_max[i] << " \n "
+                      << " P_h    = " << P_h << " \n "
+                      << " l_ji_h = " << l_ji_h << std::endl;
+            std::cout << "LIMIT_ITER " << limit_iter << std::endl;
+            abort();
           }
+#endif
+        }
+
+        /* h limiting -- to define l_ij_h */
+        double l_ij_h =
+            boundLimiter(1., hLowj, P_h_tr, h_min[j], h_max[j], eps);
+        {
+          // set limiter to 0 if water depth is close to 0
+          l_ij_h = (hLowj <= hEps) ? 0. : l_ij_h;
 
-          /* q1 limiting -- to define l_ji_q1 */
-          double l_ji_q1 = l_ji_h;
-          {
-            const double denominator =
-                1. / (std::abs(P_heta) + eps * heta_max[i]);
-
-            // Define limiter here
-            if (hetaLowi + P_heta < heta_min[i]) {
-              l_ji_q1 = std::min(
-                  (std::abs(heta_min[i] - hetaLowi) + eps * heta_min[i]) *
-                      denominator,
-                  1.);
-            } else if (heta_max[i] < hetaLowi + P_heta) {
-              l_ji_q1 = std::min(
-                  (std::abs(heta_max[i] - hetaLowi) + eps * heta_min[i]) *
-                      denominator,
-                  1.);
-            }
-
-            // set limiter to 0 if water depth is close to 0
-            l_ji_q1 = (hLowi <= hEps) ? 0. : l_ji_q1;
-
-            // get min of l_ji_q1 and previous limiter
-            l_ji_q1 = std::min(l_ji_q1, l_ji_h);
-
-            /* Box limiter to be safe? */
-            l_ji_q1 = std::min(l_ji_q1, 1.);
-            l_ji_q1 = std::max(l_ji_q1, 0.);
+          /* Box limiter to be safe? */
+          l_ij_h = std::min(l_ij_h, 1.);
+          l_ij_h = std::max(l_ij_h, 0.);
 
 #if IF_LIMITING_DEBUGGING
-            if ((hetaLowi + l_ji_q1 * P_heta) - heta_min[i] < -hEps * hEps) {
-              std::cout << " MAJOR BUG 3a " << std::setprecision(15) << " \n "
-                        << "New soln " << hetaLowi + l_ji_q1 * P_heta << " \n "
-                        << "hetaLowi " << hetaLowi << " \n "
-                        << "heta_min " << heta_min[i] << " \n "
-                        << "heta_max " << heta_max[i] << " \n "
-                        << "l_ji_q1  " << l_ji_q1 << " \n "
-                        << "test hi  " << hLowi << std::endl;
-              if (heta_max[i] > -hEps)
-                abort();
-            }
-
-            if (heta_max[i] - (hetaLowi + l_ji_q1 * P_heta) < -hEps * hEps) {
-              std::cout << " MAJOR BUG 3b " << std::setprecision(15) << " \n "
-                        << "New soln " << hetaLowi + l_ji_q1 * P_heta << " \n "
-                        << "hetaLowi " << hetaLowi << " \n "
-                        << "heta_min " << heta_min[i] << " \n "
-                        << "heta_max " << heta_max[i] << " \n "
-                        << "l_ji_q1  " << l_ji_q1 << " \n "
-                        << "test hi  " << hLowi << std::endl;
-              if (heta_max[i] > -hEps)
-                abort();
-            }
-#endif
+          if ((hLowj + l_ij_h * P_h_tr) - h_min[j] < -1e-12) {
+            std::cout << " MAJOR BUG 2a " << std::setprecision(15) << " \n "
+                      << " Diff   =  " << h_min[j] - (hLowj + l_ij_h * P_h_tr)
+                      << " \n "
+                      << " Soln   = " << (hLowj + P_h_tr) << " \n "
+                      << " hLowj  = " << hLowj << " \n "
+                      << " h_min  = " << h_min[j] << " \n "
+                      << " h_max  = " << h_max[j] << " \n "
+                      << " P_h_tr = " << P_h_tr << " \n "
+                      << " l_ij_h = " << l_ij_h << std::endl;
+            std::cout << "LIMIT_ITER " << limit_iter << std::endl;
+            abort();
           }
 
-          /* q1 limiting -- to define l_ij_q1 */
-          double l_ij_q1 = l_ij_h;
-          {
-            const double denominator =
-                1. / (std::abs(P_heta_tr) + eps * heta_max[j]);
-
-            if (hetaLowj + P_heta_tr < heta_min[j]) {
-              l_ij_q1 = std::min(
-                  (std::abs(heta_min[j] - hetaLowj) + eps * heta_min[j]) *
-                      denominator,
-                  1.);
-            } else if (heta_max[j] < hetaLowj + P_heta_tr) {
-              l_ij_q1 = std::min(
-                  (std::abs(heta_max[j] - hetaLowj) + eps * heta_min[j]) *
-                      denominator,
-                  1.);
-            }
-
-            // set limiter to 0 if water depth is close to 0
-            l_ij_q1 = (hLowj <= hEps) ? 0. : l_ij_q1;
-
-            // get min of l_ij_q1 and previous limiter
-            l_ij_q1 = std::min(l_ij_q1, l_ij_h);
-
-            /* Box limiter to be safe? */
-            l_ij_q1 = std::min(l_ij_q1, 1.0);
-            l_ij_q1 = std::max(l_ij_q1, 0.0);
+          if (h_max[j] - (hLowj + l_ij_h * P_h_tr) < -1e-12) {
+            std::cout << " MAJOR BUG 2b " << std::setprecision(15) << " \n "
+                      << " Diff   =  " << h_max[j] - (hLowj + l_ij_h * P_h_tr)
+                      << " \n "
+                      << " Soln   = " << (hLowj + P_h_tr) << " \n "
+                      << " hLowj  = " << hLowj << " \n "
+                      << " h_min  = " << h_min[j] << " \n "
+                      << " h_max  = " << h_max[j] << " \n "
+                      << " P_h_tr = " << P_h_tr << " \n "
+                      << " l_ij_h = " << l_ij_h << std::endl;
+            std::cout << "LIMIT_ITER " << limit_iter << std::endl;
+            abort();
           }
+#endif
+        }
+
+        /* q1 limiting -- to define l_ji_q1 */
+        double l_ji_q1 = boundLimiter(l_ji_h, hetaLowi, P_heta, heta_min[i],
+                                      heta_max[i], eps);
+        {
+          // set limiter to 0 if water depth is close to 0
+          l_ji_q1 = (hLowi <= hEps) ? 0. : l_ji_q1;
+
+          // get min of l_ji_q1 and previous limiter
+          l_ji_q1 = std::min(l_ji_q1, l_ji_h);
+
+          /* Box limiter to be safe? */
+          l_ji_q1 = std::min(l_ji_q1, 1.);
+          l_ji_q1 = std::max(l_ji_q1, 0.);
 
 #if IF_LIMITING_DEBUGGING
-          if ((hetaLowj + l_ij_q1 * P_heta_tr) - heta_min[j] < -hEps * hEps) {
-            std::cout << " MAJOR BUG 4a " << std::setprecision(15) << " \n "
-                      << "New soln " << hetaLowj + l_ij_q1 * P_heta_tr << " \n "
-                      << "hetaLowj " << hetaLowj << " \n "
-                      << "heta_min " << heta_min[j] << " \n "
-                      << "heta_max " << heta_max[j] << " \n "
-                      << "l_ij_q1  " << l_ij_q1 << " \n "
-                      << "test hj  " << hLowj << std::endl;
-            if (heta_max[j] > -hEps)
+          if ((hetaLowi + l_ji_q1 * P_heta) - heta_min[i] < -hEps * hEps) {
+            std::cout << " MAJOR BUG 3a " << std::setprecision(15) << " \n "
+                      << "New soln " << hetaLowi + l_ji_q1 * P_heta << " \n "
+                      << "hetaLowi " << hetaLowi << " \n "
+                      << "heta_min " << heta_min[i] << " \n "
+                      << "heta_max " << heta_max[i] << " \n "
+                      << "l_ji_q1  " << l_ji_q1 << " \n "
+                      << "test hi  " << hLowi << std::endl;
+            if (heta_max[i] > -hEps)
               abort();
           }
 
-          if (heta_max[j] - (hetaLowj + l_ij_q1 * P_heta_tr) < -hEps * hEps) {
-            std::cout << " MAJOR BUG 4b " << std::setprecision(15) << " \n "
-                      << "New soln " << hetaLowj + l_ij_q1 * P_heta_tr << " \n "
-                      << "hetaLowj " << hetaLowj << " \n "
-                      << "heta_min " << heta_min[j] << " \n "
-                      << "heta_max " << heta_max[j] << " \n "
-                      << "l_ij_q1  " << l_ij_q1 << " \n "
-                      << "test hj  " << hLowj << std::endl;
-            if (heta_max[j] > -hEps)
+          if (heta_max[i] - (hetaLowi + l_ji_q1 * P_heta) < -hEps * hEps) {
+            std::cout << " MAJOR BUG 3b " << std::setprecision(15) << " \n "
+                      << "New soln " << hetaLowi + l_ji_q1 * P_heta << " \n "
+                      << "hetaLowi " << hetaLowi << " \n "
+                      << "heta_min " << heta_min[i] << " \n "
+                      << "heta_max " << heta_max[i] << " \n "
+                      << "l_ji_q1  " << l_ji_q1 << " \n "
+                      << "test hi  " << hLowi << std::endl;
+            if (heta_max[i] > -hEps)
               abort();
           }
 #endif
+        }
 
-          /* kinetic energy limiting -- to define l_ji_K */
-          double l_tmp = 0.;
-          double l_ji_K = l_ji_q1;
-          {
-            // We first check if current l_ji_K is a good state
-            const double h_r = hLowi + l_ji_K * P_h;
-            const double hu_r = huLowi + l_ji_K * P_hu;
-            const double hv_r = hvLowi + l_ji_K * P_hv;
-            const double psi =
-                kin_max[i] * h_r - 0.5 * (hu_r * hu_r + hv_r * hv_r);
-
-            l_tmp = (psi > -KE_tiny) ? l_ji_K : l_tmp;
-
-            const double ai = -0.5 * (P_hu * P_hu + P_hv * P_hv);
-            const double ai_nudged = std::min(ai, -KE_tiny);
-            const double bi = kinMaxi * P_h - (huLowi * P_hu + hvLowi * P_hv);
-            const double ci =
-                hLowi * kinMaxi - 0.5 * (huLowi * huLowi + hvLowi * hvLowi);
-
-            const double delta_i = bi * bi - 4. * ai * ci;
-            const double root_i =
-                0.5 / ai_nudged * (-bi - std::sqrt(std::abs(delta_i)));
-
-            // define l_ji_K
-            l_ji_K = (root_i > 0.) ? std::min(root_i, l_ji_K)
-                                   : std::min(l_tmp, l_ji_K);
-
-            /* if previous bound was already satisfied, we should take
-             l_tmp instead of l_ji_K */
-            l_tmp = std::max(l_tmp, l_ji_K);
-
-            // If we are in a "dry state", limiter should be 0
-            l_tmp = (hLowi * kinMaxi <= KE_tiny) ? 0. : l_tmp;
-
-            /* Then box to be safe */
-            l_tmp = std::min(l_tmp, 1.);
-            l_tmp = std::max(l_tmp, 0.);
-          }
-
-          /* Define final l_ji_K */
-          l_ji_K = std::min(l_tmp, l_ji_q1);
-
-          /* kinetic energy limiting -- to define l_ij_K */
-          l_tmp = 0.;
-          double l_ij_K = l_ij_q1;
-          {
-            // We first check if current l_ij_K is a good state
-            const double h_r = hLowj + l_ij_K * P_h_tr;
-            const double hu_r = huLowj + l_ij_K * P_hu_tr;
-            const double hv_r = hvLowj + l_ij_K * P_hv_tr;
-            const double psi =
-                kinMaxj * h_r - 0.5 * (hu_r * hu_r + hv_r * hv_r);
-
-            l_tmp = (psi > -KE_tiny) ? l_ij_K : l_tmp;
-
-            const double aj = -0.5 * (P_hu_tr * P_hu_tr + P_hv_tr * P_hv_tr);
-            const double aj_nudged = std::min(aj, -KE_tiny);
-            const double bj =
-                kinMaxj * P_h_tr - (huLowj * P_hu_tr + hvLowj * P_hv_tr);
-            const double cj =
-                hLowj * kinMaxj - 0.5 * (huLowj * huLowj + hvLowj * hvLowj);
-
-            const double delta_j = bj * bj - 4. * aj * cj;
-            const double root_j =
-                0.5 / aj_nudged * (-bj - std::sqrt(std::abs(delta_j)));
-
-            // define l_ij_K
-            l_ij_K = (root_j > 0.) ? std::min(root_j, l_ij_K)
-                                   : std::min(l_tmp, l_ij_K);
-
-            /* if previous bound was already satisfied, we should take l_tmp
-            instead of l_ij_K */
-            l_tmp = std::max(l_tmp, l_ij_K);
-
-            // If we are in a "dry state", limiter should be 0
-            l_tmp = (hLowj * kinMaxj <= KE_tiny) ? 0. : l_tmp;
-
-            /* Box limiter */
-            l_tmp = std::min(l_tmp, 1.);
-            l_tmp = std::max(l_tmp, 0.);
-          }
+        /* q1 limiting -- to define l_ij_q1 */
+        double l_ij_q1 = boundLimiter(l_ij_h, hetaLowj, P_heta_tr, heta_min[j],
+                                      heta_max[j], eps);
+        {
+          // set limiter to 0 if water depth is close to 0
+          l_ij_q1 = (hLowj <= hEps) ? 0. : l_ij_q1;
 
-          /* Get final l_ij_K*/
-          l_ij_K = std::min(l_tmp, l_ij_q1);
+          // get min of l_ij_q1 and previous limiter
+          l_ij_q1 = std::min(l_ij_q1, l_ij_h);
 
-          /* Then we get the final limiter lij */
-          Lij_array[ij] = std::min(l_ji_K, l_ij_K);
+          /* Box limiter to be safe? */
+          l_ij_q1 = std::min(l_ij_q1, 1.0);
+          l_ij_q1 = std::max(l_ij_q1, 0.0);
+        }
 
 #if IF_LIMITING_DEBUGGING
-          if (Lij_array[ij] > 1. || Lij_array[ij] < 0.) {
-            std::cout << "\n Problem with limiter! \n " << Lij_array[ij]
-                      << "\n Aborting! " << std::endl;
-          }
+        if ((hetaLowj + l_ij_q1 * P_heta_tr) - heta_min[j] < -hEps * hEps) {
+          std::cout << " MAJOR BUG 4a " << std::setprecision(15) << " \n "
+                    << "New soln " << hetaLowj + l_ij_q1 * P_heta_tr << " \n "
+                    << "hetaLowj " << hetaLowj << " \n "
+                    << "heta_min " << heta_min[j] << " \n "
+                    << "heta_max " << heta_max[j] << " \n "
+                    << "l_ij_q1  " << l_ij_q1 << " \n "
+                    << "test hj  " << hLowj << std::endl;
+          if (heta_max[j] > -hEps)
+            abort();
+        }
+
+        if (heta_max[j] - (hetaLowj + l_ij_q1 * P_heta_tr) < -hEps * hEps) {
+          std::cout << " MAJOR BUG 4b " << std::setprecision(15) << " \n "
+                    << "New soln " << hetaLowj + l_ij_q1 * P_heta_tr << " \n "
+                    << "hetaLowj " << hetaLowj << " \n "
+                    << "heta_min " << heta_min[j] << " \n "
+                    << "heta_max " << heta_max[j] << " \n "
+                    << "l_ij_q1  " << l_ij_q1 << " \n "
+                    << "test hj  " << hLowj << std::endl;
+          if (heta_max[j] > -hEps)
+            abort();
+        }
 #endif
-          ij += 1;
-        } // end j loop
-      }   // end i loop
 
-      /* Loop to define limited solution */
-      ij = 0;
-      for (int i = 0; i < numDOFs; i++) {
+        /* kinetic energy limiting -- to define l_ji_K */
+        const double l_ji_K = kineticEnergyLimiter(
+            l_ji_q1, hLowi, huLowi, hvLowi, kinMaxi, P_h, P_hu, P_hv, KE_tiny);
 
-        const double one_over_mi = 1. / lumped_mass_matrix[i];
-        double ith_Limiter_times_FCT_matrix1 = 0.;
-        double ith_Limiter_times_FCT_matrix2 = 0.;
-        double ith_Limiter_times_FCT_matrix3 = 0.;
-        double ith_Limiter_times_FCT_matrix4 = 0.;
-        double ith_Limiter_times_FCT_matrix5 = 0.;
-        double ith_Limiter_times_FCT_matrix6 = 0.;
-
-        // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-        for (int offset = csrRowIndeces_DofLoops[i];
-             offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-          int j = csrColumnOffsets_DofLoops[offset];
+        /* kinetic energy limiting -- to define l_ij_K */
+        const double l_ij_K =
+            kineticEnergyLimiter(l_ij_q1, hLowj, huLowj, hvLowj, kinMaxj,
+                                 P_h_tr, P_hu_tr, P_hv_tr, KE_tiny);
 
-          // COMPUTE LIMITED FLUX //
-          ith_Limiter_times_FCT_matrix1 += Lij_array[ij] * FCT_h[ij];
-          ith_Limiter_times_FCT_matrix2 += Lij_array[ij] * FCT_hu[ij];
-          ith_Limiter_times_FCT_matrix3 += Lij_array[ij] * FCT_hv[ij];
-          ith_Limiter_times_FCT_matrix4 += Lij_array[ij] * FCT_heta[ij];
-          ith_Limiter_times_FCT_matrix5 += Lij_array[ij] * FCT_hw[ij];
-          ith_Limiter_times_FCT_matrix6 += Lij_array[ij] * FCT_hbeta[ij];
+        /* Then we get the final limiter lij */
+        Lij = std::min(l_ji_K, l_ij_K);
 
-          // update ij
-          ij += 1;
-        } // end j loop
+#if IF_LIMITING_DEBUGGING
+        if (Lij > 1. || Lij < 0.) {
+          std::cout << "\n Problem with limiter! \n " << Lij
+                    << "\n Aborting! " << std::endl;
+        }
+#endif
+        return Lij;
+      });
+
+      /* Loop to define limited solution */
+      fct.applyLimiter<6>([&](int i,
+                              const double *ith_Limiter_times_FCT_matrix) {
+        const double one_over_mi = 1. / lumped_mass_matrix[i];
 
         // then we add lij*Aij to uLow
-        hLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix1;
-        huLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix2;
-        hvLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix3;
-        hetaLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix4;
-        hwLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix5;
-        hbetaLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix6;
+        hLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[0];
+        huLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[1];
+        hvLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[2];
+        hetaLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[3];
+        hwLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[4];
+        hbetaLow[i] += one_over_mi * ith_Limiter_times_FCT_matrix[5];
 
 #if IF_LIMITING_DEBUGGING
         if (hLow[i] < -hEps) {
@@ -835,15 +690,10 @@ public:
           abort();
         }
 #endif
-      } // end i loop
+      });
 
       // update FCT matrices as Fct = (1 - Lij)*Fct
-      FCT_h = (1. - Lij_array) * FCT_h;
-      FCT_hu = (1. - Lij_array) * FCT_hu;
-      FCT_hv = (1. - Lij_array) * FCT_hv;
-      FCT_heta = (1. - Lij_array) * FCT_heta;
-      FCT_hw = (1. - Lij_array) * FCT_hw;
-      FCT_hbeta = (1. - Lij_array) * FCT_hbeta;
+      fct.reduceFlux(6);
     } // end loop for limiting iteration
 
     /* Update final solution */
@@ -917,78 +767,59 @@ public:
     xt::pyarray<double> &edge_based_cfl = args.array<double>("edge_based_cfl");
 
     double max_edge_based_cfl = 0.;
-    double dLowij = 0.;
 
-    int ij = 0;
-    for (int i = 0; i < numDOFsPerEqn; i++) {
-
-      // solution at time tn for the ith DOF
-      const double hi = h_dof_old[i];
+    ////////////////////////
+    // DISSIPATIVE MATRIX //
+    ////////////////////////
+    // dLow is symmetric, compute it once per edge
+    double *dLow = work.array(D_LOW, Cx.size());
+    edges.setPattern(numDOFsPerEqn, csrRowIndeces_DofLoops.data(),
+                     csrColumnOffsets_DofLoops.data());
+    edges.symmetricFill(dLow, [&](int i, int j, int ij, int ji) {
+      const double hi = h_dof_old[i], hj = h_dof_old[j];
       const double one_over_hi =
           2. * hi / (hi * hi + std::pow(fmax(hi, hEps), 2));
-      const double hui = hu_dof_old[i];
-      const double hvi = hv_dof_old[i];
-      const double ui = hui * one_over_hi;
-      const double vi = hvi * one_over_hi;
-      const double hetai = heta_dof_old[i];
-      const double mi = lumped_mass_matrix[i];
+      const double one_over_hj =
+          2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
+      const double hui = hu_dof_old[i], hvi = hv_dof_old[i];
+      const double huj = hu_dof_old[j], hvj = hv_dof_old[j];
+      const double ui = hui * one_over_hi, vi = hvi * one_over_hi;
+      const double uj = huj * one_over_hj, vj = hvj * one_over_hj;
+      const double hetai = heta_dof_old[i], hetaj = heta_dof_old[j];
       const double inv_meshSizei = inverse_mesh[i];
+      const double inv_meshSizej = inverse_mesh[j];
+
+      const double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
+      const double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
+      const double nxij = Cx[ij] / cij_norm, nyij = Cy[ij] / cij_norm;
+      const double nxji = CTx[ij] / cji_norm, nyji = CTy[ij] / cji_norm;
+
+      const double muijL = fmax(std::abs(ui * Cx[ij] + vi * Cy[ij]),
+                                std::abs(uj * CTx[ij] + vj * CTy[ij]));
+      const double dLowij =
+          fmax(maxWaveSpeedSharpInitialGuess(
+                   g, nxij, nyij, hi, hui, hvi, hetai, inv_meshSizei, hj, huj,
+                   hvj, hetaj, inv_meshSizej, hEps) *
+                   cij_norm,
+               maxWaveSpeedSharpInitialGuess(
+                   g, nxji, nyji, hj, huj, hvj, hetaj, inv_meshSizej, hi, hui,
+                   hvi, hetai, inv_meshSizei, hEps) *
+                   cji_norm);
+
+      // Take max of dij and muij
+      return fmax(dLowij, muijL);
+    });
 
-      // Initialize diagonal entry
+    for (int i = 0; i < numDOFsPerEqn; i++) {
+      // Define diagonal entry
       double dLowii = 0.;
-
-      for (int offset = csrRowIndeces_DofLoops[i];
-           offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-        // loop in j (sparsity pattern)
-        const int j = csrColumnOffsets_DofLoops[offset];
-
-        // solution at time tn for the jth DOF
-        const double hj = h_dof_old[j];
-        const double one_over_hj =
-            2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
-        const double huj = hu_dof_old[j];
-        const double hvj = hv_dof_old[j];
-        const double uj = huj * one_over_hj;
-        const double vj = hvj * one_over_hj;
-        const double hetaj = heta_dof_old[j];
-        const double mj = lumped_mass_matrix[j];
-        const double inv_meshSizej = inverse_mesh[j];
-
-        if (j != i) {
-          ////////////////////////
-          // DISSIPATIVE MATRIX //
-          ////////////////////////
-          const double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
-          const double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
-          const double nxij = Cx[ij] / cij_norm, nyij = Cy[ij] / cij_norm;
-          const double nxji = CTx[ij] / cji_norm, nyji = CTy[ij] / cji_norm;
-
-          const double muijL = fmax(std::abs(ui * Cx[ij] + vi * Cy[ij]),
-                                    std::abs(uj * CTx[ij] + vj * CTy[ij]));
-          dLowij = fmax(maxWaveSpeedSharpInitialGuess(
-                            g, nxij, nyij, hi, hui, hvi, hetai, inv_meshSizei,
-                            hj, huj, hvj, hetaj, inv_meshSizej, hEps) *
-                            cij_norm,
-                        maxWaveSpeedSharpInitialGuess(
-                            g, nxji, nyji, hj, huj, hvj, hetaj, inv_meshSizej,
-                            hi, hui, hvi, hetai, inv_meshSizei, hEps) *
-                            cji_norm);
-
-          // Take max of dij and muij
-          dLowij = fmax(dLowij, muijL);
-
-          // Define diagonal entry
-          dLowii -= dLowij;
-        }
-
-        // update ij
-        ij += 1;
-      }
+      for (int ij = csrRowIndeces_DofLoops[i];
+           ij < csrRowIndeces_DofLoops[i + 1]; ij++)
+        dLowii -= dLow[ij];
       //////////////////////////////
       // CALCULATE EDGE BASED CFL //
       //////////////////////////////
-      edge_based_cfl[i] = 1.0 * fabs(dLowii) / mi;
+      edge_based_cfl[i] = 1.0 * fabs(dLowii) / lumped_mass_matrix[i];
       max_edge_based_cfl = fmax(max_edge_based_cfl, edge_based_cfl[i]);
     }
 
@@ -1315,14 +1146,18 @@ public:
     //     * High-order right hand side
 
     /* ----------- Here we do some initial declaration --------------- */
-    // Bar states
-    std::valarray<double> hBT(0., Cx.size()), huBT(0., Cx.size()),
-        hvBT(0., Cx.size()), hetaBT(0., Cx.size()), hwBT(0., Cx.size()),
-        hbetaBT(0., Cx.size()), dLow(0., Cx.size());
+    // Bar states (every entry is set in the first loop, dLow off the diagonal)
+    double *hBT = work.array(H_BT, Cx.size()),
+           *huBT = work.array(HU_BT, Cx.size()),
+           *hvBT = work.array(HV_BT, Cx.size()),
+           *hetaBT = work.array(HETA_BT, Cx.size()),
+           *hwBT = work.array(HW_BT, Cx.size()),
+           *hbetaBT = work.array(HBETA_BT, Cx.size()),
+           *dLow = work.array(D_LOW, Cx.size());
 
     // Relaxation quantities
-    std::valarray<double> bar_deltaSqd_h(0., numDOFsPerEqn),
-        bar_deltaSqd_heta(0., numDOFsPerEqn);
+    double *bar_deltaSqd_h = work.array(BAR_DELTASQD_H, numDOFsPerEqn, 0.),
+           *bar_deltaSqd_heta = work.array(BAR_DELTASQD_HETA, numDOFsPerEqn, 0.);
 
     double high_viscosity_h, high_viscosity_hu, high_viscosity_hv,
         high_viscosity_heta, high_viscosity_hw, high_viscosity_hbeta;
@@ -1844,14 +1679,9 @@ public:
 
       kin_max[i] =
           std::max((1. + std::sqrt(mi / size_of_domain)) * kin_max[i], 0.);
-      h_min[i] =
-          std::max(drelax_i * h_min[i], h_min[i] - std::abs(bar_deltaSqd_h[i]));
-      h_max[i] =
-          std::min(urelax_i * h_max[i], h_max[i] + std::abs(bar_deltaSqd_h[i]));
-      heta_min[i] = std::max(drelax_i * heta_min[i],
-                             heta_min[i] - std::abs(bar_deltaSqd_heta[i]));
-      heta_max[i] = std::min(urelax_i * heta_max[i],
-                             heta_max[i] + std::abs(bar_deltaSqd_heta[i]));
+      relaxBounds(drelax_i, urelax_i, bar_deltaSqd_h[i], h_min[i], h_max[i]);
+      relaxBounds(drelax_i, urelax_i, bar_deltaSqd_heta[i], heta_min[i],
+                  heta_max[i]);
 
 #if IF_DEBUGGING
       if (hLow[i] > h_max[i] || hLow[i] < h_min[i]) {
@@ -2316,6 +2146,117 @@ public:
     // ********** END OF COMPUTING NORMALS ********** //
   } // end calculateResidual
 
+  /* Takes up to nSteps steps of the SSP Runge-Kutta method, stopping at
+     tOut, with the calls and updates the lumped mass matrix solver, RKEV and
+     the step controller make in Python for each step. args holds the
+     arguments of calculateResidual, calculatePreStep, calculateEV,
+     calculateBoundsAndHighOrderRHS, convexLimiting and calculateEdgeBasedCFL
+     together with the time integration state, which is updated in place.
+     The wave generation arrays are left as they are. Returns the number of
+     steps taken. */
+  int advanceSSP(arguments_dict &args) {
+    int nSteps = args.scalar<int>("nSteps");
+    int timeOrder = args.scalar<int>("timeOrder");
+    double tOut = args.scalar<double>("tOut");
+    double &t = args.scalar<double>("t");
+    double &dt = args.scalar<double>("dt");
+    double &dtLast = args.scalar<double>("dtLast");
+    double dtRatioMax = args.scalar<double>("dtRatioMax");
+    double run_cfl = args.scalar<double>("run_cfl");
+    double eps = args.scalar<double>("eps");
+    double hEps = args.scalar<double>("hEps");
+    int &lstage = args.scalar<int>("lstage");
+    int &SECOND_CALL_CALCULATE_RESIDUAL =
+        args.scalar<int>("SECOND_CALL_CALCULATE_RESIDUAL");
+    int &check_positivity_water_height =
+        args.scalar<int>("check_positivity_water_height");
+    double &KE_tiny = args.scalar<double>("KE_tiny");
+    int numDOFsPerEqn = args.scalar<int>("numDOFsPerEqn");
+    const char *names[6] = {"h", "hu", "hv", "heta", "hw", "hbeta"};
+    int offset[6], stride[6];
+    double *dof[6], *dof_old[6], *dof_last[6], *dof_lstage[6], *limited[6];
+    for (int c = 0; c < 6; c++) {
+      const std::string name(names[c]);
+      offset[c] = args.scalar<int>("offset_" + name);
+      stride[c] = args.scalar<int>("stride_" + name);
+      dof[c] = args.array<double>(name + "_dof").data();
+      dof_old[c] = args.array<double>(name + "_dof_old").data();
+      dof_last[c] = args.array<double>(name + "_dof_last").data();
+      dof_lstage[c] = args.array<double>(name + "_dof_lstage").data();
+      limited[c] = args.array<double>("limited_" + name + "np1").data();
+    }
+    xt::pyarray<double> &u = args.array<double>("u");
+    xt::pyarray<double> &globalResidual = args.array<double>("globalResidual");
+    xt::pyarray<double> &kin_max = args.array<double>("kin_max");
+    xt::pyarray<double> &normalx = args.array<double>("normalx");
+    xt::pyarray<double> &normaly = args.array<double>("normaly");
+    xt::pyarray<int> &reflectingIndex = args.array<int>("reflectingIndex");
+    const int nReflecting = reflectingIndex.size();
+
+    SSPStepper<6> ssp(timeOrder, numDOFsPerEqn,
+                      work.array(SSP_TMP, numDOFsPerEqn));
+    // the DOFs of the global vector, with the reflecting conditions applied
+    auto setUnknowns = [&]() {
+      for (int c = 0; c < 6; c++)
+        gatherComponent(u.data(), offset[c], stride[c], numDOFsPerEqn, dof[c]);
+      reflectDischarge(reflectingIndex.data(), nReflecting, normalx.data(),
+                       normaly.data(), dof[1], dof[2]);
+      if (check_positivity_water_height)
+        checkWaterHeight(dof[0], numDOFsPerEqn, eps);
+    };
+    int step = 0;
+    for (; step < nSteps && t < tOut; step++) {
+      dt = SSPStepper<6>::stepExact(t, dt, tOut);
+      for (int c = 0; c < 6; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_old[c]);
+      for (lstage = 0; lstage < timeOrder;) {
+        // high order solution
+        setUnknowns();
+        calculatePreStep(args);
+        calculateEV(args);
+        calculateBoundsAndHighOrderRHS(args);
+        std::fill(globalResidual.begin(), globalResidual.end(), 0.0);
+        SECOND_CALL_CALCULATE_RESIDUAL = 0;
+        calculateResidual(args);
+        for (int k = 0; k < nReflecting; k++)
+          for (int c = 1; c < 3; c++)
+            globalResidual[offset[c] + stride[c] * reflectingIndex[k]] = 0.;
+        std::copy(globalResidual.begin(), globalResidual.end(), u.begin());
+        // convex limiting
+        KE_tiny = hEps * (*std::max_element(kin_max.begin(), kin_max.end()));
+        for (int c = 0; c < 6; c++)
+          std::fill(limited[c], limited[c] + numDOFsPerEqn, 0.0);
+        convexLimiting(args);
+        for (int c = 0; c < 6; c++)
+          scatterComponent(limited[c], offset[c], stride[c], numDOFsPerEqn,
+                           u.data());
+        // update the solution; the quantities at the quadrature points are
+        // only needed at the end of the step
+        setUnknowns();
+        if (lstage == timeOrder - 1) {
+          std::fill(globalResidual.begin(), globalResidual.end(), 0.0);
+          SECOND_CALL_CALCULATE_RESIDUAL = 1;
+          calculateResidual(args);
+        }
+        check_positivity_water_height = 1;
+        lstage++;
+        ssp.updateStage(lstage, dof, dof_old, dof_last, dof_lstage, false);
+      }
+      lstage = 0;
+      t += dt;
+      for (int c = 0; c < 6; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_last[c]);
+      dtLast = dt;
+      // the next step starts from the current solution, which is also what
+      // the CFL number is computed from
+      for (int c = 0; c < 6; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_old[c]);
+      dt = SSPStepper<6>::chooseDt(run_cfl, calculateEdgeBasedCFL(args),
+                                   dtLast, dtRatioMax);
+    }
+    return step;
+  } // end advanceSSP
+
   void calculateMassMatrix(arguments_dict &args) {
     xt::pyarray<double> &mesh_trial_ref = args.array<double>("mesh_trial_ref");
     xt::pyarray<double> &mesh_grad_trial_ref =
@@ -226,6 +226,10 @@ class RKEV(proteus.TimeIntegration.SSP):
         self.lstage = 0
         self.dtLast = self.dt
         self.tLast = self.t
+        # scratch the kernels (re)allocated during the step, zero once the sizes have settled
+        self.transport.kernelAllocations = self.transport.dsw_2d.getAllocationCount()
+        self.transport.dsw_2d.resetAllocationCount()
+        logEvent("GN_SW2DCV kernel scratch allocations in step: %d" % self.transport.kernelAllocations, level=4)
 
     def generateSubsteps(self, tList):
         """
@@ -1084,7 +1088,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         # NOTE: this function is meant to be called within the solver
         comm = Comm.get()
 
-        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         # Extract hnp1 from global solution u
         index = list(range(0, len(self.timeIntegration.u)))
         hIndex = index[0::6]
@@ -1104,6 +1107,24 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         self.KE_tiny = self.hEps * comm.globalMax(np.amax(self.kin_max))
 
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setFCTArguments(argsDict,
+                             (limited_hnp1, limited_hunp1, limited_hvnp1,
+                              limited_hetanp1, limited_hwnp1, limited_hbetanp1))
+        self.dsw_2d.convexLimiting(argsDict)
+
+        # Pass the post processed hnp1 solution to global solution u
+        self.timeIntegration.u[hIndex] = limited_hnp1
+        self.timeIntegration.u[huIndex] = limited_hunp1
+        self.timeIntegration.u[hvIndex] = limited_hvnp1
+        self.timeIntegration.u[hetaIndex] = limited_hetanp1
+        self.timeIntegration.u[hwIndex] = limited_hwnp1
+        self.timeIntegration.u[hbetaIndex] = limited_hbetanp1
+
+    def setFCTArguments(self, argsDict, limited):
+        """
+        Put the arguments of convexLimiting into argsDict, with the six arrays limited for the limited solution
+        """
+        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         argsDict["numDOFs"] = len(rowptr) - 1
         argsDict["csrRowIndeces_DofLoops"] = rowptr
         argsDict["csrColumnOffsets_DofLoops"] = colind
@@ -1118,12 +1139,12 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["hbeta_old"] = self.hbeta_dof_old
         argsDict["b_dof"] = self.coefficients.b.dof
         ###
-        argsDict["limited_hnp1"] = limited_hnp1
-        argsDict["limited_hunp1"] = limited_hunp1
-        argsDict["limited_hvnp1"] = limited_hvnp1
-        argsDict["limited_hetanp1"] = limited_hetanp1
-        argsDict["limited_hwnp1"] = limited_hwnp1
-        argsDict["limited_hbetanp1"] = limited_hbetanp1
+        argsDict["limited_hnp1"] = limited[0]
+        argsDict["limited_hunp1"] = limited[1]
+        argsDict["limited_hvnp1"] = limited[2]
+        argsDict["limited_hetanp1"] = limited[3]
+        argsDict["limited_hwnp1"] = limited[4]
+        argsDict["limited_hbetanp1"] = limited[5]
         argsDict["hEps"] = self.hEps
         argsDict["hLow"] = self.hLow
         argsDict["huLow"] = self.huLow
@@ -1159,19 +1180,23 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["thetaj_inv"] = self.thetaj_inv
         argsDict["g"] = self.coefficients.g
         argsDict["inverse_mesh"] = self.inverse_mesh
-        self.dsw_2d.convexLimiting(argsDict)
-
-        # Pass the post processed hnp1 solution to global solution u
-        self.timeIntegration.u[hIndex] = limited_hnp1
-        self.timeIntegration.u[huIndex] = limited_hunp1
-        self.timeIntegration.u[hvIndex] = limited_hvnp1
-        self.timeIntegration.u[hetaIndex] = limited_hetanp1
-        self.timeIntegration.u[hwIndex] = limited_hwnp1
-        self.timeIntegration.u[hbetaIndex] = limited_hbetanp1
 
     def computePreStep(self):
         # Arguments
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setPreStepArguments(argsDict)
+
+        # call PreStep function
+        self.dsw_2d.calculatePreStep(argsDict)
+
+        # save things
+        self.dij_small = globalMax(argsDict.dscalar["dij_small"])
+    #
+
+    def setPreStepArguments(self, argsDict):
+        """
+        Put the arguments of calculatePreStep into argsDict
+        """
         argsDict["g"] = self.coefficients.g
         argsDict["h_dof_old"] = self.h_dof_old
         argsDict["hu_dof_old"] = self.hu_dof_old
@@ -1190,16 +1215,19 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["Cx"] = self.Cx
         argsDict["Cy"] = self.Cy
 
-        # call PreStep function
-        self.dsw_2d.calculatePreStep(argsDict)
-
-        # save things
-        self.dij_small = globalMax(argsDict.dscalar["dij_small"])
-    #
-
     def computeEV(self):
         # Arguments
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setEVArguments(argsDict)
+
+        # compute entropy residual
+        self.dsw_2d.calculateEV(argsDict)
+    #
+
+    def setEVArguments(self, argsDict):
+        """
+        Put the arguments of calculateEV into argsDict
+        """
         argsDict["g"] = self.coefficients.g
         argsDict["h_dof_old"] = self.h_dof_old
         argsDict["hu_dof_old"] = self.hu_dof_old
@@ -1217,10 +1245,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["entropy"] = self.entropy
         argsDict["h0_max"] = self.h0_max
 
-        # compute entropy residual
-        self.dsw_2d.calculateEV(argsDict)
-    #
-
     def compute_waves(self):
         x = self.mesh.nodeArray[:, 0]
         y = self.mesh.nodeArray[:, 1]
@@ -1236,6 +1260,17 @@ class LevelModel(proteus.Transport.OneLevelTransport):
 
     def computeBoundsAndRhsHigh(self):
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setBoundsAndRhsHighArguments(argsDict)
+
+        # function
+        self.dsw_2d.calculateBoundsAndHighOrderRHS(argsDict)
+
+    #
+
+    def setBoundsAndRhsHighArguments(self, argsDict):
+        """
+        Put the arguments of calculateBoundsAndHighOrderRHS into argsDict
+        """
         argsDict["g"] = self.coefficients.g
         argsDict["h_dof_old"] = self.h_dof_old
         argsDict["hu_dof_old"] = self.hu_dof_old
@@ -1302,11 +1337,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["h_w_wave"] = self.h_w_wave
         argsDict["h_beta_wave"] = self.h_beta_wave
 
-        # function
-        self.dsw_2d.calculateBoundsAndHighOrderRHS(argsDict)
-
-    #
-
     def getDOFsCoord(self):
         # get x,y coordinates of all DOFs #
         self.dofsXCoord = np.zeros(self.u[0].dof.shape, 'd')
@@ -1854,8 +1884,125 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         self.par_kin_max.scatter_forward_insert()
         #############################################
 
-        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setResidualArguments(argsDict, r)
+
+        ## call calculate residual
+        self.calculateResidual(argsDict)
+
+        if self.COMPUTE_NORMALS == 1:
+            self.par_normalx.scatter_forward_insert()
+            self.par_normaly.scatter_forward_insert()
+            self.COMPUTE_NORMALS = 0
+        #
+
+        # for reflecting conditions on all boundaries
+        if self.reflectingBoundaryConditions and self.boundaryIndex is not None:
+            for dummy, index in enumerate(self.boundaryIndex):
+                r[self.offset[1]+self.stride[1]*index] = 0.
+                r[self.offset[2]+self.stride[2]*index] = 0.
+            #
+        #
+
+        # for reflecting conditions on partial boundaries
+        if not self.reflectingBoundaryConditions and self.reflectingBoundaryIndex is not None:
+            for dummy, index in enumerate(self.reflectingBoundaryIndex):
+                r[self.offset[1]+self.stride[1]*index] = 0.
+                r[self.offset[2]+self.stride[2]*index] = 0.
+            #
+        #
+
+        if self.forceStrongConditions:
+            for cj in range(len(self.dirichletConditionsForceDOF)):
+                for dofN, g in list(self.dirichletConditionsForceDOF[cj].DOFBoundaryConditionsDict.items()):
+                    r[self.offset[cj] + self.stride[cj] * dofN] = 0.
+        #
+        if self.constrainedDOFsIndices is not None:
+            for index in self.constrainedDOFsIndices:
+                for cj in range(self.nc):
+                    global_dofN = self.offset[cj] + self.stride[cj] * index
+                    r[global_dofN] = 0.
+        #
+        logEvent("Global residual hyperbolic SGN: ", level=9, data=r)
+        # mwf decide if this is reasonable for keeping solver statistics
+        self.nonlinear_function_evaluations += 1
+
+    def advanceSSP(self, tOut, nSteps=None):
+        """
+        Take the SSP Runge-Kutta steps up to tOut (at most nSteps of them) in a single kernel call
+
+        The kernel makes the calls and updates of the lumped mass matrix
+        solver, RKEV and the step controller for each step, so the solution
+        is the same as when the steps are taken from Python. Archiving,
+        gauges and the step controllers are left to the caller; only the
+        time integration state is updated. It needs a serial run with the
+        lumped mass matrix, all DOFs free, no constrained DOFs and no wave
+        generation, and one step already taken from Python (for the
+        boundary normals and the first time step). Returns the number of
+        steps taken.
+        """
+        ti = self.timeIntegration
+        assert Comm.get().size() == 1, "advanceSSP runs in serial"
+        assert self.coefficients.LUMPED_MASS_MATRIX == 1, "advanceSSP needs the lumped mass matrix"
+        assert not self.forceStrongConditions and self.coefficients.constrainedDOFs is None
+        assert self.coefficients.waveConditions is None, "advanceSSP does not update the generated waves"
+        assert self.boundaryIndex is not None and self.COMPUTE_NORMALS == 0, "take a step before advanceSSP"
+        assert ti.dtLast is not None and ti.lstage == 0
+        u = ti.u
+        assert u.size == self.nc * self.numDOFsPerEqn, "advanceSSP needs all DOFs free"
+        if self.reflectingBoundaryConditions:
+            reflectingIndex = self.boundaryIndex
+        elif self.reflectingBoundaryIndex is not None:
+            reflectingIndex = self.reflectingBoundaryIndex
+        else:
+            reflectingIndex = []
+        limited = [np.zeros(self.h_dof_old.shape) for ci in range(self.nc)]
+
+        argsDict = cArgumentsDict.ArgumentsDict()
+        self.setResidualArguments(argsDict, np.zeros(u.shape, 'd'))
+        self.setPreStepArguments(argsDict)
+        self.setEVArguments(argsDict)
+        self.setBoundsAndRhsHighArguments(argsDict)
+        self.setFCTArguments(argsDict, limited)
+        argsDict["u"] = u
+        argsDict["reflectingIndex"] = np.array(reflectingIndex, 'i')
+        argsDict["eps"] = self.eps
+        argsDict["check_positivity_water_height"] = int(self.check_positivity_water_height)
+        for ci, name in enumerate(("h", "hu", "hv", "heta", "hw", "hbeta")):
+            argsDict[name + "_dof_last"] = ti.u_dof_last[ci]
+            argsDict[name + "_dof_lstage"] = ti.u_dof_lstage[ci]
+        argsDict["nSteps"] = 2**31 - 1 if nSteps is None else int(nSteps)
+        argsDict["timeOrder"] = ti.timeOrder
+        argsDict["tOut"] = float(tOut)
+        argsDict["t"] = float(ti.tLast)
+        argsDict["dt"] = float(ti.dt)
+        argsDict["dtLast"] = float(ti.dtLast)
+        argsDict["dtRatioMax"] = float(ti.dtRatioMax)
+        argsDict["run_cfl"] = float(ti.runCFL)
+        argsDict["edge_based_cfl"] = self.edge_based_cfl
+        nStepsTaken = self.dsw_2d.advanceSSP(argsDict)
+
+        ti.tLast = argsDict.dscalar["t"]
+        ti.dtLast = argsDict.dscalar["dtLast"]
+        ti.dt = argsDict.dscalar["dt"]
+        ti.t = ti.tLast + ti.dt
+        ti.substeps = [ti.t for i in range(ti.nStages)]
+        self.secondCallCalculateResidual = 1
+        self.check_positivity_water_height = bool(argsDict.iscalar["check_positivity_water_height"])
+        self.KE_tiny = argsDict.dscalar["KE_tiny"]
+        self.dij_small = argsDict.dscalar["dij_small"]
+        self.kernelAllocations = self.dsw_2d.getAllocationCount()
+        self.dsw_2d.resetAllocationCount()
+        logEvent("GN_SW2DCV took %d steps to t=%12.5e, kernel scratch allocations: %d" % (nStepsTaken,
+                                                                                         ti.tLast,
+                                                                                         self.kernelAllocations), level=3)
+        return nStepsTaken
+
+    def setResidualArguments(self, argsDict, r):
+        """
+        Put the arguments of calculateResidual into argsDict, with r as the global residual
+        """
+        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         argsDict["mesh_trial_ref"] = self.u[0].femSpace.elementMaps.psi
         argsDict["mesh_grad_trial_ref"] = self.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.mesh.nodeArray
@@ -1987,46 +2134,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["RHS_high_hw"] = self.RHS_high_hw
         argsDict["RHS_high_hbeta"] = self.RHS_high_hbeta
 
-        ## call calculate residual
-        self.calculateResidual(argsDict)
-
-        if self.COMPUTE_NORMALS == 1:
-            self.par_normalx.scatter_forward_insert()
-            self.par_normaly.scatter_forward_insert()
-            self.COMPUTE_NORMALS = 0
-        #
-
-        # for reflecting conditions on all boundaries
-        if self.reflectingBoundaryConditions and self.boundaryIndex is not None:
-            for dummy, index in enumerate(self.boundaryIndex):
-                r[self.offset[1]+self.stride[1]*index] = 0.
-                r[self.offset[2]+self.stride[2]*index] = 0.
-            #
-        #
-
-        # for reflecting conditions on partial boundaries
-        if not self.reflectingBoundaryConditions and self.reflectingBoundaryIndex is not None:
-            for dummy, index in enumerate(self.reflectingBoundaryIndex):
-                r[self.offset[1]+self.stride[1]*index] = 0.
-                r[self.offset[2]+self.stride[2]*index] = 0.
-            #
-        #
-
-        if self.forceStrongConditions:
-            for cj in range(len(self.dirichletConditionsForceDOF)):
-                for dofN, g in list(self.dirichletConditionsForceDOF[cj].DOFBoundaryConditionsDict.items()):
-                    r[self.offset[cj] + self.stride[cj] * dofN] = 0.
-        #
-        if self.constrainedDOFsIndices is not None:
-            for index in self.constrainedDOFsIndices:
-                for cj in range(self.nc):
-                    global_dofN = self.offset[cj] + self.stride[cj] * index
-                    r[global_dofN] = 0.
-        #
-        logEvent("Global residual hyperbolic SGN: ", level=9, data=r)
-        # mwf decide if this is reasonable for keeping solver statistics
-        self.nonlinear_function_evaluations += 1
-
     def getJacobian(self, jacobian):
         cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
                                        jacobian)
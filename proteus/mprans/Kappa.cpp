@@ -24,6 +24,6 @@ PYBIND11_MODULE(cKappa, m)
 
     py::class_<Kappa_base>(m, "cKappa_base")
         .def(py::init(&proteus::newKappa))
-        .def("calculateResidual", &Kappa_base::calculateResidual)
-        .def("calculateJacobian", &Kappa_base::calculateJacobian);
+        .def("calculateResidual", &Kappa_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &Kappa_base::calculateJacobian, proteus::release_gil());
 }
@@ -24,6 +24,6 @@ PYBIND11_MODULE(cKappa2D, m)
 
     py::class_<Kappa2D_base>(m, "cKappa2D_base")
         .def(py::init(&proteus::newKappa2D))
-        .def("calculateResidual", &Kappa2D_base::calculateResidual)
-        .def("calculateJacobian", &Kappa2D_base::calculateJacobian);
+        .def("calculateResidual", &Kappa2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &Kappa2D_base::calculateJacobian, proteus::release_gil());
 }
@@ -25,14 +25,15 @@ PYBIND11_MODULE(cMCorr, m)
 
     py::class_<MCorr_base>(m, "cMCorr_base")
         .def(py::init(&proteus::newMCorr))
-        .def("calculateResidual"                                , &MCorr_base::calculateResidual                                )
-        .def("calculateJacobian"                                , &MCorr_base::calculateJacobian                                )
-        .def("elementSolve"                                     , &MCorr_base::elementSolve                                     )
-        .def("elementConstantSolve"                             , &MCorr_base::elementConstantSolve                             )
-        .def("globalConstantRJ"                                 , &MCorr_base::globalConstantRJ, return_value_policy::take_ownership)
-        .def("calculateMass"                                    , &MCorr_base::calculateMass, return_value_policy::take_ownership)
-        .def("setMassQuadrature"                                , &MCorr_base::setMassQuadrature                                )
-        .def("FCTStep"                                          , &MCorr_base::FCTStep                                          )
-        .def("calculateMassMatrix"                              , &MCorr_base::calculateMassMatrix                              )
-        .def("setMassQuadratureEdgeBasedStabilizationMethods"   , &MCorr_base::setMassQuadratureEdgeBasedStabilizationMethods   );
+        .def("calculateResidual"                                , &MCorr_base::calculateResidual                                , proteus::release_gil())
+        .def("calculateJacobian"                                , &MCorr_base::calculateJacobian                                , proteus::release_gil())
+        .def("updateNarrowBand"                                 , &MCorr_base::updateNarrowBand                                 , proteus::release_gil())
+        .def("elementSolve"                                     , &MCorr_base::elementSolve                                     , proteus::release_gil())
+        .def("elementConstantSolve"                             , &MCorr_base::elementConstantSolve                             , proteus::release_gil())
+        .def("globalConstantRJ"                                 , &MCorr_base::globalConstantRJ, return_value_policy::take_ownership, proteus::release_gil())
+        .def("calculateMass"                                    , &MCorr_base::calculateMass, return_value_policy::take_ownership, proteus::release_gil())
+        .def("setMassQuadrature"                                , &MCorr_base::setMassQuadrature                                , proteus::release_gil())
+        .def("FCTStep"                                          , &MCorr_base::FCTStep                                          , proteus::release_gil())
+        .def("calculateMassMatrix"                              , &MCorr_base::calculateMassMatrix                              , proteus::release_gil())
+        .def("setMassQuadratureEdgeBasedStabilizationMethods"   , &MCorr_base::setMassQuadratureEdgeBasedStabilizationMethods   , proteus::release_gil());
 }
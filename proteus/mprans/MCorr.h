@@ -7,6 +7,8 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
+#include "NarrowBand.h"
 #include "equivalent_polynomials.h"
 #include PROTEUS_LAPACK_H
 #include "ArgumentsDict.h"
@@ -25,9 +27,18 @@ namespace proteus
   class MCorr_base
   {
   public:
-    std::valarray<double> Rpos, Rneg;
-    std::valarray<double> FluxCorrectionMatrix;
+    FCTLimiter fct;
+    NarrowBand narrowBand;
     virtual ~MCorr_base(){}
+    /// rebuild the narrow band from the level set u_dof and mark its DOFs in isActiveDOF
+    void updateNarrowBand(arguments_dict& args)
+    {
+      xt::pyarray<int>& u_l2g = args.array<int>("u_l2g");
+      xt::pyarray<double>& u_dof = args.array<double>("u_dof");
+      xt::pyarray<double>& isActiveDOF = args.array<double>("isActiveDOF");
+      narrowBand.build(u_l2g.shape(0), u_l2g.shape(1), u_l2g.data(), u_dof.data(),
+                       args.scalar<int>("nBandLayers"), isActiveDOF.shape(0), isActiveDOF.data());
+    }
     virtual void calculateResidual(arguments_dict& args, bool useExact)=0;
     virtual void calculateJacobian(arguments_dict& args, bool useExact)=0;
     virtual void elementSolve(arguments_dict& args)=0;
@@ -280,6 +291,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double epsFactHeaviside = args.scalar<double>("epsFactHeaviside");
         double epsFactDirac = args.scalar<double>("epsFactDirac");
@@ -332,8 +344,10 @@ namespace proteus
         gf_s.useExact = useExact_s;
 	cutfem_boundaries.clear();
 	cutfem_local_boundaries.clear();
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             //declare local storage for element residual and initialize
             double elementResidual_u[nDOF_test_element], element_u[nDOF_trial_element], element_phi[nDOF_trial_element], element_phi_s[nDOF_mesh_trial_element];
 	    bool element_active=false;
@@ -352,8 +366,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
-	    int icase_s = gf_s.calculate(element_phi_s, element_nodes, x_ref.data(),false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
+	    int icase_s = gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(),false);
 	    if (icase_s == 0)
 	      {
 		element_active=true;
@@ -560,6 +574,8 @@ namespace proteus
             int ebN = exteriorElementBoundariesArray.data()[ebNE],
               eN  = elementBoundaryElementsArray.data()[ebN*2+0],
               ebN_local = elementBoundaryLocalElementBoundariesArray.data()[ebN*2+0];
+            if (useNarrowBand && !narrowBand.contains(eN))
+              continue;
             //eN_nDOF_trial_element = eN*nDOF_trial_element;
             //double elementResidual_u[nDOF_test_element];
             double element_u[nDOF_trial_element];
@@ -815,6 +831,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double epsFactHeaviside = args.scalar<double>("epsFactHeaviside");
         double epsFactDirac = args.scalar<double>("epsFactDirac");
@@ -850,8 +867,10 @@ namespace proteus
         //
         gf.useExact = useExact;
         gf_s.useExact = useExact_s;
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             double  elementJacobian_u_u[nDOF_test_element*nDOF_trial_element],element_u[nDOF_trial_element],element_phi[nDOF_trial_element],element_phi_s[nDOF_mesh_trial_element];
             for (int j=0;j<nDOF_trial_element;j++)
               {
@@ -867,8 +886,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-	    gf.calculate(element_phi, element_nodes, x_ref.data(),false);
-	    int icase_s = gf_s.calculate(element_phi_s, element_nodes, x_ref.data(), false);
+	    gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
+	    int icase_s = gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(), false);
 	    calculateElementJacobian(mesh_trial_ref.data(),
 				     mesh_grad_trial_ref.data(),
 				     mesh_dof.data(),
@@ -1837,8 +1856,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
-	    int icase_s = gf_s.calculate(element_phi_s, element_nodes, x_ref.data(),false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
+	    int icase_s = gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(),false);
 	    for  (int k=0;k<nQuadraturePoints_element;k++)
 	      {
 		//compute indeces and declare local storage
@@ -1963,8 +1982,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
-            gf_nodes.calculate(element_phi, element_nodes, element_nodes,false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
+            gf_nodes.calculate(eN, element_phi, element_nodes, element_nodes,false);
 	    for  (int k=0;k<nQuadraturePoints_element;k++)
 	      {
 		//compute indeces and declare local storage
@@ -2030,7 +2049,6 @@ namespace proteus
 
       void FCTStep(arguments_dict& args)
       {
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix");
         xt::pyarray<double>& solH = args.array<double>("solH");
@@ -2039,71 +2057,32 @@ namespace proteus
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
         xt::pyarray<double>& MassMatrix = args.array<double>("matrix");
-        Rpos.resize(numDOFs,0.0), Rneg.resize(numDOFs,0.0);
-        FluxCorrectionMatrix.resize(NNZ,0.0);
-        //////////////////
-        // LOOP in DOFs //
-        //////////////////
-        int ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+        double* FluxCorrectionMatrix = fct.componentFlux(0);
+        ////////////////////////////////////
+        // COMPUTE FLUX CORRECTION MATRIX //
+        ////////////////////////////////////
+        fct.computeFlux(0, [&](int i, int j, int ij)
+          {
+            return ((i==j ? 1. : 0.)*lumped_mass_matrix.data()[i] - MassMatrix.data()[ij]) * (solH.data()[j]-solH.data()[i]);
+          });
+        /////////////////////////////
+        // COMPUTE Q AND R VECTORS //
+        /////////////////////////////
+        fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
           {
-            //read some vectors
-            double solHi = solH.data()[i];
-            double solLi = solL.data()[i];
-            double mi = lumped_mass_matrix.data()[i];
-
             double mini=0., maxi=1.0;
-            double Pposi=0, Pnegi=0;
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                // i-th row of flux correction matrix
-                FluxCorrectionMatrix[ij] = ((i==j ? 1. : 0.)*mi - MassMatrix.data()[ij]) * (solH.data()[j]-solHi);
-
-                ///////////////////////
-                // COMPUTE P VECTORS //
-                ///////////////////////
-                Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-                Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-                //update ij
-                ij+=1;
-              }
-            ///////////////////////
-            // COMPUTE Q VECTORS //
-            ///////////////////////
-            double Qposi = mi*(maxi-solLi);
-            double Qnegi = mi*(mini-solLi);
-
-            ///////////////////////
-            // COMPUTE R VECTORS //
-            ///////////////////////
-            Rpos[i] = ((Pposi==0) ? 1. : std::min(1.0,Qposi/Pposi));
-            Rneg[i] = ((Pnegi==0) ? 1. : std::min(1.0,Qnegi/Pnegi));
-          } // i DOFs
-
+            double mi = lumped_mass_matrix.data()[i];
+            Qposi = mi*(maxi-solL.data()[i]);
+            Qnegi = mi*(mini-solL.data()[i]);
+          });
         //////////////////////
         // COMPUTE LIMITERS //
         //////////////////////
-        ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.limit(FluxCorrectionMatrix, [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
           {
-            double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-            double Rposi = Rpos[i], Rnegi = Rneg[i];
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                ith_Limiter_times_FluxCorrectionMatrix +=
-                  ((FluxCorrectionMatrix[ij]>0) ? std::min(Rposi,Rneg[j]) : std::min(Rnegi,Rpos[j]))
-                  * FluxCorrectionMatrix[ij];
-                //ith_Limiter_times_FluxCorrectionMatrix += FluxCorrectionMatrix[ij];
-                //update ij
-                ij+=1;
-              }
             limited_solution.data()[i] = fmax(0.0,solL.data()[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix);
-          }
+          });
       }
 
       // mql. copied from calculateElementJacobian. NOTE: there are some not necessary computations!!!
@@ -2429,7 +2408,7 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
 	    for  (int k=0;k<nQuadraturePoints_element;k++)
 	      {
 		//compute indeces and declare local storage
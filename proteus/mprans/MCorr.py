@@ -31,6 +31,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                  edgeBasedStabilizationMethods=False,
                  nullSpace='NoNullSpace',
                  useExact=False,
+                 # element layers around the zero level set to correct, None for the whole mesh
+                 nBandLayers=None,
                  initialize=True):
         self.useExact=useExact
         self.useQuadraticRegularization = useQuadraticRegularization
@@ -56,6 +58,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
             self.applyCorrectionToDOF = applyCorrectionToDOF
         self.massConservationError = 0.0
         self.nullSpace = nullSpace
+        self.nBandLayers = nBandLayers
+        assert nBandLayers is None or nBandLayers >= 1, "nBandLayers must be at least 1 to keep the elements cut by the zero level set active"
         if initialize:
             self.initialize()
 
@@ -168,6 +172,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
             cebqe[('a', 0, 0)].fill(self.epsDiffusion)
 
     def preStep(self, t, firstStep=False):
+        if self.nBandLayers is not None:
+            self.massCorrModel.updateNarrowBand()
         if self.checkMass:
             logEvent("Phase 0 mass before mass correction (VOF) %21.16e" % (Norms.scalarDomainIntegral(self.vofModel.q['dV'],
                                                                                                       self.vofModel.q[('m', 0)],
@@ -598,6 +604,22 @@ class LevelModel(proteus.Transport.OneLevelTransport):
                                  self.testSpace[0].referenceFiniteElement.localFunctionSpace.dim,
                                  self.nElementBoundaryQuadraturePoints_elementBoundary,
                                  compKernelFlag)
+        # DOFs inside the narrow band; the correction is 0 at the others once the band is built
+        self.narrowBandDOF = np.ones(self.u[0].dof.shape, 'd')
+        self.useNarrowBand = False
+
+    def updateNarrowBand(self):
+        """
+        Rebuild the elements within nBandLayers layers of the zero level set being corrected
+        """
+        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict["u_l2g"] = self.u[0].femSpace.dofMap.l2g
+        argsDict["u_dof"] = self.coefficients.lsModel.u[0].dof
+        argsDict["nBandLayers"] = self.coefficients.nBandLayers
+        argsDict["isActiveDOF"] = self.narrowBandDOF
+        self.mcorr.updateNarrowBand(argsDict)
+        self.useNarrowBand = True
+
     # mwf these are getting called by redistancing classes,
 
     def FCTStep(self):
@@ -701,8 +723,12 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["isActiveElement"] = self.isActiveElement
         argsDict["ebqe_phi_s"] = self.coefficients.flowCoefficients.ebqe_phi_s
         argsDict["phi_solid"] = self.coefficients.flowCoefficients.q_phi_solid
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.mcorr.calculateResidual(argsDict,
             self.coefficients.useExact)
+        if self.useNarrowBand:
+            self.isActiveR *= self.narrowBandDOF
+            self.isActiveDOF *= self.narrowBandDOF
         r*=self.isActiveR
         self.u[0].dof[:] = np.where(self.isActiveDOF==1.0, self.u[0].dof,0.0)
         logEvent("Global residual", level=9, data=r)
@@ -826,17 +852,10 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["isActiveElement"] = self.isActiveElement
         argsDict["ebqe_phi_s"] = self.coefficients.flowCoefficients.ebqe_phi_s
         argsDict["phi_solid"] = self.coefficients.flowCoefficients.q_phi_solid
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.mcorr.calculateJacobian(argsDict,
             self.coefficients.useExact)
-        for global_dofN_a in np.argwhere(self.isActiveR==0.0):
-            global_dofN = global_dofN_a[0]
-            for i in range(
-                    self.rowptr[global_dofN],
-                    self.rowptr[global_dofN + 1]):
-                if (self.colind[i] == global_dofN):
-                    self.nzval[i] = 1.0
-                else:
-                    self.nzval[i] = 0.0
+        self.setIdentityRows(self.isActiveR)
         logEvent("Jacobian ", level=10, data=jacobian)
         # mwf decide if this is reasonable for solver statistics
         self.nonlinear_function_jacobian_evaluations += 1
@@ -25,14 +25,14 @@ PYBIND11_MODULE(cMCorr3P, m)
     xt::import_numpy();
 
     py::class_<cppMCorr3P_base>(m, "cppMCorr3P_base")
-        .def("calculateResidual", &cppMCorr3P_base::calculateResidual)
-        .def("calculateJacobian", &cppMCorr3P_base::calculateJacobian)
-        .def("elementSolve", &cppMCorr3P_base::elementSolve)
-        .def("elementConstantSolve", &cppMCorr3P_base::elementConstantSolve)
-        .def("globalConstantRJ", &cppMCorr3P_base::globalConstantRJ)
-        .def("calculateMass", &cppMCorr3P_base::calculateMass)
-        .def("setMassQuadrature", &cppMCorr3P_base::setMassQuadrature)
-        .def("calculateStiffnessMatrix", &cppMCorr3P_base::calculateStiffnessMatrix);
+        .def("calculateResidual", &cppMCorr3P_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppMCorr3P_base::calculateJacobian, proteus::release_gil())
+        .def("elementSolve", &cppMCorr3P_base::elementSolve, proteus::release_gil())
+        .def("elementConstantSolve", &cppMCorr3P_base::elementConstantSolve, proteus::release_gil())
+        .def("globalConstantRJ", &cppMCorr3P_base::globalConstantRJ, proteus::release_gil())
+        .def("calculateMass", &cppMCorr3P_base::calculateMass, proteus::release_gil())
+        .def("setMassQuadrature", &cppMCorr3P_base::setMassQuadrature, proteus::release_gil())
+        .def("calculateStiffnessMatrix", &cppMCorr3P_base::calculateStiffnessMatrix, proteus::release_gil());
 
     m.def("newMCorr3P", newMCorr3P);
 }
@@ -24,6 +24,6 @@ PYBIND11_MODULE(cMoveMesh, m)
 
     py::class_<MoveMesh_base>(m, "cMoveMesh_base")
         .def(py::init(&proteus::newMoveMesh))
-        .def("calculateResidual", &MoveMesh_base::calculateResidual)
-        .def("calculateJacobian", &MoveMesh_base::calculateJacobian);
+        .def("calculateResidual", &MoveMesh_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &MoveMesh_base::calculateJacobian, proteus::release_gil());
 }
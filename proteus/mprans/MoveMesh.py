@@ -135,6 +135,7 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
             self.mesh.nodeArray[:, 2] += self.model.u[2].dof
             self.mesh.nodeVelocityArray[:, 2] = self.model.u[2].dof
             self.model.u[2].dof[:] = 0.0
+        self.mesh.nodesMoved()
         if self.dt_last is None:
             dt = self.model.timeIntegration.dt
         else:
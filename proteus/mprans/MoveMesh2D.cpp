@@ -24,6 +24,6 @@ PYBIND11_MODULE(cMoveMesh2D, m)
 
     py::class_<MoveMesh2D_base>(m, "cMoveMesh2D_base")
         .def(py::init(&proteus::newMoveMesh2D))
-        .def("calculateResidual", &MoveMesh2D_base::calculateResidual)
-        .def("calculateJacobian", &MoveMesh2D_base::calculateJacobian);
+        .def("calculateResidual", &MoveMesh2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &MoveMesh2D_base::calculateJacobian, proteus::release_gil());
 }
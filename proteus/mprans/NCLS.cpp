@@ -24,12 +24,13 @@ PYBIND11_MODULE(cNCLS, m)
 
     py::class_<NCLS_base>(m, "cNCLS_base")
         .def(py::init(&proteus::newNCLS))
-        .def("calculateResidual"                    , &NCLS_base::calculateResidual                     )
-        .def("calculateJacobian"                    , &NCLS_base::calculateJacobian                     )
-        .def("calculateWaterline"                   , &NCLS_base::calculateWaterline                    )
-        .def("calculateRedistancingResidual"        , &NCLS_base::calculateRedistancingResidual         )
-        .def("calculateRhsSmoothing"                , &NCLS_base::calculateRhsSmoothing                 )
-        .def("calculateResidual_entropy_viscosity"  , &NCLS_base::calculateResidual_entropy_viscosity   )
-        .def("calculateMassMatrix"                  , &NCLS_base::calculateMassMatrix                   )
-        .def("calculateSmoothingMatrix"             , &NCLS_base::calculateSmoothingMatrix              );
+        .def("calculateResidual"                    , &NCLS_base::calculateResidual                     , proteus::release_gil())
+        .def("calculateJacobian"                    , &NCLS_base::calculateJacobian                     , proteus::release_gil())
+        .def("updateNarrowBand"                     , &NCLS_base::updateNarrowBand                      , proteus::release_gil())
+        .def("calculateWaterline"                   , &NCLS_base::calculateWaterline                    , proteus::release_gil())
+        .def("calculateRedistancingResidual"        , &NCLS_base::calculateRedistancingResidual         , proteus::release_gil())
+        .def("calculateRhsSmoothing"                , &NCLS_base::calculateRhsSmoothing                 , proteus::release_gil())
+        .def("calculateResidual_entropy_viscosity"  , &NCLS_base::calculateResidual_entropy_viscosity   , proteus::release_gil())
+        .def("calculateMassMatrix"                  , &NCLS_base::calculateMassMatrix                   , proteus::release_gil())
+        .def("calculateSmoothingMatrix"             , &NCLS_base::calculateSmoothingMatrix              , proteus::release_gil());
 }
@@ -5,6 +5,8 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "EdgeList.h"
+#include "NarrowBand.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
 
@@ -41,12 +43,23 @@ namespace proteus
     //The base class defining the interface
   public:
     std::valarray<double> L2_norm_per_node;
-    std::valarray<double> TransportMatrix, TransposeTransportMatrix;
+    std::valarray<double> TransportMatrix, dLow;
+    EdgeList edges;
+    NarrowBand narrowBand;
     std::valarray<double> psi, etaMax, etaMin;
     std::valarray<double> global_entropy_residual;
     std::valarray<double> gx, gy, gz, eta,
       alpha_numerator_pos, alpha_numerator_neg, alpha_denominator_pos, alpha_denominator_neg;
     virtual ~NCLS_base(){}
+    /// rebuild the narrow band from the level set u_dof and mark its DOFs in isActiveDOF
+    void updateNarrowBand(arguments_dict& args)
+    {
+      xt::pyarray<int>& u_l2g = args.array<int>("u_l2g");
+      xt::pyarray<double>& u_dof = args.array<double>("u_dof");
+      xt::pyarray<double>& isActiveDOF = args.array<double>("isActiveDOF");
+      narrowBand.build(u_l2g.shape(0), u_l2g.shape(1), u_l2g.data(), u_dof.data(),
+                       args.scalar<int>("nBandLayers"), isActiveDOF.shape(0), isActiveDOF.data());
+    }
     virtual void calculateResidual(arguments_dict& args)=0;
     virtual void calculateJacobian(arguments_dict& args)=0;
     virtual void calculateWaterline(arguments_dict& args)=0;
@@ -216,6 +229,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -231,6 +245,8 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -305,8 +321,10 @@ namespace proteus
         //eN_j is the element trial function index
         //eN_k_j is the quadrature point index for a trial function
         //eN_k_i is the quadrature point index for a trial function
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             //declare local storage for element residual and initialize
             double elementResidual_u[nDOF_test_element];
             for (int i=0;i<nDOF_test_element;i++)
@@ -528,6 +546,8 @@ namespace proteus
               eN  = elementBoundaryElementsArray.data()[ebN*2+0],
               ebN_local = elementBoundaryLocalElementBoundariesArray.data()[ebN*2+0],
               eN_nDOF_trial_element = eN*nDOF_trial_element;
+            if (useNarrowBand && !narrowBand.contains(eN))
+              continue;
             double elementResidual_u[nDOF_test_element];
             for (int i=0;i<nDOF_test_element;i++)
               {
@@ -696,6 +716,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -711,6 +732,8 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -743,8 +766,10 @@ namespace proteus
         //
         //loop over elements to compute volume integrals and load them into the element Jacobians and global Jacobian
         //
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             double  elementJacobian_u_u[nDOF_test_element][nDOF_trial_element];
             for (int i=0;i<nDOF_test_element;i++)
               for (int j=0;j<nDOF_trial_element;j++)
@@ -938,6 +963,8 @@ namespace proteus
             int eN  = elementBoundaryElementsArray.data()[ebN*2+0],
               ebN_local = elementBoundaryLocalElementBoundariesArray.data()[ebN*2+0],
               eN_nDOF_trial_element = eN*nDOF_trial_element;
+            if (useNarrowBand && !narrowBand.contains(eN))
+              continue;
             for  (int kb=0;kb<nQuadraturePoints_elementBoundary;kb++)
               {
                 int ebNE_kb = ebNE*nQuadraturePoints_elementBoundary+kb,
@@ -1117,6 +1144,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -1132,6 +1160,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -1242,6 +1271,7 @@ namespace proteus
         xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
         xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -1279,7 +1309,8 @@ namespace proteus
 
         // Allocate space for the transport matrices
         TransportMatrix.resize(NNZ,0.0);
-        TransposeTransportMatrix.resize(NNZ,0.0);
+        dLow.resize(NNZ,0.0);
+        edges.setPattern(numDOFs,csrRowIndeces_DofLoops.data(),csrColumnOffsets_DofLoops.data());
 
         //////////////////////////////////////////////
         // ** LOOP IN CELLS FOR CELL BASED TERMS ** //
@@ -1287,13 +1318,13 @@ namespace proteus
         // HERE WE COMPUTE:
         //    * Time derivative term
         //    * Transport matrices
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         for(int eN=0;eN<nElements_global;eN++)
           {
             //declare local storage for local contributions and initialize
             double
               elementResidual_u[nDOF_test_element], element_L2_norm_per_node[nDOF_test_element];
             double  elementTransport[nDOF_test_element][nDOF_trial_element];
-            double  elementTransposeTransport[nDOF_test_element][nDOF_trial_element];
             for (int i=0;i<nDOF_test_element;i++)
               {
                 elementResidual_u[i]=0.0;
@@ -1301,7 +1332,6 @@ namespace proteus
                 for (int j=0;j<nDOF_trial_element;j++)
                   {
                     elementTransport[i][j]=0.0;
-                    elementTransposeTransport[i][j]=0.0;
                   }
               }
             //loop over quadrature points and compute integrands
@@ -1362,12 +1392,9 @@ namespace proteus
                     for(int j=0;j<nDOF_trial_element;j++)
                       {
                         int j_nSpace = j*nSpace;
-                        int i_nSpace = i*nSpace;
                         // COMPUTE ELEMENT TRANSPORT MATRIX (MQL)
                         elementTransport[i][j] += // int[(vel.grad_wj)*wi*dx]
                           ck.HamiltonianJacobian_weak(vn,&u_grad_trial[j_nSpace],u_test_dV[i]);
-                        elementTransposeTransport[i][j] += // int[(vel.grad_wi)*wj*dx]
-                          ck.HamiltonianJacobian_weak(vn,&u_grad_trial[i_nSpace],u_test_dV[j]);
                       }
                   }//i
               }
@@ -1390,8 +1417,6 @@ namespace proteus
                     int eN_i_j = eN_i*nDOF_trial_element+j;
                     TransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_CellLoops.data()[eN_i_j]]
                       += elementTransport[i][j];
-                    TransposeTransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_CellLoops.data()[eN_i_j]]
-                      += elementTransposeTransport[i][j];
                   }//j
               }//i
           }//elements
@@ -1430,6 +1455,11 @@ namespace proteus
         /////////////////////////////////////////////
         // ** LOOP IN DOFs FOR EDGE BASED TERMS ** //
         /////////////////////////////////////////////
+        // first-order dissipative operator, once per edge
+        edges.symmetricFill(&dLow[0], [this](int i, int j, int ij, int ji)
+                            {
+                              return fmax(fabs(TransportMatrix[ij]),fabs(TransportMatrix[ji]));
+                            });
         int ij=0;
         for (int i=0; i<numDOFs; i++)
           {
@@ -1448,8 +1478,7 @@ namespace proteus
                 ith_flux_term += TransportMatrix[ij]*solnj;
                 if (i != j) //NOTE: there is really no need to check for i!=j (see formula for ith_dissipative_term)
                   {
-                    // first-order dissipative operator
-                    dLij = fmax(fabs(TransportMatrix[ij]),fabs(TransposeTransportMatrix[ij]));
+                    dLij = dLow[ij];
                     dLij *= fmax(psi[i],psi[j]);
                     //dissipative terms
                     ith_dissipative_term += dLij*(solnj-solni);
@@ -1473,6 +1502,7 @@ namespace proteus
         xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
         xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -1489,6 +1519,7 @@ namespace proteus
         //////////////////////////////////////////////
         // ** LOOP IN CELLS FOR CELL BASED TERMS ** //
         //////////////////////////////////////////////
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         for(int eN=0;eN<nElements_global;eN++)
           {
             //declare local storage for local contributions and initialize
@@ -1548,6 +1579,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -1563,6 +1595,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -1645,7 +1678,8 @@ namespace proteus
         // Allocate space for the transport matrices
         // This is used for first order KUZMIN'S METHOD
         TransportMatrix.resize(NNZ,0.0);
-        TransposeTransportMatrix.resize(NNZ,0.0);
+        dLow.resize(NNZ,0.0);
+        edges.setPattern(numDOFs,csrRowIndeces_DofLoops.data(),csrColumnOffsets_DofLoops.data());
         // Allocate and init to zero the Entropy residual vector
         global_entropy_residual.resize(numDOFs,0.0);
         if (STABILIZATION_TYPE==1) //EV stab
@@ -1667,7 +1701,6 @@ namespace proteus
               elementResidual_u[nDOF_test_element],
               element_entropy_residual[nDOF_test_element];
             double  elementTransport[nDOF_test_element][nDOF_trial_element];
-            double  elementTransposeTransport[nDOF_test_element][nDOF_trial_element];
             //double  preconditioned_elementTransport[nDOF_test_element][nDOF_trial_element];
             for (int i=0;i<nDOF_test_element;i++)
               {
@@ -1676,7 +1709,6 @@ namespace proteus
                 for (int j=0;j<nDOF_trial_element;j++)
                   {
                     elementTransport[i][j]=0.0;
-                    elementTransposeTransport[i][j]=0.0;
                     // preconditioned elementTransport
                     //preconditioned_elementTransport[i][j]=0.0;
                   }
@@ -1794,12 +1826,9 @@ namespace proteus
                     for(int j=0;j<nDOF_trial_element;j++)
                       {
                         int j_nSpace = j*nSpace;
-                        int i_nSpace = i*nSpace;
                         // COMPUTE ELEMENT TRANSPORT MATRIX (MQL)
                         elementTransport[i][j] += // int[(vel.grad_wj)*wi*dx]
                           ck.HamiltonianJacobian_weak(vn,&u_grad_trial[j_nSpace],u_test_dV[i]);
-                        elementTransposeTransport[i][j] += // int[(vel.grad_wi)*wj*dx]
-                          ck.HamiltonianJacobian_weak(vn,&u_grad_trial[i_nSpace],u_test_dV[j]);
                       }
                   }//i
                 //save solution at quadrature points for other models to use
@@ -1848,8 +1877,6 @@ namespace proteus
                     int eN_i_j = eN_i*nDOF_trial_element+j;
                     TransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_CellLoops.data()[eN_i_j]]
                       += elementTransport[i][j];
-                    TransposeTransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_CellLoops.data()[eN_i_j]]
-                      += elementTransposeTransport[i][j];
                   }//j
               }//i
           }//elements
@@ -2003,6 +2030,11 @@ namespace proteus
         /////////////////////////////////////////////
         // ** LOOP IN DOFs FOR EDGE BASED TERMS ** //
         /////////////////////////////////////////////
+        // first-order dissipative operator, once per edge
+        edges.symmetricFill(&dLow[0], [this](int i, int j, int ij, int ji)
+                            {
+                              return fmax(fabs(TransportMatrix[ij]),fabs(TransportMatrix[ji]));
+                            });
         ij=0;
         for (int i=0; i<numDOFs; i++)
           {
@@ -2021,8 +2053,7 @@ namespace proteus
                 ith_flux_term += TransportMatrix[ij]*solnj;
                 if (i != j) //NOTE: there is really no need to check for i!=j (see formula for ith_dissipative_term)
                   {
-                    // first-order dissipative operator
-                    dLowij = fmax(fabs(TransportMatrix[ij]),fabs(TransposeTransportMatrix[ij]));
+                    dLowij = dLow[ij];
                     if (STABILIZATION_TYPE==1) //EV Stab
                       {
                         // high-order (entropy viscosity) dissipative operator
@@ -2227,6 +2258,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -2242,6 +2274,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -2431,7 +2464,6 @@ namespace proteus
                         //int eN_k_j=eN_k*nDOF_trial_element+j;
                         //int eN_k_j_nSpace = eN_k_j*nSpace;
                         int j_nSpace = j*nSpace;
-                        int i_nSpace = i*nSpace;
                         if (LUMPED_MASS_MATRIX==1)
                           {
                             if (i==j)
@@ -2469,6 +2501,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -2484,6 +2517,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -272,6 +272,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                  outputQuantDOFs=False,
                  # NULLSPACE Info
                  nullSpace='NoNullSpace',
+                 # NARROW BAND: element layers around the zero level set, None for the whole mesh
+                 nBandLayers=None,
                  initialize=True):
 
         self.PURE_BDF=PURE_BDF
@@ -303,6 +305,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
         self.sc_beta = sc_beta
         self.waterline_interval = waterline_interval
         self.nullSpace = nullSpace
+        self.nBandLayers = nBandLayers
+        assert nBandLayers is None or nBandLayers >= 1, "nBandLayers must be at least 1 to keep the elements cut by the zero level set active"
         if initialize:
             self.initialize()
 
@@ -366,6 +370,10 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
         # SAVE OLD SOLUTION #
         self.model.u_dof_old[:] = self.model.u[0].dof
 
+        # NARROW BAND AROUND THE CURRENT INTERFACE #
+        if self.nBandLayers is not None:
+            self.model.updateNarrowBand()
+
         # COMPUTE NEW VELOCITY (if given by user) #
         if self.model.hasVelocityFieldAsFunction:
             self.model.updateVelocityFieldAsFunction()
@@ -759,6 +767,8 @@ class LevelModel(OneLevelTransport):
             cond = 'levelNonlinearSolver' in dir(options) and options.levelNonlinearSolver == ExplicitConsistentMassMatrixWithRedistancing
             assert cond, "If DO_REDISTANCING=True, use: levelNonlinearSolver=ExplicitConsistentMassMatrixWithRedistancing"
             assert self.timeIntegration.isSSP, "If DO_REDISTANCING=True, use RKEV timeIntegration within NCLS. timeOrder=2 is recommended"
+        if self.coefficients.nBandLayers is not None:
+            assert self.coefficients.STABILIZATION_TYPE == 0, "The narrow band (nBandLayers) is only implemented for STABILIZATION_TYPE=0"
         # END OF ASSERTS
 
         # Smoothing matrix
@@ -859,6 +869,21 @@ class LevelModel(OneLevelTransport):
 
         self.waterline_calls = 0
         self.waterline_prints = 0
+        # DOFs inside the narrow band; the others are held fixed once the band is built
+        self.narrowBandDOF = np.ones(self.u[0].dof.shape, 'd')
+        self.useNarrowBand = False
+
+    def updateNarrowBand(self):
+        """
+        Rebuild the elements within nBandLayers layers of the zero level set
+        """
+        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict["u_l2g"] = self.u[0].femSpace.dofMap.l2g
+        argsDict["u_dof"] = self.u[0].dof
+        argsDict["nBandLayers"] = self.coefficients.nBandLayers
+        argsDict["isActiveDOF"] = self.narrowBandDOF
+        self.ncls.updateNarrowBand(argsDict)
+        self.useNarrowBand = True
 
     # mwf these are getting called by redistancing classes,
     def calculateCoefficients(self):
@@ -921,6 +946,7 @@ class LevelModel(OneLevelTransport):
         argsDict["mesh_grad_trial_ref"] = self.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.mesh.nodeArray
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
         argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
@@ -982,6 +1008,7 @@ class LevelModel(OneLevelTransport):
         argsDict["mesh_grad_trial_ref"] = self.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.mesh.nodeArray
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
         argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
@@ -1194,6 +1221,7 @@ class LevelModel(OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
         argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
@@ -1271,7 +1299,10 @@ class LevelModel(OneLevelTransport):
         argsDict["STABILIZATION_TYPE"] = self.coefficients.STABILIZATION_TYPE
         argsDict["ENTROPY_TYPE"] = self.coefficients.ENTROPY_TYPE
         argsDict["cE"] = self.coefficients.cE
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.calculateResidual(argsDict)
+        if self.useNarrowBand:
+            r *= self.narrowBandDOF
         
         self.quantDOFs[:] = self.interface_locator
 
@@ -1326,6 +1357,7 @@ class LevelModel(OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
         argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
@@ -1390,6 +1422,7 @@ class LevelModel(OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
         argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
@@ -1432,8 +1465,13 @@ class LevelModel(OneLevelTransport):
         argsDict["csrColumnOffsets_eb_u_u"] = self.csrColumnOffsets_eb[(0, 0)]
         argsDict["PURE_BDF"] = self.coefficients.PURE_BDF
         argsDict["LUMPED_MASS_MATRIX"] = self.coefficients.LUMPED_MASS_MATRIX
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.calculateJacobian(argsDict)
 
+        # Hold the DOFs outside the narrow band fixed
+        if self.useNarrowBand:
+            self.setIdentityRows(self.narrowBandDOF)
+
         # Load the Dirichlet conditions directly into residual
         if self.forceStrongConditions:
             scaling = 1.0  # probably want to add some scaling to match non-dirichlet diagonals in linear system
@@ -1523,6 +1561,7 @@ class LevelModel(OneLevelTransport):
             argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
             argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
             argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+            argsDict["mesh_generation"] = self.mesh.generation
             argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
             argsDict["u_trial_ref"] = self.u[0].femSpace.psi
             argsDict["u_grad_trial_ref"] = self.u[0].femSpace.grad_psi
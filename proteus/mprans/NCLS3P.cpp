@@ -25,9 +25,9 @@ PYBIND11_MODULE(cNCLS3P, m)
     xt::import_numpy();
 
     py::class_<cppNCLS3P_base>(m, "cppNCLS3P_base")
-        .def("calculateResidual", &cppNCLS3P_base::calculateResidual)
-        .def("calculateJacobian", &cppNCLS3P_base::calculateJacobian)
-        .def("calculateWaterline", &cppNCLS3P_base::calculateWaterline);
+        .def("calculateResidual", &cppNCLS3P_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppNCLS3P_base::calculateJacobian, proteus::release_gil())
+        .def("calculateWaterline", &cppNCLS3P_base::calculateWaterline, proteus::release_gil());
 
     m.def("newNCLS3P", newNCLS3P);
 }
@@ -24,6 +24,6 @@ PYBIND11_MODULE(cPres, m)
 
     py::class_<cppPres_base>(m, "Pres")
         .def(py::init(&proteus::newPres))
-        .def("calculateResidual", &cppPres_base::calculateResidual)
-        .def("calculateJacobian", &cppPres_base::calculateJacobian);
+        .def("calculateResidual", &cppPres_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppPres_base::calculateJacobian, proteus::release_gil());
 }
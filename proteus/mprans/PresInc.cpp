@@ -24,6 +24,6 @@ PYBIND11_MODULE(cPresInc, m)
 
     py::class_<cppPresInc_base>(m, "PresInc")
         .def(py::init(&proteus::newPresInc))
-        .def("calculateResidual", &cppPresInc_base::calculateResidual)
-        .def("calculateJacobian", &cppPresInc_base::calculateJacobian);
+        .def("calculateResidual", &cppPresInc_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppPresInc_base::calculateJacobian, proteus::release_gil());
 }
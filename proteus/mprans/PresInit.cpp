@@ -24,6 +24,6 @@ PYBIND11_MODULE(cPresInit, m)
 
     py::class_<cppPresInit_base>(m, "PresInit")
         .def(py::init(&proteus::newPresInit))
-        .def("calculateResidual", &cppPresInit_base::calculateResidual)
-        .def("calculateJacobian", &cppPresInit_base::calculateJacobian);
+        .def("calculateResidual", &cppPresInit_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppPresInit_base::calculateJacobian, proteus::release_gil());
 }
@@ -5,8 +5,12 @@
 #include <iostream>
 #include <set>
 #include <map>
+#include <stdexcept>
 #include "CompKernel.h"
 #include "MixedModelFactory.h"
+#include "ElementColoring.h"
+#include "JacobianScatter.h"
+#include "BallGrid.h"
 #include "PyEmbeddedFunctions.h"
 #include "equivalent_polynomials.h"
 #include "ArgumentsDict.h"
@@ -124,17 +128,22 @@ namespace proteus
   class RANS2P_base
   {
   public:
+    //cell list over the particles. This is mutable state on the model object
+    //shared by all calls: step6DOF, calculateResidual and calculateJacobian each
+    //rebuild it from their own ball arrays before use, so it carries nothing
+    //between calls, but two of them must not run concurrently on one object
+    BallGrid ballGrid;
     virtual ~RANS2P_base(){}
     virtual void calculateResidual(arguments_dict& args) = 0;
     virtual void calculateJacobian(arguments_dict& args) = 0;
+    /// y = J x computed element by element, with the arguments of calculateJacobian except globalJacobian
+    virtual void applyJacobian(arguments_dict& args, xt::pyarray<double>& x, xt::pyarray<double>& y) = 0;
     virtual void calculateVelocityAverage(arguments_dict& args)=0;
     virtual void getTwoPhaseAdvectionOperator(arguments_dict& args) = 0;
     virtual void getTwoPhaseInvScaledLaplaceOperator(arguments_dict& args)=0;
     virtual void getTwoPhaseScaledMassOperator(arguments_dict& args)=0;
     void step6DOF(arguments_dict& args)
     {
-      py::gil_scoped_release release;
-      //py::gil_scoped_acquire acquire;
       xt::pyarray<double>& ball_FT = args.array<double>("ball_FT");
       xt::pyarray<double>& ball_last_FT = args.array<double>("ball_last_FT");
       xt::pyarray<double>& ball_h = args.array<double>("ball_h");
@@ -190,11 +199,19 @@ namespace proteus
 	    ball_angular_velocity(ip,i) = 0.0;
 	  }
       
+      double max_radius = 0.0;
+      for (int ip=0; ip < nParticles; ip++)
+	max_radius = fmax(max_radius, ball_radius(ip));
       while (td < dt)
 	{
 	  nSteps +=1;
 	  //particle-wall and particle-particle collision forces
-#pragma omp parallel for
+	  //only particles in adjacent cells of a grid with cells wider than the force range can interact
+	  ballGrid.build(nParticles, ball_center.data(), ball_radius.data(), 2.0*max_radius + ball_force_range);
+#pragma omp parallel
+	  {
+	  std::vector<int> ball_neighbors;
+#pragma omp for
 	  for (int ip=0; ip < nParticles; ip++)
 	    {
 	      double vnorm = enorm(&ball_last_velocity.data()[ip*3]);
@@ -223,8 +240,10 @@ namespace proteus
       
 	      for (int i=0; i< 3;i++)
 		ball_f(ip,i) = 0.0;
-	      for (int jp=0; jp < nParticles; jp++)
+	      ballGrid.neighbors(&ball_center.data()[ip*3], ball_neighbors);
+	      for (std::size_t jp_neighbor=0; jp_neighbor < ball_neighbors.size(); jp_neighbor++)
 		{
+		  const int jp = ball_neighbors[jp_neighbor];
 		  double ball_range, d;
 		  double f[3], h_ipjp[3];
 		  ball_range = ball_radius(ip) + ball_radius(jp) + ball_force_range;
@@ -239,6 +258,7 @@ namespace proteus
 		}
 	      cfl(ip) = fmax(vnorm*DT/ball_force_range, vpnorm*DT/ball_force_range);
 	    }
+	  }
 	  double max_cfl = xt::amax(cfl,{0})(0);
 	  if (max_cfl > particle_cfl)
 	    DT = (particle_cfl/max_cfl)*DT;
@@ -296,6 +316,498 @@ namespace proteus
     }
   };
 
+  // The arguments each kernel reads from its arguments_dict, looked up once
+  // per dict (see PROTEUS_ARGUMENT_BLOCK)
+#define RANS2P_RESIDUAL_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  SCALAR(double, NONCONSERVATIVE_FORM)                       \
+  SCALAR(double, MOMENTUM_SGE)                               \
+  SCALAR(double, PRESSURE_SGE)                               \
+  SCALAR(double, VELOCITY_SGE)                               \
+  SCALAR(double, PRESSURE_PROJECTION_STABILIZATION)          \
+  ARRAY(double, numerical_viscosity)                         \
+  ARRAY(double, mesh_trial_ref)                              \
+  ARRAY(double, mesh_grad_trial_ref)                         \
+  ARRAY(double, mesh_dof)                                    \
+  ARRAY(double, mesh_velocity_dof)                           \
+  SCALAR(double, MOVING_DOMAIN)                              \
+  SCALAR(int, mesh_generation)                               \
+  ARRAY(int, mesh_l2g)                                       \
+  ARRAY(double, x_ref)                                       \
+  ARRAY(double, dV_ref)                                      \
+  ARRAY(double, p_trial_ref)                                 \
+  ARRAY(double, p_grad_trial_ref)                            \
+  ARRAY(double, p_test_ref)                                  \
+  ARRAY(double, p_grad_test_ref)                             \
+  ARRAY(double, vel_trial_ref)                               \
+  ARRAY(double, vel_grad_trial_ref)                          \
+  ARRAY(double, vel_test_ref)                                \
+  ARRAY(double, vel_grad_test_ref)                           \
+  ARRAY(double, mesh_trial_trace_ref)                        \
+  ARRAY(double, mesh_grad_trial_trace_ref)                   \
+  ARRAY(double, xb_ref)                                      \
+  ARRAY(double, dS_ref)                                      \
+  ARRAY(double, p_trial_trace_ref)                           \
+  ARRAY(double, p_grad_trial_trace_ref)                      \
+  ARRAY(double, p_test_trace_ref)                            \
+  ARRAY(double, p_grad_test_trace_ref)                       \
+  ARRAY(double, vel_trial_trace_ref)                         \
+  ARRAY(double, vel_grad_trial_trace_ref)                    \
+  ARRAY(double, vel_test_trace_ref)                          \
+  ARRAY(double, vel_grad_test_trace_ref)                     \
+  ARRAY(double, normal_ref)                                  \
+  ARRAY(double, boundaryJac_ref)                             \
+  SCALAR(double, eb_adjoint_sigma)                           \
+  ARRAY(double, elementDiameter)                             \
+  ARRAY(double, elementBoundaryDiameter)                     \
+  ARRAY(double, nodeDiametersArray)                          \
+  SCALAR(double, hFactor)                                    \
+  SCALAR(int, nElements_global)                              \
+  SCALAR(int, nElementBoundaries_owned)                      \
+  SCALAR(double, useRBLES)                                   \
+  SCALAR(double, useMetrics)                                 \
+  SCALAR(double, alphaBDF)                                   \
+  SCALAR(double, epsFact_rho)                                \
+  SCALAR(double, epsFact_mu)                                 \
+  SCALAR(double, sigma)                                      \
+  SCALAR(double, rho_0)                                      \
+  SCALAR(double, nu_0)                                       \
+  SCALAR(double, rho_1)                                      \
+  SCALAR(double, nu_1)                                       \
+  SCALAR(double, smagorinskyConstant)                        \
+  SCALAR(int, turbulenceClosureModel)                        \
+  SCALAR(double, Ct_sge)                                     \
+  SCALAR(double, Cd_sge)                                     \
+  SCALAR(double, C_dc)                                       \
+  SCALAR(double, C_b)                                        \
+  ARRAY(double, eps_solid)                                   \
+  ARRAY(double, phi_solid)                                   \
+  ARRAY(double, eps_porous)                                  \
+  ARRAY(double, phi_porous)                                  \
+  ARRAY(double, q_velocity_porous)                           \
+  ARRAY(double, q_porosity)                                  \
+  ARRAY(double, q_dragAlpha)                                 \
+  ARRAY(double, q_dragBeta)                                  \
+  ARRAY(double, q_mass_source)                               \
+  ARRAY(double, q_turb_var_0)                                \
+  ARRAY(double, q_turb_var_1)                                \
+  ARRAY(double, q_turb_var_grad_0)                           \
+  SCALAR(double, LAG_LES)                                    \
+  ARRAY(double, q_eddy_viscosity)                            \
+  ARRAY(double, q_eddy_viscosity_last)                       \
+  ARRAY(double, ebqe_eddy_viscosity)                         \
+  ARRAY(double, ebqe_eddy_viscosity_last)                    \
+  ARRAY(int, p_l2g)                                          \
+  ARRAY(int, vel_l2g)                                        \
+  ARRAY(int, rp_l2g)                                         \
+  ARRAY(int, rvel_l2g)                                       \
+  ARRAY(int, elementColorOffsets)                            \
+  ARRAY(int, elementColorsArray)                             \
+  ARRAY(double, p_dof)                                       \
+  ARRAY(double, u_dof)                                       \
+  ARRAY(double, v_dof)                                       \
+  ARRAY(double, w_dof)                                       \
+  ARRAY(double, p_old_dof)                                   \
+  ARRAY(double, u_old_dof)                                   \
+  ARRAY(double, v_old_dof)                                   \
+  ARRAY(double, w_old_dof)                                   \
+  ARRAY(double, g)                                           \
+  SCALAR(double, useVF)                                      \
+  ARRAY(double, q_rho)                                       \
+  ARRAY(double, vf)                                          \
+  ARRAY(double, phi)                                         \
+  ARRAY(double, phi_nodes)                                   \
+  ARRAY(double, normal_phi)                                  \
+  ARRAY(double, kappa_phi)                                   \
+  ARRAY(double, q_mom_u_acc)                                 \
+  ARRAY(double, q_mom_v_acc)                                 \
+  ARRAY(double, q_mom_w_acc)                                 \
+  ARRAY(double, q_mass_adv)                                  \
+  ARRAY(double, q_mom_u_acc_beta_bdf)                        \
+  ARRAY(double, q_mom_v_acc_beta_bdf)                        \
+  ARRAY(double, q_mom_w_acc_beta_bdf)                        \
+  ARRAY(double, q_dV)                                        \
+  ARRAY(double, q_dV_last)                                   \
+  ARRAY(double, q_velocity_sge)                              \
+  ARRAY(double, q_cfl)                                       \
+  ARRAY(double, q_numDiff_u)                                 \
+  ARRAY(double, q_numDiff_v)                                 \
+  ARRAY(double, q_numDiff_w)                                 \
+  ARRAY(double, q_numDiff_u_last)                            \
+  ARRAY(double, q_numDiff_v_last)                            \
+  ARRAY(double, q_numDiff_w_last)                            \
+  ARRAY(int, sdInfo_u_u_rowptr)                              \
+  ARRAY(int, sdInfo_u_u_colind)                              \
+  ARRAY(int, sdInfo_u_v_rowptr)                              \
+  ARRAY(int, sdInfo_u_v_colind)                              \
+  ARRAY(int, sdInfo_u_w_rowptr)                              \
+  ARRAY(int, sdInfo_u_w_colind)                              \
+  ARRAY(int, sdInfo_v_v_rowptr)                              \
+  ARRAY(int, sdInfo_v_v_colind)                              \
+  ARRAY(int, sdInfo_v_u_rowptr)                              \
+  ARRAY(int, sdInfo_v_u_colind)                              \
+  ARRAY(int, sdInfo_v_w_rowptr)                              \
+  ARRAY(int, sdInfo_v_w_colind)                              \
+  ARRAY(int, sdInfo_w_w_rowptr)                              \
+  ARRAY(int, sdInfo_w_w_colind)                              \
+  ARRAY(int, sdInfo_w_u_rowptr)                              \
+  ARRAY(int, sdInfo_w_u_colind)                              \
+  ARRAY(int, sdInfo_w_v_rowptr)                              \
+  ARRAY(int, sdInfo_w_v_colind)                              \
+  SCALAR(int, offset_p)                                      \
+  SCALAR(int, offset_u)                                      \
+  SCALAR(int, offset_v)                                      \
+  SCALAR(int, offset_w)                                      \
+  SCALAR(int, stride_p)                                      \
+  SCALAR(int, stride_u)                                      \
+  SCALAR(int, stride_v)                                      \
+  SCALAR(int, stride_w)                                      \
+  ARRAY(double, globalResidual)                              \
+  SCALAR(int, nExteriorElementBoundaries_global)             \
+  ARRAY(int, exteriorElementBoundariesArray)                 \
+  ARRAY(int, elementBoundariesArray)                         \
+  ARRAY(int, elementBoundaryElementsArray)                   \
+  ARRAY(int, elementBoundaryLocalElementBoundariesArray)     \
+  ARRAY(double, ebqe_vf_ext)                                 \
+  ARRAY(double, bc_ebqe_vf_ext)                              \
+  ARRAY(double, ebqe_phi_ext)                                \
+  ARRAY(double, bc_ebqe_phi_ext)                             \
+  ARRAY(double, ebqe_normal_phi_ext)                         \
+  ARRAY(double, ebqe_kappa_phi_ext)                          \
+  ARRAY(double, ebqe_porosity_ext)                           \
+  ARRAY(double, ebqe_turb_var_0)                             \
+  ARRAY(double, ebqe_turb_var_1)                             \
+  ARRAY(int, isDOFBoundary_p)                                \
+  ARRAY(int, isDOFBoundary_u)                                \
+  ARRAY(int, isDOFBoundary_v)                                \
+  ARRAY(int, isDOFBoundary_w)                                \
+  ARRAY(int, isAdvectiveFluxBoundary_p)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_u)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_v)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_w)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_u)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_v)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_w)                      \
+  ARRAY(double, ebqe_bc_p_ext)                               \
+  ARRAY(double, ebqe_bc_flux_mass_ext)                       \
+  ARRAY(double, ebqe_bc_flux_mom_u_adv_ext)                  \
+  ARRAY(double, ebqe_bc_flux_mom_v_adv_ext)                  \
+  ARRAY(double, ebqe_bc_flux_mom_w_adv_ext)                  \
+  ARRAY(double, ebqe_bc_u_ext)                               \
+  ARRAY(double, ebqe_bc_flux_u_diff_ext)                     \
+  ARRAY(double, ebqe_penalty_ext)                            \
+  ARRAY(double, ebqe_bc_v_ext)                               \
+  ARRAY(double, ebqe_bc_flux_v_diff_ext)                     \
+  ARRAY(double, ebqe_bc_w_ext)                               \
+  ARRAY(double, ebqe_bc_flux_w_diff_ext)                     \
+  ARRAY(double, q_x)                                         \
+  ARRAY(double, q_u_0)                                       \
+  ARRAY(double, q_u_1)                                       \
+  ARRAY(double, q_u_2)                                       \
+  ARRAY(double, q_u_3)                                       \
+  ARRAY(double, q_velocity)                                  \
+  ARRAY(double, ebqe_velocity)                               \
+  ARRAY(double, flux)                                        \
+  ARRAY(double, elementResidual_p_save)                      \
+  ARRAY(int, elementFlags)                                   \
+  ARRAY(int, boundaryFlags)                                  \
+  ARRAY(double, barycenters)                                 \
+  ARRAY(double, wettedAreas)                                 \
+  ARRAY(double, netForces_p)                                 \
+  ARRAY(double, netForces_v)                                 \
+  ARRAY(double, netMoments)                                  \
+  ARRAY(double, velocityError)                               \
+  ARRAY(double, velocityErrorNodal)                          \
+  ARRAY(double, forcex)                                      \
+  ARRAY(double, forcey)                                      \
+  ARRAY(double, forcez)                                      \
+  SCALAR(int, use_ball_as_particle)                          \
+  ARRAY(double, ball_center)                                 \
+  ARRAY(double, ball_radius)                                 \
+  ARRAY(double, ball_velocity)                               \
+  ARRAY(double, ball_angular_velocity)                       \
+  ARRAY(double, ball_density)                                \
+  ARRAY(double, particle_signed_distances)                   \
+  ARRAY(double, particle_signed_distance_normals)            \
+  ARRAY(double, particle_velocities)                         \
+  ARRAY(double, particle_centroids)                          \
+  ARRAY(double, ebqe_phi_s)                                  \
+  ARRAY(double, ebq_global_grad_phi_s)                       \
+  ARRAY(double, ebq_particle_velocity_s)                     \
+  SCALAR(int, nParticles)                                    \
+  ARRAY(double, particle_netForces)                          \
+  ARRAY(double, particle_netMoments)                         \
+  ARRAY(double, particle_surfaceArea)                        \
+  ARRAY(double, particle_surfaceArea_projected)              \
+  ARRAY(double, projection_direction)                        \
+  ARRAY(double, particle_volume)                             \
+  SCALAR(int, nElements_owned)                               \
+  SCALAR(double, particle_nitsche)                           \
+  SCALAR(double, particle_epsFact)                           \
+  SCALAR(double, particle_alpha)                             \
+  SCALAR(double, particle_beta)                              \
+  SCALAR(double, particle_penalty_constant)                  \
+  SCALAR(double, ghost_penalty_constant)                     \
+  ARRAY(double, phi_solid_nodes)                             \
+  ARRAY(double, distance_to_solids)                          \
+  SCALAR(int, useExact)                                      \
+  ARRAY(double, isActiveR)                                   \
+  ARRAY(double, isActiveDOF_p)                               \
+  ARRAY(double, isActiveDOF_vel)                             \
+  SCALAR(int, normalize_pressure)                            \
+  ARRAY(double, errors)                                      \
+  ARRAY(double, ball_u)                                      \
+  ARRAY(double, ball_v)                                      \
+  ARRAY(double, ball_w)                                      \
+  ARRAY(int, isActiveElement)                                \
+  ARRAY(int, isActiveElement_last)
+  PROTEUS_ARGUMENT_BLOCK(RANS2PResidualArguments, RANS2P_RESIDUAL_ARGUMENTS)
+
+#define RANS2P_JACOBIAN_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  SCALAR(double, NONCONSERVATIVE_FORM)                       \
+  SCALAR(int, blockDiagonalVelocityJacobian)                 \
+  SCALAR(double, MOMENTUM_SGE)                               \
+  SCALAR(double, PRESSURE_SGE)                               \
+  SCALAR(double, VELOCITY_SGE)                               \
+  SCALAR(double, PRESSURE_PROJECTION_STABILIZATION)          \
+  ARRAY(double, mesh_trial_ref)                              \
+  ARRAY(double, mesh_grad_trial_ref)                         \
+  ARRAY(double, mesh_dof)                                    \
+  ARRAY(double, mesh_velocity_dof)                           \
+  SCALAR(double, MOVING_DOMAIN)                              \
+  SCALAR(int, mesh_generation)                               \
+  ARRAY(int, mesh_l2g)                                       \
+  ARRAY(double, x_ref)                                       \
+  ARRAY(double, dV_ref)                                      \
+  ARRAY(double, p_trial_ref)                                 \
+  ARRAY(double, p_grad_trial_ref)                            \
+  ARRAY(double, p_test_ref)                                  \
+  ARRAY(double, p_grad_test_ref)                             \
+  ARRAY(double, vel_trial_ref)                               \
+  ARRAY(double, vel_grad_trial_ref)                          \
+  ARRAY(double, vel_test_ref)                                \
+  ARRAY(double, vel_grad_test_ref)                           \
+  ARRAY(double, mesh_trial_trace_ref)                        \
+  ARRAY(double, mesh_grad_trial_trace_ref)                   \
+  ARRAY(double, xb_ref)                                      \
+  ARRAY(double, dS_ref)                                      \
+  ARRAY(double, p_trial_trace_ref)                           \
+  ARRAY(double, p_grad_trial_trace_ref)                      \
+  ARRAY(double, p_test_trace_ref)                            \
+  ARRAY(double, p_grad_test_trace_ref)                       \
+  ARRAY(double, vel_trial_trace_ref)                         \
+  ARRAY(double, vel_grad_trial_trace_ref)                    \
+  ARRAY(double, vel_test_trace_ref)                          \
+  ARRAY(double, vel_grad_test_trace_ref)                     \
+  ARRAY(double, normal_ref)                                  \
+  ARRAY(double, boundaryJac_ref)                             \
+  SCALAR(double, eb_adjoint_sigma)                           \
+  ARRAY(double, elementDiameter)                             \
+  ARRAY(double, elementBoundaryDiameter)                     \
+  ARRAY(double, nodeDiametersArray)                          \
+  SCALAR(double, hFactor)                                    \
+  SCALAR(int, nElements_global)                              \
+  SCALAR(double, useRBLES)                                   \
+  SCALAR(double, useMetrics)                                 \
+  SCALAR(double, alphaBDF)                                   \
+  SCALAR(double, epsFact_rho)                                \
+  SCALAR(double, epsFact_mu)                                 \
+  SCALAR(double, sigma)                                      \
+  SCALAR(double, rho_0)                                      \
+  SCALAR(double, nu_0)                                       \
+  SCALAR(double, rho_1)                                      \
+  SCALAR(double, nu_1)                                       \
+  SCALAR(double, smagorinskyConstant)                        \
+  SCALAR(int, turbulenceClosureModel)                        \
+  SCALAR(double, Ct_sge)                                     \
+  SCALAR(double, Cd_sge)                                     \
+  SCALAR(double, C_dg)                                       \
+  SCALAR(double, C_b)                                        \
+  ARRAY(double, eps_solid)                                   \
+  ARRAY(double, phi_solid)                                   \
+  ARRAY(double, eps_porous)                                  \
+  ARRAY(double, phi_porous)                                  \
+  ARRAY(double, q_velocity_porous)                           \
+  ARRAY(double, q_porosity)                                  \
+  ARRAY(double, q_dragAlpha)                                 \
+  ARRAY(double, q_dragBeta)                                  \
+  ARRAY(double, q_mass_source)                               \
+  ARRAY(double, q_turb_var_0)                                \
+  ARRAY(double, q_turb_var_1)                                \
+  ARRAY(double, q_turb_var_grad_0)                           \
+  SCALAR(double, LAG_LES)                                    \
+  ARRAY(double, q_eddy_viscosity_last)                       \
+  ARRAY(double, ebqe_eddy_viscosity_last)                    \
+  ARRAY(int, p_l2g)                                          \
+  ARRAY(int, vel_l2g)                                        \
+  ARRAY(int, rp_l2g)                                         \
+  ARRAY(int, rvel_l2g)                                       \
+  ARRAY(int, elementColorOffsets)                            \
+  ARRAY(int, elementColorsArray)                             \
+  SCALAR(int, offset_p)                                      \
+  SCALAR(int, offset_u)                                      \
+  SCALAR(int, offset_v)                                      \
+  SCALAR(int, offset_w)                                      \
+  SCALAR(int, stride_p)                                      \
+  SCALAR(int, stride_u)                                      \
+  SCALAR(int, stride_v)                                      \
+  SCALAR(int, stride_w)                                      \
+  ARRAY(double, p_dof)                                       \
+  ARRAY(double, u_dof)                                       \
+  ARRAY(double, v_dof)                                       \
+  ARRAY(double, w_dof)                                       \
+  ARRAY(double, p_old_dof)                                   \
+  ARRAY(double, u_old_dof)                                   \
+  ARRAY(double, v_old_dof)                                   \
+  ARRAY(double, w_old_dof)                                   \
+  ARRAY(double, g)                                           \
+  SCALAR(double, useVF)                                      \
+  ARRAY(double, vf)                                          \
+  ARRAY(double, phi)                                         \
+  ARRAY(double, phi_nodes)                                   \
+  ARRAY(double, normal_phi)                                  \
+  ARRAY(double, kappa_phi)                                   \
+  ARRAY(double, q_mom_u_acc_beta_bdf)                        \
+  ARRAY(double, q_mom_v_acc_beta_bdf)                        \
+  ARRAY(double, q_mom_w_acc_beta_bdf)                        \
+  ARRAY(double, q_dV)                                        \
+  ARRAY(double, q_dV_last)                                   \
+  ARRAY(double, q_velocity_sge)                              \
+  ARRAY(double, q_cfl)                                       \
+  ARRAY(double, q_numDiff_u_last)                            \
+  ARRAY(double, q_numDiff_v_last)                            \
+  ARRAY(double, q_numDiff_w_last)                            \
+  ARRAY(int, sdInfo_u_u_rowptr)                              \
+  ARRAY(int, sdInfo_u_u_colind)                              \
+  ARRAY(int, sdInfo_u_v_rowptr)                              \
+  ARRAY(int, sdInfo_u_v_colind)                              \
+  ARRAY(int, sdInfo_u_w_rowptr)                              \
+  ARRAY(int, sdInfo_u_w_colind)                              \
+  ARRAY(int, sdInfo_v_v_rowptr)                              \
+  ARRAY(int, sdInfo_v_v_colind)                              \
+  ARRAY(int, sdInfo_v_u_rowptr)                              \
+  ARRAY(int, sdInfo_v_u_colind)                              \
+  ARRAY(int, sdInfo_v_w_rowptr)                              \
+  ARRAY(int, sdInfo_v_w_colind)                              \
+  ARRAY(int, sdInfo_w_w_rowptr)                              \
+  ARRAY(int, sdInfo_w_w_colind)                              \
+  ARRAY(int, sdInfo_w_u_rowptr)                              \
+  ARRAY(int, sdInfo_w_u_colind)                              \
+  ARRAY(int, sdInfo_w_v_rowptr)                              \
+  ARRAY(int, sdInfo_w_v_colind)                              \
+  ARRAY(int, csrRowIndeces_p_p)                              \
+  ARRAY(int, csrColumnOffsets_p_p)                           \
+  ARRAY(int, csrRowIndeces_p_u)                              \
+  ARRAY(int, csrColumnOffsets_p_u)                           \
+  ARRAY(int, csrRowIndeces_p_v)                              \
+  ARRAY(int, csrColumnOffsets_p_v)                           \
+  ARRAY(int, csrRowIndeces_p_w)                              \
+  ARRAY(int, csrColumnOffsets_p_w)                           \
+  ARRAY(int, csrRowIndeces_u_p)                              \
+  ARRAY(int, csrColumnOffsets_u_p)                           \
+  ARRAY(int, csrRowIndeces_u_u)                              \
+  ARRAY(int, csrColumnOffsets_u_u)                           \
+  ARRAY(int, csrRowIndeces_u_v)                              \
+  ARRAY(int, csrColumnOffsets_u_v)                           \
+  ARRAY(int, csrRowIndeces_u_w)                              \
+  ARRAY(int, csrColumnOffsets_u_w)                           \
+  ARRAY(int, csrRowIndeces_v_p)                              \
+  ARRAY(int, csrColumnOffsets_v_p)                           \
+  ARRAY(int, csrRowIndeces_v_u)                              \
+  ARRAY(int, csrColumnOffsets_v_u)                           \
+  ARRAY(int, csrRowIndeces_v_v)                              \
+  ARRAY(int, csrColumnOffsets_v_v)                           \
+  ARRAY(int, csrRowIndeces_v_w)                              \
+  ARRAY(int, csrColumnOffsets_v_w)                           \
+  ARRAY(int, csrRowIndeces_w_p)                              \
+  ARRAY(int, csrColumnOffsets_w_p)                           \
+  ARRAY(int, csrRowIndeces_w_u)                              \
+  ARRAY(int, csrColumnOffsets_w_u)                           \
+  ARRAY(int, csrRowIndeces_w_v)                              \
+  ARRAY(int, csrColumnOffsets_w_v)                           \
+  ARRAY(int, csrRowIndeces_w_w)                              \
+  ARRAY(int, csrColumnOffsets_w_w)                           \
+  SCALAR(int, nExteriorElementBoundaries_global)             \
+  ARRAY(int, exteriorElementBoundariesArray)                 \
+  ARRAY(int, elementBoundaryElementsArray)                   \
+  ARRAY(int, elementBoundaryLocalElementBoundariesArray)     \
+  ARRAY(double, ebqe_vf_ext)                                 \
+  ARRAY(double, bc_ebqe_vf_ext)                              \
+  ARRAY(double, ebqe_phi_ext)                                \
+  ARRAY(double, bc_ebqe_phi_ext)                             \
+  ARRAY(double, ebqe_normal_phi_ext)                         \
+  ARRAY(double, ebqe_kappa_phi_ext)                          \
+  ARRAY(double, ebqe_porosity_ext)                           \
+  ARRAY(double, ebqe_turb_var_0)                             \
+  ARRAY(double, ebqe_turb_var_1)                             \
+  ARRAY(int, isDOFBoundary_p)                                \
+  ARRAY(int, isDOFBoundary_u)                                \
+  ARRAY(int, isDOFBoundary_v)                                \
+  ARRAY(int, isDOFBoundary_w)                                \
+  ARRAY(int, isAdvectiveFluxBoundary_p)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_u)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_v)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_w)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_u)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_v)                      \
+  ARRAY(int, isDiffusiveFluxBoundary_w)                      \
+  ARRAY(double, ebqe_bc_p_ext)                               \
+  ARRAY(double, ebqe_bc_flux_mass_ext)                       \
+  ARRAY(double, ebqe_bc_flux_mom_u_adv_ext)                  \
+  ARRAY(double, ebqe_bc_flux_mom_v_adv_ext)                  \
+  ARRAY(double, ebqe_bc_flux_mom_w_adv_ext)                  \
+  ARRAY(double, ebqe_bc_u_ext)                               \
+  ARRAY(double, ebqe_bc_flux_u_diff_ext)                     \
+  ARRAY(double, ebqe_penalty_ext)                            \
+  ARRAY(double, ebqe_bc_v_ext)                               \
+  ARRAY(double, ebqe_bc_flux_v_diff_ext)                     \
+  ARRAY(double, ebqe_bc_w_ext)                               \
+  ARRAY(double, ebqe_bc_flux_w_diff_ext)                     \
+  ARRAY(int, csrColumnOffsets_eb_p_p)                        \
+  ARRAY(int, csrColumnOffsets_eb_p_u)                        \
+  ARRAY(int, csrColumnOffsets_eb_p_v)                        \
+  ARRAY(int, csrColumnOffsets_eb_p_w)                        \
+  ARRAY(int, csrColumnOffsets_eb_u_p)                        \
+  ARRAY(int, csrColumnOffsets_eb_u_u)                        \
+  ARRAY(int, csrColumnOffsets_eb_u_v)                        \
+  ARRAY(int, csrColumnOffsets_eb_u_w)                        \
+  ARRAY(int, csrColumnOffsets_eb_v_p)                        \
+  ARRAY(int, csrColumnOffsets_eb_v_u)                        \
+  ARRAY(int, csrColumnOffsets_eb_v_v)                        \
+  ARRAY(int, csrColumnOffsets_eb_v_w)                        \
+  ARRAY(int, csrColumnOffsets_eb_w_p)                        \
+  ARRAY(int, csrColumnOffsets_eb_w_u)                        \
+  ARRAY(int, csrColumnOffsets_eb_w_v)                        \
+  ARRAY(int, csrColumnOffsets_eb_w_w)                        \
+  ARRAY(int, elementFlags)                                   \
+  ARRAY(int, boundaryFlags)                                  \
+  SCALAR(int, use_ball_as_particle)                          \
+  ARRAY(double, ball_center)                                 \
+  ARRAY(double, ball_radius)                                 \
+  ARRAY(double, ball_velocity)                               \
+  ARRAY(double, ball_angular_velocity)                       \
+  ARRAY(double, ball_density)                                \
+  ARRAY(double, particle_signed_distances)                   \
+  ARRAY(double, particle_signed_distance_normals)            \
+  ARRAY(double, particle_velocities)                         \
+  ARRAY(double, particle_centroids)                          \
+  ARRAY(double, ebqe_phi_s)                                  \
+  ARRAY(double, ebq_global_grad_phi_s)                       \
+  ARRAY(double, ebq_particle_velocity_s)                     \
+  ARRAY(double, phi_solid_nodes)                             \
+  ARRAY(double, distance_to_solids)                          \
+  ARRAY(int, isActiveElement)                                \
+  ARRAY(int, isActiveElement_last)                           \
+  SCALAR(int, nParticles)                                    \
+  SCALAR(int, nElements_owned)                               \
+  SCALAR(double, particle_nitsche)                           \
+  SCALAR(double, particle_epsFact)                           \
+  SCALAR(double, particle_alpha)                             \
+  SCALAR(double, particle_beta)                              \
+  SCALAR(double, particle_penalty_constant)                  \
+  SCALAR(double, ghost_penalty_constant)                     \
+  SCALAR(int, useExact)
+  PROTEUS_ARGUMENT_BLOCK(RANS2PJacobianArguments, RANS2P_JACOBIAN_ARGUMENTS)
+
   template<class CompKernelType,
            class CompKernelType_v,
            int nSpace,
@@ -322,6 +834,10 @@ namespace proteus
     GeneralizedFunctions<nSpace,3,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf;
     GeneralizedFunctions<nSpace,3,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf_p;
     GeneralizedFunctions<nSpace,3,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf_s;
+    ElementColorsView elementColoring;
+    JacobianScatter jacobianScatter;
+    argument_binding<RANS2PResidualArguments> residualArguments;
+    argument_binding<RANS2PJacobianArguments> jacobianArguments;
     RANS2P():
       nDOF_test_X_trial_element(nDOF_test_element*nDOF_trial_element),
       nDOF_test_X_v_trial_element(nDOF_test_element*nDOF_v_trial_element),
@@ -331,6 +847,23 @@ namespace proteus
       ck_v()
     {}
 
+    //With OpenMP the element loops run color by color, each color in parallel, over
+    //the coloring cached on the Mesh (Mesh.buildElementColoring). Elements of one color
+    //share no node, hence none of the DOFs scattered to through the l2g maps.
+    inline void setElementColoring(int nElements_global,
+                                   xt::pyarray<int>& elementColorOffsets,
+                                   xt::pyarray<int>& elementColorsArray)
+    {
+#ifdef _OPENMP
+      const int nColors = int(elementColorOffsets.size()) - 1;
+      if (nColors < 1 || elementColorOffsets.data()[nColors] != nElements_global || int(elementColorsArray.size()) != nElements_global)
+        throw std::invalid_argument("RANS2P: the element coloring does not match the mesh, call Mesh.buildElementColoring");
+      elementColoring.set(nColors, elementColorOffsets.data(), elementColorsArray.data());
+#else
+      elementColoring.setSerial(nElements_global);
+#endif
+    }
+
     inline
     void evaluateCoefficients(const double NONCONSERVATIVE_FORM,
                               const double sigma,
@@ -780,26 +1313,6 @@ namespace proteus
       mom_w_source -= forcez;
     }
 
-    int get_distance_to_ball(int n_balls,const double* ball_center, const double* ball_radius, const double x, const double y, const double z, double& distance)
-    {
-      distance = 1e10;
-      int index = -1;
-      double d_ball_i;
-      for (int i=0; i<n_balls; ++i)
-        {
-          d_ball_i = std::sqrt((ball_center[i*3+0]-x)*(ball_center[i*3+0]-x)
-                               +(ball_center[i*3+1]-y)*(ball_center[i*3+1]-y)
-                               +(ball_center[i*3+2]-z)*(ball_center[i*3+2]-z)
-                               ) - ball_radius[i];
-          if(d_ball_i<distance)
-            {
-              distance = d_ball_i;
-              index = i;
-            }
-        }
-      return index;
-    }
-
     void get_distance_to_ith_ball(int n_balls,const double* ball_center, const double* ball_radius,
                                   int I,
                                   const double x, const double y, const double z,
@@ -2152,244 +2665,10 @@ namespace proteus
 
     void calculateResidual(arguments_dict& args)
     {
-      double NONCONSERVATIVE_FORM = args.scalar<double>("NONCONSERVATIVE_FORM");
-      double MOMENTUM_SGE = args.scalar<double>("MOMENTUM_SGE");
-      double PRESSURE_SGE = args.scalar<double>("PRESSURE_SGE");
-      double VELOCITY_SGE = args.scalar<double>("VELOCITY_SGE");
-      double PRESSURE_PROJECTION_STABILIZATION = args.scalar<double>("PRESSURE_PROJECTION_STABILIZATION");
-      xt::pyarray<double>& numerical_viscosity = args.array<double>("numerical_viscosity");
-      xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
-      xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
-      xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
-      xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
-      double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
-      xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
-      xt::pyarray<double>& x_ref = args.array<double>("x_ref");
-      xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
-      xt::pyarray<double>& p_trial_ref = args.array<double>("p_trial_ref");
-      xt::pyarray<double>& p_grad_trial_ref = args.array<double>("p_grad_trial_ref");
-      xt::pyarray<double>& p_test_ref = args.array<double>("p_test_ref");
-      xt::pyarray<double>& p_grad_test_ref = args.array<double>("p_grad_test_ref");
-      xt::pyarray<double>& vel_trial_ref = args.array<double>("vel_trial_ref");
-      xt::pyarray<double>& vel_grad_trial_ref = args.array<double>("vel_grad_trial_ref");
-      xt::pyarray<double>& vel_test_ref = args.array<double>("vel_test_ref");
-      xt::pyarray<double>& vel_grad_test_ref = args.array<double>("vel_grad_test_ref");
-      xt::pyarray<double>& mesh_trial_trace_ref = args.array<double>("mesh_trial_trace_ref");
-      xt::pyarray<double>& mesh_grad_trial_trace_ref = args.array<double>("mesh_grad_trial_trace_ref");
-      xt::pyarray<double>& xb_ref = args.array<double>("xb_ref");
-      xt::pyarray<double>& dS_ref = args.array<double>("dS_ref");
-      xt::pyarray<double>& p_trial_trace_ref = args.array<double>("p_trial_trace_ref");
-      xt::pyarray<double>& p_grad_trial_trace_ref = args.array<double>("p_grad_trial_trace_ref");
-      xt::pyarray<double>& p_test_trace_ref = args.array<double>("p_test_trace_ref");
-      xt::pyarray<double>& p_grad_test_trace_ref = args.array<double>("p_grad_test_trace_ref");
-      xt::pyarray<double>& vel_trial_trace_ref = args.array<double>("vel_trial_trace_ref");
-      xt::pyarray<double>& vel_grad_trial_trace_ref = args.array<double>("vel_grad_trial_trace_ref");
-      xt::pyarray<double>& vel_test_trace_ref = args.array<double>("vel_test_trace_ref");
-      xt::pyarray<double>& vel_grad_test_trace_ref = args.array<double>("vel_grad_test_trace_ref");
-      xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
-      xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
-      double eb_adjoint_sigma = args.scalar<double>("eb_adjoint_sigma");
-      xt::pyarray<double>& elementDiameter = args.array<double>("elementDiameter");
-      xt::pyarray<double>& elementBoundaryDiameter = args.array<double>("elementBoundaryDiameter");
-      xt::pyarray<double>& nodeDiametersArray = args.array<double>("nodeDiametersArray");
-      double hFactor = args.scalar<double>("hFactor");
-      int nElements_global = args.scalar<int>("nElements_global");
-      int nElementBoundaries_owned = args.scalar<int>("nElementBoundaries_owned");
-      double useRBLES = args.scalar<double>("useRBLES");
-      double useMetrics = args.scalar<double>("useMetrics");
-      double alphaBDF = args.scalar<double>("alphaBDF");
-      double epsFact_rho = args.scalar<double>("epsFact_rho");
-      double epsFact_mu = args.scalar<double>("epsFact_mu");
-      double sigma = args.scalar<double>("sigma");
-      double rho_0 = args.scalar<double>("rho_0");
-      double nu_0 = args.scalar<double>("nu_0");
-      double rho_1 = args.scalar<double>("rho_1");
-      double nu_1 = args.scalar<double>("nu_1");
-      double smagorinskyConstant = args.scalar<double>("smagorinskyConstant");
-      int turbulenceClosureModel = args.scalar<int>("turbulenceClosureModel");
-      double Ct_sge = args.scalar<double>("Ct_sge");
-      double Cd_sge = args.scalar<double>("Cd_sge");
-      double C_dc = args.scalar<double>("C_dc");
-      double C_b = args.scalar<double>("C_b");
-      const xt::pyarray<double>& eps_solid = args.array<double>("eps_solid");
-      xt::pyarray<double>& phi_solid = args.array<double>("phi_solid");
-      const xt::pyarray<double>& eps_porous = args.array<double>("eps_porous");
-      xt::pyarray<double>& phi_porous = args.array<double>("phi_porous");
-      const xt::pyarray<double>& q_velocity_porous = args.array<double>("q_velocity_porous");
-      const xt::pyarray<double>& q_porosity = args.array<double>("q_porosity");
-      const xt::pyarray<double>& q_dragAlpha = args.array<double>("q_dragAlpha");
-      const xt::pyarray<double>& q_dragBeta = args.array<double>("q_dragBeta");
-      const xt::pyarray<double>& q_mass_source = args.array<double>("q_mass_source");
-      const xt::pyarray<double>& q_turb_var_0 = args.array<double>("q_turb_var_0");
-      const xt::pyarray<double>& q_turb_var_1 = args.array<double>("q_turb_var_1");
-      const xt::pyarray<double>& q_turb_var_grad_0 = args.array<double>("q_turb_var_grad_0");
-      const double LAG_LES = args.scalar<double>("LAG_LES");
-      xt::pyarray<double> & q_eddy_viscosity = args.array<double>("q_eddy_viscosity");
-      xt::pyarray<double> & q_eddy_viscosity_last = args.array<double>("q_eddy_viscosity_last");
-      xt::pyarray<double> & ebqe_eddy_viscosity = args.array<double>("ebqe_eddy_viscosity");
-      xt::pyarray<double> & ebqe_eddy_viscosity_last = args.array<double>("ebqe_eddy_viscosity_last");
-      xt::pyarray<int>& p_l2g = args.array<int>("p_l2g");
-      xt::pyarray<int>& vel_l2g = args.array<int>("vel_l2g");
-      xt::pyarray<int>& rp_l2g = args.array<int>("rp_l2g");
-      xt::pyarray<int>& rvel_l2g = args.array<int>("rvel_l2g");
-      xt::pyarray<double>& p_dof = args.array<double>("p_dof");
-      xt::pyarray<double>& u_dof = args.array<double>("u_dof");
-      xt::pyarray<double>& v_dof = args.array<double>("v_dof");
-      xt::pyarray<double>& w_dof = args.array<double>("w_dof");
-      xt::pyarray<double>& p_old_dof = args.array<double>("p_old_dof");
-      xt::pyarray<double>& u_old_dof = args.array<double>("u_old_dof");
-      xt::pyarray<double>& v_old_dof = args.array<double>("v_old_dof");
-      xt::pyarray<double>& w_old_dof = args.array<double>("w_old_dof");
-      xt::pyarray<double>& g = args.array<double>("g");
-      const double useVF = args.scalar<double>("useVF");
-      xt::pyarray<double>& q_rho = args.array<double>("q_rho");
-      xt::pyarray<double>& vf = args.array<double>("vf");
-      xt::pyarray<double>& phi = args.array<double>("phi");
-      xt::pyarray<double>& phi_nodes = args.array<double>("phi_nodes");
-      xt::pyarray<double>& normal_phi = args.array<double>("normal_phi");
-      xt::pyarray<double>& kappa_phi = args.array<double>("kappa_phi");
-      xt::pyarray<double>& q_mom_u_acc = args.array<double>("q_mom_u_acc");
-      xt::pyarray<double>& q_mom_v_acc = args.array<double>("q_mom_v_acc");
-      xt::pyarray<double>& q_mom_w_acc = args.array<double>("q_mom_w_acc");
-      xt::pyarray<double>& q_mass_adv = args.array<double>("q_mass_adv");
-      xt::pyarray<double>& q_mom_u_acc_beta_bdf = args.array<double>("q_mom_u_acc_beta_bdf");
-      xt::pyarray<double>& q_mom_v_acc_beta_bdf = args.array<double>("q_mom_v_acc_beta_bdf");
-      xt::pyarray<double>& q_mom_w_acc_beta_bdf = args.array<double>("q_mom_w_acc_beta_bdf");
-      xt::pyarray<double>& q_dV = args.array<double>("q_dV");
-      xt::pyarray<double>& q_dV_last = args.array<double>("q_dV_last");
-      xt::pyarray<double>& q_velocity_sge = args.array<double>("q_velocity_sge");
-      xt::pyarray<double>& q_cfl = args.array<double>("q_cfl");
-      xt::pyarray<double>& q_numDiff_u = args.array<double>("q_numDiff_u");
-      xt::pyarray<double>& q_numDiff_v = args.array<double>("q_numDiff_v");
-      xt::pyarray<double>& q_numDiff_w = args.array<double>("q_numDiff_w");
-      xt::pyarray<double>& q_numDiff_u_last = args.array<double>("q_numDiff_u_last");
-      xt::pyarray<double>& q_numDiff_v_last = args.array<double>("q_numDiff_v_last");
-      xt::pyarray<double>& q_numDiff_w_last = args.array<double>("q_numDiff_w_last");
-      xt::pyarray<int>& sdInfo_u_u_rowptr = args.array<int>("sdInfo_u_u_rowptr");
-      xt::pyarray<int>& sdInfo_u_u_colind = args.array<int>("sdInfo_u_u_colind");
-      xt::pyarray<int>& sdInfo_u_v_rowptr = args.array<int>("sdInfo_u_v_rowptr");
-      xt::pyarray<int>& sdInfo_u_v_colind = args.array<int>("sdInfo_u_v_colind");
-      xt::pyarray<int>& sdInfo_u_w_rowptr = args.array<int>("sdInfo_u_w_rowptr");
-      xt::pyarray<int>& sdInfo_u_w_colind = args.array<int>("sdInfo_u_w_colind");
-      xt::pyarray<int>& sdInfo_v_v_rowptr = args.array<int>("sdInfo_v_v_rowptr");
-      xt::pyarray<int>& sdInfo_v_v_colind = args.array<int>("sdInfo_v_v_colind");
-      xt::pyarray<int>& sdInfo_v_u_rowptr = args.array<int>("sdInfo_v_u_rowptr");
-      xt::pyarray<int>& sdInfo_v_u_colind = args.array<int>("sdInfo_v_u_colind");
-      xt::pyarray<int>& sdInfo_v_w_rowptr = args.array<int>("sdInfo_v_w_rowptr");
-      xt::pyarray<int>& sdInfo_v_w_colind = args.array<int>("sdInfo_v_w_colind");
-      xt::pyarray<int>& sdInfo_w_w_rowptr = args.array<int>("sdInfo_w_w_rowptr");
-      xt::pyarray<int>& sdInfo_w_w_colind = args.array<int>("sdInfo_w_w_colind");
-      xt::pyarray<int>& sdInfo_w_u_rowptr = args.array<int>("sdInfo_w_u_rowptr");
-      xt::pyarray<int>& sdInfo_w_u_colind = args.array<int>("sdInfo_w_u_colind");
-      xt::pyarray<int>& sdInfo_w_v_rowptr = args.array<int>("sdInfo_w_v_rowptr");
-      xt::pyarray<int>& sdInfo_w_v_colind = args.array<int>("sdInfo_w_v_colind");
-      int offset_p = args.scalar<int>("offset_p");
-      int offset_u = args.scalar<int>("offset_u");
-      int offset_v = args.scalar<int>("offset_v");
-      int offset_w = args.scalar<int>("offset_w");
-      int stride_p = args.scalar<int>("stride_p");
-      int stride_u = args.scalar<int>("stride_u");
-      int stride_v = args.scalar<int>("stride_v");
-      int stride_w = args.scalar<int>("stride_w");
-      xt::pyarray<double>& globalResidual = args.array<double>("globalResidual");
-      int nExteriorElementBoundaries_global = args.scalar<int>("nExteriorElementBoundaries_global");
-      xt::pyarray<int>& exteriorElementBoundariesArray = args.array<int>("exteriorElementBoundariesArray");
-      xt::pyarray<int>& elementBoundariesArray = args.array<int>("elementBoundariesArray");
-      xt::pyarray<int>& elementBoundaryElementsArray = args.array<int>("elementBoundaryElementsArray");
-      xt::pyarray<int>& elementBoundaryLocalElementBoundariesArray = args.array<int>("elementBoundaryLocalElementBoundariesArray");
-      xt::pyarray<double>& ebqe_vf_ext = args.array<double>("ebqe_vf_ext");
-      xt::pyarray<double>& bc_ebqe_vf_ext = args.array<double>("bc_ebqe_vf_ext");
-      xt::pyarray<double>& ebqe_phi_ext = args.array<double>("ebqe_phi_ext");
-      xt::pyarray<double>& bc_ebqe_phi_ext = args.array<double>("bc_ebqe_phi_ext");
-      xt::pyarray<double>& ebqe_normal_phi_ext = args.array<double>("ebqe_normal_phi_ext");
-      xt::pyarray<double>& ebqe_kappa_phi_ext = args.array<double>("ebqe_kappa_phi_ext");
-      const xt::pyarray<double>& ebqe_porosity_ext = args.array<double>("ebqe_porosity_ext");
-      const xt::pyarray<double>& ebqe_turb_var_0 = args.array<double>("ebqe_turb_var_0");
-      const xt::pyarray<double>& ebqe_turb_var_1 = args.array<double>("ebqe_turb_var_1");
-      xt::pyarray<int>& isDOFBoundary_p = args.array<int>("isDOFBoundary_p");
-      xt::pyarray<int>& isDOFBoundary_u = args.array<int>("isDOFBoundary_u");
-      xt::pyarray<int>& isDOFBoundary_v = args.array<int>("isDOFBoundary_v");
-      xt::pyarray<int>& isDOFBoundary_w = args.array<int>("isDOFBoundary_w");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_p = args.array<int>("isAdvectiveFluxBoundary_p");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_u = args.array<int>("isAdvectiveFluxBoundary_u");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_v = args.array<int>("isAdvectiveFluxBoundary_v");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_w = args.array<int>("isAdvectiveFluxBoundary_w");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_u = args.array<int>("isDiffusiveFluxBoundary_u");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_v = args.array<int>("isDiffusiveFluxBoundary_v");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_w = args.array<int>("isDiffusiveFluxBoundary_w");
-      xt::pyarray<double>& ebqe_bc_p_ext = args.array<double>("ebqe_bc_p_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mass_ext = args.array<double>("ebqe_bc_flux_mass_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_u_adv_ext = args.array<double>("ebqe_bc_flux_mom_u_adv_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_v_adv_ext = args.array<double>("ebqe_bc_flux_mom_v_adv_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_w_adv_ext = args.array<double>("ebqe_bc_flux_mom_w_adv_ext");
-      xt::pyarray<double>& ebqe_bc_u_ext = args.array<double>("ebqe_bc_u_ext");
-      xt::pyarray<double>& ebqe_bc_flux_u_diff_ext = args.array<double>("ebqe_bc_flux_u_diff_ext");
-      xt::pyarray<double>& ebqe_penalty_ext = args.array<double>("ebqe_penalty_ext");
-      xt::pyarray<double>& ebqe_bc_v_ext = args.array<double>("ebqe_bc_v_ext");
-      xt::pyarray<double>& ebqe_bc_flux_v_diff_ext = args.array<double>("ebqe_bc_flux_v_diff_ext");
-      xt::pyarray<double>& ebqe_bc_w_ext = args.array<double>("ebqe_bc_w_ext");
-      xt::pyarray<double>& ebqe_bc_flux_w_diff_ext = args.array<double>("ebqe_bc_flux_w_diff_ext");
-      xt::pyarray<double>& q_x = args.array<double>("q_x");
-      xt::pyarray<double>& q_u_0 = args.array<double>("q_u_0");
-      xt::pyarray<double>& q_u_1 = args.array<double>("q_u_1");
-      xt::pyarray<double>& q_u_2 = args.array<double>("q_u_2");
-      xt::pyarray<double>& q_u_3 = args.array<double>("q_u_3");
-      xt::pyarray<double>& q_velocity = args.array<double>("q_velocity");
-      xt::pyarray<double>& ebqe_velocity = args.array<double>("ebqe_velocity");
-      xt::pyarray<double>& flux = args.array<double>("flux");
-      xt::pyarray<double>& elementResidual_p_save = args.array<double>("elementResidual_p_save");
-      xt::pyarray<int>& elementFlags = args.array<int>("elementFlags");
-      xt::pyarray<int>& boundaryFlags = args.array<int>("boundaryFlags");
-      xt::pyarray<double>& barycenters = args.array<double>("barycenters");
-      xt::pyarray<double>& wettedAreas = args.array<double>("wettedAreas");
-      xt::pyarray<double>& netForces_p = args.array<double>("netForces_p");
-      xt::pyarray<double>& netForces_v = args.array<double>("netForces_v");
-      xt::pyarray<double>& netMoments = args.array<double>("netMoments");
-      xt::pyarray<double>& velocityError = args.array<double>("velocityError");
-      xt::pyarray<double>& velocityErrorNodal = args.array<double>("velocityErrorNodal");
-      xt::pyarray<double>& forcex = args.array<double>("forcex");
-      xt::pyarray<double>& forcey = args.array<double>("forcey");
-      xt::pyarray<double>& forcez = args.array<double>("forcez");
-      int     use_ball_as_particle = args.scalar<int>("use_ball_as_particle");
-      xt::pyarray<double>& ball_center = args.array<double>("ball_center");
-      xt::pyarray<double>& ball_radius = args.array<double>("ball_radius");
-      xt::pyarray<double>& ball_velocity = args.array<double>("ball_velocity");
-      xt::pyarray<double>& ball_angular_velocity = args.array<double>("ball_angular_velocity");
-      xt::pyarray<double>& ball_density = args.array<double>("ball_density");
-      xt::pyarray<double>& particle_signed_distances = args.array<double>("particle_signed_distances");
-      xt::pyarray<double>& particle_signed_distance_normals = args.array<double>("particle_signed_distance_normals");
-      xt::pyarray<double>& particle_velocities = args.array<double>("particle_velocities");
-      xt::pyarray<double>& particle_centroids = args.array<double>("particle_centroids");
-      xt::pyarray<double>& ebqe_phi_s = args.array<double>("ebqe_phi_s");
-      xt::pyarray<double>& ebq_global_grad_phi_s = args.array<double>("ebq_global_grad_phi_s");
-      xt::pyarray<double>& ebq_particle_velocity_s = args.array<double>("ebq_particle_velocity_s");
-      int nParticles = args.scalar<int>("nParticles");
-      xt::pyarray<double>& particle_netForces = args.array<double>("particle_netForces");
-      xt::pyarray<double>& particle_netMoments = args.array<double>("particle_netMoments");
-      xt::pyarray<double>& particle_surfaceArea = args.array<double>("particle_surfaceArea");
-      xt::pyarray<double>& particle_surfaceArea_projected = args.array<double>("particle_surfaceArea_projected");
-      xt::pyarray<double>& projection_direction = args.array<double>("projection_direction");
-      xt::pyarray<double>& particle_volume = args.array<double>("particle_volume");
-      int nElements_owned = args.scalar<int>("nElements_owned");
-      double particle_nitsche = args.scalar<double>("particle_nitsche");
-      double particle_epsFact = args.scalar<double>("particle_epsFact");
-      double particle_alpha = args.scalar<double>("particle_alpha");
-      double particle_beta = args.scalar<double>("particle_beta");
-      double particle_penalty_constant = args.scalar<double>("particle_penalty_constant");
-      double ghost_penalty_constant = args.scalar<double>("ghost_penalty_constant");
-      xt::pyarray<double>& phi_solid_nodes = args.array<double>("phi_solid_nodes");
-      xt::pyarray<double>& distance_to_solids = args.array<double>("distance_to_solids");
-      bool useExact = args.scalar<int>("useExact");
-      xt::pyarray<double>& isActiveR = args.array<double>("isActiveR");
-      xt::pyarray<double>& isActiveDOF_p = args.array<double>("isActiveDOF_p");
-      xt::pyarray<double>& isActiveDOF_vel = args.array<double>("isActiveDOF_vel");
-      const bool normalize_pressure = args.scalar<int>("normalize_pressure");
-      xt::pyarray<double>& errors = args.array<double>("errors");
-      xt::pyarray<double>& ball_u = args.array<double>("ball_u");
-      xt::pyarray<double>& ball_v = args.array<double>("ball_v");
-      xt::pyarray<double>& ball_w = args.array<double>("ball_w");
-      xt::pyarray<int>& isActiveElement = args.array<int>("isActiveElement");
-      xt::pyarray<int>& isActiveElement_last = args.array<int>("isActiveElement_last");
+      PROTEUS_ARGUMENT_LOCALS(RANS2P_RESIDUAL_ARGUMENTS, residualArguments(args));
+      ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
+      if (use_ball_as_particle == 1 && nParticles > 0)
+        ballGrid.build(nParticles, ball_center.data(), ball_radius.data());
       logEvent("Entered mprans calculateResidual",6);
       gf.useExact = false;//useExact;
       gf_p.useExact = false;//useExact;
@@ -2419,8 +2698,36 @@ namespace proteus
       /*          <<"Ball Info: radius "<<ball_radius[0]<<std::endl */
       /*          <<"Ball Info: velocity "<<ball_velocity[0]<<'\t'<<ball_velocity[1]<<'\t'<<ball_velocity[2]<<std::endl */
       /*          <<"Ball Info: angular "<<ball_angular_velocity[0]<<ball_angular_velocity[1]<<ball_angular_velocity[2]<<std::endl; */
-      for(int eN=0;eN<nElements_global;eN++)
+      setElementColoring(nElements_global, elementColorOffsets, elementColorsArray);
+      double *particle_netForces_ptr = particle_netForces.data(),
+        *particle_netMoments_ptr = particle_netMoments.data(),
+        *particle_surfaceArea_ptr = particle_surfaceArea.data(),
+        *particle_surfaceArea_projected_ptr = particle_surfaceArea_projected.data(),
+        *particle_volume_ptr = particle_volume.data();
+      const int nParticle_netForces = particle_netForces.size(),
+        nParticle_netMoments = particle_netMoments.size(),
+        nParticle_surfaceArea = particle_surfaceArea.size(),
+        nParticle_surfaceArea_projected = particle_surfaceArea_projected.size(),
+        nParticle_volume = particle_volume.size();
+      for (int color=0;color<elementColoring.nColors();color++)
+      {
+#pragma omp parallel reduction(+:p_dv,pa_dv,total_volume,total_surface_area,mesh_volume_conservation,mesh_volume_conservation_weak,domain_volume, \
+                               p_L1,u_L1,v_L1,w_L1,velocity_L1,p_L2,u_L2,v_L2,w_L2,velocity_L2,   \
+                               particle_netForces_ptr[:nParticle_netForces],particle_netMoments_ptr[:nParticle_netMoments], \
+                               particle_surfaceArea_ptr[:nParticle_surfaceArea],particle_surfaceArea_projected_ptr[:nParticle_surfaceArea_projected], \
+                               particle_volume_ptr[:nParticle_volume])            \
+  reduction(max:mesh_volume_conservation_err_max,mesh_volume_conservation_err_max_weak,p_LI,u_LI,v_LI,w_LI,velocity_LI)
+      {
+#ifdef _OPENMP
+      //the cut-cell integrators hold per-element state, so each thread works on its own copy
+      auto gf(this->gf);
+      auto gf_p(this->gf_p);
+      auto gf_s(this->gf_s);
+#endif
+#pragma omp for schedule(static)
+      for(int eN_color=elementColoring.colorBegin(color);eN_color<elementColoring.colorEnd(color);eN_color++)
         {
+          const int eN = elementColoring.element(eN_color);
           //declare local storage for element residual and initialize
           double elementResidual_p[nDOF_test_element],elementResidual_p_check[nDOF_test_element],elementResidual_mesh[nDOF_test_element],
             elementResidual_u[nDOF_v_test_element],
@@ -2460,7 +2767,7 @@ namespace proteus
 	      double min_d = 1e10;
               for (int I=0;I<nDOF_mesh_trial_element;I++)
                 {
-		  int index = get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),
+		  int index = ballGrid.nearest(
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+0],
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+1],
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+2],
@@ -2503,9 +2810,12 @@ namespace proteus
                   //if (elementBoundaryElementsArray.data()[ebN*2+1] != -1 && (ebN < nElementBoundaries_owned) && element_phi_s[(ebN_element+1)%nDOF_mesh_trial_element]*element_phi_s[(ebN_element+2)%nDOF_mesh_trial_element] < 0.0)
                   if (elementBoundaryElementsArray[ebN*2+1] != -1 && element_phi_s[(ebN_element+1)%nDOF_mesh_trial_element]*element_phi_s[(ebN_element+2)%nDOF_mesh_trial_element] <= 0.0)
 		    {
+#pragma omp critical(rans2p_cut_boundaries)
+		      {
 		      cutfem_boundaries.insert(ebN);
 		      if (elementBoundaryElementsArray[ebN*2 + 0] == eN)
 			cutfem_local_boundaries[ebN] = ebN_element;
+		      }
 		    }
                 }
             }
@@ -2529,6 +2839,7 @@ namespace proteus
                   const int ebN = elementBoundariesArray.data()[eN*nDOF_mesh_trial_element+ebN_element];
                   //if (elementBoundaryElementsArray.data()[ebN*2+1] != -1 && (ebN < nElementBoundaries_owned))
 		  //  ifem_boundaries.insert(ebN);
+#pragma omp critical(rans2p_cut_boundaries)
                   ifem_boundaries.insert(ebN);
                 }
             }
@@ -2945,7 +3256,7 @@ namespace proteus
                   double ball_n[nSpace];
                   if (use_ball_as_particle == 1 && nParticles > 0)
                     {
-                      int ball_index=get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),x,y,z,distance_to_solids.data()[eN_k]);
+                      int ball_index=ballGrid.nearest(x,y,z,distance_to_solids.data()[eN_k]);
                       get_normal_to_ith_ball(nParticles, ball_center.data(), ball_radius.data(),ball_index,x,y,z,ball_n[0],ball_n[1],ball_n[2]);
                     }
                   else
@@ -3529,12 +3840,12 @@ namespace proteus
                                                dmass_ham_u_s,
                                                dmass_ham_v_s,
                                                dmass_ham_w_s,
-                                               particle_netForces.data(),
-                                               particle_netMoments.data(),
-                                               particle_surfaceArea.data(),
-					       particle_surfaceArea_projected.data(),
+                                               particle_netForces_ptr,
+                                               particle_netMoments_ptr,
+                                               particle_surfaceArea_ptr,
+					       particle_surfaceArea_projected_ptr,
 					       projection_direction.data(),
-					       particle_volume.data());
+					       particle_volume_ptr);
                     }
                   //
                   //save momentum for time history and velocity for subgrid error
@@ -3781,6 +4092,8 @@ namespace proteus
           mesh_volume_conservation_err_max=fmax(mesh_volume_conservation_err_max,fabs(mesh_volume_conservation_element));
           mesh_volume_conservation_err_max_weak=fmax(mesh_volume_conservation_err_max_weak,fabs(mesh_volume_conservation_element_weak));
         }//elements
+      }//parallel
+      }//colors
       std::set<int>::iterator it=cutfem_boundaries.begin();
       while(it!=cutfem_boundaries.end())
         {
@@ -4258,7 +4571,7 @@ namespace proteus
               double eddy_viscosity_ext(0.),bc_eddy_viscosity_ext(0.); //not interested in saving boundary eddy viscosity for now
               if (use_ball_as_particle == 1 && nParticles > 0)
                 {
-                  get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),x_ext,y_ext,z_ext,ebqe_phi_s.data()[ebNE_kb]);
+                  ballGrid.nearest(x_ext,y_ext,z_ext,ebqe_phi_s.data()[ebNE_kb]);
                 }
               //else ebqe_phi_s.data()[ebNE_kb] is computed in Prestep
               const double particle_eps  = particle_epsFact*(useMetrics*h_phi+(1.0-useMetrics)*elementDiameter[eN]);
@@ -5081,247 +5394,48 @@ namespace proteus
 
     void calculateJacobian(arguments_dict& args)
     {
-      double NONCONSERVATIVE_FORM = args.scalar<double>("NONCONSERVATIVE_FORM");
-      double MOMENTUM_SGE = args.scalar<double>("MOMENTUM_SGE");
-      double PRESSURE_SGE = args.scalar<double>("PRESSURE_SGE");
-      double VELOCITY_SGE = args.scalar<double>("VELOCITY_SGE");
-      double PRESSURE_PROJECTION_STABILIZATION = args.scalar<double>("PRESSURE_PROJECTION_STABILIZATION");
-      xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
-      xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
-      xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
-      xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
-      double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
-      xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
-      xt::pyarray<double>& x_ref = args.array<double>("x_ref");
-      xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
-      xt::pyarray<double>& p_trial_ref = args.array<double>("p_trial_ref");
-      xt::pyarray<double>& p_grad_trial_ref = args.array<double>("p_grad_trial_ref");
-      xt::pyarray<double>& p_test_ref = args.array<double>("p_test_ref");
-      xt::pyarray<double>& p_grad_test_ref = args.array<double>("p_grad_test_ref");
-      xt::pyarray<double>& vel_trial_ref = args.array<double>("vel_trial_ref");
-      xt::pyarray<double>& vel_grad_trial_ref = args.array<double>("vel_grad_trial_ref");
-      xt::pyarray<double>& vel_test_ref = args.array<double>("vel_test_ref");
-      xt::pyarray<double>& vel_grad_test_ref = args.array<double>("vel_grad_test_ref");
-      xt::pyarray<double>& mesh_trial_trace_ref = args.array<double>("mesh_trial_trace_ref");
-      xt::pyarray<double>& mesh_grad_trial_trace_ref = args.array<double>("mesh_grad_trial_trace_ref");
-      xt::pyarray<double>& xb_ref = args.array<double>("xb_ref");
-      xt::pyarray<double>& dS_ref = args.array<double>("dS_ref");
-      xt::pyarray<double>& p_trial_trace_ref = args.array<double>("p_trial_trace_ref");
-      xt::pyarray<double>& p_grad_trial_trace_ref = args.array<double>("p_grad_trial_trace_ref");
-      xt::pyarray<double>& p_test_trace_ref = args.array<double>("p_test_trace_ref");
-      xt::pyarray<double>& p_grad_test_trace_ref = args.array<double>("p_grad_test_trace_ref");
-      xt::pyarray<double>& vel_trial_trace_ref = args.array<double>("vel_trial_trace_ref");
-      xt::pyarray<double>& vel_grad_trial_trace_ref = args.array<double>("vel_grad_trial_trace_ref");
-      xt::pyarray<double>& vel_test_trace_ref = args.array<double>("vel_test_trace_ref");
-      xt::pyarray<double>& vel_grad_test_trace_ref = args.array<double>("vel_grad_test_trace_ref");
-      xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
-      xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
-      double eb_adjoint_sigma = args.scalar<double>("eb_adjoint_sigma");
-      xt::pyarray<double>& elementDiameter = args.array<double>("elementDiameter");
-      xt::pyarray<double>& elementBoundaryDiameter = args.array<double>("elementBoundaryDiameter");
-      xt::pyarray<double>& nodeDiametersArray = args.array<double>("nodeDiametersArray");
-      double hFactor = args.scalar<double>("hFactor");
-      int nElements_global = args.scalar<int>("nElements_global");
-      double useRBLES = args.scalar<double>("useRBLES");
-      double useMetrics = args.scalar<double>("useMetrics");
-      double alphaBDF = args.scalar<double>("alphaBDF");
-      double epsFact_rho = args.scalar<double>("epsFact_rho");
-      double epsFact_mu = args.scalar<double>("epsFact_mu");
-      double sigma = args.scalar<double>("sigma");
-      double rho_0 = args.scalar<double>("rho_0");
-      double nu_0 = args.scalar<double>("nu_0");
-      double rho_1 = args.scalar<double>("rho_1");
-      double nu_1 = args.scalar<double>("nu_1");
-      double smagorinskyConstant = args.scalar<double>("smagorinskyConstant");
-      int turbulenceClosureModel = args.scalar<int>("turbulenceClosureModel");
-      double Ct_sge = args.scalar<double>("Ct_sge");
-      double Cd_sge = args.scalar<double>("Cd_sge");
-      double C_dg = args.scalar<double>("C_dg");
-      double C_b = args.scalar<double>("C_b");
-      const xt::pyarray<double>& eps_solid = args.array<double>("eps_solid");
-      const xt::pyarray<double>& phi_solid = args.array<double>("phi_solid");
-      const xt::pyarray<double>& eps_porous = args.array<double>("eps_porous");
-      const xt::pyarray<double>& phi_porous = args.array<double>("phi_porous");
-      const xt::pyarray<double>& q_velocity_porous = args.array<double>("q_velocity_porous");
-      const xt::pyarray<double>& q_porosity = args.array<double>("q_porosity");
-      const xt::pyarray<double>& q_dragAlpha = args.array<double>("q_dragAlpha");
-      const xt::pyarray<double>& q_dragBeta = args.array<double>("q_dragBeta");
-      const xt::pyarray<double>& q_mass_source = args.array<double>("q_mass_source");
-      const xt::pyarray<double>& q_turb_var_0 = args.array<double>("q_turb_var_0");
-      const xt::pyarray<double>& q_turb_var_1 = args.array<double>("q_turb_var_1");
-      const xt::pyarray<double>& q_turb_var_grad_0 = args.array<double>("q_turb_var_grad_0");
-      const double LAG_LES = args.scalar<double>("LAG_LES");
-      xt::pyarray<double> & q_eddy_viscosity_last = args.array<double>("q_eddy_viscosity_last");
-      xt::pyarray<double> & ebqe_eddy_viscosity_last = args.array<double>("ebqe_eddy_viscosity_last");
-      xt::pyarray<int>& p_l2g = args.array<int>("p_l2g");
-      xt::pyarray<int>& vel_l2g = args.array<int>("vel_l2g");
-      xt::pyarray<double>& p_dof = args.array<double>("p_dof");
-      xt::pyarray<double>& u_dof = args.array<double>("u_dof");
-      xt::pyarray<double>& v_dof = args.array<double>("v_dof");
-      xt::pyarray<double>& w_dof = args.array<double>("w_dof");
-      xt::pyarray<double>& p_old_dof = args.array<double>("p_old_dof");
-      xt::pyarray<double>& u_old_dof = args.array<double>("u_old_dof");
-      xt::pyarray<double>& v_old_dof = args.array<double>("v_old_dof");
-      xt::pyarray<double>& w_old_dof = args.array<double>("w_old_dof");
-      xt::pyarray<double>& g = args.array<double>("g");
-      const double useVF = args.scalar<double>("useVF");
-      xt::pyarray<double>& vf = args.array<double>("vf");
-      xt::pyarray<double>& phi = args.array<double>("phi");
-      xt::pyarray<double>& phi_nodes = args.array<double>("phi_nodes");
-      xt::pyarray<double>& normal_phi = args.array<double>("normal_phi");
-      xt::pyarray<double>& kappa_phi = args.array<double>("kappa_phi");
-      xt::pyarray<double>& q_mom_u_acc_beta_bdf = args.array<double>("q_mom_u_acc_beta_bdf");
-      xt::pyarray<double>& q_mom_v_acc_beta_bdf = args.array<double>("q_mom_v_acc_beta_bdf");
-      xt::pyarray<double>& q_mom_w_acc_beta_bdf = args.array<double>("q_mom_w_acc_beta_bdf");
-      xt::pyarray<double>& q_dV = args.array<double>("q_dV");
-      xt::pyarray<double>& q_dV_last = args.array<double>("q_dV_last");
-      xt::pyarray<double>& q_velocity_sge = args.array<double>("q_velocity_sge");
-      xt::pyarray<double>& q_cfl = args.array<double>("q_cfl");
-      xt::pyarray<double>& q_numDiff_u_last = args.array<double>("q_numDiff_u_last");
-      xt::pyarray<double>& q_numDiff_v_last = args.array<double>("q_numDiff_v_last");
-      xt::pyarray<double>& q_numDiff_w_last = args.array<double>("q_numDiff_w_last");
-      xt::pyarray<int>& sdInfo_u_u_rowptr = args.array<int>("sdInfo_u_u_rowptr");
-      xt::pyarray<int>& sdInfo_u_u_colind = args.array<int>("sdInfo_u_u_colind");
-      xt::pyarray<int>& sdInfo_u_v_rowptr = args.array<int>("sdInfo_u_v_rowptr");
-      xt::pyarray<int>& sdInfo_u_v_colind = args.array<int>("sdInfo_u_v_colind");
-      xt::pyarray<int>& sdInfo_u_w_rowptr = args.array<int>("sdInfo_u_w_rowptr");
-      xt::pyarray<int>& sdInfo_u_w_colind = args.array<int>("sdInfo_u_w_colind");
-      xt::pyarray<int>& sdInfo_v_v_rowptr = args.array<int>("sdInfo_v_v_rowptr");
-      xt::pyarray<int>& sdInfo_v_v_colind = args.array<int>("sdInfo_v_v_colind");
-      xt::pyarray<int>& sdInfo_v_u_rowptr = args.array<int>("sdInfo_v_u_rowptr");
-      xt::pyarray<int>& sdInfo_v_u_colind = args.array<int>("sdInfo_v_u_colind");
-      xt::pyarray<int>& sdInfo_v_w_rowptr = args.array<int>("sdInfo_v_w_rowptr");
-      xt::pyarray<int>& sdInfo_v_w_colind = args.array<int>("sdInfo_v_w_colind");
-      xt::pyarray<int>& sdInfo_w_w_rowptr = args.array<int>("sdInfo_w_w_rowptr");
-      xt::pyarray<int>& sdInfo_w_w_colind = args.array<int>("sdInfo_w_w_colind");
-      xt::pyarray<int>& sdInfo_w_u_rowptr = args.array<int>("sdInfo_w_u_rowptr");
-      xt::pyarray<int>& sdInfo_w_u_colind = args.array<int>("sdInfo_w_u_colind");
-      xt::pyarray<int>& sdInfo_w_v_rowptr = args.array<int>("sdInfo_w_v_rowptr");
-      xt::pyarray<int>& sdInfo_w_v_colind = args.array<int>("sdInfo_w_v_colind");
-      xt::pyarray<int>& csrRowIndeces_p_p = args.array<int>("csrRowIndeces_p_p");
-      xt::pyarray<int>& csrColumnOffsets_p_p = args.array<int>("csrColumnOffsets_p_p");
-      xt::pyarray<int>& csrRowIndeces_p_u = args.array<int>("csrRowIndeces_p_u");
-      xt::pyarray<int>& csrColumnOffsets_p_u = args.array<int>("csrColumnOffsets_p_u");
-      xt::pyarray<int>& csrRowIndeces_p_v = args.array<int>("csrRowIndeces_p_v");
-      xt::pyarray<int>& csrColumnOffsets_p_v = args.array<int>("csrColumnOffsets_p_v");
-      xt::pyarray<int>& csrRowIndeces_p_w = args.array<int>("csrRowIndeces_p_w");
-      xt::pyarray<int>& csrColumnOffsets_p_w = args.array<int>("csrColumnOffsets_p_w");
-      xt::pyarray<int>& csrRowIndeces_u_p = args.array<int>("csrRowIndeces_u_p");
-      xt::pyarray<int>& csrColumnOffsets_u_p = args.array<int>("csrColumnOffsets_u_p");
-      xt::pyarray<int>& csrRowIndeces_u_u = args.array<int>("csrRowIndeces_u_u");
-      xt::pyarray<int>& csrColumnOffsets_u_u = args.array<int>("csrColumnOffsets_u_u");
-      xt::pyarray<int>& csrRowIndeces_u_v = args.array<int>("csrRowIndeces_u_v");
-      xt::pyarray<int>& csrColumnOffsets_u_v = args.array<int>("csrColumnOffsets_u_v");
-      xt::pyarray<int>& csrRowIndeces_u_w = args.array<int>("csrRowIndeces_u_w");
-      xt::pyarray<int>& csrColumnOffsets_u_w = args.array<int>("csrColumnOffsets_u_w");
-      xt::pyarray<int>& csrRowIndeces_v_p = args.array<int>("csrRowIndeces_v_p");
-      xt::pyarray<int>& csrColumnOffsets_v_p = args.array<int>("csrColumnOffsets_v_p");
-      xt::pyarray<int>& csrRowIndeces_v_u = args.array<int>("csrRowIndeces_v_u");
-      xt::pyarray<int>& csrColumnOffsets_v_u = args.array<int>("csrColumnOffsets_v_u");
-      xt::pyarray<int>& csrRowIndeces_v_v = args.array<int>("csrRowIndeces_v_v");
-      xt::pyarray<int>& csrColumnOffsets_v_v = args.array<int>("csrColumnOffsets_v_v");
-      xt::pyarray<int>& csrRowIndeces_v_w = args.array<int>("csrRowIndeces_v_w");
-      xt::pyarray<int>& csrColumnOffsets_v_w = args.array<int>("csrColumnOffsets_v_w");
-      xt::pyarray<int>& csrRowIndeces_w_p = args.array<int>("csrRowIndeces_w_p");
-      xt::pyarray<int>& csrColumnOffsets_w_p = args.array<int>("csrColumnOffsets_w_p");
-      xt::pyarray<int>& csrRowIndeces_w_u = args.array<int>("csrRowIndeces_w_u");
-      xt::pyarray<int>& csrColumnOffsets_w_u = args.array<int>("csrColumnOffsets_w_u");
-      xt::pyarray<int>& csrRowIndeces_w_v = args.array<int>("csrRowIndeces_w_v");
-      xt::pyarray<int>& csrColumnOffsets_w_v = args.array<int>("csrColumnOffsets_w_v");
-      xt::pyarray<int>& csrRowIndeces_w_w = args.array<int>("csrRowIndeces_w_w");
-      xt::pyarray<int>& csrColumnOffsets_w_w = args.array<int>("csrColumnOffsets_w_w");
-      xt::pyarray<double>& globalJacobian = args.array<double>("globalJacobian");
-      int nExteriorElementBoundaries_global = args.scalar<int>("nExteriorElementBoundaries_global");
-      xt::pyarray<int>& exteriorElementBoundariesArray = args.array<int>("exteriorElementBoundariesArray");
-      xt::pyarray<int>& elementBoundaryElementsArray = args.array<int>("elementBoundaryElementsArray");
-      xt::pyarray<int>& elementBoundaryLocalElementBoundariesArray = args.array<int>("elementBoundaryLocalElementBoundariesArray");
-      xt::pyarray<double>& ebqe_vf_ext = args.array<double>("ebqe_vf_ext");
-      xt::pyarray<double>& bc_ebqe_vf_ext = args.array<double>("bc_ebqe_vf_ext");
-      xt::pyarray<double>& ebqe_phi_ext = args.array<double>("ebqe_phi_ext");
-      xt::pyarray<double>& bc_ebqe_phi_ext = args.array<double>("bc_ebqe_phi_ext");
-      xt::pyarray<double>& ebqe_normal_phi_ext = args.array<double>("ebqe_normal_phi_ext");
-      xt::pyarray<double>& ebqe_kappa_phi_ext = args.array<double>("ebqe_kappa_phi_ext");
-      const xt::pyarray<double>& ebqe_porosity_ext = args.array<double>("ebqe_porosity_ext");
-      const xt::pyarray<double>& ebqe_turb_var_0 = args.array<double>("ebqe_turb_var_0");
-      const xt::pyarray<double>& ebqe_turb_var_1 = args.array<double>("ebqe_turb_var_1");
-      xt::pyarray<int>& isDOFBoundary_p = args.array<int>("isDOFBoundary_p");
-      xt::pyarray<int>& isDOFBoundary_u = args.array<int>("isDOFBoundary_u");
-      xt::pyarray<int>& isDOFBoundary_v = args.array<int>("isDOFBoundary_v");
-      xt::pyarray<int>& isDOFBoundary_w = args.array<int>("isDOFBoundary_w");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_p = args.array<int>("isAdvectiveFluxBoundary_p");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_u = args.array<int>("isAdvectiveFluxBoundary_u");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_v = args.array<int>("isAdvectiveFluxBoundary_v");
-      xt::pyarray<int>& isAdvectiveFluxBoundary_w = args.array<int>("isAdvectiveFluxBoundary_w");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_u = args.array<int>("isDiffusiveFluxBoundary_u");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_v = args.array<int>("isDiffusiveFluxBoundary_v");
-      xt::pyarray<int>& isDiffusiveFluxBoundary_w = args.array<int>("isDiffusiveFluxBoundary_w");
-      xt::pyarray<double>& ebqe_bc_p_ext = args.array<double>("ebqe_bc_p_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mass_ext = args.array<double>("ebqe_bc_flux_mass_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_u_adv_ext = args.array<double>("ebqe_bc_flux_mom_u_adv_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_v_adv_ext = args.array<double>("ebqe_bc_flux_mom_v_adv_ext");
-      xt::pyarray<double>& ebqe_bc_flux_mom_w_adv_ext = args.array<double>("ebqe_bc_flux_mom_w_adv_ext");
-      xt::pyarray<double>& ebqe_bc_u_ext = args.array<double>("ebqe_bc_u_ext");
-      xt::pyarray<double>& ebqe_bc_flux_u_diff_ext = args.array<double>("ebqe_bc_flux_u_diff_ext");
-      xt::pyarray<double>& ebqe_penalty_ext = args.array<double>("ebqe_penalty_ext");
-      xt::pyarray<double>& ebqe_bc_v_ext = args.array<double>("ebqe_bc_v_ext");
-      xt::pyarray<double>& ebqe_bc_flux_v_diff_ext = args.array<double>("ebqe_bc_flux_v_diff_ext");
-      xt::pyarray<double>& ebqe_bc_w_ext = args.array<double>("ebqe_bc_w_ext");
-      xt::pyarray<double>& ebqe_bc_flux_w_diff_ext = args.array<double>("ebqe_bc_flux_w_diff_ext");
-      xt::pyarray<int>& csrColumnOffsets_eb_p_p = args.array<int>("csrColumnOffsets_eb_p_p");
-      xt::pyarray<int>& csrColumnOffsets_eb_p_u = args.array<int>("csrColumnOffsets_eb_p_u");
-      xt::pyarray<int>& csrColumnOffsets_eb_p_v = args.array<int>("csrColumnOffsets_eb_p_v");
-      xt::pyarray<int>& csrColumnOffsets_eb_p_w = args.array<int>("csrColumnOffsets_eb_p_w");
-      xt::pyarray<int>& csrColumnOffsets_eb_u_p = args.array<int>("csrColumnOffsets_eb_u_p");
-      xt::pyarray<int>& csrColumnOffsets_eb_u_u = args.array<int>("csrColumnOffsets_eb_u_u");
-      xt::pyarray<int>& csrColumnOffsets_eb_u_v = args.array<int>("csrColumnOffsets_eb_u_v");
-      xt::pyarray<int>& csrColumnOffsets_eb_u_w = args.array<int>("csrColumnOffsets_eb_u_w");
-      xt::pyarray<int>& csrColumnOffsets_eb_v_p = args.array<int>("csrColumnOffsets_eb_v_p");
-      xt::pyarray<int>& csrColumnOffsets_eb_v_u = args.array<int>("csrColumnOffsets_eb_v_u");
-      xt::pyarray<int>& csrColumnOffsets_eb_v_v = args.array<int>("csrColumnOffsets_eb_v_v");
-      xt::pyarray<int>& csrColumnOffsets_eb_v_w = args.array<int>("csrColumnOffsets_eb_v_w");
-      xt::pyarray<int>& csrColumnOffsets_eb_w_p = args.array<int>("csrColumnOffsets_eb_w_p");
-      xt::pyarray<int>& csrColumnOffsets_eb_w_u = args.array<int>("csrColumnOffsets_eb_w_u");
-      xt::pyarray<int>& csrColumnOffsets_eb_w_v = args.array<int>("csrColumnOffsets_eb_w_v");
-      xt::pyarray<int>& csrColumnOffsets_eb_w_w = args.array<int>("csrColumnOffsets_eb_w_w");
-      xt::pyarray<int>& elementFlags = args.array<int>("elementFlags");
-      xt::pyarray<int>& boundaryFlags = args.array<int>("boundaryFlags");
-      int use_ball_as_particle = args.scalar<int>("use_ball_as_particle");
-      xt::pyarray<double>& ball_center = args.array<double>("ball_center");
-      xt::pyarray<double>& ball_radius = args.array<double>("ball_radius");
-      xt::pyarray<double>& ball_velocity = args.array<double>("ball_velocity");
-      xt::pyarray<double>& ball_angular_velocity = args.array<double>("ball_angular_velocity");
-      xt::pyarray<double>& ball_density = args.array<double>("ball_density");
-      xt::pyarray<double>& particle_signed_distances = args.array<double>("particle_signed_distances");
-      xt::pyarray<double>& particle_signed_distance_normals = args.array<double>("particle_signed_distance_normals");
-      xt::pyarray<double>& particle_velocities = args.array<double>("particle_velocities");
-      xt::pyarray<double>& particle_centroids = args.array<double>("particle_centroids");
-      xt::pyarray<double>& ebqe_phi_s = args.array<double>("ebqe_phi_s");
-      xt::pyarray<double>& ebq_global_grad_phi_s = args.array<double>("ebq_global_grad_phi_s");
-      xt::pyarray<double>& ebq_particle_velocity_s = args.array<double>("ebq_particle_velocity_s");
-      xt::pyarray<double>& phi_solid_nodes = args.array<double>("phi_solid_nodes");
-      xt::pyarray<double>& distance_to_solids = args.array<double>("distance_to_solids");
-      xt::pyarray<int>& isActiveElement = args.array<int>("isActiveElement");
-      xt::pyarray<int>& isActiveElement_last = args.array<int>("isActiveElement_last");
-      int nParticles = args.scalar<int>("nParticles");
-      int nElements_owned = args.scalar<int>("nElements_owned");
-      double particle_nitsche = args.scalar<double>("particle_nitsche");
-      double particle_epsFact = args.scalar<double>("particle_epsFact");
-      double particle_alpha = args.scalar<double>("particle_alpha");
-      double particle_beta = args.scalar<double>("particle_beta");
-      double particle_penalty_constant = args.scalar<double>("particle_penalty_constant");
-      double ghost_penalty_constant = args.scalar<double>("ghost_penalty_constant");
-      const bool useExact = args.scalar<int>("useExact");
+      jacobianScatter.assemble(args.array<double>("globalJacobian").data());
+      assembleJacobian(args);
+    }
+
+    void applyJacobian(arguments_dict& args, xt::pyarray<double>& x, xt::pyarray<double>& y)
+    {
+      jacobianScatter.apply(y.size(), x.data(), y.data());
+      assembleJacobian(args);
+    }
+
+    /// the Jacobian element by element, added through jacobianScatter
+    void assembleJacobian(arguments_dict& args)
+    {
+      PROTEUS_ARGUMENT_LOCALS(RANS2P_JACOBIAN_ARGUMENTS, jacobianArguments(args));
+      //blockDiagonalVelocityJacobian is 1 to skip the velocity-velocity coupling blocks, which are then left out of the sparsity pattern (an approximate Jacobian)
+      ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
+      if (use_ball_as_particle == 1 && nParticles > 0)
+        ballGrid.build(nParticles, ball_center.data(), ball_radius.data());
       const int nQuadraturePoints_global(nElements_global*nQuadraturePoints_element);
-      std::valarray<double> particle_surfaceArea_tmp(nParticles), particle_surfaceArea_projected_tmp(nParticles), projection_direction_tmp(3),
-	particle_netForces_tmp(nParticles*3*3), particle_netMoments_tmp(nParticles*3), particle_volume_tmp(nParticles);
       gf.useExact = false;//useExact;
       gf_p.useExact = false;//useExact;
       gf_s.useExact = useExact;
+      setElementColoring(nElements_global, elementColorOffsets, elementColorsArray);
       //
       //loop over elements to compute volume integrals and load them into the element Jacobians and global Jacobian
       //
-      for(int eN=0;eN<nElements_global;eN++)
+      for (int color=0;color<elementColoring.nColors();color++)
+      {
+#pragma omp parallel
+      {
+#ifdef _OPENMP
+      //the cut-cell integrators hold per-element state, so each thread works on its own copy
+      auto gf(this->gf);
+      auto gf_p(this->gf_p);
+      auto gf_s(this->gf_s);
+#endif
+      std::valarray<double> particle_surfaceArea_tmp(nParticles), particle_surfaceArea_projected_tmp(nParticles), projection_direction_tmp(3),
+	particle_netForces_tmp(nParticles*3*3), particle_netMoments_tmp(nParticles*3), particle_volume_tmp(nParticles);
+#pragma omp for schedule(static)
+      for(int eN_color=elementColoring.colorBegin(color);eN_color<elementColoring.colorEnd(color);eN_color++)
         {
+          const int eN = elementColoring.element(eN_color);
 	  int particle_index=0;
           double eps_rho,eps_mu;
 
@@ -5375,7 +5489,7 @@ namespace proteus
 	      particle_index=0;
               for (int I=0;I<nDOF_mesh_trial_element;I++)
                 {
-		  int index = get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),
+		  int index = ballGrid.nearest(
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+0],
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+1],
 						   mesh_dof.data()[3*mesh_l2g.data()[eN*nDOF_mesh_trial_element+I]+2],
@@ -5823,7 +5937,7 @@ namespace proteus
                   double ball_n[nSpace];
                   if (use_ball_as_particle == 1 && nParticles > 0)
                     {
-                      int ball_index=get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),x,y,z,distance_to_solids.data()[eN_k]);
+                      int ball_index=ballGrid.nearest(x,y,z,distance_to_solids.data()[eN_k]);
                       get_normal_to_ith_ball(nParticles, ball_center.data(), ball_radius.data(),ball_index,x,y,z,ball_n[0],ball_n[1],ball_n[2]);
                     }
                   else
@@ -6517,24 +6631,27 @@ namespace proteus
                                                                 MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_u[j],Lstar_p_u[i]) +
                                                                 MOMENTUM_SGE*VELOCITY_SGE*ck.SubgridErrorJacobian(dsubgridError_u_u[j],Lstar_u_u[i]) +
                                                                 ck.NumericalDiffusionJacobian(q_numDiff_u_last.data()[eN_k],&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]));
-                          elementJacobian_u_v[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_v,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_u_adv_v,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_u_ham_v,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_u_v_rowptr.data(),sdInfo_u_v_colind.data(),mom_uv_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_u_source[1],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_v[j],Lstar_p_u[i]));
-                          elementJacobian_u_w[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_w,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_u_adv_w,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_u_ham_w,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_u_w_rowptr.data(),sdInfo_u_w_colind.data(),mom_uw_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_u_source[2],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_w[j],Lstar_p_u[i]));
-                          elementJacobian_v_u[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_u,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_v_adv_u,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_v_ham_u,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_v_u_rowptr.data(),sdInfo_v_u_colind.data(),mom_vu_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_v_source[0],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_u[j],Lstar_p_v[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_u_v[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_v,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_u_adv_v,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_u_ham_v,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_u_v_rowptr.data(),sdInfo_u_v_colind.data(),mom_uv_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_u_source[1],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_v[j],Lstar_p_u[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_u_w[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_w,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_u_adv_w,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_u_ham_w,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_u_w_rowptr.data(),sdInfo_u_w_colind.data(),mom_uw_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_u_source[2],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_w[j],Lstar_p_u[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_v_u[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_u,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_v_adv_u,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_v_ham_u,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_v_u_rowptr.data(),sdInfo_v_u_colind.data(),mom_vu_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_v_source[0],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_u[j],Lstar_p_v[i]));
                           elementJacobian_v_v[i][j] += H_s*H_f*(ck.MassJacobian_weak(dmom_v_acc_v_t,vel_trial[j],vel_test_dV[i]) +
                                                                 ck.MassJacobian_weak(dmom_v_ham_v,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
                                                                 ck.HamiltonianJacobian_weak(dmom_v_ham_grad_v,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
@@ -6544,24 +6661,27 @@ namespace proteus
                                                                 MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_v[j],Lstar_p_v[i]) +
                                                                 MOMENTUM_SGE*VELOCITY_SGE*ck.SubgridErrorJacobian(dsubgridError_v_v[j],Lstar_v_v[i]) +
                                                                 ck.NumericalDiffusionJacobian(q_numDiff_v_last.data()[eN_k],&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]));
-                          elementJacobian_v_w[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_w,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_v_adv_w,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_v_ham_w,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_v_w_rowptr.data(),sdInfo_v_w_colind.data(),mom_vw_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_v_source[2],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_w[j],Lstar_p_v[i]));
-                          elementJacobian_w_u[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_u,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_w_adv_u,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_w_ham_u,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_w_u_rowptr.data(),sdInfo_w_u_colind.data(),mom_wu_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_w_source[0],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_u[j],Lstar_p_w[i]));
-                          elementJacobian_w_v[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_v,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.AdvectionJacobian_weak(dmom_w_adv_v,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.MassJacobian_weak(dmom_w_ham_v,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
-                                                                ck.SimpleDiffusionJacobian_weak(sdInfo_w_v_rowptr.data(),sdInfo_w_v_colind.data(),mom_wv_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
-                                                                ck.ReactionJacobian_weak(dmom_w_source[1],vel_trial[j],vel_test_dV[i]) +
-                                                                MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_v[j],Lstar_p_w[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_v_w[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_w,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_v_adv_w,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_v_ham_w,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_v_w_rowptr.data(),sdInfo_v_w_colind.data(),mom_vw_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_v_source[2],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_w[j],Lstar_p_v[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_w_u[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_u,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_w_adv_u,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_w_ham_u,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_w_u_rowptr.data(),sdInfo_w_u_colind.data(),mom_wu_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_w_source[0],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_u[j],Lstar_p_w[i]));
+                          if (!blockDiagonalVelocityJacobian)
+                            elementJacobian_w_v[i][j] += H_s*H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_v,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.AdvectionJacobian_weak(dmom_w_adv_v,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.MassJacobian_weak(dmom_w_ham_v,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
+                                                                  ck.SimpleDiffusionJacobian_weak(sdInfo_w_v_rowptr.data(),sdInfo_w_v_colind.data(),mom_wv_diff_ten,&vel_grad_trial_ib[j_nSpace],&vel_grad_test_dV[i_nSpace]) +
+                                                                  ck.ReactionJacobian_weak(dmom_w_source[1],vel_trial[j],vel_test_dV[i]) +
+                                                                  MOMENTUM_SGE*PRESSURE_SGE*ck.SubgridErrorJacobian(dsubgridError_p_v[j],Lstar_p_w[i]));
                           elementJacobian_w_w[i][j] += H_s*H_f*(ck.MassJacobian_weak(dmom_w_acc_w_t,vel_trial[j],vel_test_dV[i]) +
                                                                 ck.MassJacobian_weak(dmom_w_ham_w,vel_trial[j],vel_test_dV[i]) + //cek hack for nonlinear hamiltonian
                                                                 ck.HamiltonianJacobian_weak(dmom_w_ham_grad_w,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
@@ -6586,28 +6706,34 @@ namespace proteus
                                                                 ck.AdvectionJacobian_weak(dmom_u_adv_u_s,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
                                                                 ck.ReactionJacobian_weak(dmom_u_source_s[0],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_u_v[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_v_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_u_source_s[1],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_u_v[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_v_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_u_source_s[1],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_u_w[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_w_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_u_source_s[2],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_u_w[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_u_ham_grad_w_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_u_source_s[2],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_v_u[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_u_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_v_source_s[0],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_v_u[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_u_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_v_source_s[0],vel_trial[j],vel_test_dV[i]));
                               
                               elementJacobian_v_v[i][j] += H_f*(ck.MassJacobian_weak(dmom_v_ham_v_s,vel_trial[j],vel_test_dV[i]) +
                                                                 ck.HamiltonianJacobian_weak(dmom_v_ham_grad_v_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
                                                                 ck.AdvectionJacobian_weak(dmom_v_adv_v_s,vel_trial[j],&vel_grad_test_dV[i_nSpace]) +
                                                                 ck.ReactionJacobian_weak(dmom_v_source_s[1],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_v_w[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_w_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_v_source_s[2],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_v_w[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_v_ham_grad_w_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_v_source_s[2],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_w_u[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_u_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_w_source_s[0],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_w_u[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_u_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_w_source_s[0],vel_trial[j],vel_test_dV[i]));
                               
-                              elementJacobian_w_v[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_v_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
-                                                                ck.ReactionJacobian_weak(dmom_w_source_s[1],vel_trial[j],vel_test_dV[i]));
+                              if (!blockDiagonalVelocityJacobian)
+                                elementJacobian_w_v[i][j] += H_f*(ck.HamiltonianJacobian_weak(dmom_w_ham_grad_v_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
+                                                                  ck.ReactionJacobian_weak(dmom_w_source_s[1],vel_trial[j],vel_test_dV[i]));
                               
                               elementJacobian_w_w[i][j] += H_f*(ck.MassJacobian_weak(dmom_w_ham_w_s,vel_trial[j],vel_test_dV[i]) +
                                                                 ck.HamiltonianJacobian_weak(dmom_w_ham_grad_w_s,&vel_grad_trial_ib[j_nSpace],vel_test_dV[i]) +
@@ -6624,54 +6750,70 @@ namespace proteus
           for (int i=0;i<nDOF_test_element;i++)
             {
               int eN_i = eN*nDOF_test_element+i;
+              int I_p = offset_p+stride_p*rp_l2g.data()[eN_i];
               for (int j=0;j<nDOF_trial_element;j++)
                 {
+                  int J_p = offset_p+stride_p*p_l2g.data()[eN*nDOF_trial_element+j];
                   int eN_i_j = eN_i*nDOF_trial_element+j;
-                  globalJacobian.data()[csrRowIndeces_p_p.data()[eN_i] + csrColumnOffsets_p_p.data()[eN_i_j]] += elementJacobian_p_p[i][j];
+                  jacobianScatter.add(csrRowIndeces_p_p.data()[eN_i] + csrColumnOffsets_p_p.data()[eN_i_j], I_p, J_p, elementJacobian_p_p[i][j]);
                 }
             }
           for (int i=0;i<nDOF_test_element;i++)
             {
               int eN_i = eN*nDOF_test_element+i;
+              int I_p = offset_p+stride_p*rp_l2g.data()[eN_i];
               for (int j=0;j<nDOF_v_trial_element;j++)
                 {
+                  int J_u = offset_u+stride_u*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_v = offset_v+stride_v*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_w = offset_w+stride_w*vel_l2g.data()[eN*nDOF_v_trial_element+j];
                   int eN_i_j = eN_i*nDOF_v_trial_element+j;
-                  globalJacobian.data()[csrRowIndeces_p_u.data()[eN_i] + csrColumnOffsets_p_u.data()[eN_i_j]] += elementJacobian_p_u[i][j];
-                  globalJacobian.data()[csrRowIndeces_p_v.data()[eN_i] + csrColumnOffsets_p_v.data()[eN_i_j]] += elementJacobian_p_v[i][j];
-                  globalJacobian.data()[csrRowIndeces_p_w.data()[eN_i] + csrColumnOffsets_p_w.data()[eN_i_j]] += elementJacobian_p_w[i][j];
+                  jacobianScatter.add(csrRowIndeces_p_u.data()[eN_i] + csrColumnOffsets_p_u.data()[eN_i_j], I_p, J_u, elementJacobian_p_u[i][j]);
+                  jacobianScatter.add(csrRowIndeces_p_v.data()[eN_i] + csrColumnOffsets_p_v.data()[eN_i_j], I_p, J_v, elementJacobian_p_v[i][j]);
+                  jacobianScatter.add(csrRowIndeces_p_w.data()[eN_i] + csrColumnOffsets_p_w.data()[eN_i_j], I_p, J_w, elementJacobian_p_w[i][j]);
                 }
             }
           for (int i=0;i<nDOF_v_test_element;i++)
             {
               int eN_i = eN*nDOF_v_test_element+i;
+              int I_u = offset_u+stride_u*rvel_l2g.data()[eN_i], I_v = offset_v+stride_v*rvel_l2g.data()[eN_i], I_w = offset_w+stride_w*rvel_l2g.data()[eN_i];
               for (int j=0;j<nDOF_trial_element;j++)
                 {
+                  int J_p = offset_p+stride_p*p_l2g.data()[eN*nDOF_trial_element+j];
                   int eN_i_j = eN_i*nDOF_trial_element+j;
-                  globalJacobian.data()[csrRowIndeces_u_p.data()[eN_i] + csrColumnOffsets_u_p.data()[eN_i_j]] += elementJacobian_u_p[i][j];
-                  globalJacobian.data()[csrRowIndeces_v_p.data()[eN_i] + csrColumnOffsets_v_p.data()[eN_i_j]] += elementJacobian_v_p[i][j];
-                  globalJacobian.data()[csrRowIndeces_w_p.data()[eN_i] + csrColumnOffsets_w_p.data()[eN_i_j]] += elementJacobian_w_p[i][j];
+                  jacobianScatter.add(csrRowIndeces_u_p.data()[eN_i] + csrColumnOffsets_u_p.data()[eN_i_j], I_u, J_p, elementJacobian_u_p[i][j]);
+                  jacobianScatter.add(csrRowIndeces_v_p.data()[eN_i] + csrColumnOffsets_v_p.data()[eN_i_j], I_v, J_p, elementJacobian_v_p[i][j]);
+                  jacobianScatter.add(csrRowIndeces_w_p.data()[eN_i] + csrColumnOffsets_w_p.data()[eN_i_j], I_w, J_p, elementJacobian_w_p[i][j]);
                 }
             }
           for (int i=0;i<nDOF_v_test_element;i++)
             {
               int eN_i = eN*nDOF_v_test_element+i;
+              int I_u = offset_u+stride_u*rvel_l2g.data()[eN_i], I_v = offset_v+stride_v*rvel_l2g.data()[eN_i], I_w = offset_w+stride_w*rvel_l2g.data()[eN_i];
               for (int j=0;j<nDOF_v_trial_element;j++)
                 {
+                  int J_u = offset_u+stride_u*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_v = offset_v+stride_v*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_w = offset_w+stride_w*vel_l2g.data()[eN*nDOF_v_trial_element+j];
                   int eN_i_j = eN_i*nDOF_v_trial_element+j;
-                  globalJacobian.data()[csrRowIndeces_u_u.data()[eN_i] + csrColumnOffsets_u_u.data()[eN_i_j]] += elementJacobian_u_u[i][j];
-                  globalJacobian.data()[csrRowIndeces_u_v.data()[eN_i] + csrColumnOffsets_u_v.data()[eN_i_j]] += elementJacobian_u_v[i][j];
-                  globalJacobian.data()[csrRowIndeces_u_w.data()[eN_i] + csrColumnOffsets_u_w.data()[eN_i_j]] += elementJacobian_u_w[i][j];
-
-                  globalJacobian.data()[csrRowIndeces_v_u.data()[eN_i] + csrColumnOffsets_v_u.data()[eN_i_j]] += elementJacobian_v_u[i][j];
-                  globalJacobian.data()[csrRowIndeces_v_v.data()[eN_i] + csrColumnOffsets_v_v.data()[eN_i_j]] += elementJacobian_v_v[i][j];
-                  globalJacobian.data()[csrRowIndeces_v_w.data()[eN_i] + csrColumnOffsets_v_w.data()[eN_i_j]] += elementJacobian_v_w[i][j];
-
-                  globalJacobian.data()[csrRowIndeces_w_u.data()[eN_i] + csrColumnOffsets_w_u.data()[eN_i_j]] += elementJacobian_w_u[i][j];
-                  globalJacobian.data()[csrRowIndeces_w_v.data()[eN_i] + csrColumnOffsets_w_v.data()[eN_i_j]] += elementJacobian_w_v[i][j];
-                  globalJacobian.data()[csrRowIndeces_w_w.data()[eN_i] + csrColumnOffsets_w_w.data()[eN_i_j]] += elementJacobian_w_w[i][j];
+                  jacobianScatter.add(csrRowIndeces_u_u.data()[eN_i] + csrColumnOffsets_u_u.data()[eN_i_j], I_u, J_u, elementJacobian_u_u[i][j]);
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_u_v.data()[eN_i] + csrColumnOffsets_u_v.data()[eN_i_j], I_u, J_v, elementJacobian_u_v[i][j]);
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_u_w.data()[eN_i] + csrColumnOffsets_u_w.data()[eN_i_j], I_u, J_w, elementJacobian_u_w[i][j]);
+
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_v_u.data()[eN_i] + csrColumnOffsets_v_u.data()[eN_i_j], I_v, J_u, elementJacobian_v_u[i][j]);
+                  jacobianScatter.add(csrRowIndeces_v_v.data()[eN_i] + csrColumnOffsets_v_v.data()[eN_i_j], I_v, J_v, elementJacobian_v_v[i][j]);
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_v_w.data()[eN_i] + csrColumnOffsets_v_w.data()[eN_i_j], I_v, J_w, elementJacobian_v_w[i][j]);
+
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_w_u.data()[eN_i] + csrColumnOffsets_w_u.data()[eN_i_j], I_w, J_u, elementJacobian_w_u[i][j]);
+                  if (!blockDiagonalVelocityJacobian)
+                    jacobianScatter.add(csrRowIndeces_w_v.data()[eN_i] + csrColumnOffsets_w_v.data()[eN_i_j], I_w, J_v, elementJacobian_w_v[i][j]);
+                  jacobianScatter.add(csrRowIndeces_w_w.data()[eN_i] + csrColumnOffsets_w_w.data()[eN_i_j], I_w, J_w, elementJacobian_w_w[i][j]);
                 }//j
             }//i
         }//elements
+      }//parallel
+      }//colors
       std::set<int>::iterator it=cutfem_boundaries.begin();
       while(it!=cutfem_boundaries.end())
         {
@@ -6862,7 +7004,7 @@ namespace proteus
                     double DWp_Dn_jump_i = Wi_it->second,
                       DWp_Dn_jump_j = Wj_it->second;
                     std::pair<int,int> ij = std::make_pair(i_global, j_global);
-                    globalJacobian.data()[p_p_nz.at(ij)] += gamma_cutfem_p*h_cutfem*DWp_Dn_jump_j*DWp_Dn_jump_i*dS;
+                    jacobianScatter.add(p_p_nz.at(ij), offset_p+stride_p*i_global, offset_p+stride_p*j_global, gamma_cutfem_p*h_cutfem*DWp_Dn_jump_j*DWp_Dn_jump_i*dS);
                   }//i,j
               for (std::map<int,double>::iterator Wi_it=DW_Dn_jump.begin(); Wi_it!=DW_Dn_jump.end(); ++Wi_it)
                 for (std::map<int,double>::iterator Wj_it=DW_Dn_jump.begin(); Wj_it!=DW_Dn_jump.end(); ++Wj_it)
@@ -6872,9 +7014,9 @@ namespace proteus
                     double DW_Dn_jump_i = Wi_it->second,
                       DW_Dn_jump_j = Wj_it->second;
                     std::pair<int,int> ij = std::make_pair(i_global, j_global);
-                    globalJacobian.data()[u_u_nz.at(ij)] += gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS;
-                    globalJacobian.data()[v_v_nz.at(ij)] += gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS;
-                    globalJacobian.data()[w_w_nz.at(ij)] += gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS;
+                    jacobianScatter.add(u_u_nz.at(ij), offset_u+stride_u*i_global, offset_u+stride_u*j_global, gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS);
+                    jacobianScatter.add(v_v_nz.at(ij), offset_v+stride_v*i_global, offset_v+stride_v*j_global, gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS);
+                    jacobianScatter.add(w_w_nz.at(ij), offset_w+stride_w*i_global, offset_w+stride_w*j_global, gamma_cutfem*h_cutfem*DW_Dn_jump_j*DW_Dn_jump_i*dS);
                   }//i,j
             }//kb
 	  it++;
@@ -7197,7 +7339,7 @@ namespace proteus
               double eddy_viscosity_ext(0.),bc_eddy_viscosity_ext(0.);//not interested in saving boundary eddy viscosity for now
               if (use_ball_as_particle == 1 && nParticles > 0)
                 {
-                  get_distance_to_ball(nParticles, ball_center.data(), ball_radius.data(),x_ext,y_ext,z_ext,ebqe_phi_s.data()[ebNE_kb]);
+                  ballGrid.nearest(x_ext,y_ext,z_ext,ebqe_phi_s.data()[ebNE_kb]);
                 }
               //else distance_to_solids is updated in PreStep
               const double particle_eps  = particle_epsFact*(useMetrics*h_phi+(1.0-useMetrics)*elementDiameter.data()[eN]);
@@ -7635,43 +7777,46 @@ namespace proteus
                                                                vel_trial_trace_ref.data()[ebN_local_kb_j],
                                                                &vel_grad_trial_trace[j_nSpace],
                                                                penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-                      fluxJacobian_u_v[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_u_adv_v_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_u_v_rowptr.data(),
-                                                               sdInfo_u_v_colind.data(),
-                                                               isDOFBoundary_v.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_v.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_uv_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-                      fluxJacobian_u_w[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_u_adv_w_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_u_w_rowptr.data(),
-                                                               sdInfo_u_w_colind.data(),
-                                                               isDOFBoundary_w.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_w.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_uw_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-
-                      fluxJacobian_v_u[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_v_adv_u_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_v_u_rowptr.data(),
-                                                               sdInfo_v_u_colind.data(),
-                                                               isDOFBoundary_u.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_u.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_vu_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_u_v[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_u_adv_v_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_u_v_rowptr.data(),
+                                                                 sdInfo_u_v_colind.data(),
+                                                                 isDOFBoundary_v.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_v.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_uv_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_u_w[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_u_adv_w_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_u_w_rowptr.data(),
+                                                                 sdInfo_u_w_colind.data(),
+                                                                 isDOFBoundary_w.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_w.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_uw_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_v_u[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_v_adv_u_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_v_u_rowptr.data(),
+                                                                 sdInfo_v_u_colind.data(),
+                                                                 isDOFBoundary_u.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_u.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_vu_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
                       fluxJacobian_v_v[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_v_adv_v_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
                         ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
                                                                ebqe_phi_ext.data()[ebNE_kb],
@@ -7684,43 +7829,46 @@ namespace proteus
                                                                vel_trial_trace_ref.data()[ebN_local_kb_j],
                                                                &vel_grad_trial_trace[j_nSpace],
                                                                penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-                      fluxJacobian_v_w[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_v_adv_w_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_v_w_rowptr.data(),
-                                                               sdInfo_v_w_colind.data(),
-                                                               isDOFBoundary_w.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_w.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_vw_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-
-                      fluxJacobian_w_u[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_w_adv_u_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_w_u_rowptr.data(),
-                                                               sdInfo_w_u_colind.data(),
-                                                               isDOFBoundary_u.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_u.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_wu_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
-                      fluxJacobian_w_v[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_w_adv_v_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
-                        ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
-                                                               ebqe_phi_ext.data()[ebNE_kb],
-                                                               sdInfo_w_v_rowptr.data(),
-                                                               sdInfo_w_v_colind.data(),
-                                                               isDOFBoundary_v.data()[ebNE_kb],
-                                                               isDiffusiveFluxBoundary_v.data()[ebNE_kb],
-                                                               normal,
-                                                               mom_wv_diff_ten_ext,
-                                                               vel_trial_trace_ref.data()[ebN_local_kb_j],
-                                                               &vel_grad_trial_trace[j_nSpace],
-                                                               penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_v_w[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_v_adv_w_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_v_w_rowptr.data(),
+                                                                 sdInfo_v_w_colind.data(),
+                                                                 isDOFBoundary_w.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_w.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_vw_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_w_u[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_w_adv_u_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_w_u_rowptr.data(),
+                                                                 sdInfo_w_u_colind.data(),
+                                                                 isDOFBoundary_u.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_u.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_wu_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
+                      if (!blockDiagonalVelocityJacobian)
+                        fluxJacobian_w_v[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_w_adv_v_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
+                          ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
+                                                                 ebqe_phi_ext.data()[ebNE_kb],
+                                                                 sdInfo_w_v_rowptr.data(),
+                                                                 sdInfo_w_v_colind.data(),
+                                                                 isDOFBoundary_v.data()[ebNE_kb],
+                                                                 isDiffusiveFluxBoundary_v.data()[ebNE_kb],
+                                                                 normal,
+                                                                 mom_wv_diff_ten_ext,
+                                                                 vel_trial_trace_ref.data()[ebN_local_kb_j],
+                                                                 &vel_grad_trial_trace[j_nSpace],
+                                                                 penalty);//ebqe_penalty_ext.data()[ebNE_kb]);
                       fluxJacobian_w_w[j]=ck.ExteriorNumericalAdvectiveFluxJacobian(dflux_mom_w_adv_w_ext,vel_trial_trace_ref.data()[ebN_local_kb_j]) +
                         ExteriorNumericalDiffusiveFluxJacobian(eps_rho,
                                                                ebqe_phi_ext.data()[ebNE_kb],
@@ -7744,45 +7892,53 @@ namespace proteus
                   for (int i=0;i<nDOF_test_element;i++)
                     {
                       int eN_i = eN*nDOF_test_element+i;
+                      int I_p = offset_p+stride_p*rp_l2g.data()[eN_i];
                       for (int j=0;j<nDOF_trial_element;j++)
                         {
+                          int J_p = offset_p+stride_p*p_l2g.data()[eN*nDOF_trial_element+j];
                           int eN_j = eN*nDOF_trial_element+j;
                           int ebN_i_j = ebN*4*nDOF_test_X_trial_element + i*nDOF_trial_element + j,ebN_local_kb_j=ebN_local_kb*nDOF_trial_element+j;
 
-                          globalJacobian.data()[csrRowIndeces_p_p[eN_i] + csrColumnOffsets_eb_p_p.data()[ebN_i_j]] += H_s*fluxJacobian_p_p[j]*p_test_dS[i];
+                          jacobianScatter.add(csrRowIndeces_p_p[eN_i] + csrColumnOffsets_eb_p_p.data()[ebN_i_j], I_p, J_p, H_s*fluxJacobian_p_p[j]*p_test_dS[i]);
                         }
                     }
                   for (int i=0;i<nDOF_test_element;i++)
                     {
                       int eN_i = eN*nDOF_test_element+i;
+                      int I_p = offset_p+stride_p*rp_l2g.data()[eN_i];
                       for (int j=0;j<nDOF_v_trial_element;j++)
                         {
+                          int J_u = offset_u+stride_u*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_v = offset_v+stride_v*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_w = offset_w+stride_w*vel_l2g.data()[eN*nDOF_v_trial_element+j];
                           int eN_j = eN*nDOF_v_trial_element+j;
                           int ebN_i_j = ebN*4*nDOF_test_X_v_trial_element + i*nDOF_v_trial_element + j,ebN_local_kb_j=ebN_local_kb*nDOF_v_trial_element+j;
-                          globalJacobian.data()[csrRowIndeces_p_u.data()[eN_i] + csrColumnOffsets_eb_p_u.data()[ebN_i_j]] += H_s*fluxJacobian_p_u[j]*p_test_dS[i];
-                          globalJacobian.data()[csrRowIndeces_p_v.data()[eN_i] + csrColumnOffsets_eb_p_v.data()[ebN_i_j]] += H_s*fluxJacobian_p_v[j]*p_test_dS[i];
-                          globalJacobian.data()[csrRowIndeces_p_w.data()[eN_i] + csrColumnOffsets_eb_p_w.data()[ebN_i_j]] += H_s*fluxJacobian_p_w[j]*p_test_dS[i];
+                          jacobianScatter.add(csrRowIndeces_p_u.data()[eN_i] + csrColumnOffsets_eb_p_u.data()[ebN_i_j], I_p, J_u, H_s*fluxJacobian_p_u[j]*p_test_dS[i]);
+                          jacobianScatter.add(csrRowIndeces_p_v.data()[eN_i] + csrColumnOffsets_eb_p_v.data()[ebN_i_j], I_p, J_v, H_s*fluxJacobian_p_v[j]*p_test_dS[i]);
+                          jacobianScatter.add(csrRowIndeces_p_w.data()[eN_i] + csrColumnOffsets_eb_p_w.data()[ebN_i_j], I_p, J_w, H_s*fluxJacobian_p_w[j]*p_test_dS[i]);
                         }
                     }
                   for (int i=0;i<nDOF_v_test_element;i++)
                     {
                       int eN_i = eN*nDOF_v_test_element+i;
+                      int I_u = offset_u+stride_u*rvel_l2g.data()[eN_i], I_v = offset_v+stride_v*rvel_l2g.data()[eN_i], I_w = offset_w+stride_w*rvel_l2g.data()[eN_i];
                       for (int j=0;j<nDOF_trial_element;j++)
                         {
+                          int J_p = offset_p+stride_p*p_l2g.data()[eN*nDOF_trial_element+j];
                           int ebN_i_j = ebN*4*nDOF_v_test_X_trial_element + i*nDOF_trial_element + j,ebN_local_kb_j=ebN_local_kb*nDOF_trial_element+j;
-                          globalJacobian.data()[csrRowIndeces_u_p.data()[eN_i] + csrColumnOffsets_eb_u_p.data()[ebN_i_j]] += H_s*fluxJacobian_u_p[j]*vel_test_dS[i];
-                          globalJacobian.data()[csrRowIndeces_v_p.data()[eN_i] + csrColumnOffsets_eb_v_p.data()[ebN_i_j]] += H_s*fluxJacobian_v_p[j]*vel_test_dS[i];
-                          globalJacobian.data()[csrRowIndeces_w_p.data()[eN_i] + csrColumnOffsets_eb_w_p.data()[ebN_i_j]] += H_s*fluxJacobian_w_p[j]*vel_test_dS[i];
+                          jacobianScatter.add(csrRowIndeces_u_p.data()[eN_i] + csrColumnOffsets_eb_u_p.data()[ebN_i_j], I_u, J_p, H_s*fluxJacobian_u_p[j]*vel_test_dS[i]);
+                          jacobianScatter.add(csrRowIndeces_v_p.data()[eN_i] + csrColumnOffsets_eb_v_p.data()[ebN_i_j], I_v, J_p, H_s*fluxJacobian_v_p[j]*vel_test_dS[i]);
+                          jacobianScatter.add(csrRowIndeces_w_p.data()[eN_i] + csrColumnOffsets_eb_w_p.data()[ebN_i_j], I_w, J_p, H_s*fluxJacobian_w_p[j]*vel_test_dS[i]);
                         }
                     }
                   for (int i=0;i<nDOF_v_test_element;i++)
                     {
                       int eN_i = eN*nDOF_v_test_element+i;
+                      int I_u = offset_u+stride_u*rvel_l2g.data()[eN_i], I_v = offset_v+stride_v*rvel_l2g.data()[eN_i], I_w = offset_w+stride_w*rvel_l2g.data()[eN_i];
                       for (int j=0;j<nDOF_v_trial_element;j++)
                         {
+                          int J_u = offset_u+stride_u*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_v = offset_v+stride_v*vel_l2g.data()[eN*nDOF_v_trial_element+j], J_w = offset_w+stride_w*vel_l2g.data()[eN*nDOF_v_trial_element+j];
                           int eN_j = eN*nDOF_v_trial_element+j;
                           int ebN_i_j = ebN*4*nDOF_v_test_X_v_trial_element + i*nDOF_v_trial_element + j,ebN_local_kb_j=ebN_local_kb*nDOF_v_trial_element+j;
-                          globalJacobian.data()[csrRowIndeces_u_u.data()[eN_i] + csrColumnOffsets_eb_u_u.data()[ebN_i_j]] +=
+                          jacobianScatter.add(csrRowIndeces_u_u.data()[eN_i] + csrColumnOffsets_eb_u_u.data()[ebN_i_j], I_u, J_u,
 			    H_s*(fluxJacobian_u_u[j]*vel_test_dS[i]+
 				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u.data()[ebNE_kb],
 										    isDiffusiveFluxBoundary_u.data()[ebNE_kb],
@@ -7792,41 +7948,44 @@ namespace proteus
 										    sdInfo_u_u_rowptr.data(),
 										    sdInfo_u_u_colind.data(),
 										    mom_uu_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_u_v.data()[eN_i] + csrColumnOffsets_eb_u_v.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_u_v[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_u.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_u_v_rowptr.data(),
-										    sdInfo_u_v_colind.data(),
-										    mom_uv_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_u_w.data()[eN_i] + csrColumnOffsets_eb_u_w.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_u_w[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_u.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_u_w_rowptr.data(),
-										    sdInfo_u_w_colind.data(),
-										    mom_uw_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-			  globalJacobian.data()[csrRowIndeces_v_u.data()[eN_i] + csrColumnOffsets_eb_v_u.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_v_u[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_v.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_v_u_rowptr.data(),
-										    sdInfo_v_u_colind.data(),
-										    mom_vu_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_v_v.data()[eN_i] + csrColumnOffsets_eb_v_v.data()[ebN_i_j]] +=
+										    &vel_grad_test_dS[i*nSpace])));
+                          if (!blockDiagonalVelocityJacobian)
+                            jacobianScatter.add(csrRowIndeces_u_v.data()[eN_i] + csrColumnOffsets_eb_u_v.data()[ebN_i_j], I_u, J_v,
+  			    H_s*(fluxJacobian_u_v[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_u.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_u_v_rowptr.data(),
+  										    sdInfo_u_v_colind.data(),
+  										    mom_uv_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+                          if (!blockDiagonalVelocityJacobian)
+                            jacobianScatter.add(csrRowIndeces_u_w.data()[eN_i] + csrColumnOffsets_eb_u_w.data()[ebN_i_j], I_u, J_w,
+  			    H_s*(fluxJacobian_u_w[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_u.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_u_w_rowptr.data(),
+  										    sdInfo_u_w_colind.data(),
+  										    mom_uw_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+			  if (!blockDiagonalVelocityJacobian)
+  			  jacobianScatter.add(csrRowIndeces_v_u.data()[eN_i] + csrColumnOffsets_eb_v_u.data()[ebN_i_j], I_v, J_u,
+  			    H_s*(fluxJacobian_v_u[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_v.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_v_u_rowptr.data(),
+  										    sdInfo_v_u_colind.data(),
+  										    mom_vu_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+                          jacobianScatter.add(csrRowIndeces_v_v.data()[eN_i] + csrColumnOffsets_eb_v_v.data()[ebN_i_j], I_v, J_v,
 			    H_s*(fluxJacobian_v_v[j]*vel_test_dS[i]+
 				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v.data()[ebNE_kb],
 										    isDiffusiveFluxBoundary_v.data()[ebNE_kb],
@@ -7836,41 +7995,44 @@ namespace proteus
 										    sdInfo_v_v_rowptr.data(),
 										    sdInfo_v_v_colind.data(),
 										    mom_vv_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_v_w.data()[eN_i] + csrColumnOffsets_eb_v_w.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_v_w[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_v.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_v_w_rowptr.data(),
-										    sdInfo_v_w_colind.data(),
-										    mom_vw_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_w_u.data()[eN_i] + csrColumnOffsets_eb_w_u.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_w_u[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_w.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_w_u_rowptr.data(),
-										    sdInfo_w_u_colind.data(),
-										    mom_wu_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_w_v.data()[eN_i] + csrColumnOffsets_eb_w_v.data()[ebN_i_j]] +=
-			    H_s*(fluxJacobian_w_v[j]*vel_test_dS[i]+
-				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v.data()[ebNE_kb],
-										    isDiffusiveFluxBoundary_w.data()[ebNE_kb],
-										    eb_adjoint_sigma,
-										    vel_trial_trace_ref.data()[ebN_local_kb_j],
-										    normal,
-										    sdInfo_w_v_rowptr.data(),
-										    sdInfo_w_v_colind.data(),
-										    mom_wv_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
-                          globalJacobian.data()[csrRowIndeces_w_w.data()[eN_i] + csrColumnOffsets_eb_w_w.data()[ebN_i_j]] +=
+										    &vel_grad_test_dS[i*nSpace])));
+                          if (!blockDiagonalVelocityJacobian)
+                            jacobianScatter.add(csrRowIndeces_v_w.data()[eN_i] + csrColumnOffsets_eb_v_w.data()[ebN_i_j], I_v, J_w,
+  			    H_s*(fluxJacobian_v_w[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_v.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_v_w_rowptr.data(),
+  										    sdInfo_v_w_colind.data(),
+  										    mom_vw_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+                          if (!blockDiagonalVelocityJacobian)
+                            jacobianScatter.add(csrRowIndeces_w_u.data()[eN_i] + csrColumnOffsets_eb_w_u.data()[ebN_i_j], I_w, J_u,
+  			    H_s*(fluxJacobian_w_u[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_w.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_w_u_rowptr.data(),
+  										    sdInfo_w_u_colind.data(),
+  										    mom_wu_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+                          if (!blockDiagonalVelocityJacobian)
+                            jacobianScatter.add(csrRowIndeces_w_v.data()[eN_i] + csrColumnOffsets_eb_w_v.data()[ebN_i_j], I_w, J_v,
+  			    H_s*(fluxJacobian_w_v[j]*vel_test_dS[i]+
+  				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v.data()[ebNE_kb],
+  										    isDiffusiveFluxBoundary_w.data()[ebNE_kb],
+  										    eb_adjoint_sigma,
+  										    vel_trial_trace_ref.data()[ebN_local_kb_j],
+  										    normal,
+  										    sdInfo_w_v_rowptr.data(),
+  										    sdInfo_w_v_colind.data(),
+  										    mom_wv_diff_ten_ext,
+  										    &vel_grad_test_dS[i*nSpace])));
+                          jacobianScatter.add(csrRowIndeces_w_w.data()[eN_i] + csrColumnOffsets_eb_w_w.data()[ebN_i_j], I_w, J_w,
 			    H_s*(fluxJacobian_w_w[j]*vel_test_dS[i]+
 				 ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w.data()[ebNE_kb],
 										    isDiffusiveFluxBoundary_w.data()[ebNE_kb],
@@ -7880,7 +8042,7 @@ namespace proteus
 										    sdInfo_w_w_rowptr.data(),
 										    sdInfo_w_w_colind.data(),
 										    mom_ww_diff_ten_ext,
-										    &vel_grad_test_dS[i*nSpace]));
+										    &vel_grad_test_dS[i*nSpace])));
                         }//j
                     }//i
                 }
@@ -7900,6 +8062,8 @@ namespace proteus
       xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
       double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
       xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+      xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
+      int mesh_generation = args.scalar<int>("mesh_generation");
       xt::pyarray<double>& mesh_trial_trace_ref = args.array<double>("mesh_trial_trace_ref");
       xt::pyarray<double>& mesh_grad_trial_trace_ref = args.array<double>("mesh_grad_trial_trace_ref");
       xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
@@ -7913,6 +8077,7 @@ namespace proteus
       xt::pyarray<double>& velocityAverage = args.array<double>("velocityAverage");
       xt::pyarray<int>& elementMaterialTypes = args.array<int>("elementMaterialTypes");
       xt::pyarray<double>& porosityTypes = args.array<double>("porosityTypes");
+      ck.updateGeometryCache(mesh_l2g.shape(0),mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
       int permutations[nQuadraturePoints_elementBoundary];
       double xArray_left[nQuadraturePoints_elementBoundary*nSpace],
         xArray_right[nQuadraturePoints_elementBoundary*nSpace];
@@ -8237,6 +8402,7 @@ namespace proteus
       xt::pyarray<double>& elementDiameter = args.array<double>("elementDiameter");
       xt::pyarray<double>& nodeDiametersArray = args.array<double>("nodeDiametersArray");
       int nElements_global = args.scalar<int>("nElements_global");
+      int mesh_generation = args.scalar<int>("mesh_generation");
       double useMetrics = args.scalar<double>("useMetrics");
       double epsFact_rho = args.scalar<double>("epsFact_rho");
       double epsFact_mu = args.scalar<double>("epsFact_mu");
@@ -8261,6 +8427,7 @@ namespace proteus
       xt::pyarray<int>& csrColumnOffsets_w_w = args.array<int>("csrColumnOffsets_w_w");
       xt::pyarray<double>& advection_matrix = args.array<double>("advection_matrix");
       gf.useExact = false;
+      ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
       for (int eN=0 ; eN < nElements_global ; ++eN)
         {
           // local matrix allocations
@@ -8398,6 +8565,7 @@ namespace proteus
       xt::pyarray<double>& elementDiameter = args.array<double>("elementDiameter");
       xt::pyarray<double>& nodeDiametersArray = args.array<double>("nodeDiametersArray");
       int nElements_global = args.scalar<int>("nElements_global");
+      int mesh_generation = args.scalar<int>("mesh_generation");
       double useMetrics = args.scalar<double>("useMetrics");
       double epsFact_rho = args.scalar<double>("epsFact_rho");
       double epsFact_mu = args.scalar<double>("epsFact_mu");
@@ -8432,6 +8600,7 @@ namespace proteus
       xt::pyarray<int>& csrColumnOffsets_w_w = args.array<int>("csrColumnOffsets_w_w");
       xt::pyarray<double>& laplace_matrix = args.array<double>("laplace_matrix");
       gf.useExact = false;
+      ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
       for (int eN=0 ; eN < nElements_global ; ++eN)
         {
           // local matrix allocations
@@ -8599,6 +8768,7 @@ namespace proteus
       xt::pyarray<double>& nodeDiametersArray = args.array<double>("nodeDiametersArray");
       xt::pyarray<double>& numerical_viscosity = args.array<double>("numerical_viscosity");
       int nElements_global = args.scalar<int>("nElements_global");
+      int mesh_generation = args.scalar<int>("mesh_generation");
       double useMetrics = args.scalar<double>("useMetrics");
       double epsFact_rho = args.scalar<double>("epsFact_rho");
       double epsFact_mu = args.scalar<double>("epsFact_mu");
@@ -8624,6 +8794,7 @@ namespace proteus
       xt::pyarray<int>& csrRowIndeces_w_w = args.array<int>("csrRowIndeces_w_w");
       xt::pyarray<int>& csrColumnOffsets_w_w = args.array<int>("csrColumnOffsets_w_w");
       xt::pyarray<double>& mass_matrix = args.array<double>("mass_matrix");
+      ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
       // Step 1.1 - Initialize local matrix
 
       for (int eN=0 ; eN < nElements_global; ++eN){
@@ -8793,6 +8964,7 @@ namespace proteus
           }
       } // eN
     }
+
   };//RANS2P
 
   inline RANS2P_base* newRANS2P(int nSpaceIn,
@@ -158,6 +158,15 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
     Equation.  This option should be turned off for most problems,
     but in some instances it may produced better preconditioning
     results than the full SGE approach.
+
+    blockDiagonalVelocityJacobian=True replaces the Jacobian by an
+    approximation that leaves out the velocity-velocity coupling blocks
+    (u_v, u_w, v_u, ...), which are then neither computed nor stored in
+    the sparsity pattern. Advection, the symmetric viscous stress, drag
+    and the stabilization all couple the velocity components, so these
+    blocks are nonzero in practice and Newton becomes an inexact Newton
+    iteration. The residual is unchanged, so it converges to the same
+    solution, typically in more iterations, with a smaller Jacobian.
     """
     from proteus.ctransportCoefficients import TwophaseNavierStokes_ST_LS_SO_2D_Evaluate
     from proteus.ctransportCoefficients import TwophaseNavierStokes_ST_LS_SO_3D_Evaluate
@@ -240,7 +249,9 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                  force_y=None,
                  force_z=None,
                  normalize_pressure=False,
-                 useInternalParticleSolver=False):
+                 useInternalParticleSolver=False,
+                 blockDiagonalVelocityJacobian=False):
+        self.blockDiagonalVelocityJacobian = blockDiagonalVelocityJacobian
         self.projection_direction=np.array([1.0,0.0,0.0])
         self.phi_s_isSet=False
         self.normalize_pressure=normalize_pressure
@@ -557,6 +568,9 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                              movingDomain=self.movingDomain)
             self.vectorComponents = [1, 2, 3]
             self.vectorName = "velocity"
+        if self.blockDiagonalVelocityJacobian:
+            for ci in self.vectorComponents:
+                self.stencil[ci] -= set(self.vectorComponents) - set([ci])
 
     def attachModels(self, modelList):
         # level set
@@ -1651,6 +1665,19 @@ class LevelModel(proteus.Transport.OneLevelTransport):
                                        self.testSpace[1].referenceFiniteElement.localFunctionSpace.dim,
                                        self.nElementBoundaryQuadraturePoints_elementBoundary,
                                        compKernelFlag)
+        # the arguments of the residual and Jacobian kernels, kept across
+        # calls so the kernels look them up only when the dict is replaced
+        self.residualArgumentsDict = cArgumentsDict.ArgumentsDict()
+        self.jacobianArgumentsDict = cArgumentsDict.ArgumentsDict()
+        # element colors for the threaded element loops; periodic conditions
+        # tie together DOFs of elements that share no node, so they get one color
+        if options is not None and options.periodicDirichletConditions is not None:
+            self.elementColorOffsets = numpy.array([0, self.mesh.nElements_global], 'i')
+            self.elementColorsArray = numpy.arange(self.mesh.nElements_global, dtype='i')
+        else:
+            self.mesh.buildElementColoring()
+            self.elementColorOffsets = self.mesh.elementColorOffsets
+            self.elementColorsArray = self.mesh.elementColorsArray
         self.ball_u = self.u[1].dof.copy()
         self.ball_v = self.u[2].dof.copy()
         if self.nSpace_global == 3:
@@ -1766,7 +1793,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
                             if self.MOVING_DOMAIN == 1.0:
                                 self.u[cj].dof[dofN] += self.mesh.nodeVelocityArray[dofN, cj - 1]
         logEvent(memory("residaul-pre-argdict","RANS"),level=4)
-        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict = self.residualArgumentsDict
         argsDict["NONCONSERVATIVE_FORM"] = float(self.coefficients.NONCONSERVATIVE_FORM)
         argsDict["MOMENTUM_SGE"] = float(self.coefficients.MOMENTUM_SGE)
         argsDict["PRESSURE_SGE"] = float(self.coefficients.PRESSURE_SGE)
@@ -1779,6 +1806,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["x_ref"] = self.elementQuadraturePoints
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["p_trial_ref"] = self.u[0].femSpace.psi
@@ -1848,6 +1876,8 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["vel_l2g"] = self.u[1].femSpace.dofMap.l2g
         argsDict["rp_l2g"] = self.l2g[0]['freeGlobal']
         argsDict["rvel_l2g"] = self.l2g[1]['freeGlobal']
+        argsDict["elementColorOffsets"] = self.elementColorOffsets
+        argsDict["elementColorsArray"] = self.elementColorsArray
         argsDict["p_dof"] = self.u[0].dof
         argsDict["u_dof"] = self.u[1].dof
         argsDict["v_dof"] = self.u[2].dof
@@ -2110,10 +2140,8 @@ velocity_I.append({:21.16e})
 """.format(*self.errors.flatten().tolist()))
         logEvent(memory("calculateResidual-end","RANS"),level=4)
     
-    def getJacobian(self, jacobian):
-        memory()
-        cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
-                                       jacobian)
+    def getJacobianArgs(self):
+        """The arguments of calculateJacobian and applyJacobian except the matrix"""
         if self.nSpace_global == 2:
             self.csrRowIndeces[(0, 3)] = self.csrRowIndeces[(0, 2)]
             self.csrColumnOffsets[(0, 3)] = self.csrColumnOffsets[(0, 2)]
@@ -2136,9 +2164,18 @@ velocity_I.append({:21.16e})
             self.csrColumnOffsets_eb[(3, 1)] = self.csrColumnOffsets[(0, 2)]
             self.csrColumnOffsets_eb[(3, 2)] = self.csrColumnOffsets[(0, 2)]
             self.csrColumnOffsets_eb[(3, 3)] = self.csrColumnOffsets[(0, 2)]
+        if self.coefficients.blockDiagonalVelocityJacobian:
+            #the kernel skips these blocks, any arrays of the right type will do
+            for ci in range(1, 4):
+                for cj in range(1, 4):
+                    if ci != cj and (ci, cj) not in self.csrRowIndeces:
+                        self.csrRowIndeces[(ci, cj)] = self.csrRowIndeces[(ci, ci)]
+                        self.csrColumnOffsets[(ci, cj)] = self.csrColumnOffsets[(ci, ci)]
+                        self.csrColumnOffsets_eb[(ci, cj)] = self.csrColumnOffsets_eb[(ci, ci)]
         logEvent(memory("ArgumentsDict-J","RANS-pre"),level=4)
-        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict = self.jacobianArgumentsDict
         argsDict["NONCONSERVATIVE_FORM"] = float(self.coefficients.NONCONSERVATIVE_FORM)
+        argsDict["blockDiagonalVelocityJacobian"] = int(self.coefficients.blockDiagonalVelocityJacobian)
         argsDict["MOMENTUM_SGE"] = float(self.coefficients.MOMENTUM_SGE)
         argsDict["PRESSURE_SGE"] = float(self.coefficients.PRESSURE_SGE)
         argsDict["VELOCITY_SGE"] = float(self.coefficients.VELOCITY_SGE)
@@ -2149,6 +2186,7 @@ velocity_I.append({:21.16e})
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["x_ref"] = self.elementQuadraturePoints
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["p_trial_ref"] = self.u[0].femSpace.psi
@@ -2213,6 +2251,18 @@ velocity_I.append({:21.16e})
         argsDict["ebqe_eddy_viscosity_last"] = self.ebqe['eddy_viscosity_last']
         argsDict["p_l2g"] = self.u[0].femSpace.dofMap.l2g
         argsDict["vel_l2g"] = self.u[1].femSpace.dofMap.l2g
+        argsDict["rp_l2g"] = self.l2g[0]['freeGlobal']
+        argsDict["rvel_l2g"] = self.l2g[1]['freeGlobal']
+        argsDict["elementColorOffsets"] = self.elementColorOffsets
+        argsDict["elementColorsArray"] = self.elementColorsArray
+        argsDict["offset_p"] = self.offset[0]
+        argsDict["offset_u"] = self.offset[1]
+        argsDict["offset_v"] = self.offset[2]
+        argsDict["offset_w"] = self.offset[3]
+        argsDict["stride_p"] = self.stride[0]
+        argsDict["stride_u"] = self.stride[1]
+        argsDict["stride_v"] = self.stride[2]
+        argsDict["stride_w"] = self.stride[3]
         argsDict["p_dof"] = self.u[0].dof
         argsDict["u_dof"] = self.u[1].dof
         argsDict["v_dof"] = self.u[2].dof
@@ -2288,7 +2338,6 @@ velocity_I.append({:21.16e})
         argsDict["csrColumnOffsets_w_v"] = self.csrColumnOffsets[(3, 2)]
         argsDict["csrRowIndeces_w_w"] = self.csrRowIndeces[(3, 3)]
         argsDict["csrColumnOffsets_w_w"] = self.csrColumnOffsets[(3, 3)]
-        argsDict["globalJacobian"] = jacobian.getCSRrepresentation()[2]
         argsDict["nExteriorElementBoundaries_global"] = self.mesh.nExteriorElementBoundaries_global
         argsDict["exteriorElementBoundariesArray"] = self.mesh.exteriorElementBoundariesArray
         argsDict["elementBoundariesArray"] = self.mesh.elementBoundariesArray
@@ -2376,6 +2425,14 @@ velocity_I.append({:21.16e})
         argsDict["isActiveElement"] = self.isActiveElement
         argsDict["isActiveElement_last"] = self.isActiveElement_last
         logEvent(memory("ArgumentsDict-J-post","RANS"),level=4)
+        return argsDict
+
+    def getJacobian(self, jacobian):
+        memory()
+        cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
+                                       jacobian)
+        argsDict = self.getJacobianArgs()
+        argsDict["globalJacobian"] = jacobian.getCSRrepresentation()[2]
         self.rans2p.calculateJacobian(argsDict)
         logEvent(memory("calcualteJacobian","RANS"),level=4)
         assert(np.all(np.isfinite(jacobian.getCSRrepresentation()[2])))
@@ -2430,6 +2487,27 @@ velocity_I.append({:21.16e})
         logEvent(memory("calcualteJacobian-rest","RANS"),level=4)
         return jacobian
 
+    def applyJacobian(self, x, y):
+        """Compute y = J x element by element without assembling J
+
+        The Jacobian is evaluated at the current solution, as in
+        getJacobian, and the rows getJacobian replaces by identity rows
+        (strong Dirichlet and inactive DOFs) are applied the same way.
+
+        This is the operator only: Newton and the linear solvers still
+        use the matrix assembled by getJacobian, nothing wraps this
+        product in a shell matrix.
+        """
+        self.rans2p.applyJacobian(self.getJacobianArgs(), x, y)
+        if self.forceStrongConditions:
+            for cj in range(self.nc):
+                for dofN in list(self.dirichletConditionsForceDOF[cj].DOFBoundaryConditionsDict.keys()):
+                    global_dofN = self.offset[cj] + self.stride[cj] * dofN
+                    y[global_dofN] = x[global_dofN]
+        inactive = self.isActiveR == 0.0
+        y[inactive] = x[inactive]
+        return y
+
     def calculateElementQuadrature(self, domainMoved=False):
         """
         Calculate the physical location and weights of the quadrature rules
@@ -2559,6 +2637,8 @@ velocity_I.append({:21.16e})
             argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
             argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
             argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+            argsDict["mesh_generation"] = self.mesh.generation
+            argsDict["mesh_grad_trial_ref"] = self.u[0].femSpace.elementMaps.grad_psi
             argsDict["mesh_trial_trace_ref"] = self.u[0].femSpace.elementMaps.psi_trace
             argsDict["mesh_grad_trial_trace_ref"] = self.u[0].femSpace.elementMaps.grad_psi_trace
             argsDict["normal_ref"] = self.u[0].femSpace.elementMaps.boundaryNormals
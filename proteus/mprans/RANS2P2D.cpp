@@ -24,11 +24,12 @@ PYBIND11_MODULE(cRANS2P2D, m)
 
     py::class_<RANS2P2D_base>(m, "cRANS2P2D_base")
       .def(py::init(&proteus::newRANS2P2D))
-      .def("calculateResidual"                    , &RANS2P2D_base::calculateResidual                     )
-      .def("calculateJacobian"                    , &RANS2P2D_base::calculateJacobian                     )
-      .def("calculateVelocityAverage"             , &RANS2P2D_base::calculateVelocityAverage              )
-      .def("getTwoPhaseAdvectionOperator"         , &RANS2P2D_base::getTwoPhaseAdvectionOperator          )
-      .def("getTwoPhaseInvScaledLaplaceOperator"  , &RANS2P2D_base::getTwoPhaseInvScaledLaplaceOperator   )
-      .def("getTwoPhaseScaledMassOperator"        , &RANS2P2D_base::getTwoPhaseScaledMassOperator         )
-      .def("step6DOF"        , &RANS2P2D_base::step6DOF);
+      .def("calculateResidual"                    , &RANS2P2D_base::calculateResidual                     , proteus::release_gil())
+      .def("calculateJacobian"                    , &RANS2P2D_base::calculateJacobian                     , proteus::release_gil())
+      .def("applyJacobian"                        , &RANS2P2D_base::applyJacobian                         , proteus::release_gil())
+      .def("calculateVelocityAverage"             , &RANS2P2D_base::calculateVelocityAverage              , proteus::release_gil())
+      .def("getTwoPhaseAdvectionOperator"         , &RANS2P2D_base::getTwoPhaseAdvectionOperator          , proteus::release_gil())
+      .def("getTwoPhaseInvScaledLaplaceOperator"  , &RANS2P2D_base::getTwoPhaseInvScaledLaplaceOperator   , proteus::release_gil())
+      .def("getTwoPhaseScaledMassOperator"        , &RANS2P2D_base::getTwoPhaseScaledMassOperator         , proteus::release_gil())
+      .def("step6DOF"        , &RANS2P2D_base::step6DOF, proteus::release_gil());
 }
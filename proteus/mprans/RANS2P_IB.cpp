@@ -24,9 +24,9 @@ PYBIND11_MODULE(cRANS2P_IB, m)
 
     py::class_<RANS2P_IB_base>(m, "cRANS2P_IB_base")
         .def(py::init(&proteus::newRANS2P_IB))
-        .def("calculateResidual"       , &RANS2P_IB_base::calculateResidual       )
-        .def("calculateBeams"          , &RANS2P_IB_base::calculateBeams          )
-        .def("calculateJacobian"       , &RANS2P_IB_base::calculateJacobian       )
-        .def("calculateForce"          , &RANS2P_IB_base::calculateForce          )
-        .def("calculateVelocityAverage", &RANS2P_IB_base::calculateVelocityAverage);
+        .def("calculateResidual"       , &RANS2P_IB_base::calculateResidual       , proteus::release_gil())
+        .def("calculateBeams"          , &RANS2P_IB_base::calculateBeams          , proteus::release_gil())
+        .def("calculateJacobian"       , &RANS2P_IB_base::calculateJacobian       , proteus::release_gil())
+        .def("calculateForce"          , &RANS2P_IB_base::calculateForce          , proteus::release_gil())
+        .def("calculateVelocityAverage", &RANS2P_IB_base::calculateVelocityAverage, proteus::release_gil());
 }
@@ -24,9 +24,10 @@ PYBIND11_MODULE(cRANS3PF, m)
 
     py::class_<cppRANS3PF_base>(m, "cppRANS3PF_base")
         .def(py::init(&proteus::newRANS3PF))
-        .def("calculateResidual", &cppRANS3PF_base::calculateResidual)
-        .def("calculateJacobian", &cppRANS3PF_base::calculateJacobian)
-        .def("calculateVelocityAverage", &cppRANS3PF_base::calculateVelocityAverage)
-        .def("getBoundaryDOFs", &cppRANS3PF_base::getBoundaryDOFs);
+        .def("calculateResidual", &cppRANS3PF_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppRANS3PF_base::calculateJacobian, proteus::release_gil())
+        .def("applyJacobian", &cppRANS3PF_base::applyJacobian, proteus::release_gil())
+        .def("calculateVelocityAverage", &cppRANS3PF_base::calculateVelocityAverage, proteus::release_gil())
+        .def("getBoundaryDOFs", &cppRANS3PF_base::getBoundaryDOFs, proteus::release_gil());
 }
 
@@ -11,6 +11,8 @@
 #include "SedClosure.h"
 #include "equivalent_polynomials.h"
 #include "ArgumentsDict.h"
+#include "JacobianScatter.h"
+#include "EdgeList.h"
 #include "xtensor-python/pyarray.hpp"
 
 double sgn3p(double val) {
@@ -52,7 +54,8 @@ namespace proteus
   class cppRANS3PF_base
   {
   public:
-    std::valarray<double> TransportMatrix, TransposeTransportMatrix;
+    std::valarray<double> TransportMatrix;
+    EdgeList edges;
     std::valarray<double> uStar_psi, vStar_psi, wStar_psi;
     std::valarray<double> uStar_hi, vStar_hi, wStar_hi, den_hi;
     std::valarray<double> uStar_min_hiHe, vStar_min_hiHe, wStar_min_hiHe;
@@ -82,6 +85,11 @@ namespace proteus
 
     virtual void calculateJacobian(arguments_dict& args,
                                    bool useExact)=0;
+    /// y = J x computed element by element, with the arguments of calculateJacobian except globalJacobian
+    virtual void applyJacobian(arguments_dict& args,
+                               bool useExact,
+                               xt::pyarray<double>& x,
+                               xt::pyarray<double>& y)=0;
     virtual void calculateVelocityAverage(arguments_dict& args) = 0;
     virtual void getBoundaryDOFs(arguments_dict& args)=0;
   };
@@ -104,6 +112,7 @@ namespace proteus
       CompKernelType ck;
       GeneralizedFunctions<nSpace,1,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf;
       GeneralizedFunctions<nSpace,1,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf_s;
+      JacobianScatter jacobianScatter;
     cppRANS3PF():
       closure(150.0,
               0.0,
@@ -1773,7 +1782,7 @@ namespace proteus
 	vStar_gamma.resize(numDOFs_1D,0.0);
 	wStar_gamma.resize(numDOFs_1D,0.0);
 	TransportMatrix.resize(NNZ_1D,0.0);
-	TransposeTransportMatrix.resize(NNZ_1D,0.0);
+	edges.setPattern(numDOFs_1D,rowptr_1D.data(),colind_1D.data());
 	uStar_psi.resize(numDOFs_1D,0.0);
 	vStar_psi.resize(numDOFs_1D,0.0);
 	wStar_psi.resize(numDOFs_1D,0.0);
@@ -1786,7 +1795,6 @@ namespace proteus
 		vStar_dMatrix[i]=0.;
 		wStar_dMatrix[i]=0.;
 		TransportMatrix[i] = 0.;
-		TransposeTransportMatrix[i] = 0.;
 	      }
 	    for (int i=0; i<numDOFs_1D; i++)
 	      {
@@ -1813,7 +1821,6 @@ namespace proteus
         for(int eN=0;eN<nElements_global;eN++)
           {
 	    double  elementTransport[nDOF_test_element][nDOF_trial_element];
-	    double  elementTransposeTransport[nDOF_test_element][nDOF_trial_element];
             //declare local storage for element residual and initialize
             double elementResidual_p[nDOF_test_element],elementResidual_mesh[nDOF_test_element],
               elementResidual_u[nDOF_test_element],
@@ -1855,7 +1862,6 @@ namespace proteus
 		    for (int j=0;j<nDOF_trial_element;j++)
 		      {
 			elementTransport[i][j]=0.0;
-			elementTransposeTransport[i][j]=0.0;
 		      }
 		  }
               }//i
@@ -2005,8 +2011,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof[mesh_l2g[eN_i]*3 + I];
 	      }//i
-	    gf_s.calculate(element_phi_s, element_nodes, x_ref.data(), false);
-            gf.calculate(element_phi, element_nodes, x_ref.data(), false);
+	    gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(), false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(), false);
             //
             //loop over quadrature points and compute integrands
             //
@@ -2933,17 +2939,11 @@ namespace proteus
 			for(int j=0;j<nDOF_trial_element;j++)
 			  {
 			    int j_nSpace = j*nSpace;
-			    int i_nSpace = i*nSpace;
 			    elementTransport[i][j] += // int[rho*(velStar.grad_wj)*wi*dx]
 			      q_rho[eN_k]*porosity*
 			      ck.AdvectionJacobian_strong(velStar,
 							  &vel_grad_test_dV[j_nSpace])
 			      *vel_trial_ref[k*nDOF_trial_element+i];
-			    elementTransposeTransport[i][j] += // int[rho*(velStar.grad_wi)*wj*dx]
-			      q_rho[eN_k]*porosity*
-			      ck.AdvectionJacobian_strong(velStar,
-							  &vel_grad_test_dV[i_nSpace])
-			      *vel_trial_ref[k*nDOF_trial_element+j];
 			  }
 		      }//j
 		  }//i
@@ -3006,10 +3006,6 @@ namespace proteus
 			TransportMatrix[csrRowIndeces_1D[eN_i]
 					+ csrColumnOffsets_1D[eN_i_j]]
 			  += elementTransport[i][j];
-			// transpose
-			TransposeTransportMatrix[csrRowIndeces_1D[eN_i]
-						 + csrColumnOffsets_1D[eN_i_j]]
-			  += elementTransposeTransport[i][j];
 		      }//j
 		  }
             }//i
@@ -3188,7 +3184,7 @@ namespace proteus
 			    double dEVij = fmax(laggedEntropyResidualPerNode[i],
 						laggedEntropyResidualPerNode[j]);
 			    double dLij = fmax(0.,fmax(TransportMatrix[ij],
-						       TransposeTransportMatrix[ij]));
+						       TransportMatrix[edges.transpose[ij]]));
 			    uStar_dMatrix[ij] = fmin(dLij,cE*dEVij);
 			    vStar_dMatrix[i] = uStar_dMatrix[ij];
 			    wStar_dMatrix[i] = uStar_dMatrix[ij];
@@ -3196,11 +3192,11 @@ namespace proteus
 			else // via smoothness indicator
 			  {
 			    uStar_dMatrix[ij] = fmax(0.,fmax(uStar_alphai*TransportMatrix[ij], // by S. Badia
-							     uStar_alphaj*TransposeTransportMatrix[ij]));
+							     uStar_alphaj*TransportMatrix[edges.transpose[ij]]));
 			    vStar_dMatrix[ij] = fmax(0.,fmax(vStar_alphai*TransportMatrix[ij], // by S. Badia
-							     vStar_alphaj*TransposeTransportMatrix[ij]));
+							     vStar_alphaj*TransportMatrix[edges.transpose[ij]]));
 			    wStar_dMatrix[ij] = fmax(0.,fmax(wStar_alphai*TransportMatrix[ij], // by S. Badia
-							     wStar_alphaj*TransposeTransportMatrix[ij]));
+							     wStar_alphaj*TransportMatrix[edges.transpose[ij]]));
 			  }
 			uStar_dii -= uStar_dMatrix[ij];
 			vStar_dii -= vStar_dMatrix[ij];
@@ -4435,6 +4431,23 @@ namespace proteus
 
       void calculateJacobian(arguments_dict& args,
                              bool useExact)
+      {
+        jacobianScatter.assemble(args.array<double>("globalJacobian").data());
+        assembleJacobian(args, useExact);
+      }
+
+      void applyJacobian(arguments_dict& args,
+                         bool useExact,
+                         xt::pyarray<double>& x,
+                         xt::pyarray<double>& y)
+      {
+        jacobianScatter.apply(y.size(), x.data(), y.data());
+        assembleJacobian(args, useExact);
+      }
+
+      /// the Jacobian element by element, added through jacobianScatter
+      void assembleJacobian(arguments_dict& args,
+                            bool useExact)
      {
         xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
         xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
@@ -4587,7 +4600,6 @@ namespace proteus
         xt::pyarray<int>& csrColumnOffsets_w_v = args.array<int>("csrColumnOffsets_w_v");
         xt::pyarray<int>& csrRowIndeces_w_w = args.array<int>("csrRowIndeces_w_w");
         xt::pyarray<int>& csrColumnOffsets_w_w = args.array<int>("csrColumnOffsets_w_w");
-        xt::pyarray<double>& globalJacobian = args.array<double>("globalJacobian");
         int nExteriorElementBoundaries_global = args.scalar<int>("nExteriorElementBoundaries_global");
         xt::pyarray<int>& exteriorElementBoundariesArray = args.array<int>("exteriorElementBoundariesArray");
         xt::pyarray<int>& elementBoundariesArray = args.array<int>("elementBoundariesArray");
@@ -4787,8 +4799,8 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof[mesh_l2g[eN_i]*3 + I];
 	      }//i
-	    gf_s.calculate(element_phi_s, element_nodes, x_ref.data(), false);
-            gf.calculate(element_phi, element_nodes, x_ref.data(), false);
+	    gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(), false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(), false);
             for  (int k=0;k<nQuadraturePoints_element;k++)
               {
                 gf.set_quad(k);
@@ -5582,8 +5594,10 @@ namespace proteus
             for (int i=0;i<nDOF_test_element;i++)
               {
                 int eN_i = eN*nDOF_test_element+i;
+                int I_u = offset_u+stride_u*vel_l2g[eN_i], I_v = offset_v+stride_v*vel_l2g[eN_i], I_w = offset_w+stride_w*vel_l2g[eN_i];
                 for (int j=0;j<nDOF_trial_element;j++)
                   {
+                    int J_u = offset_u+stride_u*vel_l2g[eN*nDOF_trial_element+j], J_v = offset_v+stride_v*vel_l2g[eN*nDOF_trial_element+j], J_w = offset_w+stride_w*vel_l2g[eN*nDOF_trial_element+j];
                     int eN_i_j = eN_i*nDOF_trial_element+j;
                     /* globalJacobian[csrRowIndeces_p_p[eN_i] + csrColumnOffsets_p_p[eN_i_j]] += elementJacobian_p_p[i][j]; */
                     /* globalJacobian[csrRowIndeces_p_u[eN_i] + csrColumnOffsets_p_u[eN_i_j]] += elementJacobian_p_u[i][j]; */
@@ -5591,19 +5605,19 @@ namespace proteus
                     /* globalJacobian[csrRowIndeces_p_w[eN_i] + csrColumnOffsets_p_w[eN_i_j]] += elementJacobian_p_w[i][j]; */
 
                     /* globalJacobian[csrRowIndeces_u_p[eN_i] + csrColumnOffsets_u_p[eN_i_j]] += elementJacobian_u_p[i][j]; */
-                    globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_u_u[eN_i_j]] += element_active*elementJacobian_u_u[i][j];
-                    globalJacobian[csrRowIndeces_u_v[eN_i] + csrColumnOffsets_u_v[eN_i_j]] += element_active*elementJacobian_u_v[i][j];
-                    globalJacobian[csrRowIndeces_u_w[eN_i] + csrColumnOffsets_u_w[eN_i_j]] += element_active*elementJacobian_u_w[i][j];
+                    jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_u_u[eN_i_j], I_u, J_u, element_active*elementJacobian_u_u[i][j]);
+                    jacobianScatter.add(csrRowIndeces_u_v[eN_i] + csrColumnOffsets_u_v[eN_i_j], I_u, J_v, element_active*elementJacobian_u_v[i][j]);
+                    jacobianScatter.add(csrRowIndeces_u_w[eN_i] + csrColumnOffsets_u_w[eN_i_j], I_u, J_w, element_active*elementJacobian_u_w[i][j]);
 
                     /* globalJacobian[csrRowIndeces_v_p[eN_i] + csrColumnOffsets_v_p[eN_i_j]] += elementJacobian_v_p[i][j]; */
-                    globalJacobian[csrRowIndeces_v_u[eN_i] + csrColumnOffsets_v_u[eN_i_j]] += element_active*elementJacobian_v_u[i][j];
-                    globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_v_v[eN_i_j]] += element_active*elementJacobian_v_v[i][j];
-                    globalJacobian[csrRowIndeces_v_w[eN_i] + csrColumnOffsets_v_w[eN_i_j]] += element_active*elementJacobian_v_w[i][j];
+                    jacobianScatter.add(csrRowIndeces_v_u[eN_i] + csrColumnOffsets_v_u[eN_i_j], I_v, J_u, element_active*elementJacobian_v_u[i][j]);
+                    jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_v_v[eN_i_j], I_v, J_v, element_active*elementJacobian_v_v[i][j]);
+                    jacobianScatter.add(csrRowIndeces_v_w[eN_i] + csrColumnOffsets_v_w[eN_i_j], I_v, J_w, element_active*elementJacobian_v_w[i][j]);
 
                     /* globalJacobian[csrRowIndeces_w_p[eN_i] + csrColumnOffsets_w_p[eN_i_j]] += elementJacobian_w_p[i][j]; */
-                    globalJacobian[csrRowIndeces_w_u[eN_i] + csrColumnOffsets_w_u[eN_i_j]] += element_active*elementJacobian_w_u[i][j];
-                    globalJacobian[csrRowIndeces_w_v[eN_i] + csrColumnOffsets_w_v[eN_i_j]] += element_active*elementJacobian_w_v[i][j];
-                    globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_w_w[eN_i_j]] += element_active*elementJacobian_w_w[i][j];
+                    jacobianScatter.add(csrRowIndeces_w_u[eN_i] + csrColumnOffsets_w_u[eN_i_j], I_w, J_u, element_active*elementJacobian_w_u[i][j]);
+                    jacobianScatter.add(csrRowIndeces_w_v[eN_i] + csrColumnOffsets_w_v[eN_i_j], I_w, J_v, element_active*elementJacobian_w_v[i][j]);
+                    jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_w_w[eN_i_j], I_w, J_w, element_active*elementJacobian_w_w[i][j]);
                   }//j
               }//i
           }//elements
@@ -5632,6 +5646,8 @@ namespace proteus
 		    int uu_ij = u_ith_row_ptr + (offset_u + counter*stride_u);
 		    int vv_ij = v_ith_row_ptr + (offset_v + counter*stride_v);
 		    int ww_ij = w_ith_row_ptr + (offset_w + counter*stride_w);
+		    // column of the ij entry in the small matrix
+		    int j = colind_1D[rowptr_1D[i]+counter];
 
 		    // read ij component of dissipative matrix
 		    double uStar_dij = uStar_dMatrix[ij];
@@ -5639,9 +5655,9 @@ namespace proteus
 		    double wStar_dij = wStar_dMatrix[ij];
 
 		    // update global Jacobian
-		    globalJacobian[uu_ij] -= uStar_dij;
-		    globalJacobian[vv_ij] -= vStar_dij;
-		    globalJacobian[ww_ij] -= wStar_dij;
+		    jacobianScatter.add(uu_ij, u_gi, offset_u+stride_u*j, -(uStar_dij));
+		    jacobianScatter.add(vv_ij, v_gi, offset_v+stride_v*j, -(vStar_dij));
+		    jacobianScatter.add(ww_ij, w_gi, offset_w+stride_w*j, -(wStar_dij));
 
 		    // update ij
 		    ij++;
@@ -5805,11 +5821,13 @@ namespace proteus
                     for (int i=0;i<nDOF_test_element;i++)
                       {
                         int eN_i = eN*nDOF_test_element+i;
+                        int I_u = offset_u+stride_u*vel_l2g[eN_i], I_v = offset_v+stride_v*vel_l2g[eN_i], I_w = offset_w+stride_w*vel_l2g[eN_i];
                         double phi_i = vel_test_dS[i];
                         double* grad_phi_i = &vel_grad_test_dS[i*nSpace+0];
                         const double grad_phi_i_dot_d = get_dot_product(grad_phi_i,distance);
                         for (int j=0;j<nDOF_trial_element;j++)
                           {
+                            int J_u = offset_u+stride_u*vel_l2g[eN*nDOF_trial_element+j], J_v = offset_v+stride_v*vel_l2g[eN*nDOF_trial_element+j], J_w = offset_w+stride_w*vel_l2g[eN*nDOF_trial_element+j];
                             int ebN_i_j = ebN*4*nDOF_test_X_trial_element
                                                     + surrogate_boundary_elements[ebN_s]*2*nDOF_test_X_trial_element
                                                     + surrogate_boundary_elements[ebN_s]*nDOF_test_X_trial_element
@@ -5824,107 +5842,107 @@ namespace proteus
 
                             // Classical Nitsche
                             // (1)
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] +=
-                              phi_i*phi_j*C_adim;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] +=
-                              phi_i*phi_j*C_adim;
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] +=
-                              phi_i*phi_j*C_adim;
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                              phi_i*phi_j*C_adim);
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                              phi_i*phi_j*C_adim);
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                              phi_i*phi_j*C_adim);
                             // (2)
                             get_symmetric_gradient_dot_vec(grad_phi_j,zero_vec,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] -=
-                                    visco * phi_i * res[0];
-                            globalJacobian[csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j]] -=
-                                    visco * phi_i * res[1];
-                            globalJacobian[csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j]] -=
-                                    visco * phi_i * res[2];
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    -(visco * phi_i * res[0]));
+                            jacobianScatter.add(csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j], I_u, J_v,
+                                    -(visco * phi_i * res[1]));
+                            jacobianScatter.add(csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j], I_u, J_w,
+                                    -(visco * phi_i * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,grad_phi_j,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j]] -=
-                                    visco * phi_i * res[0] ;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] -=
-                                    visco * phi_i * res[1];
-                            globalJacobian[csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j]] -=
-                                    visco * phi_i * res[2];
+                            jacobianScatter.add(csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j], I_v, J_u,
+                                    -(visco * phi_i * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    -(visco * phi_i * res[1]));
+                            jacobianScatter.add(csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j], I_v, J_w,
+                                    -(visco * phi_i * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,zero_vec,grad_phi_j,normal,res);
-                            globalJacobian[csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j]] -=
-                                    visco * phi_i * res[0] ;
-                            globalJacobian[csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j]] -=
-                                    visco * phi_i * res[1];
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] -=
-                                    visco * phi_i * res[2];
+                            jacobianScatter.add(csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j], I_w, J_u,
+                                    -(visco * phi_i * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j], I_w, J_v,
+                                    -(visco * phi_i * res[1]));
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    -(visco * phi_i * res[2]));
 
                             // (3)
                             get_symmetric_gradient_dot_vec(grad_phi_i,zero_vec,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] -=
-                                    visco * phi_j * res[0];
-                            globalJacobian[csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j]] -=
-                                    visco * phi_j * res[1];
-                            globalJacobian[csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j]] -=
-                                    visco * phi_j * res[2];
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    -(visco * phi_j * res[0]));
+                            jacobianScatter.add(csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j], I_u, J_v,
+                                    -(visco * phi_j * res[1]));
+                            jacobianScatter.add(csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j], I_u, J_w,
+                                    -(visco * phi_j * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,grad_phi_i,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j]] -=
-                                    visco * phi_j * res[0] ;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] -=
-                                    visco * phi_j * res[1];
-                            globalJacobian[csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j]] -=
-                                    visco * phi_j * res[2];
+                            jacobianScatter.add(csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j], I_v, J_u,
+                                    -(visco * phi_j * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    -(visco * phi_j * res[1]));
+                            jacobianScatter.add(csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j], I_v, J_w,
+                                    -(visco * phi_j * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,zero_vec,grad_phi_i,normal,res);
-                            globalJacobian[csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j]] -=
-                                    visco * phi_j * res[0] ;
-                            globalJacobian[csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j]] -=
-                                    visco * phi_j * res[1];
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] -=
-                                    visco * phi_j * res[2];
+                            jacobianScatter.add(csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j], I_w, J_u,
+                                    -(visco * phi_j * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j], I_w, J_v,
+                                    -(visco * phi_j * res[1]));
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    -(visco * phi_j * res[2]));
 
                             // (4)
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*phi_j;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*phi_j;
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*phi_j;
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    C_adim*grad_phi_i_dot_d*phi_j);
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    C_adim*grad_phi_i_dot_d*phi_j);
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    C_adim*grad_phi_i_dot_d*phi_j);
                             // (5)
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d;
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] +=
-                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d;
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d);
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d);
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    C_adim*grad_phi_i_dot_d*grad_phi_j_dot_d);
                             // (6)
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] +=
-                                    C_adim*grad_phi_j_dot_d*phi_i;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] +=
-                                    C_adim*grad_phi_j_dot_d*phi_i;
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] +=
-                                    C_adim*grad_phi_j_dot_d*phi_i;
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    C_adim*grad_phi_j_dot_d*phi_i);
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    C_adim*grad_phi_j_dot_d*phi_i);
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    C_adim*grad_phi_j_dot_d*phi_i);
                             // (7)
                             get_symmetric_gradient_dot_vec(grad_phi_i,zero_vec,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[0];
-                            globalJacobian[csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[1];
-                            globalJacobian[csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[2];
+                            jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u,
+                                    -(visco * grad_phi_j_dot_d * res[0]));
+                            jacobianScatter.add(csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j], I_u, J_v,
+                                    -(visco * grad_phi_j_dot_d * res[1]));
+                            jacobianScatter.add(csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j], I_u, J_w,
+                                    -(visco * grad_phi_j_dot_d * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,grad_phi_i,zero_vec,normal,res);
-                            globalJacobian[csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[0] ;
-                            globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[1];
-                            globalJacobian[csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[2];
+                            jacobianScatter.add(csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j], I_v, J_u,
+                                    -(visco * grad_phi_j_dot_d * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v,
+                                    -(visco * grad_phi_j_dot_d * res[1]));
+                            jacobianScatter.add(csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j], I_v, J_w,
+                                    -(visco * grad_phi_j_dot_d * res[2]));
 
                             get_symmetric_gradient_dot_vec(zero_vec,zero_vec,grad_phi_i,normal,res);
-                            globalJacobian[csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[0] ;
-                            globalJacobian[csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[1];
-                            globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] -=
-                                    visco * grad_phi_j_dot_d * res[2];
+                            jacobianScatter.add(csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j], I_w, J_u,
+                                    -(visco * grad_phi_j_dot_d * res[0])) ;
+                            jacobianScatter.add(csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j], I_w, J_v,
+                                    -(visco * grad_phi_j_dot_d * res[1]));
+                            jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w,
+                                    -(visco * grad_phi_j_dot_d * res[2]));
 
                             // the penalization on the tangential derivative
                             // B < Gw t , (Gu - GuD) t >
@@ -6691,8 +6709,10 @@ namespace proteus
                 for (int i=0;i<nDOF_test_element;i++)
                   {
                     int eN_i = eN*nDOF_test_element+i;
+                    int I_u = offset_u+stride_u*vel_l2g[eN_i], I_v = offset_v+stride_v*vel_l2g[eN_i], I_w = offset_w+stride_w*vel_l2g[eN_i];
                     for (int j=0;j<nDOF_trial_element;j++)
                       {
+                        int J_u = offset_u+stride_u*vel_l2g[eN*nDOF_trial_element+j], J_v = offset_v+stride_v*vel_l2g[eN*nDOF_trial_element+j], J_w = offset_w+stride_w*vel_l2g[eN*nDOF_trial_element+j];
                         int ebN_i_j = ebN*4*nDOF_test_X_trial_element + i*nDOF_trial_element + j,ebN_local_kb_j=ebN_local_kb*nDOF_trial_element+j;
 
                         /* globalJacobian[csrRowIndeces_p_p[eN_i] + csrColumnOffsets_eb_p_p[ebN_i_j]] += fluxJacobian_p_p[j]*p_test_dS[i]; */
@@ -6701,7 +6721,7 @@ namespace proteus
                         /* globalJacobian[csrRowIndeces_p_w[eN_i] + csrColumnOffsets_eb_p_w[ebN_i_j]] += fluxJacobian_p_w[j]*p_test_dS[i]; */
 
                         /* globalJacobian[csrRowIndeces_u_p[eN_i] + csrColumnOffsets_eb_u_p[ebN_i_j]] += fluxJacobian_u_p[j]*vel_test_dS[i]; */
-                        globalJacobian[csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j]] += fluxJacobian_u_u[j]*vel_test_dS[i]+
+                        jacobianScatter.add(csrRowIndeces_u_u[eN_i] + csrColumnOffsets_eb_u_u[ebN_i_j], I_u, J_u, fluxJacobian_u_u[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_u[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6710,8 +6730,8 @@ namespace proteus
                                                                              sdInfo_u_u_rowptr.data(),
                                                                              sdInfo_u_u_colind.data(),
                                                                              mom_uu_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j]] += fluxJacobian_u_v[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_u_v[eN_i] + csrColumnOffsets_eb_u_v[ebN_i_j], I_u, J_v, fluxJacobian_u_v[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_u[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6720,8 +6740,8 @@ namespace proteus
                                                                              sdInfo_u_v_rowptr.data(),
                                                                              sdInfo_u_v_colind.data(),
                                                                              mom_uv_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j]] += fluxJacobian_u_w[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_u_w[eN_i] + csrColumnOffsets_eb_u_w[ebN_i_j], I_u, J_w, fluxJacobian_u_w[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_u[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6730,10 +6750,10 @@ namespace proteus
                                                                              sdInfo_u_w_rowptr.data(),
                                                                              sdInfo_u_w_colind.data(),
                                                                              mom_uw_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
+                                                                             &vel_grad_test_dS[i*nSpace]));
 
                         /* globalJacobian[csrRowIndeces_v_p[eN_i] + csrColumnOffsets_eb_v_p[ebN_i_j]] += fluxJacobian_v_p[j]*vel_test_dS[i]; */
-                        globalJacobian[csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j]] += fluxJacobian_v_u[j]*vel_test_dS[i]+
+                        jacobianScatter.add(csrRowIndeces_v_u[eN_i] + csrColumnOffsets_eb_v_u[ebN_i_j], I_v, J_u, fluxJacobian_v_u[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_v[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6742,8 +6762,8 @@ namespace proteus
                                                                              sdInfo_v_u_rowptr.data(),
                                                                              sdInfo_v_u_colind.data(),
                                                                              mom_vu_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j]] += fluxJacobian_v_v[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_v_v[eN_i] + csrColumnOffsets_eb_v_v[ebN_i_j], I_v, J_v, fluxJacobian_v_v[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_v[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6752,8 +6772,8 @@ namespace proteus
                                                                              sdInfo_v_v_rowptr.data(),
                                                                              sdInfo_v_v_colind.data(),
                                                                              mom_vv_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j]] += fluxJacobian_v_w[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_v_w[eN_i] + csrColumnOffsets_eb_v_w[ebN_i_j], I_v, J_w, fluxJacobian_v_w[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_v[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6762,10 +6782,10 @@ namespace proteus
                                                                              sdInfo_v_w_rowptr.data(),
                                                                              sdInfo_v_w_colind.data(),
                                                                              mom_vw_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
+                                                                             &vel_grad_test_dS[i*nSpace]));
 
                         /* globalJacobian[csrRowIndeces_w_p[eN_i] + csrColumnOffsets_eb_w_p[ebN_i_j]] += fluxJacobian_w_p[j]*vel_test_dS[i]; */
-                        globalJacobian[csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j]] += fluxJacobian_w_u[j]*vel_test_dS[i]+
+                        jacobianScatter.add(csrRowIndeces_w_u[eN_i] + csrColumnOffsets_eb_w_u[ebN_i_j], I_w, J_u, fluxJacobian_w_u[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_u[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_w[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6774,8 +6794,8 @@ namespace proteus
                                                                              sdInfo_w_u_rowptr.data(),
                                                                              sdInfo_w_u_colind.data(),
                                                                              mom_wu_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j]] += fluxJacobian_w_v[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_w_v[eN_i] + csrColumnOffsets_eb_w_v[ebN_i_j], I_w, J_v, fluxJacobian_w_v[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_v[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_w[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6784,8 +6804,8 @@ namespace proteus
                                                                              sdInfo_w_v_rowptr.data(),
                                                                              sdInfo_w_v_colind.data(),
                                                                              mom_wv_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
-                        globalJacobian[csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j]] += fluxJacobian_w_w[j]*vel_test_dS[i]+
+                                                                             &vel_grad_test_dS[i*nSpace]));
+                        jacobianScatter.add(csrRowIndeces_w_w[eN_i] + csrColumnOffsets_eb_w_w[ebN_i_j], I_w, J_w, fluxJacobian_w_w[j]*vel_test_dS[i]+
                           ck.ExteriorElementBoundaryDiffusionAdjointJacobian(isDOFBoundary_w[ebNE_kb],
                                                                              isDiffusiveFluxBoundary_w[ebNE_kb],
                                                                              eb_adjoint_sigma,
@@ -6794,7 +6814,7 @@ namespace proteus
                                                                              sdInfo_w_w_rowptr.data(),
                                                                              sdInfo_w_w_colind.data(),
                                                                              mom_ww_diff_ten_ext,
-                                                                             &vel_grad_test_dS[i*nSpace]);
+                                                                             &vel_grad_test_dS[i*nSpace]));
                       }//j
                   }//i
               }//kb
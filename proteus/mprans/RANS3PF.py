@@ -2592,10 +2592,8 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         # mwf decide if this is reasonable for keeping solver statistics
         self.nonlinear_function_evaluations += 1
 
-    def getJacobian(self, jacobian):
-        cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
-                                       jacobian)
-
+    def getJacobianArgs(self):
+        """The arguments of calculateJacobian and applyJacobian except the matrix"""
         if self.nSpace_global == 2:
             self.csrRowIndeces[(0, 2)] = self.csrRowIndeces[(0, 1)]
             self.csrColumnOffsets[(0, 2)] = self.csrColumnOffsets[(0, 1)]
@@ -2619,7 +2617,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
             self.csrColumnOffsets_eb[(2, 1)] = self.csrColumnOffsets[(0, 1)]
             self.csrColumnOffsets_eb[(2, 2)] = self.csrColumnOffsets[(0, 1)]
 
-        (rowptr, colind, globalJacobian) = jacobian.getCSRrepresentation()
         argsDict = cArgumentsDict.ArgumentsDict()
         argsDict["mesh_trial_ref"] = self.pressureModel.u[0].femSpace.elementMaps.psi
         argsDict["mesh_grad_trial_ref"] = self.pressureModel.u[0].femSpace.elementMaps.grad_psi
@@ -2772,7 +2769,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["csrColumnOffsets_w_v"] = self.csrColumnOffsets[(2, 1)]
         argsDict["csrRowIndeces_w_w"] = self.csrRowIndeces[(2, 2)]
         argsDict["csrColumnOffsets_w_w"] = self.csrColumnOffsets[(2, 2)]
-        argsDict["globalJacobian"] = globalJacobian
         argsDict["nExteriorElementBoundaries_global"] = self.mesh.nExteriorElementBoundaries_global
         argsDict["exteriorElementBoundariesArray"] = self.mesh.exteriorElementBoundariesArray
         argsDict["elementBoundariesArray"] = self.mesh.elementBoundariesArray
@@ -2864,9 +2860,19 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["stride_w"] = self.stride[2]
         argsDict["rowptr_1D"] = self.rowptr_1D
         argsDict["colind_1D"] = self.colind_1D
+        argsDict["rowptr"] = self.rowptr
+        argsDict["colind"] = self.colind
+        argsDict["INT_BY_PARTS_PRESSURE"] = self.coefficients.INT_BY_PARTS_PRESSURE
+        return argsDict
+
+    def getJacobian(self, jacobian):
+        cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
+                                       jacobian)
+        (rowptr, colind, globalJacobian) = jacobian.getCSRrepresentation()
+        argsDict = self.getJacobianArgs()
+        argsDict["globalJacobian"] = globalJacobian
         argsDict["rowptr"] = rowptr
         argsDict["colind"] = colind
-        argsDict["INT_BY_PARTS_PRESSURE"] = self.coefficients.INT_BY_PARTS_PRESSURE
         self.rans3pf.calculateJacobian(
             argsDict,
             self.coefficients.useExact)
@@ -2908,6 +2914,32 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         self.nonlinear_function_jacobian_evaluations += 1
         return jacobian
 
+    def applyJacobian(self, x, y):
+        """Compute y = J x element by element without assembling J
+
+        The Jacobian is evaluated at the current solution, as in
+        getJacobian, and the rows getJacobian replaces by identity rows
+        (strong Dirichlet and inactive DOFs) are applied the same way.
+
+        This is the operator only: Newton and the linear solvers still
+        use the matrix assembled by getJacobian, nothing wraps this
+        product in a shell matrix.
+        """
+        self.rans3pf.applyJacobian(
+            self.getJacobianArgs(),
+            self.coefficients.useExact,
+            x,
+            y)
+        if self.forceStrongConditions:
+            for cj in range(self.nc):
+                for dofN in list(self.dirichletConditionsForceDOF[
+                        cj].DOFBoundaryConditionsDict.keys()):
+                    global_dofN = self.offset[cj] + self.stride[cj] * dofN
+                    y[global_dofN] = x[global_dofN]
+        inactive = self.isActiveDOF == 0.0
+        y[inactive] = x[inactive]
+        return y
+
     def calculateElementQuadrature(self, domainMoved=False):
         """
         Calculate the physical location and weights of the quadrature rules
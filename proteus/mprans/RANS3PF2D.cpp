@@ -24,9 +24,10 @@ PYBIND11_MODULE(cRANS3PF2D, m)
 
     py::class_<cppRANS3PF2D_base>(m, "cppRANS3PF2D_base")
         .def(py::init(&proteus::newRANS3PF2D))
-        .def("calculateResidual", &cppRANS3PF2D_base::calculateResidual)
-        .def("calculateJacobian", &cppRANS3PF2D_base::calculateJacobian)
-        .def("calculateVelocityAverage", &cppRANS3PF2D_base::calculateVelocityAverage)
-        .def("getBoundaryDOFs", &cppRANS3PF2D_base::getBoundaryDOFs);
+        .def("calculateResidual", &cppRANS3PF2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppRANS3PF2D_base::calculateJacobian, proteus::release_gil())
+        .def("applyJacobian", &cppRANS3PF2D_base::applyJacobian, proteus::release_gil())
+        .def("calculateVelocityAverage", &cppRANS3PF2D_base::calculateVelocityAverage, proteus::release_gil())
+        .def("getBoundaryDOFs", &cppRANS3PF2D_base::getBoundaryDOFs, proteus::release_gil());
 }
 
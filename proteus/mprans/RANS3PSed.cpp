@@ -24,7 +24,7 @@ PYBIND11_MODULE(cRANS3PSed, m)
 
     py::class_<cppRANS3PSed_base>(m, "cppRANS3PSed_base")
         .def(py::init(&proteus::newRANS3PSed))
-        .def("calculateResidual", &cppRANS3PSed_base::calculateResidual)
-        .def("calculateJacobian", &cppRANS3PSed_base::calculateJacobian)
-        .def("calculateVelocityAverage", &cppRANS3PSed_base::calculateVelocityAverage);
+        .def("calculateResidual", &cppRANS3PSed_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppRANS3PSed_base::calculateJacobian, proteus::release_gil())
+        .def("calculateVelocityAverage", &cppRANS3PSed_base::calculateVelocityAverage, proteus::release_gil());
 }
@@ -24,8 +24,8 @@ PYBIND11_MODULE(cRANS3PSed2D, m)
 
     py::class_<cppRANS3PSed2D_base>(m, "cppRANS3PSed2D_base")
         .def(py::init(&proteus::newRANS3PSed2D))
-        .def("calculateResidual", &cppRANS3PSed2D_base::calculateResidual)
-        .def("calculateJacobian", &cppRANS3PSed2D_base::calculateJacobian)
-        .def("calculateVelocityAverage", &cppRANS3PSed2D_base::calculateVelocityAverage);
+        .def("calculateResidual", &cppRANS3PSed2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppRANS3PSed2D_base::calculateJacobian, proteus::release_gil())
+        .def("calculateVelocityAverage", &cppRANS3PSed2D_base::calculateVelocityAverage, proteus::release_gil());
 }
 
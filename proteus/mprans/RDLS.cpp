@@ -25,10 +25,12 @@ PYBIND11_MODULE(cRDLS, m)
 
     py::class_<RDLS_base>(m, "cRDLS_base")
         .def(py::init(&proteus::newRDLS))
-        .def("calculateResidual"                , &RDLS_base::calculateResidual                 )
-        .def("calculateJacobian"                , &RDLS_base::calculateJacobian                 )
-        .def("calculateResidual_ellipticRedist" , &RDLS_base::calculateResidual_ellipticRedist  )
-        .def("calculateJacobian_ellipticRedist" , &RDLS_base::calculateJacobian_ellipticRedist  )
-        .def("normalReconstruction"             , &RDLS_base::normalReconstruction              )
-        .def("calculateMetricsAtEOS"            , &RDLS_base::calculateMetricsAtEOS, return_value_policy::take_ownership);
+        .def("calculateResidual"                , &RDLS_base::calculateResidual                 , proteus::release_gil())
+        .def("calculateJacobian"                , &RDLS_base::calculateJacobian                 , proteus::release_gil())
+        .def("updateNarrowBand"                 , &RDLS_base::updateNarrowBand                  , proteus::release_gil())
+        .def("calculateResidual_ellipticRedist" , &RDLS_base::calculateResidual_ellipticRedist  , proteus::release_gil())
+        .def("calculateJacobian_ellipticRedist" , &RDLS_base::calculateJacobian_ellipticRedist  , proteus::release_gil())
+        .def("normalReconstruction"             , &RDLS_base::normalReconstruction              , proteus::release_gil())
+        .def("eikonalRedistance"                , &RDLS_base::eikonalRedistance                 , proteus::release_gil())
+        .def("calculateMetricsAtEOS"            , &RDLS_base::calculateMetricsAtEOS, return_value_policy::take_ownership, proteus::release_gil());
 }
@@ -3,8 +3,11 @@
 #include <cmath>
 #include <iostream>
 #include <valarray>
+#include <stdexcept>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "NarrowBand.h"
+#include "Eikonal.h"
 #include "equivalent_polynomials.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
@@ -28,13 +31,24 @@ namespace proteus
   {
   public:
     std::valarray<double> weighted_lumped_mass_matrix;
+    NarrowBand narrowBand;
     virtual ~RDLS_base(){}
+    /// rebuild the narrow band from the level set u_dof and mark its DOFs in isActiveDOF
+    void updateNarrowBand(arguments_dict& args)
+    {
+      xt::pyarray<int>& u_l2g = args.array<int>("u_l2g");
+      xt::pyarray<double>& u_dof = args.array<double>("u_dof");
+      xt::pyarray<double>& isActiveDOF = args.array<double>("isActiveDOF");
+      narrowBand.build(u_l2g.shape(0), u_l2g.shape(1), u_l2g.data(), u_dof.data(),
+                       args.scalar<int>("nBandLayers"), isActiveDOF.shape(0), isActiveDOF.data());
+    }
     virtual void calculateResidual(arguments_dict& args, bool useExact)=0;
     virtual void calculateJacobian(arguments_dict& args, bool useExact)=0;
     virtual void calculateResidual_ellipticRedist(arguments_dict& args, bool useExact)=0;
     virtual void calculateJacobian_ellipticRedist(arguments_dict& args, bool useExact)=0;
     virtual void normalReconstruction(arguments_dict& args)=0;
     virtual std::tuple<double, double, double> calculateMetricsAtEOS(arguments_dict& args)=0;
+    virtual void eikonalRedistance(arguments_dict& args)=0;
   };
 
   template<class CompKernelType,
@@ -50,6 +64,7 @@ namespace proteus
       const int nDOF_test_X_trial_element;
       CompKernelType ck;
       GeneralizedFunctions<nSpace,2,nQuadraturePoints_element,nQuadraturePoints_elementBoundary> gf,gfu;
+      EikonalSolver<nSpace> eikonal;
     RDLS():
       nDOF_test_X_trial_element(nDOF_test_element*nDOF_trial_element),
         ck()
@@ -150,6 +165,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         double epsFact_redist = args.scalar<double>("epsFact_redist");
@@ -223,8 +239,10 @@ namespace proteus
         double lag_shockCapturingScale = 1.0;
         if (lag_shockCapturing == 0)
           lag_shockCapturingScale = 0.0;
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             //declare local storage for element residual and initialize
             int dummy_l2g[nDOF_mesh_trial_element];
             double elementResidual_u[nDOF_test_element],element_phi[nDOF_trial_element];
@@ -243,7 +261,7 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
             /* for (int i=0;i<nDOF_test_element;i++) */
             /*   { */
 	    /*     int eN_i=eN*nDOF_trial_element+i; */
@@ -545,6 +563,8 @@ namespace proteus
               eN  = elementBoundaryElementsArray.data()[ebN*2+0],
               ebN_local = elementBoundaryLocalElementBoundariesArray.data()[ebN*2+0],
               eN_nDOF_trial_element = eN*nDOF_trial_element;
+            if (useNarrowBand && !narrowBand.contains(eN))
+              continue;
             double epsilon_redist, h_phi;
             for  (int kb=0;kb<nQuadraturePoints_elementBoundary;kb++)
               {
@@ -629,6 +649,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        int useNarrowBand = args.scalar<int>("useNarrowBand");
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         double epsFact_redist = args.scalar<double>("epsFact_redist");
@@ -677,8 +698,10 @@ namespace proteus
         double lag_shockCapturingScale = 1.0;
         if (lag_shockCapturing == 0)
           lag_shockCapturingScale = 0.0;
-        for(int eN=0;eN<nElements_global;eN++)
+        const int nElements_band = useNarrowBand ? narrowBand.size() : nElements_global;
+        for(int eN_band=0;eN_band<nElements_band;eN_band++)
           {
+            const int eN = useNarrowBand ? narrowBand.element(eN_band) : eN_band;
             int dummy_l2g[nDOF_mesh_trial_element];
             double  elementJacobian_u_u[nDOF_test_element][nDOF_trial_element],element_phi[nDOF_trial_element];
             double epsilon_redist,h_phi, dir[nSpace], norm;
@@ -699,7 +722,7 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);            
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);            
             for  (int k=0;k<nQuadraturePoints_element;k++)
               {
                 gf.set_quad(k);
@@ -1196,7 +1219,7 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);                        
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);                        
             //loop over quadrature points and compute integrands
             for  (int k=0;k<nQuadraturePoints_element;k++)
               {
@@ -1497,7 +1520,7 @@ namespace proteus
                 for(int I=0;I<3;I++)
                   element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-            gf.calculate(element_phi, element_nodes, x_ref.data(),false);
+            gf.calculate(eN, element_phi, element_nodes, x_ref.data(),false);
             for  (int k=0;k<nQuadraturePoints_element;k++)
               {
                 gf.set_quad(k);
@@ -1845,6 +1868,25 @@ namespace proteus
         return std::tuple<double, double, double>(global_I_err, global_V_err, global_D_err);
       }
 
+      /// set u_dof to the signed distance to the zero level set of phi_dof, up to bandWidth,
+      /// starting from the distances seed_dof and returning the accepted ones in distance_dof (-1 where none)
+      void eikonalRedistance(arguments_dict& args)
+      {
+        xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
+        xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int nElements_global = args.scalar<int>("nElements_global");
+        xt::pyarray<int>& u_l2g = args.array<int>("u_l2g");
+        xt::pyarray<double>& phi_dof = args.array<double>("phi_dof");
+        xt::pyarray<double>& u_dof = args.array<double>("u_dof");
+        double bandWidth = args.scalar<double>("bandWidth");
+        xt::pyarray<double>& seed_dof = args.array<double>("seed_dof");
+        xt::pyarray<double>& distance_dof = args.array<double>("distance_dof");
+        if (nDOF_trial_element != nSpace+1 || nDOF_mesh_trial_element != nSpace+1)
+          throw std::invalid_argument("RDLS: eikonal redistancing needs P1 simplices");
+        eikonal.setMesh(nElements_global, u_dof.shape(0), u_l2g.data(), mesh_l2g.data(), mesh_dof.data());
+        std::copy(phi_dof.data(), phi_dof.data() + u_dof.shape(0), u_dof.data());
+        eikonal.redistance(u_dof.data(), bandWidth, seed_dof.data(), distance_dof.data());
+      }
     };//RDLS
   inline RDLS_base* newRDLS(int nSpaceIn,
                             int nQuadraturePoints_elementIn,
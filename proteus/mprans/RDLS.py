@@ -4,7 +4,7 @@ from proteus.mprans.cRDLS import *
 from proteus.Comm import globalMax
 import numpy as np
 from proteus.Transport import OneLevelTransport, memory
-from proteus.Transport import TC_base, NonlinearEquation, Quadrature, logEvent
+from proteus.Transport import TC_base, NonlinearEquation, Quadrature, logEvent, l2Norm
 from proteus.Transport import cfemIntegrals
 from . import cArgumentsDict
 
@@ -173,6 +173,10 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                  nullSpace='NoNullSpace', #penalization param for elliptic re-distancing
                  useExact=False,
                  copyList=True,
+                 # element layers around the zero level set to redistance, None for the whole mesh
+                 nBandLayers=None,
+                 # distance up to which RDLS.FastMarching redistances, None for the whole mesh
+                 eikonalBandWidth=None,
                  initialize=True):
         self.copyList=copyList
         self.useExact=useExact
@@ -225,6 +229,10 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
             self.alpha = 0
             self.freeze_interface_within_elliptic_redist = True
         self.nullSpace = nullSpace
+        self.nBandLayers = nBandLayers
+        assert nBandLayers is None or nBandLayers >= 1, "nBandLayers must be at least 1 to keep the elements cut by the zero level set active"
+        assert nBandLayers is None or ELLIPTIC_REDISTANCING == 0, "The narrow band (nBandLayers) is only implemented for ELLIPTIC_REDISTANCING=0"
+        self.eikonalBandWidth = eikonalBandWidth
         if initialize:
             self.initialize()
 
@@ -279,6 +287,8 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
         if self.ELLIPTIC_REDISTANCING == 2: # linear via C0 normal reconstruction
             self.rdModel.getNormalReconstruction()
         # END OF NORMAL RECONSTRUCTION #
+        if self.nBandLayers is not None:
+            self.rdModel.updateNarrowBand()
 
         if self.nModel is not None:
             logEvent("resetting signed distance level set to current level set", level=2)
@@ -774,6 +784,9 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         self.lumped_qx = np.zeros(self.u[0].dof.shape,'d')
         self.lumped_qy = np.zeros(self.u[0].dof.shape,'d')
         self.lumped_qz = np.zeros(self.u[0].dof.shape,'d')
+        # distances passed between subdomains by FastMarching, -1 where none
+        self.eikonalSeed = -np.ones(self.u[0].dof.shape,'d')
+        self.eikonalDistance = -np.ones(self.u[0].dof.shape,'d')
         self.stage = 1
         self.auxEllipticFlag = 1
         if self.coefficients.ELLIPTIC_REDISTANCING==2:
@@ -886,6 +899,53 @@ class LevelModel(proteus.Transport.OneLevelTransport):
             self.metricsAtEOS.write('global_I_err'+","+
                                     'global_V_err'+","+
                                     'global_D_err'+"\n")
+        # DOFs inside the narrow band; the others are held fixed once the band is built
+        self.narrowBandDOF = np.ones(self.u[0].dof.shape, 'd')
+        self.useNarrowBand = False
+
+    def updateNarrowBand(self):
+        """
+        Rebuild the elements within nBandLayers layers of the zero level set being redistanced
+        """
+        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict["u_l2g"] = self.u[0].femSpace.dofMap.l2g
+        if self.coefficients.dof_u0 is not None:
+            argsDict["u_dof"] = self.coefficients.dof_u0
+        else:
+            argsDict["u_dof"] = self.u[0].dof
+        argsDict["nBandLayers"] = self.coefficients.nBandLayers
+        argsDict["isActiveDOF"] = self.narrowBandDOF
+        self.rdls.updateNarrowBand(argsDict)
+        self.useNarrowBand = True
+
+    def eikonalRedistance(self, phi_dof=None):
+        """
+        Set the DOFs to the signed distance to the zero level set being redistanced by fast marching (P1 only)
+
+        The march starts from the distances in eikonalSeed too and leaves
+        the accepted ones in eikonalDistance, -1 marking none in both.
+        Returns the level set redistanced, by default dof_u0 or the DOFs.
+        """
+        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict["mesh_dof"] = self.mesh.nodeArray
+        argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["nElements_global"] = self.mesh.nElements_global
+        argsDict["u_l2g"] = self.u[0].femSpace.dofMap.l2g
+        if phi_dof is None:
+            if self.coefficients.dof_u0 is not None:
+                phi_dof = self.coefficients.dof_u0
+            else:
+                phi_dof = self.u[0].dof.copy()
+        argsDict["phi_dof"] = phi_dof
+        argsDict["u_dof"] = self.u[0].dof
+        if self.coefficients.eikonalBandWidth is not None:
+            argsDict["bandWidth"] = float(self.coefficients.eikonalBandWidth)
+        else:
+            argsDict["bandWidth"] = np.inf
+        argsDict["seed_dof"] = self.eikonalSeed
+        argsDict["distance_dof"] = self.eikonalDistance
+        self.rdls.eikonalRedistance(argsDict)
+        return phi_dof
 
     ####################################3
     def runAtEOS(self):
@@ -1090,7 +1150,10 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["lumped_qy"] = self.lumped_qy
         argsDict["lumped_qz"] = self.lumped_qz
         argsDict["alpha"] = self.coefficients.alpha/self.elementDiameter.min()
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.calculateResidual(argsDict, self.coefficients.useExact)
+        if self.useNarrowBand:
+            r *= self.narrowBandDOF
 
 
 
@@ -1192,8 +1255,13 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["ELLIPTIC_REDISTANCING"] = self.coefficients.ELLIPTIC_REDISTANCING
         argsDict["backgroundDissipationEllipticRedist"] = self.coefficients.backgroundDissipationEllipticRedist
         argsDict["alpha"] = float(self.coefficients.alpha/self.elementDiameter.min())
+        argsDict["useNarrowBand"] = int(self.useNarrowBand)
         self.calculateJacobian(argsDict, self.coefficients.useExact)
 
+        # HOLD THE DOFS OUTSIDE THE NARROW BAND FIXED #
+        if self.useNarrowBand:
+            self.setIdentityRows(self.narrowBandDOF)
+
         # FREEZING INTERFACE #
         if self.coefficients.freeze_interface_within_elliptic_redist==True:
             for gi in range(len(self.u[0].dof)):
@@ -1340,3 +1408,105 @@ def setZeroLSweakDirichletBCsSimple(RDLSvt):
                                                                            RDLSvt.u[0].dof,
                                                                            RDLSvt.dofFlag_element,  # temporary storage
                                                                            RDLSvt.weakDirichletConditionFlags)
+
+
+class FastMarching(proteus.NonlinearSolvers.NonlinearSolver):
+    """
+    Redistance by solving the eikonal equation directly instead of iterating in pseudo time
+
+    A drop-in levelNonlinearSolver for P1 simplicial meshes, e.g.
+    levelNonlinearSolver = RDLS.FastMarching with a single step
+    controller such as Newton_controller. The solution is the signed
+    distance up to Coefficients.eikonalBandWidth; the residual is
+    evaluated once at the solution to set the quadrature values used by
+    the other models. In parallel a subdomain only marches from the
+    interface in its own and ghost elements, so the accepted distances
+    are sent to the ghost DOFs and seed a new march, round after round,
+    until no owned distance decreases; the ghost DOFs then take the
+    values of their owners.
+    """
+    def __init__(self,
+                 linearSolver,
+                 F, J=None, du=None, par_du=None,
+                 rtol_r=1.0e-4,
+                 atol_r=1.0e-16,
+                 rtol_du=1.0e-4,
+                 atol_du=1.0e-16,
+                 maxIts=100,
+                 norm=l2Norm,
+                 convergenceTest='r',
+                 computeRates=True,
+                 printInfo=True,
+                 fullNewton=True,
+                 directSolver=False,
+                 EWtol=True,
+                 maxLSits=100):
+        self.par_du = par_du
+        if par_du is not None:
+            F.dim_proc = par_du.dim_proc
+        proteus.NonlinearSolvers.NonlinearSolver.__init__(self, F, J, du,
+                                                          rtol_r,
+                                                          atol_r,
+                                                          rtol_du,
+                                                          atol_du,
+                                                          maxIts,
+                                                          norm,
+                                                          convergenceTest,
+                                                          computeRates,
+                                                          printInfo)
+        self.linearSolver = linearSolver
+
+    def info(self):
+        return "Fast marching"
+
+    def solve(self, u, r=None, b=None, par_u=None, par_r=None):
+        self.F.eikonalSeed[:] = -1.0
+        phi_dof = self.F.eikonalRedistance()
+        if par_u is not None and self.par_du is not None and self.F.comm.size() > 1:
+            self.exchangeDistances(phi_dof)
+        self.F.setFreeDOF(u)
+        if par_u is not None:
+            # the owners' distances overwrite the ghosts' local ones
+            par_u.scatter_forward_insert()
+        self.F.getResidual(u, r)
+        if par_r is not None:
+            if not self.par_fullOverlap:
+                par_r.scatter_reverse_add()
+            else:
+                par_r.scatter_forward_insert()
+        self.norm_r0 = self.norm(r)
+        self.norm_r = self.norm_r0
+        self.its = 1
+        self.failedFlag = False
+        return self.failedFlag
+
+    def exchangeDistances(self, phi_dof):
+        """Re-march with the owners' distances until no owned one decreases
+
+        du holds the accepted distances in the free DOF ordering. The
+        march only lowers its seeds, so the rounds end, after about as
+        many as there are subdomains between a DOF and the interface.
+        """
+        F = self.F
+        dc = F.dirichletConditions[0]
+        nOwned = self.par_du.dim_proc
+        def copy(fromFreeToGlobal, dof):
+            cfemIntegrals.copyBetweenFreeUnknownsAndGlobalUnknowns(fromFreeToGlobal,
+                                                                   F.offset[0],
+                                                                   F.stride[0],
+                                                                   dc.global2freeGlobal_global_dofs,
+                                                                   dc.global2freeGlobal_free_dofs,
+                                                                   self.du,
+                                                                   dof)
+        copy(0, F.eikonalDistance)
+        rounds = 0
+        while True:
+            rounds += 1
+            self.par_du.scatter_forward_insert()
+            copy(1, F.eikonalSeed)
+            seed_owned = self.du[:nOwned].copy()
+            F.eikonalRedistance(phi_dof)
+            copy(0, F.eikonalDistance)
+            if globalMax(np.abs(self.du[:nOwned] - seed_owned).max(initial=0.0)) == 0.0:
+                break
+        logEvent("Fast marching exchanged distances in %d rounds" % rounds, level=3)
@@ -24,8 +24,8 @@ PYBIND11_MODULE(cSW2D, m)
 
     py::class_<SW2D_base>(m, "cSW2D_base")
         .def(py::init(&proteus::newSW2D))
-        .def("calculateResidual"        , &SW2D_base::calculateResidual)
-        .def("calculateJacobian"        , &SW2D_base::calculateJacobian)
-        .def("calculateResidual_supg"   , &SW2D_base::calculateResidual_supg)
-        .def("calculateJacobian_supg"   , &SW2D_base::calculateJacobian_supg);
+        .def("calculateResidual"        , &SW2D_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian"        , &SW2D_base::calculateJacobian, proteus::release_gil())
+        .def("calculateResidual_supg"   , &SW2D_base::calculateResidual_supg, proteus::release_gil())
+        .def("calculateJacobian_supg"   , &SW2D_base::calculateJacobian_supg, proteus::release_gil());
 }
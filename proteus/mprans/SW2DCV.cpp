@@ -22,12 +22,18 @@ PYBIND11_MODULE(cSW2DCV, m) {
 
   py::class_<SW2DCV_base>(m, "cSW2DCV_base")
       .def(py::init(&proteus::newSW2DCV))
-      .def("convexLimiting", &SW2DCV_base::convexLimiting)
+      .def("convexLimiting", &SW2DCV_base::convexLimiting,
+           proteus::release_gil())
       .def("calculateEdgeBasedCFL", &SW2DCV_base::calculateEdgeBasedCFL,
-           return_value_policy::take_ownership)
-      .def("calculateEV", &SW2DCV_base::calculateEV)
-      .def("calculateResidual", &SW2DCV_base::calculateResidual)
-      .def("calculateMassMatrix", &SW2DCV_base::calculateMassMatrix)
+           return_value_policy::take_ownership, proteus::release_gil())
+      .def("calculateEV", &SW2DCV_base::calculateEV, proteus::release_gil())
+      .def("calculateResidual", &SW2DCV_base::calculateResidual,
+           proteus::release_gil())
+      .def("advanceSSP", &SW2DCV_base::advanceSSP, proteus::release_gil())
+      .def("calculateMassMatrix", &SW2DCV_base::calculateMassMatrix,
+           proteus::release_gil())
       .def("calculateLumpedMassMatrix",
-           &SW2DCV_base::calculateLumpedMassMatrix);
+           &SW2DCV_base::calculateLumpedMassMatrix, proteus::release_gil())
+      .def("getAllocationCount", &SW2DCV_base::getAllocationCount)
+      .def("resetAllocationCount", &SW2DCV_base::resetAllocationCount);
 }
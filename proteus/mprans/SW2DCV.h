@@ -3,11 +3,14 @@
 #include "ArgumentsDict.h"
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
+#include "EdgeList.h"
+#include "Workspace.h"
+#include "SSPStepper.h"
 #include "xtensor-python/pyarray.hpp"
 #include <assert.h>
 #include <cmath>
 #include <iostream>
-#include <valarray>
 
 namespace py = pybind11;
 
@@ -129,13 +132,249 @@ inline double hStarRFromQuadPhiFromBelow(const double &g, const double &hStarL,
 
 namespace proteus {
 
+// The arguments each kernel reads from its arguments_dict, looked up once
+// per dict (see PROTEUS_ARGUMENT_BLOCK)
+#define SW2DCV_CONVEX_LIMITING_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  SCALAR(double, dt)                                                \
+  SCALAR(int, NNZ)                                                  \
+  SCALAR(int, numDOFs)                                              \
+  ARRAY(double, lumped_mass_matrix)                                 \
+  ARRAY(double, h_old)                                              \
+  ARRAY(double, hu_old)                                             \
+  ARRAY(double, hv_old)                                             \
+  ARRAY(double, b_dof)                                              \
+  ARRAY(double, high_order_hnp1)                                    \
+  ARRAY(double, high_order_hunp1)                                   \
+  ARRAY(double, high_order_hvnp1)                                   \
+  ARRAY(double, extendedSourceTerm_hu)                              \
+  ARRAY(double, extendedSourceTerm_hv)                              \
+  ARRAY(double, limited_hnp1)                                       \
+  ARRAY(double, limited_hunp1)                                      \
+  ARRAY(double, limited_hvnp1)                                      \
+  ARRAY(int, csrRowIndeces_DofLoops)                                \
+  ARRAY(int, csrColumnOffsets_DofLoops)                             \
+  ARRAY(double, MassMatrix)                                         \
+  ARRAY(double, dH_minus_dL)                                        \
+  ARRAY(double, muH_minus_muL)                                      \
+  SCALAR(double, hEps)                                              \
+  SCALAR(int, LUMPED_MASS_MATRIX)                                   \
+  ARRAY(double, dLow)                                               \
+  ARRAY(double, new_SourceTerm_hu)                                  \
+  ARRAY(double, new_SourceTerm_hv)                                  \
+  ARRAY(double, hLow)                                               \
+  ARRAY(double, huLow)                                              \
+  ARRAY(double, hvLow)                                              \
+  ARRAY(double, h_min)                                              \
+  ARRAY(double, h_max)                                              \
+  ARRAY(double, kin_max)                                            \
+  SCALAR(double, KE_tiny)
+PROTEUS_ARGUMENT_BLOCK(SW2DCVConvexLimitingArguments,
+                       SW2DCV_CONVEX_LIMITING_ARGUMENTS)
+
+#define SW2DCV_EDGE_BASED_CFL_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  SCALAR(double, g)                                                \
+  SCALAR(int, numDOFsPerEqn)                                       \
+  ARRAY(double, lumped_mass_matrix)                                \
+  ARRAY(double, h_dof_old)                                         \
+  ARRAY(double, hu_dof_old)                                        \
+  ARRAY(double, hv_dof_old)                                        \
+  ARRAY(double, b_dof)                                             \
+  ARRAY(int, csrRowIndeces_DofLoops)                               \
+  ARRAY(int, csrColumnOffsets_DofLoops)                            \
+  SCALAR(double, hEps)                                             \
+  ARRAY(double, Cx)                                                \
+  ARRAY(double, Cy)                                                \
+  ARRAY(double, CTx)                                               \
+  ARRAY(double, CTy)                                               \
+  ARRAY(double, dLow)                                              \
+  SCALAR(double, run_cfl)                                          \
+  ARRAY(double, edge_based_cfl)                                    \
+  SCALAR(int, debug)
+PROTEUS_ARGUMENT_BLOCK(SW2DCVEdgeBasedCFLArguments,
+                       SW2DCV_EDGE_BASED_CFL_ARGUMENTS)
+
+#define SW2DCV_EV_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  SCALAR(double, g)                                    \
+  ARRAY(double, h_dof_old)                             \
+  ARRAY(double, hu_dof_old)                            \
+  ARRAY(double, hv_dof_old)                            \
+  ARRAY(double, b_dof)                                 \
+  ARRAY(double, Cx)                                    \
+  ARRAY(double, Cy)                                    \
+  ARRAY(double, CTx)                                   \
+  ARRAY(double, CTy)                                   \
+  SCALAR(int, numDOFsPerEqn)                           \
+  ARRAY(int, csrRowIndeces_DofLoops)                   \
+  ARRAY(int, csrColumnOffsets_DofLoops)                \
+  ARRAY(double, lumped_mass_matrix)                    \
+  SCALAR(double, eps)                                  \
+  SCALAR(double, hEps)                                 \
+  ARRAY(double, global_entropy_residual)               \
+  SCALAR_REF(double, dij_small)
+PROTEUS_ARGUMENT_BLOCK(SW2DCVEVArguments, SW2DCV_EV_ARGUMENTS)
+
+#define SW2DCV_RESIDUAL_ARGUMENTS(ARRAY, SCALAR, SCALAR_REF) \
+  ARRAY(double, mesh_trial_ref)                              \
+  ARRAY(double, mesh_grad_trial_ref)                         \
+  ARRAY(double, mesh_dof)                                    \
+  ARRAY(int, mesh_l2g)                                       \
+  ARRAY(double, dV_ref)                                      \
+  ARRAY(double, h_trial_ref)                                 \
+  ARRAY(double, h_grad_trial_ref)                            \
+  ARRAY(double, h_test_ref)                                  \
+  ARRAY(double, h_grad_test_ref)                             \
+  ARRAY(double, vel_trial_ref)                               \
+  ARRAY(double, vel_grad_trial_ref)                          \
+  ARRAY(double, vel_test_ref)                                \
+  ARRAY(double, vel_grad_test_ref)                           \
+  ARRAY(double, mesh_trial_trace_ref)                        \
+  ARRAY(double, mesh_grad_trial_trace_ref)                   \
+  ARRAY(double, h_trial_trace_ref)                           \
+  ARRAY(double, h_grad_trial_trace_ref)                      \
+  ARRAY(double, h_test_trace_ref)                            \
+  ARRAY(double, h_grad_test_trace_ref)                       \
+  ARRAY(double, vel_trial_trace_ref)                         \
+  ARRAY(double, vel_grad_trial_trace_ref)                    \
+  ARRAY(double, vel_test_trace_ref)                          \
+  ARRAY(double, vel_grad_test_trace_ref)                     \
+  ARRAY(double, normal_ref)                                  \
+  ARRAY(double, boundaryJac_ref)                             \
+  ARRAY(double, elementDiameter)                             \
+  SCALAR(int, nElements_global)                              \
+  SCALAR(double, g)                                          \
+  ARRAY(int, h_l2g)                                          \
+  ARRAY(int, vel_l2g)                                        \
+  ARRAY(double, h_dof_old)                                   \
+  ARRAY(double, hu_dof_old)                                  \
+  ARRAY(double, hv_dof_old)                                  \
+  ARRAY(double, b_dof)                                       \
+  ARRAY(double, h_dof)                                       \
+  ARRAY(double, hu_dof)                                      \
+  ARRAY(double, hv_dof)                                      \
+  ARRAY(double, q_cfl)                                       \
+  ARRAY(int, sdInfo_hu_hu_rowptr)                            \
+  ARRAY(int, sdInfo_hu_hu_colind)                            \
+  ARRAY(int, sdInfo_hu_hv_rowptr)                            \
+  ARRAY(int, sdInfo_hu_hv_colind)                            \
+  ARRAY(int, sdInfo_hv_hv_rowptr)                            \
+  ARRAY(int, sdInfo_hv_hv_colind)                            \
+  ARRAY(int, sdInfo_hv_hu_rowptr)                            \
+  ARRAY(int, sdInfo_hv_hu_colind)                            \
+  SCALAR(int, offset_h)                                      \
+  SCALAR(int, offset_hu)                                     \
+  SCALAR(int, offset_hv)                                     \
+  SCALAR(int, stride_h)                                      \
+  SCALAR(int, stride_hu)                                     \
+  SCALAR(int, stride_hv)                                     \
+  ARRAY(double, globalResidual)                              \
+  SCALAR(int, nExteriorElementBoundaries_global)             \
+  ARRAY(int, exteriorElementBoundariesArray)                 \
+  ARRAY(int, elementBoundaryElementsArray)                   \
+  ARRAY(int, elementBoundaryLocalElementBoundariesArray)     \
+  ARRAY(int, isDOFBoundary_h)                                \
+  ARRAY(int, isDOFBoundary_hu)                               \
+  ARRAY(int, isDOFBoundary_hv)                               \
+  ARRAY(int, isAdvectiveFluxBoundary_h)                      \
+  ARRAY(int, isAdvectiveFluxBoundary_hu)                     \
+  ARRAY(int, isAdvectiveFluxBoundary_hv)                     \
+  ARRAY(int, isDiffusiveFluxBoundary_hu)                     \
+  ARRAY(int, isDiffusiveFluxBoundary_hv)                     \
+  ARRAY(double, ebqe_bc_h_ext)                               \
+  ARRAY(double, ebqe_bc_flux_mass_ext)                       \
+  ARRAY(double, ebqe_bc_flux_mom_hu_adv_ext)                 \
+  ARRAY(double, ebqe_bc_flux_mom_hv_adv_ext)                 \
+  ARRAY(double, ebqe_bc_hu_ext)                              \
+  ARRAY(double, ebqe_bc_flux_hu_diff_ext)                    \
+  ARRAY(double, ebqe_penalty_ext)                            \
+  ARRAY(double, ebqe_bc_hv_ext)                              \
+  ARRAY(double, ebqe_bc_flux_hv_diff_ext)                    \
+  ARRAY(double, q_velocity)                                  \
+  ARRAY(double, ebqe_velocity)                               \
+  ARRAY(double, flux)                                        \
+  ARRAY(double, elementResidual_h)                           \
+  ARRAY(double, Cx)                                          \
+  ARRAY(double, Cy)                                          \
+  ARRAY(double, CTx)                                         \
+  ARRAY(double, CTy)                                         \
+  SCALAR(int, numDOFsPerEqn)                                 \
+  SCALAR(int, NNZ)                                           \
+  ARRAY(int, csrRowIndeces_DofLoops)                         \
+  ARRAY(int, csrColumnOffsets_DofLoops)                      \
+  ARRAY(double, lumped_mass_matrix)                          \
+  SCALAR(double, cfl_run)                                    \
+  SCALAR(double, eps)                                        \
+  SCALAR(double, hEps)                                       \
+  ARRAY(double, hnp1_at_quad_point)                          \
+  ARRAY(double, hunp1_at_quad_point)                         \
+  ARRAY(double, hvnp1_at_quad_point)                         \
+  ARRAY(double, extendedSourceTerm_hu)                       \
+  ARRAY(double, extendedSourceTerm_hv)                       \
+  ARRAY(double, dH_minus_dL)                                 \
+  ARRAY(double, muH_minus_muL)                               \
+  SCALAR(double, cE)                                         \
+  SCALAR(int, LUMPED_MASS_MATRIX)                            \
+  SCALAR(double, dt)                                         \
+  SCALAR(int, LINEAR_FRICTION)                               \
+  SCALAR(double, mannings)                                   \
+  ARRAY(double, quantDOFs)                                   \
+  SCALAR(int, SECOND_CALL_CALCULATE_RESIDUAL)                \
+  SCALAR(int, COMPUTE_NORMALS)                               \
+  ARRAY(double, normalx)                                     \
+  ARRAY(double, normaly)                                     \
+  ARRAY(double, dLow)                                        \
+  SCALAR(int, lstage)                                        \
+  ARRAY(double, new_SourceTerm_hu)                           \
+  ARRAY(double, new_SourceTerm_hv)                           \
+  ARRAY(double, global_entropy_residual)                     \
+  SCALAR(double, dij_small)                                  \
+  ARRAY(double, hLow)                                        \
+  ARRAY(double, huLow)                                       \
+  ARRAY(double, hvLow)                                       \
+  ARRAY(double, h_min)                                       \
+  ARRAY(double, h_max)                                       \
+  ARRAY(double, kin_max)                                     \
+  ARRAY(double, urelax)                                      \
+  ARRAY(double, drelax)
+PROTEUS_ARGUMENT_BLOCK(SW2DCVResidualArguments, SW2DCV_RESIDUAL_ARGUMENTS)
+
 class SW2DCV_base {
 public:
+  /// slots of the scratch arrays kept between calls
+  enum ScratchArray {
+    ETA,
+    DELTA_SQD_H,
+    BAR_DELTASQD_H,
+    DELTA_SQD_KIN,
+    BAR_DELTASQD_KIN,
+    KIN,
+    H_BT,
+    HU_BT,
+    HV_BT,
+    HYP_FLUX_H,
+    HYP_FLUX_HU,
+    HYP_FLUX_HV,
+    PSI,
+    SSP_TMP,
+    N_SCRATCH_ARRAYS
+  };
+  FCTLimiter fct;
+  EdgeList edges;
+  Workspace<N_SCRATCH_ARRAYS> work;
   virtual ~SW2DCV_base() {}
   virtual void convexLimiting(arguments_dict &args) = 0;
   virtual double calculateEdgeBasedCFL(arguments_dict &args) = 0;
   virtual void calculateEV(arguments_dict &args) = 0;
   virtual void calculateResidual(arguments_dict &args) = 0;
+  virtual int advanceSSP(arguments_dict &args) = 0;
+  /// scratch (re)allocations made by the kernels since the last reset
+  int getAllocationCount() const {
+    return work.allocations() + fct.allocations() + edges.allocations();
+  }
+  void resetAllocationCount() {
+    work.resetAllocations();
+    fct.resetAllocations();
+    edges.resetAllocations();
+  }
   virtual void calculateMassMatrix(arguments_dict &args) = 0;
   virtual void calculateLumpedMassMatrix(arguments_dict &args) = 0;
 };
@@ -147,6 +386,10 @@ class SW2DCV : public SW2DCV_base {
 public:
   const int nDOF_test_X_trial_element;
   CompKernelType ck;
+  argument_binding<SW2DCVConvexLimitingArguments> convexLimitingArguments;
+  argument_binding<SW2DCVEdgeBasedCFLArguments> edgeBasedCFLArguments;
+  argument_binding<SW2DCVEVArguments> evArguments;
+  argument_binding<SW2DCVResidualArguments> residualArguments;
   SW2DCV()
       : nDOF_test_X_trial_element(nDOF_test_element * nDOF_trial_element),
         ck() {
@@ -232,62 +475,26 @@ public:
   }
 
   void convexLimiting(arguments_dict &args) {
-    double dt = args.scalar<double>("dt");
-    int NNZ = args.scalar<int>("NNZ");
-    int numDOFs = args.scalar<int>("numDOFs");
-    xt::pyarray<double> &lumped_mass_matrix =
-        args.array<double>("lumped_mass_matrix");
-    xt::pyarray<double> &h_old = args.array<double>("h_old");
-    xt::pyarray<double> &hu_old = args.array<double>("hu_old");
-    xt::pyarray<double> &hv_old = args.array<double>("hv_old");
-    xt::pyarray<double> &b_dof = args.array<double>("b_dof");
-    xt::pyarray<double> &high_order_hnp1 =
-        args.array<double>("high_order_hnp1");
-    xt::pyarray<double> &high_order_hunp1 =
-        args.array<double>("high_order_hunp1");
-    xt::pyarray<double> &high_order_hvnp1 =
-        args.array<double>("high_order_hvnp1");
-    xt::pyarray<double> &extendedSourceTerm_hu =
-        args.array<double>("extendedSourceTerm_hu");
-    xt::pyarray<double> &extendedSourceTerm_hv =
-        args.array<double>("extendedSourceTerm_hv");
-    xt::pyarray<double> &limited_hnp1 = args.array<double>("limited_hnp1");
-    xt::pyarray<double> &limited_hunp1 = args.array<double>("limited_hunp1");
-    xt::pyarray<double> &limited_hvnp1 = args.array<double>("limited_hvnp1");
-    xt::pyarray<int> &csrRowIndeces_DofLoops =
-        args.array<int>("csrRowIndeces_DofLoops");
-    xt::pyarray<int> &csrColumnOffsets_DofLoops =
-        args.array<int>("csrColumnOffsets_DofLoops");
-    xt::pyarray<double> &MassMatrix = args.array<double>("MassMatrix");
-    xt::pyarray<double> &dH_minus_dL = args.array<double>("dH_minus_dL");
-    xt::pyarray<double> &muH_minus_muL = args.array<double>("muH_minus_muL");
-    double hEps = args.scalar<double>("hEps");
-    int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
-    xt::pyarray<double> &dLow = args.array<double>("dLow");
-    xt::pyarray<double> &new_SourceTerm_hu =
-        args.array<double>("new_SourceTerm_hu");
-    xt::pyarray<double> &new_SourceTerm_hv =
-        args.array<double>("new_SourceTerm_hv");
-    xt::pyarray<double> &hLow = args.array<double>("hLow");
-    xt::pyarray<double> &huLow = args.array<double>("huLow");
-    xt::pyarray<double> &hvLow = args.array<double>("hvLow");
-    xt::pyarray<double> &h_min = args.array<double>("h_min");
-    xt::pyarray<double> &h_max = args.array<double>("h_max");
-    xt::pyarray<double> &kin_max = args.array<double>("kin_max");
-    double KE_tiny = args.scalar<double>("KE_tiny");
-
-    // Declare stuff for limiting on h and h*heta
-    std::valarray<double> Rneg(0.0, numDOFs), Rpos(0.0, numDOFs);
+    PROTEUS_ARGUMENT_LOCALS(SW2DCV_CONVEX_LIMITING_ARGUMENTS,
+                            convexLimitingArguments(args));
 
-    // Create FCT component matrices in vector form
-    std::valarray<double> FCT_h(0.0, dH_minus_dL.size()),
-        FCT_hu(0.0, dH_minus_dL.size()), FCT_hv(0.0, dH_minus_dL.size());
+    // FCT component matrices of h, hu and hv
+    fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(),
+                   csrColumnOffsets_DofLoops.data(), 3);
+    double *FCT_h = fct.componentFlux(0);
+    double *FCT_hu = fct.componentFlux(1);
+    double *FCT_hv = fct.componentFlux(2);
 
     ////////////////////////////////////////////////////
     // Loop to define FCT matrices for each component //
     ////////////////////////////////////////////////////
-    int ij = 0;
-    for (int i = 0; i < numDOFs; i++) {
+    fct.computeFluxes<3>([&](int i, int j, int ij, double *FCT_ij) {
+      if (i == j) {
+        FCT_ij[0] = 0.0;
+        FCT_ij[1] = 0.0;
+        FCT_ij[2] = 0.0;
+        return;
+      }
       // Read some vectors
       double high_order_hnp1i = high_order_hnp1[i];
       double high_order_hunp1i = high_order_hunp1[i];
@@ -300,255 +507,165 @@ public:
       double one_over_hiReg =
           2 * hi / (hi * hi + std::pow(fmax(hi, hEps), 2)); // hEps
 
-      // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-      for (int offset = csrRowIndeces_DofLoops[i];
-           offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-        int j = csrColumnOffsets_DofLoops[offset];
-
-        if (i != j) {
-          // Read some vectors
-          double hj = h_old[j];
-          double hunj = hu_old[j];
-          double hvnj = hv_old[j];
-          double Zj = b_dof[j];
-          double one_over_hjReg =
-              2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
-
-          // Compute star states
-          double hStarij = fmax(0., hi + Zi - fmax(Zi, Zj));
-          double huStarij = huni * hStarij * one_over_hiReg;
-          double hvStarij = hvni * hStarij * one_over_hiReg;
-
-          double hStarji = fmax(0., hj + Zj - fmax(Zi, Zj));
-          double huStarji = hunj * hStarji * one_over_hjReg;
-          double hvStarji = hvnj * hStarji * one_over_hjReg;
-
-          // i-th row of flux correction matrix
-          double ML_minus_MC = (LUMPED_MASS_MATRIX == 1
-                                    ? 0.
-                                    : (i == j ? 1. : 0.) * mi - MassMatrix[ij]);
-
-          FCT_h[ij] =
-              ML_minus_MC *
-                  (high_order_hnp1[j] - hj - (high_order_hnp1i - hi)) +
-              dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) * (hStarji - hStarij) +
-              dt * muH_minus_muL[ij] * (hj - hi);
-
-          FCT_hu[ij] = ML_minus_MC * (high_order_hunp1[j] - hunj -
-                                      (high_order_hunp1i - huni)) +
-                       dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) *
-                           (huStarji - huStarij) +
-                       dt * muH_minus_muL[ij] * (hunj - huni);
-
-          FCT_hv[ij] = ML_minus_MC * (high_order_hvnp1[j] - hvnj -
-                                      (high_order_hvnp1i - hvni)) +
-                       dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) *
-                           (hvStarji - hvStarij) +
-                       dt * muH_minus_muL[ij] * (hvnj - hvni);
-
-        } else {
-          FCT_h[ij] = 0.0;
-          FCT_hu[ij] = 0.0;
-          FCT_hv[ij] = 0.0;
-        }
-
-        // UPDATE ij //
-        ij += 1;
-      } // j loop ends here
-    }   // i loop ends here
+      double hj = h_old[j];
+      double hunj = hu_old[j];
+      double hvnj = hv_old[j];
+      double Zj = b_dof[j];
+      double one_over_hjReg =
+          2. * hj / (hj * hj + std::pow(fmax(hj, hEps), 2));
+
+      // Compute star states
+      double hStarij = fmax(0., hi + Zi - fmax(Zi, Zj));
+      double huStarij = huni * hStarij * one_over_hiReg;
+      double hvStarij = hvni * hStarij * one_over_hiReg;
+
+      double hStarji = fmax(0., hj + Zj - fmax(Zi, Zj));
+      double huStarji = hunj * hStarji * one_over_hjReg;
+      double hvStarji = hvnj * hStarji * one_over_hjReg;
+
+      // i-th row of flux correction matrix
+      double ML_minus_MC = (LUMPED_MASS_MATRIX == 1
+                                ? 0.
+                                : (i == j ? 1. : 0.) * mi - MassMatrix[ij]);
+
+      FCT_ij[0] =
+          ML_minus_MC * (high_order_hnp1[j] - hj - (high_order_hnp1i - hi)) +
+          dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) * (hStarji - hStarij) +
+          dt * muH_minus_muL[ij] * (hj - hi);
+
+      FCT_ij[1] = ML_minus_MC * (high_order_hunp1[j] - hunj -
+                                 (high_order_hunp1i - huni)) +
+                  dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) *
+                      (huStarji - huStarij) +
+                  dt * muH_minus_muL[ij] * (hunj - huni);
+
+      FCT_ij[2] = ML_minus_MC * (high_order_hvnp1[j] - hvnj -
+                                 (high_order_hvnp1i - hvni)) +
+                  dt * (dH_minus_dL[ij] - muH_minus_muL[ij]) *
+                      (hvStarji - hvStarij) +
+                  dt * muH_minus_muL[ij] * (hvnj - hvni);
+    });
 
     ////////////////////////////////////////////////////////////////////
     // Main loop to define limiters and computed limited solution //////
     ////////////////////////////////////////////////////////////////////
 
-    // Create Lij_array and initialize with 1
-    std::valarray<double> Lij_array(1.0, dH_minus_dL.size());
+    // Initialize the limiters with 1
+    fct.resetLimiter(1.0);
 
     /* Loop over limiting iterations */
     for (int limit_iter = 0; limit_iter < LIMITING_ITERATION; limit_iter++) {
 
-      /* Loop to define FCT Rpos and Rneg values */
-      ij = 0;
+      /* Define FCT Rpos and Rneg values from the bounds on h */
+      fct.computeR(
+          FCT_h,
+          [&](int i, double &Qposi, double &Qnegi) {
+            double mi = lumped_mass_matrix[i];
+            Qnegi = std::min(mi * (h_min[i] - hLow[i]), 0.0);
+            Qposi = std::max(mi * (h_max[i] - hLow[i]), 0.0);
+          },
+          1E-14);
+      // no limited flux at dry states
       for (int i = 0; i < numDOFs; i++) {
-
-        double hi = h_old[i];
-        double mi = lumped_mass_matrix[i];
-        // Initialize Pneg and Ppos quantities at ith node
-        double Pnegi = 0., Pposi = 0.;
-
-        // LOOP OVER THE SPARSITY PATTERN (j-LOOP)
-        for (int offset = csrRowIndeces_DofLoops[i];
-             offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-          int j = csrColumnOffsets_DofLoops[offset];
-
-          // COMPUTE P VECTORS
-          Pnegi += FCT_h[ij] * ((FCT_h[ij] < 0) ? 1. : 0.);
-          Pposi += FCT_h[ij] * ((FCT_h[ij] > 0) ? 1. : 0.);
-
-          // UPDATE ij
-          ij += 1;
-        } // j loop ends here
-
-        double psmall_h = 1E-14 * fmax(fabs(Pnegi), fabs(Pposi));
-
-        ///////////////////////
-        // COMPUTE Q VECTORS //
-        ///////////////////////
-        double Qnegi = std::min(mi * (h_min[i] - hLow[i]), 0.0);
-        double Qposi = std::max(mi * (h_max[i] - hLow[i]), 0.0);
-
-        ///////////////////////
-        // COMPUTE R VECTORS //
-        ///////////////////////
-        if (hi <= hEps) {
-          Rneg[i] = 0.;
-          Rpos[i] = 0.;
-        } else {
-          // for h
-          if (Pnegi >= -psmall_h) {
-            Rneg[i] = 1.0;
-          } else {
-            Rneg[i] = std::min(1.0, Qnegi / Pnegi);
-          }
-          if (Pposi <= psmall_h) {
-            Rpos[i] = 1.0;
-          } else {
-            Rpos[i] = std::min(1.0, Qposi / Pposi);
-          }
+        if (h_old[i] <= hEps) {
+          fct.Rneg[i] = 0.;
+          fct.Rpos[i] = 0.;
         }
-      } // i loop ends here
+      }
 
       /* Here we compute the limiters */
-      ij = 0;
-      for (int i = 0; i < numDOFs; i++) {
+      fct.computeLimiter([&](int i, int j, int ij, double Lij) {
+        // if i = j then lij = 0
+        if (j == i)
+          return 0.;
 
         double mi = lumped_mass_matrix[i];
         double ci =
             kin_max[i] * hLow[i] -
             0.5 * (huLow[i] * huLow[i] + hvLow[i] * hvLow[i]); // for KE lim.
 
-        // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-        for (int offset = csrRowIndeces_DofLoops[i];
-             offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-          int j = csrColumnOffsets_DofLoops[offset];
-
-          if (j != i) {
-
-            // Compute limiter based on water height
-            if (FCT_h[ij] >= 0.) {
-              Lij_array[ij] = fmin(Lij_array[ij], std::min(Rneg[j], Rpos[i]));
-            } else {
-              Lij_array[ij] = fmin(Lij_array[ij], std::min(Rneg[i], Rpos[j]));
-            }
-
-            /*======================================================*/
-            /*            Kinetic Energy limiting                   */
-            double lambdaj =
-                csrRowIndeces_DofLoops[i + 1] - csrRowIndeces_DofLoops[i] - 1;
-            double Ph_ij = FCT_h[ij] / mi / lambdaj;
-            double Phu_ij = FCT_hu[ij] / mi / lambdaj;
-            double Phv_ij = FCT_hv[ij] / mi / lambdaj;
-
-            // Here we initialize limiter based on kinetic energy
-            double KE_limiter = 1;
-            double neg_root_i = 1., neg_root_j = 1.;
-
-            // We first check if local kinetic energy > 0
-            if (kin_max[i] * hLow[i] <= KE_tiny)
-              KE_limiter = 0.;
-
-            // We then check if KE bound is already satisfied
-            double hi_with_lijPij = hLow[i] + Lij_array[ij] * Ph_ij;
-            double hui_with_lijPij = huLow[i] + Lij_array[ij] * Phu_ij;
-            double hvi_with_lijPij = hvLow[i] + Lij_array[ij] * Phv_ij;
-            double psi = kin_max[i] * hi_with_lijPij -
-                         0.5 * (hui_with_lijPij * hui_with_lijPij +
-                                hvi_with_lijPij * hvi_with_lijPij);
-            if (psi > -KE_tiny) {
-              KE_limiter = fmin(KE_limiter, Lij_array[ij]);
-            }
-
-            /*======================================================*/
+        // Compute limiter based on water height
+        if (FCT_h[ij] >= 0.) {
+          Lij = fmin(Lij, std::min(fct.Rneg[j], fct.Rpos[i]));
+        } else {
+          Lij = fmin(Lij, std::min(fct.Rneg[i], fct.Rpos[j]));
+        }
 
-            double ai = -0.5 * (Phu_ij * Phu_ij + Phv_ij * Phv_ij);
-            double bi =
-                kin_max[i] * Ph_ij - (huLow[i] * Phu_ij + hvLow[i] * Phv_ij);
-            double delta_i = bi * bi - 4. * ai * ci;
+        /*======================================================*/
+        /*            Kinetic Energy limiting                   */
+        double lambdaj =
+            csrRowIndeces_DofLoops[i + 1] - csrRowIndeces_DofLoops[i] - 1;
+        double Ph_ij = FCT_h[ij] / mi / lambdaj;
+        double Phu_ij = FCT_hu[ij] / mi / lambdaj;
+        double Phv_ij = FCT_hv[ij] / mi / lambdaj;
+
+        // Here we initialize limiter based on kinetic energy
+        double KE_limiter = 1;
+        double neg_root_i = 1., neg_root_j = 1.;
+
+        // We first check if local kinetic energy > 0
+        if (kin_max[i] * hLow[i] <= KE_tiny)
+          KE_limiter = 0.;
+
+        // We then check if KE bound is already satisfied
+        double hi_with_lijPij = hLow[i] + Lij * Ph_ij;
+        double hui_with_lijPij = huLow[i] + Lij * Phu_ij;
+        double hvi_with_lijPij = hvLow[i] + Lij * Phv_ij;
+        double psi = kin_max[i] * hi_with_lijPij -
+                     0.5 * (hui_with_lijPij * hui_with_lijPij +
+                            hvi_with_lijPij * hvi_with_lijPij);
+        if (psi > -KE_tiny) {
+          KE_limiter = fmin(KE_limiter, Lij);
+        }
 
-            if (delta_i < 0. || ai >= -0.) {
-              KE_limiter = fmin(KE_limiter, Lij_array[ij]);
-            } else {
-              neg_root_i = (-bi - std::sqrt(delta_i)) / 2. / ai;
-            }
+        /*======================================================*/
 
-            // root of jth-DOF (To compute transpose component)
-            double lambdai =
-                csrRowIndeces_DofLoops[j + 1] - csrRowIndeces_DofLoops[j] - 1;
-            double mj = lumped_mass_matrix[j];
-            double cj = kin_max[j] * hLow[j] -
-                        0.5 * (huLow[j] * huLow[j] + hvLow[j] * hvLow[j]);
-            double Ph_ji = -FCT_h[ij] / mj / lambdai; // Aij=-Aji
-            double Phu_ji = -FCT_hu[ij] / mj / lambdai;
-            double Phv_ji = -FCT_hv[ij] / mj / lambdai;
-            double aj = -0.5 * (Phu_ji * Phu_ji + Phv_ji * Phv_ji);
-            double bj =
-                kin_max[j] * Ph_ji - (huLow[j] * Phu_ji + hvLow[j] * Phv_ji);
-            double delta_j = bj * bj - 4. * aj * cj;
-
-            if (delta_j < 0. || aj >= -0.) {
-              KE_limiter = fmin(KE_limiter, Lij_array[ij]);
-            } else {
-              neg_root_j = (-bj - std::sqrt(delta_j)) / 2. / aj;
-            }
+        double ai = -0.5 * (Phu_ij * Phu_ij + Phv_ij * Phv_ij);
+        double bi =
+            kin_max[i] * Ph_ij - (huLow[i] * Phu_ij + hvLow[i] * Phv_ij);
+        double delta_i = bi * bi - 4. * ai * ci;
 
-            // define final limiter based on KE
-            KE_limiter =
-                fmin(KE_limiter, fmin(fabs(neg_root_i), fabs(neg_root_j)));
+        if (delta_i < 0. || ai >= -0.) {
+          KE_limiter = fmin(KE_limiter, Lij);
+        } else {
+          neg_root_i = (-bi - std::sqrt(delta_i)) / 2. / ai;
+        }
 
-            // Here we set final limiter
-            Lij_array[ij] = fmin(KE_limiter, Lij_array[ij]);
+        // root of jth-DOF (To compute transpose component)
+        double lambdai =
+            csrRowIndeces_DofLoops[j + 1] - csrRowIndeces_DofLoops[j] - 1;
+        double mj = lumped_mass_matrix[j];
+        double cj = kin_max[j] * hLow[j] -
+                    0.5 * (huLow[j] * huLow[j] + hvLow[j] * hvLow[j]);
+        double Ph_ji = -FCT_h[ij] / mj / lambdai; // Aij=-Aji
+        double Phu_ji = -FCT_hu[ij] / mj / lambdai;
+        double Phv_ji = -FCT_hv[ij] / mj / lambdai;
+        double aj = -0.5 * (Phu_ji * Phu_ji + Phv_ji * Phv_ji);
+        double bj =
+            kin_max[j] * Ph_ji - (huLow[j] * Phu_ji + hvLow[j] * Phv_ji);
+        double delta_j = bj * bj - 4. * aj * cj;
+
+        if (delta_j < 0. || aj >= -0.) {
+          KE_limiter = fmin(KE_limiter, Lij);
+        } else {
+          neg_root_j = (-bj - std::sqrt(delta_j)) / 2. / aj;
+        }
 
-          } else {
-            // if i = j then lij = 0
-            Lij_array[ij] = 0.;
-          }
+        // define final limiter based on KE
+        KE_limiter = fmin(KE_limiter, fmin(fabs(neg_root_i), fabs(neg_root_j)));
 
-          // update ij
-          ij += 1;
-        } // end j loop
-      }   // end i loop
+        // Here we set final limiter
+        return fmin(KE_limiter, Lij);
+      });
 
       /* Final loop to apply limiting and then define limited solution */
-      ij = 0;
-      for (int i = 0; i < numDOFs; i++) {
-
+      fct.applyLimiter<3>([&](int i, const double *ith_Limiter_times_FCT) {
         double one_over_mi = 1.0 / lumped_mass_matrix[i];
-        double ith_Limiter_times_FluxCorrectionMatrix1 = 0.;
-        double ith_Limiter_times_FluxCorrectionMatrix2 = 0.;
-        double ith_Limiter_times_FluxCorrectionMatrix3 = 0.;
-
-        // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-        for (int offset = csrRowIndeces_DofLoops[i];
-             offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-          int j = csrColumnOffsets_DofLoops[offset];
-
-          // COMPUTE LIMITED FLUX //
-          ith_Limiter_times_FluxCorrectionMatrix1 += Lij_array[ij] * FCT_h[ij];
-          ith_Limiter_times_FluxCorrectionMatrix2 += Lij_array[ij] * FCT_hu[ij];
-          ith_Limiter_times_FluxCorrectionMatrix3 += Lij_array[ij] * FCT_hv[ij];
-
-          // update ij
-          ij += 1;
-        } // end j loop
 
         // then we add lij*Aij to uLow
-        hLow[i] += one_over_mi * ith_Limiter_times_FluxCorrectionMatrix1;
-        huLow[i] += one_over_mi * ith_Limiter_times_FluxCorrectionMatrix2;
-        hvLow[i] += one_over_mi * ith_Limiter_times_FluxCorrectionMatrix3;
+        hLow[i] += one_over_mi * ith_Limiter_times_FCT[0];
+        huLow[i] += one_over_mi * ith_Limiter_times_FCT[1];
+        hvLow[i] += one_over_mi * ith_Limiter_times_FCT[2];
 
         // Finally define the limited solution
         limited_hnp1[i] = hLow[i];
@@ -574,80 +691,47 @@ public:
                               (std::pow(limited_hnp1[i], VEL_FIX_POWER) +
                                std::pow(aux, VEL_FIX_POWER));
         }
-      } // end i loop
+      });
 
       // update FCT matrices as Fct = (1 - Lij)*Fct
-      FCT_h = (1.0 - Lij_array) * FCT_h;
-      FCT_hu = (1.0 - Lij_array) * FCT_hu;
-      FCT_hv = (1.0 - Lij_array) * FCT_hv;
+      fct.reduceFlux(3);
     } // end loop for limiting iteration
   }   // end convex limiting function
 
   double calculateEdgeBasedCFL(arguments_dict &args) {
-    double g = args.scalar<double>("g");
-    int numDOFsPerEqn = args.scalar<int>("numDOFsPerEqn");
-    xt::pyarray<double> &lumped_mass_matrix =
-        args.array<double>("lumped_mass_matrix");
-    xt::pyarray<double> &h_dof_old = args.array<double>("h_dof_old");
-    xt::pyarray<double> &hu_dof_old = args.array<double>("hu_dof_old");
-    xt::pyarray<double> &hv_dof_old = args.array<double>("hv_dof_old");
-    xt::pyarray<double> &b_dof = args.array<double>("b_dof");
-    xt::pyarray<int> &csrRowIndeces_DofLoops =
-        args.array<int>("csrRowIndeces_DofLoops");
-    xt::pyarray<int> &csrColumnOffsets_DofLoops =
-        args.array<int>("csrColumnOffsets_DofLoops");
-    double hEps = args.scalar<double>("hEps");
-    xt::pyarray<double> &Cx = args.array<double>("Cx");
-    xt::pyarray<double> &Cy = args.array<double>("Cy");
-    xt::pyarray<double> &CTx = args.array<double>("CTx");
-    xt::pyarray<double> &CTy = args.array<double>("CTy");
-    xt::pyarray<double> &dLow = args.array<double>("dLow");
-    double run_cfl = args.scalar<double>("run_cfl");
-    xt::pyarray<double> &edge_based_cfl = args.array<double>("edge_based_cfl");
-    int debug = args.scalar<int>("debug");
+    PROTEUS_ARGUMENT_LOCALS(SW2DCV_EDGE_BASED_CFL_ARGUMENTS,
+                            edgeBasedCFLArguments(args));
 
     double max_edge_based_cfl = 0.;
 
-    int ij = 0;
+    ////////////////////////
+    // DISSIPATIVE MATRIX //
+    ////////////////////////
+    // dLow is symmetric, compute it once per edge
+    edges.setPattern(numDOFsPerEqn, csrRowIndeces_DofLoops.data(),
+                     csrColumnOffsets_DofLoops.data());
+    edges.symmetricFill(dLow.data(), [&](int i, int j, int ij, int ji) {
+      double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
+      double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
+      double nxij = Cx[ij] / cij_norm, nyij = Cy[ij] / cij_norm;
+      double nxji = CTx[ij] / cji_norm, nyji = CTy[ij] / cji_norm;
+      return fmax(maxWaveSpeedSharpInitialGuess(
+                      g, nxij, nyij, h_dof_old[i], hu_dof_old[i],
+                      hv_dof_old[i], h_dof_old[j], hu_dof_old[j],
+                      hv_dof_old[j], hEps, debug) *
+                      cij_norm, // hEps
+                  maxWaveSpeedSharpInitialGuess(
+                      g, nxji, nyji, h_dof_old[j], hu_dof_old[j],
+                      hv_dof_old[j], h_dof_old[i], hu_dof_old[i],
+                      hv_dof_old[i], hEps, debug) *
+                      cji_norm); // hEps
+    });
+
     for (int i = 0; i < numDOFsPerEqn; i++) {
-      // solution at time tn for the ith DOF
-      double hi = h_dof_old[i];
-      double hui = hu_dof_old[i];
-      double hvi = hv_dof_old[i];
       double dLowii = 0.;
-
-      for (int offset = csrRowIndeces_DofLoops[i];
-           offset < csrRowIndeces_DofLoops[i + 1]; offset++) {
-
-        // loop in j (sparsity pattern)
-        int j = csrColumnOffsets_DofLoops[offset];
-
-        // solution at time tn for the jth DOF
-        double hj = h_dof_old[j];
-        double huj = hu_dof_old[j];
-        double hvj = hv_dof_old[j];
-
-        if (i != j) {
-          ////////////////////////
-          // DISSIPATIVE MATRIX //
-          ////////////////////////
-          double cij_norm = sqrt(Cx[ij] * Cx[ij] + Cy[ij] * Cy[ij]);
-          double cji_norm = sqrt(CTx[ij] * CTx[ij] + CTy[ij] * CTy[ij]);
-          double nxij = Cx[ij] / cij_norm, nyij = Cy[ij] / cij_norm;
-          double nxji = CTx[ij] / cji_norm, nyji = CTy[ij] / cji_norm;
-          dLow[ij] =
-              fmax(maxWaveSpeedSharpInitialGuess(g, nxij, nyij, hi, hui, hvi,
-                                                 hj, huj, hvj, hEps, debug) *
-                       cij_norm, // hEps
-                   maxWaveSpeedSharpInitialGuess(g, nxji, nyji, hj, huj, hvj,
-                                                 hi, hui, hvi, hEps, debug) *
-                       cji_norm); // hEps
-          dLowii -= dLow[ij];
-        } else
-          dLow[ij] = 0.;
-        // update ij
-        ij += 1;
-      }
+      for (int ij = csrRowIndeces_DofLoops[i];
+           ij < csrRowIndeces_DofLoops[i + 1]; ij++)
+        dLowii -= dLow[ij];
       //////////////////////////////
       // CALCULATE EDGE BASED CFL //
       //////////////////////////////
@@ -659,27 +743,8 @@ public:
   } // End calculateEdgeBasedCFL
 
   void calculateEV(arguments_dict &args) {
-    double g = args.scalar<double>("g");
-    xt::pyarray<double> &h_dof_old = args.array<double>("h_dof_old");
-    xt::pyarray<double> &hu_dof_old = args.array<double>("hu_dof_old");
-    xt::pyarray<double> &hv_dof_old = args.array<double>("hv_dof_old");
-    xt::pyarray<double> &b_dof = args.array<double>("b_dof");
-    xt::pyarray<double> &Cx = args.array<double>("Cx");
-    xt::pyarray<double> &Cy = args.array<double>("Cy");
-    xt::pyarray<double> &CTx = args.array<double>("CTx");
-    xt::pyarray<double> &CTy = args.array<double>("CTy");
-    int numDOFsPerEqn = args.scalar<int>("numDOFsPerEqn");
-    xt::pyarray<int> &csrRowIndeces_DofLoops =
-        args.array<int>("csrRowIndeces_DofLoops");
-    xt::pyarray<int> &csrColumnOffsets_DofLoops =
-        args.array<int>("csrColumnOffsets_DofLoops");
-    xt::pyarray<double> &lumped_mass_matrix =
-        args.array<double>("lumped_mass_matrix");
-    double eps = args.scalar<double>("eps");
-    double hEps = args.scalar<double>("hEps");
-    xt::pyarray<double> &global_entropy_residual =
-        args.array<double>("global_entropy_residual");
-    double &dij_small = args.scalar<double>("dij_small");
+    PROTEUS_ARGUMENT_LOCALS(SW2DCV_EV_ARGUMENTS,
+                            evArguments(args));
 
     //////////////////////////////////////////////
     // ********** FIRST LOOP ON DOFs ********** //
@@ -687,7 +752,7 @@ public:
 
     // To compute:
     //     * Entropy at i-th node
-    std::valarray<double> eta(numDOFsPerEqn);
+    double *eta = work.array(ETA, numDOFsPerEqn);
     for (int i = 0; i < numDOFsPerEqn; i++) {
       // COMPUTE ENTROPY. NOTE: WE CONSIDER A FLAT BOTTOM
       double hi = h_dof_old[i];
@@ -706,7 +771,6 @@ public:
     //     * dij_small to avoid division by 0
 
     int ij = 0;
-    std::valarray<double> etaMax(numDOFsPerEqn), etaMin(numDOFsPerEqn);
 
     // speed = sqrt(g max(h_0)), I divide by h_epsilon to get max(h_0)
     double speed = std::sqrt(g * hEps / eps);
@@ -728,8 +792,8 @@ public:
       double mi = lumped_mass_matrix[i];
 
       // initialize etaMax and etaMin
-      etaMax[i] = fabs(eta[i]);
-      etaMin[i] = fabs(eta[i]);
+      double etaMax = fabs(eta[i]);
+      double etaMin = fabs(eta[i]);
 
       // FOR ENTROPY RESIDUAL, NOTE: FLAT BOTTOM //
       double ith_flux_term1 = 0., ith_flux_term2 = 0., ith_flux_term3 = 0.;
@@ -776,8 +840,8 @@ public:
              Cy[ij] * ENTROPY_FLUX2(g, hj, huj, hvj, 0., one_over_hjReg));
 
         // COMPUTE ETA MIN AND ETA MAX //
-        etaMax[i] = fmax(etaMax[i], fabs(eta[j]));
-        etaMin[i] = fmin(etaMin[i], fabs(eta[j]));
+        etaMax = fmax(etaMax, fabs(eta[j]));
+        etaMin = fmin(etaMin, fabs(eta[j]));
 
         // define dij_small in j loop
         double x = fabs(Cx[ij]) + fabs(Cy[ij]);
@@ -794,7 +858,7 @@ public:
 
       // define rescale for normalization
       double small_rescale = g * hEps * hEps / eps;
-      double rescale = fmax(fabs(etaMax[i] - etaMin[i]) / 2., small_rescale);
+      double rescale = fmax(fabs(etaMax - etaMin) / 2., small_rescale);
 
       // COMPUTE ENTROPY RESIDUAL //
       double one_over_entNormFactori = 1.0 / rescale;
@@ -811,180 +875,8 @@ public:
   } // end calculateEV
 
   void calculateResidual(arguments_dict &args) {
-    xt::pyarray<double> &mesh_trial_ref = args.array<double>("mesh_trial_ref");
-    xt::pyarray<double> &mesh_grad_trial_ref =
-        args.array<double>("mesh_grad_trial_ref");
-    xt::pyarray<double> &mesh_dof = args.array<double>("mesh_dof");
-    xt::pyarray<int> &mesh_l2g = args.array<int>("mesh_l2g");
-    xt::pyarray<double> &dV_ref = args.array<double>("dV_ref");
-    xt::pyarray<double> &h_trial_ref = args.array<double>("h_trial_ref");
-    xt::pyarray<double> &h_grad_trial_ref =
-        args.array<double>("h_grad_trial_ref");
-    xt::pyarray<double> &h_test_ref = args.array<double>("h_test_ref");
-    xt::pyarray<double> &h_grad_test_ref =
-        args.array<double>("h_grad_test_ref");
-    xt::pyarray<double> &vel_trial_ref = args.array<double>("vel_trial_ref");
-    xt::pyarray<double> &vel_grad_trial_ref =
-        args.array<double>("vel_grad_trial_ref");
-    xt::pyarray<double> &vel_test_ref = args.array<double>("vel_test_ref");
-    xt::pyarray<double> &vel_grad_test_ref =
-        args.array<double>("vel_grad_test_ref");
-    xt::pyarray<double> &mesh_trial_trace_ref =
-        args.array<double>("mesh_trial_trace_ref");
-    xt::pyarray<double> &mesh_grad_trial_trace_ref =
-        args.array<double>("mesh_grad_trial_trace_ref");
-    xt::pyarray<double> &h_trial_trace_ref =
-        args.array<double>("h_trial_trace_ref");
-    xt::pyarray<double> &h_grad_trial_trace_ref =
-        args.array<double>("h_grad_trial_trace_ref");
-    xt::pyarray<double> &h_test_trace_ref =
-        args.array<double>("h_test_trace_ref");
-    xt::pyarray<double> &h_grad_test_trace_ref =
-        args.array<double>("h_grad_test_trace_ref");
-    xt::pyarray<double> &vel_trial_trace_ref =
-        args.array<double>("vel_trial_trace_ref");
-    xt::pyarray<double> &vel_grad_trial_trace_ref =
-        args.array<double>("vel_grad_trial_trace_ref");
-    xt::pyarray<double> &vel_test_trace_ref =
-        args.array<double>("vel_test_trace_ref");
-    xt::pyarray<double> &vel_grad_test_trace_ref =
-        args.array<double>("vel_grad_test_trace_ref");
-    xt::pyarray<double> &normal_ref = args.array<double>("normal_ref");
-    xt::pyarray<double> &boundaryJac_ref =
-        args.array<double>("boundaryJac_ref");
-    xt::pyarray<double> &elementDiameter =
-        args.array<double>("elementDiameter");
-    int nElements_global = args.scalar<int>("nElements_global");
-    double g = args.scalar<double>("g");
-    xt::pyarray<int> &h_l2g = args.array<int>("h_l2g");
-    xt::pyarray<int> &vel_l2g = args.array<int>("vel_l2g");
-    xt::pyarray<double> &h_dof_old = args.array<double>("h_dof_old");
-    xt::pyarray<double> &hu_dof_old = args.array<double>("hu_dof_old");
-    xt::pyarray<double> &hv_dof_old = args.array<double>("hv_dof_old");
-    xt::pyarray<double> &b_dof = args.array<double>("b_dof");
-    xt::pyarray<double> &h_dof = args.array<double>("h_dof");
-    xt::pyarray<double> &hu_dof = args.array<double>("hu_dof");
-    xt::pyarray<double> &hv_dof = args.array<double>("hv_dof");
-    xt::pyarray<double> &q_cfl = args.array<double>("q_cfl");
-    xt::pyarray<int> &sdInfo_hu_hu_rowptr =
-        args.array<int>("sdInfo_hu_hu_rowptr");
-    xt::pyarray<int> &sdInfo_hu_hu_colind =
-        args.array<int>("sdInfo_hu_hu_colind");
-    xt::pyarray<int> &sdInfo_hu_hv_rowptr =
-        args.array<int>("sdInfo_hu_hv_rowptr");
-    xt::pyarray<int> &sdInfo_hu_hv_colind =
-        args.array<int>("sdInfo_hu_hv_colind");
-    xt::pyarray<int> &sdInfo_hv_hv_rowptr =
-        args.array<int>("sdInfo_hv_hv_rowptr");
-    xt::pyarray<int> &sdInfo_hv_hv_colind =
-        args.array<int>("sdInfo_hv_hv_colind");
-    xt::pyarray<int> &sdInfo_hv_hu_rowptr =
-        args.array<int>("sdInfo_hv_hu_rowptr");
-    xt::pyarray<int> &sdInfo_hv_hu_colind =
-        args.array<int>("sdInfo_hv_hu_colind");
-    int offset_h = args.scalar<int>("offset_h");
-    int offset_hu = args.scalar<int>("offset_hu");
-    int offset_hv = args.scalar<int>("offset_hv");
-    int stride_h = args.scalar<int>("stride_h");
-    int stride_hu = args.scalar<int>("stride_hu");
-    int stride_hv = args.scalar<int>("stride_hv");
-    xt::pyarray<double> &globalResidual = args.array<double>("globalResidual");
-    int nExteriorElementBoundaries_global =
-        args.scalar<int>("nExteriorElementBoundaries_global");
-    xt::pyarray<int> &exteriorElementBoundariesArray =
-        args.array<int>("exteriorElementBoundariesArray");
-    xt::pyarray<int> &elementBoundaryElementsArray =
-        args.array<int>("elementBoundaryElementsArray");
-    xt::pyarray<int> &elementBoundaryLocalElementBoundariesArray =
-        args.array<int>("elementBoundaryLocalElementBoundariesArray");
-    xt::pyarray<int> &isDOFBoundary_h = args.array<int>("isDOFBoundary_h");
-    xt::pyarray<int> &isDOFBoundary_hu = args.array<int>("isDOFBoundary_hu");
-    xt::pyarray<int> &isDOFBoundary_hv = args.array<int>("isDOFBoundary_hv");
-    xt::pyarray<int> &isAdvectiveFluxBoundary_h =
-        args.array<int>("isAdvectiveFluxBoundary_h");
-    xt::pyarray<int> &isAdvectiveFluxBoundary_hu =
-        args.array<int>("isAdvectiveFluxBoundary_hu");
-    xt::pyarray<int> &isAdvectiveFluxBoundary_hv =
-        args.array<int>("isAdvectiveFluxBoundary_hv");
-    xt::pyarray<int> &isDiffusiveFluxBoundary_hu =
-        args.array<int>("isDiffusiveFluxBoundary_hu");
-    xt::pyarray<int> &isDiffusiveFluxBoundary_hv =
-        args.array<int>("isDiffusiveFluxBoundary_hv");
-    xt::pyarray<double> &ebqe_bc_h_ext = args.array<double>("ebqe_bc_h_ext");
-    xt::pyarray<double> &ebqe_bc_flux_mass_ext =
-        args.array<double>("ebqe_bc_flux_mass_ext");
-    xt::pyarray<double> &ebqe_bc_flux_mom_hu_adv_ext =
-        args.array<double>("ebqe_bc_flux_mom_hu_adv_ext");
-    xt::pyarray<double> &ebqe_bc_flux_mom_hv_adv_ext =
-        args.array<double>("ebqe_bc_flux_mom_hv_adv_ext");
-    xt::pyarray<double> &ebqe_bc_hu_ext = args.array<double>("ebqe_bc_hu_ext");
-    xt::pyarray<double> &ebqe_bc_flux_hu_diff_ext =
-        args.array<double>("ebqe_bc_flux_hu_diff_ext");
-    xt::pyarray<double> &ebqe_penalty_ext =
-        args.array<double>("ebqe_penalty_ext");
-    xt::pyarray<double> &ebqe_bc_hv_ext = args.array<double>("ebqe_bc_hv_ext");
-    xt::pyarray<double> &ebqe_bc_flux_hv_diff_ext =
-        args.array<double>("ebqe_bc_flux_hv_diff_ext");
-    xt::pyarray<double> &q_velocity = args.array<double>("q_velocity");
-    xt::pyarray<double> &ebqe_velocity = args.array<double>("ebqe_velocity");
-    xt::pyarray<double> &flux = args.array<double>("flux");
-    xt::pyarray<double> &elementResidual_h =
-        args.array<double>("elementResidual_h");
-    xt::pyarray<double> &Cx = args.array<double>("Cx");
-    xt::pyarray<double> &Cy = args.array<double>("Cy");
-    xt::pyarray<double> &CTx = args.array<double>("CTx");
-    xt::pyarray<double> &CTy = args.array<double>("CTy");
-    int numDOFsPerEqn = args.scalar<int>("numDOFsPerEqn");
-    int NNZ = args.scalar<int>("NNZ");
-    xt::pyarray<int> &csrRowIndeces_DofLoops =
-        args.array<int>("csrRowIndeces_DofLoops");
-    xt::pyarray<int> &csrColumnOffsets_DofLoops =
-        args.array<int>("csrColumnOffsets_DofLoops");
-    xt::pyarray<double> &lumped_mass_matrix =
-        args.array<double>("lumped_mass_matrix");
-    double cfl_run = args.scalar<double>("cfl_run");
-    double eps = args.scalar<double>("eps");
-    double hEps = args.scalar<double>("hEps");
-    xt::pyarray<double> &hnp1_at_quad_point =
-        args.array<double>("hnp1_at_quad_point");
-    xt::pyarray<double> &hunp1_at_quad_point =
-        args.array<double>("hunp1_at_quad_point");
-    xt::pyarray<double> &hvnp1_at_quad_point =
-        args.array<double>("hvnp1_at_quad_point");
-    xt::pyarray<double> &extendedSourceTerm_hu =
-        args.array<double>("extendedSourceTerm_hu");
-    xt::pyarray<double> &extendedSourceTerm_hv =
-        args.array<double>("extendedSourceTerm_hv");
-    xt::pyarray<double> &dH_minus_dL = args.array<double>("dH_minus_dL");
-    xt::pyarray<double> &muH_minus_muL = args.array<double>("muH_minus_muL");
-    double cE = args.scalar<double>("cE");
-    int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
-    double dt = args.scalar<double>("dt");
-    int LINEAR_FRICTION = args.scalar<int>("LINEAR_FRICTION");
-    double mannings = args.scalar<double>("mannings");
-    xt::pyarray<double> &quantDOFs = args.array<double>("quantDOFs");
-    int SECOND_CALL_CALCULATE_RESIDUAL =
-        args.scalar<int>("SECOND_CALL_CALCULATE_RESIDUAL");
-    int COMPUTE_NORMALS = args.scalar<int>("COMPUTE_NORMALS");
-    xt::pyarray<double> &normalx = args.array<double>("normalx");
-    xt::pyarray<double> &normaly = args.array<double>("normaly");
-    xt::pyarray<double> &dLow = args.array<double>("dLow");
-    int lstage = args.scalar<int>("lstage");
-    xt::pyarray<double> &new_SourceTerm_hu =
-        args.array<double>("new_SourceTerm_hu");
-    xt::pyarray<double> &new_SourceTerm_hv =
-        args.array<double>("new_SourceTerm_hv");
-    xt::pyarray<double> &global_entropy_residual =
-        args.array<double>("global_entropy_residual");
-    double dij_small = args.scalar<double>("dij_small");
-    xt::pyarray<double> &hLow = args.array<double>("hLow");
-    xt::pyarray<double> &huLow = args.array<double>("huLow");
-    xt::pyarray<double> &hvLow = args.array<double>("hvLow");
-    xt::pyarray<double> &h_min = args.array<double>("h_min");
-    xt::pyarray<double> &h_max = args.array<double>("h_max");
-    xt::pyarray<double> &kin_max = args.array<double>("kin_max");
-    xt::pyarray<double> &urelax = args.array<double>("urelax");
-    xt::pyarray<double> &drelax = args.array<double>("drelax");
+    PROTEUS_ARGUMENT_LOCALS(SW2DCV_RESIDUAL_ARGUMENTS,
+                            residualArguments(args));
     // FOR FRICTION//
     double n2 = std::pow(mannings, 2.);
     double gamma = 4. / 3;
@@ -1089,16 +981,20 @@ public:
       //     * Low order solution (in terms of bar states)
 
       // Here we declare some arrays for local bounds
-      std::valarray<double> delta_Sqd_h(0.0, numDOFsPerEqn),
-          bar_deltaSqd_h(0.0, numDOFsPerEqn), delta_Sqd_kin(0.0, numDOFsPerEqn),
-          bar_deltaSqd_kin(0.0, numDOFsPerEqn);
-      xt::pyarray<double> kin(numDOFsPerEqn), max_of_h_and_hEps(numDOFsPerEqn);
+      double *delta_Sqd_h = work.array(DELTA_SQD_H, numDOFsPerEqn, 0.0),
+             *bar_deltaSqd_h = work.array(BAR_DELTASQD_H, numDOFsPerEqn, 0.0),
+             *delta_Sqd_kin = work.array(DELTA_SQD_KIN, numDOFsPerEqn, 0.0),
+             *bar_deltaSqd_kin = work.array(BAR_DELTASQD_KIN, numDOFsPerEqn, 0.0),
+             *kin = work.array(KIN, numDOFsPerEqn);
 
       // Define kinetic energy, kin = 1/2 q^2 / h
-      max_of_h_and_hEps = xt::where(h_dof_old > hEps, h_dof_old, hEps);
-      kin = 0.5 * (hu_dof_old * hu_dof_old + hv_dof_old * hv_dof_old);
-      kin *= 2.0 * h_dof_old /
-             (h_dof_old * h_dof_old + max_of_h_and_hEps * max_of_h_and_hEps);
+      for (int i = 0; i < numDOFsPerEqn; i++) {
+        double hi = h_dof_old[i];
+        double max_of_h_and_hEps = hi > hEps ? hi : hEps;
+        kin[i] = 0.5 * (hu_dof_old[i] * hu_dof_old[i] +
+                        hv_dof_old[i] * hv_dof_old[i]);
+        kin[i] *= 2.0 * hi / (hi * hi + max_of_h_and_hEps * max_of_h_and_hEps);
+      }
 
       /* First loop to define: delta_Sqd_h, delta_Sqd_kin */
       for (int i = 0; i < numDOFsPerEqn; i++) {
@@ -1116,8 +1012,10 @@ public:
       }   // i loops ends here
 
       // Stuff for bar states here (BT = BarTilde)
-      std::valarray<double> hBT(0.0, dH_minus_dL.size()),
-          huBT(0.0, dH_minus_dL.size()), hvBT(0.0, dH_minus_dL.size());
+      // (every entry is set in the loop below)
+      double *hBT = work.array(H_BT, dH_minus_dL.size()),
+             *huBT = work.array(HU_BT, dH_minus_dL.size()),
+             *hvBT = work.array(HV_BT, dH_minus_dL.size());
 
       /* Second loop to compute bar states (variable)BT */
       int ij = 0;
@@ -1311,10 +1209,7 @@ public:
         // limiting paper
         kin_max[i] = std::min(urelax[i] * kin_max[i],
                               kin_max[i] + std::abs(bar_deltaSqd_kin[i]));
-        h_min[i] = std::max(drelax[i] * h_min[i],
-                            h_min[i] - std::abs(bar_deltaSqd_h[i]));
-        h_max[i] = std::min(urelax[i] * h_max[i],
-                            h_max[i] + std::abs(bar_deltaSqd_h[i]));
+        relaxBounds(drelax[i], urelax[i], bar_deltaSqd_h[i], h_min[i], h_max[i]);
 
         // clean up hLow from round off error
         if (hLow[i] < hEps)
@@ -1330,9 +1225,10 @@ public:
       //     * Smoothness indicator
 
       ij = 0;
-      std::valarray<double> hyp_flux_h(numDOFsPerEqn),
-          hyp_flux_hu(numDOFsPerEqn), hyp_flux_hv(numDOFsPerEqn),
-          psi(numDOFsPerEqn), etaMax(numDOFsPerEqn), etaMin(numDOFsPerEqn);
+      double *hyp_flux_h = work.array(HYP_FLUX_H, numDOFsPerEqn),
+             *hyp_flux_hu = work.array(HYP_FLUX_HU, numDOFsPerEqn),
+             *hyp_flux_hv = work.array(HYP_FLUX_HV, numDOFsPerEqn),
+             *psi = work.array(PSI, numDOFsPerEqn);
 
       for (int i = 0; i < numDOFsPerEqn; i++) {
         // solution at time tn for the ith DOF
@@ -1679,6 +1575,125 @@ public:
     // ********** END OF COMPUTING NORMALS ********** //
   } // end calculateResidual
 
+  /* Takes up to nSteps steps of the SSP Runge-Kutta method, stopping at
+     tOut, with the calls and updates the lumped mass matrix solver, RKEV and
+     the step controller make in Python for each step. args holds the
+     arguments of calculateResidual, calculateEV, convexLimiting and
+     calculateEdgeBasedCFL together with the time integration state, which
+     is updated in place. Returns the number of steps taken. */
+  int advanceSSP(arguments_dict &args) {
+    int nSteps = args.scalar<int>("nSteps");
+    int timeOrder = args.scalar<int>("timeOrder");
+    double tOut = args.scalar<double>("tOut");
+    double &t = args.scalar<double>("t");
+    double &dt = args.scalar<double>("dt");
+    double &dtLast = args.scalar<double>("dtLast");
+    double dtRatioMax = args.scalar<double>("dtRatioMax");
+    double run_cfl = args.scalar<double>("run_cfl");
+    double eps = args.scalar<double>("eps");
+    double hEps = args.scalar<double>("hEps");
+    int &lstage = args.scalar<int>("lstage");
+    int &SECOND_CALL_CALCULATE_RESIDUAL =
+        args.scalar<int>("SECOND_CALL_CALCULATE_RESIDUAL");
+    int &check_positivity_water_height =
+        args.scalar<int>("check_positivity_water_height");
+    double &KE_tiny = args.scalar<double>("KE_tiny");
+    int numDOFsPerEqn = args.scalar<int>("numDOFsPerEqn");
+    int offset[3] = {args.scalar<int>("offset_h"), args.scalar<int>("offset_hu"),
+                     args.scalar<int>("offset_hv")};
+    int stride[3] = {args.scalar<int>("stride_h"), args.scalar<int>("stride_hu"),
+                     args.scalar<int>("stride_hv")};
+    xt::pyarray<double> &u = args.array<double>("u");
+    xt::pyarray<double> &globalResidual = args.array<double>("globalResidual");
+    xt::pyarray<double> &kin_max = args.array<double>("kin_max");
+    xt::pyarray<double> &normalx = args.array<double>("normalx");
+    xt::pyarray<double> &normaly = args.array<double>("normaly");
+    xt::pyarray<int> &reflectingIndex = args.array<int>("reflectingIndex");
+    double *dof[3] = {args.array<double>("h_dof").data(),
+                      args.array<double>("hu_dof").data(),
+                      args.array<double>("hv_dof").data()};
+    double *dof_old[3] = {args.array<double>("h_dof_old").data(),
+                          args.array<double>("hu_dof_old").data(),
+                          args.array<double>("hv_dof_old").data()};
+    double *dof_last[3] = {args.array<double>("h_dof_last").data(),
+                           args.array<double>("hu_dof_last").data(),
+                           args.array<double>("hv_dof_last").data()};
+    double *dof_lstage[3] = {args.array<double>("h_dof_lstage").data(),
+                             args.array<double>("hu_dof_lstage").data(),
+                             args.array<double>("hv_dof_lstage").data()};
+    double *high_order[3] = {args.array<double>("high_order_hnp1").data(),
+                             args.array<double>("high_order_hunp1").data(),
+                             args.array<double>("high_order_hvnp1").data()};
+    double *limited[3] = {args.array<double>("limited_hnp1").data(),
+                          args.array<double>("limited_hunp1").data(),
+                          args.array<double>("limited_hvnp1").data()};
+    const int nReflecting = reflectingIndex.size();
+
+    SSPStepper<3> ssp(timeOrder, numDOFsPerEqn,
+                      work.array(SSP_TMP, numDOFsPerEqn));
+    // the DOFs of the global vector, with the reflecting conditions applied
+    auto setUnknowns = [&]() {
+      for (int c = 0; c < 3; c++)
+        gatherComponent(u.data(), offset[c], stride[c], numDOFsPerEqn, dof[c]);
+      reflectDischarge(reflectingIndex.data(), nReflecting, normalx.data(),
+                       normaly.data(), dof[1], dof[2]);
+      if (check_positivity_water_height)
+        checkWaterHeight(dof[0], numDOFsPerEqn, eps);
+    };
+    int step = 0;
+    for (; step < nSteps && t < tOut; step++) {
+      dt = SSPStepper<3>::stepExact(t, dt, tOut);
+      for (int c = 0; c < 3; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_old[c]);
+      for (lstage = 0; lstage < timeOrder;) {
+        // high order solution
+        setUnknowns();
+        calculateEV(args);
+        std::fill(globalResidual.begin(), globalResidual.end(), 0.0);
+        SECOND_CALL_CALCULATE_RESIDUAL = 0;
+        calculateResidual(args);
+        for (int k = 0; k < nReflecting; k++)
+          for (int c = 1; c < 3; c++)
+            globalResidual[offset[c] + stride[c] * reflectingIndex[k]] = 0.;
+        std::copy(globalResidual.begin(), globalResidual.end(), u.begin());
+        // convex limiting
+        KE_tiny = hEps * (*std::max_element(kin_max.begin(), kin_max.end()));
+        for (int c = 0; c < 3; c++) {
+          gatherComponent(u.data(), offset[c], stride[c], numDOFsPerEqn,
+                          high_order[c]);
+          std::fill(limited[c], limited[c] + numDOFsPerEqn, 0.0);
+        }
+        convexLimiting(args);
+        for (int c = 0; c < 3; c++)
+          scatterComponent(limited[c], offset[c], stride[c], numDOFsPerEqn,
+                           u.data());
+        // update the solution; the quantities at the quadrature points are
+        // only needed at the end of the step
+        setUnknowns();
+        if (lstage == timeOrder - 1) {
+          std::fill(globalResidual.begin(), globalResidual.end(), 0.0);
+          SECOND_CALL_CALCULATE_RESIDUAL = 1;
+          calculateResidual(args);
+        }
+        check_positivity_water_height = 1;
+        lstage++;
+        ssp.updateStage(lstage, dof, dof_old, dof_last, dof_lstage, true);
+      }
+      lstage = 0;
+      t += dt;
+      for (int c = 0; c < 3; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_last[c]);
+      dtLast = dt;
+      // the next step starts from the current solution, which is also what
+      // the CFL number is computed from
+      for (int c = 0; c < 3; c++)
+        std::copy(dof[c], dof[c] + numDOFsPerEqn, dof_old[c]);
+      dt = SSPStepper<3>::chooseDt(run_cfl, calculateEdgeBasedCFL(args),
+                                   dtLast, dtRatioMax);
+    }
+    return step;
+  } // end advanceSSP
+
   void calculateMassMatrix(arguments_dict &args) {
     xt::pyarray<double> &mesh_trial_ref = args.array<double>("mesh_trial_ref");
     xt::pyarray<double> &mesh_grad_trial_ref =
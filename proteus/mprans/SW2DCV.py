@@ -202,6 +202,10 @@ class RKEV(proteus.TimeIntegration.SSP):
         self.lstage = 0
         self.dtLast = self.dt
         self.tLast = self.t
+        # scratch the kernels (re)allocated during the step, zero once the sizes have settled
+        self.transport.kernelAllocations = self.transport.sw2d.getAllocationCount()
+        self.transport.sw2d.resetAllocationCount()
+        logEvent("SW2DCV kernel scratch allocations in step: %d" % self.transport.kernelAllocations, level=4)
 
     def generateSubsteps(self, tList):
         """
@@ -852,6 +856,11 @@ class LevelModel(proteus.Transport.OneLevelTransport):
             self.calculateJacobian = self.sw2d.calculateLumpedMassMatrix
         else:
             self.calculateJacobian = self.sw2d.calculateMassMatrix
+        # the arguments of the stage kernels, kept across calls so the
+        # kernels look them up only when the dict is replaced
+        self.fctArgumentsDict = cArgumentsDict.ArgumentsDict()
+        self.evArgumentsDict = cArgumentsDict.ArgumentsDict()
+        self.residualArgumentsDict = cArgumentsDict.ArgumentsDict()
         #
         self.dofsXCoord = None
         self.dofsYCoord = None
@@ -873,7 +882,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
     def FCTStep(self):
         # NOTE: this function is meant to be called within the solver
         comm = Comm.get()
-        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         # Extract hnp1 from global solution u
         index = list(range(0, len(self.timeIntegration.u)))
         hIndex = index[0::3]
@@ -886,23 +894,40 @@ class LevelModel(proteus.Transport.OneLevelTransport):
 
         self.KE_tiny = self.hEps * comm.globalMax(np.amax(self.kin_max))
 
-        argsDict = cArgumentsDict.ArgumentsDict()
+        argsDict = self.fctArgumentsDict
+        self.setFCTArguments(argsDict,
+                             (self.timeIntegration.u[hIndex],
+                              self.timeIntegration.u[huIndex],
+                              self.timeIntegration.u[hvIndex]),
+                             (limited_hnp1, limited_hunp1, limited_hvnp1))
+        self.sw2d.convexLimiting(argsDict)
+
+        # Pass the post processed hnp1 solution to global solution u
+        self.timeIntegration.u[hIndex] = limited_hnp1
+        self.timeIntegration.u[huIndex] = limited_hunp1
+        self.timeIntegration.u[hvIndex] = limited_hvnp1
+
+    def setFCTArguments(self, argsDict, high_order, limited):
+        """
+        Put the arguments of convexLimiting into argsDict, limiting the (h, hu, hv) arrays high_order into limited
+        """
         argsDict["dt"] = self.timeIntegration.dt
         argsDict["NNZ"] = self.nnz
+        rowptr, colind, MassMatrix = self.MC_global.getCSRrepresentation()
         argsDict["numDOFs"] = len(rowptr) - 1
         argsDict["lumped_mass_matrix"] = self.ML
         argsDict["h_old"] = self.h_dof_old
         argsDict["hu_old"] = self.hu_dof_old
         argsDict["hv_old"] = self.hv_dof_old
         argsDict["b_dof"] = self.coefficients.b.dof
-        argsDict["high_order_hnp1"] = self.timeIntegration.u[hIndex]
-        argsDict["high_order_hunp1"] = self.timeIntegration.u[huIndex]
-        argsDict["high_order_hvnp1"] = self.timeIntegration.u[hvIndex]
+        argsDict["high_order_hnp1"] = high_order[0]
+        argsDict["high_order_hunp1"] = high_order[1]
+        argsDict["high_order_hvnp1"] = high_order[2]
         argsDict["extendedSourceTerm_hu"] = self.extendedSourceTerm_hu
         argsDict["extendedSourceTerm_hv"] = self.extendedSourceTerm_hv
-        argsDict["limited_hnp1"] = limited_hnp1
-        argsDict["limited_hunp1"] = limited_hunp1
-        argsDict["limited_hvnp1"] = limited_hvnp1
+        argsDict["limited_hnp1"] = limited[0]
+        argsDict["limited_hunp1"] = limited[1]
+        argsDict["limited_hvnp1"] = limited[2]
         argsDict["csrRowIndeces_DofLoops"] = rowptr
         argsDict["csrColumnOffsets_DofLoops"] = colind
         argsDict["MassMatrix"] = MassMatrix
@@ -920,18 +945,22 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["h_max"] = self.h_max
         argsDict["kin_max"] = self.kin_max
         argsDict["KE_tiny"] = self.KE_tiny
-        self.sw2d.convexLimiting(argsDict)
-
-        # Pass the post processed hnp1 solution to global solution u
-        self.timeIntegration.u[hIndex] = limited_hnp1
-        self.timeIntegration.u[huIndex] = limited_hunp1
-        self.timeIntegration.u[hvIndex] = limited_hvnp1
 
     def computeEV(self):
-        entropy_residual = np.zeros(self.u[0].dof.shape)
-        small = 0.0
+        argsDict = self.evArgumentsDict
+        self.setEVArguments(argsDict)
 
-        argsDict = cArgumentsDict.ArgumentsDict()
+        # compute entropy residual
+        self.sw2d.calculateEV(argsDict)
+
+        # save things
+        self.dij_small = globalMax(argsDict.dscalar["dij_small"])
+    #
+
+    def setEVArguments(self, argsDict):
+        """
+        Put the arguments of calculateEV into argsDict
+        """
         argsDict["g"] = self.coefficients.g
         argsDict["h_dof_old"] = self.h_dof_old
         argsDict["hu_dof_old"] = self.hu_dof_old
@@ -948,14 +977,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["eps"] = self.eps
         argsDict["hEps"] = self.hEps
         argsDict["global_entropy_residual"] = self.global_entropy_residual
-        argsDict["dij_small"] = small
-
-        # compute entropy residual
-        self.sw2d.calculateEV(argsDict)
-
-        # save things
-        self.dij_small = globalMax(argsDict.dscalar["dij_small"])
-    #
+        argsDict["dij_small"] = 0.0
 
     def getDOFsCoord(self):
         # get x,y coordinates of all DOFs #
@@ -1378,7 +1400,137 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         self.computeEV()
         self.par_global_entropy_residual.scatter_forward_insert()
 
+        argsDict = self.residualArgumentsDict
+        self.setResidualArguments(argsDict, r)
+
+        ## call calculate residual
+        self.calculateResidual(argsDict)
+
+        ## distribute local bounds and low order solutions (with bar states)
+        self.par_hLow.scatter_forward_insert()
+        self.par_huLow.scatter_forward_insert()
+        self.par_hvLow.scatter_forward_insert()
+        #
+        self.par_h_min.scatter_forward_insert()
+        self.par_h_max.scatter_forward_insert()
+        self.par_kin_max.scatter_forward_insert()
+
+        ## distribute source terms (not sure if needed)
+        self.par_extendedSourceTerm_hu.scatter_forward_insert()
+        self.par_extendedSourceTerm_hv.scatter_forward_insert()
+        ##
+        self.par_new_SourceTerm_hu.scatter_forward_insert()
+        self.par_new_SourceTerm_hv.scatter_forward_insert()
+
+        if self.COMPUTE_NORMALS==1:
+            self.par_normalx.scatter_forward_insert()
+            self.par_normaly.scatter_forward_insert()
+            self.COMPUTE_NORMALS = 0
+        #
+
+        # for reflecting conditions on all boundaries
+        if self.reflectingBoundaryConditions and self.boundaryIndex is not None:
+            for dummy, index in enumerate(self.boundaryIndex):
+                r[self.offset[1]+self.stride[1]*index]=0.
+                r[self.offset[2]+self.stride[2]*index]=0.
+            #
+        #
+
+        # for reflecting conditions on partial boundaries
+        if not self.reflectingBoundaryConditions and self.reflectingBoundaryIndex is not None:
+            for dummy, index in enumerate(self.reflectingBoundaryIndex):
+                r[self.offset[1]+self.stride[1]*index]=0.
+                r[self.offset[2]+self.stride[2]*index]=0.
+            #
+        #
+
+        if self.forceStrongConditions:
+            for cj in range(len(self.dirichletConditionsForceDOF)):
+                for dofN, g in list(self.dirichletConditionsForceDOF[cj].DOFBoundaryConditionsDict.items()):
+                    r[self.offset[cj] + self.stride[cj] * dofN] = 0.
+        #
+        if self.constrainedDOFsIndices is not None:
+            for index in self.constrainedDOFsIndices:
+                for cj in range(self.nc):
+                    global_dofN = self.offset[cj] + self.stride[cj] * index
+                    r[global_dofN] = 0.
+        #
+        logEvent("Global residual SWEs: ", level=9, data=r)
+        # mwf decide if this is reasonable for keeping solver statistics
+        self.nonlinear_function_evaluations += 1
+
+    def advanceSSP(self, tOut, nSteps=None):
+        """
+        Take the SSP Runge-Kutta steps up to tOut (at most nSteps of them) in a single kernel call
+
+        The kernel makes the calls and updates of the lumped mass matrix
+        solver, RKEV and the step controller for each step, so the solution
+        is the same as when the steps are taken from Python. Archiving,
+        gauges and the step controllers are left to the caller; only the
+        time integration state is updated. It needs a serial run with the
+        lumped mass matrix, all DOFs free and no constrained DOFs, and one
+        step already taken from Python (for the boundary normals and the
+        first time step). Returns the number of steps taken.
+        """
+        ti = self.timeIntegration
+        assert Comm.get().size() == 1, "advanceSSP runs in serial"
+        assert self.coefficients.LUMPED_MASS_MATRIX == 1, "advanceSSP needs the lumped mass matrix"
+        assert not self.forceStrongConditions and self.coefficients.constrainedDOFs is None
+        assert self.boundaryIndex is not None and self.COMPUTE_NORMALS == 0, "take a step before advanceSSP"
+        assert ti.dtLast is not None and ti.lstage == 0
+        u = ti.u
+        assert u.size == self.nc * self.numDOFsPerEqn, "advanceSSP needs all DOFs free"
+        if self.reflectingBoundaryConditions:
+            reflectingIndex = self.boundaryIndex
+        elif self.reflectingBoundaryIndex is not None:
+            reflectingIndex = self.reflectingBoundaryIndex
+        else:
+            reflectingIndex = []
+        high_order = [np.zeros(self.h_dof_old.shape) for ci in range(self.nc)]
+        limited = [np.zeros(self.h_dof_old.shape) for ci in range(self.nc)]
+
         argsDict = cArgumentsDict.ArgumentsDict()
+        self.setResidualArguments(argsDict, np.zeros(u.shape, 'd'))
+        self.setEVArguments(argsDict)
+        self.setFCTArguments(argsDict, high_order, limited)
+        argsDict["u"] = u
+        argsDict["reflectingIndex"] = np.array(reflectingIndex, 'i')
+        argsDict["check_positivity_water_height"] = int(self.check_positivity_water_height)
+        for ci, name in enumerate(("h", "hu", "hv")):
+            argsDict[name + "_dof_last"] = ti.u_dof_last[ci]
+            argsDict[name + "_dof_lstage"] = ti.u_dof_lstage[ci]
+        argsDict["nSteps"] = 2**31 - 1 if nSteps is None else int(nSteps)
+        argsDict["timeOrder"] = ti.timeOrder
+        argsDict["tOut"] = float(tOut)
+        argsDict["t"] = float(ti.tLast)
+        argsDict["dt"] = float(ti.dt)
+        argsDict["dtLast"] = float(ti.dtLast)
+        argsDict["dtRatioMax"] = float(ti.dtRatioMax)
+        argsDict["run_cfl"] = float(ti.runCFL)
+        argsDict["edge_based_cfl"] = self.edge_based_cfl
+        argsDict["debug"] = 0
+        nStepsTaken = self.sw2d.advanceSSP(argsDict)
+
+        ti.tLast = argsDict.dscalar["t"]
+        ti.dtLast = argsDict.dscalar["dtLast"]
+        ti.dt = argsDict.dscalar["dt"]
+        ti.t = ti.tLast + ti.dt
+        ti.substeps = [ti.t for i in range(ti.nStages)]
+        self.secondCallCalculateResidual = 1
+        self.check_positivity_water_height = bool(argsDict.iscalar["check_positivity_water_height"])
+        self.KE_tiny = argsDict.dscalar["KE_tiny"]
+        self.dij_small = argsDict.dscalar["dij_small"]
+        self.kernelAllocations = self.sw2d.getAllocationCount()
+        self.sw2d.resetAllocationCount()
+        logEvent("SW2DCV took %d steps to t=%12.5e, kernel scratch allocations: %d" % (nStepsTaken,
+                                                                                      ti.tLast,
+                                                                                      self.kernelAllocations), level=3)
+        return nStepsTaken
+
+    def setResidualArguments(self, argsDict, r):
+        """
+        Put the arguments of calculateResidual into argsDict, with r as the global residual
+        """
         argsDict["mesh_trial_ref"] = self.u[0].femSpace.elementMaps.psi
         argsDict["mesh_grad_trial_ref"] = self.u[0].femSpace.elementMaps.grad_psi
         argsDict["mesh_dof"] = self.mesh.nodeArray
@@ -1502,62 +1654,6 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["urelax"] = self.urelax
         argsDict["drelax"] = self.drelax
 
-        ## call calculate residual
-        self.calculateResidual(argsDict)
-
-        ## distribute local bounds and low order solutions (with bar states)
-        self.par_hLow.scatter_forward_insert()
-        self.par_huLow.scatter_forward_insert()
-        self.par_hvLow.scatter_forward_insert()
-        #
-        self.par_h_min.scatter_forward_insert()
-        self.par_h_max.scatter_forward_insert()
-        self.par_kin_max.scatter_forward_insert()
-
-        ## distribute source terms (not sure if needed)
-        self.par_extendedSourceTerm_hu.scatter_forward_insert()
-        self.par_extendedSourceTerm_hv.scatter_forward_insert()
-        ##
-        self.par_new_SourceTerm_hu.scatter_forward_insert()
-        self.par_new_SourceTerm_hv.scatter_forward_insert()
-
-        if self.COMPUTE_NORMALS==1:
-            self.par_normalx.scatter_forward_insert()
-            self.par_normaly.scatter_forward_insert()
-            self.COMPUTE_NORMALS = 0
-        #
-
-        # for reflecting conditions on all boundaries
-        if self.reflectingBoundaryConditions and self.boundaryIndex is not None:
-            for dummy, index in enumerate(self.boundaryIndex):
-                r[self.offset[1]+self.stride[1]*index]=0.
-                r[self.offset[2]+self.stride[2]*index]=0.
-            #
-        #
-
-        # for reflecting conditions on partial boundaries
-        if not self.reflectingBoundaryConditions and self.reflectingBoundaryIndex is not None:
-            for dummy, index in enumerate(self.reflectingBoundaryIndex):
-                r[self.offset[1]+self.stride[1]*index]=0.
-                r[self.offset[2]+self.stride[2]*index]=0.
-            #
-        #
-
-        if self.forceStrongConditions:
-            for cj in range(len(self.dirichletConditionsForceDOF)):
-                for dofN, g in list(self.dirichletConditionsForceDOF[cj].DOFBoundaryConditionsDict.items()):
-                    r[self.offset[cj] + self.stride[cj] * dofN] = 0.
-        #
-        if self.constrainedDOFsIndices is not None:
-            for index in self.constrainedDOFsIndices:
-                for cj in range(self.nc):
-                    global_dofN = self.offset[cj] + self.stride[cj] * index
-                    r[global_dofN] = 0.
-        #
-        logEvent("Global residual SWEs: ", level=9, data=r)
-        # mwf decide if this is reasonable for keeping solver statistics
-        self.nonlinear_function_evaluations += 1
-
     def getJacobian(self, jacobian):
         cfemIntegrals.zeroJacobian_CSR(self.nNonzerosInJacobian,
                                        jacobian)
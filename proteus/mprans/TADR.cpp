@@ -24,8 +24,8 @@ PYBIND11_MODULE(cTADR, m)
 
     py::class_<TADR_base>(m, "cTADR_base")
         .def(py::init(&proteus::newTADR))
-        .def("calculateResidualElementBased"    , &TADR_base::calculateResidualElementBased  )
-        .def("calculateJacobian"                , &TADR_base::calculateJacobian              )
-        .def("FCTStep"                          , &TADR_base::FCTStep                        )
-        .def("calculateResidualEdgeBased"       , &TADR_base::calculateResidualEdgeBased     );
+        .def("calculateResidualElementBased"    , &TADR_base::calculateResidualElementBased  , proteus::release_gil())
+        .def("calculateJacobian"                , &TADR_base::calculateJacobian              , proteus::release_gil())
+        .def("FCTStep"                          , &TADR_base::FCTStep                        , proteus::release_gil())
+        .def("calculateResidualEdgeBased"       , &TADR_base::calculateResidualEdgeBased     , proteus::release_gil());
 }
@@ -24,8 +24,8 @@ PYBIND11_MODULE(cVOF, m)
 
     py::class_<VOF_base>(m, "cVOF_base")
         .def(py::init(&proteus::newVOF))
-        .def("calculateResidualElementBased"    , &VOF_base::calculateResidualElementBased  )
-        .def("calculateJacobian"                , &VOF_base::calculateJacobian              )
-        .def("FCTStep"                          , &VOF_base::FCTStep                        )
-        .def("calculateResidualEdgeBased"       , &VOF_base::calculateResidualEdgeBased     );
+        .def("calculateResidualElementBased"    , &VOF_base::calculateResidualElementBased  , proteus::release_gil())
+        .def("calculateJacobian"                , &VOF_base::calculateJacobian              , proteus::release_gil())
+        .def("FCTStep"                          , &VOF_base::FCTStep                        , proteus::release_gil())
+        .def("calculateResidualEdgeBased"       , &VOF_base::calculateResidualEdgeBased     , proteus::release_gil());
 }
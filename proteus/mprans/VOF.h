@@ -7,6 +7,8 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
+#include "EdgeList.h"
 #include "equivalent_polynomials.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
@@ -52,9 +54,9 @@ namespace proteus
   {
     //The base class defining the interface
   public:
-    std::valarray<double> Rpos, Rneg;
-    std::valarray<double> FluxCorrectionMatrix;
-    std::valarray<double> TransportMatrix, TransposeTransportMatrix;
+    FCTLimiter fct;
+    std::valarray<double> TransportMatrix;
+    EdgeList edges;
     std::valarray<double> psi, eta, global_entropy_residual, boundary_integral;
     std::valarray<double> maxVel,maxEntRes;
     virtual ~VOF_base(){}
@@ -258,6 +260,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
 	xt::pyarray<double>& x_ref = args.array<double>("x_ref");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
@@ -274,6 +277,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -328,7 +332,6 @@ namespace proteus
         double uL = args.scalar<double>("uL");
         double uR = args.scalar<double>("uR");
         int numDOFs = args.scalar<int>("numDOFs");
-        int NNZ = args.scalar<int>("NNZ");
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
         xt::pyarray<int>& csrRowIndeces_CellLoops = args.array<int>("csrRowIndeces_CellLoops");
@@ -392,7 +395,7 @@ namespace proteus
 		for(int I=0;I<3;I++)
 		  element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-	    int icase_s = gf_s.calculate(element_phi_s, element_nodes, x_ref.data(),false);
+	    int icase_s = gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(),false);
 	    if (icase_s == 0)
 	      {
 		element_active=true;
@@ -1244,6 +1247,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
 	xt::pyarray<double>& x_ref = args.array<double>("x_ref");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
@@ -1260,6 +1264,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -1324,7 +1329,7 @@ namespace proteus
 		for(int I=0;I<3;I++)
 		  element_nodes[i*3 + I] = mesh_dof.data()[mesh_l2g.data()[eN_i]*3 + I];
 	      }//i
-	    int icase_s = gf_s.calculate(element_phi_s, element_nodes, x_ref.data(), false);
+	    int icase_s = gf_s.calculate(eN, element_phi_s, element_nodes, x_ref.data(), false);
             for  (int k=0;k<nQuadraturePoints_element;k++)
               {
                 int eN_k = eN*nQuadraturePoints_element+k, //index to a scalar at a quadrature point
@@ -1906,7 +1911,6 @@ namespace proteus
       void FCTStep(arguments_dict& args)
       {
         double dt = args.scalar<double>("dt");
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix");
         xt::pyarray<double>& soln = args.array<double>("soln");
@@ -1922,100 +1926,52 @@ namespace proteus
         xt::pyarray<double>& max_u_bc = args.array<double>("max_u_bc");
         int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
         int STABILIZATION_TYPE = args.scalar<int>("STABILIZATION_TYPE");
-        Rpos.resize(numDOFs,0.0);
-        Rneg.resize(numDOFs,0.0);
-        FluxCorrectionMatrix.resize(NNZ,0.0);
-        //////////////////
-        // LOOP in DOFs //
-        //////////////////
-        int ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+        double* FluxCorrectionMatrix = fct.componentFlux(0);
+        ////////////////////////////////////
+        // COMPUTE FLUX CORRECTION MATRIX //
+        ////////////////////////////////////
+        fct.computeFlux(0, [&](int i, int j, int ij)
           {
-            //read some vectors
-            double solHi = solH.data()[i];
-            double solni = soln.data()[i];
+            double solni = soln.data()[i], solnj = soln.data()[j];
+            if (STABILIZATION_TYPE==4) // DK high-order, linearly stable anti-dif. flux
+              {
+                double uLowi = uLow.data()[i], uLowj = uLow.data()[j];
+                double uDotLowi = (uLowi - solni)/dt;
+                double uDotLowj = (uLowj - solnj)/dt;
+                return dt*(MassMatrix.data()[ij]*(uDotLowi-uDotLowj)
+                           + dLow.data()[ij]*(uLowi-uLowj));
+              }
             double mi = lumped_mass_matrix.data()[i];
-            double uLowi = uLow.data()[i];
-            double uDotLowi = (uLowi - solni)/dt;
+            double ML_minus_MC =
+              (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*mi - MassMatrix.data()[ij]);
+            return ML_minus_MC * (solH.data()[j]-solnj - (solH.data()[i]-solni))
+              + dt_times_dH_minus_dL.data()[ij]*(solnj-solni);
+          });
+        /////////////////////////////
+        // COMPUTE Q AND R VECTORS //
+        /////////////////////////////
+        fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
+          {
             double mini=min_u_bc.data()[i], maxi=max_u_bc.data()[i]; // init min/max with value at BCs (NOTE: if no boundary then min=1E10, max=-1E10)
             if (GLOBAL_FCT==1)
               {
                 mini = 0.;
                 maxi = 1.;
               }
-
-            double Pposi=0, Pnegi=0;
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                double solnj = soln.data()[j];
-                ////////////////////////
-                // COMPUTE THE BOUNDS //
-                ////////////////////////
-                if (GLOBAL_FCT == 0)
-                  {
-                    mini = fmin(mini,solnj);
-                    maxi = fmax(maxi,solnj);
-                  }
-                double uLowj = uLow.data()[j];
-                double uDotLowj = (uLowj - solnj)/dt;
-                // i-th row of flux correction matrix
-                if (STABILIZATION_TYPE==4) // DK high-order, linearly stable anti-dif. flux
-                  {
-                    FluxCorrectionMatrix[ij] = dt*(MassMatrix.data()[ij]*(uDotLowi-uDotLowj)
-                                                   + dLow.data()[ij]*(uLowi-uLowj));
-                  }
-                else
-                  {
-                    double ML_minus_MC =
-                      (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*mi - MassMatrix.data()[ij]);
-                    FluxCorrectionMatrix[ij] = ML_minus_MC * (solH.data()[j]-solnj - (solHi-solni))
-                      + dt_times_dH_minus_dL.data()[ij]*(solnj-solni);
-                  }
-
-                ///////////////////////
-                // COMPUTE P VECTORS //
-                ///////////////////////
-                Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-                Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-                //update ij
-                ij+=1;
-              }
-            ///////////////////////
-            // COMPUTE Q VECTORS //
-            ///////////////////////
-            double Qposi = mi*(maxi-uLow.data()[i]);
-            double Qnegi = mi*(mini-uLow.data()[i]);
-
-            ///////////////////////
-            // COMPUTE R VECTORS //
-            ///////////////////////
-            Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-            Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-          } // i DOFs
-
+            else
+              fct.rowBounds(soln.data(), i, mini, maxi);
+            double mi = lumped_mass_matrix.data()[i];
+            Qposi = mi*(maxi-uLow.data()[i]);
+            Qnegi = mi*(mini-uLow.data()[i]);
+          });
         //////////////////////
         // COMPUTE LIMITERS //
         //////////////////////
-        ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.limit(FluxCorrectionMatrix, [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
           {
-            double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-            double Rposi = Rpos[i], Rnegi = Rneg[i];
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops.data()[offset];
-                double Lij = 1;
-                Lij = ((FluxCorrectionMatrix[ij]>0) ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]));
-                ith_Limiter_times_FluxCorrectionMatrix += Lij * FluxCorrectionMatrix[ij];
-                //update ij
-                ij+=1;
-              }
             limited_solution.data()[i] = uLow.data()[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix;
-          }
+          });
       }
 
       void calculateResidualEdgeBased(arguments_dict& args)
@@ -2027,6 +1983,7 @@ namespace proteus
         xt::pyarray<double>& mesh_velocity_dof = args.array<double>("mesh_velocity_dof");
         double MOVING_DOMAIN = args.scalar<double>("MOVING_DOMAIN");
         xt::pyarray<int>& mesh_l2g = args.array<int>("mesh_l2g");
+        int mesh_generation = args.scalar<int>("mesh_generation");
         xt::pyarray<double>& dV_ref = args.array<double>("dV_ref");
         xt::pyarray<double>& u_trial_ref = args.array<double>("u_trial_ref");
         xt::pyarray<double>& u_grad_trial_ref = args.array<double>("u_grad_trial_ref");
@@ -2042,6 +1999,7 @@ namespace proteus
         xt::pyarray<double>& normal_ref = args.array<double>("normal_ref");
         xt::pyarray<double>& boundaryJac_ref = args.array<double>("boundaryJac_ref");
         int nElements_global = args.scalar<int>("nElements_global");
+        ck.updateGeometryCache(nElements_global,mesh_dof.data(),mesh_l2g.data(),mesh_grad_trial_ref.data(),mesh_generation);
         double useMetrics = args.scalar<double>("useMetrics");
         double alphaBDF = args.scalar<double>("alphaBDF");
         int lag_shockCapturing = args.scalar<int>("lag_shockCapturing");
@@ -2111,7 +2069,7 @@ namespace proteus
         // Allocate space for the transport matrices
         // This is used for first order KUZMIN'S METHOD
         TransportMatrix.resize(NNZ,0.0);
-        TransposeTransportMatrix.resize(NNZ,0.0);
+        edges.setPattern(numDOFs,csrRowIndeces_DofLoops.data(),csrColumnOffsets_DofLoops.data());
         // compute entropy and init global_entropy_residual and boundary_integral
         psi.resize(numDOFs,0.0);
         eta.resize(numDOFs,0.0);
@@ -2145,7 +2103,6 @@ namespace proteus
               elementResidual_u[nDOF_test_element],
               element_entropy_residual[nDOF_test_element];
             double  elementTransport[nDOF_test_element][nDOF_trial_element];
-            double  elementTransposeTransport[nDOF_test_element][nDOF_trial_element];
             for (int i=0;i<nDOF_test_element;i++)
               {
                 elementResidual_u[i]=0.0;
@@ -2153,7 +2110,6 @@ namespace proteus
                 for (int j=0;j<nDOF_trial_element;j++)
                   {
                     elementTransport[i][j]=0.0;
-                    elementTransposeTransport[i][j]=0.0;
                   }
               }
             //loop over quadrature points and compute integrands
@@ -2261,14 +2217,10 @@ namespace proteus
                     ///////////////
                     for(int j=0;j<nDOF_trial_element;j++)
                       {
-                        int j_nSpace = j*nSpace;
                         int i_nSpace = i*nSpace;
                         elementTransport[i][j] += // -int[(vel.grad_wi)*wj*dx]
                           ck.AdvectionJacobian_weak(porosity_times_velocity,
                                                     u_trial_ref.data()[k*nDOF_trial_element+j],&u_grad_test_dV[i_nSpace]);
-                        elementTransposeTransport[i][j] += // -int[(vel.grad_wj)*wi*dx]
-                          ck.AdvectionJacobian_weak(porosity_times_velocity,
-                                                    u_trial_ref.data()[k*nDOF_trial_element+i],&u_grad_test_dV[j_nSpace]);
                       }
                   }//i
                 //save solution for other models
@@ -2295,9 +2247,6 @@ namespace proteus
                     int eN_i_j = eN_i*nDOF_trial_element+j;
                     TransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] +
                                     csrColumnOffsets_CellLoops.data()[eN_i_j]] += elementTransport[i][j];
-                    TransposeTransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] +
-                                             csrColumnOffsets_CellLoops.data()[eN_i_j]]
-                      += elementTransposeTransport[i][j];
                   }//j
               }//i
           }//elements
@@ -2436,8 +2385,6 @@ namespace proteus
                         int ebN_i_j = ebN*4*nDOF_test_X_trial_element + i*nDOF_trial_element + j;
                         TransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_eb_CellLoops.data()[ebN_i_j]]
                           += fluxTransport[j]*u_test_dS[i];
-                        TransposeTransportMatrix[csrRowIndeces_CellLoops.data()[eN_i] + csrColumnOffsets_eb_CellLoops.data()[ebN_i_j]]
-                          += fluxTransport[i]*u_test_dS[j];
                       }//j
                   }//i
                 // local min/max at boundary
@@ -2507,6 +2454,11 @@ namespace proteus
         /////////////////////////////////////////////
         // ** LOOP IN DOFs FOR EDGE BASED TERMS ** //
         /////////////////////////////////////////////
+        // first-order dissipative operator, once per edge
+        edges.symmetricFill(dLow.data(), [this](int i, int j, int ij, int ji)
+                            {
+                              return fmax(fabs(TransportMatrix[ij]),fabs(TransportMatrix[ji]));
+                            });
         ij=0;
         for (int i=0; i<numDOFs; i++)
           {
@@ -2532,10 +2484,9 @@ namespace proteus
                     // artificial compression
                     double solij = 0.5*(porosityi*solni+porosityj*solnj);
                     double Compij = cK*fmax(solij*(1.0-solij),0.0)/(fabs(porosityi*solni-porosityj*solnj)+1E-14);
-                    // first-order dissipative operator
-                    dLowij = fmax(fabs(TransportMatrix[ij]),fabs(TransposeTransportMatrix[ij]));
+                    dLowij = dLow.data()[ij];
                     //dLij = fmax(0.,fmax(psi[i]*TransportMatrix[ij], // Approach by S. Badia
-                    //              psi[j]*TransposeTransportMatrix[ij]));
+                    //              psi[j]*TransportMatrix[edges.transpose[ij]]));
                     dLij = dLowij*fmax(psi[i],psi[j]); // Approach by JLG & BP
                     if (STABILIZATION_TYPE==2) //EV Stab
                       {
@@ -2553,14 +2504,12 @@ namespace proteus
                     //dHij - dLij. This matrix is needed during FCT step
                     dt_times_dH_minus_dL[ij] = dt*(dHij - dLowij);
                     dLii -= dLij;
-                    dLow[ij] = dLowij;
                   }
                 else //i==j
                   {
                     // NOTE: this is incorrect. Indeed, dLii = -sum_{j!=i}(dLij) and similarly for dCii.
                     // However, it is irrelevant since during the FCT step we do (dL-dC)*(solnj-solni)
                     dt_times_dH_minus_dL[ij]=0;
-                    dLow[ij]=0;
                   }
                 //update ij
                 ij+=1;
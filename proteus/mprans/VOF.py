@@ -1157,6 +1157,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["x_ref"] = self.elementQuadraturePoints
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
@@ -1284,6 +1285,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["mesh_velocity_dof"] = self.mesh.nodeVelocityArray
         argsDict["MOVING_DOMAIN"] = self.MOVING_DOMAIN
         argsDict["mesh_l2g"] = self.mesh.elementNodesArray
+        argsDict["mesh_generation"] = self.mesh.generation
         argsDict["x_ref"] = self.elementQuadraturePoints
         argsDict["dV_ref"] = self.elementQuadratureWeights[('u', 0)]
         argsDict["u_trial_ref"] = self.u[0].femSpace.psi
@@ -25,10 +25,10 @@ PYBIND11_MODULE(cVOF3P, m)
     xt::import_numpy();
 
     py::class_<cppVOF3P_base>(m, "cppVOF3P_base")
-        .def("calculateResidualElementBased", &cppVOF3P_base::calculateResidualElementBased)
-        .def("calculateJacobian", &cppVOF3P_base::calculateJacobian)
-        .def("FCTStep", &cppVOF3P_base::FCTStep)
-        .def("calculateResidualEdgeBased", &cppVOF3P_base::calculateResidualEdgeBased);
+        .def("calculateResidualElementBased", &cppVOF3P_base::calculateResidualElementBased, proteus::release_gil())
+        .def("calculateJacobian", &cppVOF3P_base::calculateJacobian, proteus::release_gil())
+        .def("FCTStep", &cppVOF3P_base::FCTStep, proteus::release_gil())
+        .def("calculateResidualEdgeBased", &cppVOF3P_base::calculateResidualEdgeBased, proteus::release_gil());
 
     m.def("newVOF3P", newVOF3P);
 }
@@ -5,6 +5,7 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
 
@@ -44,8 +45,7 @@ namespace proteus
   {
     //The base class defining the interface
   public:
-    std::valarray<double> Rpos, Rneg;
-    std::valarray<double> FluxCorrectionMatrix;
+    FCTLimiter fct;
     std::valarray<double> TransportMatrix, TransposeTransportMatrix;
     std::valarray<double> psi, eta, global_entropy_residual, boundary_integral;
     virtual ~cppVOF3P_base(){}
@@ -317,7 +317,6 @@ namespace proteus
         double uL = args.scalar<double>("uL");
         double uR = args.scalar<double>("uR");
         int numDOFs = args.scalar<int>("numDOFs");
-        int NNZ = args.scalar<int>("NNZ");
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
         xt::pyarray<int>& csrRowIndeces_CellLoops = args.array<int>("csrRowIndeces_CellLoops");
@@ -1342,7 +1341,6 @@ namespace proteus
       void FCTStep(arguments_dict& args)
       {
         double dt = args.scalar<double>("dt");
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix");
         xt::pyarray<double>& soln = args.array<double>("soln");
@@ -1358,99 +1356,52 @@ namespace proteus
         xt::pyarray<double>& max_u_bc = args.array<double>("max_u_bc");
         int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
         int STABILIZATION_TYPE = args.scalar<int>("STABILIZATION_TYPE");
-        Rpos.resize(numDOFs,0.0), Rneg.resize(numDOFs,0.0);
-        FluxCorrectionMatrix.resize(NNZ,0.0);
-        //////////////////
-        // LOOP in DOFs //
-        //////////////////
-        int ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+        double* FluxCorrectionMatrix = fct.componentFlux(0);
+        ////////////////////////////////////
+        // COMPUTE FLUX CORRECTION MATRIX //
+        ////////////////////////////////////
+        fct.computeFlux(0, [&](int i, int j, int ij)
           {
-            //read some vectors
-            double solHi = solH[i];
-            double solni = soln[i];
+            double solni = soln[i], solnj = soln[j];
+            if (STABILIZATION_TYPE==4) // DK high-order, linearly stable anti-dif. flux
+              {
+                double uLowi = uLow[i], uLowj = uLow[j];
+                double uDotLowi = (uLowi - solni)/dt;
+                double uDotLowj = (uLowj - solnj)/dt;
+                return dt*(MassMatrix[ij]*(uDotLowi-uDotLowj)
+                           + dLow[ij]*(uLowi-uLowj));
+              }
             double mi = lumped_mass_matrix[i];
-            double uLowi = uLow[i];
-            double uDotLowi = (uLowi - solni)/dt;
+            double ML_minus_MC =
+              (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*mi - MassMatrix[ij]);
+            return ML_minus_MC * (solH[j]-solnj - (solH[i]-solni))
+              + dt_times_dH_minus_dL[ij]*(solnj-solni);
+          });
+        /////////////////////////////
+        // COMPUTE Q AND R VECTORS //
+        /////////////////////////////
+        fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
+          {
             double mini=min_u_bc[i], maxi=max_u_bc[i]; // init min/max with value at BCs (NOTE: if no boundary then min=1E10, max=-1E10)
             if (GLOBAL_FCT==1)
               {
                 mini = 0.;
                 maxi = 1.;
               }
-
-            double Pposi=0, Pnegi=0;
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops[i]; offset<csrRowIndeces_DofLoops[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops[offset];
-                double solnj = soln[j];
-                ////////////////////////
-                // COMPUTE THE BOUNDS //
-                ////////////////////////
-                if (GLOBAL_FCT == 0)
-                  {
-                    mini = fmin(mini,solnj);
-                    maxi = fmax(maxi,solnj);
-                  }
-                double uLowj = uLow[j];
-                double uDotLowj = (uLowj - solnj)/dt;
-                // i-th row of flux correction matrix           
-                if (STABILIZATION_TYPE==4) // DK high-order, linearly stable anti-dif. flux
-                  {
-                    FluxCorrectionMatrix[ij] = dt*(MassMatrix[ij]*(uDotLowi-uDotLowj)
-                                                   + dLow[ij]*(uLowi-uLowj));
-                  }
-                else
-                  {
-                    double ML_minus_MC =
-                      (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*mi - MassMatrix[ij]);
-                    FluxCorrectionMatrix[ij] = ML_minus_MC * (solH[j]-solnj - (solHi-solni))
-                      + dt_times_dH_minus_dL[ij]*(solnj-solni);
-                  }
-                
-                ///////////////////////
-                // COMPUTE P VECTORS //
-                ///////////////////////
-                Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-                Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-                //update ij
-                ij+=1;
-              }
-            ///////////////////////
-            // COMPUTE Q VECTORS //
-            ///////////////////////
-            double Qposi = mi*(maxi-uLow[i]);
-            double Qnegi = mi*(mini-uLow[i]);
-
-            ///////////////////////
-            // COMPUTE R VECTORS //
-            ///////////////////////
-            Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-            Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-          } // i DOFs
-
+            else
+              fct.rowBounds(soln.data(), i, mini, maxi);
+            double mi = lumped_mass_matrix[i];
+            Qposi = mi*(maxi-uLow[i]);
+            Qnegi = mi*(mini-uLow[i]);
+          });
         //////////////////////
         // COMPUTE LIMITERS //
         //////////////////////
-        ij=0;
-        for (int i=0; i<numDOFs; i++)
+        fct.limit(FluxCorrectionMatrix, [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
           {
-            double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-            double Rposi = Rpos[i], Rnegi = Rneg[i];
-            // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-            for (int offset=csrRowIndeces_DofLoops[i]; offset<csrRowIndeces_DofLoops[i+1]; offset++)
-              {
-                int j = csrColumnOffsets_DofLoops[offset];
-                double Lij = 1;
-                Lij = ((FluxCorrectionMatrix[ij]>0) ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]));
-                ith_Limiter_times_FluxCorrectionMatrix += Lij * FluxCorrectionMatrix[ij];
-                //update ij
-                ij+=1;
-              }
             limited_solution[i] = uLow[i] + 1./lumped_mass_matrix[i]*ith_Limiter_times_FluxCorrectionMatrix;
-          }
+          });
       }
 
       void calculateResidualEdgeBased(arguments_dict& args)
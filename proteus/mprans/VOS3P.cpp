@@ -24,10 +24,10 @@ PYBIND11_MODULE(cVOS3P, m)
 
     py::class_<cppVOS3P_base>(m, "cppVOS3P_base")
         .def(py::init(&proteus::newVOS3P))
-        .def("calculateResidual", &cppVOS3P_base::calculateResidual)
-        .def("calculateJacobian", &cppVOS3P_base::calculateJacobian)
-        .def("FCTStep", &cppVOS3P_base::FCTStep)
-        .def("kth_FCT_step", &cppVOS3P_base::kth_FCT_step)
-        .def("calculateResidual_entropy_viscosity", &cppVOS3P_base::calculateResidual_entropy_viscosity)
-        .def("calculateMassMatrix", &cppVOS3P_base::calculateMassMatrix);
+        .def("calculateResidual", &cppVOS3P_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &cppVOS3P_base::calculateJacobian, proteus::release_gil())
+        .def("FCTStep", &cppVOS3P_base::FCTStep, proteus::release_gil())
+        .def("kth_FCT_step", &cppVOS3P_base::kth_FCT_step, proteus::release_gil())
+        .def("calculateResidual_entropy_viscosity", &cppVOS3P_base::calculateResidual_entropy_viscosity, proteus::release_gil())
+        .def("calculateMassMatrix", &cppVOS3P_base::calculateMassMatrix, proteus::release_gil());
 }
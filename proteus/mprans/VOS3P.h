@@ -5,6 +5,7 @@
 #include <valarray>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
 #include "ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
 
@@ -38,9 +39,7 @@ namespace proteus
   {
     //The base class defining the interface
   public:
-    std::valarray<double> Rpos, Rneg;
-    std::valarray<double> FluxCorrectionMatrix;
-    std::valarray<double> solL;
+    FCTLimiter fct;
     std::valarray<double> TransportMatrix, TransposeTransportMatrix;
     std::valarray<double> u_free_dof_old,porosity_free_dof;
     std::valarray<double> psi, eta, global_entropy_residual, boundary_integral;
@@ -318,7 +317,6 @@ namespace proteus
         double uL = args.scalar<double>("uL");
         double uR = args.scalar<double>("uR");
         int numDOFs = args.scalar<int>("numDOFs");
-        int NNZ = args.scalar<int>("NNZ");
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
         xt::pyarray<int>& csrRowIndeces_CellLoops = args.array<int>("csrRowIndeces_CellLoops");
@@ -1202,7 +1200,6 @@ namespace proteus
     }//computeJacobian
     void FCTStep(arguments_dict& args)
     {
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix");
         xt::pyarray<double>& soln = args.array<double>("soln");
@@ -1216,98 +1213,49 @@ namespace proteus
         xt::pyarray<double>& min_u_bc = args.array<double>("min_u_bc");
         xt::pyarray<double>& max_u_bc = args.array<double>("max_u_bc");
         int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
-      Rpos.resize(numDOFs,0.0), Rneg.resize(numDOFs,0.0);
-      FluxCorrectionMatrix.resize(NNZ,0.0);
-      solL.resize(numDOFs,0.0);
-      //////////////////
-      // LOOP in DOFs //
-      //////////////////
-      int ij=0;
-      for (int i=0; i<numDOFs; i++)
+      fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+      double* FluxCorrectionMatrix = fct.componentFlux(0);
+      ////////////////////////////////////
+      // COMPUTE FLUX CORRECTION MATRIX //
+      ////////////////////////////////////
+      fct.computeFlux(0, [&](int i, int j, int ij)
         {
-          //read some vectors
-          double solHi = solH.data()[i];
           double solni = soln.data()[i];
-          double mi = lumped_mass_matrix.data()[i];
-          // compute low order solution
-          // mi*(uLi-uni) + dt*sum_j[(Tij+dLij)*unj] = 0
-          solL[i] = uLow.data()[i];
-
+          double ML_minus_MC = (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*lumped_mass_matrix.data()[i] - MassMatrix.data()[ij]);
+          return ML_minus_MC * (solH.data()[j]-soln.data()[j] - (solH.data()[i]-solni))
+            + dt_times_dH_minus_dL.data()[ij]*(soln.data()[j]-solni);
+        });
+      /////////////////////////////
+      // COMPUTE Q AND R VECTORS //
+      /////////////////////////////
+      // the low order solution is uLow: mi*(uLi-uni) + dt*sum_j[(Tij+dLij)*unj] = 0
+      fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
+        {
           double mini=min_u_bc.data()[i], maxi=max_u_bc.data()[i]; // init min/max with value at BCs (NOTE: if no boundary then min=1E10, max=-1E10)
           if (GLOBAL_FCT==1)
             {
               mini = 0.;
               maxi = 1.;
             }
-
-          double Pposi=0, Pnegi=0;
-          // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-          for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-            {
-              int j = csrColumnOffsets_DofLoops.data()[offset];
-              ////////////////////////
-              // COMPUTE THE BOUNDS //
-              ////////////////////////
-              if (GLOBAL_FCT == 0)
-                {
-                  mini = fmin(mini,soln.data()[j]);
-                  maxi = fmax(maxi,soln.data()[j]);
-                }
-              // i-th row of flux correction matrix
-              double ML_minus_MC = (LUMPED_MASS_MATRIX == 1 ? 0. : (i==j ? 1. : 0.)*mi - MassMatrix.data()[ij]);
-              FluxCorrectionMatrix[ij] = ML_minus_MC * (solH.data()[j]-soln.data()[j] - (solHi-solni))
-                + dt_times_dH_minus_dL.data()[ij]*(soln.data()[j]-solni);
-
-              ///////////////////////
-              // COMPUTE P VECTORS //
-              ///////////////////////
-              Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-              Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-              //update ij
-              ij+=1;
-            }
-          ///////////////////////
-          // COMPUTE Q VECTORS //
-          ///////////////////////
-          double Qposi = mi*(maxi-solL[i]);
-          double Qnegi = mi*(mini-solL[i]);
-
-          ///////////////////////
-          // COMPUTE R VECTORS //
-          ///////////////////////
-          Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-          Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-        } // i DOFs
-
+          else
+            fct.rowBounds(soln.data(), i, mini, maxi);
+          double mi = lumped_mass_matrix.data()[i];
+          Qposi = mi*(maxi-uLow.data()[i]);
+          Qnegi = mi*(mini-uLow.data()[i]);
+        });
       //////////////////////
       // COMPUTE LIMITERS //
       //////////////////////
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
+      fct.limit(FluxCorrectionMatrix, [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
         {
-          double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-          double Rposi = Rpos[i], Rnegi = Rneg[i];
-          // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-          for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-            {
-              int j = csrColumnOffsets_DofLoops.data()[offset];
-              ith_Limiter_times_FluxCorrectionMatrix +=
-                ((FluxCorrectionMatrix[ij]>0) ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]))
-                * FluxCorrectionMatrix[ij];
-              //ith_Limiter_times_FluxCorrectionMatrix += FluxCorrectionMatrix[ij];
-              //update ij
-              ij+=1;
-            }
-          limited_solution.data()[i] = solL[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix;
-        }
+          limited_solution.data()[i] = uLow.data()[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix;
+        });
     }
 
     void kth_FCT_step(arguments_dict& args)
     {
         double dt = args.scalar<double>("dt");
         int num_fct_iter = args.scalar<int>("num_fct_iter");
-        int NNZ = args.scalar<int>("NNZ");
         int numDOFs = args.scalar<int>("numDOFs");
         xt::pyarray<double>& MC = args.array<double>("MC");
         xt::pyarray<double>& ML = args.array<double>("ML");
@@ -1324,8 +1272,8 @@ namespace proteus
         double global_max_u = args.scalar<double>("global_max_u");
         xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
         xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
-      Rpos.resize(numDOFs,0.0), Rneg.resize(numDOFs,0.0);
-      int ij=0;
+      fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+      double* F = fct.componentFlux(0);
 
       //////////////////////////////////////////////////////
       // ********** COMPUTE LOW ORDER SOLUTION ********** //
@@ -1341,133 +1289,76 @@ namespace proteus
         {
           for (int iter=0; iter<num_fct_iter; iter++)
             {
-              ij=0;
-              for (int i=0; i<numDOFs; i++)
+              // compute Flux correction
+              fct.computeFlux(0, [&](int i, int j, int ij)
                 {
-                  double Pposi=0, Pnegi=0;
-                  for (int offset=csrRowIndeces_DofLoops.data()[i];
-                       offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-                    {
-                      int j = csrColumnOffsets_DofLoops.data()[offset];
-                      // compute Flux correction
-                      double Fluxij = FluxMatrix.data()[ij] - limitedFlux.data()[ij];
-                      Pposi += Fluxij*((Fluxij > 0) ? 1. : 0.);
-		      Pnegi += Fluxij*((Fluxij < 0) ? 1. : 0.);
-                      // update ij
-                      ij+=1;
-                    }
-                  // compute Q vectors
-                  double mi = ML.data()[i];
-                  double solLimi = solLim.data()[i];
-                  double Qposi = mi*(global_max_u-solLimi);
-		  double Qnegi = mi*(global_min_u-solLimi);
-                  // compute R vectors
-                  Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-		  Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-                }
-              ij=0;
-              for (int i=0; i<numDOFs; i++)
+                  return FluxMatrix.data()[ij] - limitedFlux.data()[ij];
+                });
+              // compute Q and R vectors
+              fct.computeR(F, [&](int i, double& Qposi, double& Qnegi)
                 {
-                  double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-                  double Rposi = Rpos[i], Rnegi = Rneg[i];
-                  for (int offset=csrRowIndeces_DofLoops.data()[i];
-                       offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-                    {
-                      int j = csrColumnOffsets_DofLoops.data()[offset];
-                      // Flux Correction
-                      double Fluxij = FluxMatrix.data()[ij] - limitedFlux.data()[ij];
-                      // compute limiter
-                      double Lij = 1.0;
-                      //Lij = (Fluxij>0 ? Rposi : Rpos[j]);
-		      Lij = (Fluxij>0 ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]));
-                      // compute limited flux
-                      ith_Limiter_times_FluxCorrectionMatrix += Lij*Fluxij;
-
-		      // ***** UPDATE VECTORS FOR NEXT FCT ITERATION ***** //
-                      // update limited flux
-                      limitedFlux.data()[ij] = Lij*Fluxij;
-
-                      //update FluxMatrix
-                      FluxMatrix.data()[ij] = Fluxij;
-
-                      //update ij
-                      ij+=1;
-                    }
-                  //update limited solution
                   double mi = ML.data()[i];
-                  solLim.data()[i] += 1.0/mi*ith_Limiter_times_FluxCorrectionMatrix;
-                }
+                  double solLimi = solLim.data()[i];
+                  Qposi = mi*(global_max_u-solLimi);
+                  Qnegi = mi*(global_min_u-solLimi);
+                });
+              fct.limit(F,
+                        [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
+                        {
+                          //update limited solution
+                          double mi = ML.data()[i];
+                          solLim.data()[i] += 1.0/mi*ith_Limiter_times_FluxCorrectionMatrix;
+                        },
+                        [&](int i, int j, int ij, double Lij)
+                        {
+                          // ***** UPDATE VECTORS FOR NEXT FCT ITERATION ***** //
+                          // update limited flux
+                          limitedFlux.data()[ij] = Lij*F[ij];
+                          //update FluxMatrix
+                          FluxMatrix.data()[ij] = F[ij];
+                          return Lij*F[ij];
+                        });
             }
         }
 
       // ***************************************** //
       // ********** HIGH ORDER SOLUTION ********** //
       // ***************************************** //
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
+      fct.computeFlux(0, [&](int i, int j, int ij)
         {
-	  double mini=fmin(min_u_bc.data()[i],solLim.data()[i]), maxi=fmax(max_u_bc.data()[i],solLim.data()[i]);
-          double Pposi = 0, Pnegi = 0.;
-          for (int offset=csrRowIndeces_DofLoops.data()[i];
-               offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-            {
-              int j = csrColumnOffsets_DofLoops.data()[offset];
-              // compute local bounds //
-              mini = fmin(mini,soln.data()[j]);
-              maxi = fmax(maxi,soln.data()[j]);
-              // compute P vectors //
-              double fij = dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
-              Pposi += fij * (fij > 0. ? 1. : 0.);
-              Pnegi += fij * (fij < 0. ? 1. : 0.);
-              //update ij
-              ij+=1;
-            }
+          return dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
+        });
+      fct.computeR(F, [&](int i, double& Qposi, double& Qnegi)
+        {
+          // compute local bounds //
+          double mini=fmin(min_u_bc.data()[i],solLim.data()[i]), maxi=fmax(max_u_bc.data()[i],solLim.data()[i]);
+          fct.rowBounds(soln.data(), i, mini, maxi);
           // compute Q vectors //
           double mi = ML.data()[i];
-          double Qposi = mi*(maxi-solLim.data()[i]);
-          double Qnegi = mi*(mini-solLim.data()[i]);
-
-          // compute R vectors //
-          Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-          Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-        }
+          Qposi = mi*(maxi-solLim.data()[i]);
+          Qnegi = mi*(mini-solLim.data()[i]);
+        });
 
       // COMPUTE LIMITERS //
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
-	{
-	  double ith_limited_flux_correction = 0;
-	  double Rposi = Rpos[i];
-	  double Rnegi = Rneg[i];
-	  for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-	    {
-	      int j = csrColumnOffsets_DofLoops.data()[offset];
-	      // compute flux correction
-	      double fij = dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
-	      // compute limiters
-	      double Lij = 1.0;
-	      Lij = fij > 0. ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]);
-	      // compute ith_limited_flux_correction
-	      ith_limited_flux_correction += Lij*fij;
-	      ij+=1;
-	    }
-	  double mi = ML.data()[i];
-	  solLim.data()[i] += 1./mi*ith_limited_flux_correction;
-
-	  // clean round off error
-	  if (solLim.data()[i] > 1.0+1E-13)
-	    {
-	      std::cout << "upper bound violated... " << 1.0-solLim.data()[i] << std::endl;
-	      abort();
-	    }
-	  else if (solLim.data()[i] < -1E-13)
-	    {
-	      std::cout << "lower bound violated... " << solLim.data()[i] << std::endl;
-	      abort();
-	    }
-	  else
-	    solLim.data()[i] = fmax(0.,fmin(solLim.data()[i],1.0));
-	}
+      fct.limit(F, [&](int i, double ith_limited_flux_correction)
+        {
+          double mi = ML.data()[i];
+          solLim.data()[i] += 1./mi*ith_limited_flux_correction;
+
+          // clean round off error
+          if (solLim.data()[i] > 1.0+1E-13)
+            {
+              std::cout << "upper bound violated... " << 1.0-solLim.data()[i] << std::endl;
+              abort();
+            }
+          else if (solLim.data()[i] < -1E-13)
+            {
+              std::cout << "lower bound violated... " << solLim.data()[i] << std::endl;
+              abort();
+            }
+          else
+            solLim.data()[i] = fmax(0.,fmin(solLim.data()[i],1.0));
+        });
     }
 
     void calculateResidual_entropy_viscosity(arguments_dict& args)
@@ -1567,8 +1458,6 @@ namespace proteus
         xt::pyarray<double>& min_u_bc = args.array<double>("min_u_bc");
         xt::pyarray<double>& max_u_bc = args.array<double>("max_u_bc");
         xt::pyarray<double>& quantDOFs = args.array<double>("quantDOFs");
-      Rpos.resize(numDOFs,0.0), Rneg.resize(numDOFs,0.0);
-      //double FluxCorrectionMatrix[NNZ];
       // NOTE: This function follows a different (but equivalent) implementation of the smoothness based indicator than NCLS.h
       // Allocate space for the transport matrices
       // This is used for first order KUZMIN'S METHOD
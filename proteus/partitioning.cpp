@@ -2,6 +2,50 @@
 
 namespace proteus
 {
+/* Give each candidate item (node, element, face or edge) to the lowest
+   rank that has it as a candidate. Items are distributed in blocks of the
+   global numbering over "home" ranks; every rank sends its candidates to
+   their homes and each home answers with the lowest rank it heard from,
+   so the work and memory per rank are proportional to its candidates plus
+   one block. This gives the same ownership as passing a global mask from
+   rank 0 up to rank size-1. */
+static void claimLowestRank(const MPI_Comm& PROTEUS_COMM_WORLD, int nItems_global,
+                            const std::set<int>& candidates, std::set<int>& owned)
+{
+  int size,rank;
+  MPI_Comm_size(PROTEUS_COMM_WORLD,&size);
+  MPI_Comm_rank(PROTEUS_COMM_WORLD,&rank);
+  const int blockSize = nItems_global/size + 1;
+  //candidates are sorted so they are already grouped by home rank
+  std::vector<int> sendItems(candidates.begin(),candidates.end());
+  std::vector<int> sendCounts(size,0),recvCounts(size,0),sendOffsets(size+1,0),recvOffsets(size+1,0);
+  for (size_t i=0;i<sendItems.size();i++)
+    sendCounts[sendItems[i]/blockSize]++;
+  MPI_Alltoall(sendCounts.data(),1,MPI_INT,recvCounts.data(),1,MPI_INT,PROTEUS_COMM_WORLD);
+  for (int sdN=0;sdN<size;sdN++)
+    {
+      sendOffsets[sdN+1] = sendOffsets[sdN]+sendCounts[sdN];
+      recvOffsets[sdN+1] = recvOffsets[sdN]+recvCounts[sdN];
+    }
+  std::vector<int> recvItems(recvOffsets[size]);
+  MPI_Alltoallv(sendItems.data(),sendCounts.data(),sendOffsets.data(),MPI_INT,
+                recvItems.data(),recvCounts.data(),recvOffsets.data(),MPI_INT,PROTEUS_COMM_WORLD);
+  //lowest rank touching each item of this rank's block
+  const int itemBegin = rank*blockSize;
+  std::vector<int> lowestRank(std::max(0,std::min(blockSize,nItems_global-itemBegin)),size);
+  for (int sdN=size-1;sdN>=0;sdN--)
+    for (int i=recvOffsets[sdN];i<recvOffsets[sdN+1];i++)
+      lowestRank[recvItems[i]-itemBegin] = sdN;
+  for (int i=0;i<recvOffsets[size];i++)
+    recvItems[i] = lowestRank[recvItems[i]-itemBegin];
+  std::vector<int> owners(sendItems.size());
+  MPI_Alltoallv(recvItems.data(),recvCounts.data(),recvOffsets.data(),MPI_INT,
+                owners.data(),sendCounts.data(),sendOffsets.data(),MPI_INT,PROTEUS_COMM_WORLD);
+  for (size_t i=0;i<sendItems.size();i++)
+    if (owners[i] == rank)
+      owned.insert(owned.end(),sendItems[i]);
+}
+
 //todo add overlap for element based partitions
 int partitionElementsOriginal(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, int nElements_overlap)
 {
@@ -21,7 +65,7 @@ int partitionElementsOriginal(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, in
   //3. Pass to Parmetis to build a better partition of the elements
   //
   //4. Tag a subset of the nodes on the subdomain elements as owned
-  //using a mark and pass approach.**
+  //by the lowest rank touching them.
   //
   //5. Extract the nodes in the
   //overlapping elements.**
@@ -207,28 +251,12 @@ int partitionElementsOriginal(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, in
   //otherwise we could just grab the nodes on the subdomain and not worry about ownership
   //in the long run it wouldn't be bad to do a global repartition of faces and edges for mixed hybrid
   //and non-conforming finite elements
-  MPI_Status status;
-  PetscBT nodeMask;
-  PetscBTCreate(mesh.nNodes_global,&nodeMask);
-  if (rank > 0)
-    {
-      MPI_Recv(nodeMask,PetscBTLength(mesh.nNodes_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status);
-    }
-  //mark the unmarked nodes on this subdomain and store the node numbers
-  set<int> nodes_subdomain_owned;
+  //the nodes on this subdomain's elements are owned by the lowest rank touching them
+  set<int> nodes_subdomain_candidates,nodes_subdomain_owned;
   for(int eN=elementOffsets_new[rank];eN<elementOffsets_new[rank+1];eN++)
     for(int nN=0;nN<mesh.nNodes_element;nN++)
-      {
-        int nN_global = elementNodesArray_new[eN*mesh.nNodes_element+nN];
-        if (!PetscBTLookupSet(nodeMask,nN_global))
-          nodes_subdomain_owned.insert(nN_global);
-      }
-  //ship off the mask
-  if (rank < size-1)
-    MPI_Send(nodeMask,PetscBTLength(mesh.nNodes_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&nodeMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy"<<endl;
+      nodes_subdomain_candidates.insert(elementNodesArray_new[eN*mesh.nNodes_element+nN]);
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nNodes_global,nodes_subdomain_candidates,nodes_subdomain_owned);
   //get the number of nodes on each processor
   valarray<int> nNodes_subdomain_new(size),
     nodeOffsets_new(size+1);
@@ -682,16 +710,8 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
   //4. To build subdomain meshes, go through and collect elements containing
   //   the locally owned nodes. Assign processor ownership of elements
   //
-  MPI_Status status;
-  PetscBT elementMask;
-  PetscBTCreate(mesh.nElements_global,&elementMask);
-  //get the owned element information
-  if (rank > 0)
-    {
-      MPI_Recv(elementMask,PetscBTLength(mesh.nElements_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status);
-    }
-  //mark the unmarked elements on this subdomain and store element numbers (in old numbering)
-  set<int> elements_subdomain_owned;
+  //the elements in the stars of the owned nodes are owned by the lowest rank touching them (in old numbering)
+  set<int> elements_subdomain_candidates,elements_subdomain_owned;
   for (int nN = nodeOffsets_new[rank]; nN < nodeOffsets_new[rank+1]; nN++)
     {
       int nN_global_old = nodeNumbering_global_new2old[nN];
@@ -699,12 +719,10 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
            eN_star_offset < mesh.nodeElementOffsets[nN_global_old+1]; eN_star_offset++)
         {
           int eN_star_old = mesh.nodeElementsArray[eN_star_offset];
-          if (!PetscBTLookupSet(elementMask,eN_star_old))
-            {
-              elements_subdomain_owned.insert(eN_star_old);
-            }
+          elements_subdomain_candidates.insert(eN_star_old);
         }
     }
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nElements_global,elements_subdomain_candidates,elements_subdomain_owned);
   //mwf debug
   //   for (int nN =  nodeOffsets_new[rank]; nN < nodeOffsets_new[rank+1]; nN++)
   //     {
@@ -730,12 +748,6 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
   //        }
   //    }
   //     }
-  //pass off newly marked info
-  if (rank < size-1)
-    MPI_Send(elementMask,PetscBTLength(mesh.nElements_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&elementMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy"<<endl;
 
   //
   //5. Generate global element numbering corresponding to new subdomain ownership
@@ -790,16 +802,9 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
         elementBoundariesArray_new[eN*mesh.nElementBoundaries_element+ebN] =
           mesh.elementBoundariesArray[elementNumbering_global_new2old[eN]*mesh.nElementBoundaries_element+ebN];
       }
-  MPI_Status status_elementBoundaries;
-  PetscBT elementBoundaryMask;
-  PetscBTCreate(mesh.nElementBoundaries_global,&elementBoundaryMask);
-  if (rank > 0)
-    {
-      MPI_Recv(elementBoundaryMask,PetscBTLength(mesh.nElementBoundaries_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status_elementBoundaries);
-    }
-  //mark the unmarked faces on this subdomain and store the global face numbers
+  //the faces on this subdomain are owned by the lowest rank touching them
   //going through owned elements can pick up owned elementBoundaries on "outside" of owned nodes nodeStars
-  set<int> elementBoundaries_subdomain_owned;
+  set<int> elementBoundaries_subdomain_candidates,elementBoundaries_subdomain_owned;
   if (mesh.nNodes_element == 8)
     {
 
@@ -834,8 +839,7 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
                   if (foundNode)
                     {
                       int ebN_global=elementBoundariesArray_new[eN_star_new*mesh.nElementBoundaries_element+ebN];
-                      if (!PetscBTLookupSet(elementBoundaryMask,ebN_global))
-                        elementBoundaries_subdomain_owned.insert(ebN_global);
+                      elementBoundaries_subdomain_candidates.insert(ebN_global);
                     }
                 }
 
@@ -864,20 +868,13 @@ int partitionNodes(const MPI_Comm& PROTEUS_COMM_WORLD,  Mesh& mesh, int nNodes_o
                   if (nN_global_old_across != nN_global_old)
                     {
                       int ebN_global=elementBoundariesArray_new[eN_star_new*mesh.nElementBoundaries_element+ebN];
-                      if (!PetscBTLookupSet(elementBoundaryMask,ebN_global))
-                        elementBoundaries_subdomain_owned.insert(ebN_global);
+                      elementBoundaries_subdomain_candidates.insert(ebN_global);
                     }
                 }
             }
         }
     }
-
-  //ship off the mask
-  if (rank < size-1)
-    MPI_Send(elementBoundaryMask,PetscBTLength(mesh.nElementBoundaries_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&elementBoundaryMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy for elementBoundaries"<<endl;
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nElementBoundaries_global,elementBoundaries_subdomain_candidates,elementBoundaries_subdomain_owned);
   //get the number of elementBoundaries on each processor
   valarray<int> nElementBoundaries_subdomain_new(size),
     elementBoundaryOffsets_new(size+1);
@@ -4645,28 +4642,12 @@ int partitionElements(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, int nEleme
   //otherwise we could just grab the nodes on the subdomain and not worry about ownership
   //in the long run it wouldn't be bad to do a global repartition of faces and edges for mixed hybrid
   //and non-conforming finite elements
-  MPI_Status status;
-  PetscBT nodeMask;
-  PetscBTCreate(mesh.nNodes_global,&nodeMask);
-  if (rank > 0)
-    {
-      MPI_Recv(nodeMask,PetscBTLength(mesh.nNodes_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status);
-    }
-  //mark the unmarked nodes on this subdomain and store the node numbers
-  set<int> nodes_subdomain_owned;
+  //the nodes on this subdomain's elements are owned by the lowest rank touching them
+  set<int> nodes_subdomain_candidates,nodes_subdomain_owned;
   for(int eN=elementOffsets_new[rank];eN<elementOffsets_new[rank+1];eN++)
     for(int nN=0;nN<mesh.nNodes_element;nN++)
-      {
-        int nN_global = elementNodesArray_new[eN*mesh.nNodes_element+nN];
-        if (!PetscBTLookupSet(nodeMask,nN_global))
-          nodes_subdomain_owned.insert(nN_global);
-      }
-  //ship off the mask
-  if (rank < size-1)
-    MPI_Send(nodeMask,PetscBTLength(mesh.nNodes_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&nodeMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy"<<endl;
+      nodes_subdomain_candidates.insert(elementNodesArray_new[eN*mesh.nNodes_element+nN]);
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nNodes_global,nodes_subdomain_candidates,nodes_subdomain_owned);
   //get the number of nodes on each processor
   valarray<int> nNodes_subdomain_new(size),
     nodeOffsets_new(size+1);
@@ -4740,50 +4721,12 @@ int partitionElements(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, int nEleme
     }
 
   //4b. repeat process to build global face numbering
-  MPI_Status status_elementBoundaries;
-  PetscBT elementBoundaryMask;
-  PetscBTCreate(mesh.nElementBoundaries_global,&elementBoundaryMask);
-  if (rank > 0)
-    {
-      MPI_Recv(elementBoundaryMask,PetscBTLength(mesh.nElementBoundaries_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status_elementBoundaries);
-    }
-  //mark the unmarked faces on this subdomain and store the global face numbers
-  set<int> elementBoundaries_subdomain_owned;
+  //the faces on this subdomain's elements are owned by the lowest rank touching them
+  set<int> elementBoundaries_subdomain_candidates,elementBoundaries_subdomain_owned;
   for(int eN=elementOffsets_new[rank];eN<elementOffsets_new[rank+1];eN++)
     for(int ebN=0;ebN<mesh.nElementBoundaries_element;ebN++)
-      {
-        int ebN_global = elementBoundariesArray_new[eN*mesh.nElementBoundaries_element+ebN];
-        if(!PetscBTLookup(elementBoundaryMask,ebN_global))
-          {
-            bool notFound=true;
-            for(int nN=0;nN<mesh.nNodes_elementBoundary;nN++)
-              {
-                int nN_global_old = mesh.elementBoundaryNodesArray[ebN_global*mesh.nNodes_elementBoundary+nN];
-                if (nodes_subdomain_owned.count(nN_global_old) > 0)
-                  {
-                    notFound=false;
-                  }
-              }
-            if (notFound)
-              {
-                //std::cout<<"=========================Face has no owned nodes"<<std::endl;
-                PetscBTSet(elementBoundaryMask,ebN_global);
-                elementBoundaries_subdomain_owned.insert(ebN_global);
-              }
-            else
-              {
-                PetscBTSet(elementBoundaryMask,ebN_global);
-                elementBoundaries_subdomain_owned.insert(ebN_global);
-              }
-          }
-      }
-  //std::cout<<"Done marking element boundares "<<elementBoundaries_subdomain_owned.size()<<std::endl;
-  //ship off the mask
-  if (rank < size-1)
-    MPI_Send(elementBoundaryMask,PetscBTLength(mesh.nElementBoundaries_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&elementBoundaryMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy for elementBoundaries"<<endl;
+      elementBoundaries_subdomain_candidates.insert(elementBoundariesArray_new[eN*mesh.nElementBoundaries_element+ebN]);
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nElementBoundaries_global,elementBoundaries_subdomain_candidates,elementBoundaries_subdomain_owned);
   //get the number of elementBoundaries on each processor
   valarray<int> nElementBoundaries_subdomain_new(size),
     elementBoundaryOffsets_new(size+1);
@@ -4901,16 +4844,9 @@ int partitionElements(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, int nEleme
   //4c. Build global edge numbering as well
   // ownership is determined by the edges on owned elements, then
   // who owns the left (0) node  of the edge
-  MPI_Status status_edges;
-  PetscBT edgesMask;
-  PetscBTCreate(mesh.nEdges_global,&edgesMask);
-  if (rank > 0)
-    {
-      MPI_Recv(edgesMask,PetscBTLength(mesh.nEdges_global),MPI_CHAR,rank-1,0,PROTEUS_COMM_WORLD,&status_edges);
-    }
-  //mark the unmarked faces on this subdomain and store the global face numbers
+  //the edges on this subdomain's elements are owned by the lowest rank touching them
   map<NodeTuple<2>, int> nodesEdgeMap_global; //new global node numbers --> original edge numbering
-  set<int> edges_subdomain_owned;
+  set<int> edges_subdomain_candidates,edges_subdomain_owned;
   for (int ig = 0; ig < mesh.nEdges_global; ig++)
     {
       int nodes[2];
@@ -4929,21 +4865,10 @@ int partitionElements(const MPI_Comm& PROTEUS_COMM_WORLD, Mesh& mesh, int nEleme
             nodes[1] = elementNodesArray_new[eN*mesh.nNodes_element+nN1];
             NodeTuple<2> et(nodes);
             if (nodesEdgeMap_global.find(et) != nodesEdgeMap_global.end())
-              {
-                int edge_global = nodesEdgeMap_global[et];
-                if(!PetscBTLookup(edgesMask,edge_global))
-                  {
-                    PetscBTSet(edgesMask,edge_global);
-                    edges_subdomain_owned.insert(nodesEdgeMap_global[et]);
-                  }
-              }
+              edges_subdomain_candidates.insert(nodesEdgeMap_global[et]);
           }
     }
-  if (rank < size-1)
-    MPI_Send(edgesMask,PetscBTLength(mesh.nEdges_global),MPI_CHAR,rank+1,0,PROTEUS_COMM_WORLD);
-  ierr = PetscBTDestroy(&edgesMask);
-  if (ierr)
-    cerr<<"Error in PetscBTDestroy for edges"<<endl;
+  claimLowestRank(PROTEUS_COMM_WORLD,mesh.nEdges_global,edges_subdomain_candidates,edges_subdomain_owned);
 
   valarray<int> nEdges_subdomain_new(size),
     edgeOffsets_new(size+1);
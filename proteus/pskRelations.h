@@ -3,7 +3,10 @@
 #include <cmath>
 #include <iostream>
 #include <cassert>
+#include <map>
+#include <utility>
 #include "densityRelations.h"
+#include "PskTable.h"
 #include "SubsurfaceTransportCoefficients.h"
 /** \file pskrelations.h
     \defgroup pskrelations pskrelations
@@ -474,6 +477,67 @@ class VGM : public VGMorig
     dSe_dpsic=DsBar_DpC;
   }
 };
+/* Van Genuchten-Mualem tabulated in alpha*psic (see proteus::VanGenuchtenTable),
+   for the psic formulations; rwork_tol[2] is the table tolerance. The tables
+   are shared by every instance with the same n and tolerance and never freed.
+   Calls in the nonsmooth regime psic < ns_del and outside the tables use VGM */
+class VGMTabulated : public VGM
+{
+ public:
+  double table_tol;
+  VGMTabulated()
+  {}
+  VGMTabulated(const double* rwork, const int* iwork = 0):
+    VGM(rwork,iwork),
+    table_tol(1.0e-8),
+    table(0)
+  {}
+  virtual inline void setTolerances(const double* rwork_tol)
+  {
+    VGM::setTolerances(rwork_tol);
+    table_tol = rwork_tol[2];
+    table = 0;
+  }
+  inline void setParams(const double* rwork, const int* iwork = 0)
+  {
+    VGM::setParams(rwork,iwork);
+    table = 0;
+  }
+  virtual inline void calc_from_psic(const double& psicIn)
+  {
+    const double alphaPsiC = alpha*psicIn;
+    if (psicIn < ns_del || !proteus::VanGenuchtenTable::covers(alphaPsiC))
+      {
+        VGM::calc_from_psic(psicIn);
+        return;
+      }
+    if (!table)
+      table = &tabulated(n,table_tol);
+    double value[proteus::VanGenuchtenTable::nFunctions],
+      derivative[proteus::VanGenuchtenTable::nFunctions];
+    table->evaluate(0,alphaPsiC,value,derivative);
+    Se = value[0];
+    krw = value[1];
+    krn = value[2];
+    dSe_dpsic = alpha*derivative[0];
+    dkrw = alpha*derivative[1];
+    dkrn = alpha*derivative[2];
+    psic = psicIn;
+    dpsic = 1.0;
+  }
+ private:
+  const proteus::VanGenuchtenTable* table;
+  static inline const proteus::VanGenuchtenTable& tabulated(double n, double tol)
+  {
+    static std::map<std::pair<double,double>,proteus::VanGenuchtenTable> tables;
+    std::pair<std::map<std::pair<double,double>,proteus::VanGenuchtenTable>::iterator,bool> entry =
+      tables.insert(std::make_pair(std::make_pair(n,tol),proteus::VanGenuchtenTable()));
+    if (entry.second)
+      entry.first->second.build(1,&n,tol);
+    return entry.first->second;
+  }
+};
+
 /* Van Genuchten-Burdine */
 class VGB : public  VGM
 {
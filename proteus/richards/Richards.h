@@ -3,8 +3,11 @@
 #include <cmath>
 #include <iostream>
 #include <valarray>
+#include <stdexcept>
 #include "CompKernel.h"
 #include "ModelFactory.h"
+#include "FCTLimiter.h"
+#include "PskTable.h"
 #include "../mprans/ArgumentsDict.h"
 #include "xtensor-python/pyarray.hpp"
 #define nnz nSpace
@@ -38,6 +41,7 @@ namespace proteus
   {
     //The base class defining the interface
   public:
+    FCTLimiter fct;
     virtual ~Richards_base(){
 		double anb_seepage_flux =1e-16;
 	}
@@ -48,6 +52,7 @@ namespace proteus
     virtual void kth_FCT_step(arguments_dict& args)=0;
     virtual void calculateResidual_entropy_viscosity(arguments_dict& args)=0;
     virtual void calculateMassMatrix(arguments_dict& args)=0;
+    virtual void evaluatePskTable(arguments_dict& args)=0;
   };
 
   template<class CompKernelType,
@@ -62,10 +67,24 @@ namespace proteus
   public:
     const int nDOF_test_X_trial_element;
     CompKernelType ck;
+    VanGenuchtenTable pskTable;
+    bool usePskTable;
     Richards():
       nDOF_test_X_trial_element(nDOF_test_element*nDOF_trial_element),
-      ck()
+      ck(),
+      usePskTable(false)
     {}
+    /// tabulate the van Genuchten-Mualem relations if pskTableTolerance > 0
+    inline void updatePskTable(arguments_dict& args)
+    {
+      const double tolerance = args.scalar<double>("pskTableTolerance");
+      usePskTable = tolerance > 0.0;
+      if (usePskTable)
+        {
+          xt::pyarray<double>& n = args.array<double>("n");
+          pskTable.build(n.size(), n.data(), tolerance);
+        }
+    }
     inline
     void evaluateCoefficients(const int rowptr[nSpace],
 			      const int colind[nnz],
@@ -74,6 +93,7 @@ namespace proteus
 			      const double gravity[nSpace],
 			      const double alpha,
 			      const double n_vg,
+			      const int material,
 			      const double thetaR,
 			      const double thetaSR,
 			      const double KWs[nnz],
@@ -117,7 +137,16 @@ namespace proteus
       m_vg = 1.0 - 1.0 / n_vg;
       thetaS = thetaR + thetaSR;
 	  //std::cout<< "Thetas"<<thetaS<<std::endl;//arnob trying to debug
-      if (psiC > 0.0)
+      if (psiC > 0.0 && usePskTable && pskTable.covers(alpha * psiC))
+	{
+	  double psk[VanGenuchtenTable::nFunctions], dpsk[VanGenuchtenTable::nFunctions];
+	  pskTable.evaluate(material, alpha * psiC, psk, dpsk);
+	  thetaW = thetaSR*psk[0] + thetaR;
+	  DthetaW_DpsiC = thetaSR * alpha * dpsk[0];
+	  KWr = psk[1];
+	  DKWr_DpsiC = alpha * dpsk[1];
+	}
+      else if (psiC > 0.0)
 	{
 	  pcBar = alpha * psiC;
 	  pcBarStar = pcBar;
@@ -455,6 +484,7 @@ namespace proteus
 
     void calculateResidual(arguments_dict& args)
     {
+      updatePskTable(args);
       xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
       xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
       xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
@@ -531,7 +561,6 @@ namespace proteus
       double uR = args.scalar<double>("uR");
       // PARAMETERS FOR EDGE VISCOSITY
       int numDOFs = args.scalar<int>("numDOFs");
-      int NNZ = args.scalar<int>("NNZ");
       xt::pyarray<int>& csrRowIndeces_DofLoops = args.array<int>("csrRowIndeces_DofLoops");
       xt::pyarray<int>& csrColumnOffsets_DofLoops = args.array<int>("csrColumnOffsets_DofLoops");
       xt::pyarray<int>& csrRowIndeces_CellLoops = args.array<int>("csrRowIndeces_CellLoops");
@@ -674,6 +703,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -877,6 +907,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -897,6 +928,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -969,6 +1001,7 @@ namespace proteus
 
     void calculateJacobian(arguments_dict& args)
     {
+      updatePskTable(args);
       xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
       xt::pyarray<double>& mesh_grad_trial_ref = args.array<double>("mesh_grad_trial_ref");
       xt::pyarray<double>& mesh_dof = args.array<double>("mesh_dof");
@@ -1122,6 +1155,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -1322,6 +1356,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -1342,6 +1377,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],
@@ -1395,7 +1431,6 @@ namespace proteus
     void FCTStep(arguments_dict& args)
     {
       xt::pyarray<double>& bc_mask = args.array<double>("bc_mask");
-      int NNZ = args.scalar<int>("NNZ"); //number on non-zero entries on sparsity pattern
       int numDOFs = args.scalar<int>("numDOFs"); //number of DOFs
       double dt = args.scalar<double>("dt");
       xt::pyarray<double>& lumped_mass_matrix = args.array<double>("lumped_mass_matrix"); //lumped mass matrix (as vector)
@@ -1413,26 +1448,28 @@ namespace proteus
       xt::pyarray<double>& max_s_bc = args.array<double>("max_s_bc");
       int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
       int MONOLITHIC = args.scalar<int>("MONOLITHIC");
-      double Rpos[numDOFs], Rneg[numDOFs];
-      double FluxCorrectionMatrix[NNZ];
-      double solL[numDOFs];
-      double sdot[numDOFs];
-      //////////////////
-      // LOOP in DOFs //
-      //////////////////
-      int ij=0;
-      for (int i=0; i<numDOFs; i++)
-	{
-	  //read some vectors
-	  double solHi = solH.data()[i];
-	  double solni = soln.data()[i];
+      fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+      double* FluxCorrectionMatrix = fct.componentFlux(0);
+      ////////////////////////////////////
+      // COMPUTE FLUX CORRECTION MATRIX //
+      ////////////////////////////////////
+      fct.computeFlux(0, [&](int i, int j, int ij)
+        {
+	  if (MONOLITHIC == 0)
+	    {
+	      //double sdoti = (solH.data()[i] - soln.data()[i]);
+	      double sdoti = uDotLow[i], sdotj = uDotLow[j];
+	      return (LUMPED_MASS_MATRIX == 1 ? 0. : 1.)*dt*MassMatrix.data()[ij]*(sdoti - sdotj) + dt_times_fH_minus_fL.data()[ij];
+	    }
+	  return dt_times_fH_minus_fL.data()[ij];
+        });
+      /////////////////////////////
+      // COMPUTE Q AND R VECTORS //
+      /////////////////////////////
+      // the low order solution is uLow: mi*(uLi-uni) + dt*sum_j[(Tij+dLij)*unj] = 0
+      fct.computeR(FluxCorrectionMatrix, [&](int i, double& Qposi, double& Qnegi)
+        {
 	  double mi = lumped_mass_matrix.data()[i];
-	  // compute low order solution
-	  // mi*(uLi-uni) + dt*sum_j[(Tij+dLij)*unj] = 0
-	  solL[i] = uLow.data()[i];
-	  //double sdoti = (solHi - solni);
-	  double sdoti = uDotLow[i];
-	  sdot[i] = 0.0;
 	  //double mini=max_s_bc.data()[i], maxi=min_s_bc.data()[i]; // init min/max with value at BCs (NOTE: if no boundary then min=1E10, max=-1E10)
 	  double mini=1e10, maxi=1e-10; // init min/max with value at BCs (NOTE: if no boundary then min=1E10, max=-1E10)
 	  if (GLOBAL_FCT==1)
@@ -1440,113 +1477,43 @@ namespace proteus
 	      mini = 0.;
 	      maxi = 1.;
 	    }
-
-	  double Pposi=0, Pnegi=0;
-	  // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-	  for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-	    {
-	      int j = csrColumnOffsets_DofLoops.data()[offset];
-	      ////////////////////////
-	      // COMPUTE THE BOUNDS //
-	      ////////////////////////
-	      if (GLOBAL_FCT == 0)
-		{
-		  if (MONOLITHIC == 0)
-		    {
-		      mini = fmin(mini,solL[j]);
-		      maxi = fmax(maxi,solL[j]);
-		    }
-		  else
-		    {
-		      mini = fmin(mini,pn.data()[j]);
-		      maxi = fmax(maxi,pn.data()[j]);
-		    }
-		}
-	      // i-th row of flux correction matrix
-	      //double sdotj = (solH.data()[j] - soln.data()[j]);
-	      double sdotj = uDotLow[j];
-	      double I_plus_ML_minus_MC = (i==j ? 1. : 0.)*(1. + mi) - MassMatrix.data()[ij];
-	      sdot[i] +=  I_plus_ML_minus_MC*(solH.data()[j]-soln.data()[j])/mi;
-	      if (MONOLITHIC == 0)
-		{
-		  FluxCorrectionMatrix[ij] = (LUMPED_MASS_MATRIX == 1 ? 0. : 1.)*dt*MassMatrix.data()[ij]*(sdoti - sdotj) + dt_times_fH_minus_fL.data()[ij];
-		}
-	      else
-		{
-		  FluxCorrectionMatrix[ij] = dt_times_fH_minus_fL.data()[ij];                  
-		}
-	      ///////////////////////
-	      // COMPUTE P VECTORS //
-	      ///////////////////////
-	      Pposi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] > 0) ? 1. : 0.);
-	      Pnegi += FluxCorrectionMatrix[ij]*((FluxCorrectionMatrix[ij] < 0) ? 1. : 0.);
-
-	      //update ij
-	      ij+=1;
-	      //std::cout<<"sdoti error"<<fabs(sdoti-sdot[i])<<std::endl;
-	    }
-	  ///////////////////////
-	  // COMPUTE Q VECTORS //
-	  ///////////////////////
-	  double gamma;
-	  double Qposi;
-	  double Qnegi;
+	  else
+	    fct.rowBounds(MONOLITHIC == 0 ? uLow.data() : pn.data(), i, mini, maxi);
 	  if (MONOLITHIC == 0)
 	    {
-	      Qposi = mi*(maxi-solL[i]);
-	      Qnegi = mi*(mini-solL[i]);
+	      Qposi = mi*(maxi-uLow.data()[i]);
+	      Qnegi = mi*(mini-uLow.data()[i]);
 	    }
 	  else
 	    {
-	      gamma=10.0*mi;
+	      double gamma=10.0*mi;
 	      Qposi =fmin(0.5*mi*(1.0-soln.data()[i]), gamma*(maxi-pn.data()[i]));
 	      Qnegi =fmax(0.5*mi*(0.0-soln.data()[i]), gamma*(mini-pn.data()[i]));
 	    }
-	  ///////////////////////
-	  // COMPUTE R VECTORS //
-	  ///////////////////////
-	  Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-	  Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));
-	} // i DOFs
-
+        });
       //////////////////////
       // COMPUTE LIMITERS //
       //////////////////////
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
-	{
-	  double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-	  double alpha_fA, alpha_dot, beta_ij=1.0;
-	  double Rposi = Rpos[i], Rnegi = Rneg[i];
-	  //double sdoti = (solH.data()[i] - soln.data()[i]);
-	  double sdoti = uDotLow[i];
-	  // LOOP OVER THE SPARSITY PATTERN (j-LOOP)//
-	  for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-	    {
-	      int j = csrColumnOffsets_DofLoops.data()[offset];
-	      //double sdotj = (solH.data()[j] - soln.data()[j]);
-	      double sdotj = uDotLow[j];
-	      alpha_fA = ((FluxCorrectionMatrix[ij]>0) ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]))
-		* FluxCorrectionMatrix[ij];
-	      alpha_dot = fmin(1.0, beta_ij*fabs(alpha_fA)/MassMatrix.data()[ij]/fmax(1.0e-8,fabs(sdoti-sdotj)));
-	      if (MONOLITHIC == 0)
-		{
-		  ith_Limiter_times_FluxCorrectionMatrix += alpha_fA;
-		}
-	      else
-		{
-		  ith_Limiter_times_FluxCorrectionMatrix += alpha_fA + (LUMPED_MASS_MATRIX == 1 ? 0. : 1.)*dt*alpha_dot*MassMatrix.data()[ij]*(sdoti-sdotj);
-		}
-	      //update ij
-	      ij+=1;
-	    }
-	  limited_solution.data()[i] = solL[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix*bc_mask[i];
-	}
+      double beta_ij=1.0;
+      fct.limit(FluxCorrectionMatrix,
+                [&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
+                {
+                  limited_solution.data()[i] = uLow.data()[i] + 1./lumped_mass_matrix.data()[i]*ith_Limiter_times_FluxCorrectionMatrix*bc_mask[i];
+                },
+                [&](int i, int j, int ij, double Lij)
+                {
+                  double alpha_fA = Lij*FluxCorrectionMatrix[ij];
+                  if (MONOLITHIC == 0)
+                    return alpha_fA;
+                  //double sdotj = (solH.data()[j] - soln.data()[j]);
+                  double sdoti = uDotLow[i], sdotj = uDotLow[j];
+                  double alpha_dot = fmin(1.0, beta_ij*fabs(alpha_fA)/MassMatrix.data()[ij]/fmax(1.0e-8,fabs(sdoti-sdotj)));
+                  return alpha_fA + (LUMPED_MASS_MATRIX == 1 ? 0. : 1.)*dt*alpha_dot*MassMatrix.data()[ij]*(sdoti-sdotj);
+                });
     }
 
     void kth_FCT_step(arguments_dict& args)
     {
-      int NNZ = args.scalar<int>("NNZ"); //number on non-zero entries on sparsity pattern
       int numDOFs = args.scalar<int>("numDOFs"); //number of DOFs
       int num_fct_iter = args.scalar<int>("num_fct_iter");
       double dt = args.scalar<double>("dt");
@@ -1570,8 +1537,8 @@ namespace proteus
       xt::pyarray<double>& max_s_bc = args.array<double>("max_s_bc");
       int LUMPED_MASS_MATRIX = args.scalar<int>("LUMPED_MASS_MATRIX");
       int MONOLITHIC = args.scalar<int>("MONOLITHIC");
-      double Rpos[numDOFs], Rneg[numDOFs];
-      int ij=0;
+      fct.setPattern(numDOFs, csrRowIndeces_DofLoops.data(), csrColumnOffsets_DofLoops.data());
+      double* F = fct.componentFlux(0);
 
       //////////////////////////////////////////////////////
       // ********** COMPUTE LOW ORDER SOLUTION ********** //
@@ -1587,117 +1554,67 @@ namespace proteus
 	{
 	  for (int iter=0; iter<num_fct_iter; iter++)
 	    {
-	      ij=0;
-	      for (int i=0; i<numDOFs; i++)
+	      // compute Flux correction
+	      fct.computeFlux(0, [&](int i, int j, int ij)
 		{
-		  double maxi=1.0, Pposi=0;
-		  for (int offset=csrRowIndeces_DofLoops.data()[i];
-		       offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-		    {
-		      int j = csrColumnOffsets_DofLoops.data()[offset];
-		      // compute Flux correction
-		      double Fluxij = FluxMatrix.data()[ij] - limitedFlux.data()[ij];	      
-		      Pposi += Fluxij*((Fluxij > 0) ? 1. : 0.);
-		      // update ij
-		      ij+=1;
-		    }
-		  // compute Q vectors
-		  double mi = ML.data()[i];
-		  double solLimi = solLim.data()[i];
-		  double Qposi = mi*(maxi-solLimi);
-		  // compute R vectors
-		  Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-		}
-	      ij=0;
-	      for (int i=0; i<numDOFs; i++)
+		  return FluxMatrix.data()[ij] - limitedFlux.data()[ij];
+		});
+	      // compute Q and R vectors, only the upper bound is enforced
+	      fct.computeR(F, [&](int i, double& Qposi, double& Qnegi)
 		{
-		  double ith_Limiter_times_FluxCorrectionMatrix = 0.;
-		  double Rposi = Rpos[i];
-		  for (int offset=csrRowIndeces_DofLoops.data()[i];
-		       offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-		    {
-		      int j = csrColumnOffsets_DofLoops.data()[offset];
-		      // Flux Correction
-		      double Fluxij = FluxMatrix.data()[ij] - limitedFlux.data()[ij];
-		      // compute limiter
-		      double Lij = 1.0;
-		      Lij = (Fluxij>0 ? Rposi : Rpos[j]);		    
-		      // compute limited flux 
-		      ith_Limiter_times_FluxCorrectionMatrix += Lij*Fluxij;		    
-			
-		      // update limited flux
-		      limitedFlux.data()[ij] = Lij*Fluxij;
-			
-		      //update FluxMatrix
-		      FluxMatrix.data()[ij] = Fluxij;		   
-			
-		      //update ij
-		      ij+=1;
-		    }
-		  //update limited solution
+		  double maxi=1.0;
 		  double mi = ML.data()[i];
-		  solLim.data()[i] += 1.0/mi*ith_Limiter_times_FluxCorrectionMatrix;	    
-		}
+		  double solLimi = solLim.data()[i];
+		  Qposi = mi*(maxi-solLimi);
+		  Qnegi = -HUGE_VAL;
+		});
+	      fct.limit(F,
+			[&](int i, double ith_Limiter_times_FluxCorrectionMatrix)
+			{
+			  //update limited solution
+			  double mi = ML.data()[i];
+			  solLim.data()[i] += 1.0/mi*ith_Limiter_times_FluxCorrectionMatrix;
+			},
+			[&](int i, int j, int ij, double Lij)
+			{
+			  // update limited flux
+			  limitedFlux.data()[ij] = Lij*F[ij];
+			  //update FluxMatrix
+			  FluxMatrix.data()[ij] = F[ij];
+			  return Lij*F[ij];
+			});
 	    }
 	}
 
       // ***************************************** //
       // ********** HIGH ORDER SOLUTION ********** //
       // ***************************************** //
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
+      fct.computeFlux(0, [&](int i, int j, int ij)
+	{
+	  return dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
+	});
+      fct.computeR(F, [&](int i, double& Qposi, double& Qnegi)
 	{
+	  // compute local bounds //
 	  double mini=soln.data()[i], maxi=soln.data()[i];
-	  double Pposi = 0, Pnegi = 0.;
-	  for (int offset=csrRowIndeces_DofLoops.data()[i];
-	       offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-	    {
-	      int j = csrColumnOffsets_DofLoops.data()[offset];
-	      // compute local bounds //
-	      mini = fmin(mini,soln.data()[j]);
-	      maxi = fmax(maxi,soln.data()[j]);
-	      // compute P vectors //
-	      double fij = dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
-	      Pposi += fij * (fij > 0 ? 1. : 0.);
-	      Pnegi += fij * (fij < 0 ? 1. : 0.);
-	      //update ij
-	      ij+=1;
-	    }
+	  fct.rowBounds(soln.data(), i, mini, maxi);
 	  // compute Q vectors //
 	  double mi = ML.data()[i];
-	  double Qposi = mi*(maxi-solLim.data()[i]);
-	  double Qnegi = mi*(mini-solLim.data()[i]);
-	  // compute R vectors //
-	  Rpos[i] = ((Pposi==0) ? 1. : fmin(1.0,Qposi/Pposi));
-	  Rneg[i] = ((Pnegi==0) ? 1. : fmin(1.0,Qnegi/Pnegi));	    	
-	}
+	  Qposi = mi*(maxi-solLim.data()[i]);
+	  Qnegi = mi*(mini-solLim.data()[i]);
+	});
 
       // COMPUTE LIMITERS //
-      ij=0;
-      for (int i=0; i<numDOFs; i++)
+      fct.limit(F, [&](int i, double ith_limited_flux_correction)
 	{
-	  double ith_limited_flux_correction = 0;
-	  double Rposi = Rpos[i];
-	  double Rnegi = Rneg[i];
-	  for (int offset=csrRowIndeces_DofLoops.data()[i]; offset<csrRowIndeces_DofLoops.data()[i+1]; offset++)
-	    {
-	      int j = csrColumnOffsets_DofLoops.data()[offset];
-	      // compute flux correction
-	      double fij = dt*(MC.data()[ij]*(uDotLow.data()[i]-uDotLow.data()[j]) + dLow.data()[ij]*(uLow.data()[i]-uLow.data()[j]));
-	      // compute limiters
-	      double Lij = 1.0;
-	      Lij = fij > 0 ? fmin(Rposi,Rneg[j]) : fmin(Rnegi,Rpos[j]);
-	      // compute ith_limited_flux_correction
-	      ith_limited_flux_correction += Lij*fij;
-	      ij+=1;
-	    }
 	  double mi = ML.data()[i];
 	  solLim[i] += 1./mi*ith_limited_flux_correction;
-	}
+	});
     }
 
     void calculateResidual_entropy_viscosity(arguments_dict& args)
     {
+      updatePskTable(args);
       xt::pyarray<double>& globalJacobian = args.array<double>("globalJacobian");
       double Theta = args.scalar<double>("Theta");
       xt::pyarray<double>& bc_mask = args.array<double>("bc_mask");
@@ -1824,8 +1741,6 @@ namespace proteus
 	  anb_seepage_flux=0.0;
 
 
-      double Rpos[numDOFs], Rneg[numDOFs];
-      //double FluxCorrectionMatrix[NNZ];
       // NOTE: This function follows a different (but equivalent) implementation of the smoothness based indicator than NCLS.h
       // Allocate space for the transport matrices
       // This is used for first order KUZMIN'S METHOD
@@ -1975,6 +1890,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes[eN]],
 				   n.data()[elementMaterialTypes[eN]],
+				   elementMaterialTypes[eN],
 				   thetaR.data()[elementMaterialTypes[eN]],
 				   thetaSR.data()[elementMaterialTypes[eN]],
 				   &KWs.data()[elementMaterialTypes[eN]*nnz],			      
@@ -1995,6 +1911,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes[eN]],
 				   n.data()[elementMaterialTypes[eN]],
+				   elementMaterialTypes[eN],
 				   thetaR.data()[elementMaterialTypes[eN]],
 				   thetaSR.data()[elementMaterialTypes[eN]],
 				   &KWs.data()[elementMaterialTypes[eN]*nnz],			      
@@ -2587,6 +2504,7 @@ namespace proteus
 				       gravity.data(),
 				       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 				       n.data()[elementMaterialTypes.data()[0]],
+				       elementMaterialTypes.data()[0],
 				       thetaR.data()[elementMaterialTypes.data()[0]],
 				       thetaSR.data()[elementMaterialTypes.data()[0]],
 				       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2618,6 +2536,7 @@ namespace proteus
 				       gravity.data(),
 				       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 				       n.data()[elementMaterialTypes.data()[0]],
+				       elementMaterialTypes.data()[0],
 				       thetaR.data()[elementMaterialTypes.data()[0]],
 				       thetaSR.data()[elementMaterialTypes.data()[0]],
 				       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2652,6 +2571,7 @@ namespace proteus
 				       gravity.data(),
 				       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 				       n.data()[elementMaterialTypes.data()[0]],
+				       elementMaterialTypes.data()[0],
 				       thetaR.data()[elementMaterialTypes.data()[0]],
 				       thetaSR.data()[elementMaterialTypes.data()[0]],
 				       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2678,6 +2598,7 @@ namespace proteus
 				       gravity.data(),
 				       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 				       n.data()[elementMaterialTypes.data()[0]],
+				       elementMaterialTypes.data()[0],
 				       thetaR.data()[elementMaterialTypes.data()[0]],
 				       thetaSR.data()[elementMaterialTypes.data()[0]],
 				       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2714,6 +2635,7 @@ namespace proteus
 			       gravity.data(),
 			       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 			       n.data()[elementMaterialTypes.data()[0]],
+			       elementMaterialTypes.data()[0],
 			       thetaR.data()[elementMaterialTypes.data()[0]],
 			       thetaSR.data()[elementMaterialTypes.data()[0]],
 			       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2734,6 +2656,7 @@ namespace proteus
 			       gravity.data(),
 			       alpha.data()[elementMaterialTypes.data()[0]],//cek hack, only for 1 material
 			       n.data()[elementMaterialTypes.data()[0]],
+			       elementMaterialTypes.data()[0],
 			       thetaR.data()[elementMaterialTypes.data()[0]],
 			       thetaSR.data()[elementMaterialTypes.data()[0]],
 			       &KWs.data()[elementMaterialTypes.data()[0]*nnz],			      
@@ -2918,8 +2841,21 @@ namespace proteus
 	}
     }
 
+    void evaluatePskTable(arguments_dict& args)
+    {
+      updatePskTable(args);
+      int material = args.scalar<int>("material");
+      xt::pyarray<double>& x = args.array<double>("x");
+      xt::pyarray<double>& value = args.array<double>("value");
+      xt::pyarray<double>& derivative = args.array<double>("derivative");
+      if (!usePskTable)
+        throw std::invalid_argument("Richards: evaluatePskTable needs pskTableTolerance > 0");
+      pskTable.evaluate(material, x.size(), x.data(), value.data(), derivative.data());
+    }
+
     void calculateMassMatrix(arguments_dict& args)
     {
+      updatePskTable(args);
       //element
       double dt = args.scalar<double>("dt");
       xt::pyarray<double>& mesh_trial_ref = args.array<double>("mesh_trial_ref");
@@ -3080,6 +3016,7 @@ namespace proteus
 				   gravity.data(),
 				   alpha.data()[elementMaterialTypes.data()[eN]],
 				   n.data()[elementMaterialTypes.data()[eN]],
+				   elementMaterialTypes.data()[eN],
 				   thetaR.data()[elementMaterialTypes.data()[eN]],
 				   thetaSR.data()[elementMaterialTypes.data()[eN]],
 				   &KWs.data()[elementMaterialTypes.data()[eN]*nnz],			      
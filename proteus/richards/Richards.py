@@ -238,7 +238,9 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
                  # FOR ARTIFICIAL COMPRESSION
                  cK=1.0,
                  # OUTPUT quantDOFs
-                 outputQuantDOFs=False, ):
+                 outputQuantDOFs=False,
+                 # TABULATED VAN GENUCHTEN-MUALEM RELATIONS IF > 0
+                 pskTableTolerance=0.0):
         self.anb_seepage_flux= 0.00
         #self.anb_seepage_flux_n =0.0
         variableNames=['pressure_head']
@@ -255,6 +257,7 @@ class Coefficients(proteus.TransportCoefficients.TC_base):
         self.beta=beta
         self.vgm_n_types = vgm_n_types
         self.vgm_alpha_types = vgm_alpha_types
+        self.pskTableTolerance = pskTableTolerance
         self.thetaR_types    = thetaR_types
         self.thetaSR_types   = thetaSR_types
         self.elementMaterialTypes = None
@@ -1242,6 +1245,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["gravity"] = self.coefficients.gravity
         argsDict["alpha"] = self.coefficients.vgm_alpha_types
         argsDict["n"] = self.coefficients.vgm_n_types
+        argsDict["pskTableTolerance"] = self.coefficients.pskTableTolerance
         argsDict["thetaR"] = self.coefficients.thetaR_types
         argsDict["thetaSR"] = self.coefficients.thetaSR_types
         argsDict["KWs"] = self.coefficients.Ksw_types
@@ -1699,6 +1703,7 @@ class LevelModel(proteus.Transport.OneLevelTransport):
         argsDict["gravity"] = self.coefficients.gravity
         argsDict["alpha"] = self.coefficients.vgm_alpha_types
         argsDict["n"] = self.coefficients.vgm_n_types
+        argsDict["pskTableTolerance"] = self.coefficients.pskTableTolerance
         argsDict["thetaR"] = self.coefficients.thetaR_types
         argsDict["thetaSR"] = self.coefficients.thetaSR_types
         argsDict["KWs"] = self.coefficients.Ksw_types
@@ -24,11 +24,12 @@ PYBIND11_MODULE(cRichards, m)
 
     py::class_<Richards_base>(m, "cRichards_base")
         .def(py::init(&proteus::newRichards))
-        .def("calculateResidual", &Richards_base::calculateResidual)
-        .def("calculateJacobian", &Richards_base::calculateJacobian)
-        .def("invert", &Richards_base::invert)
-        .def("FCTStep", &Richards_base::FCTStep)
-        .def("kth_FCT_step", &Richards_base::kth_FCT_step)
-        .def("calculateResidual_entropy_viscosity", &Richards_base::calculateResidual_entropy_viscosity)
-        .def("calculateMassMatrix", &Richards_base::calculateMassMatrix);
+        .def("calculateResidual", &Richards_base::calculateResidual, proteus::release_gil())
+        .def("calculateJacobian", &Richards_base::calculateJacobian, proteus::release_gil())
+        .def("invert", &Richards_base::invert, proteus::release_gil())
+        .def("FCTStep", &Richards_base::FCTStep, proteus::release_gil())
+        .def("kth_FCT_step", &Richards_base::kth_FCT_step, proteus::release_gil())
+        .def("calculateResidual_entropy_viscosity", &Richards_base::calculateResidual_entropy_viscosity, proteus::release_gil())
+        .def("calculateMassMatrix", &Richards_base::calculateMassMatrix, proteus::release_gil())
+        .def("evaluatePskTable", &Richards_base::evaluatePskTable, proteus::release_gil());
 }
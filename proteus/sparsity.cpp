@@ -1,34 +1,40 @@
 #include "sparsity.h"
+#include <iterator>
 
 namespace proteus
 {
-  void SparsityInfo::findNonzeros(int nElements_global,
-                                  int nDOF_test_element,
-                                  int nDOF_trial_element,
-                                  int* nFreeDOF_test,
-                                  int* freeGlobal_test,
-                                  int* nFreeDOF_trial,
-                                  int* freeGlobal_trial,
-                                  int offset_test,
-                                  int stride_test,
-                                  int offset_trial,
-                                  int stride_trial,
-                                  int hasNumericalFlux,
-                                  int hasDiffusionInMixedForm,
-                                  int needNumericalFluxJacobian,
-                                  int nElementBoundaries_element,
-                                  int* elementNeighborsArray,
-                                  int nInteriorElementBoundaries_global,
-                                  int* interiorElementBoundariesArray,
-                                  int* elementBoundaryElementsArray,
-                                  int* elementBoundaryLocalElementBoundariesArray,
-                                  int hasFluxBoundaryConditions,
-                                  int nExteriorElementBoundaries_global,
-                                  int* exteriorElementBoundariesArray,
-                                  int hasOutflowBoundary,
-                                  int needOutflowJacobian)
-  {      
+  /* Call f(I,J) for every (row,column) coupling of one component pair; f is
+     called concurrently when built with OpenMP and sees repeated pairs */
+  template<class F>
+  static void forEachNonzero(int nElements_global,
+                             int nDOF_test_element,
+                             int nDOF_trial_element,
+                             int* nFreeDOF_test,
+                             int* freeGlobal_test,
+                             int* nFreeDOF_trial,
+                             int* freeGlobal_trial,
+                             int offset_test,
+                             int stride_test,
+                             int offset_trial,
+                             int stride_trial,
+                             int hasNumericalFlux,
+                             int hasDiffusionInMixedForm,
+                             int needNumericalFluxJacobian,
+                             int nElementBoundaries_element,
+                             int* elementNeighborsArray,
+                             int nInteriorElementBoundaries_global,
+                             int* interiorElementBoundariesArray,
+                             int* elementBoundaryElementsArray,
+                             int* elementBoundaryLocalElementBoundariesArray,
+                             int hasFluxBoundaryConditions,
+                             int nExteriorElementBoundaries_global,
+                             int* exteriorElementBoundariesArray,
+                             int hasOutflowBoundary,
+                             int needOutflowJacobian,
+                             F f)
+  {
     //elements
+#pragma omp parallel for
     for(int eN=0;eN<nElements_global;eN++)
       {
         for(int ii=0;ii<nFreeDOF_test[eN];ii++)
@@ -37,7 +43,7 @@ namespace proteus
             for(int jj=0;jj<nFreeDOF_trial[eN];jj++)
               {
                 int J = offset_trial + stride_trial*freeGlobal_trial[eN*nDOF_trial_element+jj];
-                columnIndecesMap[I].insert(J);
+                f(I,J);
               }
           }
         //get element neighbor DOF for mixed form diffusion
@@ -56,7 +62,7 @@ namespace proteus
                         for (int jj=0;jj<nFreeDOF_trial[eN_ebN];jj++)
                           {
                             int J = offset_trial + stride_trial*freeGlobal_trial[eN_ebN*nDOF_trial_element+jj];
-                            columnIndecesMap[I].insert(J);
+                            f(I,J);
                           }
                       }
                   }
@@ -67,6 +73,7 @@ namespace proteus
     if (hasNumericalFlux &&
         needNumericalFluxJacobian)
       {
+#pragma omp parallel for
         for(int ebNI=0;ebNI<nInteriorElementBoundaries_global;ebNI++)
           {
             int ebN = interiorElementBoundariesArray[ebNI],
@@ -80,12 +87,12 @@ namespace proteus
                 for (int jj=0;jj<nFreeDOF_trial[left_eN_global];jj++)
                   {
                     int left_J = offset_trial+stride_trial*freeGlobal_trial[left_eN_global*nDOF_trial_element + jj];
-                    columnIndecesMap[left_I].insert(left_J);
+                    f(left_I,left_J);
                   }
                 for (int jj=0;jj<nFreeDOF_trial[right_eN_global];jj++)
                   {
                     int right_J = offset_trial+stride_trial*freeGlobal_trial[right_eN_global*nDOF_trial_element + jj];
-                    columnIndecesMap[left_I].insert(right_J);
+                    f(left_I,right_J);
                   }
               }
             for(int ii=0;ii<nFreeDOF_test[right_eN_global];ii++)
@@ -94,12 +101,12 @@ namespace proteus
                 for(int jj=0;jj<nFreeDOF_trial[left_eN_global];jj++)
                   {
                     int left_J = offset_trial+stride_trial*freeGlobal_trial[left_eN_global*nDOF_trial_element+jj];
-                    columnIndecesMap[right_I].insert(left_J);
+                    f(right_I,left_J);
                   }
                 for(int jj=0;jj<nFreeDOF_trial[right_eN_global];jj++)
                   {
                     int right_J = offset_trial+stride_trial*freeGlobal_trial[right_eN_global*nDOF_trial_element+jj];
-                    columnIndecesMap[right_I].insert(right_J);
+                    f(right_I,right_J);
                   }
               }
             if(hasDiffusionInMixedForm)
@@ -116,7 +123,7 @@ namespace proteus
                             for (int jj=0;jj<nFreeDOF_trial[left_eN_ebN];jj++)
                               {
                                 int left_J = offset_trial+stride_trial*freeGlobal_trial[left_eN_ebN*nDOF_trial_element+jj];
-                                columnIndecesMap[left_I].insert(left_J);
+                                f(left_I,left_J);
                               }
                           }
                         if(right_eN_ebN >= 0)
@@ -124,7 +131,7 @@ namespace proteus
                             for(int jj=0;jj<nFreeDOF_trial[right_eN_ebN];jj++)
                               {
                                 int right_J = offset_trial+stride_trial*freeGlobal_trial[right_eN_ebN*nDOF_trial_element+jj];
-                                columnIndecesMap[left_I].insert(right_J);
+                                f(left_I,right_J);
                               }
                           }
                       }
@@ -136,7 +143,7 @@ namespace proteus
                             for(int jj=0;jj<nFreeDOF_trial[left_eN_ebN];jj++)
                               {
                                 int left_J = offset_trial+stride_trial*freeGlobal_trial[left_eN_ebN*nDOF_trial_element+jj];
-                                columnIndecesMap[right_I].insert(left_J);
+                                f(right_I,left_J);
                               }
                           }
                         if(right_eN_ebN >= 0)
@@ -144,7 +151,7 @@ namespace proteus
                             for(int jj=0;jj<nFreeDOF_trial[right_eN_ebN];jj++)
                               {
                                 int right_J = offset_trial+stride_trial*freeGlobal_trial[right_eN_ebN*nDOF_trial_element+jj];
-                                columnIndecesMap[right_I].insert(right_J);
+                                f(right_I,right_J);
                               }
                           }
                       }
@@ -158,6 +165,7 @@ namespace proteus
         (hasOutflowBoundary &&
          needOutflowJacobian))
       {
+#pragma omp parallel for
         for(int ebNE=0;ebNE<nExteriorElementBoundaries_global;ebNE++)
           {
             int ebN = exteriorElementBoundariesArray[ebNE],
@@ -169,7 +177,7 @@ namespace proteus
                 for (int jj=0;jj<nFreeDOF_trial[eN_global];jj++)
                   {
                     int J = offset_trial+stride_trial*freeGlobal_trial[eN_global*nDOF_trial_element+jj];
-                    columnIndecesMap[I].insert(J);
+                    f(I,J);
                   }
               }
             if(hasNumericalFlux &&
@@ -186,7 +194,7 @@ namespace proteus
                             for(int jj=0;jj<nFreeDOF_trial[eN_ebN];jj++)
                               {
                                 int J = offset_trial+stride_trial*freeGlobal_trial[eN_ebN*nDOF_trial_element+jj];
-                                columnIndecesMap[I].insert(J);
+                                f(I,J);
                               }
                           }
                       }
@@ -194,13 +202,151 @@ namespace proteus
               }
           }
       }
-    //debug
-    //   for (std::map<int, std::set<int> >::iterator mit = columnIndecesMap.begin();mit != columnIndecesMap.end();mit++)
-    //     {
-    //       for(std::set<int>::iterator sit = mit->second.begin();sit!=mit->second.end();sit++)
-    //         std::cout<<*sit<<'\t';
-    //       std::cout<<std::endl;
-    //     }
+  }
+
+  void SparsityInfo::findNonzeros(int nElements_global,
+                                  int nDOF_test_element,
+                                  int nDOF_trial_element,
+                                  int* nFreeDOF_test,
+                                  int* freeGlobal_test,
+                                  int* nFreeDOF_trial,
+                                  int* freeGlobal_trial,
+                                  int offset_test,
+                                  int stride_test,
+                                  int offset_trial,
+                                  int stride_trial,
+                                  int hasNumericalFlux,
+                                  int hasDiffusionInMixedForm,
+                                  int needNumericalFluxJacobian,
+                                  int nElementBoundaries_element,
+                                  int* elementNeighborsArray,
+                                  int nInteriorElementBoundaries_global,
+                                  int* interiorElementBoundariesArray,
+                                  int* elementBoundaryElementsArray,
+                                  int* elementBoundaryLocalElementBoundariesArray,
+                                  int hasFluxBoundaryConditions,
+                                  int nExteriorElementBoundaries_global,
+                                  int* exteriorElementBoundariesArray,
+                                  int hasOutflowBoundary,
+                                  int needOutflowJacobian)
+  {
+    //rows touched by this component pair
+    int nRows=0;
+#pragma omp parallel for reduction(max:nRows)
+    for(int eN=0;eN<nElements_global;eN++)
+      for(int ii=0;ii<nFreeDOF_test[eN];ii++)
+        nRows = std::max(nRows,offset_test + stride_test*freeGlobal_test[eN*nDOF_test_element+ii] + 1);
+    //first pass: count the couplings of each row, repeats included
+    std::vector<int> rowptr_new(nRows+1,0);
+    forEachNonzero(nElements_global,
+                   nDOF_test_element,
+                   nDOF_trial_element,
+                   nFreeDOF_test,
+                   freeGlobal_test,
+                   nFreeDOF_trial,
+                   freeGlobal_trial,
+                   offset_test,
+                   stride_test,
+                   offset_trial,
+                   stride_trial,
+                   hasNumericalFlux,
+                   hasDiffusionInMixedForm,
+                   needNumericalFluxJacobian,
+                   nElementBoundaries_element,
+                   elementNeighborsArray,
+                   nInteriorElementBoundaries_global,
+                   interiorElementBoundariesArray,
+                   elementBoundaryElementsArray,
+                   elementBoundaryLocalElementBoundariesArray,
+                   hasFluxBoundaryConditions,
+                   nExteriorElementBoundaries_global,
+                   exteriorElementBoundariesArray,
+                   hasOutflowBoundary,
+                   needOutflowJacobian,
+                   [&rowptr_new](int I, int J)
+                   {
+#pragma omp atomic
+                     rowptr_new[I+1]++;
+                   });
+    for(int I=0;I<nRows;I++)
+      rowptr_new[I+1] += rowptr_new[I];
+    //second pass: fill the rows
+    std::vector<int> colind_new(rowptr_new[nRows]);
+    std::vector<int> fill(rowptr_new.begin(),rowptr_new.end()-1);
+    forEachNonzero(nElements_global,
+                   nDOF_test_element,
+                   nDOF_trial_element,
+                   nFreeDOF_test,
+                   freeGlobal_test,
+                   nFreeDOF_trial,
+                   freeGlobal_trial,
+                   offset_test,
+                   stride_test,
+                   offset_trial,
+                   stride_trial,
+                   hasNumericalFlux,
+                   hasDiffusionInMixedForm,
+                   needNumericalFluxJacobian,
+                   nElementBoundaries_element,
+                   elementNeighborsArray,
+                   nInteriorElementBoundaries_global,
+                   interiorElementBoundariesArray,
+                   elementBoundaryElementsArray,
+                   elementBoundaryLocalElementBoundariesArray,
+                   hasFluxBoundaryConditions,
+                   nExteriorElementBoundaries_global,
+                   exteriorElementBoundariesArray,
+                   hasOutflowBoundary,
+                   needOutflowJacobian,
+                   [&fill,&colind_new](int I, int J)
+                   {
+                     int k;
+#pragma omp atomic capture
+                     k = fill[I]++;
+                     colind_new[k] = J;
+                   });
+    //sort and unique each row in place, then compact
+    std::vector<int> rowSize(nRows);
+#pragma omp parallel for schedule(dynamic,256)
+    for(int I=0;I<nRows;I++)
+      {
+        int* row_begin = colind_new.data() + rowptr_new[I];
+        int* row_end = colind_new.data() + rowptr_new[I+1];
+        std::sort(row_begin,row_end);
+        rowSize[I] = int(std::unique(row_begin,row_end) - row_begin);
+      }
+    int nnz_new=0;
+    for(int I=0;I<nRows;I++)
+      {
+        const int start = rowptr_new[I];
+        rowptr_new[I] = nnz_new;
+        std::copy(colind_new.begin()+start,colind_new.begin()+start+rowSize[I],colind_new.begin()+nnz_new);
+        nnz_new += rowSize[I];
+      }
+    rowptr_new[nRows] = nnz_new;
+    colind_new.resize(nnz_new);
+    //merge with the pattern of the previous component pairs
+    const int nRows_old = int(patternRowptr.size()) - 1;
+    if (nRows_old <= 0)
+      {
+        patternRowptr.swap(rowptr_new);
+        patternColind.swap(colind_new);
+        return;
+      }
+    const int nRows_merged = std::max(nRows_old,nRows);
+    std::vector<int> rowptr_merged(nRows_merged+1,0), colind_merged;
+    colind_merged.reserve(patternColind.size() + colind_new.size());
+    for(int I=0;I<nRows_merged;I++)
+      {
+        const int* a_begin = patternColind.data() + (I < nRows_old ? patternRowptr[I] : 0);
+        const int* a_end = patternColind.data() + (I < nRows_old ? patternRowptr[I+1] : 0);
+        const int* b_begin = colind_new.data() + (I < nRows ? rowptr_new[I] : 0);
+        const int* b_end = colind_new.data() + (I < nRows ? rowptr_new[I+1] : 0);
+        std::set_union(a_begin,a_end,b_begin,b_end,std::back_inserter(colind_merged));
+        rowptr_merged[I+1] = int(colind_merged.size());
+      }
+    patternRowptr.swap(rowptr_merged);
+    patternColind.swap(colind_merged);
   }
 
   void SparsityInfo::getOffsets_CSR(int nElements_global,
@@ -236,6 +382,7 @@ namespace proteus
                                     int* csrColumnOffsets_eb_eNebN)
   {
     //elements
+#pragma omp parallel for
     for(int eN=0;eN<nElements_global;eN++)
       {
         for(int ii=0;ii<nFreeDOF_test[eN];ii++)
@@ -247,7 +394,7 @@ namespace proteus
                 int J = offset_trial + stride_trial*freeGlobal_trial[eN*nDOF_trial_element+jj];
                 csrColumnOffsets[eN*nDOF_test_element*nDOF_trial_element+
                                  ii*nDOF_trial_element+
-                                 jj] = columnOffsetsMap[I][J];
+                                 jj] = columnOffset(I,J);
               }
           }
         //get element neighbor DOF for mixed form diffusion
@@ -269,7 +416,7 @@ namespace proteus
                             csrColumnOffsets_eNebN[eN*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                    ebN*nDOF_test_element*nDOF_trial_element+
                                                    ii*nDOF_test_element+
-                                                   jj] = columnOffsetsMap[I][J];
+                                                   jj] = columnOffset(I,J);
                           }
                       }
                   }
@@ -280,6 +427,7 @@ namespace proteus
     if (hasNumericalFlux &&
         needNumericalFluxJacobian)
       {
+#pragma omp parallel for
         for(int ebNI=0;ebNI<nInteriorElementBoundaries_global;ebNI++)
           {
             int ebN = interiorElementBoundariesArray[ebNI],
@@ -297,7 +445,7 @@ namespace proteus
                                         0*2*nDOF_test_element*nDOF_trial_element+
                                         0*nDOF_test_element*nDOF_trial_element+
                                         ii*nDOF_trial_element+
-                                        jj] = columnOffsetsMap[left_I][left_J];
+                                        jj] = columnOffset(left_I,left_J);
                   }
                 for (int jj=0;jj<nFreeDOF_trial[right_eN_global];jj++)
                   {
@@ -306,7 +454,7 @@ namespace proteus
                                         0*2*nDOF_test_element*nDOF_trial_element+
                                         1*nDOF_test_element*nDOF_trial_element+
                                         ii*nDOF_trial_element+
-                                        jj] = columnOffsetsMap[left_I][right_J];
+                                        jj] = columnOffset(left_I,right_J);
                   }
               }
             for(int ii=0;ii<nFreeDOF_test[right_eN_global];ii++)
@@ -319,7 +467,7 @@ namespace proteus
                                         1*2*nDOF_test_element*nDOF_trial_element+
                                         0*nDOF_test_element*nDOF_trial_element+
                                         ii*nDOF_trial_element+
-                                        jj] = columnOffsetsMap[right_I][left_J];
+                                        jj] = columnOffset(right_I,left_J);
                   }
                 for(int jj=0;jj<nFreeDOF_trial[right_eN_global];jj++)
                   {
@@ -328,7 +476,7 @@ namespace proteus
                                         1*2*nDOF_test_element*nDOF_trial_element+
                                         1*nDOF_test_element*nDOF_trial_element+
                                         ii*nDOF_trial_element+
-                                        jj] = columnOffsetsMap[right_I][right_J];
+                                        jj] = columnOffset(right_I,right_J);
                   }
               }
             if(hasDiffusionInMixedForm)
@@ -350,7 +498,7 @@ namespace proteus
                                                           0*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                           ebN_eN*nDOF_test_element*nDOF_trial_element+
                                                           ii*nDOF_trial_element+
-                                                          jj] = columnOffsetsMap[left_I][left_J];
+                                                          jj] = columnOffset(left_I,left_J);
                               }
                           }
                         if(right_eN_ebN >= 0)
@@ -363,7 +511,7 @@ namespace proteus
                                                           1*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                           ebN_eN*nDOF_test_element*nDOF_trial_element+
                                                           ii*nDOF_trial_element+
-                                                          jj] = columnOffsetsMap[left_I][right_J];
+                                                          jj] = columnOffset(left_I,right_J);
                               }
                           }
                       }
@@ -380,7 +528,7 @@ namespace proteus
                                                           0*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                           ebN_eN*nDOF_test_element*nDOF_trial_element+
                                                           ii*nDOF_trial_element+
-                                                          jj] = columnOffsetsMap[right_I][left_J];
+                                                          jj] = columnOffset(right_I,left_J);
                               }
                           }
                         if(right_eN_ebN >= 0)
@@ -393,7 +541,7 @@ namespace proteus
                                                           1*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                           ebN_eN*nDOF_test_element*nDOF_trial_element+
                                                           ii*nDOF_trial_element+
-                                                          jj] = columnOffsetsMap[right_I][right_J];
+                                                          jj] = columnOffset(right_I,right_J);
                               }
                           }
                       }
@@ -407,6 +555,7 @@ namespace proteus
         (hasOutflowBoundary &&
          needOutflowJacobian))
       {
+#pragma omp parallel for
         for(int ebNE=0;ebNE<nExteriorElementBoundaries_global;ebNE++)
           {
             int ebN = exteriorElementBoundariesArray[ebNE],
@@ -422,7 +571,7 @@ namespace proteus
                                         0*2*nDOF_test_element*nDOF_trial_element+
                                         0*nDOF_test_element*nDOF_trial_element+
                                         ii*nDOF_trial_element+
-                                        jj] = columnOffsetsMap[I][J];
+                                        jj] = columnOffset(I,J);
                   }
               }
             if(hasNumericalFlux &&
@@ -444,7 +593,7 @@ namespace proteus
                                                           0*nElementBoundaries_element*nDOF_test_element*nDOF_trial_element+
                                                           ebN_eN*nDOF_test_element*nDOF_trial_element+
                                                           ii*nDOF_trial_element+
-                                                          jj] = columnOffsetsMap[I][J];
+                                                          jj] = columnOffset(I,J);
                               }
                           }
                       }
@@ -456,36 +605,21 @@ namespace proteus
   
   void SparsityInfo::getCSR()
   {
-    //debug
-    //   for (std::map<int, std::set<int> >::iterator mit = self->columnIndecesMap.begin();mit != self->columnIndecesMap.end();mit++)
-    //     {
-    //       for(std::set<int>::iterator sit = mit->second.begin();sit!=mit->second.end();sit++)
-    //         std:://cout<<*sit<<'\t';
-    //       std::cout<<std::endl;
-    //     }
-    nrows = int(columnIndecesMap.size())+1;
+    if (rowptr != NULL)
+      delete [] rowptr;
+    if (colind != NULL)
+      delete [] colind;
+    if (nzval != NULL)
+      delete [] nzval;
+    if (patternRowptr.empty())
+      patternRowptr.assign(1,0);
+    nrows = int(patternRowptr.size());
+    nnz = patternRowptr[nrows-1];
     rowptr = new int[nrows];
-    rowptr[0] = 0;
-    for(int I=1;I< columnIndecesMap.size()+1;I++)
-      rowptr[I]=rowptr[I-1] + int(columnIndecesMap[I-1].size());
-    nnz = rowptr[columnIndecesMap.size()];
     colind = new int[nnz];
     nzval = new double[nnz];
-    int max_nonzeros=0;
-    for(int I=0;I< columnIndecesMap.size();I++)
-      {
-        int offset=0;
-        for(std::set<int>::iterator sit=columnIndecesMap[I].begin();sit != columnIndecesMap[I].end();sit++)
-          {
-            columnOffsetsMap[I][*sit] = offset;
-            assert(rowptr[I]+offset < nnz);
-            colind[rowptr[I]+offset]=*sit;
-            offset++;
-          }
-        std::sort(&colind[rowptr[I]],&colind[rowptr[I+1]]);
-        max_nonzeros = std::max(max_nonzeros,rowptr[I+1] - rowptr[I]);
-      }
-    //std::cout<<"Proteus: Maximum nonzeros in any row is "<<max_nonzeros<<std::endl;
+    std::copy(patternRowptr.begin(),patternRowptr.end(),rowptr);
+    std::copy(patternColind.begin(),patternColind.end(),colind);
   }
   
   SparsityInfo::SparsityInfo():
@@ -1,12 +1,22 @@
 #ifndef SPARSITYINFO_H
 #define SPARSITYINFO_H
-#include <map>
-#include <set>
+#include <vector>
 #include <cassert>
 #include <algorithm>
 
 namespace proteus
 {
+  /**
+   * \brief Nonzero pattern of a global Jacobian in CSR form
+   *
+   * Each call to findNonzeros adds the couplings of one (test,trial)
+   * component pair. The pattern is built in two passes over the
+   * element/boundary couplings (count per row, then fill) followed by a
+   * per-row sort and unique, and is merged row by row into the pattern
+   * of the previous calls, so the cost is linear in the number of
+   * couplings. getOffsets_CSR looks up column offsets by bisection in
+   * the sorted rows. The passes are threaded when built with OpenMP.
+   */
   class SparsityInfo
   {
   public:
@@ -74,8 +84,16 @@ namespace proteus
     int *rowptr, *colind;
     double* nzval;
   private:
-    std::map<int,std::set<int> > columnIndecesMap;
-    std::map<int,std::map<int,int> > columnOffsetsMap;
+    /// offset of column J in row I, 0 if (I,J) is not in the pattern
+    inline int columnOffset(int I, int J) const
+    {
+      const int* row_begin = patternColind.data() + patternRowptr[I];
+      const int* row_end = patternColind.data() + patternRowptr[I+1];
+      const int* it = std::lower_bound(row_begin, row_end, J);
+      return (it != row_end && *it == J) ? int(it - row_begin) : 0;
+    }
+    std::vector<int> patternRowptr;
+    std::vector<int> patternColind;
   };
 }
 #endif
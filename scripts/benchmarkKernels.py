@@ -0,0 +1,540 @@
+#!/usr/bin/env python
+"""
+Micro-benchmark for the residual and Jacobian kernels of the CompKernel-based models
+
+Each model is set up from one of the regression problems under test/ on
+a sequence of meshes. The first residual and Jacobian call the model
+makes into its compiled kernel is intercepted, the arrays of the
+argument dictionary are saved, and the kernel is called again on the
+same arguments a fixed number of times before the arrays are restored.
+Every (problem, size, thread count) combination runs in its own process,
+so OMP_NUM_THREADS and the Context options are read fresh each time.
+
+The bandwidth counts every array of the argument dictionary once per
+call, so it is a lower bound on the memory traffic of the kernel.
+
+With --overlap the first residual calls of two models of the same
+problem are timed one after the other and then from two Python threads,
+which overlap since the kernels run without the GIL, and the results of
+the two runs are compared.
+
+With --psk-table the tabulated van Genuchten-Mualem relations of
+Richards are timed against their analytic numpy evaluation.
+
+With --redistance the first RDLS solve of the dam break, iterating on
+the redistancing equation, is timed against RDLS.FastMarching started
+from the same level set, and the two distances are compared near the
+interface.
+
+Example::
+
+    python scripts/benchmarkKernels.py --models RANS2P,VOF --threads 1,2,4
+    python scripts/benchmarkKernels.py --overlap VOF,NCLS --sizes 0.025
+    python scripts/benchmarkKernels.py --psk-table --sizes 1000000
+    python scripts/benchmarkKernels.py --redistance --sizes 0.05,0.025
+"""
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+#: problems the kernels are benchmarked on, with the parameter setting the mesh size
+PROBLEMS = {
+    'damBreak': {'kind': 'TwoPhaseFlow',
+                 'path': 'test/TwoPhaseFlow',
+                 'case': 'damBreak',
+                 'context': 'final_time=0.1 dt_output=0.1',
+                 'size': 'he',
+                 'sizes': [0.1, 0.05, 0.025],
+                 'models': ['RANS2P', 'VOF', 'NCLS', 'MCorr']},
+    'solitary_wave': {'kind': 'SWEs',
+                      'path': 'test/SWFlow',
+                      'case': 'solitary_wave',
+                      'context': 'sw_model=0 final_time=0.1 dt_output=0.1',
+                      'size': 'refinement',
+                      'sizes': [3, 4, 5],
+                      'models': ['SW2DCV']},
+    'richards': {'kind': 'pn',
+                 'path': 'test/richards',
+                 'case': ('re_vgm_sand_10x10x10_3d_p', 're_vgm_sand_10x10x10_3d_c0p1_n'),
+                 'size': 'nn',
+                 'sizes': [11, 21, 31],
+                 'models': ['Richards']},
+}
+
+#: level model attribute holding the compiled kernel of each model
+KERNELS = {'RANS2P': 'rans2p',
+           'VOF': 'vof',
+           'NCLS': 'ncls',
+           'MCorr': 'mcorr',
+           'SW2DCV': 'sw2d',
+           'Richards': 'richards'}
+
+#: problem whose level set redistancing --redistance times
+REDISTANCE_PROBLEM = 'damBreak'
+
+RESULT_TAG = 'KERNEL_BENCHMARK '
+
+
+def kernelKind(name):
+    """Classify a kernel entry point as residual or Jacobian assembly"""
+    if name.startswith('calculateResidual'):
+        return 'residual'
+    if name in ('calculateJacobian', 'calculateMassMatrix', 'calculateLumpedMassMatrix'):
+        return 'jacobian'
+    return None
+
+
+class KernelTimer(object):
+    """Times the first residual and Jacobian call of each requested model"""
+
+    def __init__(self, pending, repeat):
+        self.pending = set(pending)
+        self.repeat = repeat
+        self.results = []
+
+    def measure(self, model, levelModel, name, call, argsDict, args):
+        import numpy as np
+        kind = kernelKind(name)
+        if (model, kind) not in self.pending:
+            return
+        self.pending.remove((model, kind))
+        arrays = {}
+        for a in getattr(argsDict, 'arrays', {}).values():
+            arrays[id(a)] = a
+        saved = [(a, a.copy()) for a in arrays.values()]
+        times = []
+        for r in range(self.repeat):
+            start = time.perf_counter()
+            call(argsDict, *args)
+            times.append(time.perf_counter() - start)
+        for a, a_saved in saved:
+            np.copyto(a, a_saved)
+        times.sort()
+        self.results.append({'model': model,
+                             'kernel': name,
+                             'nElements': int(levelModel.mesh.nElements_global),
+                             'seconds': times[len(times)//2],
+                             'bytes': int(sum(a.nbytes for a in arrays.values()))})
+        if not self.pending:
+            self.report()
+            #skip the rest of the simulation
+            os._exit(0)
+
+    def report(self):
+        sys.stdout.write(RESULT_TAG+json.dumps(self.results)+'\n')
+        sys.stdout.flush()
+
+
+class OverlapTimer(object):
+    """Times the first residual calls of several models run in sequence and concurrently"""
+
+    def __init__(self, models, repeat):
+        self.models = list(models)
+        self.repeat = repeat
+        self.calls = {}
+        self.results = []
+
+    def measure(self, model, levelModel, name, call, argsDict, args):
+        if kernelKind(name) != 'residual' or model in self.calls:
+            return
+        arrays = {}
+        for a in getattr(argsDict, 'arrays', {}).values():
+            arrays[id(a)] = a
+        self.calls[model] = {'kernel': name,
+                             'call': call,
+                             'argsDict': argsDict,
+                             'args': args,
+                             'nElements': int(levelModel.mesh.nElements_global),
+                             'saved': [(a, a.copy()) for a in arrays.values()]}
+        if len(self.calls) == len(self.models):
+            self.run()
+            self.report()
+            os._exit(0)
+
+    def restore(self):
+        import numpy as np
+        for model in self.models:
+            for a, a_saved in self.calls[model]['saved']:
+                np.copyto(a, a_saved)
+
+    def outputs(self):
+        return [a.copy() for model in self.models for a, a_saved in self.calls[model]['saved']]
+
+    def sequential(self):
+        for model in self.models:
+            c = self.calls[model]
+            c['call'](c['argsDict'], *c['args'])
+
+    def concurrent(self):
+        threads = []
+        for model in self.models:
+            c = self.calls[model]
+            threads.append(threading.Thread(target=c['call'], args=(c['argsDict'],)+tuple(c['args'])))
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+    def run(self):
+        import numpy as np
+        seconds = {}
+        results = {}
+        for mode, run in (('sequential', self.sequential), ('concurrent', self.concurrent)):
+            times = []
+            for r in range(self.repeat):
+                self.restore()
+                start = time.perf_counter()
+                run()
+                times.append(time.perf_counter() - start)
+            times.sort()
+            seconds[mode] = times[len(times)//2]
+            results[mode] = self.outputs()
+        self.restore()
+        identical = all(np.array_equal(a, b, equal_nan=True)
+                        for a, b in zip(results['sequential'], results['concurrent']))
+        self.results.append({'models': self.models,
+                             'kernels': [self.calls[m]['kernel'] for m in self.models],
+                             'nElements': [self.calls[m]['nElements'] for m in self.models],
+                             'sequential': seconds['sequential'],
+                             'concurrent': seconds['concurrent'],
+                             'identical': identical})
+
+    def report(self):
+        sys.stdout.write(RESULT_TAG+json.dumps(self.results)+'\n')
+        sys.stdout.flush()
+
+
+class RedistanceTimer(object):
+    """Times the first RDLS solve against fast marching from the same level set"""
+
+    def __init__(self, model, repeat):
+        self.model = model
+        self.repeat = repeat
+        self.solveMultilevel = model.solver.solveMultilevel
+        model.solver.solveMultilevel = self.solve
+
+    def solve(self, uList, rList, par_uList=None, par_rList=None):
+        import numpy as np
+        from proteus.mprans import RDLS
+        levelModel = self.model.levelModelList[-1]
+        levelSolver = self.model.solver.solverList[-1]
+        phi = levelModel.u[0].dof.copy()
+        times = {'pseudoTime': [], 'fastMarching': []}
+        for r in range(self.repeat):
+            levelModel.u[0].dof[:] = phi
+            levelModel.setFreeDOF(uList[-1])
+            start = time.perf_counter()
+            self.solveMultilevel(uList=uList, rList=rList, par_uList=par_uList, par_rList=par_rList)
+            times['pseudoTime'].append(time.perf_counter() - start)
+        its = levelSolver.its
+        distance = levelModel.u[0].dof.copy()
+        fastMarching = RDLS.FastMarching(None, levelModel, du=levelSolver.du, par_du=levelSolver.par_du)
+        fastMarching.par_fullOverlap = levelSolver.par_fullOverlap
+        for r in range(self.repeat):
+            levelModel.u[0].dof[:] = phi
+            levelModel.setFreeDOF(uList[-1])
+            start = time.perf_counter()
+            fastMarching.solve(uList[-1], rList[-1],
+                               par_u=par_uList[-1] if par_uList else None,
+                               par_r=par_rList[-1] if par_rList else None)
+            times['fastMarching'].append(time.perf_counter() - start)
+        near = np.abs(distance) < 3.0*levelModel.mesh.h
+        results = [{'nElements': int(levelModel.mesh.nElements_global),
+                    'nDOF': int(levelModel.u[0].dof.shape[0]),
+                    'its': int(its),
+                    'pseudoTime': sorted(times['pseudoTime'])[self.repeat//2],
+                    'fastMarching': sorted(times['fastMarching'])[self.repeat//2],
+                    'maxDifference': float(np.abs(levelModel.u[0].dof - distance)[near].max(initial=0.0))}]
+        sys.stdout.write(RESULT_TAG+json.dumps(results)+'\n')
+        sys.stdout.flush()
+        #skip the rest of the simulation
+        os._exit(0)
+
+
+class KernelProxy(object):
+    """Forwards to a compiled kernel, timing its residual and Jacobian entry points"""
+
+    def __init__(self, kernel, model, levelModel, timer):
+        self._kernel = kernel
+        self._model = model
+        self._levelModel = levelModel
+        self._timer = timer
+
+    def __getattr__(self, name):
+        call = getattr(self._kernel, name)
+        if kernelKind(name) is None:
+            return call
+        def timed(argsDict, *args):
+            result = call(argsDict, *args)
+            self._timer.measure(self._model, self._levelModel, name, call, argsDict, args)
+            return result
+        return timed
+
+
+def recordArguments():
+    """Make the models build argument dictionaries that remember their arrays"""
+    import numpy as np
+    from proteus.mprans import cArgumentsDict
+    class RecordingArgumentsDict(cArgumentsDict.ArgumentsDict):
+        def __init__(self):
+            super(RecordingArgumentsDict, self).__init__()
+            self.arrays = {}
+        def __setitem__(self, key, value):
+            super(RecordingArgumentsDict, self).__setitem__(key, value)
+            if isinstance(value, np.ndarray):
+                self.arrays[key] = value
+    cArgumentsDict.ArgumentsDict = RecordingArgumentsDict
+
+
+def loadProblem(problem, size):
+    """Load the so, p and n modules of a problem the way parun does"""
+    import proteus
+    from proteus import Context, defaults
+    from proteus.iproteus import default_s
+    spec = PROBLEMS[problem]
+    sys.path.insert(0, os.path.join(REPO, spec['path']))
+    Context.contextOptionsString = "{0} {1}={2}".format(spec.get('context', ''), spec['size'], size)
+    pList = []
+    nList = []
+    if spec['kind'] == 'TwoPhaseFlow':
+        import proteus.TwoPhaseFlow.TwoPhaseFlowProblem as TpFlow
+        case = __import__(spec['case'])
+        Context.setFromModule(case)
+        prob = [obj for obj in Context.get() if isinstance(obj, TpFlow.TwoPhaseFlowProblem)][0]
+        prob.initializeAll()
+        so = prob.so
+        so.name = spec['case']
+        for (pModule, nModule) in so.pnList:
+            pList.append(pModule)
+            nList.append(nModule)
+    elif spec['kind'] == 'SWEs':
+        #SWEs_so finds the case file on the parun command line
+        sys.argv = ['parun', '--SWEs', spec['case']+'.py']
+        path_models = os.path.join(proteus.__path__[0], 'SWFlow', 'models')
+        path_utils = os.path.join(proteus.__path__[0], 'SWFlow', 'utils')
+        so = defaults.load_system('SWEs_so', path=path_utils)
+        for (pModule, nModule) in so.pnList:
+            pList.append(defaults.load_physics(pModule, path=path_models))
+            nList.append(defaults.load_numerics(nModule, path=path_models))
+    else:
+        pModule, nModule = spec['case']
+        so = defaults.System_base()
+        so.pnList = [spec['case']]
+        so.name = pModule[:-2]
+        pList.append(defaults.load_physics(pModule, path=os.path.join(REPO, spec['path'])))
+        nList.append(defaults.load_numerics(nModule, path=os.path.join(REPO, spec['path'])))
+        #structured tetrahedral mesh with size nodes on each side
+        nList[0].nn = nList[0].nnx = nList[0].nny = nList[0].nnz = size
+        so.tnList = nList[0].tnList
+    for p, (pModule, nModule) in zip(pList, so.pnList):
+        if p.name is None:
+            p.name = pModule
+    sList = so.sList if so.sList else [default_s for p in pList]
+    return so, pList, nList, sList
+
+
+def runWorker(problem, size, models, repeat, overlap=False, redistance=False):
+    from proteus.iproteus import opts
+    from proteus import NumericalSolution
+    spec = PROBLEMS[problem]
+    so, pList, nList, sList = loadProblem(problem, type(spec['sizes'][0])(size))
+    recordArguments()
+    ns = NumericalSolution.NS_base(so, pList, nList, sList, opts, None, spec['kind'] == 'TwoPhaseFlow')
+    if redistance:
+        for model in ns.modelList:
+            if type(model.levelModelList[-1]).__module__.split('.')[-1] == 'RDLS':
+                RedistanceTimer(model, repeat)
+        ns.calculateSolution(so.name)
+        return
+    if overlap:
+        timer = OverlapTimer(models, repeat)
+    else:
+        timer = KernelTimer([(m, kind) for m in models for kind in ('residual', 'jacobian')], repeat)
+    for model in ns.modelList:
+        for levelModel in model.levelModelList:
+            name = type(levelModel).__module__.split('.')[-1]
+            if name not in models:
+                continue
+            kernel = getattr(levelModel, KERNELS[name])
+            proxy = KernelProxy(kernel, name, levelModel, timer)
+            setattr(levelModel, KERNELS[name], proxy)
+            #entry points the level model bound to the kernel at construction
+            for key, value in list(vars(levelModel).items()):
+                if getattr(value, '__self__', None) is kernel:
+                    setattr(levelModel, key, getattr(proxy, value.__name__))
+    ns.calculateSolution(so.name)
+    timer.report()
+
+
+def runWorkerProcess(problem, size, models, nThreads, repeat, overlap=False, redistance=False):
+    """Run a worker in a fresh process and return the results it reports"""
+    env = dict(os.environ, OMP_NUM_THREADS=nThreads)
+    workDir = tempfile.mkdtemp(prefix='benchmarkKernels')
+    command = [sys.executable, os.path.abspath(__file__),
+               '--worker', problem, size,
+               '--models' if not overlap else '--overlap', ','.join(models),
+               '--repeat', str(repeat)]
+    if redistance:
+        command.append('--redistance')
+    try:
+        worker = subprocess.run(command, cwd=workDir, env=env,
+                                stdout=subprocess.PIPE, universal_newlines=True)
+    finally:
+        shutil.rmtree(workDir, ignore_errors=True)
+    results = []
+    for line in worker.stdout.splitlines():
+        if line.startswith(RESULT_TAG):
+            results = json.loads(line[len(RESULT_TAG):])
+    if not results:
+        print("{0} {1}={2} with {3} threads failed".format(problem, PROBLEMS[problem]['size'], size, nThreads))
+    return results
+
+
+def runOverlap(problem, models, args):
+    """Compare sequential and concurrent residual assembly of models of one problem"""
+    spec = PROBLEMS[problem]
+    row = "{0:<16} {1:>8} {2:>7} {3:>14} {4:>14} {5:>8} {6:>10}"
+    print(row.format('models', 'size', 'threads', 'sequential ms', 'concurrent ms', 'speedup', 'identical'))
+    sizes = args.sizes.split(',') if args.sizes else [str(s) for s in spec['sizes']]
+    for size in sizes:
+        for nThreads in args.threads.split(','):
+            for r in runWorkerProcess(problem, size, models, nThreads, args.repeat, overlap=True):
+                print(row.format('+'.join(r['models']), size, nThreads,
+                                 "{0:.3f}".format(1.0e3*r['sequential']),
+                                 "{0:.3f}".format(1.0e3*r['concurrent']),
+                                 "{0:.2f}".format(r['sequential']/r['concurrent']),
+                                 str(r['identical'])))
+            sys.stdout.flush()
+
+
+def runRedistance(args):
+    """Compare the iterative RDLS solve with fast marching on the dam break"""
+    spec = PROBLEMS[REDISTANCE_PROBLEM]
+    row = "{0:>8} {1:>10} {2:>7} {3:>6} {4:>14} {5:>16} {6:>8} {7:>14}"
+    print(row.format('size', 'elements', 'threads', 'its', 'iterative ms', 'fast marching ms', 'speedup', 'max difference'))
+    sizes = args.sizes.split(',') if args.sizes else [str(s) for s in spec['sizes']]
+    for size in sizes:
+        for nThreads in args.threads.split(','):
+            for r in runWorkerProcess(REDISTANCE_PROBLEM, size, spec['models'], nThreads, args.repeat, redistance=True):
+                print(row.format(size, r['nElements'], nThreads, r['its'],
+                                 "{0:.3f}".format(1.0e3*r['pseudoTime']),
+                                 "{0:.3f}".format(1.0e3*r['fastMarching']),
+                                 "{0:.2f}".format(r['pseudoTime']/r['fastMarching']),
+                                 "{0:.3e}".format(r['maxDifference'])))
+            sys.stdout.flush()
+
+
+def runPskTable(args):
+    """Time the tabulated van Genuchten-Mualem relations against their analytic evaluation"""
+    import numpy as np
+    from proteus.mprans import cArgumentsDict
+    from proteus.richards import cRichards
+    row = "{0:>10} {1:>10} {2:>14} {3:>14} {4:>8}"
+    print(row.format('points', 'tolerance', 'table ns/pt', 'numpy ns/pt', 'speedup'))
+    richards = cRichards.cRichards_base(1, 2, 2, 2, 2, 1, 0)
+    n = 2.0
+    m = 1.0 - 1.0/n
+    sizes = args.sizes.split(',') if args.sizes else ['1000000']
+    for size in sizes:
+        x = 10.0**np.random.RandomState(1).uniform(-4.0, 4.0, int(size))
+        for tolerance in (1.0e-4, 1.0e-8):
+            argsDict = cArgumentsDict.ArgumentsDict()
+            argsDict["n"] = np.array([n], 'd')
+            argsDict["pskTableTolerance"] = tolerance
+            argsDict["material"] = 0
+            argsDict["x"] = x
+            argsDict["value"] = np.zeros((3, x.shape[0]), 'd')
+            argsDict["derivative"] = np.zeros((3, x.shape[0]), 'd')
+            #build the table outside the timing
+            richards.evaluatePskTable(argsDict)
+            times = {'table': [], 'numpy': []}
+            for r in range(args.repeat):
+                start = time.perf_counter()
+                richards.evaluatePskTable(argsDict)
+                times['table'].append(time.perf_counter() - start)
+                start = time.perf_counter()
+                S = (1.0 + x**n)**(-m)
+                u = x**(n-1.0)*S
+                dS = (1.0 - n)*x**(n-1.0)*S/(1.0 + x**n)
+                du = (n - 1.0)*x**(n-2.0)*S + x**(n-1.0)*dS
+                oneMinusS = -np.expm1(-m*np.log1p(x**n))
+                krw = np.sqrt(S)*(1.0-u)**2
+                krn = np.sqrt(oneMinusS)*u**2
+                dkrw = 0.5/np.sqrt(S)*dS*(1.0-u)**2 - 2.0*np.sqrt(S)*(1.0-u)*du
+                dkrn = -0.5/np.sqrt(oneMinusS)*dS*u**2 + 2.0*np.sqrt(oneMinusS)*u*du
+                times['numpy'].append(time.perf_counter() - start)
+            table = sorted(times['table'])[args.repeat//2]
+            analytic = sorted(times['numpy'])[args.repeat//2]
+            print(row.format(x.shape[0], "{0:.0e}".format(tolerance),
+                             "{0:.1f}".format(1.0e9*table/x.shape[0]),
+                             "{0:.1f}".format(1.0e9*analytic/x.shape[0]),
+                             "{0:.2f}".format(analytic/table)))
+            sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--models', default=','.join(sorted(KERNELS)),
+                        help="comma separated models to benchmark")
+    parser.add_argument('--sizes', default=None,
+                        help="comma separated values of the mesh size parameter of each problem (he, refinement or nn)")
+    parser.add_argument('--threads', default='1',
+                        help="comma separated values of OMP_NUM_THREADS")
+    parser.add_argument('--repeat', type=int, default=10,
+                        help="kernel calls timed per measurement")
+    parser.add_argument('--overlap', default=None,
+                        help="comma separated models of one problem whose residuals are assembled concurrently")
+    parser.add_argument('--psk-table', action='store_true',
+                        help="time the tabulated van Genuchten-Mualem relations of Richards (--sizes are numbers of points)")
+    parser.add_argument('--redistance', action='store_true',
+                        help="time the iterative RDLS solve of the dam break against fast marching")
+    parser.add_argument('--worker', nargs=2, metavar=('PROBLEM', 'SIZE'), help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    if args.psk_table:
+        runPskTable(args)
+        return
+    if args.redistance and not args.worker:
+        runRedistance(args)
+        return
+    models = (args.overlap or args.models).split(',')
+    for m in models:
+        if m not in KERNELS:
+            parser.error("unknown model {0}, choose from {1}".format(m, ','.join(sorted(KERNELS))))
+    if args.worker:
+        runWorker(args.worker[0], args.worker[1], models, args.repeat, args.overlap is not None, args.redistance)
+        return
+    if args.overlap:
+        problems = [p for p in PROBLEMS if set(models) <= set(PROBLEMS[p]['models'])]
+        if len(models) < 2 or not problems:
+            parser.error("--overlap needs two or more models of the same problem")
+        runOverlap(problems[0], models, args)
+        return
+    row = "{0:<10} {1:<38} {2:>8} {3:>10} {4:>7} {5:>10} {6:>12} {7:>8}"
+    print(row.format('model', 'kernel', 'size', 'elements', 'threads', 'ms', 'elements/s', 'GB/s'))
+    for problem in sorted(PROBLEMS):
+        spec = PROBLEMS[problem]
+        problemModels = [m for m in spec['models'] if m in models]
+        if not problemModels:
+            continue
+        sizes = args.sizes.split(',') if args.sizes else [str(s) for s in spec['sizes']]
+        for size in sizes:
+            for nThreads in args.threads.split(','):
+                results = runWorkerProcess(problem, size, problemModels, nThreads, args.repeat)
+                for r in results:
+                    print(row.format(r['model'], r['kernel'], size, r['nElements'], nThreads,
+                                     "{0:.3f}".format(1.0e3*r['seconds']),
+                                     "{0:.4g}".format(r['nElements']/r['seconds']),
+                                     "{0:.2f}".format(r['bytes']/r['seconds']/1.0e9)))
+                sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
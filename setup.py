@@ -39,6 +39,8 @@ from proteus.config import *
 PROTEUS_PETSC_EXTRA_LINK_ARGS = getattr(config, 'PROTEUS_PETSC_EXTRA_LINK_ARGS', [])
 PROTEUS_PETSC_EXTRA_COMPILE_ARGS = getattr(config, 'PROTEUS_PETSC_EXTRA_COMPILE_ARGS', [])
 PROTEUS_CHRONO_CXX_FLAGS = getattr(config, 'PROTEUS_CHRONO_CXX_FLAGS', [])
+PROTEUS_OPENMP_COMPILE_ARGS = getattr(config, 'PROTEUS_OPENMP_COMPILE_ARGS', [])
+PROTEUS_OPENMP_LINK_ARGS = getattr(config, 'PROTEUS_OPENMP_LINK_ARGS', [])
 
 proteus_install_path = os.path.join(sysconfig.get_python_lib(), 'proteus')
 
@@ -126,58 +128,60 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cPres',
         sources = ['proteus/mprans/Pres.cpp'],
-        depends=['proteus/mprans/Pres.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/Pres.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cPresInit',
         sources = ['proteus/mprans/PresInit.cpp'],
-        depends=['proteus/mprans/PresInit.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/PresInit.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cPresInc',
         sources = ['proteus/mprans/PresInc.cpp'],
-        depends = ['proteus/mprans/PresInc.h', 'proteus/mprans/PresInc.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends = ['proteus/mprans/PresInc.h', 'proteus/mprans/PresInc.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension('mprans.cAddedMass',
               sources = ['proteus/mprans/AddedMass.cpp'],
-              depends=['proteus/mprans/AddedMass.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+              depends=['proteus/mprans/AddedMass.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
               language='c++',
               include_dirs=get_xtensor_include(),
               extra_compile_args=PROTEUS_OPT+['-std=c++14']),
     Extension('mprans.SedClosure',
               sources = ['proteus/mprans/SedClosure.cpp'],
-              depends = ['proteus/mprans/SedClosure.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+              depends = ['proteus/mprans/SedClosure.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
               language='c++',
               include_dirs=get_xtensor_include(),
               extra_compile_args=PROTEUS_OPT+['-std=c++14']),
     Extension('mprans.cVOF3P',
               sources = ['proteus/mprans/VOF3P.cpp'],
-              depends = ['proteus/mprans/VOF3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+              depends = ['proteus/mprans/VOF3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/FCTLimiter.h', 'proteus/Workspace.h'],
               language='c++',
               include_dirs=get_xtensor_include(),
-              extra_compile_args=PROTEUS_OPT+['-std=c++14']),
+              extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+              extra_link_args=PROTEUS_OPENMP_LINK_ARGS),
     Extension(
         'mprans.cVOS3P',
         sources = ['proteus/mprans/VOS3P.cpp'],
-        depends = ['proteus/mprans/VOS3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends = ['proteus/mprans/VOS3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/FCTLimiter.h', 'proteus/Workspace.h'],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension('mprans.cNCLS3P',
               sources=['proteus/mprans/NCLS3P.cpp'],
-              depends=['proteus/mprans/NCLS3P.h', 'proteus/mprans/ArgumentsDict.h' , 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+              depends=['proteus/mprans/NCLS3P.h', 'proteus/mprans/ArgumentsDict.h' , 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
               language='c++',
               include_dirs=get_xtensor_include(),
               extra_compile_args=PROTEUS_OPT+['-std=c++14']),
     Extension('mprans.cMCorr3P',
               sources=['proteus/mprans/MCorr3P.cpp'],
-              depends=['proteus/mprans/MCorr3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+              depends=['proteus/mprans/MCorr3P.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
               language='c++',
               include_dirs=get_xtensor_include(),
               extra_compile_args=PROTEUS_OPT+['-std=c++14'],
@@ -196,24 +200,25 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cRANS3PSed',
         sources=['proteus/mprans/RANS3PSed.cpp'],
-        depends=['proteus/mprans/RANS3PSed.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/RANS3PSed.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cRANS3PSed2D',
         sources=['proteus/mprans/RANS3PSed2D.cpp'],
-        depends=['proteus/mprans/RANS3PSed2D.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/RANS3PSed2D.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'richards.cRichards',
         sources=['proteus/richards/cRichards.cpp'],
-        depends=['proteus/richards/Richards.h', 'proteus/mprans/ArgumentsDict.h' ,'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/richards/Richards.h', 'proteus/mprans/ArgumentsDict.h' ,'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/FCTLimiter.h', 'proteus/Workspace.h', 'proteus/PskTable.h'],
         include_dirs=get_xtensor_include(),
         language='c++',
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
     ),
     Extension(
         'elastoplastic.cElastoPlastic',
@@ -224,7 +229,7 @@ EXTENSIONS_TO_BUILD = [
                         PROTEUS_LAPACK_INTEGER),
                        ('PROTEUS_BLAS_H',
                         PROTEUS_BLAS_H)],
-        depends=['proteus/elastoplastic/ElastoPlastic.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/elastoplastic/ElastoPlastic.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/Workspace.h'],
         include_dirs=get_xtensor_include(),
         language='c++',
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
@@ -236,14 +241,14 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cRANS3PF',
         sources=['proteus/mprans/RANS3PF.cpp'],
-        depends=['proteus/mprans/RANS3PF.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/RANS3PF.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/JacobianScatter.h', 'proteus/EdgeList.h', 'proteus/Workspace.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cRANS3PF2D',
         sources=['proteus/mprans/RANS3PF2D.cpp'],
-        depends=['proteus/mprans/RANS3PF2D.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/mprans/RANS3PF2D.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h', 'proteus/JacobianScatter.h', 'proteus/EdgeList.h', 'proteus/Workspace.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
@@ -326,7 +331,7 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'cADR',
         sources=['proteus/ADR.cpp'],
-        depends=['proteus/ADR.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/CompKernel.h'],
+        depends=['proteus/ADR.h', 'proteus/mprans/ArgumentsDict.h', 'proteus/ModelFactory.h', 'proteus/Discretizations.h', 'proteus/CompKernel.h'],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'
@@ -368,10 +373,12 @@ EXTENSIONS_TO_BUILD = [
               sources=['proteus/csparsity.pyx', 'proteus/sparsity.cpp'],
               depends=['proteus/sparsity.h'],
               language='c++',
-              extra_compile_args=PROTEUS_OPT,
+              extra_compile_args=PROTEUS_OPT + PROTEUS_OPENMP_COMPILE_ARGS,
+              extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
               include_dirs=[numpy.get_include(),'proteus'],),
     Extension("cmeshTools",
               sources=['proteus/cmeshTools.pyx', 'proteus/mesh.cpp', 'proteus/meshio.cpp'],
+              depends=['proteus/mesh.h', 'proteus/ElementColoring.h'],
               language='c++',
               define_macros=[('PROTEUS_TRIANGLE_H',PROTEUS_TRIANGLE_H),
                              ('PROTEUS_SUPERLU_H',PROTEUS_SUPERLU_H),
@@ -389,8 +396,8 @@ EXTENSIONS_TO_BUILD = [
               PROTEUS_MPI_INCLUDE_DIRS,
               library_dirs=PROTEUS_PETSC_LIB_DIRS+PROTEUS_MPI_LIB_DIRS+PROTEUS_HDF5_LIB_DIRS,
               libraries=['hdf5','stdc++','m']+PROTEUS_PETSC_LIBS+PROTEUS_MPI_LIBS+PROTEUS_HDF5_LIBS,
-              extra_link_args=PROTEUS_EXTRA_LINK_ARGS + PROTEUS_PETSC_EXTRA_LINK_ARGS,
-              extra_compile_args=PROTEUS_EXTRA_COMPILE_ARGS + PROTEUS_PETSC_EXTRA_COMPILE_ARGS+PROTEUS_OPT),
+              extra_link_args=PROTEUS_EXTRA_LINK_ARGS + PROTEUS_PETSC_EXTRA_LINK_ARGS + PROTEUS_OPENMP_LINK_ARGS,
+              extra_compile_args=PROTEUS_EXTRA_COMPILE_ARGS + PROTEUS_PETSC_EXTRA_COMPILE_ARGS+PROTEUS_OPT + PROTEUS_OPENMP_COMPILE_ARGS),
     Extension('ctransportCoefficients',
               sources=['proteus/ctransportCoefficients.pyx','proteus/transportCoefficients.c'],
               include_dirs=[numpy.get_include(),'proteus'],
@@ -502,6 +509,7 @@ EXTENSIONS_TO_BUILD = [
                "proteus/SubsurfaceTransportCoefficients.cpp"],
               depends=["proteus/SubsurfaceTransportCoefficients.h",
                        "proteus/pskRelations.h",
+                       "proteus/PskTable.h",
                        "proteus/pskRelations.pxd",
                        "proteus/densityRelations.h",
                        "proteus/twophaseDarcyCoefficients.pxd",
@@ -553,7 +561,8 @@ EXTENSIONS_TO_BUILD = [
     Extension("cpskRelations",
               sources=["proteus/cpskRelations.pyx"],
               depends=["proteus/pskRelations.pxd",
-                       "proteus/pskRelations.h"],
+                       "proteus/pskRelations.h",
+                       "proteus/PskTable.h"],
               define_macros=[('PROTEUS_TRIANGLE_H',PROTEUS_TRIANGLE_H),
                              ('PROTEUS_SUPERLU_H',PROTEUS_SUPERLU_H),
                              ('CMRVEC_BOUNDS_CHECK',1),
@@ -631,21 +640,22 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cCLSVOF',
         sources=['proteus/mprans/CLSVOF.cpp'],
-        depends=["proteus/mprans/CLSVOF.h", "proteus/mprans/CLSVOF.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/CLSVOF.h", "proteus/mprans/CLSVOF.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h"],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cNCLS',
         sources=['proteus/mprans/NCLS.cpp'],
-        depends=["proteus/mprans/NCLS.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/NCLS.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/EdgeList.h","proteus/Workspace.h","proteus/NarrowBand.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cMCorr',
         sources=['proteus/mprans/MCorr.cpp'],
-        depends=["proteus/mprans/MCorr.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"] + [
+        depends=["proteus/mprans/MCorr.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h","proteus/NarrowBand.h"] + [
             "proteus/equivalent_polynomials.h",
             "proteus/equivalent_polynomials_utils.h",
             "proteus/equivalent_polynomials_coefficients.h",
@@ -657,30 +667,30 @@ EXTENSIONS_TO_BUILD = [
         library_dirs=[PROTEUS_LAPACK_LIB_DIR,
                       PROTEUS_BLAS_LIB_DIR],
         libraries=['m',PROTEUS_LAPACK_LIB,PROTEUS_BLAS_LIB],
-        extra_compile_args=PROTEUS_EXTRA_COMPILE_ARGS+PROTEUS_OPT+['-std=c++14'],
-        extra_link_args=PROTEUS_EXTRA_LINK_ARGS,
+        extra_compile_args=PROTEUS_EXTRA_COMPILE_ARGS+PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_EXTRA_LINK_ARGS+PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cRANS2P',
         sources=['proteus/mprans/RANS2P.cpp'],
-        depends=["proteus/mprans/RANS2P.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/MixedModelFactory.h","proteus/CompKernel.h"] + [
+        depends=["proteus/mprans/RANS2P.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/MixedModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/ElementColoring.h","proteus/JacobianScatter.h"] + [
             "proteus/equivalent_polynomials.h",
             "proteus/equivalent_polynomials_utils.h",
             "proteus/equivalent_polynomials_coefficients.h",
             'proteus/equivalent_polynomials_coefficients_quad.h'],
         include_dirs=get_xtensor_include() + PROTEUS_MPI_INCLUDE_DIRS,
-        extra_compile_args=PROTEUS_OPT+PROTEUS_MPI_LIB_DIRS+['-std=c++14'],#,'-fopenmp'],#,'-DXTENSOR_USE_OPENMP'],
+        extra_compile_args=PROTEUS_OPT+PROTEUS_MPI_LIB_DIRS+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,#,'-DXTENSOR_USE_OPENMP'],
         library_dirs=PROTEUS_MPI_LIB_DIRS+[PROTEUS_LAPACK_LIB_DIR,
                       PROTEUS_BLAS_LIB_DIR],
         libraries=PROTEUS_MPI_LIBS+['m',
                                     PROTEUS_LAPACK_LIB,
                                     PROTEUS_BLAS_LIB],
-        extra_link_args=PROTEUS_SCOREC_EXTRA_LINK_ARGS+PROTEUS_EXTRA_LINK_ARGS,#+['-fopenmp'],
+        extra_link_args=PROTEUS_SCOREC_EXTRA_LINK_ARGS+PROTEUS_EXTRA_LINK_ARGS+PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cRANS2P_IB',
         sources=['proteus/mprans/RANS2P_IB.cpp'],
-        depends=["proteus/mprans/RANS2P_IB.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/MixedModelFactory.h","proteus/CompKernel.h"] + [
+        depends=["proteus/mprans/RANS2P_IB.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/MixedModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"] + [
             "proteus/equivalent_polynomials.h",
             "proteus/equivalent_polynomials_utils.h",
             "proteus/equivalent_polynomials_coefficients.h",
@@ -691,7 +701,7 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cRANS2P2D',
         sources=['proteus/mprans/RANS2P2D.cpp'],
-        depends=["proteus/mprans/RANS2P2D.h"] + ["proteus/MixedModelFactory.h","proteus/CompKernel.h"] + [
+        depends=["proteus/mprans/RANS2P2D.h"] + ["proteus/MixedModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/JacobianScatter.h"] + [
             "proteus/equivalent_polynomials.h",
             "proteus/equivalent_polynomials_utils.h",
             "proteus/equivalent_polynomials_coefficients.h",
@@ -708,7 +718,7 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cRDLS',
         sources=['proteus/mprans/RDLS.cpp'],
-        depends=["proteus/mprans/RDLS.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"] + [
+        depends=["proteus/mprans/RDLS.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/Workspace.h","proteus/NarrowBand.h","proteus/Eikonal.h"] + [
             "proteus/equivalent_polynomials.h",
             "proteus/equivalent_polynomials_utils.h",
             "proteus/equivalent_polynomials_coefficients.h",
@@ -719,77 +729,81 @@ EXTENSIONS_TO_BUILD = [
     Extension(
         'mprans.cVOF',
         sources=['proteus/mprans/VOF.cpp'],
-        depends=["proteus/mprans/VOF.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/VOF.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h","proteus/EdgeList.h"],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cTADR',
         sources=['proteus/mprans/TADR.cpp'],
-        depends=["proteus/mprans/TADR.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/TADR.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h","proteus/EdgeList.h"],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cMoveMesh',
         ['proteus/mprans/MoveMesh.cpp'],
-        depends=["proteus/mprans/MoveMesh.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/MoveMesh.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cMoveMesh2D',
         sources=['proteus/mprans/MoveMesh2D.cpp'],
-        depends=["proteus/mprans/MoveMesh2D.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/MoveMesh2D.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cSW2D',
         sources=['proteus/mprans/SW2D.cpp'],
-        depends=["proteus/mprans/SW2D.h", "proteus/mprans/SW2D.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/SW2D.h", "proteus/mprans/SW2D.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cSW2DCV',
         sources=['proteus/mprans/SW2DCV.cpp'],
-        depends=["proteus/mprans/SW2DCV.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/SW2DCV.h", "proteus/mprans/ArgumentsDict.h", "proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h","proteus/SSPStepper.h","proteus/EdgeList.h"],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cGN_SW2DCV',
         sources=['proteus/mprans/GN_SW2DCV.cpp'],
-        depends=["proteus/mprans/GN_SW2DCV.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/GN_SW2DCV.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h","proteus/FCTLimiter.h","proteus/Workspace.h","proteus/SSPStepper.h","proteus/EdgeList.h"],
         include_dirs=get_xtensor_include(),
-        extra_compile_args=PROTEUS_OPT+['-std=c++14'],
+        extra_compile_args=PROTEUS_OPT+['-std=c++14']+PROTEUS_OPENMP_COMPILE_ARGS,
+        extra_link_args=PROTEUS_OPENMP_LINK_ARGS,
         language='c++'),
     Extension(
         'mprans.cKappa',
         sources=['proteus/mprans/Kappa.cpp'],
-        depends=["proteus/mprans/Kappa.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/Kappa.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cKappa2D',
         sources=['proteus/mprans/Kappa2D.cpp'],
-        depends=["proteus/mprans/Kappa2D.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/Kappa2D.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cDissipation',
         sources=['proteus/mprans/Dissipation.cpp'],
-        depends=["proteus/mprans/Dissipation.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/Dissipation.h", "proteus/mprans/ArgumentsDict.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
     Extension(
         'mprans.cDissipation2D',
         sources=['proteus/mprans/Dissipation2D.cpp'],
-        depends=["proteus/mprans/Dissipation2D.h"] + ["proteus/ModelFactory.h","proteus/CompKernel.h"],
+        depends=["proteus/mprans/Dissipation2D.h"] + ["proteus/ModelFactory.h","proteus/Discretizations.h","proteus/CompKernel.h"],
         include_dirs=get_xtensor_include(),
         extra_compile_args=PROTEUS_OPT+['-std=c++14'],
         language='c++'),
@@ -842,6 +856,7 @@ def setup_given_extensions(extensions):
                         'proteus/proteus_lapack.h',
                         'proteus/proteus_superlu.h',
                         'proteus/ModelFactory.h',
+                        'proteus/Discretizations.h',
                         'proteus/CompKernel.h'
                        ]),
          ],
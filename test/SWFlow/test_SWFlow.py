@@ -90,3 +90,66 @@ class TestSWFlow(object):
         os.system("parun --SWEs --path " + self.path + " "
                   "-l1 -v santos_step.py -C 'refinement=3 final_time=0.1 dt_output=0.1'")
         self.compare_vs_saved_files("santos_step")
+
+    def load_solution(self, case, context):
+        from proteus import NumericalSolution
+        from proteus.iproteus import opts
+        import proteus.SWFlow
+        # SWEs_so imports the case named on the parun command line
+        sys.modules.pop(case, None)
+        sys.argv = ['parun', '--SWEs', case+'.py']
+        if self.path not in sys.path:
+            sys.path.insert(0, self.path)
+        Context.contextOptionsString = context
+        path = os.path.dirname(proteus.SWFlow.__file__)
+        so = proteus.defaults.load_system('SWEs_so', path=os.path.join(path, 'utils'))
+        pList = [proteus.defaults.load_physics(p, path=os.path.join(path, 'models')) for p, n in so.pnList]
+        nList = [proteus.defaults.load_numerics(n, path=os.path.join(path, 'models')) for p, n in so.pnList]
+        for p, (pModule, nModule) in zip(pList, so.pnList):
+            if p.name is None:
+                p.name = pModule
+        sList = [default_s for p in pList]
+        return NumericalSolution.NS_base(so, pList, nList, sList, opts)
+
+    def python_step(self, model, tOut):
+        # the solver, RKEV and step controller calls the step loop makes
+        m = model.levelModelList[-1]
+        ti = m.timeIntegration
+        if ti.tLast + ti.dt >= tOut * (1.0 - 1.0e-12):
+            ti.dt = tOut - ti.tLast
+        elif tOut - (ti.tLast + ti.dt) < ti.dt / 2.0:
+            ti.dt = (tOut - ti.tLast) / 2.0
+        m.coefficients.preStep(ti.tLast)
+        for stage in range(ti.nStages):
+            model.solver.solverList[-1].solve(u=model.uList[-1], r=model.rList[-1])
+            ti.updateStage()
+        ti.updateTimeHistory()
+        ti.choose_dt()
+
+    @pytest.mark.parametrize("sw_model", [0, 1])
+    def test_advanceSSP(self, sw_model):
+        ns = self.load_solution("dam3Bumps",
+                                "sw_model={0} refinement=3 final_time=0.05 dt_output=0.05".format(sw_model))
+        ns.calculateSolution("dam3Bumps_advanceSSP")
+        model = ns.modelList[0]
+        m = model.levelModelList[-1]
+        ti = m.timeIntegration
+        state = [m.u[ci].dof for ci in range(m.nc)] + [model.uList[-1], m.dLow, m.edge_based_cfl]
+        state += [m.h_dof_old, m.hu_dof_old, m.hv_dof_old]
+        if sw_model == 1:
+            state += [m.heta_dof_old, m.hw_dof_old, m.hbeta_dof_old]
+        state += list(ti.u_dof_last.values()) + list(ti.u_dof_lstage.values())
+        saved = [a.copy() for a in state]
+        savedTime = (ti.tLast, ti.t, ti.dt, ti.dtLast)
+        nSteps = m.advanceSSP(0.1, nSteps=5)
+        assert nSteps == 5
+        native = [m.u[ci].dof.copy() for ci in range(m.nc)]
+        nativeTime = (ti.tLast, ti.dt, ti.dtLast)
+        for a, a_saved in zip(state, saved):
+            a[:] = a_saved
+        ti.tLast, ti.t, ti.dt, ti.dtLast = savedTime
+        for step in range(nSteps):
+            self.python_step(model, 0.1)
+        for ci in range(m.nc):
+            np.testing.assert_array_equal(native[ci], m.u[ci].dof)
+        assert nativeTime == (ti.tLast, ti.dt, ti.dtLast)
@@ -12,7 +12,9 @@ opts = Context.Options([
     ("T", 4.0, "Time interval [0, T]"),
     ("he",0.2, "maximum size of edges"),
     ("backwardEuler",False,"use backward Euler or not"),
-    ("onlySaveFinalSolution",False,"Only save the final solution")
+    ("onlySaveFinalSolution",False,"Only save the final solution"),
+    ("forceStrongDirichlet",False,"Impose the Dirichlet conditions strongly"),
+    ("blockDiagonalVelocityJacobian",False,"Leave the velocity cross-coupling blocks out of the Jacobian")
 ], mutable=True)
 
 
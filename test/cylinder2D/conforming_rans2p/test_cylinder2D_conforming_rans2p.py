@@ -28,7 +28,10 @@ class Test_rans2p(object):
 
     def teardown_method(self, method):
         """ Tear down function """
-        FileList = [ "cylinder_rans2p_T1_rans2p.h5","cylinder_rans2p_T1_rans2p.xmf"
+        FileList = [ "cylinder_rans2p_T1_rans2p.h5","cylinder_rans2p_T1_rans2p.xmf",
+                     "cylinder_rans2p_applyJacobian.h5","cylinder_rans2p_applyJacobian.xmf",
+                     "cylinder_rans2p_crossBlocks.h5","cylinder_rans2p_crossBlocks.xmf",
+                     "cylinder_rans2p_noCrossBlocks.h5","cylinder_rans2p_noCrossBlocks.xmf"
                     ]
         for file in FileList:
             if os.path.isfile(file):
@@ -44,8 +47,58 @@ class Test_rans2p(object):
         self.compare_name = "T1_rans2p"
         self.example_setting("T=0.01 onlySaveFinalSolution=True")
 
-    def example_setting(self, pre_setting):
+    def test_apply_jacobian(self):
+        """applyJacobian matches the product with the assembled Jacobian,
+        including the strong Dirichlet and inactive identity rows"""
+        self.compare_name = "applyJacobian"
+        ns, my_so = self.build_ns("T=0.01 onlySaveFinalSolution=True forceStrongDirichlet=True")
+        ns.calculateSolution(my_so.name)
+        model = ns.modelList[0].levelModelList[-1]
+        assert model.forceStrongConditions
+        model.isActiveR[::7] = 0.0
+        jacobian = model.getJacobian(ns.modelList[0].jacobianList[-1])
+        x = np.random.RandomState(0).uniform(-1.0, 1.0, len(model.rowptr) - 1)
+        y_assembled = np.zeros_like(x)
+        jacobian.matvec(x, y_assembled)
+        y = model.applyJacobian(x, np.zeros_like(x))
+        np.testing.assert_allclose(y, y_assembled, rtol=1.0e-10, atol=1.0e-10*np.abs(y_assembled).max())
+
+    def test_block_diagonal_velocity_jacobian(self):
+        """Dropping the velocity cross blocks shrinks the Jacobian; Newton
+        becomes inexact, converges in at least as many iterations and
+        reaches the same solution"""
+        nnz = {}
+        dofs = {}
+        its = {}
+        for blockDiagonal, name in ((False, "crossBlocks"), (True, "noCrossBlocks")):
+            self.compare_name = name
+            ns, my_so = self.build_ns("T=0.01 onlySaveFinalSolution=True blockDiagonalVelocityJacobian=%s" % blockDiagonal)
+            newton = ns.nlsList[0].solverList[-1]
+            its[blockDiagonal] = []
+            solve = newton.solve
+            def countingSolve(*args, **kwargs):
+                failed = solve(*args, **kwargs)
+                its[blockDiagonal].append(newton.its)
+                assert not newton.failedFlag
+                return failed
+            newton.solve = countingSolve
+            ns.calculateSolution(my_so.name)
+            model = ns.modelList[0].levelModelList[-1]
+            assert model.coefficients.blockDiagonalVelocityJacobian == blockDiagonal
+            nnz[blockDiagonal] = model.nnz
+            dofs[blockDiagonal] = [model.u[ci].dof.copy() for ci in range(model.nc)]
+        assert nnz[True] < nnz[False]
+        assert len(its[True]) == len(its[False]) > 0
+        assert sum(its[True]) >= sum(its[False])
+        for dof_exact, dof_inexact in zip(dofs[False], dofs[True]):
+            np.testing.assert_allclose(dof_inexact, dof_exact, rtol=0.0, atol=1.0e-6)
+
+    def build_ns(self, pre_setting):
         Context.contextOptionsString = pre_setting
+        # the problem module reads the options when it is imported
+        for name in ("cylinder2d", __package__ + ".cylinder2d"):
+            if name in sys.modules:
+                reload(sys.modules[name])
 
         from . import cylinder_so as my_so
         reload(my_so)
@@ -80,6 +133,10 @@ class Test_rans2p(object):
                                                sList,
                                                opts)
         self.aux_names.append(ns.modelList[0].name)
+        return ns, my_so
+
+    def example_setting(self, pre_setting):
+        ns, my_so = self.build_ns(pre_setting)
         ns.calculateSolution(my_so.name)
         # COMPARE VS SAVED FILES #
         actual = h5py.File( my_so.name + '.h5')
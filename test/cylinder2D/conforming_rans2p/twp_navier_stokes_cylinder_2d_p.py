@@ -23,7 +23,8 @@ coefficients = RANS2P.Coefficients(epsFact=epsFact_viscosity,
                                    LS_model=None,
                                    epsFact_density=epsFact_density,
                                    stokes=False,
-                                   forceStrongDirichlet=False,
+                                   forceStrongDirichlet=opts.forceStrongDirichlet,
+                                   blockDiagonalVelocityJacobian=opts.blockDiagonalVelocityJacobian,
                                    eb_adjoint_sigma=1.0,
                                    eb_penalty_constant=100.0,
                                    useRBLES=0.0,
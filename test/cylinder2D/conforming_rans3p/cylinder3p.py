@@ -11,7 +11,8 @@ opts = Context.Options([
     ("he",0.2, "maximum size of edges"),
     ("onlySaveFinalSolution",False,"Only save the final solution"),
     ("vspaceOrder",2,"FE space for velocity"),
-    ("pspaceOrder",1,"FE space for pressure")
+    ("pspaceOrder",1,"FE space for pressure"),
+    ("forceStrongDirichlet",False,"Impose the Dirichlet conditions strongly")
 ], mutable=True)
 
 
@@ -130,7 +131,7 @@ if opts.onlySaveFinalSolution == True:
 
 
 # Numerical parameters
-ns_forceStrongDirichlet = False
+ns_forceStrongDirichlet = opts.forceStrongDirichlet
 ns_sed_forceStrongDirichlet = False
 if useMetrics:
     ns_shockCapturingFactor  = 0.0
@@ -38,8 +38,29 @@ class Test_rans3p(object):
         self.example_setting("T=0.1 vspaceOrder=1 onlySaveFinalSolution=True")
 
 
-    def example_setting(self, pre_setting):
+    def test_apply_jacobian(self):
+        """applyJacobian matches the product with the assembled Jacobian,
+        including the strong Dirichlet and inactive identity rows"""
+        self.compare_name = "applyJacobian"
+        ns, my_so = self.build_ns("T=0.01 vspaceOrder=1 onlySaveFinalSolution=True forceStrongDirichlet=True")
+        ns.calculateSolution(my_so.name)
+        V_model = my_so.cylinder3p.V_model
+        model = ns.modelList[V_model].levelModelList[-1]
+        assert model.forceStrongConditions
+        model.isActiveDOF[::7] = 0.0
+        jacobian = model.getJacobian(ns.modelList[V_model].jacobianList[-1])
+        x = np.random.RandomState(0).uniform(-1.0, 1.0, len(model.rowptr) - 1)
+        y_assembled = np.zeros_like(x)
+        jacobian.matvec(x, y_assembled)
+        y = model.applyJacobian(x, np.zeros_like(x))
+        np.testing.assert_allclose(y, y_assembled, rtol=1.0e-10, atol=1.0e-10*np.abs(y_assembled).max())
+
+    def build_ns(self, pre_setting):
         Context.contextOptionsString = pre_setting
+        # the problem module reads the options when it is imported
+        for name in ("cylinder3p", __package__ + ".cylinder3p"):
+            if name in sys.modules:
+                reload(sys.modules[name])
         from . import cylinder_so as my_so
         reload(my_so)
         # defined in iproteus
@@ -76,6 +97,10 @@ class Test_rans3p(object):
                                                sList,
                                                opts)
         self.aux_names.append(ns.modelList[0].name)
+        return ns, my_so
+
+    def example_setting(self, pre_setting):
+        ns, my_so = self.build_ns(pre_setting)
         ns.calculateSolution(my_so.name)
         # COMPARE VS SAVED FILES #
         actual=h5py.File( my_so.name + '.h5')
@@ -11,6 +11,7 @@ This module solves equations of the form
 """
 from proteus.iproteus import *
 import os
+import time
 import numpy as np
 import h5py
 from . import re_gl_6_3d_p
@@ -21,6 +22,8 @@ from . import sm_gl_6_3d_n
 from proteus import Quadrature
 from proteus import MeshTools
 from proteus import FemTools
+from proteus.mprans import cArgumentsDict
+from proteus.elastoplastic import cElastoPlastic
 
 class TestRichards(object):
 
@@ -105,6 +108,78 @@ class TestRichards(object):
 
         actual.close()
         del ns
-        
+
+    def test_elastoplastic_tangent_reuse(self):
+        """The Jacobian assembled from the tangents kept by the residual
+        equals the one that repeats the return mapping"""
+        pList = [sm_gl_6_3d_p]
+        nList = [sm_gl_6_3d_n]
+        reload(default_so)
+        so = default_so
+        so.name = pList[0].name = "elastoplastic_tangents"
+        reload(default_s)
+        so.sList=[default_s]
+        opts.logLevel=7
+        opts.verbose=True
+        opts.profile=True
+        opts.gatherArchive=True
+        ns = NumericalSolution.NS_base(so,pList,nList,so.sList,opts)
+        ns.calculateSolution(so.name)
+        self.aux_names.append(so.name)
+        model = ns.modelList[0].levelModelList[-1]
+        assert model.coefficients.gravityStep == 0
+        jacobian = ns.modelList[0].jacobianList[-1]
+        u = ns.modelList[0].uList[-1].copy()
+        r = np.zeros_like(u)
+        model.getResidual(u, r)
+        start = time.time()
+        reused = model.getJacobian(jacobian).getCSRrepresentation()[2].copy()
+        reusedTime = time.time() - start
+        #the tangents kept now are of another displacement, so the Jacobian at u repeats the return mapping
+        model.getResidual(1.5*u, r)
+        model.setUnknowns(u)
+        start = time.time()
+        recomputed = model.getJacobian(jacobian).getCSRrepresentation()[2].copy()
+        recomputedTime = time.time() - start
+        print("Jacobian with reused tangents %g s, with recomputed tangents %g s" % (reusedTime, recomputedTime))
+        np.testing.assert_array_equal(reused, recomputed)
+        del ns
+
+    def test_yield_function_derivatives(self):
+        """df and dr of the yield function match central differences of f and r"""
+        materialProperties = np.zeros((14,),'d')
+        materialProperties[5] = sm_gl_6_3d_p.phi_mc
+        materialProperties[6] = sm_gl_6_3d_p.c_mc
+        materialProperties[7] = sm_gl_6_3d_p.psi_mc
+        kernel = cElastoPlastic.cElastoPlastic_base(3,5,4,4,4,4,0)
+        def evaluate(stress):
+            n = stress.shape[0]
+            f = np.zeros((n,),'d')
+            df = np.zeros((n,6),'d')
+            r = np.zeros((n,6),'d')
+            dr = np.zeros((n,6,6),'d')
+            argsDict = cArgumentsDict.ArgumentsDict()
+            argsDict["materialProperties"] = materialProperties
+            argsDict["stress"] = stress
+            argsDict["f"] = f
+            argsDict["df"] = df
+            argsDict["r"] = r
+            argsDict["dr"] = dr
+            kernel.evaluateYieldFunction(argsDict)
+            return f, df, r, dr
+        stress = np.random.RandomState(0).uniform(-100.0, 100.0, (20,6))
+        f, df, r, dr = evaluate(stress)
+        for j in range(6):
+            h = 1.0e-6*(np.abs(stress[:,j]) + 1.0)
+            stress_plus = stress.copy()
+            stress_plus[:,j] += h
+            stress_minus = stress.copy()
+            stress_minus[:,j] -= h
+            f_plus, df_plus, r_plus, dr_plus = evaluate(stress_plus)
+            f_minus, df_minus, r_minus, dr_minus = evaluate(stress_minus)
+            np.testing.assert_allclose(df[:,j], (f_plus - f_minus)/(2.0*h), rtol=1.0e-4, atol=1.0e-6)
+            #dr[k,j,i] is the derivative of r[k,i] by stress[k,j]
+            np.testing.assert_allclose(dr[:,j,:], (r_plus - r_minus)/(2.0*h)[:,np.newaxis], rtol=1.0e-4, atol=1.0e-6*np.abs(dr).max())
+
 if __name__ == '__main__':
     pass
@@ -0,0 +1,64 @@
+import numpy as np
+import pytest
+
+from proteus import csparsity
+
+def element_pattern(l2g, nc):
+    """Reference pattern for nc interlaced components coupled through every element"""
+    columns = {}
+    for dofs in l2g:
+        for ci in range(nc):
+            for cj in range(nc):
+                for I in dofs:
+                    columns.setdefault(ci+nc*I, set()).update(cj+nc*J for J in dofs)
+    return columns
+
+@pytest.mark.LinearAlgebraTools
+@pytest.mark.parametrize("nc", [1, 2])
+def test_element_sparsity(nc):
+    nx = 5
+    l2g = []
+    for j in range(nx):
+        for i in range(nx):
+            n0 = j*(nx+1)+i
+            l2g.append([n0, n0+1, n0+nx+2])
+            l2g.append([n0, n0+nx+2, n0+nx+1])
+    #shuffle so rows are not filled in order
+    l2g = np.array(l2g, dtype='i')[np.random.RandomState(0).permutation(len(l2g))]
+    nElements_global, nDOF_element = l2g.shape
+    nFreeDOF = np.full((nElements_global,), nDOF_element, dtype='i')
+    dummy = np.zeros((1,), 'i')
+    sparsity = csparsity.PySparsityInfo()
+    for ci in range(nc):
+        for cj in range(nc):
+            sparsity.findNonzeros(nElements_global, nDOF_element, nDOF_element,
+                                  nFreeDOF, l2g, nFreeDOF, l2g,
+                                  ci, nc, cj, nc,
+                                  0, 0, 0, 3, dummy,
+                                  0, dummy, dummy, dummy,
+                                  0, 0, dummy, 0, 0)
+    rowptr, colind, nnz, nzval = sparsity.getCSR()
+    columns = element_pattern(l2g, nc)
+    assert rowptr.shape[0] == len(columns)+1
+    assert nnz == sum(len(c) for c in columns.values())
+    for I in range(len(columns)):
+        assert list(colind[rowptr[I]:rowptr[I+1]]) == sorted(columns[I])
+    for ci in range(nc):
+        for cj in range(nc):
+            csrRowIndeces = np.zeros((nElements_global, nDOF_element), 'i')
+            csrColumnOffsets = np.zeros((nElements_global, nDOF_element, nDOF_element), 'i')
+            sparsity.getOffsets_CSR(nElements_global, nDOF_element, nDOF_element,
+                                    nFreeDOF, l2g, nFreeDOF, l2g,
+                                    ci, nc, cj, nc,
+                                    0, 0, 0, 3, dummy,
+                                    0, dummy, dummy, dummy,
+                                    0, 0, dummy, 0, 0,
+                                    rowptr, csrRowIndeces, csrColumnOffsets,
+                                    dummy, dummy, dummy)
+            for eN in range(nElements_global):
+                for i in range(nDOF_element):
+                    I = ci+nc*l2g[eN, i]
+                    assert csrRowIndeces[eN, i] == rowptr[I]
+                    for j in range(nDOF_element):
+                        J = cj+nc*l2g[eN, j]
+                        assert colind[csrRowIndeces[eN, i]+csrColumnOffsets[eN, i, j]] == J
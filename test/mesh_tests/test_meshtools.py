@@ -4,6 +4,7 @@ import numpy.testing as npt
 import numpy as np
 import os
 import math
+import struct
 import pytest
 import xml.etree.ElementTree as ElementTree
 from proteus.EGeometry import (EVec,
@@ -487,6 +488,95 @@ class TestMeshTools(object):
            mesh3d.writeEdgesGnuplot('mesh3d')
            mesh3d.viewMeshGnuplotPipe('mesh3d')
 
+    def test_ElementColoring(self):
+        mesh2d = TriangularMesh()
+        mesh2d.generateTriangularMeshFromRectangularGrid(5,4,1.0,1.0)
+        mesh3d = TetrahedralMesh()
+        mesh3d.generateTetrahedralMeshFromRectangularGrid(3,3,3,1.0,1.0,1.0)
+        for mesh in [mesh2d, mesh3d]:
+            mesh.buildElementColoring()
+            offsets = mesh.elementColorOffsets
+            assert offsets[0] == 0
+            assert offsets[mesh.nElementColors] == mesh.nElements_global
+            assert (np.sort(mesh.elementColorsArray) == np.arange(mesh.nElements_global)).all()
+            for c in range(mesh.nElementColors):
+                nodes = mesh.elementNodesArray[mesh.elementColorsArray[offsets[c]:offsets[c+1]]].flatten()
+                assert len(np.unique(nodes)) == len(nodes)
+            offsets = mesh.exteriorElementBoundaryColorOffsets
+            assert offsets[mesh.nExteriorElementBoundaryColors] == mesh.nExteriorElementBoundaries_global
+            for c in range(mesh.nExteriorElementBoundaryColors):
+                ebNE = mesh.exteriorElementBoundaryColorsArray[offsets[c]:offsets[c+1]]
+                eN = mesh.elementBoundaryElementsArray[mesh.exteriorElementBoundariesArray[ebNE],0]
+                nodes = mesh.elementNodesArray[eN].flatten()
+                assert len(np.unique(nodes)) == len(nodes)
+            #cached coloring is reused
+            elementColorsArray = mesh.elementColorsArray
+            mesh.buildElementColoring()
+            assert (elementColorsArray == mesh.elementColorsArray).all()
+
+    def test_BinaryMesh(self):
+        mesh2d = TriangularMesh()
+        mesh2d.generateTriangularMeshFromRectangularGrid(5,4,1.0,1.0)
+        mesh3d = TetrahedralMesh()
+        mesh3d.generateTetrahedralMeshFromRectangularGrid(3,3,3,1.0,1.0,1.0)
+        for name, mesh in [('mesh2d.pmesh', mesh2d), ('mesh3d.pmesh', mesh3d)]:
+            mesh.writeBinaryFile(name)
+            meshIn = mesh.__class__()
+            meshIn.generateFromBinaryFile(name)
+            for attr in ['nElements_global', 'nNodes_global', 'nElementBoundaries_global',
+                         'nExteriorElementBoundaries_global', 'nEdges_global', 'max_nNodeNeighbors_node',
+                         'h', 'hMin', 'volume']:
+                assert getattr(meshIn, attr) == getattr(mesh, attr)
+            for attr in ['elementNodesArray', 'nodeArray', 'elementBoundariesArray',
+                         'elementNeighborsArray', 'elementBoundaryElementsArray',
+                         'exteriorElementBoundariesArray', 'nodeStarArray',
+                         'elementBoundaryMaterialTypes', 'nodeMaterialTypes',
+                         'elementDiametersArray', 'elementBoundaryBarycentersArray']:
+                npt.assert_array_equal(getattr(meshIn, attr), getattr(mesh, attr))
+            os.remove(name)
+        with pytest.raises(IOError):
+            TetrahedralMesh().generateFromBinaryFile('missing.pmesh')
+        #a node star shorter than its offsets claim
+        mesh3d.writeBinaryFile('short.pmesh')
+        with open('short.pmesh', 'r+b') as f:
+            f.seek(60)
+            nSections, = struct.unpack('I', f.read(4))
+            for s in range(nSections):
+                f.seek(128 + 24*s)
+                sectionId, entrySize, count = struct.unpack('IIQ', f.read(16))
+                if sectionId == 13:
+                    f.seek(128 + 24*s + 8)
+                    f.write(struct.pack('Q', count - 1))
+        with pytest.raises(IOError):
+            TetrahedralMesh().generateFromBinaryFile('short.pmesh')
+        os.remove('short.pmesh')
+
+    def test_TetgenFiles(self):
+        mesh3d = TetrahedralMesh()
+        mesh3d.generateTetrahedralMeshFromRectangularGrid(3,3,3,1.0,1.0,1.0)
+        mesh3d.writeTetgenFiles('tetgen_io',1)
+        meshIn = TetrahedralMesh()
+        meshIn.generateFromTetgenFiles('tetgen_io',1)
+        #comments, blank lines and records out of order
+        permutation = np.random.RandomState(0).permutation
+        for ext in ['.node', '.ele']:
+            with open('tetgen_io'+ext) as f:
+                lines = f.readlines()
+            records = [l for l in lines[1:] if l.strip() and l[0] != '#']
+            with open('tetgen_io'+ext, 'w') as f:
+                f.write('# shuffled\n\n'+lines[0])
+                for i in permutation(len(records)):
+                    f.write('! comment\n   \n'+records[i])
+        meshShuffled = TetrahedralMesh()
+        meshShuffled.generateFromTetgenFiles('tetgen_io',1)
+        for attr in ['nodeArray', 'nodeMaterialTypes', 'elementNodesArray', 'elementMaterialTypes']:
+            npt.assert_array_equal(getattr(meshShuffled, attr), getattr(meshIn, attr))
+        npt.assert_allclose(meshIn.nodeArray, mesh3d.nodeArray, atol=1.0e-5)
+        npt.assert_array_equal(meshIn.elementNodesArray, mesh3d.elementNodesArray)
+        for ext in ['.node', '.ele', '.face']:
+            if os.path.exists('tetgen_io'+ext):
+                os.remove('tetgen_io'+ext)
+
     def test_Refine_1D(self):
         grid1d = RectangularGrid(3,1,1,1.0,1.0,1.0)
         grid1dFine = RectangularGrid()
@@ -0,0 +1,99 @@
+"""
+Tests of the fast marching redistancing of RDLS
+"""
+import numpy as np
+import pytest
+from proteus.mprans import cArgumentsDict
+from proteus.mprans import cRDLS
+
+def triangleMesh(n):
+    """the nodes of the unit square cut in n x n squares, padded to 3D, and the triangles"""
+    x, y = np.meshgrid(np.linspace(0.0, 1.0, n+1), np.linspace(0.0, 1.0, n+1), indexing='ij')
+    nodes = np.column_stack((x.flat, y.flat, np.zeros(x.size)))
+    l2g = []
+    for i in range(n):
+        for j in range(n):
+            a, b, c, d = i*(n+1)+j, (i+1)*(n+1)+j, (i+1)*(n+1)+j+1, i*(n+1)+j+1
+            l2g += [[a, b, c], [a, c, d]]
+    return nodes, np.array(l2g, 'i')
+
+def redistance(nodes, l2g, phi, bandWidth, rdls=None, seed=None, distance=None):
+    if rdls is None:
+        rdls = cRDLS.cRDLS_base(2, 3, 3, 3, 3, 2, 0)
+    if seed is None:
+        seed = -np.ones(phi.shape, 'd')
+    if distance is None:
+        distance = np.zeros(phi.shape, 'd')
+    argsDict = cArgumentsDict.ArgumentsDict()
+    argsDict["mesh_dof"] = nodes
+    argsDict["mesh_l2g"] = l2g
+    argsDict["nElements_global"] = l2g.shape[0]
+    argsDict["u_l2g"] = l2g
+    argsDict["phi_dof"] = phi
+    u = np.zeros(phi.shape, 'd')
+    argsDict["u_dof"] = u
+    argsDict["bandWidth"] = bandWidth
+    argsDict["seed_dof"] = seed
+    argsDict["distance_dof"] = distance
+    rdls.eikonalRedistance(argsDict)
+    return u
+
+@pytest.mark.parametrize("n", [32, 64])
+def test_circle_distance(n):
+    nodes, l2g = triangleMesh(n)
+    distance = np.sqrt((nodes[:, 0]-0.4)**2 + (nodes[:, 1]-0.55)**2) - 0.25
+    u = redistance(nodes, l2g, distance*(1.0 + 3.0*nodes[:, 0]), np.inf)
+    assert np.all(np.sign(u) == np.sign(distance))
+    near = np.abs(distance) < 0.1
+    assert np.abs(u - distance)[near].max() < 0.25/n
+
+def test_band():
+    n = 64
+    nodes, l2g = triangleMesh(n)
+    distance = np.sqrt((nodes[:, 0]-0.4)**2 + (nodes[:, 1]-0.55)**2) - 0.25
+    bandWidth = 0.1
+    u = redistance(nodes, l2g, distance*(1.0 + 3.0*nodes[:, 0]), bandWidth)
+    u_full = redistance(nodes, l2g, distance*(1.0 + 3.0*nodes[:, 0]), np.inf)
+    inside = np.abs(u_full) <= bandWidth
+    assert u[inside] == pytest.approx(u_full[inside])
+    assert np.all(np.abs(u[~inside]) >= bandWidth)
+
+def test_moving_mesh():
+    """the solver follows nodes moved in place between calls"""
+    n = 32
+    nodes, l2g = triangleMesh(n)
+    phi = np.sqrt((nodes[:, 0]-0.4)**2 + (nodes[:, 1]-0.55)**2) - 0.25
+    rdls = cRDLS.cRDLS_base(2, 3, 3, 3, 3, 2, 0)
+    redistance(nodes, l2g, phi, np.inf, rdls)
+    nodes[:, :2] *= 2.0
+    u = redistance(nodes, l2g, phi, np.inf, rdls)
+    u_new = redistance(nodes, l2g, phi, np.inf)
+    assert u == pytest.approx(u_new)
+    near = np.abs(phi) < 0.1
+    assert np.abs(u - 2.0*phi)[near].max() < 0.5/n
+
+@pytest.mark.parametrize("bandWidth", [np.inf, 0.3])
+def test_subdomains(bandWidth):
+    """two subdomains with one ghost layer, the interface in one of them,
+    exchanging the owners' distances reach the distance on the whole mesh"""
+    n = 64
+    nodes, l2g = triangleMesh(n)
+    phi = (np.sqrt((nodes[:, 0]-0.2)**2 + (nodes[:, 1]-0.55)**2) - 0.1)*(1.0 + 3.0*nodes[:, 0])
+    u_full = redistance(nodes, l2g, phi, bandWidth)
+    column = np.repeat(np.arange(n), 2*n)
+    parts = [l2g[column <= n//2], l2g[column >= n//2-1]]
+    left = nodes[:, 0] < 0.5
+    rdls = [cRDLS.cRDLS_base(2, 3, 3, 3, 3, 2, 0) for part in parts]
+    seed = -np.ones(phi.shape, 'd')
+    distance = [np.zeros(phi.shape, 'd') for part in parts]
+    u = redistance(nodes, parts[1], phi, bandWidth, rdls[1], seed, distance[1])
+    assert np.abs(u - u_full)[~left].max() > 0.05
+    for rounds in range(10):
+        u = [redistance(nodes, part, phi, bandWidth, rdls_p, seed, distance_p)
+             for part, rdls_p, distance_p in zip(parts, rdls, distance)]
+        owned = np.where(left, distance[0], distance[1])
+        if np.array_equal(owned, seed):
+            break
+        seed = owned
+    assert rounds < 9
+    assert np.where(left, u[0], u[1]) == pytest.approx(u_full)
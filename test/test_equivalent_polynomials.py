@@ -411,4 +411,24 @@ def test_3D():
                     print(int_D, int_D_exact)
                     assert(int_H == approx(int_H_exact,1e-12,1e-12))
                     assert(int_ImH == approx(int_ImH_exact,1e-12,1e-12))
-                    assert(int_D == approx(int_D_exact,1e-11,1e-11))
\ No newline at end of file
+                    assert(int_D == approx(int_D_exact,1e-11,1e-11))
+def test_cached():
+    from proteus.Quadrature import GaussTriangle
+    quad = GaussTriangle(order=4)
+    points = np.array(quad.points)
+    nodes = np.array([[0.,0.,0.],[1.,0.,0.],[0.,1.,0.]])
+    phiList = [[-1.,1.,1.],[-1.,-1.,1.],[0.5,-0.25,1.],[1.,1.,1.],[-1.,1.,1.],[-1.,1.,1.],[0.,0.,-1.],[-1.,1.,1.]]
+    for nP in [1,2,3]:
+        gf = eqp.Simplex(nSpace=2, nP=nP, nQ=len(quad.points))
+        gf_cached = eqp.Simplex(nSpace=2, nP=nP, nQ=len(quad.points))
+        for phi in phiList:
+            for eN, scale in enumerate([1.0, 2.0]):
+                #the same element and phi as in an earlier pass, or a changed phi
+                gf.calculate(np.array(phi), scale*nodes, points)
+                gf_cached.calculate(np.array(phi), scale*nodes, points, eN=eN)
+                for k in range(len(quad.points)):
+                    gf.set_quad(k)
+                    gf_cached.set_quad(k)
+                    assert gf_cached.H == gf.H
+                    assert gf_cached.ImH == gf.ImH
+                    assert gf_cached.D == gf.D
@@ -0,0 +1,64 @@
+"""
+Tests of the narrow band of elements around the zero level set
+"""
+import numpy as np
+import pytest
+from proteus.mprans import cArgumentsDict
+from proteus.mprans import cNCLS
+
+def triangleMesh(n):
+    """the nodes and triangles of the unit square cut in n x n squares"""
+    x, y = np.meshgrid(np.linspace(0.0, 1.0, n+1), np.linspace(0.0, 1.0, n+1), indexing='ij')
+    nodes = np.column_stack((x.flat, y.flat))
+    l2g = []
+    for i in range(n):
+        for j in range(n):
+            a, b, c, d = i*(n+1)+j, (i+1)*(n+1)+j, (i+1)*(n+1)+j+1, i*(n+1)+j+1
+            l2g += [[a, b, c], [a, c, d]]
+    l2g = np.array(l2g, 'i')
+    return nodes, l2g
+
+def cutElements(l2g, phi):
+    element_phi = phi[l2g]
+    return np.where((element_phi.min(axis=1) <= 0.0) & (element_phi.max(axis=1) >= 0.0))[0]
+
+def referenceBand(l2g, phi, nLayers):
+    band = set(cutElements(l2g, phi))
+    for layer in range(nLayers):
+        dofs = set(l2g[list(band)].flat)
+        band |= set(eN for eN in range(len(l2g)) if dofs.intersection(l2g[eN]))
+    inBand = np.zeros(len(l2g), bool)
+    inBand[list(band)] = True
+    active = np.zeros(len(phi))
+    active[l2g[inBand].flat] = 1.0
+    active[l2g[~inBand].flat] = 0.0
+    return active
+
+def updateNarrowBand(l2g, phi, nLayers):
+    ncls = cNCLS.cNCLS_base(2, 3, 3, 3, 3, 2, 0)
+    argsDict = cArgumentsDict.ArgumentsDict()
+    argsDict["u_l2g"] = l2g
+    argsDict["u_dof"] = phi
+    argsDict["nBandLayers"] = nLayers
+    isActiveDOF = np.ones(phi.shape, 'd')
+    argsDict["isActiveDOF"] = isActiveDOF
+    ncls.updateNarrowBand(argsDict)
+    return isActiveDOF
+
+def circle(nodes):
+    phi = np.sqrt((nodes[:, 0]-0.4)**2 + (nodes[:, 1]-0.55)**2) - 0.25
+    phi[::13] = np.where(np.abs(phi[::13]) < 0.05, 0.0, phi[::13])
+    return phi
+
+@pytest.mark.parametrize("nLayers", [1, 2, 3])
+def test_band_matches_reference(nLayers):
+    nodes, l2g = triangleMesh(16)
+    phi = circle(nodes)
+    isActiveDOF = updateNarrowBand(l2g, phi, nLayers)
+    assert isActiveDOF == pytest.approx(referenceBand(l2g, phi, nLayers))
+    assert (isActiveDOF[l2g[cutElements(l2g, phi)]] == 1.0).all()
+
+def test_band_rejects_no_layers():
+    nodes, l2g = triangleMesh(4)
+    with pytest.raises(ValueError):
+        updateNarrowBand(l2g, circle(nodes), 0)
@@ -0,0 +1,59 @@
+"""
+Tests of the tabulated van Genuchten-Mualem relations of Richards
+"""
+import numpy as np
+import pytest
+from proteus.mprans import cArgumentsDict
+from proteus.richards import cRichards
+
+def vanGenuchtenMualem(x, n):
+    """S, krw and krn of x = alpha*psi_c and their x derivatives"""
+    m = 1.0 - 1.0/n
+    S = (1.0 + x**n)**(-m)
+    dS = (1.0 - n)*x**(n-1.0)*S/(1.0 + x**n)
+    u = x**(n-1.0)*S
+    du = (n - 1.0)*x**(n-2.0)*S + x**(n-1.0)*dS
+    oneMinusS = -np.expm1(-m*np.log1p(x**n))
+    value = np.array([S, np.sqrt(S)*(1.0-u)**2, np.sqrt(oneMinusS)*u**2])
+    derivative = np.array([dS,
+                           0.5/np.sqrt(S)*dS*(1.0-u)**2 - 2.0*np.sqrt(S)*(1.0-u)*du,
+                           -0.5/np.sqrt(oneMinusS)*dS*u**2 + 2.0*np.sqrt(oneMinusS)*u*du])
+    return value, derivative
+
+def evaluatePskTable(n, tolerance, material, x, richards=None):
+    if richards is None:
+        richards = cRichards.cRichards_base(1, 2, 2, 2, 2, 1, 0)
+    argsDict = cArgumentsDict.ArgumentsDict()
+    argsDict["n"] = np.array(n, 'd')
+    argsDict["pskTableTolerance"] = tolerance
+    argsDict["material"] = material
+    argsDict["x"] = x
+    value = np.zeros((3, x.shape[0]), 'd')
+    derivative = np.zeros((3, x.shape[0]), 'd')
+    argsDict["value"] = value
+    argsDict["derivative"] = derivative
+    richards.evaluatePskTable(argsDict)
+    return value, derivative
+
+@pytest.mark.parametrize("tolerance", [1.0e-4, 1.0e-8])
+def test_table_accuracy(tolerance):
+    n = [1.1, 1.5, 2.0, 3.0]
+    x = 10.0**np.random.RandomState(0).uniform(-7.5, 5.5, 10000)
+    for material in range(len(n)):
+        value, derivative = evaluatePskTable(n, tolerance, material, x)
+        value_exact, derivative_exact = vanGenuchtenMualem(x, n[material])
+        assert np.abs(value - value_exact).max() <= tolerance
+        assert np.abs(x*(derivative - derivative_exact)).max() <= 100.0*tolerance
+
+def test_analytic_outside_table():
+    x = np.array([1.0e-9, 1.0e7])
+    value, derivative = evaluatePskTable([2.0], 1.0e-6, 0, x)
+    value_exact, derivative_exact = vanGenuchtenMualem(x, 2.0)
+    assert value == pytest.approx(value_exact, rel=1.0e-10, abs=1.0e-20)
+    assert derivative == pytest.approx(derivative_exact, rel=1.0e-10, abs=1.0e-20)
+
+def test_table_only_in_pressure_pressure_formulation():
+    from proteus import SubsurfaceTransportCoefficients as STC
+    STC.TwophaseDarcy_fc_pp(psk_model='VGMtable')
+    with pytest.raises(AssertionError):
+        STC.TwophaseDarcy_fc(psk_model='VGMtable')